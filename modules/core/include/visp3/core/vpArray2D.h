@@ -49,6 +49,35 @@
 #include <visp3/core/vpConfig.h>
 #include <visp3/core/vpException.h>
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+/*!
+  Storage of a R-by-C array embedded in the object of a class that inherits from vpArray2D,
+  so that the elements of small fixed size arrays are not allocated on the heap.
+  The elements are initialized to 0. Copy and assignment do not copy the elements,
+  since this is done by vpArray2D.
+*/
+template<class Type, unsigned int R, unsigned int C>
+class vpArray2DStorage
+{
+public:
+  vpArray2DStorage() { init(); }
+  vpArray2DStorage(const vpArray2DStorage &) { init(); }
+  vpArray2DStorage &operator=(const vpArray2DStorage &) { return *this; }
+
+  Type data[R*C];
+  Type *rowPtrs[R];
+
+private:
+  void init()
+  {
+    for (unsigned int i = 0; i < R; i++) {
+      rowPtrs[i] = data + i*C;
+    }
+    memset(data, 0, R*C*sizeof(Type));
+  }
+};
+#endif
+
 /*!
   \class vpArray2D
   \ingroup group_core_matrices
@@ -65,6 +94,10 @@
   - concerning vectors, vpColVector, vpRowVector but also specific containers describing
     the pose (vpPoseVector) and the rotation (vpRotationVector) inherit also from
     vpArray2D<double>.
+
+  The elements of the arrays are allocated on the heap, except for the containers of
+  small fixed size (vpHomogeneousMatrix, vpRotationMatrix, vpVelocityTwistMatrix and
+  vpTranslationVector) that embed their elements and cannot be resized.
 */
 template<class Type>
 class vpArray2D
@@ -78,6 +111,8 @@ protected:
   Type **rowPtrs;
   //! Current array size (rowNum * colNum)
   unsigned int dsize;
+  //! True when data and rowPtrs point to a storage of fixed size owned by a derived class
+  bool isFixedSize;
 
 public:
   //! Address of the first element of the data array
@@ -89,13 +124,13 @@ public:
   Number of columns and rows are set to zero.
   */
   vpArray2D<Type>()
-    : rowNum(0), colNum(0), rowPtrs(NULL), dsize(0), data(NULL)
+    : rowNum(0), colNum(0), rowPtrs(NULL), dsize(0), isFixedSize(false), data(NULL)
   {}
   /*!
   Copy constructor of a 2D array.
   */
   vpArray2D<Type>(const vpArray2D<Type> & A)
-    : rowNum(0), colNum(0), rowPtrs(NULL), dsize(0), data(NULL)
+    : rowNum(0), colNum(0), rowPtrs(NULL), dsize(0), isFixedSize(false), data(NULL)
   {
     resize(A.rowNum, A.colNum);
     memcpy(data, A.data, rowNum*colNum*sizeof(Type));
@@ -107,7 +142,7 @@ public:
   \param c : Array number of columns.
   */
   vpArray2D<Type>(unsigned int r, unsigned int c)
-    : rowNum(0), colNum(0), rowPtrs(NULL), dsize(0), data(NULL)
+    : rowNum(0), colNum(0), rowPtrs(NULL), dsize(0), isFixedSize(false), data(NULL)
   {
     resize(r, c);
   }
@@ -119,7 +154,7 @@ public:
   \param val : Each element of the array is set to \e val.
   */
   vpArray2D<Type>(unsigned int r, unsigned int c, Type val)
-    : rowNum(0), colNum(0), rowPtrs(NULL), dsize(0), data(NULL)
+    : rowNum(0), colNum(0), rowPtrs(NULL), dsize(0), isFixedSize(false), data(NULL)
   {
     resize(r, c);
     *this = val;
@@ -129,6 +164,11 @@ public:
   */
   virtual ~vpArray2D<Type>()
   {
+    if (isFixedSize) {
+      data = NULL;
+      rowPtrs = NULL;
+    }
+
     if (data != NULL ) {
       free(data);
       data=NULL;
@@ -141,6 +181,22 @@ public:
     rowNum = colNum = dsize = 0;
   }
 
+protected:
+  /*!
+  Constructor used by the containers of fixed size to use a storage embedded in the
+  derived class instead of heap memory.
+
+  \param storage : Storage member of the derived class. Since it is constructed after
+  this base class, it is only used to get the address of the elements.
+  */
+  template<unsigned int R, unsigned int C>
+  vpArray2D<Type>(vpArray2DStorage<Type, R, C> &storage)
+    : rowNum(R), colNum(C), rowPtrs(storage.rowPtrs), dsize(R*C), isFixedSize(true), data(storage.data)
+  {
+  }
+
+public:
+
   /** @name Inherited functionalities from vpArray2D */
   //@{
 
@@ -163,6 +219,9 @@ public:
   after resize. If false, the initial values from the common part of the
   array (common part between old and new version of the array) are kept.
   Default value is true.
+
+  \exception vpException::dimensionError : If the array has a fixed size that differs
+  from the requested one.
   */
   void resize(const unsigned int nrows, const unsigned int ncols,
               const bool flagNullify = true)
@@ -172,6 +231,10 @@ public:
         memset(this->data, 0, this->dsize*sizeof(Type));
       }
     }
+    else if (isFixedSize) {
+      throw(vpException(vpException::dimensionError,
+        "Cannot resize a (%dx%d) fixed size array to (%dx%d)", rowNum, colNum, nrows, ncols));
+    }
     else {
       const bool recopyNeeded = (ncols != this ->colNum);
       Type * copyTmp = NULL;
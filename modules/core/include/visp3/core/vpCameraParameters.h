@@ -295,7 +295,7 @@ public :
     
     \return List of the normals.
   */
-  inline std::vector<vpColVector> getFovNormals() const { 
+  inline const std::vector<vpColVector>& getFovNormals() const { 
     if(!isFov) vpTRACE("Warning: The FOV is not computed, getFovNormals() won't be significant.");
     return fovNormals; 
   }
@@ -41,6 +41,7 @@
 
 #include <visp3/core/vpArray2D.h>
 #include <visp3/core/vpException.h>
+#include <visp3/core/vpGEMMKernel.h>
 
 const vpArray2D<double> null(0,0);
 
@@ -134,159 +135,6 @@ inline void GEMMsize<7>(const vpArray2D<double> & A,const vpArray2D<double> & B,
   Bcols= B.getRows();
 }
 
-template<unsigned int>
-inline void GEMM1(const unsigned int &/*Arows*/,const unsigned int &/*Brows*/, const unsigned int &/*Bcols*/, const vpArray2D<double> & /*A*/, const vpArray2D<double> & /*B*/, const double & /*alpha*/,vpArray2D<double> &/*D*/){}
-
-template<>
-inline void GEMM1<0>(const unsigned int &Arows,const unsigned int &Brows, const unsigned int &Bcols, const vpArray2D<double> & A, const vpArray2D<double> & B, const double & alpha,vpArray2D<double> &D)
-{
-  for(unsigned int r=0;r<Arows;r++)
-    for(unsigned int c=0;c<Bcols;c++){
-      double sum=0;
-      for(unsigned int n=0;n<Brows;n++)
-        sum+=A[r][n]*B[n][c]*alpha;
-      D[r][c]=sum;
-    }
-}
-
-template<>
-inline void GEMM1<1>(const unsigned int &Arows,const unsigned int &Brows, const unsigned int &Bcols, const vpArray2D<double> & A, const vpArray2D<double> & B, const double & alpha,vpArray2D<double> &D)
-{
-  for(unsigned int r=0;r<Arows;r++)
-    for(unsigned int c=0;c<Bcols;c++){
-      double sum=0;
-      for(unsigned int n=0;n<Brows;n++)
-        sum+=A[n][r]*B[n][c]*alpha;
-      D[r][c]=sum;
-    }
-}
-
-template<>
-inline void GEMM1<2>(const unsigned int &Arows,const unsigned int &Brows, const unsigned int &Bcols, const vpArray2D<double> & A,const vpArray2D<double> & B, const double & alpha,vpArray2D<double> &D)
-{
-  for(unsigned int r=0;r<Arows;r++)
-    for(unsigned int c=0;c<Bcols;c++){
-      double sum=0;
-      for(unsigned int n=0;n<Brows;n++)
-        sum+=A[r][n]*B[c][n]*alpha;
-      D[r][c]=sum;
-    }
-}
-
-template<>
-inline void GEMM1<3>(const unsigned int &Arows,const unsigned int &Brows, const unsigned int &Bcols, const vpArray2D<double> & A,const vpArray2D<double> & B, const double & alpha,vpArray2D<double> &D)
-{
-  for(unsigned int r=0;r<Arows;r++)
-    for(unsigned int c=0;c<Bcols;c++){
-      double sum=0;
-      for(unsigned int n=0;n<Brows;n++)
-        sum+=A[n][r]*B[c][n]*alpha;
-      D[r][c]=sum;
-    }
-}
-
-template<unsigned int>
-inline void GEMM2(const unsigned int &/*Arows*/,const unsigned int &/*Brows*/, const unsigned int &/*Bcols*/, const vpArray2D<double> & /*A*/,const vpArray2D<double> & /*B*/, const double & /*alpha*/, const vpArray2D<double> & /*C*/ , const double &/*beta*/, vpArray2D<double> &/*D*/)
-{}
-
-template<>
-inline void GEMM2<0>(const unsigned int &Arows,const unsigned int &Brows, const unsigned int &Bcols, const vpArray2D<double> & A,const vpArray2D<double> & B, const double & alpha, const vpArray2D<double> & C , const double &beta, vpArray2D<double> &D)
-{
-  for(unsigned int r=0;r<Arows;r++)
-    for(unsigned int c=0;c<Bcols;c++){
-      double sum=0;
-      for(unsigned int n=0;n<Brows;n++)
-        sum+=A[r][n]*B[n][c]*alpha;
-      D[r][c]=sum+C[r][c]*beta;
-    }
-}
-
-template<>
-inline void GEMM2<1>(const unsigned int &Arows,const unsigned int &Brows, const unsigned int &Bcols, const vpArray2D<double> & A,const vpArray2D<double> & B, const double & alpha, const vpArray2D<double> & C , const double &beta, vpArray2D<double> &D)
-{
-  for(unsigned int r=0;r<Arows;r++)
-    for(unsigned int c=0;c<Bcols;c++){
-      double sum=0;
-      for(unsigned int n=0;n<Brows;n++)
-        sum+=A[n][r]*B[n][c]*alpha;
-      D[r][c]=sum+C[r][c]*beta;
-    }
-}
-
-template<>
-inline void GEMM2<2>(const unsigned int &Arows,const unsigned int &Brows, const unsigned int &Bcols, const vpArray2D<double> & A,const vpArray2D<double> & B, const double & alpha, const vpArray2D<double> & C , const double &beta, vpArray2D<double> &D)
-{
-  for(unsigned int r=0;r<Arows;r++)
-    for(unsigned int c=0;c<Bcols;c++){
-      double sum=0;
-      for(unsigned int n=0;n<Brows;n++)
-        sum+=A[r][n]*B[c][n]*alpha;
-      D[r][c]=sum+C[r][c]*beta;
-    }
-}
-
-template<>
-inline void GEMM2<3>(const unsigned int &Arows,const unsigned int &Brows, const unsigned int &Bcols, const vpArray2D<double> & A,const vpArray2D<double> & B, const double & alpha, const vpArray2D<double> & C , const double &beta, vpArray2D<double> &D)
-{
-  for(unsigned int r=0;r<Arows;r++)
-    for(unsigned int c=0;c<Bcols;c++){
-      double sum=0;
-      for(unsigned int n=0;n<Brows;n++)
-        sum+=A[n][r]*B[c][n]*alpha;
-      D[r][c]=sum+C[r][c]*beta;
-    }
-}
-
-
-template<>
-inline void GEMM2<4>(const unsigned int &Arows,const unsigned int &Brows, const unsigned int &Bcols, const vpArray2D<double> & A,const vpArray2D<double> & B, const double & alpha, const vpArray2D<double> & C , const double &beta, vpArray2D<double> &D)
-{
-  for(unsigned int r=0;r<Arows;r++)
-    for(unsigned int c=0;c<Bcols;c++){
-      double sum=0;
-      for(unsigned int n=0;n<Brows;n++)
-        sum+=A[r][n]*B[n][c]*alpha;
-      D[r][c]=sum+C[c][r]*beta;
-    }
-}
-
-template<>
-inline void GEMM2<5>(const unsigned int &Arows,const unsigned int &Brows, const unsigned int &Bcols, const vpArray2D<double> & A,const vpArray2D<double> & B, const double & alpha, const vpArray2D<double> & C , const double &beta, vpArray2D<double> &D)
-{
-  for(unsigned int r=0;r<Arows;r++)
-    for(unsigned int c=0;c<Bcols;c++){
-      double sum=0;
-      for(unsigned int n=0;n<Brows;n++)
-        sum+=A[n][r]*B[n][c]*alpha;
-      D[r][c]=sum+C[c][r]*beta;
-    }
-
-}
-
-template<>
-inline void GEMM2<6>(const unsigned int &Arows,const unsigned int &Brows, const unsigned int &Bcols, const vpArray2D<double> & A,const vpArray2D<double> & B, const double & alpha, const vpArray2D<double> & C , const double &beta, vpArray2D<double> &D)
-{
-  for(unsigned int r=0;r<Arows;r++)
-    for(unsigned int c=0;c<Bcols;c++){
-      double sum=0;
-      for(unsigned int n=0;n<Brows;n++)
-        sum+=A[r][n]*B[c][n]*alpha;
-      D[r][c]=sum+C[c][r]*beta;
-    }
-}
-
-template<>
-inline void GEMM2<7>(const unsigned int &Arows, const unsigned int &Brows, const unsigned int &Bcols, const vpArray2D<double> & A,const vpArray2D<double> & B, const double & alpha, const vpArray2D<double> & C , const double &beta, vpArray2D<double> &D)
-{
-  for(unsigned int r=0;r<Arows;r++)
-    for(unsigned int c=0;c<Bcols;c++){
-      double sum=0;
-      for(unsigned int n=0;n<Brows;n++)
-        sum+=A[n][r]*B[c][n]*alpha;
-      D[r][c]=sum+C[c][r]*beta;
-    }
-}
-
 template<unsigned int T>
 inline void vpTGEMM(const vpArray2D<double> & A, const vpArray2D<double> & B, const double & alpha ,const vpArray2D<double> & C, const double & beta, vpArray2D<double> & D)
 {
@@ -311,16 +159,39 @@ inline void vpTGEMM(const vpArray2D<double> & A, const vpArray2D<double> & B, co
   }
   
   if(C.getRows()!=0 && C.getCols()!=0){
-    if ((Arows != C.getRows()) || (Bcols != C.getCols())) {
+    unsigned int Crows = (T & VP_GEMM_C_T) ? C.getCols() : C.getRows();
+    unsigned int Ccols = (T & VP_GEMM_C_T) ? C.getRows() : C.getCols();
+    if ((Arows != Crows) || (Bcols != Ccols)) {
       throw(vpException(vpException::dimensionError,
                         "In vpGEMM, cannot add resulting (%dx%d) matrix to (%dx%d) matrix",
-                        Arows, Bcols, C.getRows(), C.getCols())) ;
+                        Arows, Bcols, Crows, Ccols)) ;
     }
     
-    GEMM2<T>(Arows,Brows,Bcols,A,B,alpha,C,beta,D);
+    // D = beta*op(C), taking care of a transposed C that is also the result
+    if (T & VP_GEMM_C_T) {
+      if (C.data == D.data) {
+        vpArray2D<double> Ct(C);
+        for(unsigned int r=0;r<Arows;r++)
+          for(unsigned int c=0;c<Bcols;c++)
+            D[r][c]=Ct[c][r]*beta;
+      }
+      else {
+        for(unsigned int r=0;r<Arows;r++)
+          for(unsigned int c=0;c<Bcols;c++)
+            D[r][c]=C[c][r]*beta;
+      }
+    }
+    else {
+      for(unsigned int i=0;i<D.size();i++)
+        D.data[i]=C.data[i]*beta;
+    }
   }else{
-    GEMM1<T>(Arows,Brows,Bcols,A,B,alpha,D);
+    for(unsigned int i=0;i<D.size();i++)
+      D.data[i]=0;
   }
+
+  vpGEMMKernel::gemm((T & VP_GEMM_A_T) != 0, (T & VP_GEMM_B_T) != 0, Arows, Bcols, Acols,
+                     alpha, A.data, A.getCols(), B.data, B.getCols(), D.data, D.getCols());
   
 }
 
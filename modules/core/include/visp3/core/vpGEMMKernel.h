@@ -0,0 +1,86 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Built-in blocked matrix product kernels.
+ *
+ *****************************************************************************/
+
+#ifndef __vpGEMMKernel_h_
+#define __vpGEMMKernel_h_
+
+/*!
+  \file vpGEMMKernel.h
+  \brief Built-in cache blocked and vectorized matrix product kernels.
+*/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \class vpGEMMKernel
+  \ingroup group_core_matrices
+
+  Low level matrix products on row-major arrays of doubles, used by
+  vpMatrix::mult2Matrices(), vpMatrix::multMatrixVector(), vpMatrix::AtA(),
+  vpMatrix::AAt() and vpGEMM().
+
+  The products are cache blocked: panels of the operands are packed in
+  contiguous buffers and a 4-by-4 micro kernel accumulates in registers.
+  The micro kernel uses SSE2 when ViSP is built with SSE2 support. With GCC or
+  Clang on x86, an AVX2 version is also compiled and selected at run time
+  when the processor supports it. The matrix by vector product puts one row
+  of the matrix per SIMD lane. Every kernel sums the products in the order
+  of the inner dimension without fused multiply-add, so the results do not
+  depend on the instruction set and are the same as the ones of the previous
+  triple loops as long as the inner dimension does not exceed one block.
+
+  All the functions accumulate in the output: they compute C += ... .
+  \e lda, \e ldb, \e ldc are the number of elements between two consecutive rows of
+  the corresponding array.
+*/
+class VISP_EXPORT vpGEMMKernel
+{
+public:
+  static void gemm(const bool transA, const bool transB,
+                   const unsigned int M, const unsigned int N, const unsigned int K,
+                   const double alpha, const double *A, const unsigned int lda,
+                   const double *B, const unsigned int ldb,
+                   double *C, const unsigned int ldc);
+  static void gemv(const bool transA, const unsigned int M, const unsigned int N,
+                   const double alpha, const double *A, const unsigned int lda,
+                   const double *x, double *y);
+  static void syrk(const bool transA, const unsigned int N, const unsigned int K,
+                   const double alpha, const double *A, const unsigned int lda,
+                   double *C, const unsigned int ldc);
+
+  static const char *getInstructionSet();
+  static void setVectorization(const bool enable);
+};
+
+#endif
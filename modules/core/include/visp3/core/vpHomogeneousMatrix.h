@@ -194,6 +194,10 @@ class VISP_EXPORT vpHomogeneousMatrix : public vpArray2D<double>
   //@}
 #endif
 
+private:
+  //! Elements of the matrix, embedded to avoid heap allocations
+  vpArray2DStorage<double, 4, 4> m_storage;
+
 } ;
 
 #endif
@@ -47,17 +47,17 @@
 #include <visp3/core/vpConfig.h>
 #include <visp3/core/vpDebug.h>
 #include <visp3/core/vpException.h>
+#include <visp3/core/vpImageBufferPool.h>
 #include <visp3/core/vpImageException.h>
 #include <visp3/core/vpImagePoint.h>
 #include <visp3/core/vpRGBa.h>
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
-#  include <visp3/core/vpThread.h>
-#endif
+#include <visp3/core/vpThreadPool.h>
 
 #include <fstream>
 #include <iostream>
 #include <iomanip>      // std::setw
 #include <math.h>
+#include <new>
 #include <string.h>
 
 class vpDisplay;
@@ -82,6 +82,20 @@ class vpDisplay;
   \image html image-data-structure.gif
   \image latex image-data-structure.ps  width=10cm
 
+  The bitmap is allocated by vpImageBufferPool: it is aligned on 64 bytes and,
+  when the image is destroyed or resized, its memory is recycled for the next
+  image of the same size instead of being freed.
+
+  By default the rows are stored one after the other. initAligned() rather pads
+  each row so that all of them start on an aligned address, the distance
+  between two rows given by getStride() being greater than the width. Vectorized
+  code can then process full registers on every row without scalar tail nor
+  unaligned load. The I[i][j] accessors and the member functions of this class
+  take the padding into account, but the functions that process \e bitmap as a
+  continuous array of getSize() pixels, like most of vpImageConvert, vpImageIo
+  and vpDisplay, require an image for which isContiguous() is true. Copies of an
+  image are always continuous.
+
   Such a structure allows a fast acces to each element of the image.
   if i is the ith rows and j the jth columns the value of this pixel
   is given by I[i][j] (that is equivalent to row[i][j]).
@@ -225,6 +239,15 @@ public:
   */
   inline  unsigned int getWidth() const { return width; }
 
+  /*!
+    Get the number of elements between the first pixels of two consecutive
+    rows, that is equal to the width unless the image was created by
+    initAligned().
+
+    \sa isContiguous()
+  */
+  inline unsigned int getStride() const { return stride; }
+
   // Returns a new image that's half size of the current image
   void halfSizeImage(vpImage<Type> &res) const;
 
@@ -234,7 +257,16 @@ public:
   void init(unsigned int height, unsigned int width, Type value) ;
   //! init from an image stored as a continuous array in memory
   void init(Type * const array, const unsigned int height, const unsigned int width, const bool copyData=false);
+  //! Set the size of the image with rows starting on aligned addresses
+  void initAligned(unsigned int height, unsigned int width, unsigned int rowAlignment=64);
   void insert(const vpImage<Type> &src, const vpImagePoint topLeft);
+  /*!
+    Return true if the rows are stored one after the other, so that \e bitmap
+    can be processed as a continuous array of getSize() pixels.
+
+    \sa getStride(), initAligned()
+  */
+  inline bool isContiguous() const { return stride == width; }
 
   //------------------------------------------------------------------
   //         Acces to the image
@@ -256,7 +288,7 @@ public:
   */
   inline Type operator()(const unsigned int i, const  unsigned int j) const
   {
-    return bitmap[i*width+j] ;
+    return bitmap[i*stride+j] ;
   }
   /*!
     Set the value \e v of an image point with coordinates (i, j), with i the row position and j
@@ -266,7 +298,7 @@ public:
   inline void  operator()(const unsigned int i, const  unsigned int j,
          const Type &v)
   {
-    bitmap[i*width+j] = v ;
+    bitmap[i*stride+j] = v ;
   }
   /*!
     Get the value of an image point.
@@ -284,7 +316,7 @@ public:
     unsigned int i = (unsigned int) ip.get_i();
     unsigned int j = (unsigned int) ip.get_j();
 
-    return bitmap[i*width+j] ;
+    return bitmap[i*stride+j] ;
   }
   /*!
     Set the value of an image point.
@@ -300,7 +332,7 @@ public:
     unsigned int i = (unsigned int) ip.get_i();
     unsigned int j = (unsigned int) ip.get_j();
 
-    bitmap[i*width+j] = v ;
+    bitmap[i*stride+j] = v ;
   }
 
   vpImage<Type> operator-(const vpImage<Type> &B);
@@ -335,10 +367,15 @@ public:
   //@}
 
 private:
+  void initBitmap(unsigned int h, unsigned int w, unsigned int s);
+  void releaseBitmap();
+
   unsigned int npixels ; ///! number of pixel in the image
   unsigned int width ;   ///! number of columns
   unsigned int height ;  ///! number of rows
+  unsigned int stride ;  ///! number of elements between two rows
   Type **row ;    //!< points the row pointer array
+  Type *buffer ;  //!< memory allocated by vpImageBufferPool, NULL if the bitmap was given by the user
 };
 
 template<class Type>
@@ -467,147 +504,112 @@ inline std::ostream& operator<<(std::ostream &s, const vpImage<double> &I) {
 }
 
 
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
 namespace {
-  struct ImageLut_Param_t {
-    unsigned int m_start_index;
-    unsigned int m_end_index;
-
-    unsigned char m_lut[256];
-    unsigned char *m_bitmap;
-
-    ImageLut_Param_t() : m_start_index(0), m_end_index(0), m_lut(), m_bitmap(NULL) {
+  class vpImageLutTask : public vpThreadPool::Task {
+  public:
+    vpImageLutTask(unsigned char *bitmap, const unsigned char (&lut)[256]) :
+      m_bitmap(bitmap), m_lut(lut) {
     }
 
-    ImageLut_Param_t(const unsigned int start_index, const unsigned int end_index,
-        unsigned char *bitmap) :
-      m_start_index(start_index), m_end_index(end_index), m_lut(), m_bitmap(bitmap) {
-    }
-  };
-
-  vpThread::Return performLutThread(vpThread::Args args) {
-    ImageLut_Param_t *imageLut_param = ( (ImageLut_Param_t *) args );
-    unsigned int start_index = imageLut_param->m_start_index;
-    unsigned int end_index = imageLut_param->m_end_index;
+    void operator()(const unsigned int start_index, const unsigned int end_index) {
+      unsigned char *ptrStart = m_bitmap + start_index;
+      unsigned char *ptrEnd = m_bitmap + end_index;
+      unsigned char *ptrCurrent = ptrStart;
 
-    unsigned char *bitmap = imageLut_param->m_bitmap;
+      if(end_index - start_index >= 8) {
+        //Unroll loop version
+        for(; ptrCurrent <= ptrEnd - 8;) {
+          *ptrCurrent = m_lut[*ptrCurrent];
+          ++ptrCurrent;
 
-    unsigned char *ptrStart = bitmap + start_index;
-    unsigned char *ptrEnd = bitmap + end_index;
-    unsigned char *ptrCurrent = ptrStart;
+          *ptrCurrent = m_lut[*ptrCurrent];
+          ++ptrCurrent;
 
+          *ptrCurrent = m_lut[*ptrCurrent];
+          ++ptrCurrent;
 
-//    while(ptrCurrent != ptrEnd) {
-//      *ptrCurrent = imageLut_param->m_lut[*ptrCurrent];
-//      ++ptrCurrent;
-//    }
+          *ptrCurrent = m_lut[*ptrCurrent];
+          ++ptrCurrent;
 
-    if(end_index - start_index >= 8) {
-      //Unroll loop version
-      for(; ptrCurrent <= ptrEnd - 8;) {
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent];
-        ++ptrCurrent;
+          *ptrCurrent = m_lut[*ptrCurrent];
+          ++ptrCurrent;
 
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent];
-        ++ptrCurrent;
+          *ptrCurrent = m_lut[*ptrCurrent];
+          ++ptrCurrent;
 
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent];
-        ++ptrCurrent;
+          *ptrCurrent = m_lut[*ptrCurrent];
+          ++ptrCurrent;
 
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent];
-        ++ptrCurrent;
-
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent];
-        ++ptrCurrent;
-
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent];
-        ++ptrCurrent;
-
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent];
-        ++ptrCurrent;
-
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent];
-        ++ptrCurrent;
+          *ptrCurrent = m_lut[*ptrCurrent];
+          ++ptrCurrent;
+        }
       }
-    }
 
-    for(; ptrCurrent != ptrEnd; ++ptrCurrent) {
-      *ptrCurrent = imageLut_param->m_lut[*ptrCurrent];
+      for(; ptrCurrent != ptrEnd; ++ptrCurrent) {
+        *ptrCurrent = m_lut[*ptrCurrent];
+      }
     }
 
-    return 0;
-  }
-
-
-  struct ImageLutRGBa_Param_t {
-    unsigned int m_start_index;
-    unsigned int m_end_index;
-
-    vpRGBa m_lut[256];
+  private:
     unsigned char *m_bitmap;
-
-    ImageLutRGBa_Param_t() : m_start_index(0), m_end_index(0), m_lut(), m_bitmap(NULL) {
-    }
-
-    ImageLutRGBa_Param_t(const unsigned int start_index, const unsigned int end_index,
-        unsigned char *bitmap) :
-      m_start_index(start_index), m_end_index(end_index), m_lut(), m_bitmap(bitmap) {
-    }
+    const unsigned char (&m_lut)[256];
   };
 
-  vpThread::Return performLutRGBaThread(vpThread::Args args) {
-    ImageLutRGBa_Param_t *imageLut_param = ( (ImageLutRGBa_Param_t *) args );
-    unsigned int start_index = imageLut_param->m_start_index;
-    unsigned int end_index = imageLut_param->m_end_index;
 
-    unsigned char *bitmap = imageLut_param->m_bitmap;
-
-    unsigned char *ptrStart = bitmap + start_index*4;
-    unsigned char *ptrEnd = bitmap + end_index*4;
-    unsigned char *ptrCurrent = ptrStart;
+  class vpImageLutRGBaTask : public vpThreadPool::Task {
+  public:
+    vpImageLutRGBaTask(unsigned char *bitmap, const vpRGBa (&lut)[256]) :
+      m_bitmap(bitmap), m_lut(lut) {
+    }
 
+    void operator()(const unsigned int start_index, const unsigned int end_index) {
+      unsigned char *ptrStart = m_bitmap + start_index*4;
+      unsigned char *ptrEnd = m_bitmap + end_index*4;
+      unsigned char *ptrCurrent = ptrStart;
+
+      if(end_index - start_index >= 4*2) {
+        //Unroll loop version
+        for(; ptrCurrent <= ptrEnd - 4*2;) {
+          *ptrCurrent = m_lut[*ptrCurrent].R;
+          ptrCurrent++;
+          *ptrCurrent = m_lut[*ptrCurrent].G;
+          ptrCurrent++;
+          *ptrCurrent = m_lut[*ptrCurrent].B;
+          ptrCurrent++;
+          *ptrCurrent = m_lut[*ptrCurrent].A;
+          ptrCurrent++;
+
+          *ptrCurrent = m_lut[*ptrCurrent].R;
+          ptrCurrent++;
+          *ptrCurrent = m_lut[*ptrCurrent].G;
+          ptrCurrent++;
+          *ptrCurrent = m_lut[*ptrCurrent].B;
+          ptrCurrent++;
+          *ptrCurrent = m_lut[*ptrCurrent].A;
+          ptrCurrent++;
+        }
+      }
 
-    if(end_index - start_index >= 4*2) {
-      //Unroll loop version
-      for(; ptrCurrent <= ptrEnd - 4*2;) {
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent].R;
-        ptrCurrent++;
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent].G;
-        ptrCurrent++;
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent].B;
-        ptrCurrent++;
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent].A;
+      while(ptrCurrent != ptrEnd) {
+        *ptrCurrent = m_lut[*ptrCurrent].R;
         ptrCurrent++;
 
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent].R;
-        ptrCurrent++;
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent].G;
+        *ptrCurrent = m_lut[*ptrCurrent].G;
         ptrCurrent++;
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent].B;
+
+        *ptrCurrent = m_lut[*ptrCurrent].B;
         ptrCurrent++;
-        *ptrCurrent = imageLut_param->m_lut[*ptrCurrent].A;
+
+        *ptrCurrent = m_lut[*ptrCurrent].A;
         ptrCurrent++;
       }
     }
 
-    while(ptrCurrent != ptrEnd) {
-      *ptrCurrent = imageLut_param->m_lut[*ptrCurrent].R;
-      ptrCurrent++;
-
-      *ptrCurrent = imageLut_param->m_lut[*ptrCurrent].G;
-      ptrCurrent++;
-
-      *ptrCurrent = imageLut_param->m_lut[*ptrCurrent].B;
-      ptrCurrent++;
-
-      *ptrCurrent = imageLut_param->m_lut[*ptrCurrent].A;
-      ptrCurrent++;
-    }
-
-    return 0;
-  }
+  private:
+    unsigned char *m_bitmap;
+    const vpRGBa (&m_lut)[256];
+  };
 }
-#endif
 
 
 /*!
@@ -637,7 +639,9 @@ vpImage<Type>::init(unsigned int h, unsigned int w, Type value)
     throw ;
   }
 
-  for (unsigned int i=0  ; i < npixels ;  i++)
+  // The padding of the rows, if any, is also set
+  const unsigned int n = stride*height;
+  for (unsigned int i=0  ; i < n ;  i++)
     bitmap[i] = value ;
 }
 
@@ -662,6 +666,53 @@ vpImage<Type>::init(unsigned int h, unsigned int w, Type value)
 template<class Type>
 void
 vpImage<Type>::init(unsigned int h, unsigned int w)
+{
+  initBitmap(h, w, w);
+}
+
+/*!
+  \brief Image initialization with aligned rows
+
+  Allocate memory for an [h x w] image whose rows start on addresses aligned
+  on \e rowAlignment bytes. Each row is padded so that the number of elements
+  between two rows, given by getStride(), is the smallest one greater or equal
+  to \e w that keeps this alignment.
+
+  \param h : Image height.
+  \param w : Image width.
+  \param rowAlignment : Alignment in bytes. It must be a power of two that is
+  a multiple of the size of an element and that is lower or equal to
+  vpImageBufferPool::getAlignment().
+
+  Element of the bitmap are not initialized.
+
+  \exception vpException::badValue : If \e rowAlignment is not valid.
+  \exception vpException::memoryAllocationError
+
+  \sa isContiguous()
+*/
+template<class Type>
+void
+vpImage<Type>::initAligned(unsigned int h, unsigned int w, unsigned int rowAlignment)
+{
+  if (rowAlignment == 0 || (rowAlignment & (rowAlignment - 1)) != 0 || rowAlignment % sizeof(Type) != 0
+      || rowAlignment > vpImageBufferPool::getAlignment()) {
+    throw(vpException(vpException::badValue,
+                      "Cannot align the rows of the image on %d bytes", rowAlignment)) ;
+  }
+
+  const unsigned int rowSize = (unsigned int)((w*sizeof(Type) + rowAlignment - 1) & ~(rowAlignment - 1));
+  initBitmap(h, w, rowSize / (unsigned int)sizeof(Type));
+}
+
+/*!
+  Allocate memory for an [h x w] image with \e s elements between the first
+  pixels of two consecutive rows. The memory is kept if the layout does not
+  change.
+*/
+template<class Type>
+void
+vpImage<Type>::initBitmap(unsigned int h, unsigned int w, unsigned int s)
 {
   if (h != this->height) {
     if (row != NULL)  {
@@ -671,42 +722,52 @@ vpImage<Type>::init(unsigned int h, unsigned int w)
     }
   }
 
-  if ((h != this->height) || (w != this->width))
+  if ((h != this->height) || (w != this->width) || (s != this->stride))
   {
-    if (bitmap != NULL) {
-      vpDEBUG_TRACE(10,"Destruction bitmap[]") ;
-      delete [] bitmap;
-      bitmap = NULL;
-    }
+    vpDEBUG_TRACE(10,"Destruction bitmap[]") ;
+    releaseBitmap();
   }
 
   this->width = w ;
   this->height = h;
+  this->stride = s;
 
   npixels=width*height;
 
-  if (bitmap == NULL)  bitmap = new  Type[npixels] ;
-
-  //  vpERROR_TRACE("Allocate bitmap %p",bitmap) ;
-  if (bitmap == NULL)
-  {
-        vpERROR_TRACE("cannot allocate bitmap ") ;
-    throw(vpException(vpException::memoryAllocationError,
-          "cannot allocate bitmap ")) ;
+  if (bitmap == NULL) {
+    const size_t n = (size_t)stride*height;
+    buffer = static_cast<Type *>(vpImageBufferPool::getInstance().allocate(n*sizeof(Type)));
+    for (size_t i = 0; i < n; i++)
+      new (buffer + i) Type;
+    bitmap = buffer;
   }
 
   if (row == NULL)  row = new  Type*[height] ;
-//  vpERROR_TRACE("Allocate row %p",row) ;
-  if (row == NULL)
-  {
-    vpERROR_TRACE("cannot allocate row ") ;
-    throw(vpException(vpException::memoryAllocationError,
-          "cannot allocate row ")) ;
-  }
 
   unsigned int i ;
   for ( i =0  ; i < height ; i++)
-    row[i] = bitmap + i*width ;
+    row[i] = bitmap + i*stride ;
+}
+
+/*!
+  Give back the memory of the bitmap to vpImageBufferPool, or delete it if it
+  was given by the user.
+*/
+template<class Type>
+void
+vpImage<Type>::releaseBitmap()
+{
+  if (buffer != NULL) {
+    const size_t n = (size_t)stride*height;
+    for (size_t i = 0; i < n; i++)
+      buffer[i].~Type();
+    vpImageBufferPool::getInstance().deallocate(buffer, n*sizeof(Type));
+    buffer = NULL;
+  }
+  else if (bitmap != NULL) {
+    delete [] bitmap;
+  }
+  bitmap = NULL;
 }
 
 /*!
@@ -725,6 +786,14 @@ template<class Type>
 void
 vpImage<Type>::init(Type * const array, const unsigned int h, const unsigned int w, const bool copyData)
 {
+  if(copyData) {
+    init(h, w);
+
+    //Copy the image data
+    memcpy(bitmap, array, (size_t) (npixels * sizeof(Type)));
+    return;
+  }
+
   if (h != this->height) {
     if (row != NULL)  {
       delete [] row;
@@ -732,39 +801,18 @@ vpImage<Type>::init(Type * const array, const unsigned int h, const unsigned int
     }
   }
 
-  //Delete bitmap if copyData==false, otherwise only if the dimension differs
-  if ( (copyData && ((h != this->height) || (w != this->width))) || !copyData ) {
-    if (bitmap != NULL) {
-      delete [] bitmap;
-      bitmap = NULL;
-    }
-  }
+  releaseBitmap();
 
   this->width = w ;
   this->height = h;
+  this->stride = w;
 
   npixels = width*height;
 
-  if(copyData) {
-    if (bitmap == NULL)  bitmap = new  Type[npixels];
-
-    if (bitmap == NULL) {
-      throw(vpException(vpException::memoryAllocationError,
-            "cannot allocate bitmap ")) ;
-    }
-
-    //Copy the image data
-    memcpy(bitmap, array, (size_t) (npixels * sizeof(Type)));
-  } else {
-    //Copy the address of the array in the bitmap
-    bitmap = array;
-  }
+  //Copy the address of the array in the bitmap
+  bitmap = array;
 
   if (row == NULL)  row = new Type*[height];
-  if (row == NULL) {
-    throw(vpException(vpException::memoryAllocationError,
-          "cannot allocate row ")) ;
-  }
 
   for (unsigned int i = 0  ; i < height ; i++) {
     row[i] = bitmap + i*width;
@@ -791,7 +839,7 @@ vpImage<Type>::init(Type * const array, const unsigned int h, const unsigned int
 */
 template<class Type>
 vpImage<Type>::vpImage(unsigned int h, unsigned int w)
-  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL)
+  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), stride(0), row(NULL), buffer(NULL)
 {
   try
   {
@@ -822,7 +870,7 @@ vpImage<Type>::vpImage(unsigned int h, unsigned int w)
 */
 template<class Type>
 vpImage<Type>::vpImage (unsigned int h, unsigned int w, Type value)
-  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL)
+  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), stride(0), row(NULL), buffer(NULL)
 {
   try
   {
@@ -851,7 +899,7 @@ vpImage<Type>::vpImage (unsigned int h, unsigned int w, Type value)
 */
 template<class Type>
 vpImage<Type>::vpImage (Type * const array, const unsigned int h, const unsigned int w, const bool copyData)
-  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL)
+  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), stride(0), row(NULL), buffer(NULL)
 {
   try
   {
@@ -874,7 +922,7 @@ vpImage<Type>::vpImage (Type * const array, const unsigned int h, const unsigned
 */
 template<class Type>
 vpImage<Type>::vpImage()
-  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL)
+  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), stride(0), row(NULL), buffer(NULL)
 {
 }
 
@@ -961,13 +1009,7 @@ vpImage<Type>::destroy()
  //   vpERROR_TRACE("Deallocate ") ;
 
 
-  if (bitmap!=NULL)
-  {
-  //  vpERROR_TRACE("Deallocate bitmap memory %p",bitmap) ;
-//    vpDEBUG_TRACE(20,"Deallocate bitmap memory %p",bitmap) ;
-    delete [] bitmap ;
-    bitmap = NULL;
-  }
+  releaseBitmap();
 
 
   if (row!=NULL)
@@ -999,13 +1041,18 @@ vpImage<Type>::~vpImage()
 */
 template<class Type>
 vpImage<Type>::vpImage(const vpImage<Type>& I)
-  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), row(NULL)
+  : bitmap(NULL), display(NULL), npixels(0), width(0), height(0), stride(0), row(NULL), buffer(NULL)
 {
   try
   {
     resize(I.getHeight(),I.getWidth());
-    memcpy(bitmap, I.bitmap, I.npixels*sizeof(Type)) ;
-    for (unsigned int i =0  ; i < this->height ; i++) row[i] = bitmap + i*this->width ;
+    if (I.isContiguous()) {
+      memcpy(bitmap, I.bitmap, I.npixels*sizeof(Type)) ;
+    }
+    else {
+      for (unsigned int i =0  ; i < this->height ; i++)
+        memcpy((void *)row[i], I.row[i], this->width*sizeof(Type)) ;
+    }
   }
   catch(vpException &)
   {
@@ -1023,9 +1070,11 @@ template<class Type>
 Type vpImage<Type>::getMaxValue() const
 {
   Type m = bitmap[0] ;
-  for (unsigned int i=0 ; i < npixels ; i++)
+  for (unsigned int i=0 ; i < height ; i++)
   {
-    if (bitmap[i]>m) m = bitmap[i] ;
+    const Type *p = row[i];
+    for (unsigned int j=0 ; j < width ; j++)
+      if (p[j]>m) m = p[j] ;
   }
   return m ;
 }
@@ -1039,8 +1088,12 @@ template<class Type>
 Type vpImage<Type>::getMinValue() const
 {
   Type m =  bitmap[0];
-  for (unsigned int i=0 ; i < npixels ; i++)
-    if (bitmap[i]<m) m = bitmap[i] ;
+  for (unsigned int i=0 ; i < height ; i++)
+  {
+    const Type *p = row[i];
+    for (unsigned int j=0 ; j < width ; j++)
+      if (p[j]<m) m = p[j] ;
+  }
   return m ;
 }
 
@@ -1055,10 +1108,14 @@ template<class Type>
 void vpImage<Type>::getMinMaxValue(Type &min, Type &max) const
 {
   min = max =  bitmap[0];
-  for (unsigned int i=0 ; i < npixels ; i++)
+  for (unsigned int i=0 ; i < height ; i++)
   {
-    if (bitmap[i]<min) min = bitmap[i] ;
-    if (bitmap[i]>max) max = bitmap[i] ;
+    const Type *p = row[i];
+    for (unsigned int j=0 ; j < width ; j++)
+    {
+      if (p[j]<min) min = p[j] ;
+      if (p[j]>max) max = p[j] ;
+    }
   }
 }
 
@@ -1068,47 +1125,34 @@ void vpImage<Type>::getMinMaxValue(Type &min, Type &max) const
 template<class Type>
 vpImage<Type> & vpImage<Type>::operator=(const vpImage<Type> &I)
 {
-    /* we first have to set the initial values of the image because resize function calls init function that test the actual size of the image */
-  if(bitmap != NULL){
-    delete[] bitmap;
-    bitmap = NULL ;
-  }
+  if (this == &I)
+    return (* this);
 
-  if(row != NULL){
-    delete[] row;
-    row = NULL ;
+  if (I.npixels == 0)
+  {
+    releaseBitmap();
+    if(row != NULL){
+      delete[] row;
+      row = NULL ;
+    }
+    this->width = I.width;
+    this->height = I.height;
+    this->stride = I.width;
+    this->npixels = I.npixels;
+    return (* this);
   }
-  this->width = I.width;
-  this->height = I.height;
-  this->npixels = I.npixels;
+
   try
   {
-    if(I.npixels != 0)
-    {
-      if (bitmap == NULL){
-        bitmap = new  Type[npixels] ;
-      }
-
-      if (bitmap == NULL){
-            vpERROR_TRACE("cannot allocate bitmap ") ;
-        throw(vpException(vpException::memoryAllocationError,
-              "cannot allocate bitmap ")) ;
-      }
-
-      if (row == NULL){
-        row = new  Type*[height] ;
-      }
-      if (row == NULL){
-        vpERROR_TRACE("cannot allocate row ") ;
-        throw(vpException(vpException::memoryAllocationError,
-              "cannot allocate row ")) ;
-      }
+    // The memory is reused if the size does not change
+    init(I.height, I.width);
 
+    if (I.isContiguous()) {
       memcpy(bitmap, I.bitmap, I.npixels*sizeof(Type)) ;
-
-      for (unsigned int i=0; i<this->height; i++){
-        row[i] = bitmap + i*this->width;
-      }
+    }
+    else {
+      for (unsigned int i=0; i<this->height; i++)
+        memcpy((void *)row[i], I.row[i], this->width*sizeof(Type)) ;
     }
   }
   catch(vpException &)
@@ -1129,7 +1173,8 @@ vpImage<Type> & vpImage<Type>::operator=(const vpImage<Type> &I)
 template<class Type>
 vpImage<Type>& vpImage<Type>::operator=(const Type &v)
 {
-  for (unsigned int i=0 ; i < npixels ; i++)
+  const unsigned int n = stride*height;
+  for (unsigned int i=0 ; i < n ; i++)
     bitmap[i] = v ;
 
   return *this;
@@ -1149,11 +1194,15 @@ bool vpImage<Type>::operator==(const vpImage<Type> &I)
     return false;
 
 //  printf("wxh: %dx%d bitmap: %p I.bitmap %p\n", width, height, bitmap, I.bitmap);
-  for (unsigned int i=0 ; i < npixels ; i++)
+  for (unsigned int i=0 ; i < height ; i++)
   {
-    if (bitmap[i] != I.bitmap[i]) {
-//      std::cout << "differ for pixel " << i << " (" << i%this->height << ", " << i - i%this->height << ")" << std::endl;
-      return false;
+    Type *p = row[i];
+    Type *q = I.row[i];
+    for (unsigned int j=0 ; j < width ; j++)
+    {
+      if (p[j] != q[j]) {
+        return false;
+      }
     }
   }
   return true ;
@@ -1267,8 +1316,8 @@ void vpImage<Type>::insert(const vpImage<Type> &src, const vpImagePoint topLeft)
 
   for (int i = 0; i < hsize; i++)
   {
-    srcBitmap = src.bitmap + ((src_ibegin+i)*src_w+src_jbegin);
-    destBitmap = this->bitmap + ((dest_ibegin+i)*dest_w+dest_jbegin);
+    srcBitmap = src.row[src_ibegin+i] + src_jbegin;
+    destBitmap = this->row[dest_ibegin+i] + dest_jbegin;
 
     memcpy(destBitmap, srcBitmap, (size_t)wsize*sizeof(Type));
   }
@@ -1785,9 +1834,10 @@ void vpImage<Type>::sub(const vpImage<Type> &B, vpImage<Type> &C)
           "vpImage mismatch in vpImage/vpImage substraction ")) ;
   }
 
-  for (unsigned int i=0;i<this->getWidth()*this->getHeight();i++)
+  for (unsigned int i=0;i<this->getHeight();i++)
   {
-    *(C.bitmap + i) = *(bitmap + i) - *(B.bitmap + i) ;
+    for (unsigned int j=0;j<this->getWidth();j++)
+      C.row[i][j] = row[i][j] - B.row[i][j] ;
   }
 }
 
@@ -1827,9 +1877,10 @@ void vpImage<Type>::sub(const vpImage<Type> &A, const vpImage<Type> &B,
                       "vpImage mismatch in vpImage/vpImage substraction ")) ;
   }
 
-  for (unsigned int i=0;i<A.getWidth()*A.getHeight();i++)
+  for (unsigned int i=0;i<A.getHeight();i++)
   {
-    *(C.bitmap + i) = *(A.bitmap + i) - *(B.bitmap + i) ;
+    for (unsigned int j=0;j<A.getWidth();j++)
+      C.row[i][j] = A.row[i][j] - B.row[i][j] ;
   }
 }
 
@@ -1857,7 +1908,8 @@ void vpImage<Type>::performLut(const Type (&)[256], const unsigned int)
 */
 template<>
 inline void vpImage<unsigned char>::performLut(const unsigned char (&lut)[256], const unsigned int nbThreads) {
-  unsigned int size = getWidth()*getHeight();
+  // The padding of the rows, if any, is also transformed
+  unsigned int size = stride*height;
   unsigned char *ptrStart = (unsigned char*) bitmap;
   unsigned char *ptrEnd = ptrStart + size;
   unsigned char *ptrCurrent = ptrStart;
@@ -1868,7 +1920,7 @@ inline void vpImage<unsigned char>::performLut(const unsigned char (&lut)[256],
   use_single_thread = true;
 #endif
 
-  if(!use_single_thread && getSize() <= nbThreads) {
+  if(!use_single_thread && size <= nbThreads) {
     use_single_thread = true;
   }
 
@@ -1881,52 +1933,10 @@ inline void vpImage<unsigned char>::performLut(const unsigned char (&lut)[256],
       ++ptrCurrent;
     }
   } else {
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
     //Multi-threads
-
-    std::vector<vpThread *> threadpool;
-    std::vector<ImageLut_Param_t *> imageLutParams;
-
-    ImageLut_Param_t *imageLut_param = NULL;
-    vpThread *imageLut_thread = NULL;
-
-    unsigned int image_size = getSize();
-    unsigned int step = image_size / nbThreads;
-    unsigned int last_step = image_size - step * (nbThreads-1);
-
-    for(unsigned int index = 0; index < nbThreads; index++) {
-      unsigned int start_index = index*step;
-      unsigned int end_index = (index+1)*step;
-
-      if(index == nbThreads-1) {
-        end_index = start_index+last_step;
-      }
-
-      imageLut_param = new ImageLut_Param_t(start_index, end_index, bitmap);
-      memcpy(imageLut_param->m_lut, lut, 256*sizeof(unsigned char));
-
-      imageLutParams.push_back(imageLut_param);
-
-      // Start the threads
-      imageLut_thread = new vpThread((vpThread::Fn) performLutThread, (vpThread::Args) imageLut_param);
-      threadpool.push_back(imageLut_thread);
-    }
-
-    for(size_t cpt = 0; cpt < threadpool.size(); cpt++) {
-      // Wait until thread ends up
-      threadpool[cpt]->join();
-    }
-
-
-    //Delete
-    for(size_t cpt = 0; cpt < threadpool.size(); cpt++) {
-      delete threadpool[cpt];
-    }
-
-    for(size_t cpt = 0; cpt < imageLutParams.size(); cpt++) {
-      delete imageLutParams[cpt];
-    }
-#endif
+    unsigned int image_size = size;
+    vpImageLutTask task(bitmap, lut);
+    vpThreadPool::getInstance().parallelFor(0, image_size, task, (image_size + nbThreads - 1) / nbThreads, nbThreads);
   }
 }
 
@@ -1938,7 +1948,8 @@ inline void vpImage<unsigned char>::performLut(const unsigned char (&lut)[256],
 */
 template<>
 inline void vpImage<vpRGBa>::performLut(const vpRGBa (&lut)[256], const unsigned int nbThreads) {
-  unsigned int size = getWidth()*getHeight();
+  // The padding of the rows, if any, is also transformed
+  unsigned int size = stride*height;
   unsigned char *ptrStart = (unsigned char*) bitmap;
   unsigned char *ptrEnd = ptrStart + size*4;
   unsigned char *ptrCurrent = ptrStart;
@@ -1949,7 +1960,7 @@ inline void vpImage<vpRGBa>::performLut(const vpRGBa (&lut)[256], const unsigned
   use_single_thread = true;
 #endif
 
-  if(!use_single_thread && getSize() <= nbThreads) {
+  if(!use_single_thread && size <= nbThreads) {
     use_single_thread = true;
   }
 
@@ -1970,51 +1981,10 @@ inline void vpImage<vpRGBa>::performLut(const vpRGBa (&lut)[256], const unsigned
       ++ptrCurrent;
     }
   } else {
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
     //Multi-threads
-    std::vector<vpThread *> threadpool;
-    std::vector<ImageLutRGBa_Param_t *> imageLutParams;
-
-    ImageLutRGBa_Param_t *imageLut_param = NULL;
-    vpThread *imageLut_thread = NULL;
-
-    unsigned int image_size = getSize();
-    unsigned int step = image_size / nbThreads;
-    unsigned int last_step = image_size - step * (nbThreads-1);
-
-    for(unsigned int index = 0; index < nbThreads; index++) {
-      unsigned int start_index = index*step;
-      unsigned int end_index = (index+1)*step;
-
-      if(index == nbThreads-1) {
-        end_index = start_index+last_step;
-      }
-
-      imageLut_param = new ImageLutRGBa_Param_t(start_index, end_index, (unsigned char *) bitmap);
-      memcpy(imageLut_param->m_lut, lut, 256*sizeof(vpRGBa));
-
-      imageLutParams.push_back(imageLut_param);
-
-      // Start the threads
-      imageLut_thread = new vpThread((vpThread::Fn) performLutRGBaThread, (vpThread::Args) imageLut_param);
-      threadpool.push_back(imageLut_thread);
-    }
-
-    for(size_t cpt = 0; cpt < threadpool.size(); cpt++) {
-      // Wait until thread ends up
-      threadpool[cpt]->join();
-    }
-
-
-    //Delete
-    for(size_t cpt = 0; cpt < threadpool.size(); cpt++) {
-      delete threadpool[cpt];
-    }
-
-    for(size_t cpt = 0; cpt < imageLutParams.size(); cpt++) {
-      delete imageLutParams[cpt];
-    }
-#endif
+    unsigned int image_size = size;
+    vpImageLutRGBaTask task((unsigned char *) bitmap, lut);
+    vpThreadPool::getInstance().parallelFor(0, image_size, task, (image_size + nbThreads - 1) / nbThreads, nbThreads);
   }
 }
 
@@ -0,0 +1,120 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Process-wide pool of aligned image buffers.
+ *
+ *****************************************************************************/
+
+#ifndef __vpImageBufferPool_h_
+#define __vpImageBufferPool_h_
+
+/*!
+  \file vpImageBufferPool.h
+  \brief Process-wide pool of aligned image buffers.
+*/
+
+#include <stddef.h>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpException.h>
+
+/*!
+  \class vpImageBufferPool
+  \ingroup group_core_image
+
+  \brief Process-wide pool of memory blocks aligned on getAlignment() bytes,
+  used to store the pixels of the vpImage instances.
+
+  When an image is destroyed or resized, its block is given back to the pool
+  instead of being freed, and the next image of the same size in bytes
+  reuses it. Processing loops that create temporary images for each frame,
+  or that read frames of a constant size, thus no more call the system
+  allocator once the first frames have been processed.
+
+  The blocks kept for later reuse are bounded by getCapacity() bytes. Beyond
+  this size the released blocks are freed. Setting the capacity to 0
+  disables the recycling; the blocks are still aligned.
+
+  The pool can be used from several threads.
+
+  \code
+#include <visp3/core/vpImage.h>
+
+int main()
+{
+  // Keep at most 32 MB of unused image memory
+  vpImageBufferPool::getInstance().setCapacity(32 << 20);
+
+  for (unsigned int i = 0; i < 100; i++) {
+    vpImage<unsigned char> I(480, 640); // Only the first image is allocated by the system
+  }
+
+  // Free the unused blocks
+  vpImageBufferPool::getInstance().clear();
+}
+  \endcode
+*/
+class VISP_EXPORT vpImageBufferPool
+{
+public:
+  static vpImageBufferPool &getInstance();
+
+  void *allocate(const size_t size);
+  void clear();
+  void deallocate(void *ptr, const size_t size);
+
+  /*!
+    Return the alignment in bytes of the blocks returned by allocate(). It
+    matches the size of a cache line and of an AVX-512 register.
+  */
+  static size_t getAlignment() { return 64; }
+  size_t getCachedSize() const;
+  /*!
+    Return the maximum number of bytes kept in the pool for later reuse.
+  */
+  inline size_t getCapacity() const { return m_capacity; }
+
+  void setCapacity(const size_t capacity);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  class Impl;
+#endif
+
+private:
+  vpImageBufferPool();
+  ~vpImageBufferPool();
+  vpImageBufferPool(const vpImageBufferPool &); // not implemented
+  vpImageBufferPool &operator=(const vpImageBufferPool &); // not implemented
+
+  Impl *m_impl;
+  size_t m_capacity;
+};
+
+#endif
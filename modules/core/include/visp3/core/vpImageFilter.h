@@ -63,17 +63,57 @@
 
   \brief  Various image filter, convolution, etc...
 
+  The separable filters (filter() with a kernel array, gaussianBlur(), getGradX()
+  and getGradY() with a kernel array, getGradXGauss2D() and getGradYGauss2D())
+  are computed row by row: the rows filtered along X are kept in a small cache
+  of kernel size rows instead of a full intermediate image, the inner loops
+  work on contiguous rows with SSE2 or AVX2 instructions, and large images are
+  split in bands of rows over the threads of vpThreadPool. Besides the double
+  versions, which give the same results as the per pixel helpers filterX() and
+  filterY(), these filters have float versions that halve the memory traffic,
+  and gaussianBlur() has a fixed-point version from and to 8 bits images.
+  The output images are only reallocated when their size changes, so that they
+  can be reused from one frame to the next.
+
+  \code
+#include <visp3/core/vpImageFilter.h>
+
+int main()
+{
+  vpImage<unsigned char> I(480, 640, 128);
+  const unsigned int size = 7;
+  float fg[(size+1)/2], fgd[(size+1)/2];
+  vpImageFilter::getGaussianKernel(fg, size);
+  vpImageFilter::getGaussianDerivativeKernel(fgd, size);
+
+  vpImage<float> dIx, dIy;
+  // for each new image I
+  vpImageFilter::getGradXGauss2D(I, dIx, fg, fgd, size);
+  vpImageFilter::getGradYGauss2D(I, dIy, fg, fgd, size);
+}
+  \endcode
 */
 class VISP_EXPORT vpImageFilter
 {
 public:
-#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+  /*! Implementation of the Canny edge detector. */
+  typedef enum {
+    CANNY_OPENCV_BACKEND, /*!< cv::Canny(), only available when ViSP is built with OpenCV */
+    CANNY_VISP_BACKEND    /*!< Native implementation */
+  } vpCannyBackendType;
+
   static void canny(const vpImage<unsigned char>& I,
                     vpImage<unsigned char>& Ic,
                     const unsigned int gaussianFilterSize,
                     const double thresholdCanny,
                     const unsigned int apertureSobel);
-#endif
+  static void canny(const vpImage<unsigned char>& I,
+                    vpImage<unsigned char>& Ic,
+                    const unsigned int gaussianFilterSize,
+                    const double lowerThreshold,
+                    const double upperThreshold,
+                    const unsigned int apertureSobel,
+                    const vpCannyBackendType backend = CANNY_VISP_BACKEND);
 
   /*!
    Apply a 1x3 derivative filter to an image pixel.
@@ -184,6 +224,8 @@ public:
 
   static void filter(const vpImage<unsigned char> &I, vpImage<double>& GI, const double *filter,unsigned  int size);
   static void filter(const vpImage<double> &I, vpImage<double>& GI, const double *filter,unsigned  int size);
+  static void filter(const vpImage<unsigned char> &I, vpImage<float>& GI, const float *filter, unsigned int size);
+  static void filter(const vpImage<float> &I, vpImage<float>& GI, const float *filter, unsigned int size);
 
   static inline unsigned char filterGaussXPyramidal(const vpImage<unsigned char> &I, unsigned int i, unsigned int j)
   {
@@ -398,6 +440,8 @@ public:
 
   static void gaussianBlur(const vpImage<unsigned char> &I, vpImage<double>& GI, unsigned int size=7, double sigma=0., bool normalize=true);
   static void gaussianBlur(const vpImage<double> &I, vpImage<double>& GI, unsigned int size=7, double sigma=0., bool normalize=true);
+  static void gaussianBlur(const vpImage<unsigned char> &I, vpImage<float>& GI, unsigned int size=7, double sigma=0., bool normalize=true);
+  static void gaussianBlur(const vpImage<unsigned char> &I, vpImage<unsigned char>& GI, unsigned int size=7, double sigma=0., bool normalize=true);
   /*!
    Apply a 5x5 Gaussian filter to an image pixel.
 
@@ -428,6 +472,8 @@ public:
 
   static void getGaussianKernel(double *filter, unsigned int size, double sigma=0., bool normalize=true);
   static void getGaussianDerivativeKernel(double *filter, unsigned int size, double sigma=0., bool normalize=true);
+  static void getGaussianKernel(float *filter, unsigned int size, double sigma=0., bool normalize=true);
+  static void getGaussianDerivativeKernel(float *filter, unsigned int size, double sigma=0., bool normalize=true);
 
   //fonction renvoyant le gradient en X de l'image I pour traitement pyramidal => dimension /2
   static void getGradX(const vpImage<unsigned char> &I, vpImage<double>& dIx);
@@ -435,6 +481,9 @@ public:
   static void getGradX(const vpImage<double> &I, vpImage<double>& dIx, const double *filter, unsigned int size);
   static void getGradXGauss2D(const vpImage<unsigned char> &I, vpImage<double>& dIx, const double *gaussianKernel,
                               const double *gaussianDerivativeKernel, unsigned  int size);
+  static void getGradX(const vpImage<unsigned char> &I, vpImage<float>& dIx, const float *filter, unsigned int size);
+  static void getGradXGauss2D(const vpImage<unsigned char> &I, vpImage<float>& dIx, const float *gaussianKernel,
+                              const float *gaussianDerivativeKernel, unsigned int size);
 
   //fonction renvoyant le gradient en Y de l'image I
   static void getGradY(const vpImage<unsigned char> &I, vpImage<double>& dIy);
@@ -442,6 +491,9 @@ public:
   static void getGradY(const vpImage<double> &I, vpImage<double>& dIy, const double *filter, unsigned int size);
   static void getGradYGauss2D(const vpImage<unsigned char> &I, vpImage<double>& dIy, const double *gaussianKernel,
                               const double *gaussianDerivativeKernel,unsigned  int size);
+  static void getGradY(const vpImage<unsigned char> &I, vpImage<float>& dIy, const float *filter, unsigned int size);
+  static void getGradYGauss2D(const vpImage<unsigned char> &I, vpImage<float>& dIy, const float *gaussianKernel,
+                              const float *gaussianDerivativeKernel, unsigned int size);
 };
 
 
@@ -0,0 +1,123 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Pyramid of images with preallocated levels.
+ *
+ *****************************************************************************/
+
+#ifndef __vpImagePyramid_h_
+#define __vpImagePyramid_h_
+
+/*!
+  \file vpImagePyramid.h
+  \brief Pyramid of images with preallocated levels.
+*/
+
+#include <vector>
+
+#include <visp3/core/vpImage.h>
+
+/*!
+  \class vpImagePyramid
+  \ingroup group_core_image
+
+  \brief Pyramid of grey level images, each level being half the size of the
+  previous one.
+
+  The levels are kept from one call of build() to the next one, so that a
+  tracker that builds the pyramid of every new frame does not reallocate them
+  as long as the image size does not change. The first level is the image
+  given to build(): it is not copied and must outlive the use of the pyramid.
+
+  Each call to build() increments a generation counter. Several trackers
+  working on the same frame can share one pyramid, build it once and check
+  with getGeneration() whether the data they derived from the levels (image
+  gradients for instance) are still up to date.
+
+  \code
+#include <visp3/core/vpImagePyramid.h>
+
+int main()
+{
+  vpImagePyramid pyramid(3);
+  vpImage<unsigned char> I(480, 640, 128);
+
+  // for each new image I
+  pyramid.build(I);
+  const vpImage<unsigned char> &I2 = pyramid[2]; // 120x160 image
+}
+  \endcode
+*/
+class VISP_EXPORT vpImagePyramid
+{
+public:
+  /*! Computation of a level from the previous one. */
+  typedef enum {
+    GAUSSIAN_REDUCTION,   /*!< Gaussian smoothing then subsampling, see vpImageFilter::getGaussPyramidal(). */
+    SUBSAMPLING_REDUCTION /*!< One pixel over two in each direction, without smoothing. */
+  } vpReductionType;
+
+  explicit vpImagePyramid(const unsigned int nbLevels = 1, const vpReductionType type = GAUSSIAN_REDUCTION);
+
+  void build(const vpImage<unsigned char> &I);
+  void clear();
+
+  /*!
+    Return the number of times the pyramid was built. Two consumers of the
+    same pyramid can compare it to know whether it was built from a new image.
+  */
+  inline unsigned long getGeneration() const { return m_generation; }
+  const vpImage<unsigned char> &getLevel(const unsigned int level) const;
+  //! Return the number of levels, the first one being the full resolution image.
+  inline unsigned int getNbLevels() const { return m_nbLevels; }
+  //! Return how a level is computed from the previous one.
+  inline vpReductionType getReductionType() const { return m_type; }
+  //! Return true if build() was called since the construction or the last call to clear().
+  inline bool isBuilt() const { return m_base != NULL; }
+
+  void setNbLevels(const unsigned int nbLevels);
+  void setReductionType(const vpReductionType type);
+
+  //! Return the image of the given level, see getLevel().
+  inline const vpImage<unsigned char> &operator[](const unsigned int level) const { return getLevel(level); }
+
+  static void subsample(const vpImage<unsigned char> &I, vpImage<unsigned char> &Isub);
+
+private:
+  unsigned int m_nbLevels;
+  vpReductionType m_type;
+  //! Full resolution image, not owned
+  const vpImage<unsigned char> *m_base;
+  //! Levels 1 to m_nbLevels-1, the first element is unused
+  std::vector< vpImage<unsigned char> > m_levels;
+  unsigned long m_generation;
+};
+
+#endif
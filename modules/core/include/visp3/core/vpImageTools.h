@@ -49,14 +49,11 @@
 
 #include <visp3/core/vpImage.h>
 
-#ifdef VISP_HAVE_PTHREAD
-#  include <pthread.h>
-#endif
-
 #include <visp3/core/vpImageException.h>
 #include <visp3/core/vpMath.h>
 #include <visp3/core/vpRect.h>
 #include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpThreadPool.h>
 
 #include <fstream>
 #include <iostream>
@@ -153,7 +150,8 @@ public:
   template<class Type>
   static void undistort(const vpImage<Type> &I,
                         const vpCameraParameters &cam,
-                        vpImage<Type> &newI);
+                        vpImage<Type> &newI,
+                        const unsigned int nThreads=2);
 
 #if defined(VISP_BUILD_DEPRECATED_FUNCTIONS)
   /*!
@@ -477,114 +475,81 @@ inline void vpImageTools::binarise(vpImage<unsigned char> &I,
   }
 }
 
-#ifdef VISP_HAVE_PTHREAD
-
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 template<class Type>
-class vpUndistortInternalType
+class vpUndistortTask : public vpThreadPool::Task
 {
 public:
-  Type *src;
-  Type *dst;
-  unsigned int width;
-  unsigned int height;
-  vpCameraParameters cam;
-  unsigned int nthreads;
-  unsigned int threadid;
-public:
-  vpUndistortInternalType()
-    : src(NULL), dst(NULL), width(0), height(0), cam(), nthreads(0), threadid(0)
-  {};
-
-  vpUndistortInternalType(const vpUndistortInternalType<Type> &u) {
-    *this = u;
-  };
-  vpUndistortInternalType &operator=(const vpUndistortInternalType<Type> &u) {
-    src = u.src;
-    dst = u.dst;
-    width = u.width;
-    height = u.height;
-    cam = u.cam;
-    nthreads = u.nthreads;
-    threadid = u.threadid;
-
-    return *this;
+  vpUndistortTask(const vpImage<Type> &I, const vpCameraParameters &cam, vpImage<Type> &undistI)
+    : m_src(I.bitmap), m_dst(undistI), m_width((int) I.getWidth()), m_height((int) I.getHeight()),
+      m_stride((int) I.getStride()), m_u0(cam.get_u0()), m_v0(cam.get_v0()), m_kud_px2(0.0), m_kud_py2(0.0)
+  {
+    double invpx = 1.0/cam.get_px();
+    double invpy = 1.0/cam.get_py();
+
+    m_kud_px2 = cam.get_kud() * invpx * invpx;
+    m_kud_py2 = cam.get_kud() * invpy * invpy;
   }
 
-  static void *vpUndistort_threaded(void *arg);
-};
-
-
-template<class Type>
-void *vpUndistortInternalType<Type>::vpUndistort_threaded(void *arg)
-{
-  vpUndistortInternalType<Type> *undistortSharedData = (vpUndistortInternalType<Type>*)arg;
-  int offset   = (int)undistortSharedData->threadid;
-  int width    = (int)undistortSharedData->width;
-  int height   = (int)undistortSharedData->height;
-  int nthreads = (int)undistortSharedData->nthreads;
-
-  double u0 = undistortSharedData->cam.get_u0();
-  double v0 = undistortSharedData->cam.get_v0();
-  double px = undistortSharedData->cam.get_px();
-  double py = undistortSharedData->cam.get_py();
-  double kud = undistortSharedData->cam.get_kud();
-
-  double invpx = 1.0/px;
-  double invpy = 1.0/py;
-
-  double kud_px2 = kud * invpx * invpx;
-  double kud_py2 = kud * invpy * invpy;
-
-  Type *dst = undistortSharedData->dst+(height/nthreads*offset)*width;
-  Type *src = undistortSharedData->src;
-
-  for (double v = height/nthreads*offset;v < height/nthreads*(offset+1) ; v++) {
-    double  deltav  = v - v0;
-    //double fr1 = 1.0 + kd * (vpMath::sqr(deltav * invpy));
-    double fr1 = 1.0 + kud_py2 * deltav * deltav;
-
-    for (double u = 0 ; u < width ; u++) {
-      //computation of u,v : corresponding pixel coordinates in I.
-      double  deltau  = u - u0;
-      //double fr2 = fr1 + kd * (vpMath::sqr(deltau * invpx));
-      double fr2 = fr1 + kud_px2 * deltau * deltau;
-
-      double u_double = deltau * fr2 + u0;
-      double v_double = deltav * fr2 + v0;
-
-      //computation of the bilinear interpolation
-
-      //declarations
-      int u_round  = (int) (u_double);
-      int v_round  = (int) (v_double);
-      if (u_round < 0.f) u_round = -1;
-      if (v_round < 0.f) v_round = -1;
-      double  du_double  = (u_double) - (double) u_round;
-      double  dv_double  = (v_double) - (double) v_round;
-      Type v01;
-      Type v23;
-      if ( (0 <= u_round) && (0 <= v_round) &&
-           (u_round < ((width) - 1)) && (v_round < ((height) - 1)) ) {
-        //process interpolation
-        const Type* _mp = &src[v_round*width+u_round];
-        v01 = (Type)(_mp[0] + ((_mp[1] - _mp[0]) * du_double));
-        _mp += width;
-        v23 = (Type)(_mp[0] + ((_mp[1] - _mp[0]) * du_double));
-        *dst = (Type)(v01 + ((v23 - v01) * dv_double));
-      }
-      else {
-        *dst = 0;
+  //! Undistort the rows in [begin, end).
+  void operator()(const unsigned int begin, const unsigned int end)
+  {
+    for (unsigned int i = begin; i < end ; i++) {
+      double v = i;
+      Type *dst = m_dst[i];
+      double  deltav  = v - m_v0;
+      //double fr1 = 1.0 + kd * (vpMath::sqr(deltav * invpy));
+      double fr1 = 1.0 + m_kud_py2 * deltav * deltav;
+
+      for (double u = 0 ; u < m_width ; u++) {
+        //computation of u,v : corresponding pixel coordinates in I.
+        double  deltau  = u - m_u0;
+        //double fr2 = fr1 + kd * (vpMath::sqr(deltau * invpx));
+        double fr2 = fr1 + m_kud_px2 * deltau * deltau;
+
+        double u_double = deltau * fr2 + m_u0;
+        double v_double = deltav * fr2 + m_v0;
+
+        //computation of the bilinear interpolation
+
+        //declarations
+        int u_round  = (int) (u_double);
+        int v_round  = (int) (v_double);
+        if (u_round < 0.f) u_round = -1;
+        if (v_round < 0.f) v_round = -1;
+        double  du_double  = (u_double) - (double) u_round;
+        double  dv_double  = (v_double) - (double) v_round;
+        Type v01;
+        Type v23;
+        if ( (0 <= u_round) && (0 <= v_round) &&
+             (u_round < (m_width - 1)) && (v_round < (m_height - 1)) ) {
+          //process interpolation
+          const Type* _mp = &m_src[v_round*m_stride+u_round];
+          v01 = (Type)(_mp[0] + ((_mp[1] - _mp[0]) * du_double));
+          _mp += m_stride;
+          v23 = (Type)(_mp[0] + ((_mp[1] - _mp[0]) * du_double));
+          *dst = (Type)(v01 + ((v23 - v01) * dv_double));
+        }
+        else {
+          *dst = 0;
+        }
+        dst++;
       }
-      dst++;
     }
   }
 
-  pthread_exit((void*) 0);
-  return NULL;
-}
+private:
+  const Type *m_src;
+  vpImage<Type> &m_dst;
+  int m_width;
+  int m_height;
+  int m_stride;
+  double m_u0;
+  double m_v0;
+  double m_kud_px2;
+  double m_kud_py2;
+};
 #endif // DOXYGEN_SHOULD_SKIP_THIS
-#endif // VISP_HAVE_PTHREAD
 
 /*!
   Undistort an image
@@ -598,22 +563,27 @@ void *vpUndistortInternalType<Type>::vpUndistort_threaded(void *arg)
   parameter \f$K_d\f$ is null (see cam.get_kd_mp()), \e undistI is
   just a copy of \e I.
 
+  \param nThreads : Number of threads used to process bands of rows. The threads are
+  taken from vpThreadPool. If 0, vpThreadPool::getNumThreads() threads are used.
+
   \warning This function works only with Types authorizing "+,-,
   multiplication by a scalar" operators.
 
   \warning This function is time consuming :
     - On "Rhea"(Intel Core 2 Extreme X6800 2.93GHz, 2Go RAM)
       or "Charon"(Intel Xeon 3 GHz, 2Go RAM) : ~8 ms for a 640x480 image.
+
+  To undistort a sequence of images of the same camera, vpImageUndistortMap
+  computes the distortion model once and is much faster.
+
+  \sa vpImageUndistortMap
 */
 template<class Type>
 void vpImageTools::undistort(const vpImage<Type> &I,
                              const vpCameraParameters &cam,
-                             vpImage<Type> &undistI)
+                             vpImage<Type> &undistI,
+                             const unsigned int nThreads)
 {
-#ifdef VISP_HAVE_PTHREAD
-  //
-  // Optimized version using pthreads
-  //
   unsigned int width = I.getWidth();
   unsigned int height = I.getHeight();
 
@@ -628,114 +598,14 @@ void vpImageTools::undistort(const vpImage<Type> &I,
     return;
   }
 
-  unsigned int nthreads = 2;
-  pthread_attr_t attr;
-  pthread_t *callThd = new pthread_t [nthreads];
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  vpUndistortInternalType<Type> *undistortSharedData;
-  undistortSharedData = new vpUndistortInternalType<Type> [nthreads];
-
-  for(unsigned int i=0;i<nthreads;i++) {
-    // Each thread works on a different set of data.
-    //    vpTRACE("create thread %d", i);
-    undistortSharedData[i].src      = I.bitmap;
-    undistortSharedData[i].dst      = undistI.bitmap;
-    undistortSharedData[i].width    = I.getWidth();
-    undistortSharedData[i].height   = I.getHeight();
-    undistortSharedData[i].cam      = cam;
-    undistortSharedData[i].nthreads = nthreads;
-    undistortSharedData[i].threadid = i;
-    pthread_create( &callThd[i], &attr,
-                    &vpUndistortInternalType<Type>::vpUndistort_threaded,
-                    &undistortSharedData[i]);
+  vpUndistortTask<Type> task(I, cam, undistI);
+  if (nThreads == 1) {
+    task(0, height);
   }
-  pthread_attr_destroy(&attr);
-  /* Wait on the other threads */
-
-  for(unsigned int i=0;i<nthreads;i++) {
-    //  vpTRACE("join thread %d", i);
-    pthread_join( callThd[i], NULL);
-  }
-
-  delete [] callThd;
-  delete [] undistortSharedData;
-#else // VISP_HAVE_PTHREAD
-  //
-  // optimized version without pthreads
-  //
-  unsigned int width = I.getWidth();
-  unsigned int height = I.getHeight();
-
-  undistI.resize(height, width);
-
-  double u0 = cam.get_u0();
-  double v0 = cam.get_v0();
-  double px = cam.get_px();
-  double py = cam.get_py();
-  double kud = cam.get_kud();
-
-  //if (kud == 0) {
-  if (std::fabs(kud) <= std::numeric_limits<double>::epsilon()) {
-    // There is no need to undistort the image
-    undistI = I;
-    return;
-  }
-
-  double invpx = 1.0/px;
-  double invpy = 1.0/py;
-
-  double kud_px2 = kud * invpx * invpx;
-  double kud_py2 = kud * invpy * invpy;
-
-  Type *dst = undistI.bitmap;
-  for (double v = 0;v < height ; v++) {
-    double  deltav  = v - v0;
-    //double fr1 = 1.0 + kd * (vpMath::sqr(deltav * invpy));
-    double fr1 = 1.0 + kud_py2 * deltav * deltav;
-
-    for (double u = 0 ; u < width ; u++) {
-      //computation of u,v : corresponding pixel coordinates in I.
-      double  deltau  = u - u0;
-      //double fr2 = fr1 + kd * (vpMath::sqr(deltau * invpx));
-      double fr2 = fr1 + kud_px2 * deltau * deltau;
-
-      double u_double = deltau * fr2 + u0;
-      double v_double = deltav * fr2 + v0;
-
-      //printf("[%g][%g] %g %g : ", u, v, u_double, v_double );
-
-      //computation of the bilinear interpolation
-
-      //declarations
-      int u_round  = (int) (u_double);
-      int v_round  = (int) (v_double);
-      if (u_round < 0.f) u_round = -1;
-      if (v_round < 0.f) v_round = -1;
-      double  du_double  = (u_double) - (double) u_round;
-      double  dv_double  = (v_double) - (double) v_round;
-      Type  v01;
-      Type  v23;
-      if ( (0 <= u_round) && (0 <= v_round) &&
-           (u_round < (((int)width) - 1)) && (v_round < (((int)height) - 1)) ) {
-        //process interpolation
-        const Type* _mp = &I[(unsigned int)v_round][(unsigned int)u_round];
-        v01 = (Type)(_mp[0] + ((_mp[1] - _mp[0]) * du_double));
-        _mp += width;
-        v23 = (Type)(_mp[0] + ((_mp[1] - _mp[0]) * du_double));
-        *dst = (Type)(v01 + ((v23 - v01) * dv_double));
-        //printf("R %d G %d B %d\n", dst->R, dst->G, dst->B);
-      }
-      else {
-        *dst = 0;
-      }
-      dst++;
-    }
+  else {
+    unsigned int nbThreads = nThreads > 0 ? nThreads : vpThreadPool::getInstance().getNumThreads();
+    vpThreadPool::getInstance().parallelFor(0, height, task, (height + nbThreads - 1) / nbThreads, nbThreads);
   }
-#endif // VISP_HAVE_PTHREAD
-
-
 
 
 #if 0
@@ -788,8 +658,7 @@ void vpImageTools::flip(const vpImage<Type> &I,
 
     for (unsigned int i = 0; i < height; i++)
     {
-      memcpy(newI.bitmap+i*width, I.bitmap+(height-1-i)*width,
-             width*sizeof(Type));
+      memcpy(newI[i], I[height-1-i], width*sizeof(Type));
     }
 }
 
@@ -837,13 +706,10 @@ void vpImageTools::flip(vpImage<Type> &I)
 
     for ( i = 0; i < height/2; i++)
     {
-      memcpy(Ibuf.bitmap, I.bitmap+i*width,
-             width*sizeof(Type));
+      memcpy(Ibuf.bitmap, I[i], width*sizeof(Type));
 
-      memcpy(I.bitmap+i*width, I.bitmap+(height-1-i)*width,
-             width*sizeof(Type));
-      memcpy(I.bitmap+(height-1-i)*width, Ibuf.bitmap,
-             width*sizeof(Type));
+      memcpy(I[i], I[height-1-i], width*sizeof(Type));
+      memcpy(I[height-1-i], Ibuf.bitmap, width*sizeof(Type));
     }
 }
 
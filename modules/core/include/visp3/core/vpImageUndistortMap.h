@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Precomputed remap tables to undistort images.
+ *
+ *****************************************************************************/
+
+#ifndef __vpImageUndistortMap_h_
+#define __vpImageUndistortMap_h_
+
+/*!
+  \file vpImageUndistortMap.h
+  \brief Precomputed remap tables to undistort images.
+*/
+
+#include <vector>
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRGBa.h>
+
+/*!
+  \class vpImageUndistortMap
+  \ingroup group_core_image
+
+  \brief Remap tables that undistort the images of a camera with radial
+  distortion.
+
+  vpImageTools::undistort() evaluates the distortion model for each pixel of
+  each image. Since the camera parameters do not change from one frame to the
+  next one, this class rather computes once, for each pixel of the undistorted
+  image, the position of the source pixel in fixed point, that is the
+  coordinates of the top left pixel of the 2x2 neighborhood and the bilinear
+  weights on 7 bits. remap() then only applies the tables. The pixels are
+  processed with SSE2 for color images and with AVX2 gathers for grey level
+  images when the processor supports them, and the rows are split over
+  vpThreadPool.
+
+  The result differs from vpImageTools::undistort() by at most one or two grey
+  levels, since the latter truncates the intermediate interpolations.
+
+  \code
+#include <visp3/core/vpImageUndistortMap.h>
+
+int main()
+{
+  vpCameraParameters cam(600, 600, 320, 240, -0.2, 0.2);
+  vpImageUndistortMap map(cam, 640, 480);
+
+  vpImage<unsigned char> I(480, 640), Iundist;
+  // for each new image I
+  map.remap(I, Iundist);
+}
+  \endcode
+*/
+class VISP_EXPORT vpImageUndistortMap
+{
+public:
+  vpImageUndistortMap();
+  vpImageUndistortMap(const vpCameraParameters &cam, const unsigned int width, const unsigned int height);
+
+  //! Return the height of the images that can be undistorted.
+  inline unsigned int getHeight() const { return m_height; }
+  //! Return the width of the images that can be undistorted.
+  inline unsigned int getWidth() const { return m_width; }
+
+  void init(const vpCameraParameters &cam, const unsigned int width, const unsigned int height);
+  /*!
+    Return true if the camera has no distortion, in which case remap() copies
+    the images.
+  */
+  inline bool isIdentity() const { return m_identity; }
+
+  void remap(const vpImage<unsigned char> &I, vpImage<unsigned char> &Iundist, const unsigned int nThreads=0) const;
+  void remap(const vpImage<vpRGBa> &I, vpImage<vpRGBa> &Iundist, const unsigned int nThreads=0) const;
+
+private:
+  void checkSize(const unsigned int width, const unsigned int height) const;
+
+  unsigned int m_width;
+  unsigned int m_height;
+  bool m_identity;
+  //! Source pixel of each destination pixel, column in the low 16 bits and row in the high ones
+  std::vector<unsigned int> m_coords;
+  //! Bilinear weights of each destination pixel, along the columns in the low 16 bits and the rows in the high ones
+  std::vector<unsigned int> m_weights;
+};
+
+#endif
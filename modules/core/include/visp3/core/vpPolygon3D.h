@@ -99,6 +99,8 @@ private:
                                            vpPoint &p1Clipped, vpPoint &p2Clipped,
                                            unsigned int &p1ClippedInfo, unsigned int &p2ClippedInfo,
                                            const unsigned int &flag, const double &distance);
+
+            int           getClippingSide(const std::vector<vpColVector> &fovNormals, const bool fovComputed) const;
     
 public: 
             vpPolygon3D() ;
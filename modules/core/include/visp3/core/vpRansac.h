@@ -51,7 +51,10 @@
 #include <visp3/core/vpDebug.h> // debug and trace
 #include <visp3/core/vpColVector.h>
 #include <visp3/core/vpMath.h>
+#include <visp3/core/vpRansacEngine.h>
 #include <ctime>
+#include <vector>
+
 /*!
   \class vpRansac
   \ingroup group_core_robust
@@ -68,7 +71,11 @@
   pk at csse uwa edu au
   http://www.csse.uwa.edu.au/~pk
 
-  \sa vpHomography
+  The transformation class gives the static functions
+  degenerateConfiguration(), computeTransformation() and computeResidual()
+  that are used as the vpRansacEngine::Problem solved by vpRansacEngine.
+
+  \sa vpHomography, vpRansacEngine
 
  */
 template <class vpTransformation>
@@ -83,6 +90,63 @@ public:
 		      int consensus = 1000,
           double not_used = 0.0,
           const int maxNbumbersOfTrials = 10000);
+
+private:
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  //! Problem defined by the static functions of vpTransformation
+  class Problem : public vpRansacEngine::Problem
+  {
+  public:
+    Problem(unsigned int npts, vpColVector &x, unsigned int s) : m_npts(npts), m_x(x), m_s(s) {}
+
+    unsigned int getNbData() const { return m_npts; }
+    unsigned int getSampleSize() const { return m_s; }
+
+    bool isDegenerate(const unsigned int *sample) const
+    {
+      std::vector<unsigned int> ind(sample, sample + m_s);
+      return vpTransformation::degenerateConfiguration(m_x, &ind[0]);
+    }
+
+    unsigned int computeModels(const unsigned int *sample, std::vector<vpColVector> &models) const
+    {
+      std::vector<unsigned int> ind(sample, sample + m_s);
+      vpColVector M;
+      vpTransformation::computeTransformation(m_x, &ind[0], M);
+      models.push_back(M);
+      return 1;
+    }
+
+    void computeErrors(const vpColVector &model, const unsigned int begin, const unsigned int end,
+                       double *errors) const
+    {
+      vpColVector M = model, d;
+      vpTransformation::computeResidual(m_x, M, d);
+      for (unsigned int i = begin; i < end; i++)
+        errors[i - begin] = fabs(d[i]);
+    }
+
+    unsigned int computeConsensus(const vpColVector &model, const double threshold,
+                                  const unsigned int nbInliersToBeat, std::vector<unsigned int> &consensus,
+                                  std::vector<double> &errors) const
+    {
+      (void)nbInliersToBeat;
+      errors.resize(m_npts);
+      computeErrors(model, 0, m_npts, &errors[0]);
+      consensus.clear();
+      for (unsigned int i = 0; i < m_npts; i++) {
+        if (errors[i] < threshold)
+          consensus.push_back(i);
+      }
+      return (unsigned int) consensus.size();
+    }
+
+  private:
+    unsigned int m_npts;
+    vpColVector &m_x;
+    unsigned int m_s;
+  };
+#endif
 };
 
 /*!
@@ -113,6 +177,15 @@ public:
   \param maxNbumbersOfTrials : Maximum number of trials. Even if a solution is
   not found, the method is stopped.
 
+  The search also stops when a sample without outlier has been drawn with a
+  probability of 0.99. The degenerate samples are drawn again without
+  counting a trial.
+
+  \exception vpException::fatalError : If no nondegenerate sample is drawn
+  after 1000 attempts.
+
+  Since the functions of the transformation class are not required to be
+  thread-safe, the hypotheses are evaluated sequentially.
 */
 
 template <class vpTransformation>
@@ -125,129 +198,34 @@ vpRansac<vpTransformation>::ransac(unsigned int npts, vpColVector &x,
            double not_used,
            const int maxNbumbersOfTrials)
 {
-  /*   bool isplanar; */
-  /*   if (s == 4) isplanar = true; */
-  /*   else isplanar = false; */
   (void)not_used;
-  double eps = 1e-6 ;
-  double p = 0.99;    // Desired probability of choosing at least one sample
-  // free from outliers
-
-  int maxTrials = maxNbumbersOfTrials;      // Maximum number of trials before we give up.
-  int  maxDataTrials = 1000;  // Max number of attempts to select a non-degenerate
-  // data set.
 
   if (s<4)
     s = 4;
 
-  // Sentinel value allowing detection of solution failure.
-  bool solutionFind = false ;
-  vpColVector bestM ;
-  int trialcount = 0;
-  int  bestscore =  -1;
-  double   N = 1;            // Dummy initialisation for number of trials.
-
-  vpUniRand random((const long)time(NULL)) ;
-  vpColVector bestinliers ;
-  unsigned int *ind = new unsigned int [s] ;
-  int numiter = 0;
-  int ninliers = 0;
-  double residual = 0.0;
-  while(( N > trialcount) && (consensus > bestscore))
-  {
-    // Select at random s datapoints to form a trial model, M.
-    // In selecting these points we have to check that they are not in
-    // a degenerate configuration.
-
-    bool degenerate = true;
-    int count = 1;
-
-    while ( degenerate == true)
-    {
-      // Generate s random indicies in the range 1..npts
-      for  (unsigned int i=0 ; i < s ; i++)
-        ind[i] = (unsigned int)ceil(random()*npts) -1;
-
-      // Test that these points are not a degenerate configuration.
-      degenerate = vpTransformation::degenerateConfiguration(x,ind) ;
-      //   degenerate = feval(degenfn, x(:,ind));
-
-      // Safeguard against being stuck in this loop forever
-      count = count + 1;
-
-      if (count > maxDataTrials)      {
-        delete [] ind;
-        vpERROR_TRACE("Unable to select a nondegenerate data set");
-        throw(vpException(vpException::fatalError, "Unable to select a nondegenerate data set"));
-        //return false; //Useless after a throw() function
-      }
-    }
-    // Fit model to this random selection of data points.
-    vpTransformation::computeTransformation(x,ind, M);
-
-    vpColVector d ;
-    // Evaluate distances between points and model.
-    vpTransformation::computeResidual(x, M, d) ;
-
-    // Find the indices of points that are inliers to this model.
-    residual = 0.0;
-    ninliers =0 ;
-    for (unsigned int i=0 ; i < npts ; i++)
-    {
-      double resid = fabs(d[i]);
-      if (resid < t)
-      {
-        inliers[i] = 1 ;
-        ninliers++ ;
-        residual += fabs(d[i]);
-      }
-      else inliers[i] = 0;
-    }
-
-    if (ninliers > bestscore)    // Largest set of inliers so far...
-    {
-      bestscore = ninliers;  // Record data for this model
-      bestinliers = inliers;
-      bestM = M;
-      solutionFind = true ;
-
-      // Update estimate of N, the number of trials to ensure we pick,
-      // with probability p, a data set with no outliers.
-
-      double fracinliers =  (double)ninliers / (double)npts;
-
-      double pNoOutliers = 1 -  pow(fracinliers,static_cast<int>(s));
-
-      pNoOutliers = vpMath::maximum(eps, pNoOutliers);  // Avoid division by -Inf
-      pNoOutliers = vpMath::minimum(1-eps, pNoOutliers);// Avoid division by 0.
-      N = (log(1-p)/log(pNoOutliers));
-    }
-
-    trialcount = trialcount+1;
-    // Safeguard against being stuck in this loop forever
-    if (trialcount > maxTrials)
-    {
-      vpTRACE("ransac reached the maximum number of %d trials",   maxTrials);
-      break ;
-    }
-    numiter++;
+  vpRansacEngine engine;
+  engine.setThreshold(t);
+  engine.setMaxTrials(maxNbumbersOfTrials > 0 ? (unsigned int) maxNbumbersOfTrials : 0);
+  engine.setNbInliersToReachConsensus(consensus > 0 ? (unsigned int) consensus : 0);
+  engine.setLocalOptimization(false);
+  engine.setNbThreads(1);
+
+  Problem problem(npts, x, s);
+  std::vector<unsigned int> best_consensus;
+  bool foundSolution = engine.estimate(problem, M, best_consensus);
+  if (engine.isDegenerateLimitReached()) {
+    vpERROR_TRACE("Unable to select a nondegenerate data set");
+    throw(vpException(vpException::fatalError, "Unable to select a nondegenerate data set"));
   }
-
-  if (solutionFind==true)   // We got a solution
-  {
-    M = bestM;
-    inliers = bestinliers;
+  if (foundSolution) {
+    inliers = 0;
+    for (size_t i = 0; i < best_consensus.size(); i++)
+      inliers[best_consensus[i]] = 1;
   }
-  else
-  {
-    vpTRACE("ransac was unable to find a useful solution");
+  else {
     M = 0;
   }
 
-  if(ninliers > 0)
-    residual /= ninliers;
-  delete [] ind;
-
   return true;
 }
 
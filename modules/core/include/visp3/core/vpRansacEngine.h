@@ -0,0 +1,271 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Generic and parallel RANSAC engine.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpRansacEngine.h
+  \brief Generic and parallel RANSAC engine.
+*/
+
+#ifndef vpRansacEngine_h
+#define vpRansacEngine_h
+
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpColVector.h>
+
+/*!
+  \class vpRansacEngine
+  \ingroup group_core_robust
+
+  \brief Generic RANSAC \cite Fischler81 and LO-RANSAC \cite Chum03 engine
+  whose hypotheses are evaluated in parallel.
+
+  The estimation problem is described by a vpRansacEngine::Problem that
+  gives the minimal solver, the degeneracy test of a sample, the errors of
+  the data for a model and optionally the non-minimal solver used by the
+  local optimization. The models are stored in vpColVector.
+
+  The samples are drawn in the calling thread by batches, then the models of
+  a batch are computed and scored in the threads of vpThreadPool. The
+  hypotheses are finally examined in the order of their samples, so that the
+  estimation gives the same result whatever the number of threads.
+  The scoring of a hypothesis stops as soon as it cannot have more inliers
+  than the best hypothesis of the previous batches.
+
+  A degenerate sample is drawn again and does not count as a trial, as in
+  the former vpRansac. If no valid sample is drawn after
+  getMaxDegenerateDraws() attempts, the search stops and
+  isDegenerateLimitReached() returns true.
+
+  The search stops when the maximum number of trials is reached, when a
+  model has the requested number of inliers, or when a sample without
+  outlier has been drawn with the requested confidence given the ratio of
+  inliers of the best model. Since this adaptive stop may end the search
+  before a model reaches the requested number of inliers, callers that
+  require this number of inliers should disable it with setConfidence(0).
+
+  When the local optimization is enabled, each new best model is refined
+  from its inliers with Problem::refineModel() as long as the number of
+  inliers increases.
+
+  vpHomography::ransac(), vpPose::poseRansac() and vpRansac are built on
+  this class.
+*/
+class VISP_EXPORT vpRansacEngine
+{
+public:
+  /*!
+    \class RandomGenerator
+    Minimal random number generator of Park and Miller \cite Park:1988 used
+    to draw the samples. Unlike vpUniRand, whose shuffle table is shared by
+    all the instances, two generators with the same seed give the same
+    sequence.
+  */
+  class RandomGenerator
+  {
+  public:
+    explicit RandomGenerator(const long seed = 0) : m_x(seed % 2147483647)
+    {
+      if (m_x <= 0)
+        m_x += 2147483646;
+    }
+
+    //! Uniform random index in [0, n)
+    inline unsigned int operator()(const unsigned int n)
+    {
+      const long a = 16807, m = 2147483647, q = 127773, r = 2836;
+      const long k = m_x / q;
+      m_x = a * (m_x - k * q) - k * r;
+      if (m_x < 0)
+        m_x += m;
+      const unsigned int index = (unsigned int) (n * ((m_x - 1) / (double) (m - 1)));
+      return index < n ? index : n - 1;
+    }
+
+  private:
+    long m_x;
+  };
+
+  /*!
+    \class Problem
+    Interface of an estimation problem solved by vpRansacEngine.
+
+    computeModels(), computeErrors() and computeConsensus() are called
+    concurrently from the threads of vpThreadPool, so that they must not
+    modify shared data. isDegenerate() and refineModel() are only called
+    from the thread that runs vpRansacEngine::estimate().
+  */
+  class VISP_EXPORT Problem
+  {
+  public:
+    virtual ~Problem() {}
+
+    //! Number of data.
+    virtual unsigned int getNbData() const = 0;
+    //! Number of data of a minimal sample.
+    virtual unsigned int getSampleSize() const = 0;
+
+    /*!
+      Return true if the data of the sample, whose getSampleSize() distinct
+      indexes are given in \e sample, are in a degenerate configuration.
+      A degenerate sample is drawn again without counting a trial.
+      By default, no sample is degenerate.
+    */
+    virtual bool isDegenerate(const unsigned int *sample) const
+    {
+      (void)sample;
+      return false;
+    }
+
+    /*!
+      Minimal solver: append to \e models the models that fit the data of
+      the sample and return their number, that can be zero. A sample without
+      model counts as a trial.
+    */
+    virtual unsigned int computeModels(const unsigned int *sample, std::vector<vpColVector> &models) const = 0;
+
+    /*!
+      Compute in \e errors[0, end-begin) the errors of the data of indexes
+      [\e begin, \e end) for the model. It is called by the default
+      computeConsensus() on blocks of data.
+    */
+    virtual void computeErrors(const vpColVector &model, const unsigned int begin, const unsigned int end,
+                               double *errors) const = 0;
+
+    /*!
+      Return true if a data whose error equals the threshold is an inlier.
+      By default, the errors of the inliers are strictly below the threshold.
+    */
+    virtual bool isThresholdInclusive() const { return false; }
+
+    /*!
+      Score a model: compute its consensus set, that is the indexes of the
+      inliers in increasing order, and return its number of inliers. The
+      count may stop as soon as the model cannot have more than
+      \e nbInliersToBeat inliers. Override it when the inliers are not only
+      defined by their errors.
+    */
+    virtual unsigned int computeConsensus(const vpColVector &model, const double threshold,
+                                          const unsigned int nbInliersToBeat, std::vector<unsigned int> &consensus,
+                                          std::vector<double> &errors) const;
+
+    /*!
+      Non-minimal solver used by the local optimization: estimate \e model
+      from the data of indexes \e inliers, \e model being initialized with
+      the current model. Return false if the model is not refined, which is
+      the default.
+    */
+    virtual bool refineModel(const std::vector<unsigned int> &inliers, vpColVector &model) const
+    {
+      (void)inliers;
+      (void)model;
+      return false;
+    }
+  };
+
+  vpRansacEngine();
+
+  bool estimate(const Problem &problem, vpColVector &model, std::vector<unsigned int> &inliers);
+
+  static unsigned int computeNbTrials(const double confidence, const double inlierRatio,
+                                      const unsigned int sampleSize, const unsigned int maxTrials);
+
+  //! Confidence of drawing a sample without outlier used to stop the search.
+  inline double getConfidence() const { return m_confidence; }
+  //! Maximum number of consecutive degenerate samples drawn before the search stops.
+  inline unsigned int getMaxDegenerateDraws() const { return m_maxDegenerateDraws; }
+  /*!
+    Number of samples evaluated by the last estimation, that can exceed
+    getNbTrials() since the samples are evaluated by batches.
+  */
+  inline unsigned int getNbHypotheses() const { return m_nbHypotheses; }
+  //! Number of inliers of the model of the last estimation.
+  inline unsigned int getNbInliers() const { return m_nbInliers; }
+  //! Number of samples drawn by the last estimation.
+  inline unsigned int getNbTrials() const { return m_nbTrials; }
+  //! Maximum number of threads, 0 meaning all the threads of vpThreadPool.
+  inline unsigned int getNbThreads() const { return m_nbThreads; }
+  //! Error below which a data is an inlier.
+  inline double getThreshold() const { return m_threshold; }
+  /*!
+    Return true if the last estimation stopped because no valid sample was
+    drawn after getMaxDegenerateDraws() attempts.
+  */
+  inline bool isDegenerateLimitReached() const { return m_degenerateLimitReached; }
+
+  /*!
+    Set the confidence of drawing a sample without outlier, in ]0, 1[, used
+    to adapt the number of trials to the ratio of inliers of the best model.
+    A value of 0 or 1 disables the adaptive stop.
+  */
+  inline void setConfidence(const double confidence) { m_confidence = confidence; }
+  //! Enable or disable the local optimization of the best models.
+  inline void setLocalOptimization(const bool enable) { m_localOptimization = enable; }
+  //! Set the maximum number of consecutive degenerate samples drawn before the search stops.
+  inline void setMaxDegenerateDraws(const unsigned int maxDraws) { m_maxDegenerateDraws = maxDraws; }
+  //! Set the maximum number of samples drawn.
+  inline void setMaxTrials(const unsigned int maxTrials) { m_maxTrials = maxTrials; }
+  //! Stop the search as soon as a model has this number of inliers.
+  inline void setNbInliersToReachConsensus(const unsigned int nbInliers) { m_nbInliersConsensus = nbInliers; }
+  /*!
+    Set the maximum number of threads used to evaluate the hypotheses. With
+    0, all the threads of vpThreadPool are used, with 1 the estimation is
+    sequential.
+  */
+  inline void setNbThreads(const unsigned int nbThreads) { m_nbThreads = nbThreads; }
+  //! Set the seed of the random generator used to draw the samples.
+  inline void setSeed(const long seed) { m_seed = seed; }
+  /*!
+    Set the error below which a data is an inlier (see
+    Problem::isThresholdInclusive()).
+  */
+  inline void setThreshold(const double threshold) { m_threshold = threshold; }
+
+private:
+  double m_confidence;
+  bool m_degenerateLimitReached;
+  bool m_localOptimization;
+  unsigned int m_maxDegenerateDraws;
+  unsigned int m_maxTrials;
+  unsigned int m_nbHypotheses;
+  unsigned int m_nbInliers;
+  unsigned int m_nbInliersConsensus;
+  unsigned int m_nbThreads;
+  unsigned int m_nbTrials;
+  long m_seed;
+  double m_threshold;
+};
+
+#endif
@@ -74,6 +74,8 @@ private:
 
   //!Normalized residue
   vpColVector normres; 
+  //!Normalized residues of all the data given to MEstimator(method, residues, all_residues, weights)
+  vpColVector all_normres;
   //!Sorted normalized Residues
   vpColVector sorted_normres;
   //!Sorted residues
@@ -204,13 +206,23 @@ public:
   
   /** @name Sort function  */
   //@{
-  //! Swap two value
-  void exch(double &A, double &B){swap = A; A = B;  B = swap;}
-  //! Sort function using partition method
-  int partition(vpColVector &a, int l, int r);
   //! Sort the vector and select a value in the sorted vector
   double select(vpColVector &a, int l, int r, int k);
   //@}
+
+#if defined(VISP_BUILD_DEPRECATED_FUNCTIONS)
+  /*!
+    @name Deprecated functions
+  */
+  //@{
+  /*!
+     \deprecated Provided only for compat with previous releases.
+     select() no longer uses it.
+   */
+  vp_deprecated void exch(double &A, double &B){swap = A; A = B;  B = swap;}
+  vp_deprecated int partition(vpColVector &a, int l, int r);
+  //@}
+#endif
 };
 
 #endif
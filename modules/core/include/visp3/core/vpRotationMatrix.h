@@ -157,6 +157,8 @@ public:
 
 private:
   static const double threshold;
+  //! Elements of the matrix, embedded to avoid heap allocations
+  vpArray2DStorage<double, 3, 3> m_storage;
 };
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
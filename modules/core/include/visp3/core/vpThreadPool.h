@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Process-wide pool of worker threads.
+ *
+ *****************************************************************************/
+
+#ifndef __vpThreadPool_h_
+#define __vpThreadPool_h_
+
+/*!
+  \file vpThreadPool.h
+  \brief Process-wide pool of worker threads with a parallel-for API.
+*/
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpException.h>
+
+/*!
+   \class vpThreadPool
+
+   \ingroup group_core_threading
+
+   Process-wide pool of persistent worker threads.
+
+   The library functions that can run on several cores (vpHistogram::calculate(),
+   vpImage::performLut(), vpImageTools::undistort(), vpPose::poseRansac(), ...)
+   no more create and join their own vpThread at each call, but submit their work
+   to the unique instance of this class. The workers are created once, the first
+   time they are needed, and then wait for the next job. This removes the thread
+   creation latency in the processing loops and allows to bound the total number
+   of threads used by ViSP with setNumThreads().
+
+   A job is a range of indexes [begin, end) that is processed by a vpThreadPool::Task.
+   The range is first split into one contiguous slice per participating thread; the
+   calling thread always takes part in the computation. When a thread has exhausted
+   its slice it steals half of the remaining work of another one, so that unbalanced
+   loads are redistributed.
+
+   When ViSP is built without pthread or Windows threads, or when parallelFor() is called
+   from inside a task (nested parallelism), the range is processed sequentially by the
+   calling thread.
+
+   The following example shows how to sum a vector using the pool:
+   \code
+#include <visp3/core/vpThreadPool.h>
+
+class SumTask : public vpThreadPool::Task
+{
+public:
+  SumTask(const std::vector<double> &v)
+    : m_v(v), m_sums(vpThreadPool::getInstance().getNumThreads(), 0.0) {}
+
+  void operator()(const unsigned int begin, const unsigned int end) {
+    // Each thread accumulates in its own slot
+    double &sum = m_sums[vpThreadPool::getThreadIndex()];
+    for (unsigned int i = begin; i < end; i++)
+      sum += m_v[i];
+  }
+
+  const std::vector<double> &m_v;
+  std::vector<double> m_sums;
+};
+
+int main()
+{
+  std::vector<double> v(1000000, 1.0);
+  SumTask task(v);
+  vpThreadPool::getInstance().parallelFor(0, (unsigned int)v.size(), task, 1024);
+
+  double sum = 0.0;
+  for (size_t i = 0; i < task.m_sums.size(); i++)
+    sum += task.m_sums[i];
+}
+   \endcode
+ */
+class VISP_EXPORT vpThreadPool
+{
+public:
+  /*!
+    \class Task
+    Interface of a job that can be executed by the pool.
+
+    The call operator may be invoked concurrently from several threads on disjoint sub-ranges,
+    so that it must only write to data that depends on the indexes it receives or on
+    vpThreadPool::getThreadIndex().
+   */
+  class Task
+  {
+  public:
+    virtual ~Task() {}
+    /*!
+      Process indexes in [\e begin, \e end).
+     */
+    virtual void operator()(const unsigned int begin, const unsigned int end) = 0;
+  };
+
+  static vpThreadPool &getInstance();
+  static unsigned int getNumberOfCPU();
+  static unsigned int getThreadIndex();
+
+  /*!
+    Return the maximum number of threads, including the calling thread, that are
+    used to process a job.
+   */
+  inline unsigned int getNumThreads() const { return m_nbThreads; }
+
+  void parallelFor(const unsigned int begin, const unsigned int end, Task &task,
+                   const unsigned int grainSize=1, const unsigned int nbThreads=0);
+  void setNumThreads(const unsigned int nbThreads);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  class Impl;
+#endif
+
+private:
+  vpThreadPool();
+  ~vpThreadPool();
+  vpThreadPool(const vpThreadPool &); // not implemented
+  vpThreadPool &operator=(const vpThreadPool &); // not implemented
+
+  Impl *m_impl;
+  unsigned int m_nbThreads;
+};
+
+#endif
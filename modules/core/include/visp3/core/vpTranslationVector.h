@@ -98,7 +98,7 @@ public:
       Default constructor.
       The translation vector is initialized to zero.
     */
-  vpTranslationVector() : vpArray2D<double>(3, 1) {};
+  vpTranslationVector() : vpArray2D<double>(m_storage), m_storage() {};
   vpTranslationVector(const double tx, const double ty, const double tz) ;
   vpTranslationVector(const vpTranslationVector &tv);
   vpTranslationVector(const vpHomogeneousMatrix &M);
@@ -165,6 +165,10 @@ public:
                                    const vpTranslationVector &b) ;
   static vpMatrix skew(const vpTranslationVector &tv) ;
   static void skew(const  vpTranslationVector &tv, vpMatrix &M) ;
+
+private:
+  //! Elements of the vector, embedded to avoid heap allocations
+  vpArray2DStorage<double, 3, 1> m_storage;
 } ;
 
 #endif
@@ -179,6 +179,10 @@ class VISP_EXPORT vpVelocityTwistMatrix : public vpArray2D<double>
   vp_deprecated void setIdentity();
   //@}
 #endif
+
+private:
+  //! Elements of the matrix, embedded to avoid heap allocations
+  vpArray2DStorage<double, 6, 6> m_storage;
 } ;
 
 #endif
@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Weighted linear least squares solved through the normal equations.
+ *
+ *****************************************************************************/
+
+#ifndef __vpWeightedLeastSquares_h_
+#define __vpWeightedLeastSquares_h_
+
+/*!
+  \file vpWeightedLeastSquares.h
+  \brief Weighted linear least squares solved through the normal equations.
+*/
+
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpMatrix.h>
+
+/*!
+  \class vpWeightedLeastSquares
+  \ingroup group_core_matrices
+
+  Solve the weighted linear least squares problem
+  \f[ \min_{\bf x} \sum_i w_i \left( {\bf J}_i {\bf x} - e_i \right)^2 \f]
+  where \f$ {\bf J}_i \f$ is the i-th row of a tall and skinny matrix, typically
+  the N-by-6 interaction matrix of a virtual visual servoing loop.
+
+  Instead of computing the pseudo-inverse of \f$ {\bf J} \f$ by SVD, the rows are
+  streamed into the normal equations \f$ {\bf J}^T {\bf W} {\bf J} \f$ and
+  \f$ {\bf J}^T {\bf W} {\bf e} \f$, so that \f$ {\bf J} \f$ does not need to be
+  built. The small symmetric system is then solved by a Cholesky (LDL^T)
+  decomposition with diagonal pivoting. Only when this system is badly
+  conditioned does solve() fall back to the SVD pseudo-inverse, which keeps the
+  behavior of the previous code for rank deficient problems.
+
+  \code
+#include <visp3/core/vpWeightedLeastSquares.h>
+
+int main()
+{
+  vpWeightedLeastSquares ls(6);
+  double J[6], e, w;
+  for (unsigned int i = 0; i < 1000; i++) {
+    // ... fill J with the i-th row of the interaction matrix, compute the error e and its weight w
+    ls.addRow(J, e, w);
+  }
+  vpColVector v;
+  ls.solve(v);
+  v = -0.5 * v; // velocity of the VVS control law with a gain of 0.5
+}
+  \endcode
+*/
+class VISP_EXPORT vpWeightedLeastSquares
+{
+public:
+  explicit vpWeightedLeastSquares(const unsigned int nbUnknowns=6);
+
+  void addRow(const double *J, const double e, const double w=1.0);
+  void addRows(const vpMatrix &J, const vpColVector &e);
+  void addRows(const vpMatrix &J, const vpColVector &e, const vpColVector &w);
+
+  void changeVariables(const vpMatrix &T);
+
+  vpMatrix getJtWJ() const;
+  vpColVector getJtWe() const;
+  //! Return the number of rows added since the last reset().
+  inline unsigned int getNbRows() const { return m_nbRows; }
+  //! Return the number of unknowns, that is the number of columns of the rows.
+  inline unsigned int getNbUnknowns() const { return m_n; }
+  //! Return \f$ \sum_i w_i e_i^2 \f$.
+  inline double getWeightedSumSquare() const { return m_sumWe2; }
+
+  void init(const unsigned int nbUnknowns);
+  void reset();
+
+  unsigned int solve(vpColVector &x, const double mu=0.0, const double svThreshold=1e-12) const;
+
+private:
+  //! Number of unknowns
+  unsigned int m_n;
+  //! Upper triangle of J^T W J, stored row-major in a n x n array
+  std::vector<double> m_JtWJ;
+  //! J^T W e
+  std::vector<double> m_JtWe;
+  double m_sumWe2;
+  unsigned int m_nbRows;
+};
+
+#endif
@@ -0,0 +1,231 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Process-wide pool of aligned image buffers.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpImageBufferPool.cpp
+  \brief Definition of the vpImageBufferPool class member functions.
+*/
+
+#include <map>
+#include <stdlib.h>
+
+#include <visp3/core/vpImageBufferPool.h>
+#include <visp3/core/vpMutex.h>
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+#  define VP_IMAGE_BUFFER_POOL_LOCK
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  /*
+    Set when the pool has been destroyed at the exit of the program. The images
+    that are destroyed later, like static ones, free their memory directly.
+  */
+  bool poolDestroyed = false;
+
+  //! Allocate a block aligned on \e alignment bytes, the address returned by malloc() being stored just before.
+  void *alignedMalloc(const size_t size, const size_t alignment)
+  {
+    void *raw = malloc(size + alignment - 1 + sizeof(void *));
+    if (raw == NULL) {
+      throw(vpException(vpException::memoryAllocationError,
+                        "Cannot allocate an image buffer of %lu bytes", (unsigned long) size));
+    }
+    size_t address = ((size_t) raw + sizeof(void *) + alignment - 1) & ~(alignment - 1);
+    void *ptr = (void *) address;
+    ((void **) ptr)[-1] = raw;
+    return ptr;
+  }
+
+  void alignedFree(void *ptr)
+  {
+    if (ptr != NULL)
+      free(((void **) ptr)[-1]);
+  }
+}
+
+class vpImageBufferPool::Impl
+{
+public:
+  Impl() : m_blocks(), m_cachedSize(0)
+#ifdef VP_IMAGE_BUFFER_POOL_LOCK
+    , m_mutex()
+#endif
+  {}
+
+  void lock()
+  {
+#ifdef VP_IMAGE_BUFFER_POOL_LOCK
+    m_mutex.lock();
+#endif
+  }
+
+  void unlock()
+  {
+#ifdef VP_IMAGE_BUFFER_POOL_LOCK
+    m_mutex.unlock();
+#endif
+  }
+
+  //! Unused blocks sorted by size in bytes.
+  std::multimap<size_t, void *> m_blocks;
+  //! Total size of the unused blocks.
+  size_t m_cachedSize;
+#ifdef VP_IMAGE_BUFFER_POOL_LOCK
+  vpMutex m_mutex;
+#endif
+};
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+vpImageBufferPool::vpImageBufferPool()
+  : m_impl(new Impl), m_capacity(256 << 20)
+{
+}
+
+vpImageBufferPool::~vpImageBufferPool()
+{
+  clear();
+  delete m_impl;
+  m_impl = NULL;
+  poolDestroyed = true;
+}
+
+/*!
+  Return the unique instance of the pool.
+*/
+vpImageBufferPool &vpImageBufferPool::getInstance()
+{
+  static vpImageBufferPool pool;
+  return pool;
+}
+
+/*!
+  Return a block of \e size bytes aligned on getAlignment() bytes. A block of
+  the same size previously given back with deallocate() is returned if there
+  is one.
+
+  \exception vpException::memoryAllocationError : If the memory cannot be allocated.
+
+  \sa deallocate()
+*/
+void *vpImageBufferPool::allocate(const size_t size)
+{
+  if (! poolDestroyed && m_capacity > 0) {
+    m_impl->lock();
+    std::multimap<size_t, void *>::iterator it = m_impl->m_blocks.find(size);
+    if (it != m_impl->m_blocks.end()) {
+      void *ptr = it->second;
+      m_impl->m_blocks.erase(it);
+      m_impl->m_cachedSize -= size;
+      m_impl->unlock();
+      return ptr;
+    }
+    m_impl->unlock();
+  }
+
+  return alignedMalloc(size, getAlignment());
+}
+
+/*!
+  Free all the blocks kept for a later reuse.
+*/
+void vpImageBufferPool::clear()
+{
+  m_impl->lock();
+  for (std::multimap<size_t, void *>::iterator it = m_impl->m_blocks.begin(); it != m_impl->m_blocks.end(); ++it)
+    alignedFree(it->second);
+  m_impl->m_blocks.clear();
+  m_impl->m_cachedSize = 0;
+  m_impl->unlock();
+}
+
+/*!
+  Give back a block returned by allocate(). It is kept for a later reuse if the
+  total size of the unused blocks stays below getCapacity(), and freed otherwise.
+
+  \param ptr : Block returned by allocate(). Nothing is done if it is NULL.
+  \param size : Size given to allocate().
+*/
+void vpImageBufferPool::deallocate(void *ptr, const size_t size)
+{
+  if (ptr == NULL)
+    return;
+
+  if (! poolDestroyed) {
+    m_impl->lock();
+    if (m_impl->m_cachedSize + size <= m_capacity) {
+      m_impl->m_blocks.insert(std::pair<size_t, void *>(size, ptr));
+      m_impl->m_cachedSize += size;
+      m_impl->unlock();
+      return;
+    }
+    m_impl->unlock();
+  }
+
+  alignedFree(ptr);
+}
+
+/*!
+  Return the total size in bytes of the blocks kept for a later reuse.
+*/
+size_t vpImageBufferPool::getCachedSize() const
+{
+  m_impl->lock();
+  size_t size = m_impl->m_cachedSize;
+  m_impl->unlock();
+  return size;
+}
+
+/*!
+  Set the maximum number of bytes kept in the pool for a later reuse. The
+  unused blocks are freed if they exceed the new capacity. The default
+  capacity is 256 MB.
+
+  \param capacity : Capacity in bytes. 0 disables the recycling of the blocks.
+*/
+void vpImageBufferPool::setCapacity(const size_t capacity)
+{
+  m_impl->lock();
+  m_capacity = capacity;
+  // Free the largest blocks first
+  while (m_impl->m_cachedSize > m_capacity) {
+    std::multimap<size_t, void *>::iterator it = m_impl->m_blocks.end();
+    --it;
+    m_impl->m_cachedSize -= it->first;
+    alignedFree(it->second);
+    m_impl->m_blocks.erase(it);
+  }
+  m_impl->unlock();
+}
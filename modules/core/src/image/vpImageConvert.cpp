@@ -45,9 +45,11 @@
 
 #include <sstream>
 #include <map>
+#include <string.h>
 
 // image
 #include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpThreadPool.h>
 
 #if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
 #  include <emmintrin.h>
@@ -63,6 +65,19 @@
 #  endif
 #endif
 
+// AVX2 kernels compiled with a target attribute and selected at run time
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    ((defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 5) || (defined(__clang__) && __clang_major__ >= 4))
+#  include <immintrin.h>
+#  define VISP_HAVE_AVX2_DISPATCH 1
+#  define VP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define VISP_HAVE_NEON 1
+#endif
+
 
 bool vpImageConvert::YCbCrLUTcomputed = false;
 int vpImageConvert::vpCrr[256];
@@ -70,6 +85,868 @@ int vpImageConvert::vpCgb[256];
 int vpImageConvert::vpCgr[256];
 int vpImageConvert::vpCbb[256];
 
+namespace {
+  /*
+    Vectorized kernels of the most used conversions. The SSE2 and SSSE3 versions are
+    selected at build time, the AVX2 ones at run time when the processor supports
+    them. All the versions compute exactly the same fixed-point formulas as the
+    scalar code, so that the result does not depend on the processor.
+  */
+  enum vpConvertSimd { CONVERT_SCALAR, CONVERT_SSE2, CONVERT_AVX2, CONVERT_NEON };
+
+  vpConvertSimd getConvertSimd()
+  {
+    // The detection always gives the same result, a concurrent first call is harmless
+    static int simd = -1;
+    if (simd < 0) {
+      simd = CONVERT_SCALAR;
+#if VISP_HAVE_SSE2
+      simd = CONVERT_SSE2;
+#endif
+#if VISP_HAVE_NEON
+      simd = CONVERT_NEON;
+#endif
+#if VISP_HAVE_AVX2_DISPATCH
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2"))
+        simd = CONVERT_AVX2;
+#endif
+    }
+    return (vpConvertSimd)simd;
+  }
+
+  // Below this number of pixels the conversions are not split between threads
+  const unsigned int PARALLEL_MIN_PIXELS = 1 << 19;
+
+  // Luminance weights 0.2126, 0.7152 and 0.0722 scaled by 2^15 (their sum is exactly 2^15)
+  const int GREY_WR = 6966;
+  const int GREY_WG = 23436;
+  const int GREY_WB = 2366;
+
+  // Chroma weights of YUV420ToRGBa(), 0.354 and 0.707 scaled by 2^16
+  const int YUV420_WU = 23200;
+  const int YUV420_WV = 46334;
+
+  // Convert n pixels
+  typedef void (*vpConvertFunction)(const unsigned char *src, unsigned char *dst, unsigned int n);
+
+  //--------------------------------------------------------------------------
+  // RGB, BGR and RGBa to grey
+  //--------------------------------------------------------------------------
+  template <unsigned int step, bool bgr>
+  void colorToGreyScalar(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    const int wr = bgr ? GREY_WB : GREY_WR;
+    const int wb = bgr ? GREY_WR : GREY_WB;
+    for (unsigned int i = 0; i < n; i++, src += step)
+      dst[i] = (unsigned char)((wr*src[0] + GREY_WG*src[1] + wb*src[2]) >> 15);
+  }
+
+#if VISP_HAVE_SSE2
+  // Grey levels of 4 pixels stored in 32 bits with R, G, B in their 3 lower bytes
+  inline __m128i rgbxToGreySSE2(const __m128i &px, const __m128i &coeff_rg, const __m128i &coeff_b)
+  {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    // R in the low 16 bits and G in the high 16 bits of each 32 bits
+    const __m128i rg = _mm_or_si128(_mm_and_si128(px, mask), _mm_slli_epi32(_mm_and_si128(px, _mm_set1_epi32(0xFF00)), 8));
+    const __m128i b = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+    return _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(rg, coeff_rg), _mm_madd_epi16(b, coeff_b)), 15);
+  }
+
+  inline void storeGreySSE2(unsigned char *dst, const __m128i &g0, const __m128i &g1, const __m128i &g2, const __m128i &g3)
+  {
+    _mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(_mm_packs_epi32(g0, g1), _mm_packs_epi32(g2, g3)));
+  }
+
+  template <bool bgr>
+  void rgbaToGreySSE2(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    const __m128i coeff_rg = bgr ? _mm_set1_epi32(GREY_WB | (GREY_WG << 16)) : _mm_set1_epi32(GREY_WR | (GREY_WG << 16));
+    const __m128i coeff_b = _mm_set1_epi32(bgr ? GREY_WR : GREY_WB);
+    unsigned int i = 0;
+    for (; i + 16 <= n; i += 16, src += 64) {
+      const __m128i g0 = rgbxToGreySSE2(_mm_loadu_si128((const __m128i *)src), coeff_rg, coeff_b);
+      const __m128i g1 = rgbxToGreySSE2(_mm_loadu_si128((const __m128i *)(src + 16)), coeff_rg, coeff_b);
+      const __m128i g2 = rgbxToGreySSE2(_mm_loadu_si128((const __m128i *)(src + 32)), coeff_rg, coeff_b);
+      const __m128i g3 = rgbxToGreySSE2(_mm_loadu_si128((const __m128i *)(src + 48)), coeff_rg, coeff_b);
+      storeGreySSE2(dst + i, g0, g1, g2, g3);
+    }
+    colorToGreyScalar<4, bgr>(src, dst + i, n - i);
+  }
+
+#if VISP_HAVE_SSSE3
+  template <bool bgr>
+  void rgbToGreySSSE3(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    const __m128i coeff_rg = bgr ? _mm_set1_epi32(GREY_WB | (GREY_WG << 16)) : _mm_set1_epi32(GREY_WR | (GREY_WG << 16));
+    const __m128i coeff_b = _mm_set1_epi32(bgr ? GREY_WR : GREY_WB);
+    // Expand 4 packed pixels to 32 bits each, from the first or the last 12 bytes of a load
+    const __m128i expand_first = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i expand_last = _mm_setr_epi8(4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+    unsigned int i = 0;
+    for (; i + 16 <= n; i += 16, src += 48) {
+      const __m128i g0 = rgbxToGreySSE2(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src), expand_first), coeff_rg, coeff_b);
+      const __m128i g1 = rgbxToGreySSE2(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 12)), expand_first), coeff_rg, coeff_b);
+      const __m128i g2 = rgbxToGreySSE2(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 24)), expand_first), coeff_rg, coeff_b);
+      const __m128i g3 = rgbxToGreySSE2(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 32)), expand_last), coeff_rg, coeff_b);
+      storeGreySSE2(dst + i, g0, g1, g2, g3);
+    }
+    colorToGreyScalar<3, bgr>(src, dst + i, n - i);
+  }
+#endif
+#endif
+
+#if VISP_HAVE_AVX2_DISPATCH
+  VP_TARGET_AVX2
+  inline __m256i rgbxToGreyAVX2(const __m256i &px, const __m256i &coeff_rg, const __m256i &coeff_b)
+  {
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    const __m256i rg = _mm256_or_si256(_mm256_and_si256(px, mask), _mm256_slli_epi32(_mm256_and_si256(px, _mm256_set1_epi32(0xFF00)), 8));
+    const __m256i b = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask);
+    return _mm256_srli_epi32(_mm256_add_epi32(_mm256_madd_epi16(rg, coeff_rg), _mm256_madd_epi16(b, coeff_b)), 15);
+  }
+
+  VP_TARGET_AVX2
+  inline void storeGreyAVX2(unsigned char *dst, const __m256i &g0, const __m256i &g1, const __m256i &g2, const __m256i &g3)
+  {
+    // The packs work inside each 128 bits lane, the permutation puts the groups of 4 pixels back in order
+    const __m256i g = _mm256_packus_epi16(_mm256_packs_epi32(g0, g1), _mm256_packs_epi32(g2, g3));
+    _mm256_storeu_si256((__m256i *)dst, _mm256_permutevar8x32_epi32(g, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+  }
+
+  template <bool bgr>
+  VP_TARGET_AVX2
+  void rgbaToGreyAVX2(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    const __m256i coeff_rg = bgr ? _mm256_set1_epi32(GREY_WB | (GREY_WG << 16)) : _mm256_set1_epi32(GREY_WR | (GREY_WG << 16));
+    const __m256i coeff_b = _mm256_set1_epi32(bgr ? GREY_WR : GREY_WB);
+    unsigned int i = 0;
+    for (; i + 32 <= n; i += 32, src += 128) {
+      const __m256i g0 = rgbxToGreyAVX2(_mm256_loadu_si256((const __m256i *)src), coeff_rg, coeff_b);
+      const __m256i g1 = rgbxToGreyAVX2(_mm256_loadu_si256((const __m256i *)(src + 32)), coeff_rg, coeff_b);
+      const __m256i g2 = rgbxToGreyAVX2(_mm256_loadu_si256((const __m256i *)(src + 64)), coeff_rg, coeff_b);
+      const __m256i g3 = rgbxToGreyAVX2(_mm256_loadu_si256((const __m256i *)(src + 96)), coeff_rg, coeff_b);
+      storeGreyAVX2(dst + i, g0, g1, g2, g3);
+    }
+    colorToGreyScalar<4, bgr>(src, dst + i, n - i);
+  }
+
+  // Load 8 packed pixels, the two halves from src and src+offset, and expand them to 32 bits
+  VP_TARGET_AVX2
+  inline __m256i loadRGBAVX2(const unsigned char *src, const unsigned int offset, const __m256i &expand)
+  {
+    const __m256i px = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)src)),
+                                               _mm_loadu_si128((const __m128i *)(src + offset)), 1);
+    return _mm256_shuffle_epi8(px, expand);
+  }
+
+  template <bool bgr>
+  VP_TARGET_AVX2
+  void rgbToGreyAVX2(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    const __m256i coeff_rg = bgr ? _mm256_set1_epi32(GREY_WB | (GREY_WG << 16)) : _mm256_set1_epi32(GREY_WR | (GREY_WG << 16));
+    const __m256i coeff_b = _mm256_set1_epi32(bgr ? GREY_WR : GREY_WB);
+    const __m256i expand = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    // For the last 4 pixels the load ends with them to stay inside the buffer
+    const __m256i expand_last = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                                 4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+    unsigned int i = 0;
+    for (; i + 32 <= n; i += 32, src += 96) {
+      const __m256i g0 = rgbxToGreyAVX2(loadRGBAVX2(src, 12, expand), coeff_rg, coeff_b);
+      const __m256i g1 = rgbxToGreyAVX2(loadRGBAVX2(src + 24, 12, expand), coeff_rg, coeff_b);
+      const __m256i g2 = rgbxToGreyAVX2(loadRGBAVX2(src + 48, 12, expand), coeff_rg, coeff_b);
+      const __m256i g3 = rgbxToGreyAVX2(loadRGBAVX2(src + 72, 8, expand_last), coeff_rg, coeff_b);
+      storeGreyAVX2(dst + i, g0, g1, g2, g3);
+    }
+    colorToGreyScalar<3, bgr>(src, dst + i, n - i);
+  }
+#endif
+
+#if VISP_HAVE_NEON
+  inline uint8x8_t rgbToGreyNEON(const uint8x8_t &r, const uint8x8_t &g, const uint8x8_t &b, const bool bgr)
+  {
+    const uint16x8_t r16 = vmovl_u8(bgr ? b : r);
+    const uint16x8_t g16 = vmovl_u8(g);
+    const uint16x8_t b16 = vmovl_u8(bgr ? r : b);
+    uint32x4_t lo = vmull_n_u16(vget_low_u16(r16), GREY_WR);
+    uint32x4_t hi = vmull_n_u16(vget_high_u16(r16), GREY_WR);
+    lo = vmlal_n_u16(lo, vget_low_u16(g16), GREY_WG);
+    hi = vmlal_n_u16(hi, vget_high_u16(g16), GREY_WG);
+    lo = vmlal_n_u16(lo, vget_low_u16(b16), GREY_WB);
+    hi = vmlal_n_u16(hi, vget_high_u16(b16), GREY_WB);
+    return vmovn_u16(vcombine_u16(vshrn_n_u32(lo, 15), vshrn_n_u32(hi, 15)));
+  }
+
+  template <bool bgr>
+  void rgbaToGreyNEON(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    unsigned int i = 0;
+    for (; i + 8 <= n; i += 8, src += 32) {
+      const uint8x8x4_t px = vld4_u8(src);
+      vst1_u8(dst + i, rgbToGreyNEON(px.val[0], px.val[1], px.val[2], bgr));
+    }
+    colorToGreyScalar<4, bgr>(src, dst + i, n - i);
+  }
+
+  template <bool bgr>
+  void rgbToGreyNEON(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    unsigned int i = 0;
+    for (; i + 8 <= n; i += 8, src += 24) {
+      const uint8x8x3_t px = vld3_u8(src);
+      vst1_u8(dst + i, rgbToGreyNEON(px.val[0], px.val[1], px.val[2], bgr));
+    }
+    colorToGreyScalar<3, bgr>(src, dst + i, n - i);
+  }
+#endif
+
+  template <bool bgr>
+  vpConvertFunction getRGBaToGreyFunction()
+  {
+    switch (getConvertSimd()) {
+#if VISP_HAVE_AVX2_DISPATCH
+    case CONVERT_AVX2:
+      return rgbaToGreyAVX2<bgr>;
+#endif
+#if VISP_HAVE_SSE2
+    case CONVERT_SSE2:
+      return rgbaToGreySSE2<bgr>;
+#endif
+#if VISP_HAVE_NEON
+    case CONVERT_NEON:
+      return rgbaToGreyNEON<bgr>;
+#endif
+    default:
+      return colorToGreyScalar<4, bgr>;
+    }
+  }
+
+  template <bool bgr>
+  vpConvertFunction getRGBToGreyFunction()
+  {
+    switch (getConvertSimd()) {
+#if VISP_HAVE_AVX2_DISPATCH
+    case CONVERT_AVX2:
+      return rgbToGreyAVX2<bgr>;
+#endif
+#if VISP_HAVE_SSSE3
+    case CONVERT_SSE2:
+      return rgbToGreySSSE3<bgr>;
+#endif
+#if VISP_HAVE_NEON
+    case CONVERT_NEON:
+      return rgbToGreyNEON<bgr>;
+#endif
+    default:
+      return colorToGreyScalar<3, bgr>;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  // YUYV and UYVY (YUV422) to grey: keep one byte out of two
+  //--------------------------------------------------------------------------
+  template <unsigned int offset>
+  void yuv422ToGreyScalar(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    for (unsigned int i = 0; i < n; i++)
+      dst[i] = src[2*i + offset];
+  }
+
+#if VISP_HAVE_SSE2
+  template <unsigned int offset>
+  void yuv422ToGreySSE2(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    const __m128i mask = _mm_set1_epi16(0xFF);
+    unsigned int i = 0;
+    for (; i + 16 <= n; i += 16) {
+      __m128i lo = _mm_loadu_si128((const __m128i *)(src + 2*i));
+      __m128i hi = _mm_loadu_si128((const __m128i *)(src + 2*i + 16));
+      if (offset == 0) {
+        lo = _mm_and_si128(lo, mask);
+        hi = _mm_and_si128(hi, mask);
+      }
+      else {
+        lo = _mm_srli_epi16(lo, 8);
+        hi = _mm_srli_epi16(hi, 8);
+      }
+      _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    yuv422ToGreyScalar<offset>(src + 2*i, dst + i, n - i);
+  }
+#endif
+
+#if VISP_HAVE_AVX2_DISPATCH
+  template <unsigned int offset>
+  VP_TARGET_AVX2
+  void yuv422ToGreyAVX2(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    const __m256i mask = _mm256_set1_epi16(0xFF);
+    unsigned int i = 0;
+    for (; i + 32 <= n; i += 32) {
+      __m256i lo = _mm256_loadu_si256((const __m256i *)(src + 2*i));
+      __m256i hi = _mm256_loadu_si256((const __m256i *)(src + 2*i + 32));
+      if (offset == 0) {
+        lo = _mm256_and_si256(lo, mask);
+        hi = _mm256_and_si256(hi, mask);
+      }
+      else {
+        lo = _mm256_srli_epi16(lo, 8);
+        hi = _mm256_srli_epi16(hi, 8);
+      }
+      _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8));
+    }
+    yuv422ToGreyScalar<offset>(src + 2*i, dst + i, n - i);
+  }
+#endif
+
+#if VISP_HAVE_NEON
+  template <unsigned int offset>
+  void yuv422ToGreyNEON(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    unsigned int i = 0;
+    for (; i + 16 <= n; i += 16)
+      vst1q_u8(dst + i, vld2q_u8(src + 2*i).val[offset]);
+    yuv422ToGreyScalar<offset>(src + 2*i, dst + i, n - i);
+  }
+#endif
+
+  template <unsigned int offset>
+  vpConvertFunction getYUV422ToGreyFunction()
+  {
+    switch (getConvertSimd()) {
+#if VISP_HAVE_AVX2_DISPATCH
+    case CONVERT_AVX2:
+      return yuv422ToGreyAVX2<offset>;
+#endif
+#if VISP_HAVE_SSE2
+    case CONVERT_SSE2:
+      return yuv422ToGreySSE2<offset>;
+#endif
+#if VISP_HAVE_NEON
+    case CONVERT_NEON:
+      return yuv422ToGreyNEON<offset>;
+#endif
+    default:
+      return yuv422ToGreyScalar<offset>;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  // YUYV to RGBa
+  //--------------------------------------------------------------------------
+  inline unsigned char saturate(const int c)
+  {
+    return (unsigned char)((c & (~255)) ? (c < 0 ? 0 : 255) : c);
+  }
+
+  // n is the number of pixels, it has to be even
+  void yuyvToRGBaScalar(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    for (unsigned int c = n / 2; c > 0; c--, src += 4, dst += 8) {
+      const int y1 = src[0];
+      const int y2 = src[2];
+      const int cb = ((src[1] - 128) * 454) >> 8;
+      const int cr = ((src[3] - 128) * 359) >> 8;
+      const int cg = ((src[1] - 128) * 88 + (src[3] - 128) * 183) >> 8;
+
+      dst[0] = saturate(y1 + cr);
+      dst[1] = saturate(y1 - cg);
+      dst[2] = saturate(y1 + cb);
+      dst[3] = vpRGBa::alpha_default;
+      dst[4] = saturate(y2 + cr);
+      dst[5] = saturate(y2 - cg);
+      dst[6] = saturate(y2 + cb);
+      dst[7] = vpRGBa::alpha_default;
+    }
+  }
+
+#if VISP_HAVE_SSE2
+  void yuyvToRGBaSSE2(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    const __m128i mask_y = _mm_set1_epi16(0xFF);
+    const __m128i offset = _mm_set1_epi16(128);
+    // Coefficients applied to the (u, v) pairs
+    const __m128i coeff_cb = _mm_set1_epi32(454);
+    const __m128i coeff_cr = _mm_set1_epi32(359 << 16);
+    const __m128i coeff_cg = _mm_set1_epi32(88 | (183 << 16));
+    const __m128i alpha = _mm_set1_epi8((char)vpRGBa::alpha_default);
+    unsigned int i = 0;
+    for (; i + 8 <= n; i += 8, src += 16, dst += 32) {
+      const __m128i data = _mm_loadu_si128((const __m128i *)src);
+      const __m128i y = _mm_and_si128(data, mask_y);
+      const __m128i uv = _mm_sub_epi16(_mm_srli_epi16(data, 8), offset);
+
+      // One chroma value for 2 pixels, duplicated to 16 bits per pixel
+      __m128i cb = _mm_srai_epi32(_mm_madd_epi16(uv, coeff_cb), 8);
+      __m128i cr = _mm_srai_epi32(_mm_madd_epi16(uv, coeff_cr), 8);
+      __m128i cg = _mm_srai_epi32(_mm_madd_epi16(uv, coeff_cg), 8);
+      cb = _mm_packs_epi32(cb, cb);
+      cr = _mm_packs_epi32(cr, cr);
+      cg = _mm_packs_epi32(cg, cg);
+      cb = _mm_unpacklo_epi16(cb, cb);
+      cr = _mm_unpacklo_epi16(cr, cr);
+      cg = _mm_unpacklo_epi16(cg, cg);
+
+      const __m128i r = _mm_packus_epi16(_mm_add_epi16(y, cr), _mm_setzero_si128());
+      const __m128i g = _mm_packus_epi16(_mm_sub_epi16(y, cg), _mm_setzero_si128());
+      const __m128i b = _mm_packus_epi16(_mm_add_epi16(y, cb), _mm_setzero_si128());
+      const __m128i rg = _mm_unpacklo_epi8(r, g);
+      const __m128i ba = _mm_unpacklo_epi8(b, alpha);
+      _mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(rg, ba));
+      _mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(rg, ba));
+    }
+    yuyvToRGBaScalar(src, dst, n - i);
+  }
+#endif
+
+#if VISP_HAVE_AVX2_DISPATCH
+  VP_TARGET_AVX2
+  void yuyvToRGBaAVX2(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    const __m256i mask_y = _mm256_set1_epi16(0xFF);
+    const __m256i offset = _mm256_set1_epi16(128);
+    const __m256i coeff_cb = _mm256_set1_epi32(454);
+    const __m256i coeff_cr = _mm256_set1_epi32(359 << 16);
+    const __m256i coeff_cg = _mm256_set1_epi32(88 | (183 << 16));
+    const __m256i alpha = _mm256_set1_epi8((char)vpRGBa::alpha_default);
+    unsigned int i = 0;
+    for (; i + 16 <= n; i += 16, src += 32, dst += 64) {
+      const __m256i data = _mm256_loadu_si256((const __m256i *)src);
+      const __m256i y = _mm256_and_si256(data, mask_y);
+      const __m256i uv = _mm256_sub_epi16(_mm256_srli_epi16(data, 8), offset);
+
+      __m256i cb = _mm256_srai_epi32(_mm256_madd_epi16(uv, coeff_cb), 8);
+      __m256i cr = _mm256_srai_epi32(_mm256_madd_epi16(uv, coeff_cr), 8);
+      __m256i cg = _mm256_srai_epi32(_mm256_madd_epi16(uv, coeff_cg), 8);
+      cb = _mm256_packs_epi32(cb, cb);
+      cr = _mm256_packs_epi32(cr, cr);
+      cg = _mm256_packs_epi32(cg, cg);
+      cb = _mm256_unpacklo_epi16(cb, cb);
+      cr = _mm256_unpacklo_epi16(cr, cr);
+      cg = _mm256_unpacklo_epi16(cg, cg);
+
+      // Everything stays inside the 128 bits lanes: pixels 0-7 in the low lane, 8-15 in the high one
+      const __m256i zero = _mm256_setzero_si256();
+      const __m256i r = _mm256_packus_epi16(_mm256_add_epi16(y, cr), zero);
+      const __m256i g = _mm256_packus_epi16(_mm256_sub_epi16(y, cg), zero);
+      const __m256i b = _mm256_packus_epi16(_mm256_add_epi16(y, cb), zero);
+      const __m256i rg = _mm256_unpacklo_epi8(r, g);
+      const __m256i ba = _mm256_unpacklo_epi8(b, alpha);
+      const __m256i lo = _mm256_unpacklo_epi16(rg, ba);
+      const __m256i hi = _mm256_unpackhi_epi16(rg, ba);
+      _mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(lo, hi, 0x20));
+      _mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    yuyvToRGBaScalar(src, dst, n - i);
+  }
+#endif
+
+#if VISP_HAVE_NEON
+  void yuyvToRGBaNEON(const unsigned char *src, unsigned char *dst, unsigned int n)
+  {
+    const int16x8_t offset = vdupq_n_s16(128);
+    unsigned int i = 0;
+    for (; i + 16 <= n; i += 16, src += 32, dst += 64) {
+      // val[0]: y of the even pixels, val[1]: u, val[2]: y of the odd pixels, val[3]: v
+      const uint8x8x4_t data = vld4_u8(src);
+      const int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(data.val[1])), offset);
+      const int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(data.val[3])), offset);
+
+      const int16x8_t cb = vcombine_s16(vshrn_n_s32(vmull_n_s16(vget_low_s16(u), 454), 8),
+                                        vshrn_n_s32(vmull_n_s16(vget_high_s16(u), 454), 8));
+      const int16x8_t cr = vcombine_s16(vshrn_n_s32(vmull_n_s16(vget_low_s16(v), 359), 8),
+                                        vshrn_n_s32(vmull_n_s16(vget_high_s16(v), 359), 8));
+      const int16x8_t cg = vcombine_s16(vshrn_n_s32(vmlal_n_s16(vmull_n_s16(vget_low_s16(u), 88), vget_low_s16(v), 183), 8),
+                                        vshrn_n_s32(vmlal_n_s16(vmull_n_s16(vget_high_s16(u), 88), vget_high_s16(v), 183), 8));
+
+      const int16x8_t y0 = vreinterpretq_s16_u16(vmovl_u8(data.val[0]));
+      const int16x8_t y1 = vreinterpretq_s16_u16(vmovl_u8(data.val[2]));
+      const uint8x8x2_t r = vzip_u8(vqmovun_s16(vaddq_s16(y0, cr)), vqmovun_s16(vaddq_s16(y1, cr)));
+      const uint8x8x2_t g = vzip_u8(vqmovun_s16(vsubq_s16(y0, cg)), vqmovun_s16(vsubq_s16(y1, cg)));
+      const uint8x8x2_t b = vzip_u8(vqmovun_s16(vaddq_s16(y0, cb)), vqmovun_s16(vaddq_s16(y1, cb)));
+      const uint8x8_t alpha = vdup_n_u8(vpRGBa::alpha_default);
+      for (unsigned int k = 0; k < 2; k++) {
+        uint8x8x4_t rgba;
+        rgba.val[0] = r.val[k];
+        rgba.val[1] = g.val[k];
+        rgba.val[2] = b.val[k];
+        rgba.val[3] = alpha;
+        vst4_u8(dst + 32*k, rgba);
+      }
+    }
+    yuyvToRGBaScalar(src, dst, n - i);
+  }
+#endif
+
+  vpConvertFunction getYUYVToRGBaFunction()
+  {
+    switch (getConvertSimd()) {
+#if VISP_HAVE_AVX2_DISPATCH
+    case CONVERT_AVX2:
+      return yuyvToRGBaAVX2;
+#endif
+#if VISP_HAVE_SSE2
+    case CONVERT_SSE2:
+      return yuyvToRGBaSSE2;
+#endif
+#if VISP_HAVE_NEON
+    case CONVERT_NEON:
+      return yuyvToRGBaNEON;
+#endif
+    default:
+      return yuyvToRGBaScalar;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  // YUV420 to RGBa, two rows sharing the same chroma at a time
+  //--------------------------------------------------------------------------
+  typedef void (*vpConvertYUV420Function)(const unsigned char *y0, const unsigned char *y1,
+                                          const unsigned char *u, const unsigned char *v,
+                                          unsigned char *rgba0, unsigned char *rgba1, unsigned int width);
+
+  // (int)(c * w / 2^16) rounded toward zero like the cast of a double
+  inline int scaleChroma(const int c, const int w)
+  {
+    const int a = c * w;
+    return (a + ((a >> 31) & 0xFFFF)) >> 16;
+  }
+
+  inline void storeRGBa(unsigned char *dst, const int R, const int G, const int B)
+  {
+    dst[0] = saturate(R);
+    dst[1] = saturate(G);
+    dst[2] = saturate(B);
+    dst[3] = vpRGBa::alpha_default;
+  }
+
+  void yuv420ToRGBaScalar(const unsigned char *y0, const unsigned char *y1,
+                          const unsigned char *u, const unsigned char *v,
+                          unsigned char *rgba0, unsigned char *rgba1, unsigned int width)
+  {
+    // Original equations
+    // R = Y           + 1.402 V
+    // G = Y - 0.344 U - 0.714 V
+    // B = Y + 1.772 U
+    for (unsigned int j = 0; j < width / 2; j++) {
+      const int U = scaleChroma(u[j] - 128, YUV420_WU);
+      const int V = scaleChroma(v[j] - 128, YUV420_WV);
+      const int V2 = 2*V;
+      const int U5 = 5*U;
+      const int UV = - U - V;
+      storeRGBa(rgba0 + 8*j,     y0[2*j]     + V2, y0[2*j]     + UV, y0[2*j]     + U5);
+      storeRGBa(rgba0 + 8*j + 4, y0[2*j + 1] + V2, y0[2*j + 1] + UV, y0[2*j + 1] + U5);
+      storeRGBa(rgba1 + 8*j,     y1[2*j]     + V2, y1[2*j]     + UV, y1[2*j]     + U5);
+      storeRGBa(rgba1 + 8*j + 4, y1[2*j + 1] + V2, y1[2*j + 1] + UV, y1[2*j + 1] + U5);
+    }
+  }
+
+#if VISP_HAVE_SSE2
+  // Scale 8 chroma values in [-128, 127] rounding toward zero
+  inline __m128i scaleChromaSSE2(const __m128i &c, const __m128i &w)
+  {
+    const __m128i sign = _mm_srai_epi16(c, 15);
+    const __m128i abs = _mm_sub_epi16(_mm_xor_si128(c, sign), sign);
+    const __m128i scaled = _mm_mulhi_epu16(abs, w);
+    return _mm_sub_epi16(_mm_xor_si128(scaled, sign), sign);
+  }
+
+  // Convert and store 16 pixels of a row
+  inline void yuv420RowSSE2(const unsigned char *y, const __m128i (&chroma)[6], const __m128i &alpha, unsigned char *dst)
+  {
+    const __m128i data = _mm_loadu_si128((const __m128i *)y);
+    const __m128i lo = _mm_unpacklo_epi8(data, _mm_setzero_si128());
+    const __m128i hi = _mm_unpackhi_epi8(data, _mm_setzero_si128());
+    const __m128i r = _mm_packus_epi16(_mm_add_epi16(lo, chroma[0]), _mm_add_epi16(hi, chroma[1]));
+    const __m128i g = _mm_packus_epi16(_mm_add_epi16(lo, chroma[2]), _mm_add_epi16(hi, chroma[3]));
+    const __m128i b = _mm_packus_epi16(_mm_add_epi16(lo, chroma[4]), _mm_add_epi16(hi, chroma[5]));
+    const __m128i rg_lo = _mm_unpacklo_epi8(r, g);
+    const __m128i rg_hi = _mm_unpackhi_epi8(r, g);
+    const __m128i ba_lo = _mm_unpacklo_epi8(b, alpha);
+    const __m128i ba_hi = _mm_unpackhi_epi8(b, alpha);
+    _mm_storeu_si128((__m128i *)dst,        _mm_unpacklo_epi16(rg_lo, ba_lo));
+    _mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(rg_lo, ba_lo));
+    _mm_storeu_si128((__m128i *)(dst + 32), _mm_unpacklo_epi16(rg_hi, ba_hi));
+    _mm_storeu_si128((__m128i *)(dst + 48), _mm_unpackhi_epi16(rg_hi, ba_hi));
+  }
+
+  void yuv420ToRGBaSSE2(const unsigned char *y0, const unsigned char *y1,
+                        const unsigned char *u, const unsigned char *v,
+                        unsigned char *rgba0, unsigned char *rgba1, unsigned int width)
+  {
+    const __m128i offset = _mm_set1_epi16(128);
+    const __m128i wu = _mm_set1_epi16((short)YUV420_WU);
+    const __m128i wv = _mm_set1_epi16((short)YUV420_WV);
+    const __m128i alpha = _mm_set1_epi8((char)vpRGBa::alpha_default);
+    unsigned int j = 0;
+    for (; j + 16 <= width; j += 16) {
+      const __m128i U = scaleChromaSSE2(_mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(u + j/2)), _mm_setzero_si128()), offset), wu);
+      const __m128i V = scaleChromaSSE2(_mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(v + j/2)), _mm_setzero_si128()), offset), wv);
+      const __m128i V2 = _mm_add_epi16(V, V);
+      const __m128i UV = _mm_sub_epi16(_mm_setzero_si128(), _mm_add_epi16(U, V));
+      const __m128i U5 = _mm_add_epi16(_mm_slli_epi16(U, 2), U);
+      // Each chroma value is shared by 2 consecutive pixels
+      const __m128i chroma[6] = {
+        _mm_unpacklo_epi16(V2, V2), _mm_unpackhi_epi16(V2, V2),
+        _mm_unpacklo_epi16(UV, UV), _mm_unpackhi_epi16(UV, UV),
+        _mm_unpacklo_epi16(U5, U5), _mm_unpackhi_epi16(U5, U5)
+      };
+      yuv420RowSSE2(y0 + j, chroma, alpha, rgba0 + 4*j);
+      yuv420RowSSE2(y1 + j, chroma, alpha, rgba1 + 4*j);
+    }
+    yuv420ToRGBaScalar(y0 + j, y1 + j, u + j/2, v + j/2, rgba0 + 4*j, rgba1 + 4*j, width - j);
+  }
+#endif
+
+#if VISP_HAVE_AVX2_DISPATCH
+  VP_TARGET_AVX2
+  inline __m256i scaleChromaAVX2(const __m256i &c, const __m256i &w)
+  {
+    return _mm256_sign_epi16(_mm256_mulhi_epu16(_mm256_abs_epi16(c), w), c);
+  }
+
+  VP_TARGET_AVX2
+  inline void yuv420RowAVX2(const unsigned char *y, const __m256i (&chroma)[6], const __m256i &alpha, unsigned char *dst)
+  {
+    // The unpacks work inside the 128 bits lanes: lo holds pixels 0-7 and 16-23, hi pixels 8-15 and 24-31,
+    // which matches the duplicated chroma
+    const __m256i data = _mm256_loadu_si256((const __m256i *)y);
+    const __m256i lo = _mm256_unpacklo_epi8(data, _mm256_setzero_si256());
+    const __m256i hi = _mm256_unpackhi_epi8(data, _mm256_setzero_si256());
+    const __m256i r = _mm256_packus_epi16(_mm256_add_epi16(lo, chroma[0]), _mm256_add_epi16(hi, chroma[1]));
+    const __m256i g = _mm256_packus_epi16(_mm256_add_epi16(lo, chroma[2]), _mm256_add_epi16(hi, chroma[3]));
+    const __m256i b = _mm256_packus_epi16(_mm256_add_epi16(lo, chroma[4]), _mm256_add_epi16(hi, chroma[5]));
+    const __m256i rg_lo = _mm256_unpacklo_epi8(r, g);
+    const __m256i rg_hi = _mm256_unpackhi_epi8(r, g);
+    const __m256i ba_lo = _mm256_unpacklo_epi8(b, alpha);
+    const __m256i ba_hi = _mm256_unpackhi_epi8(b, alpha);
+    const __m256i q0 = _mm256_unpacklo_epi16(rg_lo, ba_lo);
+    const __m256i q1 = _mm256_unpackhi_epi16(rg_lo, ba_lo);
+    const __m256i q2 = _mm256_unpacklo_epi16(rg_hi, ba_hi);
+    const __m256i q3 = _mm256_unpackhi_epi16(rg_hi, ba_hi);
+    _mm256_storeu_si256((__m256i *)dst,        _mm256_permute2x128_si256(q0, q1, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(q2, q3, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 64), _mm256_permute2x128_si256(q0, q1, 0x31));
+    _mm256_storeu_si256((__m256i *)(dst + 96), _mm256_permute2x128_si256(q2, q3, 0x31));
+  }
+
+  VP_TARGET_AVX2
+  void yuv420ToRGBaAVX2(const unsigned char *y0, const unsigned char *y1,
+                        const unsigned char *u, const unsigned char *v,
+                        unsigned char *rgba0, unsigned char *rgba1, unsigned int width)
+  {
+    const __m256i offset = _mm256_set1_epi16(128);
+    const __m256i wu = _mm256_set1_epi16((short)YUV420_WU);
+    const __m256i wv = _mm256_set1_epi16((short)YUV420_WV);
+    const __m256i alpha = _mm256_set1_epi8((char)vpRGBa::alpha_default);
+    unsigned int j = 0;
+    for (; j + 32 <= width; j += 32) {
+      const __m256i U = scaleChromaAVX2(_mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(u + j/2))), offset), wu);
+      const __m256i V = scaleChromaAVX2(_mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(v + j/2))), offset), wv);
+      const __m256i V2 = _mm256_add_epi16(V, V);
+      const __m256i UV = _mm256_sub_epi16(_mm256_setzero_si256(), _mm256_add_epi16(U, V));
+      const __m256i U5 = _mm256_add_epi16(_mm256_slli_epi16(U, 2), U);
+      const __m256i chroma[6] = {
+        _mm256_unpacklo_epi16(V2, V2), _mm256_unpackhi_epi16(V2, V2),
+        _mm256_unpacklo_epi16(UV, UV), _mm256_unpackhi_epi16(UV, UV),
+        _mm256_unpacklo_epi16(U5, U5), _mm256_unpackhi_epi16(U5, U5)
+      };
+      yuv420RowAVX2(y0 + j, chroma, alpha, rgba0 + 4*j);
+      yuv420RowAVX2(y1 + j, chroma, alpha, rgba1 + 4*j);
+    }
+    yuv420ToRGBaScalar(y0 + j, y1 + j, u + j/2, v + j/2, rgba0 + 4*j, rgba1 + 4*j, width - j);
+  }
+#endif
+
+#if VISP_HAVE_NEON
+  inline int16x8_t scaleChromaNEON(const int16x8_t &c, const uint16_t w)
+  {
+    const uint16x8_t abs = vreinterpretq_u16_s16(vabsq_s16(c));
+    const int16x8_t scaled = vreinterpretq_s16_u16(vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(abs), w), 16),
+                                                                vshrn_n_u32(vmull_n_u16(vget_high_u16(abs), w), 16)));
+    return vbslq_s16(vcltq_s16(c, vdupq_n_s16(0)), vnegq_s16(scaled), scaled);
+  }
+
+  inline void yuv420RowNEON(const unsigned char *y, const int16x8x2_t &V2, const int16x8x2_t &UV, const int16x8x2_t &U5,
+                            unsigned char *dst)
+  {
+    const uint8x16_t data = vld1q_u8(y);
+    const int16x8_t lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(data)));
+    const int16x8_t hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(data)));
+    uint8x16x4_t rgba;
+    rgba.val[0] = vcombine_u8(vqmovun_s16(vaddq_s16(lo, V2.val[0])), vqmovun_s16(vaddq_s16(hi, V2.val[1])));
+    rgba.val[1] = vcombine_u8(vqmovun_s16(vaddq_s16(lo, UV.val[0])), vqmovun_s16(vaddq_s16(hi, UV.val[1])));
+    rgba.val[2] = vcombine_u8(vqmovun_s16(vaddq_s16(lo, U5.val[0])), vqmovun_s16(vaddq_s16(hi, U5.val[1])));
+    rgba.val[3] = vdupq_n_u8(vpRGBa::alpha_default);
+    vst4q_u8(dst, rgba);
+  }
+
+  void yuv420ToRGBaNEON(const unsigned char *y0, const unsigned char *y1,
+                        const unsigned char *u, const unsigned char *v,
+                        unsigned char *rgba0, unsigned char *rgba1, unsigned int width)
+  {
+    const int16x8_t offset = vdupq_n_s16(128);
+    unsigned int j = 0;
+    for (; j + 16 <= width; j += 16) {
+      const int16x8_t U = scaleChromaNEON(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + j/2))), offset), YUV420_WU);
+      const int16x8_t V = scaleChromaNEON(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + j/2))), offset), YUV420_WV);
+      const int16x8_t V2 = vaddq_s16(V, V);
+      const int16x8_t UV = vnegq_s16(vaddq_s16(U, V));
+      const int16x8_t U5 = vaddq_s16(vshlq_n_s16(U, 2), U);
+      // Each chroma value is shared by 2 consecutive pixels
+      const int16x8x2_t V2d = vzipq_s16(V2, V2);
+      const int16x8x2_t UVd = vzipq_s16(UV, UV);
+      const int16x8x2_t U5d = vzipq_s16(U5, U5);
+      yuv420RowNEON(y0 + j, V2d, UVd, U5d, rgba0 + 4*j);
+      yuv420RowNEON(y1 + j, V2d, UVd, U5d, rgba1 + 4*j);
+    }
+    yuv420ToRGBaScalar(y0 + j, y1 + j, u + j/2, v + j/2, rgba0 + 4*j, rgba1 + 4*j, width - j);
+  }
+#endif
+
+  vpConvertYUV420Function getYUV420ToRGBaFunction()
+  {
+    switch (getConvertSimd()) {
+#if VISP_HAVE_AVX2_DISPATCH
+    case CONVERT_AVX2:
+      return yuv420ToRGBaAVX2;
+#endif
+#if VISP_HAVE_SSE2
+    case CONVERT_SSE2:
+      return yuv420ToRGBaSSE2;
+#endif
+#if VISP_HAVE_NEON
+    case CONVERT_NEON:
+      return yuv420ToRGBaNEON;
+#endif
+    default:
+      return yuv420ToRGBaScalar;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  // Split of the conversions in bands processed by the thread pool
+  //--------------------------------------------------------------------------
+  class vpConvertTask : public vpThreadPool::Task
+  {
+  public:
+    vpConvertTask(vpConvertFunction function, const unsigned char *src, const unsigned int srcStep,
+                  unsigned char *dst, const unsigned int dstStep)
+      : m_function(function), m_src(src), m_srcStep(srcStep), m_dst(dst), m_dstStep(dstStep)
+    {
+    }
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      m_function(m_src + begin*m_srcStep, m_dst + begin*m_dstStep, end - begin);
+    }
+
+  private:
+    vpConvertFunction m_function;
+    const unsigned char *m_src;
+    unsigned int m_srcStep;
+    unsigned char *m_dst;
+    unsigned int m_dstStep;
+  };
+
+  /*
+    Convert n pixels, srcStep and dstStep being the size in bytes of a source and a
+    destination pixel. Large images are split in bands of consecutive pixels.
+  */
+  void convertPixels(vpConvertFunction function, const unsigned char *src, const unsigned int srcStep,
+                     unsigned char *dst, const unsigned int dstStep, const unsigned int n)
+  {
+    vpThreadPool &pool = vpThreadPool::getInstance();
+    const unsigned int nbThreads = pool.getNumThreads();
+    if (n < PARALLEL_MIN_PIXELS || nbThreads < 2) {
+      function(src, dst, n);
+      return;
+    }
+
+    // Keep the bands a multiple of the widest vector loop
+    unsigned int grainSize = (n + nbThreads - 1) / nbThreads;
+    grainSize = (grainSize + 31) & ~31u;
+    vpConvertTask task(function, src, srcStep, dst, dstStep);
+    pool.parallelFor(0, n, task, grainSize);
+  }
+
+  class vpConvertYUV420Task : public vpThreadPool::Task
+  {
+  public:
+    vpConvertYUV420Task(vpConvertYUV420Function function, const unsigned char *yuv, unsigned char *rgba,
+                        const unsigned int width, const unsigned int height)
+      : m_function(function), m_yuv(yuv), m_rgba(rgba), m_width(width), m_height(height)
+    {
+    }
+
+    //! Convert the pairs of rows [begin, end)
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      const unsigned int size = m_width * m_height;
+      const unsigned char *u = m_yuv + size;
+      const unsigned char *v = m_yuv + 5*size/4;
+      for (unsigned int i = begin; i < end; i++) {
+        const unsigned char *y = m_yuv + 2*i*m_width;
+        unsigned char *rgba = m_rgba + 8*i*m_width;
+        m_function(y, y + m_width, u + i*(m_width/2), v + i*(m_width/2), rgba, rgba + 4*m_width, m_width);
+      }
+    }
+
+  private:
+    vpConvertYUV420Function m_function;
+    const unsigned char *m_yuv;
+    unsigned char *m_rgba;
+    unsigned int m_width;
+    unsigned int m_height;
+  };
+
+  class vpConvertFlipTask : public vpThreadPool::Task
+  {
+  public:
+    vpConvertFlipTask(vpConvertFunction function, const unsigned char *src, const unsigned int srcStep,
+                      unsigned char *dst, const unsigned int dstStep, const unsigned int width, const unsigned int height)
+      : m_function(function), m_src(src), m_srcStep(srcStep), m_dst(dst), m_dstStep(dstStep),
+        m_width(width), m_height(height)
+    {
+    }
+
+    //! Convert the rows [begin, end) of the destination, read from the bottom of the source
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      for (unsigned int i = begin; i < end; i++)
+        m_function(m_src + (m_height - 1 - i)*m_width*m_srcStep, m_dst + i*m_width*m_dstStep, m_width);
+    }
+
+  private:
+    vpConvertFunction m_function;
+    const unsigned char *m_src;
+    unsigned int m_srcStep;
+    unsigned char *m_dst;
+    unsigned int m_dstStep;
+    unsigned int m_width;
+    unsigned int m_height;
+  };
+
+  //! Convert a width x height image, flipping it vertically if needed.
+  void convertImage(vpConvertFunction function, const unsigned char *src, const unsigned int srcStep,
+                    unsigned char *dst, const unsigned int dstStep,
+                    const unsigned int width, const unsigned int height, const bool flip)
+  {
+    if (! flip) {
+      convertPixels(function, src, srcStep, dst, dstStep, width*height);
+      return;
+    }
+
+    vpConvertFlipTask task(function, src, srcStep, dst, dstStep, width, height);
+    vpThreadPool &pool = vpThreadPool::getInstance();
+    if (width*height < PARALLEL_MIN_PIXELS || pool.getNumThreads() < 2)
+      task(0, height);
+    else
+      pool.parallelFor(0, height, task, (height + pool.getNumThreads() - 1) / pool.getNumThreads());
+  }
+}
+
 
 /*!
   Convert a vpImage\<unsigned char\> to a vpImage\<vpRGBa\>.
@@ -1223,50 +2100,14 @@ void vpImageConvert::convert(const yarp::sig::ImageOf< yarp::sig::PixelRgb > *sr
 void vpImageConvert::YUYVToRGBa(unsigned char* yuyv, unsigned char* rgba,
                                 unsigned int width, unsigned int height)
 {
-  unsigned char *s;
-  unsigned char *d;
-  int w, h;
-  int r, g, b, cr, cg, cb, y1, y2;
-
-  h = (int)height;
-  w = (int)width;
-  s = yuyv;
-  d = rgba;
-  while (h--) {
-    int c = w >> 1;
-    while (c--) {
-      y1 = *s++;
-      cb = ((*s - 128) * 454) >> 8;
-      cg = (*s++ - 128) * 88;
-      y2 = *s++;
-      cr = ((*s - 128) * 359) >> 8;
-      cg = (cg + (*s++ - 128) * 183) >> 8;
-
-      r = y1 + cr;
-      b = y1 + cb;
-      g = y1 - cg;
-      vpSAT(r);
-      vpSAT(g);
-      vpSAT(b);
-
-      *d++ = static_cast<unsigned char>(r);
-      *d++ = static_cast<unsigned char>(g);
-      *d++ = static_cast<unsigned char>(b);
-      *d++ = vpRGBa::alpha_default;
-
-      r = y2 + cr;
-      b = y2 + cb;
-      g = y2 - cg;
-      vpSAT(r);
-      vpSAT(g);
-      vpSAT(b);
-
-      *d++ = static_cast<unsigned char>(r);
-      *d++ = static_cast<unsigned char>(g);
-      *d++ = static_cast<unsigned char>(b);
-      *d++ = vpRGBa::alpha_default;
-    }
+  if (width & 1) {
+    // Each row is converted by pairs of pixels, the last pixel of an odd row is skipped
+    vpConvertFunction function = getYUYVToRGBaFunction();
+    for (unsigned int i = 0; i < height; i++)
+      function(yuyv + 2*i*(width - 1), rgba + 4*i*(width - 1), width - 1);
+    return;
   }
+  convertPixels(getYUYVToRGBaFunction(), yuyv, 2, rgba, 4, width*height);
 }
 
 /*!
@@ -1331,14 +2172,7 @@ void vpImageConvert::YUYVToRGB(unsigned char* yuyv, unsigned char* rgb,
 */
 void vpImageConvert::YUYVToGrey(unsigned char* yuyv, unsigned char* grey, unsigned int size)
 {
-  unsigned int i=0,j=0;
-
-  while( j < size*2)
-  {
-    grey[i++] = yuyv[j];
-    grey[i++] = yuyv[j+2];
-    j+=4;
-  }
+  convertPixels(getYUV422ToGreyFunction<0>(), yuyv, 2, grey, 1, size);
 }
 
 
@@ -1655,14 +2489,7 @@ void vpImageConvert::YUV422ToRGB(unsigned char* yuv, unsigned char* rgb, unsigne
 */
 void vpImageConvert::YUV422ToGrey(unsigned char* yuv, unsigned char* grey, unsigned int size)
 {
-  unsigned int i=0,j=0;
-
-  while( j < size*2)
-  {
-    grey[i++] = yuv[j+1];
-    grey[i++] = yuv[j+3];
-    j+=4;
-  }
+  convertPixels(getYUV422ToGreyFunction<1>(), yuv, 2, grey, 1, size);
 }
 
 /*!
@@ -1796,96 +2623,13 @@ void vpImageConvert::YUV411ToRGB(unsigned char* yuv, unsigned char* rgb, unsigne
 void vpImageConvert::YUV420ToRGBa(unsigned char* yuv, unsigned char* rgba,
                                   unsigned int width, unsigned int height)
 {
-  //  std::cout << "call optimized ConvertYUV420ToRGBa()" << std::endl;
-  int U, V, R, G, B, V2, U5, UV;
-  int Y0, Y1, Y2, Y3;
-  unsigned int size = width*height;
-  unsigned char* iU = yuv + size;
-  unsigned char* iV = yuv + 5*size/4;
-  for(unsigned int i = 0; i<height/2; i++)
-  {
-    for(unsigned int j = 0; j < width/2 ; j++)
-    {
-      U   = (int)((*iU++ - 128) * 0.354);
-      U5  = 5*U;
-      V   = (int)((*iV++ - 128) * 0.707);
-      V2  = 2*V;
-      UV  = - U - V;
-      Y0  = *yuv++;
-      Y1  = *yuv;
-      yuv = yuv+width-1;
-      Y2  = *yuv++;
-      Y3  = *yuv;
-      yuv = yuv-width+1;
-
-      // Original equations
-      // R = Y           + 1.402 V
-      // G = Y - 0.344 U - 0.714 V
-      // B = Y + 1.772 U
-      R = Y0 + V2;
-      if ((R >> 8) > 0) R = 255; else if (R < 0) R = 0;
-
-      G = Y0 + UV;
-      if ((G >> 8) > 0) G = 255; else if (G < 0) G = 0;
-
-      B = Y0 + U5;
-      if ((B >> 8) > 0) B = 255; else if (B < 0) B = 0;
-
-      *rgba++ = (unsigned char)R;
-      *rgba++ = (unsigned char)G;
-      *rgba++ = (unsigned char)B;
-      *rgba++ = vpRGBa::alpha_default;
-
-      //---
-      R = Y1 + V2;
-      if ((R >> 8) > 0) R = 255; else if (R < 0) R = 0;
-
-      G = Y1 + UV;
-      if ((G >> 8) > 0) G = 255; else if (G < 0) G = 0;
-
-      B = Y1 + U5;
-      if ((B >> 8) > 0) B = 255; else if (B < 0) B = 0;
-
-      *rgba++ = (unsigned char)R;
-      *rgba++ = (unsigned char)G;
-      *rgba++ = (unsigned char)B;
-      *rgba = vpRGBa::alpha_default;
-      rgba = rgba + 4*width-7;
-
-      //---
-      R = Y2 + V2;
-      if ((R >> 8) > 0) R = 255; else if (R < 0) R = 0;
-
-      G = Y2 + UV;
-      if ((G >> 8) > 0) G = 255; else if (G < 0) G = 0;
-
-      B = Y2 + U5;
-      if ((B >> 8) > 0) B = 255; else if (B < 0) B = 0;
-
-      *rgba++ = (unsigned char)R;
-      *rgba++ = (unsigned char)G;
-      *rgba++ = (unsigned char)B;
-      *rgba++ = vpRGBa::alpha_default;
-
-      //---
-      R = Y3 + V2;
-      if ((R >> 8) > 0) R = 255; else if (R < 0) R = 0;
-
-      G = Y3 + UV;
-      if ((G >> 8) > 0) G = 255; else if (G < 0) G = 0;
-
-      B = Y3 + U5;
-      if ((B >> 8) > 0) B = 255; else if (B < 0) B = 0;
-
-      *rgba++ = (unsigned char)R;
-      *rgba++ = (unsigned char)G;
-      *rgba++ = (unsigned char)B;
-      *rgba = vpRGBa::alpha_default;
-      rgba = rgba -4*width+1;
-    }
-    yuv+=width;
-    rgba+=4*width;
-  }
+  vpConvertYUV420Task task(getYUV420ToRGBaFunction(), yuv, rgba, width, height);
+  vpThreadPool &pool = vpThreadPool::getInstance();
+  const unsigned int nbRowPairs = height / 2;
+  if (width*height < PARALLEL_MIN_PIXELS || pool.getNumThreads() < 2)
+    task(0, nbRowPairs);
+  else
+    pool.parallelFor(0, nbRowPairs, task, (nbRowPairs + pool.getNumThreads() - 1) / pool.getNumThreads());
 }
 /*!
 
@@ -1991,10 +2735,7 @@ void vpImageConvert::YUV420ToRGB(unsigned char* yuv,
 */
 void vpImageConvert::YUV420ToGrey(unsigned char* yuv, unsigned char* grey, unsigned int size)
 {
-  for(unsigned int i=0 ; i < size ; i++)
-  {
-    *grey++ = *yuv++;
-  }
+  memcpy(grey, yuv, size);
 }
 /*!
 
@@ -2897,133 +3638,13 @@ void vpImageConvert::RGBaToRGB(unsigned char* rgba, unsigned char* rgb, unsigned
   modern monitor. See Charles Pontyon's Colour FAQ
   http://www.poynton.com/notes/colour_and_gamma/ColorFAQ.html
 
+  The weights 0.2126, 0.7152 and 0.0722 are applied in 15 bits fixed point,
+  with the same result on every processor. Large images are converted by
+  the threads of vpThreadPool.
 */
 void vpImageConvert::RGBToGrey(unsigned char* rgb, unsigned char* grey, unsigned int size)
 {
-#if VISP_HAVE_SSSE3
-  unsigned int i = 0;
-
-  if(size >= 16) {
-    //Mask to select R component
-    const __m128i mask_R1 = _mm_set_epi8(
-          -1, -1, -1, -1, 15, -1, 12, -1, 9, -1, 6, -1, 3, -1, 0, -1
-          );
-    const __m128i mask_R2 = _mm_set_epi8(
-          5, -1, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
-          );
-    const __m128i mask_R3 = _mm_set_epi8(
-          -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 14, -1, 11, -1, 8, -1
-          );
-    const __m128i mask_R4 = _mm_set_epi8(
-          13, -1, 10, -1, 7, -1, 4, -1, 1, -1, -1, -1, -1, -1, -1, -1
-          );
-
-    //Mask to select G component
-    const __m128i mask_G1 = _mm_set_epi8(
-          -1, -1, -1, -1, -1, -1, 13, -1, 10, -1, 7, -1, 4, -1, 1, -1
-          );
-    const __m128i mask_G2 = _mm_set_epi8(
-          6, -1, 3, -1, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
-          );
-    const __m128i mask_G3 = _mm_set_epi8(
-          -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 15, -1, 12, -1, 9, -1
-          );
-    const __m128i mask_G4 = _mm_set_epi8(
-          14, -1, 11, -1, 8, -1, 5, -1, 2, -1, -1, -1, -1, -1, -1, -1
-          );
-
-    //Mask to select B component
-    const __m128i mask_B1 = _mm_set_epi8(
-          -1, -1, -1, -1, -1, -1, 14, -1, 11, -1, 8, -1, 5, -1, 2, -1
-          );
-    const __m128i mask_B2 = _mm_set_epi8(
-          7, -1, 4, -1, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
-          );
-    const __m128i mask_B3 = _mm_set_epi8(
-          -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 13, -1, 10, -1
-          );
-    const __m128i mask_B4 = _mm_set_epi8(
-          15, -1, 12, -1, 9, -1, 6, -1, 3, -1, 0, -1, -1, -1, -1, -1
-          );
-
-    //Mask to select the gray component
-    const __m128i mask_low1 = _mm_set_epi8(
-          -1, -1, -1, -1, -1, -1, -1, -1, 15, 13, 11, 9, 7, 5, 3, 1
-          );
-    const __m128i mask_low2 = _mm_set_epi8(
-          15, 13, 11, 9, 7, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1, -1
-          );
-
-    //Coefficients RGB to Gray
-    const __m128i coeff_R = _mm_set_epi16(
-          13933, 13933, 13933, 13933, 13933, 13933, 13933, 13933
-          );
-    const __m128i coeff_G = _mm_set_epi16(
-          (short int) 46871, (short int) 46871, (short int) 46871, (short int) 46871,
-          (short int) 46871, (short int) 46871, (short int) 46871, (short int) 46871
-          );
-    const __m128i coeff_B = _mm_set_epi16(
-          4732, 4732, 4732, 4732, 4732, 4732, 4732, 4732
-          );
-
-    for(; i <= size - 16; i+=16) {
-      //Process 16 color pixels
-      const __m128i data1 = _mm_loadu_si128((const __m128i*) rgb);
-      const __m128i data2 = _mm_loadu_si128((const __m128i*) (rgb + 16));
-      const __m128i data3 = _mm_loadu_si128((const __m128i*) (rgb + 32));
-
-      const __m128i red_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_R1), _mm_shuffle_epi8(data2, mask_R2) );
-      const __m128i green_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_G1), _mm_shuffle_epi8(data2, mask_G2) );
-      const __m128i blue_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_B1), _mm_shuffle_epi8(data2, mask_B2) );
-
-      const __m128i grays_0_7 =
-          _mm_adds_epu16(
-            _mm_mulhi_epu16(red_0_7, coeff_R),
-            _mm_adds_epu16(
-              _mm_mulhi_epu16(green_0_7, coeff_G),
-              _mm_mulhi_epu16(blue_0_7,  coeff_B)
-              ));
-
-      const __m128i red_8_15 = _mm_or_si128( _mm_shuffle_epi8(data2, mask_R3), _mm_shuffle_epi8(data3, mask_R4) );
-      const __m128i green_8_15 = _mm_or_si128( _mm_shuffle_epi8(data2, mask_G3), _mm_shuffle_epi8(data3, mask_G4) );
-      const __m128i blue_8_15 = _mm_or_si128( _mm_shuffle_epi8(data2, mask_B3), _mm_shuffle_epi8(data3, mask_B4) );
-
-      const __m128i grays_8_15 =
-          _mm_adds_epu16(
-            _mm_mulhi_epu16(red_8_15, coeff_R),
-            _mm_adds_epu16(
-              _mm_mulhi_epu16(green_8_15, coeff_G),
-              _mm_mulhi_epu16(blue_8_15,  coeff_B)
-              ));
-
-      _mm_storeu_si128( (__m128i*) grey, _mm_or_si128(_mm_shuffle_epi8(grays_0_7, mask_low1), _mm_shuffle_epi8(grays_8_15, mask_low2)) );
-
-      rgb += 48;
-      grey += 16;
-    }
-  }
-
-  for(; i < size; i++) {
-    *grey = (unsigned char) (0.2126 * (*rgb)
-                             + 0.7152 * (*(rgb + 1))
-                             + 0.0722 * (*(rgb + 2)) );
-
-    rgb += 3;
-    ++grey;
-  }
-#else
-  unsigned char *pt_input = rgb;
-  unsigned char* pt_end = rgb + size*3;
-  unsigned char *pt_output = grey;
-
-  while(pt_input != pt_end) {
-    *pt_output = (unsigned char) (0.2126 * (*pt_input)
-                                  + 0.7152 * (*(pt_input + 1))
-                                  + 0.0722 * (*(pt_input + 2)) );
-    pt_input += 3;
-    pt_output ++;
-  }
-#endif
+  convertPixels(getRGBToGreyFunction<false>(), rgb, 3, grey, 1, size);
 }
 /*!
 
@@ -3034,115 +3655,7 @@ void vpImageConvert::RGBToGrey(unsigned char* rgb, unsigned char* grey, unsigned
 */
 void vpImageConvert::RGBaToGrey(unsigned char* rgba, unsigned char* grey, unsigned int size)
 {
-#if VISP_HAVE_SSSE3
-  unsigned int i = 0;
-
-  if(size >= 16) {
-    //Mask to select R component
-    const __m128i mask_R1 = _mm_set_epi8(
-          -1, -1, -1, -1, -1, -1, -1, -1, 12, -1, 8, -1, 4, -1, 0, -1
-          );
-    const __m128i mask_R2 = _mm_set_epi8(
-          12, -1, 8, -1, 4, -1, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1
-          );
-
-    //Mask to select G component
-    const __m128i mask_G1 = _mm_set_epi8(
-          -1, -1, -1, -1, -1, -1, -1, -1, 13, -1, 9, -1, 5, -1, 1, -1
-          );
-    const __m128i mask_G2 = _mm_set_epi8(
-          13, -1, 9, -1, 5, -1, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1
-          );
-
-    //Mask to select B component
-    const __m128i mask_B1 = _mm_set_epi8(
-          -1, -1, -1, -1, -1, -1, -1, -1, 14, -1, 10, -1, 6, -1, 2, -1
-          );
-    const __m128i mask_B2 = _mm_set_epi8(
-          14, -1, 10, -1, 6, -1, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1
-          );
-
-    //Mask to select the gray component
-    const __m128i mask_low1 = _mm_set_epi8(
-          -1, -1, -1, -1, -1, -1, -1, -1, 15, 13, 11, 9, 7, 5, 3, 1
-          );
-    const __m128i mask_low2 = _mm_set_epi8(
-          15, 13, 11, 9, 7, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1, -1
-          );
-
-    //Coefficients RGB to Gray
-    const __m128i coeff_R = _mm_set_epi16(
-          13933, 13933, 13933, 13933, 13933, 13933, 13933, 13933
-          );
-    const __m128i coeff_G = _mm_set_epi16(
-          (short int) 46871, (short int) 46871, (short int) 46871, (short int) 46871,
-          (short int) 46871, (short int) 46871, (short int) 46871, (short int) 46871
-          );
-    const __m128i coeff_B = _mm_set_epi16(
-          4732, 4732, 4732, 4732, 4732, 4732, 4732, 4732
-          );
-
-    for(; i <= size - 16; i+=16) {
-      //Process 2*4 color pixels
-      const __m128i data1 = _mm_loadu_si128((const __m128i*) rgba);
-      const __m128i data2 = _mm_loadu_si128((const __m128i*) (rgba + 16));
-
-      const __m128i red_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_R1), _mm_shuffle_epi8(data2, mask_R2) );
-      const __m128i green_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_G1), _mm_shuffle_epi8(data2, mask_G2) );
-      const __m128i blue_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_B1), _mm_shuffle_epi8(data2, mask_B2) );
-
-      const __m128i grays_0_7 =
-          _mm_adds_epu16(
-            _mm_mulhi_epu16(red_0_7, coeff_R),
-            _mm_adds_epu16(
-              _mm_mulhi_epu16(green_0_7, coeff_G),
-              _mm_mulhi_epu16(blue_0_7,  coeff_B)
-              ));
-
-      //Process next 2*4 color pixels
-      const __m128i data3 = _mm_loadu_si128((const __m128i*) (rgba + 32));
-      const __m128i data4 = _mm_loadu_si128((const __m128i*) (rgba + 48));
-
-      const __m128i red_8_15 = _mm_or_si128( _mm_shuffle_epi8(data3, mask_R1), _mm_shuffle_epi8(data4, mask_R2) );
-      const __m128i green_8_15 = _mm_or_si128( _mm_shuffle_epi8(data3, mask_G1), _mm_shuffle_epi8(data4, mask_G2) );
-      const __m128i blue_8_15 = _mm_or_si128( _mm_shuffle_epi8(data3, mask_B1), _mm_shuffle_epi8(data4, mask_B2) );
-
-      const __m128i grays_8_15 =
-          _mm_adds_epu16(
-            _mm_mulhi_epu16(red_8_15, coeff_R),
-            _mm_adds_epu16(
-              _mm_mulhi_epu16(green_8_15, coeff_G),
-              _mm_mulhi_epu16(blue_8_15,  coeff_B)
-              ));
-
-      _mm_storeu_si128( (__m128i*) grey, _mm_or_si128(_mm_shuffle_epi8(grays_0_7, mask_low1), _mm_shuffle_epi8(grays_8_15, mask_low2)) );
-
-      rgba += 64;
-      grey += 16;
-    }
-  }
-
-  for(; i < size; i++) {
-    *grey = (unsigned char) (0.2126 * (*rgba)
-                             + 0.7152 * (*(rgba + 1))
-                             + 0.0722 * (*(rgba + 2)) );
-
-    rgba += 4;
-    ++grey;
-  }
-#else
-  unsigned char *pt_input = rgba;
-  unsigned char* pt_end = rgba + size*4;
-  unsigned char *pt_output = grey;
-
-  while(pt_input != pt_end) {
-    *pt_output = (unsigned char) (0.2126 * (*pt_input)
-                                  + 0.7152 * (*(pt_input + 1))
-                                  + 0.0722 * (*(pt_input + 2)) );
-    pt_input += 4;
-    pt_output ++;
-  }
-#endif
+  convertPixels(getRGBaToGreyFunction<false>(), rgba, 4, grey, 1, size);
 }
 
 /*!
@@ -3235,232 +3748,7 @@ void
 vpImageConvert::BGRToGrey(unsigned char * bgr, unsigned char * grey,
                           unsigned int width, unsigned int height, bool flip)
 {
-#if VISP_HAVE_SSSE3
-  //Mask to select B component
-  const __m128i mask_B1 = _mm_set_epi8(
-        -1, -1, -1, -1, 15, -1, 12, -1, 9, -1, 6, -1, 3, -1, 0, -1
-        );
-  const __m128i mask_B2 = _mm_set_epi8(
-        5, -1, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
-        );
-  const __m128i mask_B3 = _mm_set_epi8(
-        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 14, -1, 11, -1, 8, -1
-        );
-  const __m128i mask_B4 = _mm_set_epi8(
-        13, -1, 10, -1, 7, -1, 4, -1, 1, -1, -1, -1, -1, -1, -1, -1
-        );
-
-  //Mask to select G component
-  const __m128i mask_G1 = _mm_set_epi8(
-        -1, -1, -1, -1, -1, -1, 13, -1, 10, -1, 7, -1, 4, -1, 1, -1
-        );
-  const __m128i mask_G2 = _mm_set_epi8(
-        6, -1, 3, -1, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
-        );
-  const __m128i mask_G3 = _mm_set_epi8(
-        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 15, -1, 12, -1, 9, -1
-        );
-  const __m128i mask_G4 = _mm_set_epi8(
-        14, -1, 11, -1, 8, -1, 5, -1, 2, -1, -1, -1, -1, -1, -1, -1
-        );
-
-  //Mask to select R component
-  const __m128i mask_R1 = _mm_set_epi8(
-        -1, -1, -1, -1, -1, -1, 14, -1, 11, -1, 8, -1, 5, -1, 2, -1
-        );
-  const __m128i mask_R2 = _mm_set_epi8(
-        7, -1, 4, -1, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
-        );
-  const __m128i mask_R3 = _mm_set_epi8(
-        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 13, -1, 10, -1
-        );
-  const __m128i mask_R4 = _mm_set_epi8(
-        15, -1, 12, -1, 9, -1, 6, -1, 3, -1, 0, -1, -1, -1, -1, -1
-        );
-
-  //Mask to select the gray component
-  const __m128i mask_low1 = _mm_set_epi8(
-        -1, -1, -1, -1, -1, -1, -1, -1, 15, 13, 11, 9, 7, 5, 3, 1
-        );
-  const __m128i mask_low2 = _mm_set_epi8(
-        15, 13, 11, 9, 7, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1, -1
-        );
-
-  //Coefficients RGB to Gray
-  //  const __m128i coeff_R = _mm_set_epi8(
-  //        54, -1, 54, -1, 54, -1, 54, -1, 54, -1, 54, -1, 54, -1, 54, -1
-  //        );
-  //  const __m128i coeff_G = _mm_set_epi8(
-  //        183, -1, 183, -1, 183, -1, 183, -1, 183, -1, 183, -1, 183, -1, 183, -1
-  //        );
-  //  const __m128i coeff_B = _mm_set_epi8(
-  //        18, -1, 18, -1, 18, -1, 18, -1, 18, -1, 18, -1, 18, -1, 18, -1
-  //        );
-  //  const __m128i coeff_R = _mm_set_epi16(
-  //        6969*2, 6969*2, 6969*2, 6969*2, 6969*2, 6969*2, 6969*2, 6969*2
-  //        );
-  //  const __m128i coeff_G = _mm_set_epi16(
-  //        23434*2, 23434*2, 23434*2, 23434*2, 23434*2, 23434*2, 23434*2, 23434*2
-  //        );
-  //  const __m128i coeff_B = _mm_set_epi16(
-  //        2365*2, 2365*2, 2365*2, 2365*2, 2365*2, 2365*2, 2365*2, 2365*2
-  //        );
-  const __m128i coeff_R = _mm_set_epi16(
-        13933, 13933, 13933, 13933, 13933, 13933, 13933, 13933
-        );
-  const __m128i coeff_G = _mm_set_epi16(
-        (short int) 46871, (short int) 46871, (short int) 46871, (short int) 46871,
-        (short int) 46871, (short int) 46871, (short int) 46871, (short int) 46871
-        );
-  const __m128i coeff_B = _mm_set_epi16(
-        4732, 4732, 4732, 4732, 4732, 4732, 4732, 4732
-        );
-
-  if(flip) {
-    int i = ((int) height) - 1;
-    int lineStep = -(int) (width*3);
-    bgr = bgr + (width * (height-1) * 3);
-
-    unsigned char *linePtr = bgr;
-    unsigned char r,g,b;
-
-    if(width >= 16) {
-      for(; i >= 0; i--) {
-        unsigned int j = 0;
-
-        for(; j <= width - 16; j+=16) {
-          //Process 16 color pixels
-          const __m128i data1 = _mm_loadu_si128((const __m128i*) bgr);
-          const __m128i data2 = _mm_loadu_si128((const __m128i*) (bgr + 16));
-          const __m128i data3 = _mm_loadu_si128((const __m128i*) (bgr + 32));
-
-          const __m128i red_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_R1), _mm_shuffle_epi8(data2, mask_R2) );
-          const __m128i green_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_G1), _mm_shuffle_epi8(data2, mask_G2) );
-          const __m128i blue_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_B1), _mm_shuffle_epi8(data2, mask_B2) );
-
-          const __m128i grays_0_7 =
-              _mm_adds_epu16(
-                _mm_mulhi_epu16(red_0_7, coeff_R),
-                _mm_adds_epu16(
-                  _mm_mulhi_epu16(green_0_7, coeff_G),
-                  _mm_mulhi_epu16(blue_0_7,  coeff_B)
-                  ));
-
-          const __m128i red_8_15 = _mm_or_si128( _mm_shuffle_epi8(data2, mask_R3), _mm_shuffle_epi8(data3, mask_R4) );
-          const __m128i green_8_15 = _mm_or_si128( _mm_shuffle_epi8(data2, mask_G3), _mm_shuffle_epi8(data3, mask_G4) );
-          const __m128i blue_8_15 = _mm_or_si128( _mm_shuffle_epi8(data2, mask_B3), _mm_shuffle_epi8(data3, mask_B4) );
-
-          const __m128i grays_8_15 =
-              _mm_adds_epu16(
-                _mm_mulhi_epu16(red_8_15, coeff_R),
-                _mm_adds_epu16(
-                  _mm_mulhi_epu16(green_8_15, coeff_G),
-                  _mm_mulhi_epu16(blue_8_15,  coeff_B)
-                  ));
-
-          _mm_storeu_si128( (__m128i*) grey, _mm_or_si128(_mm_shuffle_epi8(grays_0_7, mask_low1), _mm_shuffle_epi8(grays_8_15, mask_low2)) );
-
-          bgr += 48;
-          grey += 16;
-        }
-
-        for(; j < width; j++) {
-          b = *(bgr++);
-          g = *(bgr++);
-          r = *(bgr++);
-          *grey++ = (unsigned char) ( 0.2126 * r + 0.7152 * g + 0.0722 * b);
-        }
-
-        linePtr += lineStep;
-        bgr = linePtr;
-      }
-    }
-
-    for(; i >= 0; i--) {
-      for(unsigned int j = 0; j < width; j++) {
-        b = *(bgr++);
-        g = *(bgr++);
-        r = *(bgr++);
-        *grey++ = (unsigned char) ( 0.2126 * r + 0.7152 * g + 0.0722 * b);
-      }
-
-      linePtr += lineStep;
-      bgr = linePtr;
-    }
-  } else {
-    unsigned int i = 0;
-    unsigned int size = width * height;
-
-    if(size >= 16) {
-      for(; i <= size - 16; i+=16) {
-        //Process 16 color pixels
-        const __m128i data1 = _mm_loadu_si128((const __m128i*) bgr);
-        const __m128i data2 = _mm_loadu_si128((const __m128i*) (bgr + 16));
-        const __m128i data3 = _mm_loadu_si128((const __m128i*) (bgr + 32));
-
-        const __m128i red_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_R1), _mm_shuffle_epi8(data2, mask_R2) );
-        const __m128i green_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_G1), _mm_shuffle_epi8(data2, mask_G2) );
-        const __m128i blue_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_B1), _mm_shuffle_epi8(data2, mask_B2) );
-
-        const __m128i grays_0_7 =
-            _mm_adds_epu16(
-              _mm_mulhi_epu16(red_0_7, coeff_R),
-              _mm_adds_epu16(
-                _mm_mulhi_epu16(green_0_7, coeff_G),
-                _mm_mulhi_epu16(blue_0_7,  coeff_B)
-                ));
-
-        const __m128i red_8_15 = _mm_or_si128( _mm_shuffle_epi8(data2, mask_R3), _mm_shuffle_epi8(data3, mask_R4) );
-        const __m128i green_8_15 = _mm_or_si128( _mm_shuffle_epi8(data2, mask_G3), _mm_shuffle_epi8(data3, mask_G4) );
-        const __m128i blue_8_15 = _mm_or_si128( _mm_shuffle_epi8(data2, mask_B3), _mm_shuffle_epi8(data3, mask_B4) );
-
-        const __m128i grays_8_15 =
-            _mm_adds_epu16(
-              _mm_mulhi_epu16(red_8_15, coeff_R),
-              _mm_adds_epu16(
-                _mm_mulhi_epu16(green_8_15, coeff_G),
-                _mm_mulhi_epu16(blue_8_15,  coeff_B)
-                ));
-
-        _mm_storeu_si128( (__m128i*) grey, _mm_or_si128(_mm_shuffle_epi8(grays_0_7, mask_low1), _mm_shuffle_epi8(grays_8_15, mask_low2)) );
-
-        bgr += 48;
-        grey += 16;
-      }
-    }
-
-    for(; i < size; i++) {
-      *grey = (unsigned char) (0.2126 * (*(bgr + 2))
-                               + 0.7152 * (*(bgr + 1))
-                               + 0.0722 * (*bgr) );
-
-      bgr += 3;
-      ++grey;
-    }
-  }
-#else
-  //if we have to flip the image, we start from the end last scanline so the
-  //step is negative
-  int lineStep = (flip) ? -(int)(width*3) : (int)(width*3);
-
-  //starting source address = last line if we need to flip the image
-  unsigned char * src = (flip) ? bgr+(width*height*3)+lineStep : bgr;
-
-  for(unsigned int i=0 ; i < height ; i++)
-  {
-    unsigned char *line = src;
-    for(unsigned int j=0 ; j < width ; j++)
-    {
-      *grey++ = (unsigned char)( 0.2126 * *(line+2)
-                                 + 0.7152 * *(line+1)
-                                 + 0.0722 * *(line+0)) ;
-      line+=3;
-    }
-
-    //go to the next line
-    src+=lineStep;
-  }
-#endif
+  convertImage(getRGBToGreyFunction<true>(), bgr, 3, grey, 1, width, height, flip);
 }
 
 /*!
@@ -3507,171 +3795,7 @@ void
 vpImageConvert::RGBToGrey(unsigned char * rgb, unsigned char * grey,
                           unsigned int width, unsigned int height, bool flip)
 {
-  if(flip) {
-#if VISP_HAVE_SSSE3
-    int i = ((int) height) - 1;
-    int lineStep = -(int) (width*3);
-    rgb = rgb + (width * (height-1) * 3);
-
-    unsigned char *linePtr = rgb;
-    unsigned char r,g,b;
-
-    if(width >= 16) {
-      //Mask to select R component
-      const __m128i mask_R1 = _mm_set_epi8(
-            -1, -1, -1, -1, 15, -1, 12, -1, 9, -1, 6, -1, 3, -1, 0, -1
-            );
-      const __m128i mask_R2 = _mm_set_epi8(
-            5, -1, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
-            );
-      const __m128i mask_R3 = _mm_set_epi8(
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 14, -1, 11, -1, 8, -1
-            );
-      const __m128i mask_R4 = _mm_set_epi8(
-            13, -1, 10, -1, 7, -1, 4, -1, 1, -1, -1, -1, -1, -1, -1, -1
-            );
-
-      //Mask to select G component
-      const __m128i mask_G1 = _mm_set_epi8(
-            -1, -1, -1, -1, -1, -1, 13, -1, 10, -1, 7, -1, 4, -1, 1, -1
-            );
-      const __m128i mask_G2 = _mm_set_epi8(
-            6, -1, 3, -1, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
-            );
-      const __m128i mask_G3 = _mm_set_epi8(
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 15, -1, 12, -1, 9, -1
-            );
-      const __m128i mask_G4 = _mm_set_epi8(
-            14, -1, 11, -1, 8, -1, 5, -1, 2, -1, -1, -1, -1, -1, -1, -1
-            );
-
-      //Mask to select B component
-      const __m128i mask_B1 = _mm_set_epi8(
-            -1, -1, -1, -1, -1, -1, 14, -1, 11, -1, 8, -1, 5, -1, 2, -1
-            );
-      const __m128i mask_B2 = _mm_set_epi8(
-            7, -1, 4, -1, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
-            );
-      const __m128i mask_B3 = _mm_set_epi8(
-            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 13, -1, 10, -1
-            );
-      const __m128i mask_B4 = _mm_set_epi8(
-            15, -1, 12, -1, 9, -1, 6, -1, 3, -1, 0, -1, -1, -1, -1, -1
-            );
-
-      //Mask to select the gray component
-      const __m128i mask_low1 = _mm_set_epi8(
-            -1, -1, -1, -1, -1, -1, -1, -1, 15, 13, 11, 9, 7, 5, 3, 1
-            );
-      const __m128i mask_low2 = _mm_set_epi8(
-            15, 13, 11, 9, 7, 5, 3, 1, -1, -1, -1, -1, -1, -1, -1, -1
-            );
-
-      //Coefficients RGB to Gray
-      const __m128i coeff_R = _mm_set_epi16(
-            13933, 13933, 13933, 13933, 13933, 13933, 13933, 13933
-            );
-      const __m128i coeff_G = _mm_set_epi16(
-            (short int) 46871, (short int) 46871, (short int) 46871, (short int) 46871,
-            (short int) 46871, (short int) 46871, (short int) 46871, (short int) 46871
-            );
-      const __m128i coeff_B = _mm_set_epi16(
-            4732, 4732, 4732, 4732, 4732, 4732, 4732, 4732
-            );
-
-      for(; i >= 0; i--) {
-        unsigned int j = 0;
-
-        for(; j <= width - 16; j+=16) {
-          //Process 16 color pixels
-          const __m128i data1 = _mm_loadu_si128((const __m128i*) rgb);
-          const __m128i data2 = _mm_loadu_si128((const __m128i*) (rgb + 16));
-          const __m128i data3 = _mm_loadu_si128((const __m128i*) (rgb + 32));
-
-          const __m128i red_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_R1), _mm_shuffle_epi8(data2, mask_R2) );
-          const __m128i green_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_G1), _mm_shuffle_epi8(data2, mask_G2) );
-          const __m128i blue_0_7 = _mm_or_si128( _mm_shuffle_epi8(data1, mask_B1), _mm_shuffle_epi8(data2, mask_B2) );
-
-          const __m128i grays_0_7 =
-              _mm_adds_epu16(
-                _mm_mulhi_epu16(red_0_7, coeff_R),
-                _mm_adds_epu16(
-                  _mm_mulhi_epu16(green_0_7, coeff_G),
-                  _mm_mulhi_epu16(blue_0_7,  coeff_B)
-                  ));
-
-          const __m128i red_8_15 = _mm_or_si128( _mm_shuffle_epi8(data2, mask_R3), _mm_shuffle_epi8(data3, mask_R4) );
-          const __m128i green_8_15 = _mm_or_si128( _mm_shuffle_epi8(data2, mask_G3), _mm_shuffle_epi8(data3, mask_G4) );
-          const __m128i blue_8_15 = _mm_or_si128( _mm_shuffle_epi8(data2, mask_B3), _mm_shuffle_epi8(data3, mask_B4) );
-
-          const __m128i grays_8_15 =
-              _mm_adds_epu16(
-                _mm_mulhi_epu16(red_8_15, coeff_R),
-                _mm_adds_epu16(
-                  _mm_mulhi_epu16(green_8_15, coeff_G),
-                  _mm_mulhi_epu16(blue_8_15,  coeff_B)
-                  ));
-
-          _mm_storeu_si128( (__m128i*) grey, _mm_or_si128(_mm_shuffle_epi8(grays_0_7, mask_low1), _mm_shuffle_epi8(grays_8_15, mask_low2)) );
-
-          rgb += 48;
-          grey += 16;
-        }
-
-        for(; j < width; j++) {
-          r = *(rgb++);
-          g = *(rgb++);
-          b = *(rgb++);
-          *grey++ = (unsigned char) ( 0.2126 * r + 0.7152 * g + 0.0722 * b);
-        }
-
-        linePtr += lineStep;
-        rgb = linePtr;
-      }
-    }
-
-    for(; i >= 0; i--) {
-      for(unsigned int j = 0; j < width; j++) {
-        r = *(rgb++);
-        g = *(rgb++);
-        b = *(rgb++);
-        *grey++ = (unsigned char) ( 0.2126 * r + 0.7152 * g + 0.0722 * b);
-      }
-
-      linePtr += lineStep;
-      rgb = linePtr;
-    }
-#else
-    //if we have to flip the image, we start from the end last scanline so the
-    //step is negative
-    int lineStep = (flip) ? -(int)(width*3) : (int)(width*3);
-
-    //starting source address = last line if we need to flip the image
-    unsigned char * src = (flip) ? rgb+(width*height*3)+lineStep : rgb;
-
-    unsigned int j=0;
-    unsigned int i=0;
-
-    unsigned r,g,b;
-
-    for(i=0 ; i < height ; i++)
-    {
-      unsigned char * line = src;
-      for( j=0 ; j < width ; j++)
-      {
-        r = *(line++);
-        g = *(line++);
-        b = *(line++);
-        *grey++ = (unsigned char)( 0.2126 * r + 0.7152 * g + 0.0722 * b) ;
-      }
-
-      //go to the next line
-      src+=lineStep;
-    }
-#endif
-  } else {
-    RGBToGrey(rgb, grey, width*height);
-  }
+  convertImage(getRGBToGreyFunction<false>(), rgb, 3, grey, 1, width, height, flip);
 }
 
 /*!
@@ -35,8 +35,13 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include <visp3/core/vpImageFilter.h>
 #include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpThreadPool.h>
 #if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020408)
 #  include <opencv2/imgproc/imgproc.hpp>
 #elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020101)
@@ -45,6 +50,720 @@
 #  include <cv.h>
 #endif
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+// AVX2 kernels compiled with a target attribute and selected at run time
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    ((defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 5)) || (defined(__clang__) && (__clang_major__ >= 4)))
+#  include <immintrin.h>
+#  define VISP_HAVE_AVX2_DISPATCH 1
+#  define VP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+  /*
+    Separable filters computed row by row.
+
+    Every pass comes down to acc[c] += f * (a[c] +/- b[c]) over contiguous rows: for the
+    X pass a and b are shifted views of a row padded with its mirrored borders, for the
+    Y pass they are two rows of a cache that holds the last rows read or filtered along X.
+    The multiplications and additions are done in the same order as the per pixel
+    helpers vpImageFilter::filterX() and filterY(), without fused multiply-add, so the
+    double results are identical to theirs.
+  */
+
+  // Below this number of pixels the filters are not split between threads
+  const unsigned int FILTER_PARALLEL_MIN_PIXELS = 1 << 18;
+
+  // Fixed-point Gaussian blur: kernel in Q12, rows filtered along X in Q7
+  const int FIXED_KERNEL_SHIFT = 12;
+  const int FIXED_ROW_SHIFT = 7;
+
+  enum vpFilterKind {
+    FILTER_NONE,       //!< No filtering along this direction
+    FILTER_SMOOTH,     //!< Symmetric kernel, mirrored borders
+    FILTER_DERIVATIVE  //!< Antisymmetric kernel, borders set to 0
+  };
+
+  enum vpFilterSimd { FILTER_SCALAR, FILTER_SSE2, FILTER_AVX2 };
+
+  vpFilterSimd getFilterSimd()
+  {
+    // The detection always gives the same result, a concurrent first call is harmless
+    static int simd = -1;
+    if (simd < 0) {
+      simd = FILTER_SCALAR;
+#if VISP_HAVE_SSE2
+      simd = FILTER_SSE2;
+#endif
+#if VISP_HAVE_AVX2_DISPATCH
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2"))
+        simd = FILTER_AVX2;
+#endif
+    }
+    return (vpFilterSimd)simd;
+  }
+
+  /*
+    Index of the pixel read beyond the borders, the same as in the border helpers of
+    vpImageFilter: -k is replaced by k and n-1+k by n-k.
+  */
+  inline int mirrorIndex(int i, const int n)
+  {
+    while (i < 0 || i >= n) {
+      if (i < 0)
+        i = -i;
+      if (i >= n)
+        i = 2*n - 1 - i;
+    }
+    return i;
+  }
+
+  //--------------------------------------------------------------------------
+  // acc[i] += f * (a[i] + b[i]) or acc[i] += f * (a[i] - b[i])
+  //--------------------------------------------------------------------------
+  template <typename T>
+  void accumulateScalar(T *acc, const T *a, const T *b, const T f, const unsigned int n, const bool diff)
+  {
+    if (diff) {
+      for (unsigned int i = 0; i < n; i++)
+        acc[i] += f * (a[i] - b[i]);
+    }
+    else {
+      for (unsigned int i = 0; i < n; i++)
+        acc[i] += f * (a[i] + b[i]);
+    }
+  }
+
+  // Fixed-point version, the sums are computed on 32 bits
+  void accumulateFixedScalar(int *acc, const short *a, const short *b, const short f, const unsigned int n)
+  {
+    for (unsigned int i = 0; i < n; i++)
+      acc[i] += f * ((int)a[i] + (int)b[i]);
+  }
+
+#if VISP_HAVE_SSE2
+  void accumulateSSE2(float *acc, const float *a, const float *b, const float f, const unsigned int n, const bool diff)
+  {
+    const __m128 vf = _mm_set1_ps(f);
+    unsigned int i = 0;
+    if (diff) {
+      for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(vf, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)))));
+    }
+    else {
+      for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(vf, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)))));
+    }
+    accumulateScalar(acc + i, a + i, b + i, f, n - i, diff);
+  }
+
+  void accumulateSSE2(double *acc, const double *a, const double *b, const double f, const unsigned int n, const bool diff)
+  {
+    const __m128d vf = _mm_set1_pd(f);
+    unsigned int i = 0;
+    if (diff) {
+      for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(acc + i, _mm_add_pd(_mm_loadu_pd(acc + i), _mm_mul_pd(vf, _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)))));
+    }
+    else {
+      for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(acc + i, _mm_add_pd(_mm_loadu_pd(acc + i), _mm_mul_pd(vf, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)))));
+    }
+    accumulateScalar(acc + i, a + i, b + i, f, n - i, diff);
+  }
+
+  void accumulateFixedSSE2(int *acc, const short *a, const short *b, const short f, const unsigned int n)
+  {
+    // madd on the interleaved (a, b) pairs gives f*a + f*b on 32 bits
+    const __m128i vf = _mm_set1_epi16(f);
+    unsigned int i = 0;
+    for (; i + 8 <= n; i += 8) {
+      const __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+      const __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+      const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(va, vb), vf);
+      const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(va, vb), vf);
+      _mm_storeu_si128((__m128i *)(acc + i), _mm_add_epi32(_mm_loadu_si128((const __m128i *)(acc + i)), lo));
+      _mm_storeu_si128((__m128i *)(acc + i + 4), _mm_add_epi32(_mm_loadu_si128((const __m128i *)(acc + i + 4)), hi));
+    }
+    accumulateFixedScalar(acc + i, a + i, b + i, f, n - i);
+  }
+#endif
+
+#if VISP_HAVE_AVX2_DISPATCH
+  VP_TARGET_AVX2
+  void accumulateAVX2(float *acc, const float *a, const float *b, const float f, const unsigned int n, const bool diff)
+  {
+    const __m256 vf = _mm256_set1_ps(f);
+    unsigned int i = 0;
+    if (diff) {
+      for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(vf, _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)))));
+    }
+    else {
+      for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(vf, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)))));
+    }
+    accumulateScalar(acc + i, a + i, b + i, f, n - i, diff);
+  }
+
+  VP_TARGET_AVX2
+  void accumulateAVX2(double *acc, const double *a, const double *b, const double f, const unsigned int n, const bool diff)
+  {
+    const __m256d vf = _mm256_set1_pd(f);
+    unsigned int i = 0;
+    if (diff) {
+      for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(acc + i, _mm256_add_pd(_mm256_loadu_pd(acc + i), _mm256_mul_pd(vf, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)))));
+    }
+    else {
+      for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(acc + i, _mm256_add_pd(_mm256_loadu_pd(acc + i), _mm256_mul_pd(vf, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)))));
+    }
+    accumulateScalar(acc + i, a + i, b + i, f, n - i, diff);
+  }
+
+  VP_TARGET_AVX2
+  void accumulateFixedAVX2(int *acc, const short *a, const short *b, const short f, const unsigned int n)
+  {
+    const __m256i vf = _mm256_set1_epi16(f);
+    unsigned int i = 0;
+    for (; i + 16 <= n; i += 16) {
+      const __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+      const __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+      // The unpacks work inside the 128 bits lanes: lo holds the elements 0-3 and 8-11, hi 4-7 and 12-15
+      const __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(va, vb), vf);
+      const __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(va, vb), vf);
+      _mm256_storeu_si256((__m256i *)(acc + i),
+                          _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(acc + i)), _mm256_permute2x128_si256(lo, hi, 0x20)));
+      _mm256_storeu_si256((__m256i *)(acc + i + 8),
+                          _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(acc + i + 8)), _mm256_permute2x128_si256(lo, hi, 0x31)));
+    }
+    accumulateFixedScalar(acc + i, a + i, b + i, f, n - i);
+  }
+#endif
+
+  template <typename T>
+  void accumulate(T *acc, const T *a, const T *b, const T f, const unsigned int n, const bool diff)
+  {
+    switch (getFilterSimd()) {
+#if VISP_HAVE_AVX2_DISPATCH
+    case FILTER_AVX2:
+      accumulateAVX2(acc, a, b, f, n, diff);
+      break;
+#endif
+#if VISP_HAVE_SSE2
+    case FILTER_SSE2:
+      accumulateSSE2(acc, a, b, f, n, diff);
+      break;
+#endif
+    default:
+      accumulateScalar(acc, a, b, f, n, diff);
+    }
+  }
+
+  void accumulateFixed(int *acc, const short *a, const short *b, const short f, const unsigned int n)
+  {
+    switch (getFilterSimd()) {
+#if VISP_HAVE_AVX2_DISPATCH
+    case FILTER_AVX2:
+      accumulateFixedAVX2(acc, a, b, f, n);
+      break;
+#endif
+#if VISP_HAVE_SSE2
+    case FILTER_SSE2:
+      accumulateFixedSSE2(acc, a, b, f, n);
+      break;
+#endif
+    default:
+      accumulateFixedScalar(acc, a, b, f, n);
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  // Floating point filters
+  //--------------------------------------------------------------------------
+  /*
+    Filter the rows [begin, end) of an image. Depending on xFirst, the rows are
+    filtered along X when they enter the cache (X then Y) or after the Y pass.
+  */
+  template <typename Tin, typename T>
+  class vpSeparableFilterTask : public vpThreadPool::Task
+  {
+  public:
+    vpSeparableFilterTask(const vpImage<Tin> &I, vpImage<T> &If, const T *kernelX, const vpFilterKind kindX,
+                          const T *kernelY, const vpFilterKind kindY, const unsigned int size, const bool xFirst)
+      : m_I(I), m_If(If), m_kernelX(kernelX), m_kindX(kindX), m_kernelY(kernelY), m_kindY(kindY),
+        m_half((int)(size - 1) / 2), m_xFirst(xFirst)
+    {
+    }
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      const int width = (int)m_I.getWidth();
+      const int height = (int)m_I.getHeight();
+      const int halfY = (m_kindY == FILTER_NONE) ? 0 : m_half;
+      const int nbCachedRows = 2*halfY + 1;
+      std::vector<T> cache((size_t)nbCachedRows * width), tmp(width), pad(width + 2*m_half), acc(width);
+
+      int nextRow = (std::max)(0, (int)begin - halfY);
+      for (int i = (int)begin; i < (int)end; i++) {
+        // Bring the source rows up to i+halfY in the cache
+        const int lastRow = (std::min)(height - 1, i + halfY);
+        for (; nextRow <= lastRow; nextRow++) {
+          T *row = &cache[(size_t)(nextRow % nbCachedRows) * width];
+          if (m_xFirst && m_kindX != FILTER_NONE)
+            filterRowX(m_I[(unsigned int)nextRow], row, width, pad, acc);
+          else {
+            for (int j = 0; j < width; j++)
+              row[j] = (T)m_I[(unsigned int)nextRow][j];
+          }
+        }
+
+        T *out = m_If[(unsigned int)i];
+        const bool xAfter = ! m_xFirst && m_kindX != FILTER_NONE;
+        T *yOut = xAfter ? &tmp[0] : out;
+        if (m_kindY == FILTER_NONE)
+          std::copy(cache.begin() + (size_t)(i % nbCachedRows) * width, cache.begin() + (size_t)(i % nbCachedRows + 1) * width, yOut);
+        else
+          filterRowY(cache, i, width, height, yOut, acc);
+        if (xAfter)
+          filterRowX(yOut, out, width, pad, acc);
+      }
+    }
+
+  private:
+    template <typename Tsrc>
+    void filterRowX(const Tsrc *src, T *dst, const int width, std::vector<T> &pad, std::vector<T> &acc) const
+    {
+      const int h = m_half;
+      for (int j = -h; j < width + h; j++)
+        pad[j + h] = (T)src[mirrorIndex(j, width)];
+
+      const T *center = &pad[h];
+      std::fill(acc.begin(), acc.end(), T(0));
+      for (int k = 1; k <= h; k++)
+        accumulate(&acc[0], center + k, center - k, m_kernelX[k], (unsigned int)width, m_kindX == FILTER_DERIVATIVE);
+
+      if (m_kindX == FILTER_SMOOTH) {
+        for (int j = 0; j < width; j++)
+          dst[j] = acc[j] + m_kernelX[0] * center[j];
+      }
+      else {
+        for (int j = 0; j < width; j++)
+          dst[j] = (j < h || j >= width - h) ? T(0) : acc[j];
+      }
+    }
+
+    void filterRowY(const std::vector<T> &cache, const int i, const int width, const int height, T *dst,
+                    std::vector<T> &acc) const
+    {
+      const int h = m_half;
+      const int nbCachedRows = 2*h + 1;
+      if (m_kindY == FILTER_DERIVATIVE && (i < h || i >= height - h)) {
+        std::fill(dst, dst + width, T(0));
+        return;
+      }
+
+      std::fill(acc.begin(), acc.end(), T(0));
+      for (int k = 1; k <= h; k++) {
+        const T *below = &cache[(size_t)(mirrorIndex(i + k, height) % nbCachedRows) * width];
+        const T *above = &cache[(size_t)(mirrorIndex(i - k, height) % nbCachedRows) * width];
+        accumulate(&acc[0], below, above, m_kernelY[k], (unsigned int)width, m_kindY == FILTER_DERIVATIVE);
+      }
+
+      if (m_kindY == FILTER_SMOOTH) {
+        const T *center = &cache[(size_t)(i % nbCachedRows) * width];
+        for (int j = 0; j < width; j++)
+          dst[j] = acc[j] + m_kernelY[0] * center[j];
+      }
+      else
+        std::copy(acc.begin(), acc.end(), dst);
+    }
+
+    const vpImage<Tin> &m_I;
+    vpImage<T> &m_If;
+    const T *m_kernelX;
+    vpFilterKind m_kindX;
+    const T *m_kernelY;
+    vpFilterKind m_kindY;
+    int m_half;
+    bool m_xFirst;
+  };
+
+  //! Split the rows in bands over the thread pool when the image is large enough.
+  void runRows(vpThreadPool::Task &task, const unsigned int width, const unsigned int height)
+  {
+    vpThreadPool &pool = vpThreadPool::getInstance();
+    const unsigned int nbThreads = pool.getNumThreads();
+    if (width*height < FILTER_PARALLEL_MIN_PIXELS || nbThreads < 2 || height < 2*nbThreads)
+      task(0, height);
+    else
+      pool.parallelFor(0, height, task, (height + nbThreads - 1) / nbThreads);
+  }
+
+  /*
+    Filter I along X and Y with kernels of the same size, given like in
+    vpImageFilter::getGaussianKernel() by their (size+1)/2 right coefficients.
+  */
+  template <typename Tin, typename T>
+  void separableFilter(const vpImage<Tin> &I, vpImage<T> &If, const T *kernelX, const vpFilterKind kindX,
+                       const T *kernelY, const vpFilterKind kindY, const unsigned int size, const bool xFirst)
+  {
+    if (size % 2 != 1)
+      throw (vpImageException(vpImageException::incorrectInitializationError, "Bad filter size %d", size));
+
+    If.resize(I.getHeight(), I.getWidth());
+    if (I.getSize() == 0)
+      return;
+
+    vpSeparableFilterTask<Tin, T> task(I, If, kernelX, kindX, kernelY, kindY, size, xFirst);
+    runRows(task, I.getWidth(), I.getHeight());
+  }
+
+  //--------------------------------------------------------------------------
+  // Fixed-point Gaussian blur of 8 bits images
+  //--------------------------------------------------------------------------
+  class vpFixedGaussianTask : public vpThreadPool::Task
+  {
+  public:
+    vpFixedGaussianTask(const vpImage<unsigned char> &I, vpImage<unsigned char> &GI, const std::vector<short> &kernel)
+      : m_I(I), m_GI(GI), m_kernel(kernel), m_half((int)kernel.size() - 1)
+    {
+    }
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      const int width = (int)m_I.getWidth();
+      const int height = (int)m_I.getHeight();
+      const int h = m_half;
+      const int nbCachedRows = 2*h + 1;
+      std::vector<short> cache((size_t)nbCachedRows * width), pad(width + 2*h);
+      std::vector<int> acc(width);
+
+      int nextRow = (std::max)(0, (int)begin - h);
+      for (int i = (int)begin; i < (int)end; i++) {
+        // Rows filtered along X, in Q7
+        const int lastRow = (std::min)(height - 1, i + h);
+        for (; nextRow <= lastRow; nextRow++) {
+          const unsigned char *src = m_I[(unsigned int)nextRow];
+          for (int j = -h; j < width + h; j++)
+            pad[j + h] = src[mirrorIndex(j, width)];
+          const short *center = &pad[h];
+          std::fill(acc.begin(), acc.end(), 0);
+          for (int k = 1; k <= h; k++)
+            accumulateFixed(&acc[0], center + k, center - k, m_kernel[k], (unsigned int)width);
+
+          short *row = &cache[(size_t)(nextRow % nbCachedRows) * width];
+          const int round = 1 << (FIXED_KERNEL_SHIFT - FIXED_ROW_SHIFT - 1);
+          for (int j = 0; j < width; j++) {
+            const int v = (acc[j] + m_kernel[0] * center[j] + round) >> (FIXED_KERNEL_SHIFT - FIXED_ROW_SHIFT);
+            row[j] = (short)(std::min)(v, 32767);
+          }
+        }
+
+        // Y pass, back to 8 bits
+        std::fill(acc.begin(), acc.end(), 0);
+        for (int k = 1; k <= h; k++) {
+          const short *below = &cache[(size_t)(mirrorIndex(i + k, height) % nbCachedRows) * width];
+          const short *above = &cache[(size_t)(mirrorIndex(i - k, height) % nbCachedRows) * width];
+          accumulateFixed(&acc[0], below, above, m_kernel[k], (unsigned int)width);
+        }
+        const short *center = &cache[(size_t)(i % nbCachedRows) * width];
+        unsigned char *out = m_GI[(unsigned int)i];
+        const int shift = FIXED_KERNEL_SHIFT + FIXED_ROW_SHIFT;
+        for (int j = 0; j < width; j++) {
+          const int v = (acc[j] + m_kernel[0] * center[j] + (1 << (shift - 1))) >> shift;
+          out[j] = (unsigned char)(std::min)(v, 255);
+        }
+      }
+    }
+
+  private:
+    const vpImage<unsigned char> &m_I;
+    vpImage<unsigned char> &m_GI;
+    const std::vector<short> &m_kernel;
+    int m_half;
+  };
+
+  //--------------------------------------------------------------------------
+  // Canny edge detector
+  //--------------------------------------------------------------------------
+  enum vpCannyLabel { CANNY_NONE, CANNY_WEAK, CANNY_STRONG };
+
+  //! L1 norm of the gradient, |gx| + |gy|, like the default of cv::Canny()
+  void gradientMagnitudeScalar(const float *gx, const float *gy, float *mag, const unsigned int n)
+  {
+    for (unsigned int j = 0; j < n; j++)
+      mag[j] = std::fabs(gx[j]) + std::fabs(gy[j]);
+  }
+
+#if VISP_HAVE_SSE2
+  void gradientMagnitudeSSE2(const float *gx, const float *gy, float *mag, const unsigned int n)
+  {
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    unsigned int j = 0;
+    for (; j + 4 <= n; j += 4) {
+      const __m128 ax = _mm_andnot_ps(sign, _mm_loadu_ps(gx + j));
+      const __m128 ay = _mm_andnot_ps(sign, _mm_loadu_ps(gy + j));
+      _mm_storeu_ps(mag + j, _mm_add_ps(ax, ay));
+    }
+    gradientMagnitudeScalar(gx + j, gy + j, mag + j, n - j);
+  }
+#endif
+
+#if VISP_HAVE_AVX2_DISPATCH
+  VP_TARGET_AVX2
+  void gradientMagnitudeAVX2(const float *gx, const float *gy, float *mag, const unsigned int n)
+  {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    unsigned int j = 0;
+    for (; j + 8 <= n; j += 8) {
+      const __m256 ax = _mm256_andnot_ps(sign, _mm256_loadu_ps(gx + j));
+      const __m256 ay = _mm256_andnot_ps(sign, _mm256_loadu_ps(gy + j));
+      _mm256_storeu_ps(mag + j, _mm256_add_ps(ax, ay));
+    }
+    gradientMagnitudeScalar(gx + j, gy + j, mag + j, n - j);
+  }
+#endif
+
+  void gradientMagnitude(const float *gx, const float *gy, float *mag, const unsigned int n)
+  {
+    switch (getFilterSimd()) {
+#if VISP_HAVE_AVX2_DISPATCH
+    case FILTER_AVX2:
+      gradientMagnitudeAVX2(gx, gy, mag, n);
+      break;
+#endif
+#if VISP_HAVE_SSE2
+    case FILTER_SSE2:
+      gradientMagnitudeSSE2(gx, gy, mag, n);
+      break;
+#endif
+    default:
+      gradientMagnitudeScalar(gx, gy, mag, n);
+    }
+  }
+
+  //! Gradient magnitude of the rows [begin, end).
+  class vpGradientMagnitudeTask : public vpThreadPool::Task
+  {
+  public:
+    vpGradientMagnitudeTask(const vpImage<float> &dIx, const vpImage<float> &dIy, vpImage<float> &mag)
+      : m_dIx(dIx), m_dIy(dIy), m_mag(mag)
+    {
+    }
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      for (unsigned int i = begin; i < end; i++)
+        gradientMagnitude(m_dIx[i], m_dIy[i], m_mag[i], m_mag.getWidth());
+    }
+
+  private:
+    const vpImage<float> &m_dIx;
+    const vpImage<float> &m_dIy;
+    vpImage<float> &m_mag;
+  };
+
+  /*
+    Non-maximum suppression along the gradient direction, quantized in 4 sectors,
+    and classification of the remaining pixels as weak or strong edges. The pixels
+    on the image borders are never edges.
+  */
+  class vpCannyNonMaxTask : public vpThreadPool::Task
+  {
+  public:
+    vpCannyNonMaxTask(const vpImage<float> &dIx, const vpImage<float> &dIy, const vpImage<float> &mag,
+                      const float lowerThreshold, const float upperThreshold, vpImage<unsigned char> &labels)
+      : m_dIx(dIx), m_dIy(dIy), m_mag(mag), m_lower(lowerThreshold), m_upper(upperThreshold), m_labels(labels)
+    {
+    }
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      const float tan22_5 = 0.4142135624f, tan67_5 = 2.4142135624f;
+      const unsigned int width = m_mag.getWidth(), height = m_mag.getHeight();
+      for (unsigned int i = begin; i < end; i++) {
+        unsigned char *label = m_labels[i];
+        std::fill(label, label + width, (unsigned char)CANNY_NONE);
+        if (i == 0 || i + 1 >= height)
+          continue;
+
+        const float *prev = m_mag[i - 1], *cur = m_mag[i], *next = m_mag[i + 1];
+        const float *gx = m_dIx[i], *gy = m_dIy[i];
+        for (unsigned int j = 1; j + 1 < width; j++) {
+          const float m = cur[j];
+          if (m <= m_lower)
+            continue;
+
+          const float ax = std::fabs(gx[j]), ay = std::fabs(gy[j]);
+          bool isMax;
+          if (ay < ax * tan22_5)
+            isMax = m > cur[j - 1] && m >= cur[j + 1];
+          else if (ay > ax * tan67_5)
+            isMax = m > prev[j] && m >= next[j];
+          else {
+            // Diagonal: the neighbors along the gradient depend on the signs of gx and gy
+            const int s = ((gx[j] < 0) != (gy[j] < 0)) ? -1 : 1;
+            isMax = m > prev[(int)j - s] && m > next[(int)j + s];
+          }
+          if (isMax)
+            label[j] = (unsigned char)(m > m_upper ? CANNY_STRONG : CANNY_WEAK);
+        }
+      }
+    }
+
+  private:
+    const vpImage<float> &m_dIx;
+    const vpImage<float> &m_dIy;
+    const vpImage<float> &m_mag;
+    float m_lower;
+    float m_upper;
+    vpImage<unsigned char> &m_labels;
+  };
+
+  /*
+    Hysteresis: the weak edges connected to a strong one become strong. The
+    connected pixels are followed with an explicit stack rather than by recursion,
+    so that long contours cannot overflow the call stack.
+  */
+  void cannyHysteresis(vpImage<unsigned char> &labels)
+  {
+    const int width = (int)labels.getWidth();
+    const unsigned int size = labels.getSize();
+    unsigned char *l = labels.bitmap;
+    const int neighbors[8] = { -width - 1, -width, -width + 1, -1, 1, width - 1, width, width + 1 };
+
+    std::vector<unsigned int> stack;
+    for (unsigned int p = 0; p < size; p++) {
+      if (l[p] == CANNY_STRONG)
+        stack.push_back(p);
+    }
+    // Only pixels inside the image are labeled, so their neighbors are always valid
+    while (! stack.empty()) {
+      const unsigned int p = stack.back();
+      stack.pop_back();
+      for (unsigned int k = 0; k < 8; k++) {
+        const unsigned int q = (unsigned int)((int)p + neighbors[k]);
+        if (l[q] == CANNY_WEAK) {
+          l[q] = CANNY_STRONG;
+          stack.push_back(q);
+        }
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  // Gaussian pyramid
+  //--------------------------------------------------------------------------
+  /*
+    Row of vpImageFilter::getGaussXPyramidal(): 1 4 6 4 1 filter on the even pixels,
+    the first and last pixels being copied. The sums are exact in 16 bits and the
+    division by 16 truncates, like the double computation of the per pixel code.
+  */
+  void pyramidRowX(const unsigned char *src, unsigned char *dst, const unsigned int w)
+  {
+    if (w == 0)
+      return;
+    dst[0] = src[0];
+    unsigned int j = 1;
+#if VISP_HAVE_SSE2
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    for (; j + 9 <= w; j += 8) {
+      const unsigned char *p = src + 2*(j - 1);
+      const __m128i v0 = _mm_loadu_si128((const __m128i *)p);
+      const __m128i v1 = _mm_loadu_si128((const __m128i *)(p + 2));
+      const __m128i v2 = _mm_loadu_si128((const __m128i *)(p + 4));
+      const __m128i e0 = _mm_and_si128(v0, mask), o0 = _mm_srli_epi16(v0, 8);
+      const __m128i e1 = _mm_and_si128(v1, mask), o1 = _mm_srli_epi16(v1, 8);
+      const __m128i e2 = _mm_and_si128(v2, mask);
+      __m128i sum = _mm_add_epi16(e0, e2);
+      sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_slli_epi16(e1, 2), _mm_slli_epi16(e1, 1)));
+      sum = _mm_add_epi16(sum, _mm_slli_epi16(_mm_add_epi16(o0, o1), 2));
+      const __m128i res = _mm_srli_epi16(sum, 4);
+      _mm_storel_epi64((__m128i *)(dst + j), _mm_packus_epi16(res, res));
+    }
+#endif
+    for (; j + 1 < w; j++) {
+      const unsigned char *p = src + 2*j;
+      dst[j] = (unsigned char)((p[-2] + 4*p[-1] + 6*p[0] + 4*p[1] + p[2]) >> 4);
+    }
+    dst[w - 1] = src[2*w - 1];
+  }
+
+  //! Row of vpImageFilter::getGaussYPyramidal() from 5 rows filtered along X.
+  void pyramidRowY(const unsigned char *r0, const unsigned char *r1, const unsigned char *r2,
+                   const unsigned char *r3, const unsigned char *r4, unsigned char *dst, const unsigned int w)
+  {
+    unsigned int j = 0;
+#if VISP_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; j + 8 <= w; j += 8) {
+      const __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(r0 + j)), zero);
+      const __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(r1 + j)), zero);
+      const __m128i c = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(r2 + j)), zero);
+      const __m128i d = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(r3 + j)), zero);
+      const __m128i e = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(r4 + j)), zero);
+      __m128i sum = _mm_add_epi16(a, e);
+      sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_slli_epi16(c, 2), _mm_slli_epi16(c, 1)));
+      sum = _mm_add_epi16(sum, _mm_slli_epi16(_mm_add_epi16(b, d), 2));
+      const __m128i res = _mm_srli_epi16(sum, 4);
+      _mm_storel_epi64((__m128i *)(dst + j), _mm_packus_epi16(res, res));
+    }
+#endif
+    for (; j < w; j++)
+      dst[j] = (unsigned char)((r0[j] + 4*r1[j] + 6*r2[j] + 4*r3[j] + r4[j]) >> 4);
+  }
+
+  /*
+    Rows [begin, end) of the half resolution image, identical to getGaussXPyramidal()
+    followed by getGaussYPyramidal(). The rows filtered along X are kept in a small
+    cache since consecutive output rows share three of them.
+  */
+  class vpGaussPyramidalTask : public vpThreadPool::Task
+  {
+  public:
+    vpGaussPyramidalTask(const vpImage<unsigned char> &I, vpImage<unsigned char> &GI)
+      : m_I(I), m_GI(GI)
+    {
+    }
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      const unsigned int w = m_GI.getWidth(), h = m_GI.getHeight();
+      std::vector<unsigned char> cache(5 * (size_t)w);
+      int tags[5] = { -1, -1, -1, -1, -1 };
+      for (unsigned int i = begin; i < end; i++) {
+        if (i == 0 || i + 1 == h) {
+          // First and last rows are not filtered along Y, the last one wins when h is 1
+          pyramidRowX(m_I[i + 1 == h ? 2*h - 1 : 0], m_GI[i], w);
+          continue;
+        }
+        const unsigned char *rows[5];
+        for (unsigned int k = 0; k < 5; k++) {
+          const int r = (int)(2*i + k) - 2;
+          unsigned char *row = &cache[(size_t)(r % 5) * w];
+          if (tags[r % 5] != r) {
+            pyramidRowX(m_I[(unsigned int)r], row, w);
+            tags[r % 5] = r;
+          }
+          rows[k] = row;
+        }
+        pyramidRowY(rows[0], rows[1], rows[2], rows[3], rows[4], m_GI[i], w);
+      }
+    }
+
+  private:
+    const vpImage<unsigned char> &m_I;
+    vpImage<unsigned char> &m_GI;
+  };
+}
+
 
 /*!
   Apply a filter to an image.
@@ -257,11 +976,14 @@ vpImageFilter::sepFilter(const vpImage<unsigned char> &I,
   }
 }
 
-#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
 /*!
   Apply the Canny edge operator on the image \e Isrc and return the resulting
   image \e Ires.
 
+  When ViSP is built with OpenCV, the edges are computed by cv::Canny() like in
+  the previous versions, otherwise by the native implementation, see
+  canny(const vpImage<unsigned char>&, vpImage<unsigned char>&, const unsigned int, const double, const double, const unsigned int, const vpCannyBackendType).
+
   The following example shows how to use the method:
 
   \code
@@ -271,7 +993,6 @@ vpImageFilter::sepFilter(const vpImage<unsigned char> &I,
 
 int main()
 {
-#if VISP_HAVE_OPENCV_VERSION >= 0x020100 // Canny uses OpenCV >=2.1.0
   // Constants for the Canny operator.
   const unsigned int gaussianFilterSize = 5;
   const double thresholdCanny = 15;
@@ -285,7 +1006,6 @@ int main()
 
   //Apply the Canny edge operator and set the Icanny image.
   vpImageFilter::canny(Isrc, Icanny, gaussianFilterSize, thresholdCanny, apertureSobel);
-#endif
   return (0);
 }
   \endcode
@@ -305,37 +1025,113 @@ vpImageFilter:: canny(const vpImage<unsigned char>& Isrc,
                       const double thresholdCanny,
                       const unsigned int apertureSobel)
 {
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
-  IplImage* img_ipl = NULL;
-  vpImageConvert::convert(Isrc, img_ipl);
-  IplImage* edges_ipl;
-  edges_ipl = cvCreateImage(cvSize(img_ipl->width, img_ipl->height), img_ipl->depth, img_ipl->nChannels);
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+  canny(Isrc, Ires, gaussianFilterSize, thresholdCanny, thresholdCanny, apertureSobel, CANNY_OPENCV_BACKEND);
+#else
+  canny(Isrc, Ires, gaussianFilterSize, thresholdCanny, thresholdCanny, apertureSobel, CANNY_VISP_BACKEND);
+#endif
+}
+
+/*!
+  Apply the Canny edge operator on the image \e Isrc and return the resulting
+  image \e Ires.
 
-  cvSmooth(img_ipl, img_ipl, CV_GAUSSIAN, (int)gaussianFilterSize, (int)gaussianFilterSize, 0, 0);
-  cvCanny(img_ipl, edges_ipl, thresholdCanny, thresholdCanny, (int)apertureSobel);
+  The native implementation smoothes the image with gaussianBlur(), using the
+  standard deviation that cv::GaussianBlur() chooses for this kernel size, and
+  computes the Sobel derivatives with the separable filters of this class. The
+  edges are the local maxima of the L1 norm of the gradient along its direction
+  that are above \e upperThreshold, or above \e lowerThreshold and connected to
+  such a pixel. The filtering and the non-maximum suppression of large images
+  are split in bands of rows over the threads of vpThreadPool.
 
-  vpImageConvert::convert(edges_ipl, Ires);
-  cvReleaseImage(&img_ipl);
-  cvReleaseImage(&edges_ipl);
+  \param Isrc : Image to apply the Canny edge detector to.
+  \param Ires : Filtered image (255 means an edge, 0 otherwise). It can be the
+  same image as \e Isrc.
+  \param gaussianFilterSize : The size of the mask of the Gaussian filter to
+  apply (an odd number).
+  \param lowerThreshold : Gradient magnitude under which a pixel is never an edge.
+  \param upperThreshold : Gradient magnitude above which a local maximum is always an edge.
+  \param apertureSobel : Size of the mask for the Sobel operator (3, 5 or 7).
+  \param backend : Implementation to use. CANNY_OPENCV_BACKEND requires ViSP to
+  be built with OpenCV.
+
+  \exception vpException::functionNotImplementedError : If the OpenCV backend is
+  requested and ViSP is not built with OpenCV.
+  \exception vpImageException::incorrectInitializationError : If the Sobel
+  aperture is not supported.
+*/
+void
+vpImageFilter::canny(const vpImage<unsigned char>& Isrc,
+                     vpImage<unsigned char>& Ires,
+                     const unsigned int gaussianFilterSize,
+                     const double lowerThreshold,
+                     const double upperThreshold,
+                     const unsigned int apertureSobel,
+                     const vpCannyBackendType backend)
+{
+  if (backend == CANNY_OPENCV_BACKEND) {
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+#  if (VISP_HAVE_OPENCV_VERSION < 0x020408)
+    IplImage* img_ipl = NULL;
+    vpImageConvert::convert(Isrc, img_ipl);
+    IplImage* edges_ipl;
+    edges_ipl = cvCreateImage(cvSize(img_ipl->width, img_ipl->height), img_ipl->depth, img_ipl->nChannels);
+
+    cvSmooth(img_ipl, img_ipl, CV_GAUSSIAN, (int)gaussianFilterSize, (int)gaussianFilterSize, 0, 0);
+    cvCanny(img_ipl, edges_ipl, lowerThreshold, upperThreshold, (int)apertureSobel);
+
+    vpImageConvert::convert(edges_ipl, Ires);
+    cvReleaseImage(&img_ipl);
+    cvReleaseImage(&edges_ipl);
+#  else
+    cv::Mat img_cvmat, edges_cvmat;
+    vpImageConvert::convert(Isrc, img_cvmat);
+    cv::GaussianBlur(img_cvmat, img_cvmat, cv::Size((int)gaussianFilterSize, (int)gaussianFilterSize), 0, 0);
+    cv::Canny(img_cvmat, edges_cvmat, lowerThreshold, upperThreshold, (int)apertureSobel);
+    vpImageConvert::convert(edges_cvmat, Ires);
+#  endif
+    return;
 #else
-  cv::Mat img_cvmat, edges_cvmat;
-  vpImageConvert::convert(Isrc, img_cvmat);
-  cv::GaussianBlur(img_cvmat, img_cvmat, cv::Size((int)gaussianFilterSize, (int)gaussianFilterSize), 0, 0);
-  cv::Canny(img_cvmat, edges_cvmat, thresholdCanny, thresholdCanny, (int)apertureSobel);
-  vpImageConvert::convert(edges_cvmat, Ires);
+    throw(vpException(vpException::functionNotImplementedError,
+                      "The OpenCV Canny backend requires ViSP to be built with OpenCV"));
 #endif
+  }
+
+  // Separable Sobel kernels, given like the Gaussian ones by their right coefficients
+  const float sobelSmooth[3][4] = { { 2, 1 }, { 6, 4, 1 }, { 20, 15, 6, 1 } };
+  const float sobelDerivative[3][4] = { { 0, 1 }, { 0, 2, 1 }, { 0, 5, 4, 1 } };
+  if (apertureSobel != 3 && apertureSobel != 5 && apertureSobel != 7)
+    throw (vpImageException(vpImageException::incorrectInitializationError, "Bad Sobel aperture %d", apertureSobel));
+  const unsigned int sobel = (apertureSobel - 3) / 2;
+
+  // Standard deviation chosen by cv::GaussianBlur() when it is not given
+  const double sigma = 0.3 * ((gaussianFilterSize - 1) * 0.5 - 1) + 0.8;
+  vpImage<float> Iblur, dIx, dIy, mag;
+  gaussianBlur(Isrc, Iblur, gaussianFilterSize, sigma);
+  separableFilter(Iblur, dIx, sobelDerivative[sobel], FILTER_DERIVATIVE, sobelSmooth[sobel], FILTER_SMOOTH, apertureSobel, false);
+  separableFilter(Iblur, dIy, sobelSmooth[sobel], FILTER_SMOOTH, sobelDerivative[sobel], FILTER_DERIVATIVE, apertureSobel, true);
+
+  const unsigned int width = Iblur.getWidth(), height = Iblur.getHeight();
+  mag.resize(height, width);
+  vpGradientMagnitudeTask magnitudeTask(dIx, dIy, mag);
+  runRows(magnitudeTask, width, height);
+
+  // Isrc is not read any more, the labels can be computed in place
+  Ires.resize(height, width);
+  vpCannyNonMaxTask nonMaxTask(dIx, dIy, mag, (float)lowerThreshold, (float)upperThreshold, Ires);
+  runRows(nonMaxTask, width, height);
+  cannyHysteresis(Ires);
+
+  for (unsigned int i = 0; i < Ires.getSize(); i++)
+    Ires.bitmap[i] = (Ires.bitmap[i] == CANNY_STRONG) ? 255 : 0;
 }
-#endif
 
 /*!
   Apply a separable filter.
  */
 void vpImageFilter::filter(const vpImage<unsigned char> &I, vpImage<double>& GI, const double *filter,unsigned  int size)
 {
-  vpImage<double> GIx ;
-  filterX(I, GIx,filter,size);
-  filterY(GIx, GI,filter,size);
-  GIx.destroy();
+  separableFilter(I, GI, filter, FILTER_SMOOTH, filter, FILTER_SMOOTH, size, true);
 }
 
 /*!
@@ -343,103 +1139,50 @@ void vpImageFilter::filter(const vpImage<unsigned char> &I, vpImage<double>& GI,
  */
 void vpImageFilter::filter(const vpImage<double> &I, vpImage<double>& GI, const double *filter,unsigned  int size)
 {
-  vpImage<double> GIx ;
-  filterX(I, GIx,filter,size);
-  filterY(GIx, GI,filter,size);
-  GIx.destroy();
+  separableFilter(I, GI, filter, FILTER_SMOOTH, filter, FILTER_SMOOTH, size, true);
+}
+
+/*!
+  Apply a separable symmetric filter in single precision.
+
+  \param I : Input image.
+  \param GI : Filtered image. It is only reallocated if its size differs from the one of \e I.
+  \param filter : The (size+1)/2 coefficients of the filter, the central one first, see getGaussianKernel().
+  \param size : Filter size. This value should be odd.
+ */
+void vpImageFilter::filter(const vpImage<unsigned char> &I, vpImage<float>& GI, const float *filter, unsigned int size)
+{
+  separableFilter(I, GI, filter, FILTER_SMOOTH, filter, FILTER_SMOOTH, size, true);
+}
+
+/*!
+  Apply a separable symmetric filter in single precision.
+
+  \param I : Input image.
+  \param GI : Filtered image. It is only reallocated if its size differs from the one of \e I.
+  \param filter : The (size+1)/2 coefficients of the filter, the central one first, see getGaussianKernel().
+  \param size : Filter size. This value should be odd.
+ */
+void vpImageFilter::filter(const vpImage<float> &I, vpImage<float>& GI, const float *filter, unsigned int size)
+{
+  separableFilter(I, GI, filter, FILTER_SMOOTH, filter, FILTER_SMOOTH, size, true);
 }
 
 void vpImageFilter::filterX(const vpImage<unsigned char> &I, vpImage<double>& dIx, const double *filter,unsigned  int size)
 {
-  dIx.resize(I.getHeight(),I.getWidth()) ;
-  for (unsigned int i=0 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < (size-1)/2 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::filterXLeftBorder(I,i,j,filter,size);
-      //dIx[i][j]=0;
-    }
-    for (unsigned int j=(size-1)/2 ; j < I.getWidth()-(size-1)/2 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::filterX(I,i,j,filter,size);
-    }
-    for (unsigned int j=I.getWidth()-(size-1)/2 ; j < I.getWidth() ; j++)
-    {
-      dIx[i][j]=vpImageFilter::filterXRightBorder(I,i,j,filter,size);
-      //dIx[i][j]=0;
-    }
-  }
+  separableFilter(I, dIx, filter, FILTER_SMOOTH, (const double *)NULL, FILTER_NONE, size, true);
 }
 void vpImageFilter::filterX(const vpImage<double> &I, vpImage<double>& dIx, const double *filter,unsigned  int size)
 {
-  dIx.resize(I.getHeight(),I.getWidth()) ;
-  for (unsigned int i=0 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < (size-1)/2 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::filterXLeftBorder(I,i,j,filter,size);
-      //dIx[i][j]=0;
-    }
-    for (unsigned int j=(size-1)/2 ; j < I.getWidth()-(size-1)/2 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::filterX(I,i,j,filter,size);
-    }
-    for (unsigned int j=I.getWidth()-(size-1)/2 ; j < I.getWidth() ; j++)
-    {
-      dIx[i][j]=vpImageFilter::filterXRightBorder(I,i,j,filter,size);
-      //dIx[i][j]=0;
-    }
-  }
+  separableFilter(I, dIx, filter, FILTER_SMOOTH, (const double *)NULL, FILTER_NONE, size, true);
 }
 void vpImageFilter::filterY(const vpImage<unsigned char> &I, vpImage<double>& dIy, const double *filter,unsigned  int size)
 {
-  dIy.resize(I.getHeight(),I.getWidth()) ;
-  for (unsigned int i=0 ; i < (size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::filterYTopBorder(I,i,j,filter,size);
-    }
-  }
-  for (unsigned int i=(size-1)/2 ; i < I.getHeight()-(size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::filterY(I,i,j,filter,size);
-    }
-  }
-  for (unsigned int i=I.getHeight()-(size-1)/2 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::filterYBottomBorder(I,i,j,filter,size);
-    }
-  }
+  separableFilter(I, dIy, (const double *)NULL, FILTER_NONE, filter, FILTER_SMOOTH, size, false);
 }
 void vpImageFilter::filterY(const vpImage<double> &I, vpImage<double>& dIy, const double *filter,unsigned  int size)
 {
-  dIy.resize(I.getHeight(),I.getWidth()) ;
-  for (unsigned int i=0 ; i < (size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::filterYTopBorder(I,i,j,filter,size);
-    }
-  }
-  for (unsigned int i=(size-1)/2 ; i < I.getHeight()-(size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::filterY(I,i,j,filter,size);
-    }
-  }
-  for (unsigned int i=I.getHeight()-(size-1)/2 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::filterYBottomBorder(I,i,j,filter,size);
-    }
-  }
+  separableFilter(I, dIy, (const double *)NULL, FILTER_NONE, filter, FILTER_SMOOTH, size, false);
 }
 
 /*!
@@ -453,13 +1196,9 @@ void vpImageFilter::filterY(const vpImage<double> &I, vpImage<double>& dIy, cons
  */
 void vpImageFilter::gaussianBlur(const vpImage<unsigned char> &I, vpImage<double>& GI, unsigned int size, double sigma, bool normalize)
 {
-  double *fg=new double[(size+1)/2] ;
-  vpImageFilter::getGaussianKernel(fg, size, sigma, normalize) ;
-  vpImage<double> GIx ;
-  vpImageFilter::filterX(I, GIx,fg,size);
-  vpImageFilter::filterY(GIx, GI,fg,size);
-  GIx.destroy();
-  delete[] fg;
+  std::vector<double> fg((size+1)/2);
+  vpImageFilter::getGaussianKernel(&fg[0], size, sigma, normalize) ;
+  vpImageFilter::filter(I, GI, &fg[0], size);
 }
 
 /*!
@@ -473,13 +1212,60 @@ void vpImageFilter::gaussianBlur(const vpImage<unsigned char> &I, vpImage<double
  */
 void vpImageFilter::gaussianBlur(const vpImage<double> &I, vpImage<double>& GI, unsigned int size, double sigma, bool normalize)
 {
-  double *fg=new double[(size+1)/2] ;
-  vpImageFilter::getGaussianKernel(fg, size, sigma, normalize) ;
-  vpImage<double> GIx ;
-  vpImageFilter::filterX(I, GIx,fg,size);
-  vpImageFilter::filterY(GIx, GI,fg,size);
-  GIx.destroy();
-  delete[] fg;
+  std::vector<double> fg((size+1)/2);
+  vpImageFilter::getGaussianKernel(&fg[0], size, sigma, normalize) ;
+  vpImageFilter::filter(I, GI, &fg[0], size);
+}
+
+/*!
+  Apply a Gaussian blur to an image in single precision.
+  \param I : Input image.
+  \param GI : Filtered image. It is only reallocated if its size differs from the one of \e I.
+  \param size : Filter size. This value should be odd.
+  \param sigma : Gaussian standard deviation. If it is equal to zero or negative, it is computed from filter size as sigma = (size-1)/6.
+  \param normalize : Flag indicating whether to normalize the filter coefficients or not.
+
+ */
+void vpImageFilter::gaussianBlur(const vpImage<unsigned char> &I, vpImage<float>& GI, unsigned int size, double sigma, bool normalize)
+{
+  std::vector<float> fg((size+1)/2);
+  vpImageFilter::getGaussianKernel(&fg[0], size, sigma, normalize) ;
+  vpImageFilter::filter(I, GI, &fg[0], size);
+}
+
+/*!
+  Apply a Gaussian blur to an image in fixed-point arithmetic.
+
+  The kernel is quantized on 12 bits and the intermediate rows are kept on 16 bits,
+  so the result may differ by one grey level from the rounded floating point blur.
+
+  \param I : Input image.
+  \param GI : Filtered image. It is only reallocated if its size differs from the one of \e I.
+  \param size : Filter size. This value should be odd.
+  \param sigma : Gaussian standard deviation. If it is equal to zero or negative, it is computed from filter size as sigma = (size-1)/6.
+  \param normalize : Flag indicating whether to normalize the filter coefficients or not.
+
+ */
+void vpImageFilter::gaussianBlur(const vpImage<unsigned char> &I, vpImage<unsigned char>& GI, unsigned int size, double sigma, bool normalize)
+{
+  std::vector<double> fg((size+1)/2);
+  vpImageFilter::getGaussianKernel(&fg[0], size, sigma, normalize) ;
+
+  std::vector<short> kernel(fg.size());
+  int sum = 0;
+  for (size_t i = 0; i < fg.size(); i++) {
+    kernel[i] = (short)vpMath::round(fg[i] * (1 << FIXED_KERNEL_SHIFT));
+    sum += (i == 0) ? kernel[i] : 2*kernel[i];
+  }
+  // A normalized kernel keeps the grey levels of a uniform image
+  if (normalize)
+    kernel[0] = (short)(kernel[0] + (1 << FIXED_KERNEL_SHIFT) - sum);
+
+  GI.resize(I.getHeight(), I.getWidth());
+  if (I.getSize() == 0)
+    return;
+  vpFixedGaussianTask task(I, GI, kernel);
+  runRows(task, I.getWidth(), I.getHeight());
 }
 
 /*!
@@ -564,6 +1350,30 @@ void vpImageFilter::getGaussianDerivativeKernel(double *filter, unsigned int siz
 }
 
 
+/*!
+  Return the coefficients of a Gaussian filter in single precision, see
+  getGaussianKernel(double *, unsigned int, double, bool).
+*/
+void vpImageFilter::getGaussianKernel(float *filter, unsigned int size, double sigma, bool normalize)
+{
+  std::vector<double> f((size+1)/2);
+  getGaussianKernel(&f[0], size, sigma, normalize);
+  for (size_t i = 0; i < f.size(); i++)
+    filter[i] = (float)f[i];
+}
+
+/*!
+  Return the coefficients of a Gaussian derivative filter in single precision, see
+  getGaussianDerivativeKernel(double *, unsigned int, double, bool).
+*/
+void vpImageFilter::getGaussianDerivativeKernel(float *filter, unsigned int size, double sigma, bool normalize)
+{
+  std::vector<double> f((size+1)/2);
+  getGaussianDerivativeKernel(&f[0], size, sigma, normalize);
+  for (size_t i = 0; i < f.size(); i++)
+    filter[i] = (float)f[i];
+}
+
 void vpImageFilter::getGradX(const vpImage<unsigned char> &I, vpImage<double>& dIx)
 {
   dIx.resize(I.getHeight(),I.getWidth()) ;
@@ -614,99 +1424,47 @@ void vpImageFilter::getGradY(const vpImage<unsigned char> &I, vpImage<double>& d
 
 void vpImageFilter::getGradX(const vpImage<unsigned char> &I, vpImage<double>& dIx, const double *filter,unsigned  int size)
 {
-  dIx.resize(I.getHeight(),I.getWidth()) ;
-  //#pragma omp parallel for
-  for (unsigned int i=0 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < (size-1)/2 ; j++)
-    {
-      dIx[i][j]=0;
-    }
-    for (unsigned int j=(size-1)/2 ; j < I.getWidth()-(size-1)/2 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::derivativeFilterX(I,i,j,filter,size);
-    }
-    for (unsigned int j=I.getWidth()-(size-1)/2 ; j < I.getWidth() ; j++)
-    {
-      dIx[i][j]=0;
-    }
-  }
+  separableFilter(I, dIx, filter, FILTER_DERIVATIVE, (const double *)NULL, FILTER_NONE, size, true);
 }
 void vpImageFilter::getGradX(const vpImage<double> &I, vpImage<double>& dIx, const double *filter,unsigned  int size)
 {
-  dIx.resize(I.getHeight(),I.getWidth()) ;
-  //dIx=0;
-  for (unsigned int i=0 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < (size-1)/2 ; j++)
-    {
-      dIx[i][j]=0;
-    }
-    for (unsigned int j=(size-1)/2 ; j < I.getWidth()-(size-1)/2 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::derivativeFilterX(I,i,j,filter,size);
-    }
-    for (unsigned int j=I.getWidth()-(size-1)/2 ; j < I.getWidth() ; j++)
-    {
-      dIx[i][j]=0;
-    }
-  }
+  separableFilter(I, dIx, filter, FILTER_DERIVATIVE, (const double *)NULL, FILTER_NONE, size, true);
 }
 
 void vpImageFilter::getGradY(const vpImage<unsigned char> &I, vpImage<double>& dIy, const double *filter,unsigned  int size)
 {
-  dIy.resize(I.getHeight(),I.getWidth()) ;
-  //#pragma omp parallel for
-  for (unsigned int i=0 ; i < (size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=0;
-    }
-  }
-  //#pragma omp parallel for
-  for (unsigned int i=(size-1)/2 ; i < I.getHeight()-(size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::derivativeFilterY(I,i,j,filter,size);
-    }
-  }
-  //#pragma omp parallel for
-  for (unsigned int i=I.getHeight()-(size-1)/2 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=0;
-    }
-  }
+  separableFilter(I, dIy, (const double *)NULL, FILTER_NONE, filter, FILTER_DERIVATIVE, size, false);
 }
 
 void vpImageFilter::getGradY(const vpImage<double> &I, vpImage<double>& dIy, const double *filter,unsigned  int size)
 {
-  dIy.resize(I.getHeight(),I.getWidth()) ;
-  //dIy=0;
-  for (unsigned int i=0 ; i < (size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=0;
-    }
-  }
-  for (unsigned int i=(size-1)/2 ; i < I.getHeight()-(size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::derivativeFilterY(I,i,j,filter,size);
-    }
-  }
-  for (unsigned int i=I.getHeight()-(size-1)/2 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=0;
-    }
-  }
+  separableFilter(I, dIy, (const double *)NULL, FILTER_NONE, filter, FILTER_DERIVATIVE, size, false);
+}
+
+/*!
+   Compute the gradient along X in single precision.
+   \param I : Input image
+   \param dIx : Gradient along X, set to 0 on the (size-1)/2 first and last columns.
+   It is only reallocated if its size differs from the one of \e I.
+   \param filter : Derivative kernel, for instance computed using vpImageFilter::getGaussianDerivativeKernel().
+   \param size : Size of the kernel.
+ */
+void vpImageFilter::getGradX(const vpImage<unsigned char> &I, vpImage<float>& dIx, const float *filter, unsigned int size)
+{
+  separableFilter(I, dIx, filter, FILTER_DERIVATIVE, (const float *)NULL, FILTER_NONE, size, true);
+}
+
+/*!
+   Compute the gradient along Y in single precision.
+   \param I : Input image
+   \param dIy : Gradient along Y, set to 0 on the (size-1)/2 first and last rows.
+   It is only reallocated if its size differs from the one of \e I.
+   \param filter : Derivative kernel, for instance computed using vpImageFilter::getGaussianDerivativeKernel().
+   \param size : Size of the kernel.
+ */
+void vpImageFilter::getGradY(const vpImage<unsigned char> &I, vpImage<float>& dIy, const float *filter, unsigned int size)
+{
+  separableFilter(I, dIy, (const float *)NULL, FILTER_NONE, filter, FILTER_DERIVATIVE, size, false);
 }
 
 /*!
@@ -719,9 +1477,7 @@ void vpImageFilter::getGradY(const vpImage<double> &I, vpImage<double>& dIy, con
  */
 void vpImageFilter::getGradXGauss2D(const vpImage<unsigned char> &I, vpImage<double>& dIx, const double *gaussianKernel, const double *gaussianDerivativeKernel, unsigned  int size)
 {
-  vpImage<double> GIy;
-  vpImageFilter::filterY(I,  GIy, gaussianKernel, size);
-  vpImageFilter::getGradX(GIy, dIx, gaussianDerivativeKernel, size);
+  separableFilter(I, dIx, gaussianDerivativeKernel, FILTER_DERIVATIVE, gaussianKernel, FILTER_SMOOTH, size, false);
 }
 
 /*!
@@ -734,15 +1490,45 @@ void vpImageFilter::getGradXGauss2D(const vpImage<unsigned char> &I, vpImage<dou
  */
 void vpImageFilter::getGradYGauss2D(const vpImage<unsigned char> &I, vpImage<double>& dIy, const double *gaussianKernel, const double *gaussianDerivativeKernel,unsigned  int size)
 {
-  vpImage<double> GIx;
-  vpImageFilter::filterX(I,  GIx, gaussianKernel, size);
-  vpImageFilter::getGradY(GIx, dIy, gaussianDerivativeKernel, size);
+  separableFilter(I, dIy, gaussianKernel, FILTER_SMOOTH, gaussianDerivativeKernel, FILTER_DERIVATIVE, size, true);
+}
+
+/*!
+   Compute the gradient along X after applying a gaussian filter along Y, in single precision.
+   \param I : Input image
+   \param dIx : Gradient along X. It is only reallocated if its size differs from the one of \e I.
+   \param gaussianKernel : Gaussian kernel which values should be computed using vpImageFilter::getGaussianKernel().
+   \param gaussianDerivativeKernel : Gaussian derivative kernel which values should be computed using vpImageFilter::getGaussianDerivativeKernel().
+   \param size : Size of the Gaussian and Gaussian derivative kernels.
+ */
+void vpImageFilter::getGradXGauss2D(const vpImage<unsigned char> &I, vpImage<float>& dIx, const float *gaussianKernel,
+                                    const float *gaussianDerivativeKernel, unsigned int size)
+{
+  separableFilter(I, dIx, gaussianDerivativeKernel, FILTER_DERIVATIVE, gaussianKernel, FILTER_SMOOTH, size, false);
 }
 
-//operation pour pyramide gaussienne
+/*!
+   Compute the gradient along Y after applying a gaussian filter along X, in single precision.
+   \param I : Input image
+   \param dIy : Gradient along Y. It is only reallocated if its size differs from the one of \e I.
+   \param gaussianKernel : Gaussian kernel which values should be computed using vpImageFilter::getGaussianKernel().
+   \param gaussianDerivativeKernel : Gaussian derivative kernel which values should be computed using vpImageFilter::getGaussianDerivativeKernel().
+   \param size : Size of the Gaussian and Gaussian derivative kernels.
+ */
+void vpImageFilter::getGradYGauss2D(const vpImage<unsigned char> &I, vpImage<float>& dIy, const float *gaussianKernel,
+                                    const float *gaussianDerivativeKernel, unsigned int size)
+{
+  separableFilter(I, dIy, gaussianKernel, FILTER_SMOOTH, gaussianDerivativeKernel, FILTER_DERIVATIVE, size, true);
+}
+
+/*!
+  Compute the next level of a Gaussian pyramid: \e GI is \e I smoothed by a 1 4 6 4 1
+  filter and subsampled by 2 in each direction. Without OpenCV, the result is the one
+  of getGaussXPyramidal() followed by getGaussYPyramidal(), computed in a single
+  vectorized pass. \e GI can be the same image as \e I.
+*/
 void vpImageFilter::getGaussPyramidal(const vpImage<unsigned char> &I, vpImage<unsigned char>& GI)
 {
-  vpImage<unsigned char> GIx;
 #if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x030000)
   cv::Mat imgsrc, imgdest;
   vpImageConvert::convert(I, imgsrc);
@@ -767,8 +1553,17 @@ void vpImageFilter::getGaussPyramidal(const vpImage<unsigned char> &I, vpImage<u
   //vpImage<unsigned char> sGI;sGI=GI;
 
 #else
-  vpImageFilter::getGaussXPyramidal(I,GIx);
-  vpImageFilter::getGaussYPyramidal(GIx,GI);
+  // Same result as getGaussXPyramidal() followed by getGaussYPyramidal()
+  if (&I == &GI) {
+    vpImage<unsigned char> Icopy(I);
+    getGaussPyramidal(Icopy, GI);
+    return;
+  }
+  GI.resize(I.getHeight() / 2, I.getWidth() / 2);
+  if (GI.getSize() == 0)
+    return;
+  vpGaussPyramidalTask task(I, GI);
+  runRows(task, GI.getWidth(), GI.getHeight());
 #endif
 }
 
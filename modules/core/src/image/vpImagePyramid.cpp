@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Pyramid of images with preallocated levels.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpImagePyramid.cpp
+  \brief Pyramid of images with preallocated levels.
+*/
+
+#include <visp3/core/vpImageException.h>
+#include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpImagePyramid.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+/*!
+  Create a pyramid with \e nbLevels levels, the first one being the full
+  resolution image. No image is allocated before the first call to build().
+*/
+vpImagePyramid::vpImagePyramid(const unsigned int nbLevels, const vpReductionType type)
+  : m_nbLevels(0), m_type(type), m_base(NULL), m_levels(), m_generation(0)
+{
+  setNbLevels(nbLevels);
+}
+
+/*!
+  Compute the levels of the pyramid from the image \e I. The levels keep their
+  memory when the size of \e I does not change.
+
+  \param I : Full resolution image, that becomes the first level. It is not
+  copied and must outlive the use of the pyramid.
+*/
+void vpImagePyramid::build(const vpImage<unsigned char> &I)
+{
+  m_base = &I;
+  for (unsigned int l = 1; l < m_nbLevels; l++) {
+    const vpImage<unsigned char> &prev = (l == 1) ? I : m_levels[l - 1];
+    if (m_type == GAUSSIAN_REDUCTION)
+      vpImageFilter::getGaussPyramidal(prev, m_levels[l]);
+    else
+      subsample(prev, m_levels[l]);
+  }
+  m_generation++;
+}
+
+/*!
+  Forget the full resolution image given to build(). The memory of the other
+  levels is kept for the next call to build().
+*/
+void vpImagePyramid::clear()
+{
+  m_base = NULL;
+}
+
+/*!
+  Return the image of a level, the level 0 being the image given to build().
+
+  \exception vpImageException::notInitializedError : If the pyramid was not built.
+  \exception vpImageException::incorrectInitializationError : If the level does not exist.
+*/
+const vpImage<unsigned char> &vpImagePyramid::getLevel(const unsigned int level) const
+{
+  if (m_base == NULL)
+    throw(vpImageException(vpImageException::notInitializedError, "The image pyramid is not built"));
+  if (level >= m_nbLevels)
+    throw(vpImageException(vpImageException::incorrectInitializationError,
+                           "Level %d does not exist in a %d levels pyramid", level, m_nbLevels));
+  return (level == 0) ? *m_base : m_levels[level];
+}
+
+/*!
+  Set the number of levels, at least 1. The pyramid has to be built again.
+*/
+void vpImagePyramid::setNbLevels(const unsigned int nbLevels)
+{
+  const unsigned int n = (nbLevels < 1) ? 1 : nbLevels;
+  if (n != m_nbLevels) {
+    m_nbLevels = n;
+    m_levels.resize(n);
+    m_base = NULL;
+  }
+}
+
+/*!
+  Set how a level is computed from the previous one. The pyramid has to be
+  built again.
+*/
+void vpImagePyramid::setReductionType(const vpReductionType type)
+{
+  if (type != m_type) {
+    m_type = type;
+    m_base = NULL;
+  }
+}
+
+/*!
+  Keep one pixel over two in each direction: \f$ I_{sub}(i, j) = I(2i, 2j) \f$.
+  \e Isub is only reallocated if its size is not the half of the one of \e I.
+*/
+void vpImagePyramid::subsample(const vpImage<unsigned char> &I, vpImage<unsigned char> &Isub)
+{
+  const unsigned int w = I.getWidth() / 2, h = I.getHeight() / 2;
+  Isub.resize(h, w);
+  for (unsigned int i = 0; i < h; i++) {
+    const unsigned char *src = I[2*i];
+    unsigned char *dst = Isub[i];
+    unsigned int j = 0;
+#if VISP_HAVE_SSE2
+    // The even bytes of 32 source pixels packed in 16 pixels
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    for (; j + 16 <= w; j += 16) {
+      const __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src + 2*j)), mask);
+      const __m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src + 2*j + 16)), mask);
+      _mm_storeu_si128((__m128i *)(dst + j), _mm_packus_epi16(a, b));
+    }
+#endif
+    for (; j < w; j++)
+      dst[j] = src[2*j];
+  }
+}
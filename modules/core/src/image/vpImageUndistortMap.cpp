@@ -0,0 +1,426 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Precomputed remap tables to undistort images.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpImageUndistortMap.cpp
+  \brief Precomputed remap tables to undistort images.
+*/
+
+#include <cmath>
+#include <limits>
+#include <string.h>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpImageUndistortMap.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpThreadPool.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+// AVX2 kernels compiled with a target attribute and selected at run time
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    ((defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 5)) || (defined(__clang__) && (__clang_major__ >= 4)))
+#  include <immintrin.h>
+#  define VISP_HAVE_AVX2_DISPATCH 1
+#  define VP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+  //! Number of bits of the bilinear weights along each direction
+  const unsigned int weightBits = 7;
+  const unsigned int weightOne = 1 << weightBits;
+  const int weightRound = 1 << (2*weightBits - 1);
+  //! Source coordinates of a destination pixel that falls outside the image
+  const unsigned int invalidCoords = 0xFFFFFFFF;
+
+  bool hasAVX2()
+  {
+    // The detection always gives the same result, a concurrent first call is harmless
+    static int avx2 = -1;
+    if (avx2 < 0) {
+      avx2 = 0;
+#if VISP_HAVE_AVX2_DISPATCH
+      __builtin_cpu_init();
+      avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+#endif
+    }
+    return avx2 != 0;
+  }
+
+#if VISP_HAVE_AVX2_DISPATCH
+  /*
+    Remap 8 grey level pixels at a time, the 2x2 neighborhoods being read with
+    two gathers of 4 bytes. The one of the bottom row starts 2 bytes before the
+    pixel, so that none of them reads past the end of the image. Return the
+    number of pixels processed.
+  */
+  VP_TARGET_AVX2
+  unsigned int remapGreyAVX2(const unsigned char *src, const unsigned int stride, const unsigned int *coords,
+                             const unsigned int *weights, unsigned char *dst, const unsigned int n)
+  {
+    const __m256i ones = _mm256_set1_epi32(-1);
+    const __m256i lowMask = _mm256_set1_epi32(0xFFFF);
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    const __m256i one = _mm256_set1_epi32((int)weightOne);
+    const __m256i round = _mm256_set1_epi32(weightRound);
+    const __m256i vstride = _mm256_set1_epi32((int)stride);
+    const int *top = (const int *)src;
+    const int *bottom = (const int *)(src + stride - 2);
+
+    unsigned int j = 0;
+    for (; j + 8 <= n; j += 8) {
+      __m256i c = _mm256_loadu_si256((const __m256i *)(coords + j));
+      const __m256i w = _mm256_loadu_si256((const __m256i *)(weights + j));
+      const __m256i invalid = _mm256_cmpeq_epi32(c, ones);
+      c = _mm256_andnot_si256(invalid, c);
+      const __m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(c, 16), vstride),
+                                           _mm256_and_si256(c, lowMask));
+
+      const __m256i t = _mm256_i32gather_epi32(top, idx, 1);
+      const __m256i b = _mm256_i32gather_epi32(bottom, idx, 1);
+      const __m256i p00 = _mm256_and_si256(t, byteMask);
+      const __m256i p01 = _mm256_and_si256(_mm256_srli_epi32(t, 8), byteMask);
+      const __m256i p10 = _mm256_and_si256(_mm256_srli_epi32(b, 16), byteMask);
+      const __m256i p11 = _mm256_srli_epi32(b, 24);
+
+      const __m256i du = _mm256_and_si256(w, lowMask);
+      const __m256i dv = _mm256_srli_epi32(w, 16);
+      const __m256i cu = _mm256_sub_epi32(one, du);
+      const __m256i r0 = _mm256_add_epi32(_mm256_mullo_epi32(p00, cu), _mm256_mullo_epi32(p01, du));
+      const __m256i r1 = _mm256_add_epi32(_mm256_mullo_epi32(p10, cu), _mm256_mullo_epi32(p11, du));
+      __m256i r = _mm256_add_epi32(_mm256_mullo_epi32(r0, _mm256_sub_epi32(one, dv)), _mm256_mullo_epi32(r1, dv));
+      r = _mm256_srli_epi32(_mm256_add_epi32(r, round), 2*weightBits);
+      r = _mm256_andnot_si256(invalid, r);
+
+      // 8 results in [0, 255] packed in 8 bytes
+      r = _mm256_packus_epi16(_mm256_packs_epi32(r, r), r);
+      const int lo = _mm_cvtsi128_si32(_mm256_castsi256_si128(r));
+      const int hi = _mm_cvtsi128_si32(_mm256_extracti128_si256(r, 1));
+      memcpy(dst + j, &lo, 4);
+      memcpy(dst + j + 4, &hi, 4);
+    }
+    return j;
+  }
+#endif
+
+  class vpRemapGreyTask : public vpThreadPool::Task
+  {
+  public:
+    vpRemapGreyTask(const vpImage<unsigned char> &I, vpImage<unsigned char> &Iundist,
+                    const unsigned int *coords, const unsigned int *weights)
+      : m_I(I), m_Iundist(Iundist), m_coords(coords), m_weights(weights)
+    {
+    }
+
+    //! Remap the rows in [begin, end).
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      const unsigned int width = m_I.getWidth();
+      const unsigned int stride = m_I.getStride();
+      const unsigned char *src = m_I.bitmap;
+#if VISP_HAVE_AVX2_DISPATCH
+      const bool avx2 = hasAVX2() && width >= 4 && m_I.getHeight() >= 2;
+#endif
+      for (unsigned int i = begin; i < end; i++) {
+        const unsigned int *coords = m_coords + i*width;
+        const unsigned int *weights = m_weights + i*width;
+        unsigned char *dst = m_Iundist[i];
+        unsigned int j = 0;
+#if VISP_HAVE_AVX2_DISPATCH
+        if (avx2)
+          j = remapGreyAVX2(src, stride, coords, weights, dst, width);
+#endif
+        for (; j < width; j++) {
+          const unsigned int c = coords[j];
+          if (c == invalidCoords) {
+            dst[j] = 0;
+            continue;
+          }
+          const unsigned char *p = src + (c >> 16)*stride + (c & 0xFFFF);
+          const int du = (int)(weights[j] & 0xFFFF), dv = (int)(weights[j] >> 16);
+          const int r0 = p[0]*((int)weightOne - du) + p[1]*du;
+          const int r1 = p[stride]*((int)weightOne - du) + p[stride + 1]*du;
+          dst[j] = (unsigned char)((r0*((int)weightOne - dv) + r1*dv + weightRound) >> (2*weightBits));
+        }
+      }
+    }
+
+  private:
+    const vpImage<unsigned char> &m_I;
+    vpImage<unsigned char> &m_Iundist;
+    const unsigned int *m_coords;
+    const unsigned int *m_weights;
+  };
+
+  class vpRemapColorTask : public vpThreadPool::Task
+  {
+  public:
+    vpRemapColorTask(const vpImage<vpRGBa> &I, vpImage<vpRGBa> &Iundist,
+                     const unsigned int *coords, const unsigned int *weights)
+      : m_I(I), m_Iundist(Iundist), m_coords(coords), m_weights(weights)
+    {
+    }
+
+    //! Remap the rows in [begin, end).
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      const unsigned int width = m_I.getWidth();
+      const unsigned int stride = m_I.getStride();
+      const vpRGBa *src = m_I.bitmap;
+#if VISP_HAVE_SSE2
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i round = _mm_set1_epi32(weightRound);
+#endif
+      for (unsigned int i = begin; i < end; i++) {
+        const unsigned int *coords = m_coords + i*width;
+        const unsigned int *weights = m_weights + i*width;
+        vpRGBa *dst = m_Iundist[i];
+        for (unsigned int j = 0; j < width; j++) {
+          const unsigned int c = coords[j];
+          if (c == invalidCoords) {
+            dst[j] = vpRGBa(0, 0, 0, 0);
+            continue;
+          }
+          const vpRGBa *p = src + (c >> 16)*stride + (c & 0xFFFF);
+          const int du = (int)(weights[j] & 0xFFFF), dv = (int)(weights[j] >> 16);
+          // Weights of the 4 neighbors on 14 bits, their sum being 1 << 14
+          const int w00 = ((int)weightOne - du)*((int)weightOne - dv);
+          const int w01 = du*((int)weightOne - dv);
+          const int w10 = ((int)weightOne - du)*dv;
+          const int w11 = du*dv;
+#if VISP_HAVE_SSE2
+          // Interleave the channels of the 2 pixels of each row, R0 R1 G0 G1 B0 B1 A0 A1, then multiply-add the pairs
+          const __m128i t = _mm_loadl_epi64((const __m128i *)p);
+          const __m128i b = _mm_loadl_epi64((const __m128i *)(p + stride));
+          const __m128i t16 = _mm_unpacklo_epi8(_mm_unpacklo_epi8(t, _mm_srli_si128(t, 4)), zero);
+          const __m128i b16 = _mm_unpacklo_epi8(_mm_unpacklo_epi8(b, _mm_srli_si128(b, 4)), zero);
+          __m128i r = _mm_add_epi32(_mm_madd_epi16(t16, _mm_set1_epi32((w01 << 16) | w00)),
+                                    _mm_madd_epi16(b16, _mm_set1_epi32((w11 << 16) | w10)));
+          r = _mm_srli_epi32(_mm_add_epi32(r, round), 2*weightBits);
+          r = _mm_packus_epi16(_mm_packs_epi32(r, r), r);
+          const int rgba = _mm_cvtsi128_si32(r);
+          memcpy((void *)(dst + j), &rgba, 4);
+#else
+          const vpRGBa *q = p + stride;
+          dst[j].R = (unsigned char)((p[0].R*w00 + p[1].R*w01 + q[0].R*w10 + q[1].R*w11 + weightRound) >> (2*weightBits));
+          dst[j].G = (unsigned char)((p[0].G*w00 + p[1].G*w01 + q[0].G*w10 + q[1].G*w11 + weightRound) >> (2*weightBits));
+          dst[j].B = (unsigned char)((p[0].B*w00 + p[1].B*w01 + q[0].B*w10 + q[1].B*w11 + weightRound) >> (2*weightBits));
+          dst[j].A = (unsigned char)((p[0].A*w00 + p[1].A*w01 + q[0].A*w10 + q[1].A*w11 + weightRound) >> (2*weightBits));
+#endif
+        }
+      }
+    }
+
+  private:
+    const vpImage<vpRGBa> &m_I;
+    vpImage<vpRGBa> &m_Iundist;
+    const unsigned int *m_coords;
+    const unsigned int *m_weights;
+  };
+
+  void runRemap(vpThreadPool::Task &task, const unsigned int height, const unsigned int nThreads)
+  {
+    if (nThreads == 1) {
+      task(0, height);
+    }
+    else {
+      const unsigned int nbThreads = nThreads > 0 ? nThreads : vpThreadPool::getInstance().getNumThreads();
+      vpThreadPool::getInstance().parallelFor(0, height, task, (height + nbThreads - 1) / nbThreads, nbThreads);
+    }
+  }
+}
+
+/*!
+  Create empty tables. init() has to be called before remap().
+*/
+vpImageUndistortMap::vpImageUndistortMap()
+  : m_width(0), m_height(0), m_identity(true), m_coords(), m_weights()
+{
+}
+
+/*!
+  Compute the tables for the images of size \e width x \e height of a camera.
+  See init().
+*/
+vpImageUndistortMap::vpImageUndistortMap(const vpCameraParameters &cam, const unsigned int width,
+                                         const unsigned int height)
+  : m_width(0), m_height(0), m_identity(true), m_coords(), m_weights()
+{
+  init(cam, width, height);
+}
+
+void vpImageUndistortMap::checkSize(const unsigned int width, const unsigned int height) const
+{
+  if (width != m_width || height != m_height) {
+    throw(vpException(vpException::dimensionError,
+                      "Cannot undistort a %dx%d image with remap tables computed for %dx%d images",
+                      width, height, m_width, m_height));
+  }
+}
+
+/*!
+  Compute the tables for the images of size \e width x \e height of a camera.
+
+  A pixel (u, v) of the undistorted image takes the value of the point of the
+  distorted image given by the model of vpImageTools::undistort():
+  \f[ u_d = u_0 + (u - u_0) (1 + k_{ud} r^2), \quad v_d = v_0 + (v - v_0) (1 + k_{ud} r^2) \f]
+  with \f$ r^2 = ((u - u_0) / p_x)^2 + ((v - v_0) / p_y)^2 \f$. The pixels whose
+  2x2 neighborhood around this point is not entirely inside the image are set
+  to 0.
+
+  \param cam : Camera parameters with the \f$ k_{ud} \f$ distortion coefficient.
+  \param width, height : Size of the images given to remap().
+
+  \exception vpException::dimensionError : If the width or the height is larger than 65535.
+*/
+void vpImageUndistortMap::init(const vpCameraParameters &cam, const unsigned int width, const unsigned int height)
+{
+  if (width > 0xFFFF || height > 0xFFFF) {
+    throw(vpException(vpException::dimensionError,
+                      "Cannot compute the undistortion tables of a %dx%d image", width, height));
+  }
+
+  m_width = width;
+  m_height = height;
+
+  const double kud = cam.get_kud();
+  m_identity = std::fabs(kud) <= std::numeric_limits<double>::epsilon();
+  if (m_identity) {
+    m_coords.clear();
+    m_weights.clear();
+    return;
+  }
+
+  m_coords.resize((size_t)width*height);
+  m_weights.resize((size_t)width*height);
+
+  const double u0 = cam.get_u0(), v0 = cam.get_v0();
+  const double invpx = 1.0 / cam.get_px(), invpy = 1.0 / cam.get_py();
+  const double kud_px2 = kud * invpx * invpx;
+  const double kud_py2 = kud * invpy * invpy;
+
+  size_t k = 0;
+  for (unsigned int v = 0; v < height; v++) {
+    const double deltav = v - v0;
+    const double fr1 = 1.0 + kud_py2 * deltav * deltav;
+    for (unsigned int u = 0; u < width; u++, k++) {
+      const double deltau = u - u0;
+      const double fr2 = fr1 + kud_px2 * deltau * deltau;
+      const double ud = deltau * fr2 + u0;
+      const double vd = deltav * fr2 + v0;
+
+      const double uf = std::floor(ud), vf = std::floor(vd);
+      if (uf < 0 || vf < 0 || uf >= (double)width - 1 || vf >= (double)height - 1) {
+        m_coords[k] = invalidCoords;
+        m_weights[k] = 0;
+        continue;
+      }
+      const unsigned int du = (unsigned int)vpMath::round((ud - uf) * weightOne);
+      const unsigned int dv = (unsigned int)vpMath::round((vd - vf) * weightOne);
+      m_coords[k] = ((unsigned int)vf << 16) | (unsigned int)uf;
+      m_weights[k] = (dv << 16) | du;
+    }
+  }
+}
+
+/*!
+  Undistort a grey level image.
+
+  \param I : Distorted image, of the size given to init(). It may have padded
+  rows, see vpImage::initAligned().
+  \param Iundist : Undistorted image, resized if needed. It can be \e I.
+  \param nThreads : Number of threads used to process bands of rows. The
+  threads are taken from vpThreadPool. If 0, vpThreadPool::getNumThreads()
+  threads are used.
+
+  \exception vpException::dimensionError : If \e I does not have the size of the tables.
+*/
+void vpImageUndistortMap::remap(const vpImage<unsigned char> &I, vpImage<unsigned char> &Iundist,
+                                const unsigned int nThreads) const
+{
+  checkSize(I.getWidth(), I.getHeight());
+  if (m_identity) {
+    if (&I != &Iundist)
+      Iundist = I;
+    return;
+  }
+  if (&I == &Iundist) {
+    vpImage<unsigned char> Icopy(I);
+    remap(Icopy, Iundist, nThreads);
+    return;
+  }
+
+  Iundist.resize(m_height, m_width);
+  if (m_coords.empty())
+    return;
+  vpRemapGreyTask task(I, Iundist, &m_coords[0], &m_weights[0]);
+  runRemap(task, m_height, nThreads);
+}
+
+/*!
+  Undistort a color image. The four channels are interpolated.
+
+  \param I : Distorted image, of the size given to init(). It may have padded
+  rows, see vpImage::initAligned().
+  \param Iundist : Undistorted image, resized if needed. It can be \e I.
+  \param nThreads : Number of threads used to process bands of rows. The
+  threads are taken from vpThreadPool. If 0, vpThreadPool::getNumThreads()
+  threads are used.
+
+  \exception vpException::dimensionError : If \e I does not have the size of the tables.
+*/
+void vpImageUndistortMap::remap(const vpImage<vpRGBa> &I, vpImage<vpRGBa> &Iundist,
+                                const unsigned int nThreads) const
+{
+  checkSize(I.getWidth(), I.getHeight());
+  if (m_identity) {
+    if (&I != &Iundist)
+      Iundist = I;
+    return;
+  }
+  if (&I == &Iundist) {
+    vpImage<vpRGBa> Icopy(I);
+    remap(Icopy, Iundist, nThreads);
+    return;
+  }
+
+  Iundist.resize(m_height, m_width);
+  if (m_coords.empty())
+    return;
+  vpRemapColorTask task(I, Iundist, &m_coords[0], &m_weights[0]);
+  runRemap(task, m_height, nThreads);
+}
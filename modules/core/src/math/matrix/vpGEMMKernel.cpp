@@ -0,0 +1,675 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Built-in blocked matrix product kernels.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpGEMMKernel.cpp
+  \brief Built-in cache blocked and vectorized matrix product kernels.
+*/
+
+#include <vector>
+
+#include <visp3/core/vpGEMMKernel.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+// AVX2 kernels compiled with a target attribute and selected at run time. FMA is
+// deliberately not enabled: fused multiply-adds would change the rounding of the products
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    ((defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 5)) || (defined(__clang__) && (__clang_major__ >= 4)))
+#  include <immintrin.h>
+#  define VISP_HAVE_AVX2_DISPATCH 1
+#  define VP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+  // Register block (micro kernel) and cache block sizes
+  const unsigned int MR = 4;
+  const unsigned int NR = 4;
+  const unsigned int MC = 128;
+  const unsigned int KC = 256;
+  const unsigned int NC = 1024;
+
+  // Below this number of multiply-adds packing is not worth it
+  const unsigned int SMALL_PRODUCT = 8*8*8;
+  // Maximum number of columns handled by the tall-skinny kernels
+  const unsigned int NARROW = 8;
+
+  enum vpKernelType { KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2 };
+
+  bool g_vectorization = true;
+
+  vpKernelType detectKernel()
+  {
+#if VISP_HAVE_AVX2_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      return KERNEL_AVX2;
+#endif
+#if VISP_HAVE_SSE2
+    return KERNEL_SSE2;
+#else
+    return KERNEL_SCALAR;
+#endif
+  }
+
+  vpKernelType getKernel()
+  {
+    // The detection always gives the same result, a concurrent first call is harmless
+    static int kernel = -1;
+    if (kernel < 0)
+      kernel = (int)detectKernel();
+    return g_vectorization ? (vpKernelType)kernel : KERNEL_SCALAR;
+  }
+
+  inline double opA(const bool trans, const double *A, const unsigned int lda,
+                    const unsigned int i, const unsigned int k)
+  {
+    return trans ? A[k*lda + i] : A[i*lda + k];
+  }
+
+  /*
+    Pack the mc x kc block of op(A) starting at (i0, k0) in panels of MR rows.
+    Inside a panel the MR values of a given k are contiguous. Missing rows are zero padded.
+  */
+  void packA(const bool trans, const double *A, const unsigned int lda,
+             const unsigned int i0, const unsigned int k0,
+             const unsigned int mc, const unsigned int kc, double *Ap)
+  {
+    for (unsigned int ip = 0; ip < mc; ip += MR) {
+      const unsigned int mr = (mc - ip < MR) ? mc - ip : MR;
+      for (unsigned int k = 0; k < kc; k++) {
+        for (unsigned int r = 0; r < mr; r++)
+          Ap[r] = opA(trans, A, lda, i0 + ip + r, k0 + k);
+        for (unsigned int r = mr; r < MR; r++)
+          Ap[r] = 0.0;
+        Ap += MR;
+      }
+    }
+  }
+
+  /*
+    Pack the kc x nc block of op(B) starting at (k0, j0) in panels of NR columns.
+  */
+  void packB(const bool trans, const double *B, const unsigned int ldb,
+             const unsigned int k0, const unsigned int j0,
+             const unsigned int kc, const unsigned int nc, double *Bp)
+  {
+    for (unsigned int jp = 0; jp < nc; jp += NR) {
+      const unsigned int nr = (nc - jp < NR) ? nc - jp : NR;
+      for (unsigned int k = 0; k < kc; k++) {
+        if (! trans && nr == NR) {
+          const double *b = B + (k0 + k)*ldb + j0 + jp;
+          Bp[0] = b[0]; Bp[1] = b[1]; Bp[2] = b[2]; Bp[3] = b[3];
+        }
+        else {
+          for (unsigned int c = 0; c < nr; c++)
+            Bp[c] = trans ? B[(j0 + jp + c)*ldb + k0 + k] : B[(k0 + k)*ldb + j0 + jp + c];
+          for (unsigned int c = nr; c < NR; c++)
+            Bp[c] = 0.0;
+        }
+        Bp += NR;
+      }
+    }
+  }
+
+  /*
+    Micro kernels: ab (4x4, row-major) = sum_k Ap[k] * Bp[k]^T.
+    All of them accumulate in the order of k without fused multiply-add, so that the
+    result does not depend on the instruction set and, as long as K <= KC, is the same
+    as the one of a plain triple loop.
+  */
+  void microKernelScalar(const unsigned int kc, const double *Ap, const double *Bp, double *ab)
+  {
+    double c[MR*NR];
+    for (unsigned int i = 0; i < MR*NR; i++)
+      c[i] = 0.0;
+    for (unsigned int k = 0; k < kc; k++, Ap += MR, Bp += NR) {
+      for (unsigned int r = 0; r < MR; r++) {
+        const double a = Ap[r];
+        c[r*NR + 0] += a * Bp[0];
+        c[r*NR + 1] += a * Bp[1];
+        c[r*NR + 2] += a * Bp[2];
+        c[r*NR + 3] += a * Bp[3];
+      }
+    }
+    for (unsigned int i = 0; i < MR*NR; i++)
+      ab[i] = c[i];
+  }
+
+#if VISP_HAVE_SSE2
+  void microKernelSSE2(const unsigned int kc, const double *Ap, const double *Bp, double *ab)
+  {
+    __m128d c00 = _mm_setzero_pd(), c01 = _mm_setzero_pd();
+    __m128d c10 = _mm_setzero_pd(), c11 = _mm_setzero_pd();
+    __m128d c20 = _mm_setzero_pd(), c21 = _mm_setzero_pd();
+    __m128d c30 = _mm_setzero_pd(), c31 = _mm_setzero_pd();
+    for (unsigned int k = 0; k < kc; k++, Ap += MR, Bp += NR) {
+      const __m128d b0 = _mm_loadu_pd(Bp);
+      const __m128d b1 = _mm_loadu_pd(Bp + 2);
+      __m128d a = _mm_set1_pd(Ap[0]);
+      c00 = _mm_add_pd(c00, _mm_mul_pd(a, b0));
+      c01 = _mm_add_pd(c01, _mm_mul_pd(a, b1));
+      a = _mm_set1_pd(Ap[1]);
+      c10 = _mm_add_pd(c10, _mm_mul_pd(a, b0));
+      c11 = _mm_add_pd(c11, _mm_mul_pd(a, b1));
+      a = _mm_set1_pd(Ap[2]);
+      c20 = _mm_add_pd(c20, _mm_mul_pd(a, b0));
+      c21 = _mm_add_pd(c21, _mm_mul_pd(a, b1));
+      a = _mm_set1_pd(Ap[3]);
+      c30 = _mm_add_pd(c30, _mm_mul_pd(a, b0));
+      c31 = _mm_add_pd(c31, _mm_mul_pd(a, b1));
+    }
+    _mm_storeu_pd(ab,      c00); _mm_storeu_pd(ab + 2,  c01);
+    _mm_storeu_pd(ab + 4,  c10); _mm_storeu_pd(ab + 6,  c11);
+    _mm_storeu_pd(ab + 8,  c20); _mm_storeu_pd(ab + 10, c21);
+    _mm_storeu_pd(ab + 12, c30); _mm_storeu_pd(ab + 14, c31);
+  }
+#endif
+
+#if VISP_HAVE_AVX2_DISPATCH
+  VP_TARGET_AVX2
+  void microKernelAVX2(const unsigned int kc, const double *Ap, const double *Bp, double *ab)
+  {
+    __m256d c0 = _mm256_setzero_pd(), c1 = _mm256_setzero_pd();
+    __m256d c2 = _mm256_setzero_pd(), c3 = _mm256_setzero_pd();
+    for (unsigned int k = 0; k < kc; k++, Ap += MR, Bp += NR) {
+      const __m256d b = _mm256_loadu_pd(Bp);
+      c0 = _mm256_add_pd(c0, _mm256_mul_pd(_mm256_broadcast_sd(Ap),     b));
+      c1 = _mm256_add_pd(c1, _mm256_mul_pd(_mm256_broadcast_sd(Ap + 1), b));
+      c2 = _mm256_add_pd(c2, _mm256_mul_pd(_mm256_broadcast_sd(Ap + 2), b));
+      c3 = _mm256_add_pd(c3, _mm256_mul_pd(_mm256_broadcast_sd(Ap + 3), b));
+    }
+    _mm256_storeu_pd(ab,      c0);
+    _mm256_storeu_pd(ab + 4,  c1);
+    _mm256_storeu_pd(ab + 8,  c2);
+    _mm256_storeu_pd(ab + 12, c3);
+  }
+#endif
+
+  typedef void (*vpMicroKernel)(const unsigned int, const double *, const double *, double *);
+
+  vpMicroKernel getMicroKernel()
+  {
+    switch (getKernel()) {
+#if VISP_HAVE_AVX2_DISPATCH
+    case KERNEL_AVX2:
+      return microKernelAVX2;
+#endif
+#if VISP_HAVE_SSE2
+    case KERNEL_SSE2:
+      return microKernelSSE2;
+#endif
+    default:
+      return microKernelScalar;
+    }
+  }
+
+  /*
+    Straightforward product for small operands, where packing costs more than it saves.
+    Only the upper triangle (j >= i) is updated when upper is true.
+  */
+  template <bool transA, bool transB>
+  void gemmSmall(const unsigned int M, const unsigned int N, const unsigned int K,
+                 const double alpha, const double *A, const unsigned int lda,
+                 const double *B, const unsigned int ldb,
+                 double *C, const unsigned int ldc, const bool upper)
+  {
+    for (unsigned int i = 0; i < M; i++) {
+      double *ci = C + i*ldc;
+      unsigned int j = upper ? i : 0;
+      // Four columns at a time for independent accumulations
+      for (; j + 4 <= N; j += 4) {
+        double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+        for (unsigned int k = 0; k < K; k++) {
+          const double a = transA ? A[k*lda + i] : A[i*lda + k];
+          if (transB) {
+            s0 += a * B[j*ldb + k];
+            s1 += a * B[(j+1)*ldb + k];
+            s2 += a * B[(j+2)*ldb + k];
+            s3 += a * B[(j+3)*ldb + k];
+          }
+          else {
+            const double *bk = B + k*ldb + j;
+            s0 += a * bk[0];
+            s1 += a * bk[1];
+            s2 += a * bk[2];
+            s3 += a * bk[3];
+          }
+        }
+        ci[j]   += alpha * s0;
+        ci[j+1] += alpha * s1;
+        ci[j+2] += alpha * s2;
+        ci[j+3] += alpha * s3;
+      }
+      for (; j < N; j++) {
+        double s = 0.0;
+        for (unsigned int k = 0; k < K; k++)
+          s += (transA ? A[k*lda + i] : A[i*lda + k]) * (transB ? B[j*ldb + k] : B[k*ldb + j]);
+        ci[j] += alpha * s;
+      }
+    }
+  }
+
+  void gemmSmall(const bool transA, const bool transB,
+                 const unsigned int M, const unsigned int N, const unsigned int K,
+                 const double alpha, const double *A, const unsigned int lda,
+                 const double *B, const unsigned int ldb,
+                 double *C, const unsigned int ldc, const bool upper)
+  {
+    if (transA) {
+      if (transB)
+        gemmSmall<true, true>(M, N, K, alpha, A, lda, B, ldb, C, ldc, upper);
+      else
+        gemmSmall<true, false>(M, N, K, alpha, A, lda, B, ldb, C, ldc, upper);
+    }
+    else {
+      if (transB)
+        gemmSmall<false, true>(M, N, K, alpha, A, lda, B, ldb, C, ldc, upper);
+      else
+        gemmSmall<false, false>(M, N, K, alpha, A, lda, B, ldb, C, ldc, upper);
+    }
+  }
+
+  /*
+    C += alpha A^T A when A has only N <= NARROW columns, like the interaction matrices:
+    the rows are streamed once and their outer products accumulated in registers.
+  */
+  template <unsigned int N>
+  void syrkNarrow(const unsigned int K, const double alpha, const double *A, const unsigned int lda,
+                  double *C, const unsigned int ldc)
+  {
+    double acc[N][N];
+    for (unsigned int i = 0; i < N; i++)
+      for (unsigned int j = 0; j < N; j++)
+        acc[i][j] = 0.0;
+    for (unsigned int k = 0; k < K; k++) {
+      const double *a = A + k*lda;
+      for (unsigned int i = 0; i < N; i++) {
+        const double ai = a[i];
+        for (unsigned int j = i; j < N; j++)
+          acc[i][j] += ai * a[j];
+      }
+    }
+    for (unsigned int i = 0; i < N; i++) {
+      for (unsigned int j = i; j < N; j++)
+        C[i*ldc + j] += alpha * acc[i][j];
+    }
+  }
+
+  void syrkNarrow(const unsigned int N, const unsigned int K,
+                  const double alpha, const double *A, const unsigned int lda,
+                  double *C, const unsigned int ldc)
+  {
+    switch (N) {
+    case 1: syrkNarrow<1>(K, alpha, A, lda, C, ldc); break;
+    case 2: syrkNarrow<2>(K, alpha, A, lda, C, ldc); break;
+    case 3: syrkNarrow<3>(K, alpha, A, lda, C, ldc); break;
+    case 4: syrkNarrow<4>(K, alpha, A, lda, C, ldc); break;
+    case 5: syrkNarrow<5>(K, alpha, A, lda, C, ldc); break;
+    case 6: syrkNarrow<6>(K, alpha, A, lda, C, ldc); break;
+    case 7: syrkNarrow<7>(K, alpha, A, lda, C, ldc); break;
+    case 8: syrkNarrow<8>(K, alpha, A, lda, C, ldc); break;
+    default: break;
+    }
+  }
+
+  /*
+    Blocked product C += alpha op(A) op(B). When upper is true, the register tiles
+    that lie entirely under the diagonal of C are skipped.
+  */
+  void gemmBlocked(const bool transA, const bool transB,
+                   const unsigned int M, const unsigned int N, const unsigned int K,
+                   const double alpha, const double *A, const unsigned int lda,
+                   const double *B, const unsigned int ldb,
+                   double *C, const unsigned int ldc, const bool upper)
+  {
+    if (M == 0 || N == 0 || K == 0)
+      return;
+
+    if ((double)M * N * K <= SMALL_PRODUCT) {
+      gemmSmall(transA, transB, M, N, K, alpha, A, lda, B, ldb, C, ldc, upper);
+      return;
+    }
+
+    const vpMicroKernel kernel = getMicroKernel();
+    const unsigned int mcMax = (M < MC) ? ((M + MR - 1) / MR) * MR : MC;
+    const unsigned int ncMax = (N < NC) ? ((N + NR - 1) / NR) * NR : NC;
+    const unsigned int kcMax = (K < KC) ? K : KC;
+    std::vector<double> Apack(mcMax * kcMax);
+    std::vector<double> Bpack(ncMax * kcMax);
+    double ab[MR*NR];
+
+    for (unsigned int jc = 0; jc < N; jc += NC) {
+      const unsigned int nc = (N - jc < NC) ? N - jc : NC;
+      for (unsigned int pc = 0; pc < K; pc += KC) {
+        const unsigned int kc = (K - pc < KC) ? K - pc : KC;
+        packB(transB, B, ldb, pc, jc, kc, nc, &Bpack[0]);
+        for (unsigned int ic = 0; ic < M; ic += MC) {
+          const unsigned int mc = (M - ic < MC) ? M - ic : MC;
+          if (upper && ic >= jc + nc)
+            continue;
+          packA(transA, A, lda, ic, pc, mc, kc, &Apack[0]);
+          for (unsigned int jr = 0; jr < nc; jr += NR) {
+            const unsigned int nr = (nc - jr < NR) ? nc - jr : NR;
+            const double *Bp = &Bpack[0] + jr*kc;
+            for (unsigned int ir = 0; ir < mc; ir += MR) {
+              if (upper && ic + ir >= jc + jr + nr)
+                break;
+              const unsigned int mr = (mc - ir < MR) ? mc - ir : MR;
+              kernel(kc, &Apack[0] + ir*kc, Bp, ab);
+              double *c = C + (ic + ir)*ldc + jc + jr;
+              for (unsigned int r = 0; r < mr; r++, c += ldc) {
+                for (unsigned int s = 0; s < nr; s++)
+                  c[s] += alpha * ab[r*NR + s];
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /*
+    Matrix by vector kernels: y[i] += alpha * sum_k A[i][k] x[k] for the rows [0, M).
+    The SIMD versions put one row per lane and add the products in the order of k, so
+    that the results are the same as the ones of the scalar version. Eight rows are
+    processed at a time to have several independent chains of additions.
+  */
+  void gemvRowsScalar(const unsigned int M, const unsigned int N, const double alpha, const double *A,
+                      const unsigned int lda, const double *x, double *y)
+  {
+    // Four rows at a time: the dot products are independent, each one is summed in order
+    unsigned int i = 0;
+    for (; i + 4 <= M; i += 4) {
+      const double *a0 = A + i*lda, *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;
+      double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+      for (unsigned int k = 0; k < N; k++) {
+        const double xk = x[k];
+        s0 += a0[k] * xk;
+        s1 += a1[k] * xk;
+        s2 += a2[k] * xk;
+        s3 += a3[k] * xk;
+      }
+      y[i]   += alpha * s0;
+      y[i+1] += alpha * s1;
+      y[i+2] += alpha * s2;
+      y[i+3] += alpha * s3;
+    }
+    for (; i < M; i++) {
+      const double *a = A + i*lda;
+      double s = 0.0;
+      for (unsigned int k = 0; k < N; k++)
+        s += a[k] * x[k];
+      y[i] += alpha * s;
+    }
+  }
+
+  void axpyScalar(const unsigned int n, const double alpha, const double *x, double *y)
+  {
+    for (unsigned int k = 0; k < n; k++)
+      y[k] += alpha * x[k];
+  }
+
+#if VISP_HAVE_SSE2
+  void gemvRowsSSE2(const unsigned int M, const unsigned int N, const double alpha, const double *A,
+                    const unsigned int lda, const double *x, double *y)
+  {
+    unsigned int i = 0;
+    for (; i + 8 <= M; i += 8) {
+      const double *a[8];
+      for (unsigned int r = 0; r < 8; r++)
+        a[r] = A + (i + r)*lda;
+      // s[r/2] holds the sums of the rows r and r+1
+      __m128d s[4] = { _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd() };
+      unsigned int k = 0;
+      for (; k + 2 <= N; k += 2) {
+        const __m128d x0 = _mm_set1_pd(x[k]), x1 = _mm_set1_pd(x[k+1]);
+        for (unsigned int r = 0; r < 4; r++) {
+          const __m128d u = _mm_loadu_pd(a[2*r] + k), v = _mm_loadu_pd(a[2*r+1] + k);
+          s[r] = _mm_add_pd(s[r], _mm_mul_pd(_mm_unpacklo_pd(u, v), x0));
+          s[r] = _mm_add_pd(s[r], _mm_mul_pd(_mm_unpackhi_pd(u, v), x1));
+        }
+      }
+      if (k < N) {
+        const __m128d x0 = _mm_set1_pd(x[k]);
+        for (unsigned int r = 0; r < 4; r++)
+          s[r] = _mm_add_pd(s[r], _mm_mul_pd(_mm_set_pd(a[2*r+1][k], a[2*r][k]), x0));
+      }
+      const __m128d va = _mm_set1_pd(alpha);
+      for (unsigned int r = 0; r < 4; r++)
+        _mm_storeu_pd(y + i + 2*r, _mm_add_pd(_mm_loadu_pd(y + i + 2*r), _mm_mul_pd(va, s[r])));
+    }
+    if (i < M)
+      gemvRowsScalar(M - i, N, alpha, A + i*lda, lda, x, y + i);
+  }
+
+  void axpySSE2(const unsigned int n, const double alpha, const double *x, double *y)
+  {
+    const __m128d va = _mm_set1_pd(alpha);
+    unsigned int k = 0;
+    for (; k + 2 <= n; k += 2)
+      _mm_storeu_pd(y + k, _mm_add_pd(_mm_loadu_pd(y + k), _mm_mul_pd(va, _mm_loadu_pd(x + k))));
+    for (; k < n; k++)
+      y[k] += alpha * x[k];
+  }
+#endif
+
+#if VISP_HAVE_AVX2_DISPATCH
+  //! Add the products of 4 consecutive columns of 4 rows to the row sums s, in the order of the columns.
+  VP_TARGET_AVX2
+  inline __m256d gemv4x4AVX2(const double *a0, const double *a1, const double *a2, const double *a3,
+                             const double *x, __m256d s)
+  {
+    // Transpose the 4x4 block so that each vector holds one column
+    const __m256d r0 = _mm256_loadu_pd(a0), r1 = _mm256_loadu_pd(a1);
+    const __m256d r2 = _mm256_loadu_pd(a2), r3 = _mm256_loadu_pd(a3);
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+    s = _mm256_add_pd(s, _mm256_mul_pd(_mm256_permute2f128_pd(t0, t2, 0x20), _mm256_broadcast_sd(x)));
+    s = _mm256_add_pd(s, _mm256_mul_pd(_mm256_permute2f128_pd(t1, t3, 0x20), _mm256_broadcast_sd(x + 1)));
+    s = _mm256_add_pd(s, _mm256_mul_pd(_mm256_permute2f128_pd(t0, t2, 0x31), _mm256_broadcast_sd(x + 2)));
+    s = _mm256_add_pd(s, _mm256_mul_pd(_mm256_permute2f128_pd(t1, t3, 0x31), _mm256_broadcast_sd(x + 3)));
+    return s;
+  }
+
+  VP_TARGET_AVX2
+  void gemvRowsAVX2(const unsigned int M, const unsigned int N, const double alpha, const double *A,
+                    const unsigned int lda, const double *x, double *y)
+  {
+    unsigned int i = 0;
+    for (; i + 8 <= M; i += 8) {
+      const double *a0 = A + i*lda, *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;
+      const double *a4 = a3 + lda, *a5 = a4 + lda, *a6 = a5 + lda, *a7 = a6 + lda;
+      // s0 holds the sums of the rows 0 to 3, s1 the ones of the rows 4 to 7
+      __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+      unsigned int k = 0;
+      for (; k + 4 <= N; k += 4) {
+        s0 = gemv4x4AVX2(a0 + k, a1 + k, a2 + k, a3 + k, x + k, s0);
+        s1 = gemv4x4AVX2(a4 + k, a5 + k, a6 + k, a7 + k, x + k, s1);
+      }
+      for (; k < N; k++) {
+        const __m256d xk = _mm256_broadcast_sd(x + k);
+        s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_set_pd(a3[k], a2[k], a1[k], a0[k]), xk));
+        s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_set_pd(a7[k], a6[k], a5[k], a4[k]), xk));
+      }
+      const __m256d va = _mm256_set1_pd(alpha);
+      _mm256_storeu_pd(y + i,     _mm256_add_pd(_mm256_loadu_pd(y + i),     _mm256_mul_pd(va, s0)));
+      _mm256_storeu_pd(y + i + 4, _mm256_add_pd(_mm256_loadu_pd(y + i + 4), _mm256_mul_pd(va, s1)));
+    }
+    if (i < M)
+      gemvRowsScalar(M - i, N, alpha, A + i*lda, lda, x, y + i);
+  }
+
+  VP_TARGET_AVX2
+  void axpyAVX2(const unsigned int n, const double alpha, const double *x, double *y)
+  {
+    const __m256d va = _mm256_set1_pd(alpha);
+    unsigned int k = 0;
+    for (; k + 4 <= n; k += 4)
+      _mm256_storeu_pd(y + k, _mm256_add_pd(_mm256_loadu_pd(y + k), _mm256_mul_pd(va, _mm256_loadu_pd(x + k))));
+    for (; k < n; k++)
+      y[k] += alpha * x[k];
+  }
+#endif
+
+  typedef void (*vpGemvKernel)(const unsigned int, const unsigned int, const double, const double *,
+                               const unsigned int, const double *, double *);
+  typedef void (*vpAxpyKernel)(const unsigned int, const double, const double *, double *);
+}
+
+/*!
+  Compute \f$ {\bf C} = {\bf C} + \alpha \; op({\bf A}) \; op({\bf B}) \f$ where
+  \f$ op({\bf X}) \f$ is \f$ {\bf X} \f$ or \f$ {\bf X}^T \f$.
+
+  \param transA, transB : Use the transpose of the corresponding array.
+  \param M, N, K : \f$ op({\bf A}) \f$ is M-by-K, \f$ op({\bf B}) \f$ is K-by-N and \f$ {\bf C} \f$ is M-by-N.
+  \param alpha : Scale factor.
+  \param A, lda : First operand and its row stride.
+  \param B, ldb : Second operand and its row stride.
+  \param C, ldc : Result, updated in place, and its row stride. It must not overlap \e A or \e B.
+*/
+void vpGEMMKernel::gemm(const bool transA, const bool transB,
+                        const unsigned int M, const unsigned int N, const unsigned int K,
+                        const double alpha, const double *A, const unsigned int lda,
+                        const double *B, const unsigned int ldb,
+                        double *C, const unsigned int ldc)
+{
+  if (N == 1 && ldc == 1 && (transB || ldb == 1)) {
+    // Matrix by vector product
+    if (transA)
+      gemv(true, K, M, alpha, A, lda, B, C);
+    else
+      gemv(false, M, K, alpha, A, lda, B, C);
+    return;
+  }
+  gemmBlocked(transA, transB, M, N, K, alpha, A, lda, B, ldb, C, ldc, false);
+}
+
+/*!
+  Compute \f$ {\bf y} = {\bf y} + \alpha \; op({\bf A}) \; {\bf x} \f$.
+
+  \param transA : Use the transpose of \e A.
+  \param M, N : Size of the array \e A (not of \f$ op({\bf A}) \f$).
+  \param alpha : Scale factor.
+  \param A, lda : M-by-N array and its row stride.
+  \param x : Vector of size N, or M if \e transA is true.
+  \param y : Vector of size M, or N if \e transA is true.
+*/
+void vpGEMMKernel::gemv(const bool transA, const unsigned int M, const unsigned int N,
+                        const double alpha, const double *A, const unsigned int lda,
+                        const double *x, double *y)
+{
+  vpGemvKernel gemvRows = gemvRowsScalar;
+  vpAxpyKernel axpy = axpyScalar;
+  switch (getKernel()) {
+#if VISP_HAVE_AVX2_DISPATCH
+  case KERNEL_AVX2:
+    gemvRows = gemvRowsAVX2;
+    axpy = axpyAVX2;
+    break;
+#endif
+#if VISP_HAVE_SSE2
+  case KERNEL_SSE2:
+    gemvRows = gemvRowsSSE2;
+    axpy = axpySSE2;
+    break;
+#endif
+  default:
+    break;
+  }
+
+  if (! transA) {
+    gemvRows(M, N, alpha, A, lda, x, y);
+  }
+  else {
+    // Row by row to keep a contiguous access to A
+    for (unsigned int i = 0; i < M; i++) {
+      if (x[i] != 0.0)
+        axpy(N, alpha * x[i], A + i*lda, y);
+    }
+  }
+}
+
+/*!
+  Compute the symmetric product \f$ {\bf C} = {\bf C} + \alpha \; op({\bf A}) \; op({\bf A})^T \f$.
+  Only the upper part is computed, then copied in the lower part so that
+  \e C has to be symmetric on input (typically zero).
+
+  \param transA : If true compute \f$ {\bf A}^T {\bf A} \f$ instead of \f$ {\bf A} {\bf A}^T \f$.
+  \param N, K : \f$ op({\bf A}) \f$ is N-by-K and \f$ {\bf C} \f$ is N-by-N.
+  \param alpha : Scale factor.
+  \param A, lda : Operand and its row stride.
+  \param C, ldc : Result, updated in place, and its row stride.
+*/
+void vpGEMMKernel::syrk(const bool transA, const unsigned int N, const unsigned int K,
+                        const double alpha, const double *A, const unsigned int lda,
+                        double *C, const unsigned int ldc)
+{
+  if (transA && N <= NARROW)
+    syrkNarrow(N, K, alpha, A, lda, C, ldc);
+  else
+    gemmBlocked(transA, ! transA, N, N, K, alpha, A, lda, A, lda, C, ldc, true);
+  for (unsigned int i = 1; i < N; i++) {
+    for (unsigned int j = 0; j < i; j++)
+      C[i*ldc + j] = C[j*ldc + i];
+  }
+}
+
+/*!
+  Return the name of the instruction set used by the kernels: "AVX2", "SSE2" or "none".
+*/
+const char *vpGEMMKernel::getInstructionSet()
+{
+  switch (getKernel()) {
+  case KERNEL_AVX2:
+    return "AVX2";
+  case KERNEL_SSE2:
+    return "SSE2";
+  default:
+    return "none";
+  }
+}
+
+/*!
+  Enable or disable the SIMD kernels (enabled by default). When disabled,
+  the products remain blocked but use plain C++ micro kernels. This is
+  mainly intended to benchmark the vectorized code.
+*/
+void vpGEMMKernel::setVectorization(const bool enable)
+{
+  g_vectorization = enable;
+}
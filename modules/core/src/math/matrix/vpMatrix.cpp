@@ -61,6 +61,7 @@
 #endif
 
 #include <visp3/core/vpMatrix.h>
+#include <visp3/core/vpGEMMKernel.h>
 #include <visp3/core/vpMath.h>
 #include <visp3/core/vpTranslationVector.h>
 #include <visp3/core/vpColVector.h>
@@ -300,21 +301,8 @@ void vpMatrix::AAt(vpMatrix &B) const
   }
 
   // compute A*A^T
-  for(unsigned int i=0;i<rowNum;i++){
-    for(unsigned int j=i;j<rowNum;j++){
-      double *pi = rowPtrs[i];// row i
-      double *pj = rowPtrs[j];// row j
-
-      // sum (row i .* row j)
-      double ssum=0;
-      for(unsigned int k=0; k < colNum ;k++)
-        ssum += *(pi++)* *(pj++);
-
-      B[i][j]=ssum; //upper triangle
-      if(i!=j)
-        B[j][i]=ssum; //lower triangle
-    }
-  }
+  B = 0.0;
+  vpGEMMKernel::syrk(false, rowNum, colNum, 1.0, data, colNum, B.data, rowNum);
 }
 
 /*!
@@ -338,33 +326,9 @@ void vpMatrix::AtA(vpMatrix &B) const
     throw ;
   }
 
-  unsigned int i,j,k;
-  double s;
-  double *ptr;
-  for (i=0;i<colNum;i++)
-  {
-    double *Bi = B[i] ;
-    for (j=0;j<i;j++)
-    {
-      ptr=data;
-      s = 0 ;
-      for (k=0;k<rowNum;k++)
-      {
-        s +=(*(ptr+i)) * (*(ptr+j));
-        ptr+=colNum;
-      }
-      *Bi++ = s ;
-      B[j][i] = s;
-    }
-    ptr=data;
-    s = 0 ;
-    for (k=0;k<rowNum;k++)
-    {
-      s +=(*(ptr+i)) * (*(ptr+i));
-      ptr+=colNum;
-    }
-    *Bi = s;
-  }
+  // compute A^T*A
+  B = 0.0;
+  vpGEMMKernel::syrk(true, colNum, rowNum, 1.0, data, colNum, B.data, colNum);
 }
 
 
@@ -619,12 +583,7 @@ void vpMatrix::multMatrixVector(const vpMatrix &A, const vpColVector &v, vpColVe
   }
 
   w = 0.0;
-  for (unsigned int j=0;j<A.colNum;j++) {
-    double vj = v[j] ; // optimization em 5/12/2006
-    for (unsigned int i=0;i<A.rowNum;i++) {
-      w[i]+=A.rowPtrs[i][j] * vj;
-    }
-  }
+  vpGEMMKernel::gemv(false, A.rowNum, A.colNum, 1.0, A.data, A.colNum, v.data, w.data);
 }
 
 //---------------------------------
@@ -655,22 +614,9 @@ void vpMatrix::mult2Matrices(const vpMatrix &A, const vpMatrix &B, vpMatrix &C)
                       A.getRows(), A.getCols(), B.getRows(), B.getCols())) ;
   }
 
-  // 5/12/06 some "very" simple optimization to avoid indexation
-  unsigned int BcolNum = B.colNum;
-  unsigned int BrowNum = B.rowNum;
-  unsigned int i,j,k;
-  double **BrowPtrs = B.rowPtrs;
-  for (i=0;i<A.rowNum;i++)
-  {
-    double *rowptri = A.rowPtrs[i];
-    double *ci = C[i];
-    for (j=0;j<BcolNum;j++)
-    {
-      double s = 0;
-      for (k=0;k<BrowNum;k++) s += rowptri[k] * BrowPtrs[k][j];
-      ci[j] = s;
-    }
-  }
+  C = 0.0;
+  vpGEMMKernel::gemm(false, false, A.rowNum, B.colNum, A.colNum, 1.0, A.data, A.colNum,
+                     B.data, B.colNum, C.data, C.colNum);
 }
 
 /*!
@@ -0,0 +1,346 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Weighted linear least squares solved through the normal equations.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpWeightedLeastSquares.cpp
+  \brief Weighted linear least squares solved through the normal equations.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpWeightedLeastSquares.h>
+
+namespace {
+  /*
+    Accumulate the rows of the N columns matrix J with the weights w (or 1 if w is NULL).
+    N is a template parameter so that the accumulators stay in registers.
+  */
+  template <unsigned int N>
+  void accumulateRows(const unsigned int nbRows, const double *J, const double *e, const double *w,
+                      double *JtWJ, double *JtWe, double &sumWe2)
+  {
+    double A[N][N], b[N];
+    for (unsigned int i = 0; i < N; i++) {
+      b[i] = 0.0;
+      for (unsigned int j = 0; j < N; j++)
+        A[i][j] = 0.0;
+    }
+    double s = 0.0;
+    for (unsigned int r = 0; r < nbRows; r++, J += N) {
+      const double wr = (w != NULL) ? w[r] : 1.0;
+      const double we = wr * e[r];
+      s += we * e[r];
+      for (unsigned int i = 0; i < N; i++) {
+        const double wJi = wr * J[i];
+        b[i] += J[i] * we;
+        for (unsigned int j = i; j < N; j++)
+          A[i][j] += wJi * J[j];
+      }
+    }
+    for (unsigned int i = 0; i < N; i++) {
+      JtWe[i] += b[i];
+      for (unsigned int j = i; j < N; j++)
+        JtWJ[i*N + j] += A[i][j];
+    }
+    sumWe2 += s;
+  }
+}
+
+/*!
+  Create an empty system with \e nbUnknowns unknowns.
+*/
+vpWeightedLeastSquares::vpWeightedLeastSquares(const unsigned int nbUnknowns)
+  : m_n(0), m_JtWJ(), m_JtWe(), m_sumWe2(0.0), m_nbRows(0)
+{
+  init(nbUnknowns);
+}
+
+/*!
+  Set the number of unknowns and clear the system.
+*/
+void vpWeightedLeastSquares::init(const unsigned int nbUnknowns)
+{
+  m_n = nbUnknowns;
+  m_JtWJ.resize(m_n*m_n);
+  m_JtWe.resize(m_n);
+  reset();
+}
+
+/*!
+  Clear the system, keeping the number of unknowns.
+*/
+void vpWeightedLeastSquares::reset()
+{
+  std::fill(m_JtWJ.begin(), m_JtWJ.end(), 0.0);
+  std::fill(m_JtWe.begin(), m_JtWe.end(), 0.0);
+  m_sumWe2 = 0.0;
+  m_nbRows = 0;
+}
+
+/*!
+  Add the equation \f$ {\bf J} {\bf x} = e \f$ with the weight \e w.
+
+  \param J : Array of getNbUnknowns() values.
+  \param e : Right hand side.
+  \param w : Weight of the equation.
+*/
+void vpWeightedLeastSquares::addRow(const double *J, const double e, const double w)
+{
+  const double we = w * e;
+  for (unsigned int i = 0; i < m_n; i++) {
+    const double wJi = w * J[i];
+    double *A = &m_JtWJ[i*m_n];
+    for (unsigned int j = i; j < m_n; j++)
+      A[j] += wJi * J[j];
+    m_JtWe[i] += J[i] * we;
+  }
+  m_sumWe2 += we * e;
+  m_nbRows++;
+}
+
+/*!
+  Add the equations \f$ {\bf J} {\bf x} = {\bf e} \f$ with unit weights.
+
+  \exception vpException::dimensionError : If the sizes of \e J and \e e do not match.
+*/
+void vpWeightedLeastSquares::addRows(const vpMatrix &J, const vpColVector &e)
+{
+  if (J.getCols() != m_n || J.getRows() != e.getRows()) {
+    throw(vpException(vpException::dimensionError,
+                      "Cannot add a (%dx%d) matrix and a (%d) vector to a %d unknowns least squares system",
+                      J.getRows(), J.getCols(), e.getRows(), m_n));
+  }
+
+  if (m_n == 6)
+    accumulateRows<6>(J.getRows(), J.data, e.data, NULL, &m_JtWJ[0], &m_JtWe[0], m_sumWe2);
+  else {
+    for (unsigned int r = 0; r < J.getRows(); r++)
+      addRow(J[r], e[r]);
+    return;
+  }
+  m_nbRows += J.getRows();
+}
+
+/*!
+  Add the equations \f$ {\bf J} {\bf x} = {\bf e} \f$ with the weights \e w.
+
+  \exception vpException::dimensionError : If the sizes of \e J, \e e and \e w do not match.
+*/
+void vpWeightedLeastSquares::addRows(const vpMatrix &J, const vpColVector &e, const vpColVector &w)
+{
+  if (J.getCols() != m_n || J.getRows() != e.getRows() || J.getRows() != w.getRows()) {
+    throw(vpException(vpException::dimensionError,
+                      "Cannot add a (%dx%d) matrix, a (%d) vector and (%d) weights to a %d unknowns least squares system",
+                      J.getRows(), J.getCols(), e.getRows(), w.getRows(), m_n));
+  }
+
+  if (m_n == 6)
+    accumulateRows<6>(J.getRows(), J.data, e.data, w.data, &m_JtWJ[0], &m_JtWe[0], m_sumWe2);
+  else {
+    for (unsigned int r = 0; r < J.getRows(); r++)
+      addRow(J[r], e[r], w[r]);
+    return;
+  }
+  m_nbRows += J.getRows();
+}
+
+/*!
+  Replace the unknowns \f$ {\bf x} \f$ by \f$ {\bf T} {\bf y} \f$, so that the
+  system becomes the one of the rows \f$ {\bf J} {\bf T} \f$: the normal equations
+  are transformed in \f$ {\bf T}^T {\bf J}^T {\bf W} {\bf J} {\bf T} \f$ and
+  \f$ {\bf T}^T {\bf J}^T {\bf W} {\bf e} \f$ without building \f$ {\bf J} {\bf T} \f$.
+  solve() then gives \f$ {\bf y} \f$.
+
+  This is typically used with \f$ {\bf T} = {^c}{\bf V}_o \; {^o}{\bf J}_o \f$ to
+  estimate only some of the degrees of freedom of a pose.
+
+  \param T : Matrix with getNbUnknowns() rows. Its number of columns becomes the
+  number of unknowns.
+
+  \exception vpException::dimensionError : If the number of rows of \e T is not getNbUnknowns().
+*/
+void vpWeightedLeastSquares::changeVariables(const vpMatrix &T)
+{
+  if (T.getRows() != m_n) {
+    throw(vpException(vpException::dimensionError,
+                      "Cannot change the variables of a %d unknowns least squares system with a (%dx%d) matrix",
+                      m_n, T.getRows(), T.getCols()));
+  }
+
+  const vpMatrix TtJtWJT = T.t() * getJtWJ() * T;
+  const vpColVector TtJtWe = T.t() * getJtWe();
+  m_n = T.getCols();
+  m_JtWJ.resize(m_n*m_n);
+  m_JtWe.resize(m_n);
+  for (unsigned int i = 0; i < m_n; i++) {
+    for (unsigned int j = 0; j < m_n; j++)
+      m_JtWJ[i*m_n + j] = j >= i ? TtJtWJT[i][j] : 0.0;
+    m_JtWe[i] = TtJtWe[i];
+  }
+}
+
+/*!
+  Return the symmetric matrix \f$ {\bf J}^T {\bf W} {\bf J} \f$.
+*/
+vpMatrix vpWeightedLeastSquares::getJtWJ() const
+{
+  vpMatrix A(m_n, m_n);
+  for (unsigned int i = 0; i < m_n; i++) {
+    for (unsigned int j = i; j < m_n; j++)
+      A[i][j] = A[j][i] = m_JtWJ[i*m_n + j];
+  }
+  return A;
+}
+
+/*!
+  Return the vector \f$ {\bf J}^T {\bf W} {\bf e} \f$.
+*/
+vpColVector vpWeightedLeastSquares::getJtWe() const
+{
+  vpColVector b(m_n);
+  for (unsigned int i = 0; i < m_n; i++)
+    b[i] = m_JtWe[i];
+  return b;
+}
+
+/*!
+  Solve \f$ ({\bf J}^T {\bf W} {\bf J} + \mu {\bf I}) \; {\bf x} = {\bf J}^T {\bf W} {\bf e} \f$.
+
+  The system is solved by a LDL^T decomposition with diagonal pivoting. If the
+  ratio between the smallest and the largest pivots is below the square root of
+  the machine epsilon, the system is considered as badly conditioned and the
+  solution is computed with the SVD pseudo-inverse of the left hand side.
+
+  \param x : Solution.
+  \param mu : Damping factor, typically the Levenberg-Marquardt one.
+  \param svThreshold : Threshold on the singular values of the left hand side
+  used by the SVD fallback, see vpMatrix::pseudoInverse().
+
+  \return The rank of the left hand side.
+*/
+unsigned int vpWeightedLeastSquares::solve(vpColVector &x, const double mu, const double svThreshold) const
+{
+  const unsigned int n = m_n;
+  x.resize(n);
+  if (n == 0)
+    return 0;
+
+  // Full symmetric copy of the left hand side
+  std::vector<double> a(n*n);
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int j = i; j < n; j++)
+      a[i*n + j] = a[j*n + i] = m_JtWJ[i*n + j];
+    a[i*n + i] += mu;
+  }
+
+  std::vector<unsigned int> perm(n);
+  for (unsigned int i = 0; i < n; i++)
+    perm[i] = i;
+
+  const double minPivotRatio = std::sqrt(std::numeric_limits<double>::epsilon());
+  double maxPivot = 0.0;
+  bool wellConditioned = true;
+  std::vector<double> col(n);
+
+  for (unsigned int k = 0; k < n && wellConditioned; k++) {
+    // Diagonal pivoting: bring the largest remaining diagonal element in position k
+    unsigned int p = k;
+    for (unsigned int i = k + 1; i < n; i++) {
+      if (a[i*n + i] > a[p*n + p])
+        p = i;
+    }
+    if (p != k) {
+      for (unsigned int j = 0; j < n; j++)
+        std::swap(a[k*n + j], a[p*n + j]);
+      for (unsigned int i = 0; i < n; i++)
+        std::swap(a[i*n + k], a[i*n + p]);
+      std::swap(perm[k], perm[p]);
+    }
+
+    const double d = a[k*n + k];
+    if (k == 0)
+      maxPivot = d;
+    if (! (d > maxPivot * minPivotRatio) || maxPivot <= 0.0) {
+      wellConditioned = false;
+      break;
+    }
+
+    // Column of L and update of the trailing symmetric block
+    for (unsigned int i = k + 1; i < n; i++) {
+      col[i] = a[i*n + k];
+      a[i*n + k] = col[i] / d;
+    }
+    for (unsigned int i = k + 1; i < n; i++) {
+      const double lik = a[i*n + k];
+      for (unsigned int j = k + 1; j <= i; j++) {
+        a[i*n + j] -= lik * col[j];
+        a[j*n + i] = a[i*n + j];
+      }
+    }
+  }
+
+  if (! wellConditioned) {
+    vpMatrix A = getJtWJ();
+    for (unsigned int i = 0; i < n; i++)
+      A[i][i] += mu;
+    vpMatrix Ap;
+    unsigned int rank = A.pseudoInverse(Ap, svThreshold);
+    x = Ap * getJtWe();
+    return rank;
+  }
+
+  // Forward substitution L z = P b, then D and back substitution L^T y = z
+  std::vector<double> z(n);
+  for (unsigned int i = 0; i < n; i++) {
+    double s = m_JtWe[perm[i]];
+    for (unsigned int j = 0; j < i; j++)
+      s -= a[i*n + j] * z[j];
+    z[i] = s;
+  }
+  for (unsigned int i = 0; i < n; i++)
+    z[i] /= a[i*n + i];
+  for (unsigned int i = n; i-- > 0;) {
+    double s = z[i];
+    for (unsigned int j = i + 1; j < n; j++)
+      s -= a[j*n + i] * z[j];
+    z[i] = s;
+  }
+  for (unsigned int i = 0; i < n; i++)
+    x[perm[i]] = z[i];
+
+  return n;
+}
@@ -0,0 +1,301 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Generic and parallel RANSAC engine.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpRansacEngine.cpp
+  \brief Generic and parallel RANSAC engine.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <visp3/core/vpRansacEngine.h>
+#include <visp3/core/vpThreadPool.h>
+
+namespace {
+//! Number of samples drawn and evaluated together
+const unsigned int batchSize = 32;
+//! Number of data whose errors are computed together
+const unsigned int errorBlockSize = 256;
+//! Maximum number of local optimizations of a model
+const unsigned int maxLocalOptimizations = 4;
+
+//! Best hypothesis of a sample
+struct Hypothesis {
+  Hypothesis() : model(), consensus(), nbInliers(0) {}
+
+  vpColVector model;
+  std::vector<unsigned int> consensus;
+  unsigned int nbInliers;
+};
+
+//! Compute and score the models of a batch of samples
+class HypothesisTask : public vpThreadPool::Task
+{
+public:
+  HypothesisTask(const vpRansacEngine::Problem &problem, const std::vector<unsigned int> &samples,
+                 std::vector<Hypothesis> &hypotheses, std::vector<std::vector<vpColVector> > &models,
+                 std::vector<std::vector<double> > &errors, std::vector<std::vector<unsigned int> > &consensus,
+                 const double threshold, const unsigned int nbInliersToBeat)
+    : m_problem(problem), m_samples(samples), m_hypotheses(hypotheses), m_models(models), m_errors(errors),
+      m_consensus(consensus), m_threshold(threshold), m_nbInliersToBeat(nbInliersToBeat)
+  {
+  }
+
+  void operator()(const unsigned int begin, const unsigned int end)
+  {
+    const unsigned int thread = vpThreadPool::getThreadIndex();
+    std::vector<vpColVector> &models = m_models[thread];
+    std::vector<unsigned int> &consensus = m_consensus[thread];
+    const unsigned int sampleSize = m_problem.getSampleSize();
+    for (unsigned int i = begin; i < end; i++) {
+      Hypothesis &hypothesis = m_hypotheses[i];
+      hypothesis.nbInliers = 0;
+      const unsigned int *sample = &m_samples[i * sampleSize];
+      models.clear();
+      const unsigned int nbModels = m_problem.computeModels(sample, models);
+      for (unsigned int k = 0; k < nbModels; k++) {
+        // The hypotheses that are not better than the best one of the
+        // previous batches are not kept
+        const unsigned int nbInliersToBeat = std::max(m_nbInliersToBeat, hypothesis.nbInliers);
+        const unsigned int nbInliers = m_problem.computeConsensus(models[k], m_threshold, nbInliersToBeat, consensus,
+                                                                  m_errors[thread]);
+        if (nbInliers > nbInliersToBeat) {
+          hypothesis.nbInliers = nbInliers;
+          hypothesis.model = models[k];
+          hypothesis.consensus.swap(consensus);
+        }
+      }
+    }
+  }
+
+private:
+  const vpRansacEngine::Problem &m_problem;
+  const std::vector<unsigned int> &m_samples;
+  std::vector<Hypothesis> &m_hypotheses;
+  std::vector<std::vector<vpColVector> > &m_models;
+  std::vector<std::vector<double> > &m_errors;
+  std::vector<std::vector<unsigned int> > &m_consensus;
+  const double m_threshold;
+  const unsigned int m_nbInliersToBeat;
+};
+}
+
+/*!
+  Compute the consensus set of the model, that is the indexes of the data
+  whose error is below the threshold, or equal to it if
+  isThresholdInclusive() returns true. The errors are computed by blocks with
+  computeErrors(), and the count stops as soon as the model cannot have more
+  than \e nbInliersToBeat inliers.
+
+  \param model : Model to score.
+  \param threshold : Error below which a data is an inlier.
+  \param nbInliersToBeat : Number of inliers of the best model.
+  \param consensus : Indexes of the inliers, in increasing order.
+  \param errors : Buffer used to store the errors.
+
+  \return The number of inliers, that is not greater than \e nbInliersToBeat
+  if the count was stopped.
+*/
+unsigned int vpRansacEngine::Problem::computeConsensus(const vpColVector &model, const double threshold,
+                                                       const unsigned int nbInliersToBeat,
+                                                       std::vector<unsigned int> &consensus,
+                                                       std::vector<double> &errors) const
+{
+  consensus.clear();
+  const unsigned int size = getNbData();
+  if (errors.size() < errorBlockSize) {
+    errors.resize(errorBlockSize);
+  }
+
+  const bool inclusive = isThresholdInclusive();
+  unsigned int nbOutliers = 0;
+  for (unsigned int begin = 0; begin < size; begin += errorBlockSize) {
+    const unsigned int end = std::min(begin + errorBlockSize, size);
+    computeErrors(model, begin, end, &errors[0]);
+    for (unsigned int i = begin; i < end; i++) {
+      if (errors[i - begin] < threshold || (inclusive && errors[i - begin] == threshold)) {
+        consensus.push_back(i);
+      }
+      else if (size - ++nbOutliers <= nbInliersToBeat) {
+        return (unsigned int) consensus.size();
+      }
+    }
+  }
+  return (unsigned int) consensus.size();
+}
+
+/*!
+  Default constructor: the search uses all the threads of vpThreadPool,
+  with a maximum of 1000 trials, a confidence of 0.99, a threshold of 1e-3,
+  a maximum of 1000 consecutive degenerate samples and the local
+  optimization enabled.
+*/
+vpRansacEngine::vpRansacEngine()
+  : m_confidence(0.99), m_degenerateLimitReached(false), m_localOptimization(true), m_maxDegenerateDraws(1000),
+    m_maxTrials(1000), m_nbHypotheses(0), m_nbInliers(0), m_nbInliersConsensus(0), m_nbThreads(0), m_nbTrials(0),
+    m_seed(0), m_threshold(1e-3)
+{
+}
+
+/*!
+  Number of trials needed to draw a sample without outlier with a given
+  confidence.
+
+  \param confidence : Probability of drawing at least one sample without outlier.
+  \param inlierRatio : Ratio of inliers among the data.
+  \param sampleSize : Number of data of a sample.
+  \param maxTrials : Maximum number of trials.
+
+  \return The number of trials, bounded by \e maxTrials.
+*/
+unsigned int vpRansacEngine::computeNbTrials(const double confidence, const double inlierRatio,
+                                             const unsigned int sampleSize, const unsigned int maxTrials)
+{
+  if (confidence <= 0 || confidence >= 1) {
+    return maxTrials;
+  }
+  const double pNoOutlier = pow(inlierRatio, (double) sampleSize);
+  if (pNoOutlier >= 1) {
+    return 0;
+  }
+  if (pNoOutlier <= 0) {
+    return maxTrials;
+  }
+  const double nbTrials = ceil(log(1 - confidence) / log(1 - pNoOutlier));
+  return nbTrials < maxTrials ? (unsigned int) nbTrials : maxTrials;
+}
+
+/*!
+  Robustly estimate the model of a problem.
+
+  \param problem : Problem to solve.
+  \param model : Model with the largest consensus set, refined by the local
+  optimization if enabled.
+  \param inliers : Indexes of the inliers of \e model, in increasing order.
+
+  \return true if a model was found, false otherwise.
+*/
+bool vpRansacEngine::estimate(const Problem &problem, vpColVector &model, std::vector<unsigned int> &inliers)
+{
+  m_degenerateLimitReached = false;
+  m_nbTrials = 0;
+  m_nbHypotheses = 0;
+  m_nbInliers = 0;
+  inliers.clear();
+
+  const unsigned int size = problem.getNbData();
+  const unsigned int sampleSize = problem.getSampleSize();
+  if (size < sampleSize || sampleSize == 0) {
+    return false;
+  }
+
+  vpThreadPool &pool = vpThreadPool::getInstance();
+  const unsigned int nbThreads = pool.getNumThreads();
+  std::vector<std::vector<vpColVector> > threadModels(nbThreads);
+  std::vector<std::vector<double> > threadErrors(nbThreads);
+  std::vector<std::vector<unsigned int> > threadConsensus(nbThreads);
+  std::vector<Hypothesis> hypotheses(batchSize);
+  std::vector<unsigned int> samples(batchSize * sampleSize);
+  std::vector<unsigned int> consensus;
+  std::vector<double> errors;
+
+  RandomGenerator random(m_seed);
+  unsigned int maxTrials = m_maxTrials;
+  const unsigned int nbInliersConsensus = m_nbInliersConsensus > 0 ? m_nbInliersConsensus : size;
+  bool foundSolution = false;
+  while (m_nbTrials < maxTrials && m_nbInliers < nbInliersConsensus && !m_degenerateLimitReached) {
+    // Draw the samples of the batch without replacement, the degenerate
+    // samples being drawn again
+    unsigned int nbSamples = std::min(batchSize, maxTrials - m_nbTrials);
+    for (unsigned int i = 0; i < nbSamples; i++) {
+      unsigned int *sample = &samples[i * sampleSize];
+      unsigned int nbDraws = 0;
+      do {
+        if (nbDraws++ == m_maxDegenerateDraws) {
+          m_degenerateLimitReached = true;
+          nbSamples = i;
+          break;
+        }
+        for (unsigned int j = 0; j < sampleSize;) {
+          const unsigned int index = random(size);
+          if (std::find(sample, sample + j, index) == sample + j) {
+            sample[j++] = index;
+          }
+        }
+      } while (problem.isDegenerate(sample));
+    }
+
+    HypothesisTask task(problem, samples, hypotheses, threadModels, threadErrors, threadConsensus, m_threshold,
+                        m_nbInliers);
+    pool.parallelFor(0, nbSamples, task, 1, m_nbThreads);
+
+    // Examine the hypotheses in the order of their samples, as a sequential search would do
+    for (unsigned int i = 0; i < nbSamples && m_nbTrials < maxTrials && m_nbInliers < nbInliersConsensus; i++) {
+      m_nbTrials++;
+      Hypothesis &hypothesis = hypotheses[i];
+      if (hypothesis.nbInliers <= m_nbInliers) {
+        continue;
+      }
+
+      foundSolution = true;
+      m_nbInliers = hypothesis.nbInliers;
+      model = hypothesis.model;
+      inliers.swap(hypothesis.consensus);
+
+      if (m_localOptimization) {
+        for (unsigned int k = 0; k < maxLocalOptimizations && m_nbInliers < nbInliersConsensus; k++) {
+          vpColVector refinedModel = model;
+          if (!problem.refineModel(inliers, refinedModel)) {
+            break;
+          }
+          const unsigned int nbInliers = problem.computeConsensus(refinedModel, m_threshold, m_nbInliers, consensus,
+                                                                  errors);
+          if (nbInliers <= m_nbInliers) {
+            break;
+          }
+          m_nbInliers = nbInliers;
+          model = refinedModel;
+          inliers.swap(consensus);
+        }
+      }
+
+      maxTrials = std::min(maxTrials, computeNbTrials(m_confidence, m_nbInliers / (double) size, sampleSize,
+                                                      m_maxTrials));
+    }
+    m_nbHypotheses += nbSamples;
+  }
+
+  return foundSolution;
+}
@@ -51,9 +51,15 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <algorithm> // std::nth_element, std::swap
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
 #define vpITMAX 100
 #define vpEPS 3.0e-7
 #define vpCST 1
@@ -66,7 +72,7 @@
 
 */
 vpRobust::vpRobust(unsigned int n_data)
-  : normres(), sorted_normres(), sorted_residues(), NoiseThreshold(0.0017), sig_prev(0), it(0), swap(0), size(n_data)
+  : normres(), all_normres(), sorted_normres(), sorted_residues(), NoiseThreshold(0.0017), sig_prev(0), it(0), swap(0), size(n_data)
 {
   vpCDEBUG(2) << "vpRobust constructor reached" << std::endl;
 
@@ -80,7 +86,7 @@ vpRobust::vpRobust(unsigned int n_data)
   Default constructor.
 */
 vpRobust::vpRobust()
-  : normres(), sorted_normres(), sorted_residues(), NoiseThreshold(0.0017), sig_prev(0), it(0), swap(0), size(0)
+  : normres(), all_normres(), sorted_normres(), sorted_residues(), NoiseThreshold(0.0017), sig_prev(0), it(0), swap(0), size(0)
 {
 }
 
@@ -98,6 +104,7 @@ vpRobust::vpRobust(const vpRobust &other)
 vpRobust & vpRobust::operator=(const vpRobust &other)
 {
   normres = other.normres;
+  all_normres = other.all_normres;
   sorted_normres = other.sorted_normres;
   sorted_residues = other.sorted_residues;
   NoiseThreshold = other.NoiseThreshold;
@@ -115,6 +122,7 @@ vpRobust & vpRobust::operator=(const vpRobust &other)
 vpRobust & vpRobust::operator=(const vpRobust &&other)
 {
   normres = std::move(other.normres);
+  all_normres = std::move(other.all_normres);
   sorted_normres = std::move(other.sorted_normres);
   sorted_residues = std::move(other.sorted_residues);
   NoiseThreshold = std::move(other.NoiseThreshold);
@@ -261,8 +269,10 @@ void vpRobust::MEstimator(const vpRobustEstimatorType method,
   double normmedian=0; 	// Normalized median
   double sigma=0;// Standard Deviation
 
+  // resize vectors only if the size of the residue vectors has changed
   unsigned int n_all_data = all_residues.getRows();
-  vpColVector all_normres(n_all_data); 
+  if (all_normres.getRows() != n_all_data)
+    all_normres.resize(n_all_data, false);
 
   // compute median with the residues vector, return all_normres which are the normalized all_residues vector.
   normmedian = computeNormalizedMedian(all_normres,residues,all_residues,weights);
@@ -325,29 +335,19 @@ double vpRobust::computeNormalizedMedian(vpColVector &all_normres,
   
   // resize vector only if the size of residue vector has changed
   resize(n_data);
-    
-  sorted_residues = residues;
-  vpColVector no_null_weight_residues;
-  no_null_weight_residues.resize(n_data);
-  
-  //all_normres.resize(n_all_data); // Normalized Residue
-  //vpColVector sorted_normres(n_data); // Normalized Residue
-  //vpColVector sorted_residues = residues;
-  //vpColVector sorted_residues;
-  
 
+  // The residues with a null weight are not copied; only the first n_data
+  // elements of sorted_residues and sorted_normres are used
   unsigned int index =0;
   for(unsigned int j=0;j<n_data;j++)
   {
     //if(weights[j]!=0)
     if(std::fabs(weights[j]) > std::numeric_limits<double>::epsilon())
     {
-      no_null_weight_residues[index]=residues[j];
+      sorted_residues[index]=residues[j];
       index++;
     }
   }
-  sorted_residues.resize(index);
-  memcpy(sorted_residues.data,no_null_weight_residues.data,index*sizeof(double));
   n_data=index;
 
   vpCDEBUG(2) << "vpRobust MEstimator reached. No. data = " << n_data
@@ -675,20 +675,39 @@ void vpRobust::psiTukey(double sig, vpColVector &x, vpColVector & weights)
 
   unsigned int n_data = x.getRows();
   double cst_const = vpCST*4.6851;
+  const double eps = std::numeric_limits<double>::epsilon();
 
-  for(unsigned int i=0; i<n_data; i++)
+  //if(sig==0)
+  if(std::fabs(sig) <= eps)
   {
-    //if(sig==0 && weights[i]!=0)
-    if(std::fabs(sig) <= std::numeric_limits<double>::epsilon() && std::fabs(weights[i]) > std::numeric_limits<double>::epsilon())
-    {
-      weights[i]=1;
-      continue;
-    }
+    for(unsigned int i=0; i<n_data; i++)
+      weights[i] = (std::fabs(weights[i]) > eps) ? 1 : 0;
+    return;
+  }
 
+  unsigned int i=0;
+#if VISP_HAVE_SSE2
+  // Same operations as below, two residues at a time
+  const __m128d v_sign = _mm_set1_pd(-0.0), v_sig = _mm_set1_pd(sig), v_cst = _mm_set1_pd(cst_const);
+  const __m128d v_one = _mm_set1_pd(1.0), v_eps = _mm_set1_pd(eps);
+  for(; i+2<=n_data; i+=2)
+  {
+    const __m128d v_xi_sig = _mm_div_pd(_mm_loadu_pd(x.data+i), v_sig);
+    const __m128d v_w = _mm_loadu_pd(weights.data+i);
+    const __m128d v_inlier = _mm_and_pd(_mm_cmple_pd(_mm_andnot_pd(v_sign, v_xi_sig), v_cst),
+                                        _mm_cmpgt_pd(_mm_andnot_pd(v_sign, v_w), v_eps));
+    const __m128d v_r = _mm_div_pd(v_xi_sig, v_cst);
+    const __m128d v_t = _mm_sub_pd(v_one, _mm_mul_pd(v_r, v_r));
+    _mm_storeu_pd(weights.data+i, _mm_and_pd(v_inlier, _mm_mul_pd(v_t, v_t)));
+  }
+#endif
+
+  for(; i<n_data; i++)
+  {
     double xi_sig = x[i]/sig;
 
     //if((fabs(xi_sig)<=(cst_const)) && weights[i]!=0)
-    if((std::fabs(xi_sig)<=(cst_const)) && std::fabs(weights[i]) > std::numeric_limits<double>::epsilon())
+    if((std::fabs(xi_sig)<=(cst_const)) && std::fabs(weights[i]) > eps)
     {
       weights[i] = vpMath::sqr(1-vpMath::sqr(xi_sig/cst_const));
       //w[i] = vpMath::sqr(1-vpMath::sqr(x[i]/sig/4.7));
@@ -712,11 +731,28 @@ void vpRobust::psiHuber(double sig, vpColVector &x, vpColVector &weights)
 {
   double c = 1.2107; //1.345;
   unsigned int n_data = x.getRows();
+  const double eps = std::numeric_limits<double>::epsilon();
+
+  unsigned int i=0;
+#if VISP_HAVE_SSE2
+  // Same operations as below, two residues at a time
+  const __m128d v_sign = _mm_set1_pd(-0.0), v_sig = _mm_set1_pd(sig), v_c = _mm_set1_pd(c);
+  const __m128d v_one = _mm_set1_pd(1.0), v_eps = _mm_set1_pd(eps);
+  for(; i+2<=n_data; i+=2)
+  {
+    const __m128d v_w = _mm_loadu_pd(weights.data+i);
+    const __m128d v_abs = _mm_andnot_pd(v_sign, _mm_div_pd(_mm_loadu_pd(x.data+i), v_sig));
+    const __m128d v_small = _mm_cmple_pd(v_abs, v_c);
+    const __m128d v_huber = _mm_or_pd(_mm_and_pd(v_small, v_one), _mm_andnot_pd(v_small, _mm_div_pd(v_c, v_abs)));
+    const __m128d v_update = _mm_cmpgt_pd(_mm_andnot_pd(v_sign, v_w), v_eps);
+    _mm_storeu_pd(weights.data+i, _mm_or_pd(_mm_and_pd(v_update, v_huber), _mm_andnot_pd(v_update, v_w)));
+  }
+#endif
 
-  for(unsigned int i=0; i<n_data; i++)
+  for(; i<n_data; i++)
   {
     //if(weights[i]!=0)
-    if(std::fabs(weights[i]) > std::numeric_limits<double>::epsilon())
+    if(std::fabs(weights[i]) > eps)
     {
       double xi_sig = x[i]/sig;
       if(fabs(xi_sig)<=c)
@@ -740,8 +776,18 @@ void vpRobust::psiCauchy(double sig, vpColVector &x, vpColVector &weights)
   unsigned int n_data = x.getRows();
   double const_sig = 2.3849*sig;
 
+  unsigned int i=0;
+#if VISP_HAVE_SSE2
+  const __m128d v_const_sig = _mm_set1_pd(const_sig), v_one = _mm_set1_pd(1.0);
+  for(; i+2<=n_data; i+=2)
+  {
+    const __m128d v_r = _mm_div_pd(_mm_loadu_pd(x.data+i), v_const_sig);
+    _mm_storeu_pd(weights.data+i, _mm_div_pd(v_one, _mm_add_pd(v_one, _mm_mul_pd(v_r, v_r))));
+  }
+#endif
+
   //Calculate Cauchy's equation
-  for(unsigned int i=0; i<n_data; i++)
+  for(; i<n_data; i++)
   {
     weights[i] = 1/(1+vpMath::sqr(x[i]/(const_sig)));
 
@@ -794,7 +840,11 @@ void vpRobust::psiMcLure(double sig, vpColVector &r,vpColVector &weights)
 }
 
 
+#if defined(VISP_BUILD_DEPRECATED_FUNCTIONS)
 /*!
+  \deprecated Provided only for compat with previous releases.
+  select() no longer uses it.
+
   \brief partition function
   \param a : vector to be sorted
   \param l : first value to be considered
@@ -812,14 +862,20 @@ vpRobust::partition(vpColVector &a, int l, int r)
     while (a[(unsigned int)++i] < v) ;
     while (v < a[(unsigned int)--j]) if (j == l) break;
     if (i >= j) break;
-    exch(a[(unsigned int)i], a[(unsigned int)j]);
+    std::swap(a[(unsigned int)i], a[(unsigned int)j]);
   }
-  exch(a[(unsigned int)i], a[(unsigned int)r]);
+  std::swap(a[(unsigned int)i], a[(unsigned int)r]);
   return i;
 }
+#endif // defined(VISP_BUILD_DEPRECATED_FUNCTIONS)
 
 /*!
   \brief sort a part of a vector and select a value of this new vector
+
+  The elements are reordered so that the k-th one is the one that would be
+  at this position if the part was sorted (introselect, linear in average
+  and in the worst case).
+
   \param a : vector to be sorted
   \param l : first value to be considered
   \param r : last value to be considered
@@ -828,12 +884,8 @@ vpRobust::partition(vpColVector &a, int l, int r)
 double 
 vpRobust::select(vpColVector &a, int l, int r, int k)
 {
-  while (r > l)
-  {
-    int i = partition(a, l, r);
-    if (i >= k) r = i-1;
-    if (i <= k) l = i+1;
-  }
+  if (r > l)
+    std::nth_element(a.data + l, a.data + k, a.data + r + 1);
   return a[(unsigned int)k];
 }
 
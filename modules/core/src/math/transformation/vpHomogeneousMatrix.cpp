@@ -54,7 +54,7 @@
  */
 vpHomogeneousMatrix::vpHomogeneousMatrix(const vpTranslationVector &t,
                                          const vpQuaternionVector &q)
-  : vpArray2D<double>(4, 4)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(t,q);
   (*this)[3][3] = 1.;
@@ -64,7 +64,7 @@ vpHomogeneousMatrix::vpHomogeneousMatrix(const vpTranslationVector &t,
   Default constructor that initialize an homogeneous matrix as identity.
 */
 vpHomogeneousMatrix::vpHomogeneousMatrix()
-  : vpArray2D<double>(4, 4)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   eye() ;
 }
@@ -73,7 +73,7 @@ vpHomogeneousMatrix::vpHomogeneousMatrix()
   Copy constructor that initialize an homogeneous matrix from another homogeneous matrix.
 */
 vpHomogeneousMatrix::vpHomogeneousMatrix(const vpHomogeneousMatrix &M)
-  : vpArray2D<double>(4, 4)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   *this = M;
 }
@@ -83,7 +83,7 @@ vpHomogeneousMatrix::vpHomogeneousMatrix(const vpHomogeneousMatrix &M)
  */
 vpHomogeneousMatrix::vpHomogeneousMatrix(const vpTranslationVector &t,
                                          const vpThetaUVector &tu)
-  : vpArray2D<double>(4, 4)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(t, tu);
   (*this)[3][3] = 1.;
@@ -94,7 +94,7 @@ vpHomogeneousMatrix::vpHomogeneousMatrix(const vpTranslationVector &t,
  */
 vpHomogeneousMatrix::vpHomogeneousMatrix(const vpTranslationVector &t,
                                          const vpRotationMatrix &R)
-  : vpArray2D<double>(4, 4)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   insert(R);
   insert(t);
@@ -105,7 +105,7 @@ vpHomogeneousMatrix::vpHomogeneousMatrix(const vpTranslationVector &t,
   Construct an homogeneous matrix from a pose vector.
  */
 vpHomogeneousMatrix::vpHomogeneousMatrix(const vpPoseVector &p)
-  : vpArray2D<double>(4, 4)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(p[0], p[1], p[2], p[3], p[4], p[5]) ;
   (*this)[3][3] = 1.;
@@ -150,7 +150,7 @@ M:
   \endcode
   */
 vpHomogeneousMatrix::vpHomogeneousMatrix(const std::vector<float> &v)
-  : vpArray2D<double>(4, 4)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(v) ;
   (*this)[3][3] = 1.;
@@ -195,7 +195,7 @@ M:
   \endcode
   */
 vpHomogeneousMatrix::vpHomogeneousMatrix(const std::vector<double> &v)
-  : vpArray2D<double>(4, 4)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(v) ;
   (*this)[3][3] = 1.;
@@ -211,7 +211,7 @@ vpHomogeneousMatrix::vpHomogeneousMatrix(const double tx,
                                          const double tux,
                                          const double tuy,
                                          const double tuz)
-  : vpArray2D<double>(4, 4)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(tx, ty, tz, tux, tuy, tuz);
   (*this)[3][3] = 1.;
@@ -422,21 +422,16 @@ vpHomogeneousMatrix::operator*(const vpHomogeneousMatrix &M) const
 {
   vpHomogeneousMatrix p;
 
-  vpRotationMatrix R1, R2, R ;
-  vpTranslationVector T1, T2 , T;
-
-  extract(T1) ;
-  M.extract(T2) ;
-
-  extract (R1) ;
-  M.extract (R2) ;
-
-  R = R1*R2 ;
-
-  T = R1*T2 + T1 ;
-
-  p.insert(T) ;
-  p.insert(R) ;
+  // Unrolled product of the 3-by-4 upper parts; the last row is always [0 0 0 1]
+  const double *a = data;
+  const double *b = M.data;
+  double *c = p.data;
+  for (unsigned int i = 0; i < 3; i++, a += 4, c += 4) {
+    c[0] = a[0]*b[0] + a[1]*b[4] + a[2]*b[8];
+    c[1] = a[0]*b[1] + a[1]*b[5] + a[2]*b[9];
+    c[2] = a[0]*b[2] + a[1]*b[6] + a[2]*b[10];
+    c[3] = a[0]*b[3] + a[1]*b[7] + a[2]*b[11] + a[3];
+  }
 
   return p;
 }
@@ -504,7 +499,7 @@ vpPoint vpHomogeneousMatrix::operator*(const vpPoint& bP) const
 {
   vpPoint aP ;
 
-  vpColVector v(4),v1(4) ;
+  double v[4], v1[4];
 
   v[0] = bP.get_X() ;
   v[1] = bP.get_Y() ;
@@ -516,7 +511,10 @@ vpPoint vpHomogeneousMatrix::operator*(const vpPoint& bP) const
   v1[2] = (*this)[2][0]*v[0] + (*this)[2][1]*v[1]+ (*this)[2][2]*v[2]+ (*this)[2][3]*v[3] ;
   v1[3] = (*this)[3][0]*v[0] + (*this)[3][1]*v[1]+ (*this)[3][2]*v[2]+ (*this)[3][3]*v[3] ;
 
-  v1 /= v1[3] ;
+  v1[0] /= v1[3] ;
+  v1[1] /= v1[3] ;
+  v1[2] /= v1[3] ;
+  v1[3] = 1.0 ;
 
   //  v1 = M*v ;
   aP.set_X(v1[0]) ;
@@ -673,15 +671,18 @@ vpHomogeneousMatrix
 vpHomogeneousMatrix::inverse() const
 {
   vpHomogeneousMatrix Mi ;
-
-  vpRotationMatrix R ;      extract(R) ;
-  vpTranslationVector T ;   extract(T) ;
-
-  vpTranslationVector RtT ; RtT = -(R.t()*T) ;
-
-
-  Mi.insert(R.t()) ;
-  Mi.insert(RtT) ;
+  const double *a = data;
+  double *b = Mi.data;
+
+  // Rotation part is transposed
+  b[0] = a[0]; b[1] = a[4]; b[2]  = a[8];
+  b[4] = a[1]; b[5] = a[5]; b[6]  = a[9];
+  b[8] = a[2]; b[9] = a[6]; b[10] = a[10];
+
+  // Translation part is -R^T t
+  b[3]  = -(a[0]*a[3] + a[4]*a[7] + a[8]*a[11]);
+  b[7]  = -(a[1]*a[3] + a[5]*a[7] + a[9]*a[11]);
+  b[11] = -(a[2]*a[3] + a[6]*a[7] + a[10]*a[11]);
 
   return Mi ;
 }
@@ -142,13 +142,13 @@ vpRotationMatrix::operator*(const vpRotationMatrix &R) const
 {
   vpRotationMatrix p ;
 
-  for (unsigned int i=0;i<3;i++) {
-    for (unsigned int j=0;j<3;j++) {
-      double s =0 ;
-      for (unsigned int k=0;k<3;k++)
-        s +=rowPtrs[i][k] * R.rowPtrs[k][j];
-      p[i][j] = s ;
-    }
+  const double *a = data;
+  const double *b = R.data;
+  double *c = p.data;
+  for (unsigned int i=0;i<3;i++, a+=3, c+=3) {
+    c[0] = a[0]*b[0] + a[1]*b[3] + a[2]*b[6];
+    c[1] = a[0]*b[1] + a[1]*b[4] + a[2]*b[7];
+    c[2] = a[0]*b[2] + a[1]*b[5] + a[2]*b[8];
   }
   return p;
 }
@@ -245,14 +245,10 @@ vpRotationMatrix::operator*(const vpTranslationVector &tv) const
 {
   vpTranslationVector p ;
 
-  for (unsigned int j=0;j<3;j++)
-    p[j] = 0;
-
-  for (unsigned int j=0;j<3;j++) {
-    for (unsigned int i=0;i<3;i++) {
-      p[i] += rowPtrs[i][j] * tv[j];
-    }
-  }
+  const double *a = data;
+  p[0] = a[0]*tv[0] + a[1]*tv[1] + a[2]*tv[2];
+  p[1] = a[3]*tv[0] + a[4]*tv[1] + a[5]*tv[2];
+  p[2] = a[6]*tv[0] + a[7]*tv[1] + a[8]*tv[2];
 
   return p;
 }
@@ -331,7 +327,7 @@ vpRotationMatrix::isARotationMatrix() const
 /*!
   Default constructor that initialise a 3-by-3 rotation matrix to identity.
 */
-vpRotationMatrix::vpRotationMatrix() : vpArray2D<double>(3,3)
+vpRotationMatrix::vpRotationMatrix() : vpArray2D<double>(m_storage), m_storage()
 {
   eye();
 }
@@ -340,14 +336,14 @@ vpRotationMatrix::vpRotationMatrix() : vpArray2D<double>(3,3)
 /*!
   Copy contructor that construct a 3-by-3 rotation matrix from another rotation matrix.
 */
-vpRotationMatrix::vpRotationMatrix(const vpRotationMatrix &M) : vpArray2D<double>(3,3)
+vpRotationMatrix::vpRotationMatrix(const vpRotationMatrix &M) : vpArray2D<double>(m_storage), m_storage()
 {
   (*this) = M ;
 }
 /*!
   Construct a 3-by-3 rotation matrix from an homogeneous matrix.
 */
-vpRotationMatrix::vpRotationMatrix(const vpHomogeneousMatrix &M) : vpArray2D<double>(3,3)
+vpRotationMatrix::vpRotationMatrix(const vpHomogeneousMatrix &M) : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(M);
 }
@@ -355,7 +351,7 @@ vpRotationMatrix::vpRotationMatrix(const vpHomogeneousMatrix &M) : vpArray2D<dou
 /*!
   Construct a 3-by-3 rotation matrix from \f$ \theta {\bf u}\f$ angle representation.
  */
-vpRotationMatrix::vpRotationMatrix(const vpThetaUVector &tu) : vpArray2D<double>(3,3)
+vpRotationMatrix::vpRotationMatrix(const vpThetaUVector &tu) : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(tu) ;
 }
@@ -363,7 +359,7 @@ vpRotationMatrix::vpRotationMatrix(const vpThetaUVector &tu) : vpArray2D<double>
 /*!
   Construct a 3-by-3 rotation matrix from a pose vector.
  */
-vpRotationMatrix::vpRotationMatrix(const vpPoseVector &p) : vpArray2D<double>(3,3)
+vpRotationMatrix::vpRotationMatrix(const vpPoseVector &p) : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(p) ;
 }
@@ -371,7 +367,7 @@ vpRotationMatrix::vpRotationMatrix(const vpPoseVector &p) : vpArray2D<double>(3,
 /*!
   Construct a 3-by-3 rotation matrix from \f$ R(z,y,z) \f$ Euler angle representation.
  */
-vpRotationMatrix::vpRotationMatrix(const vpRzyzVector &euler) : vpArray2D<double>(3,3)
+vpRotationMatrix::vpRotationMatrix(const vpRzyzVector &euler) : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(euler) ;
 }
@@ -379,7 +375,7 @@ vpRotationMatrix::vpRotationMatrix(const vpRzyzVector &euler) : vpArray2D<double
 /*!
   Construct a 3-by-3 rotation matrix from \f$ R(x,y,z) \f$ Euler angle representation.
  */
-vpRotationMatrix::vpRotationMatrix(const vpRxyzVector &Rxyz) : vpArray2D<double>(3,3)
+vpRotationMatrix::vpRotationMatrix(const vpRxyzVector &Rxyz) : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(Rxyz) ;
 }
@@ -387,7 +383,7 @@ vpRotationMatrix::vpRotationMatrix(const vpRxyzVector &Rxyz) : vpArray2D<double>
 /*!
   Construct a 3-by-3 rotation matrix from \f$ R(z,y,x) \f$ Euler angle representation.
  */
-vpRotationMatrix::vpRotationMatrix(const vpRzyxVector &Rzyx) : vpArray2D<double>(3,3)
+vpRotationMatrix::vpRotationMatrix(const vpRzyxVector &Rzyx) : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(Rzyx) ;
 }
@@ -395,7 +391,7 @@ vpRotationMatrix::vpRotationMatrix(const vpRzyxVector &Rzyx) : vpArray2D<double>
 /*!
   Construct a 3-by-3 rotation matrix from \f$ \theta {\bf u}=(\theta u_x, \theta u_y, \theta u_z)^T\f$ angle representation.
  */
-vpRotationMatrix::vpRotationMatrix(const double tux, const double tuy, const double tuz) : vpArray2D<double>(3,3)
+vpRotationMatrix::vpRotationMatrix(const double tux, const double tuy, const double tuz) : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(tux, tuy, tuz) ;
 }
@@ -403,7 +399,7 @@ vpRotationMatrix::vpRotationMatrix(const double tux, const double tuy, const dou
 /*!
   Construct a 3-by-3 rotation matrix from quaternion angle representation.
  */
-vpRotationMatrix::vpRotationMatrix(const vpQuaternionVector& q) : vpArray2D<double>(3,3)
+vpRotationMatrix::vpRotationMatrix(const vpQuaternionVector& q) : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(q);
 }
@@ -89,7 +89,7 @@ vpVelocityTwistMatrix::eye()
   Initialize a velocity twist transformation matrix as identity.
 */
 vpVelocityTwistMatrix::vpVelocityTwistMatrix()
-  : vpArray2D<double>(6, 6)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   eye() ;
 }
@@ -100,7 +100,7 @@ vpVelocityTwistMatrix::vpVelocityTwistMatrix()
   \param V : Velocity twist matrix used as initializer.
 */
 vpVelocityTwistMatrix::vpVelocityTwistMatrix(const vpVelocityTwistMatrix &V)
-  : vpArray2D<double>(6, 6)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   *this = V;
 }
@@ -116,7 +116,7 @@ vpVelocityTwistMatrix::vpVelocityTwistMatrix(const vpVelocityTwistMatrix &V)
 
 */
 vpVelocityTwistMatrix::vpVelocityTwistMatrix(const vpHomogeneousMatrix &M)
-  : vpArray2D<double>(6, 6)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(M);
 }
@@ -133,7 +133,7 @@ vpVelocityTwistMatrix::vpVelocityTwistMatrix(const vpHomogeneousMatrix &M)
 */
 vpVelocityTwistMatrix::vpVelocityTwistMatrix(const vpTranslationVector &t,
                                              const vpThetaUVector &thetau)
-  : vpArray2D<double>(6, 6)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(t, thetau) ;
 }
@@ -150,7 +150,7 @@ vpVelocityTwistMatrix::vpVelocityTwistMatrix(const vpTranslationVector &t,
 */
 vpVelocityTwistMatrix::vpVelocityTwistMatrix(const vpTranslationVector &t,
                                              const vpRotationMatrix &R)
-  : vpArray2D<double>(6, 6)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   buildFrom(t,R) ;
 }
@@ -171,7 +171,7 @@ vpVelocityTwistMatrix::vpVelocityTwistMatrix(const double tx,
 					     const double tux,
 					     const double tuy,
                const double tuz)
-  : vpArray2D<double>(6, 6)
+  : vpArray2D<double>(m_storage), m_storage()
 {
   vpTranslationVector T(tx,ty,tz) ;
   vpThetaUVector tu(tux,tuy,tuz) ;
@@ -189,14 +189,14 @@ vpVelocityTwistMatrix::operator*(const vpVelocityTwistMatrix &V) const
 {
   vpVelocityTwistMatrix p ;
 
-  for (unsigned int i=0;i<6;i++)
-    for (unsigned int j=0;j<6;j++)
-    {
-      double s =0 ;
-      for (int k=0;k<6;k++)
-        s +=rowPtrs[i][k] * V.rowPtrs[k][j];
-      p[i][j] = s ;
+  const double *a = data;
+  double *c = p.data;
+  for (unsigned int i=0;i<6;i++, a+=6, c+=6) {
+    const double *b = V.data;
+    for (unsigned int j=0;j<6;j++, b++) {
+      c[j] = a[0]*b[0] + a[1]*b[6] + a[2]*b[12] + a[3]*b[18] + a[4]*b[24] + a[5]*b[30];
     }
+  }
   return p;
 }
 
@@ -165,15 +165,27 @@ void
 vpPolygon3D::computePolygonClipped(const vpCameraParameters &cam)
 {
   polyClipped.clear();
-  std::vector<vpColVector> fovNormals;
+  const std::vector<vpColVector> noFovNormals;
+  const std::vector<vpColVector> &fovNormals = (cam.isFovComputed() && clippingFlag > 3) ? cam.getFovNormals() : noFovNormals;
   std::vector<std::pair<vpPoint,unsigned int> > polyClippedTemp;
   std::vector<std::pair<vpPoint,unsigned int> > polyClippedTemp2;
 
-  if(cam.isFovComputed() && clippingFlag > 3)
-    fovNormals = cam.getFovNormals();
+  for(unsigned int i = 0 ; i < nbpt ; i++)
+    p[i].projection();
+
+  // Most of the polygons of a large model are either entirely inside or entirely
+  // outside the clipping planes: there is nothing to clip.
+  const int side = getClippingSide(fovNormals, cam.isFovComputed());
+  if(side < 0)
+    return;
+  if(side > 0){
+    polyClipped.reserve(nbpt);
+    for(unsigned int i = 0 ; i < nbpt ; i++)
+      polyClipped.push_back(std::make_pair(p[i],vpPolygon3D::NO_CLIPPING));
+    return;
+  }
 
   for(unsigned int i = 0 ; i < nbpt ; i++){
-      p[i%nbpt].projection();
       polyClippedTemp.push_back(std::make_pair(p[i%nbpt],vpPolygon3D::NO_CLIPPING));
   }
 
@@ -254,6 +266,69 @@ vpPolygon3D::computePolygonClipped(const vpCameraParameters &cam)
   polyClipped = polyClippedTemp;
 }
     
+/*!
+  Test if the polygon is entirely inside or entirely outside the clipping planes
+  used by computePolygonClipped(), the planes being considered in the same order.
+
+  \warning Suppose that changeFrame() has already been called.
+
+  \param fovNormals : Normals of the field of view planes, empty if not used.
+  \param fovComputed : True if the field of view of the camera has been computed.
+
+  \return -1 if the clipped polygon is empty, 1 if the polygon is not clipped at all,
+  and 0 if the polygon has to be clipped or if the test is not conclusive.
+*/
+int
+vpPolygon3D::getClippingSide(const std::vector<vpColVector> &fovNormals, const bool fovComputed) const
+{
+  if(clippingFlag == vpPolygon3D::NO_CLIPPING)
+    return 1;
+
+  for(unsigned int i = 1 ; i < 64 ; i=i*2)
+  {
+    if(((clippingFlag & i) == i) || ((clippingFlag > vpPolygon3D::FAR_CLIPPING) && (i==1)))
+    {
+      if(i > vpPolygon3D::FAR_CLIPPING && !fovComputed)
+        continue;
+
+      unsigned int nbOutside = 0;
+      for(unsigned int j = 0 ; j < nbpt ; j++)
+      {
+        const double X = p[j].get_X(), Y = p[j].get_Y(), Z = p[j].get_Z();
+        bool outside;
+        if(i == vpPolygon3D::NEAR_CLIPPING)
+          outside = (Z < distNearClip);
+        else if(i == vpPolygon3D::FAR_CLIPPING)
+          outside = (Z > distFarClip);
+        else {
+          // Same as the angle test of getClippedPointsFovGeneric(), with a margin
+          // so that rounding errors cannot change the side of a point
+          const vpColVector &normal = fovNormals[i == vpPolygon3D::LEFT_CLIPPING ? 0 :
+                                                 i == vpPolygon3D::RIGHT_CLIPPING ? 1 :
+                                                 i == vpPolygon3D::UP_CLIPPING ? 2 : 3];
+          const double d = normal[0] * X + normal[1] * Y + normal[2] * Z;
+          const double margin = 1e-9 * sqrt(X * X + Y * Y + Z * Z);
+          if(d > margin)
+            outside = true;
+          else if(d < -margin)
+            outside = false;
+          else
+            return 0;
+        }
+        if(outside)
+          nbOutside++;
+      }
+
+      if(nbOutside == nbpt && nbpt > 0)
+        return -1;
+      if(nbOutside != 0)
+        return 0;
+    }
+  }
+
+  return 1;
+}
+
 /*!
   Get the clipped points according to a plane equation.
 
@@ -50,87 +50,86 @@
 #include <visp3/core/vpDisplay.h>
 
 
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
-#include <visp3/core/vpThread.h>
+#include <visp3/core/vpThreadPool.h>
 
 namespace {
-  struct Histogram_Param_t {
-    unsigned int m_start_index;
-    unsigned int m_end_index;
-
-    unsigned int m_lut[256];
-    unsigned int *m_histogram;
-    const vpImage<unsigned char> *m_I;
-
-    Histogram_Param_t() : m_start_index(0), m_end_index(0), m_lut(), m_histogram(NULL), m_I(NULL) {
-    }
-
-    Histogram_Param_t(const unsigned int start_index, const unsigned int end_index,
-        const vpImage<unsigned char> * const I) :
-      m_start_index(start_index), m_end_index(end_index), m_lut(), m_histogram(NULL), m_I(I) {
+  class vpHistogramTask : public vpThreadPool::Task
+  {
+  public:
+    vpHistogramTask(const vpImage<unsigned char> &I, const unsigned int (&lut)[256],
+                    const unsigned int nbChunks, const unsigned int size)
+      : m_I(I), m_lut(lut), m_nbChunks(nbChunks), m_size(size), m_histograms(nbChunks*size, 0) {
     }
 
-    ~Histogram_Param_t() {
-      if(m_histogram != NULL) {
-        delete []m_histogram;
+    void operator()(const unsigned int begin, const unsigned int end) {
+      unsigned int image_size = m_I.getSize();
+      for (unsigned int chunk = begin; chunk < end; chunk++) {
+        unsigned int start_index = (unsigned int) (((unsigned long long) image_size * chunk) / m_nbChunks);
+        unsigned int end_index = (unsigned int) (((unsigned long long) image_size * (chunk+1)) / m_nbChunks);
+        computeHistogram(start_index, end_index, &m_histograms[chunk*m_size]);
       }
     }
-  };
-
-  vpThread::Return computeHistogramThread(vpThread::Args args) {
-    Histogram_Param_t *histogram_param = static_cast<Histogram_Param_t *>(args);
-    unsigned int start_index = histogram_param->m_start_index;
-    unsigned int end_index = histogram_param->m_end_index;
 
-    const vpImage<unsigned char> *I = histogram_param->m_I;
+    //! Sum the histograms computed on each chunk of the image
+    void reduce(unsigned int *histogram) const {
+      for(unsigned int cpt1 = 0; cpt1 < m_size; cpt1++) {
+        unsigned int sum = 0;
 
-    unsigned char *ptrStart = (unsigned char*) (I->bitmap) + start_index;
-    unsigned char *ptrEnd = (unsigned char*) (I->bitmap) + end_index;
-    unsigned char *ptrCurrent = ptrStart;
+        for(unsigned int cpt2 = 0; cpt2 < m_nbChunks; cpt2++) {
+          sum += m_histograms[cpt2*m_size + cpt1];
+        }
 
+        histogram[cpt1] = sum;
+      }
+    }
 
-//    while(ptrCurrent != ptrEnd) {
-//      histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-//      ++ptrCurrent;
-//    }
+  private:
+    void computeHistogram(const unsigned int start_index, const unsigned int end_index, unsigned int *histogram) const {
+      const unsigned char *ptrStart = (const unsigned char*) (m_I.bitmap) + start_index;
+      const unsigned char *ptrEnd = (const unsigned char*) (m_I.bitmap) + end_index;
+      const unsigned char *ptrCurrent = ptrStart;
 
-    if(end_index - start_index >= 8) {
-      //Unroll loop version
-      for(; ptrCurrent <= ptrEnd - 8;) {
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
+      if(end_index - start_index >= 8) {
+        //Unroll loop version
+        for(; ptrCurrent <= ptrEnd - 8;) {
+          histogram[ m_lut[ *ptrCurrent ] ] ++;
+          ++ptrCurrent;
 
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
+          histogram[ m_lut[ *ptrCurrent ] ] ++;
+          ++ptrCurrent;
 
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
+          histogram[ m_lut[ *ptrCurrent ] ] ++;
+          ++ptrCurrent;
 
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
+          histogram[ m_lut[ *ptrCurrent ] ] ++;
+          ++ptrCurrent;
 
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
+          histogram[ m_lut[ *ptrCurrent ] ] ++;
+          ++ptrCurrent;
 
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
+          histogram[ m_lut[ *ptrCurrent ] ] ++;
+          ++ptrCurrent;
 
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
+          histogram[ m_lut[ *ptrCurrent ] ] ++;
+          ++ptrCurrent;
 
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
+          histogram[ m_lut[ *ptrCurrent ] ] ++;
+          ++ptrCurrent;
+        }
       }
-    }
 
-    for(; ptrCurrent != ptrEnd; ++ptrCurrent) {
-      histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
+      for(; ptrCurrent != ptrEnd; ++ptrCurrent) {
+        histogram[ m_lut[ *ptrCurrent ] ] ++;
+      }
     }
 
-    return 0;
-  }
+    const vpImage<unsigned char> &m_I;
+    const unsigned int (&m_lut)[256];
+    unsigned int m_nbChunks;
+    unsigned int m_size;
+    std::vector<unsigned int> m_histograms;
+  };
 }
-#endif
 
 bool compare_vpHistogramPeak (vpHistogramPeak first, vpHistogramPeak second);
 
@@ -238,7 +237,8 @@ vpHistogram::init(unsigned size_)
 
   \param I : Gray level image.
   \param nbins : Number of bins to compute the histogram.
-  \param nbThreads : Number of threads to use for the computation.
+  \param nbThreads : Number of threads to use for the computation. The threads are taken from
+  vpThreadPool, so that their number is also bounded by vpThreadPool::getNumThreads().
 */
 void vpHistogram::calculate(const vpImage<unsigned char> &I, const unsigned int nbins, const unsigned int nbThreads)
 {
@@ -258,12 +258,7 @@ void vpHistogram::calculate(const vpImage<unsigned char> &I, const unsigned int
   memset(histogram, 0, size * sizeof(unsigned int));
 
 
-  bool use_single_thread;
-#if !defined(VISP_HAVE_PTHREAD) && !defined(_WIN32)
-  use_single_thread = true;
-#else
-  use_single_thread = (nbThreads == 0 || nbThreads == 1);
-#endif
+  bool use_single_thread = (nbThreads == 0 || nbThreads == 1);
 
   if(!use_single_thread && I.getSize() <= nbThreads) {
     use_single_thread = true;
@@ -288,60 +283,10 @@ void vpHistogram::calculate(const vpImage<unsigned char> &I, const unsigned int
       ++ptrCurrent;
     }
   } else {
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
-    //Multi-threads
-
-    std::vector<vpThread *> threadpool;
-    std::vector<Histogram_Param_t *> histogramParams;
-
-    unsigned int image_size = I.getSize();
-    unsigned int step = image_size / nbThreads;
-    unsigned int last_step = image_size - step * (nbThreads-1);
-
-    for(unsigned int index = 0; index < nbThreads; index++) {
-      unsigned int start_index = index*step;
-      unsigned int end_index = (index+1)*step;
-
-      if(index == nbThreads-1) {
-        end_index = start_index+last_step;
-      }
-
-      Histogram_Param_t *histogram_param = new Histogram_Param_t(start_index, end_index, &I);
-      histogram_param->m_histogram = new unsigned int[size];
-      memset(histogram_param->m_histogram, 0, size * sizeof(unsigned int));
-      memcpy(histogram_param->m_lut, lut, 256*sizeof(unsigned int));
-
-      histogramParams.push_back(histogram_param);
-
-      // Start the threads
-      vpThread *histogram_thread = new vpThread((vpThread::Fn) computeHistogramThread, (vpThread::Args) histogram_param);
-      threadpool.push_back(histogram_thread);
-    }
-
-    for(size_t cpt = 0; cpt < threadpool.size(); cpt++) {
-      // Wait until thread ends up
-      threadpool[cpt]->join();
-    }
-
-    for(unsigned int cpt1 = 0; cpt1 < size; cpt1++) {
-      unsigned int sum = 0;
-
-      for(size_t cpt2 = 0; cpt2 < histogramParams.size(); cpt2++) {
-        sum += histogramParams[cpt2]->m_histogram[cpt1];
-      }
-
-      histogram[cpt1] = sum;
-    }
-
-    //Delete
-    for(size_t cpt = 0; cpt < threadpool.size(); cpt++) {
-      delete threadpool[cpt];
-    }
-
-    for(size_t cpt = 0; cpt < histogramParams.size(); cpt++) {
-      delete histogramParams[cpt];
-    }
-#endif
+    //Multi-threads: one partial histogram per chunk of the image, computed by the thread pool
+    vpHistogramTask task(I, lut, nbThreads, size);
+    vpThreadPool::getInstance().parallelFor(0, nbThreads, task, 1, nbThreads);
+    task.reduce(histogram);
   }
 }
 
@@ -0,0 +1,543 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Process-wide pool of worker threads.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpThreadPool.cpp
+  \brief Definition of the vpThreadPool class member functions.
+*/
+
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpThreadPool.h>
+
+// std::exception_ptr keeps the dynamic type of the exceptions raised in the workers
+#if (__cplusplus >= 201103L) || (defined(_MSC_VER) && _MSC_VER >= 1600)
+#  define VP_THREAD_POOL_EXCEPTION_PTR
+#  include <exception>
+#endif
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+#  define VP_THREAD_POOL_OK
+#  include <visp3/core/vpThread.h>
+#endif
+
+#if defined(_WIN32)
+#  include <windows.h>
+#elif defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#  include <unistd.h>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+#ifdef VP_THREAD_POOL_OK
+  //! Native lock that can be associated to a condition variable.
+  class vpPoolLock
+  {
+  public:
+#if defined(VISP_HAVE_PTHREAD)
+    vpPoolLock() : m_mutex() { pthread_mutex_init(&m_mutex, NULL); }
+    ~vpPoolLock() { pthread_mutex_destroy(&m_mutex); }
+    void lock() { pthread_mutex_lock(&m_mutex); }
+    bool tryLock() { return pthread_mutex_trylock(&m_mutex) == 0; }
+    void unlock() { pthread_mutex_unlock(&m_mutex); }
+    pthread_mutex_t m_mutex;
+#else
+    vpPoolLock() : m_mutex() { InitializeCriticalSection(&m_mutex); }
+    ~vpPoolLock() { DeleteCriticalSection(&m_mutex); }
+    void lock() { EnterCriticalSection(&m_mutex); }
+    bool tryLock() { return TryEnterCriticalSection(&m_mutex) != 0; }
+    void unlock() { LeaveCriticalSection(&m_mutex); }
+    CRITICAL_SECTION m_mutex;
+#endif
+
+  private:
+    vpPoolLock(const vpPoolLock &);
+    vpPoolLock &operator=(const vpPoolLock &);
+  };
+
+  //! Condition variable associated to a vpPoolLock.
+  class vpPoolCondition
+  {
+  public:
+#if defined(VISP_HAVE_PTHREAD)
+    vpPoolCondition() : m_cond() { pthread_cond_init(&m_cond, NULL); }
+    ~vpPoolCondition() { pthread_cond_destroy(&m_cond); }
+    void wait(vpPoolLock &lock) { pthread_cond_wait(&m_cond, &lock.m_mutex); }
+    void broadcast() { pthread_cond_broadcast(&m_cond); }
+    pthread_cond_t m_cond;
+#else
+    vpPoolCondition() : m_cond() { InitializeConditionVariable(&m_cond); }
+    void wait(vpPoolLock &lock) { SleepConditionVariableCS(&m_cond, &lock.m_mutex, INFINITE); }
+    void broadcast() { WakeAllConditionVariable(&m_cond); }
+    CONDITION_VARIABLE m_cond;
+#endif
+
+  private:
+    vpPoolCondition(const vpPoolCondition &);
+    vpPoolCondition &operator=(const vpPoolCondition &);
+  };
+
+  /*!
+    Thread local storage of the index of the current thread in the pool. The stored
+    value is the index plus one while the thread executes a job, and 0 otherwise.
+   */
+  class vpPoolThreadIndex
+  {
+  public:
+#if defined(VISP_HAVE_PTHREAD)
+    vpPoolThreadIndex() : m_key() { pthread_key_create(&m_key, NULL); }
+    ~vpPoolThreadIndex() { pthread_key_delete(m_key); }
+    size_t get() const { return (size_t) pthread_getspecific(m_key); }
+    void set(size_t index) { pthread_setspecific(m_key, (void *) index); }
+    pthread_key_t m_key;
+#else
+    vpPoolThreadIndex() : m_key(TlsAlloc()) {}
+    ~vpPoolThreadIndex() { TlsFree(m_key); }
+    size_t get() const { return (size_t) TlsGetValue(m_key); }
+    void set(size_t index) { TlsSetValue(m_key, (LPVOID) index); }
+    DWORD m_key;
+#endif
+  };
+
+  //! Part of the range of a job owned by a thread, that others may steal.
+  struct vpPoolSlice
+  {
+    vpPoolSlice() : m_lock(), m_next(0), m_end(0) {}
+
+    vpPoolLock m_lock;
+    unsigned int m_next;
+    unsigned int m_end;
+  };
+#endif
+
+  //! Stores the first error raised by a task to rethrow it in the calling thread.
+  struct vpPoolError
+  {
+#ifdef VP_THREAD_POOL_EXCEPTION_PTR
+    vpPoolError() : m_failed(false), m_exception() {}
+
+    //! Keep the exception being handled.
+    void set()
+    {
+      if (!m_failed) {
+        m_failed = true;
+        m_exception = std::current_exception();
+      }
+    }
+
+    void rethrow() const { std::rethrow_exception(m_exception); }
+
+    bool m_failed;
+    std::exception_ptr m_exception;
+#else
+    vpPoolError() : m_failed(false), m_code(vpException::fatalError), m_message() {}
+
+    //! Keep the code and the message of the exception being handled, its type is lost.
+    void set()
+    {
+      if (m_failed)
+        return;
+      m_failed = true;
+      try {
+        throw;
+      }
+      catch (vpException &e) {
+        m_code = e.getCode();
+        m_message = e.getStringMessage();
+      }
+      catch (const std::exception &e) {
+        m_message = e.what();
+      }
+      catch (...) {
+        m_message = "Unknown exception raised by a vpThreadPool task";
+      }
+    }
+
+    void rethrow() const { throw vpException(m_code, m_message); }
+
+    bool m_failed;
+    int m_code;
+    std::string m_message;
+#endif
+  };
+}
+
+class vpThreadPool::Impl
+{
+public:
+#ifdef VP_THREAD_POOL_OK
+  struct Job
+  {
+    Job(vpThreadPool::Task &task, const unsigned int grainSize, const unsigned int nbParticipants)
+      : m_task(task), m_grainSize(grainSize), m_nbParticipants(nbParticipants),
+        m_slices(new vpPoolSlice[nbParticipants]), m_nbRunning(0), m_error()
+    {
+    }
+
+    ~Job()
+    {
+      delete [] m_slices;
+    }
+
+    vpThreadPool::Task &m_task;
+    unsigned int m_grainSize;
+    unsigned int m_nbParticipants;
+    vpPoolSlice *m_slices;
+    unsigned int m_nbRunning;
+    vpPoolError m_error;
+
+  private:
+    Job(const Job &);
+    Job &operator=(const Job &);
+  };
+
+  struct WorkerArgs
+  {
+    WorkerArgs() : m_impl(NULL), m_index(0) {}
+    Impl *m_impl;
+    unsigned int m_index;
+  };
+
+  Impl()
+    : m_submit(), m_lock(), m_cond(), m_threadIndex(), m_workers(), m_workerArgs(),
+      m_job(NULL), m_generation(0), m_stop(false)
+  {
+  }
+
+  ~Impl()
+  {
+    stopWorkers();
+  }
+
+  //! Start \e nbWorkers threads. Must be called with \e m_submit locked.
+  void startWorkers(const unsigned int nbWorkers)
+  {
+    if (m_workers.size() == nbWorkers)
+      return;
+
+    stopWorkers();
+
+    m_workerArgs.resize(nbWorkers);
+    for (unsigned int i = 0; i < nbWorkers; i++) {
+      m_workerArgs[i].m_impl = this;
+      m_workerArgs[i].m_index = i + 1; // 0 is the calling thread
+      m_workers.push_back(new vpThread((vpThread::Fn) workerMain, (vpThread::Args) &m_workerArgs[i]));
+    }
+  }
+
+  //! Stop and join the workers. Must be called with \e m_submit locked.
+  void stopWorkers()
+  {
+    m_lock.lock();
+    m_stop = true;
+    m_cond.broadcast();
+    m_lock.unlock();
+
+    for (size_t i = 0; i < m_workers.size(); i++) {
+      m_workers[i]->join();
+      delete m_workers[i];
+    }
+    m_workers.clear();
+    m_workerArgs.clear();
+
+    m_lock.lock();
+    m_stop = false;
+    m_lock.unlock();
+  }
+
+  //! Take the next chunk of indexes from the own slice or steal from another thread.
+  static bool nextChunk(Job &job, const unsigned int self, unsigned int &begin, unsigned int &end)
+  {
+    vpPoolSlice &own = job.m_slices[self];
+    for (;;) {
+      own.m_lock.lock();
+      if (own.m_next < own.m_end) {
+        begin = own.m_next;
+        end = (own.m_end - begin > job.m_grainSize) ? begin + job.m_grainSize : own.m_end;
+        own.m_next = end;
+        own.m_lock.unlock();
+        return true;
+      }
+      own.m_lock.unlock();
+
+      // Own slice is empty, steal half of the work of the first busy thread
+      bool stolen = false;
+      for (unsigned int k = 1; k < job.m_nbParticipants && !stolen; k++) {
+        vpPoolSlice &victim = job.m_slices[(self + k) % job.m_nbParticipants];
+        victim.m_lock.lock();
+        unsigned int remaining = victim.m_end - victim.m_next;
+        if (remaining > 0) {
+          unsigned int nb = remaining / 2;
+          if (nb < job.m_grainSize)
+            nb = (remaining < job.m_grainSize) ? remaining : job.m_grainSize;
+          begin = victim.m_end - nb;
+          end = victim.m_end;
+          victim.m_end = begin;
+          stolen = true;
+        }
+        victim.m_lock.unlock();
+      }
+
+      if (!stolen)
+        return false;
+
+      own.m_lock.lock();
+      own.m_next = begin;
+      own.m_end = end;
+      own.m_lock.unlock();
+    }
+  }
+
+  static void execute(Job &job, const unsigned int self)
+  {
+    unsigned int begin = 0, end = 0;
+    while (nextChunk(job, self, begin, end)) {
+      try {
+        job.m_task(begin, end);
+      }
+      catch (...) {
+        job.m_slices[0].m_lock.lock();
+        job.m_error.set();
+        job.m_slices[0].m_lock.unlock();
+      }
+    }
+  }
+
+  static vpThread::Return workerMain(vpThread::Args args)
+  {
+    WorkerArgs *workerArgs = static_cast<WorkerArgs *>(args);
+    Impl *impl = workerArgs->m_impl;
+    const unsigned int index = workerArgs->m_index;
+    impl->m_threadIndex.set(index + 1);
+
+    unsigned long long seen = 0;
+    impl->m_lock.lock();
+    for (;;) {
+      while (!impl->m_stop && (impl->m_job == NULL || impl->m_generation == seen)) {
+        impl->m_cond.wait(impl->m_lock);
+      }
+      if (impl->m_stop)
+        break;
+
+      seen = impl->m_generation;
+      Job *job = impl->m_job;
+      if (index >= job->m_nbParticipants)
+        continue;
+
+      impl->m_lock.unlock();
+      execute(*job, index);
+      impl->m_lock.lock();
+
+      if (--job->m_nbRunning == 0)
+        impl->m_cond.broadcast();
+    }
+    impl->m_lock.unlock();
+
+    return 0;
+  }
+
+  vpPoolLock m_submit; //!< Serializes the jobs submitted by different threads
+  vpPoolLock m_lock; //!< Protects m_job, m_generation, m_stop and Job::m_nbRunning
+  vpPoolCondition m_cond;
+  vpPoolThreadIndex m_threadIndex;
+  std::vector<vpThread *> m_workers;
+  std::vector<WorkerArgs> m_workerArgs;
+  Job *m_job;
+  unsigned long long m_generation;
+  bool m_stop;
+#endif
+};
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+vpThreadPool::vpThreadPool()
+  : m_impl(new Impl), m_nbThreads(getNumberOfCPU())
+{
+}
+
+vpThreadPool::~vpThreadPool()
+{
+  delete m_impl;
+}
+
+/*!
+  Return the unique instance of the pool. Worker threads are only created the first
+  time a job needs them.
+ */
+vpThreadPool &vpThreadPool::getInstance()
+{
+  static vpThreadPool pool;
+  return pool;
+}
+
+/*!
+  Return the number of logical cores of the computer, or 1 if it cannot be determined.
+ */
+unsigned int vpThreadPool::getNumberOfCPU()
+{
+#if defined(_WIN32)
+  SYSTEM_INFO sysinfo;
+#  if defined(WINRT)
+  GetNativeSystemInfo(&sysinfo);
+#  else
+  GetSystemInfo(&sysinfo);
+#  endif
+  return sysinfo.dwNumberOfProcessors > 0 ? (unsigned int) sysinfo.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+  long nb = sysconf(_SC_NPROCESSORS_ONLN);
+  return nb > 0 ? (unsigned int) nb : 1;
+#else
+  return 1;
+#endif
+}
+
+/*!
+  Return the index of the calling thread inside the job being executed, in the range
+  [0, getNumThreads()[. The thread that called parallelFor() has the index 0. This index
+  may be used by tasks to select a per-thread accumulator or scratch buffer.
+ */
+unsigned int vpThreadPool::getThreadIndex()
+{
+#ifdef VP_THREAD_POOL_OK
+  size_t index = getInstance().m_impl->m_threadIndex.get();
+  return index > 0 ? (unsigned int) (index - 1) : 0;
+#else
+  return 0;
+#endif
+}
+
+/*!
+  Set the maximum number of threads, including the calling thread, used to process a job.
+  This bounds the total number of threads that ViSP creates for its parallel algorithms.
+
+  \param nbThreads : Number of threads. If 0, the number of logical cores given by
+  getNumberOfCPU() is used. Setting 1 disables multi-threading.
+ */
+void vpThreadPool::setNumThreads(const unsigned int nbThreads)
+{
+  unsigned int nb = nbThreads == 0 ? getNumberOfCPU() : nbThreads;
+#ifdef VP_THREAD_POOL_OK
+  m_impl->m_submit.lock();
+  if (m_impl->m_workers.size() + 1 > nb) {
+    m_impl->startWorkers(nb - 1);
+  }
+  m_nbThreads = nb;
+  m_impl->m_submit.unlock();
+#else
+  m_nbThreads = nb;
+#endif
+}
+
+/*!
+  Process the range [\e begin, \e end) with \e task using the threads of the pool.
+  The function returns when all the indexes have been processed.
+
+  \param begin, end : Range of indexes to process.
+  \param task : Task called on sub-ranges of [\e begin, \e end).
+  \param grainSize : Maximum number of indexes given to the task in one call. Small values
+  improve the load balancing, large ones reduce the scheduling overhead.
+  \param nbThreads : Maximum number of threads used for this job. If 0 or greater than
+  getNumThreads(), getNumThreads() threads are used.
+
+  \exception vpException : If the task raised an exception in one of the threads, the first
+  one is rethrown in the calling thread after all the threads have completed. With a C++11
+  compiler the exception keeps its type (vpMatrixException, std::bad_alloc...), otherwise a
+  vpException with the same code and message is thrown.
+ */
+void vpThreadPool::parallelFor(const unsigned int begin, const unsigned int end, Task &task,
+                               const unsigned int grainSize, const unsigned int nbThreads)
+{
+  if (end <= begin)
+    return;
+
+  unsigned int grain = grainSize > 0 ? grainSize : 1;
+  unsigned int nbChunks = (end - begin + grain - 1) / grain;
+  unsigned int nbParticipants = (nbThreads == 0 || nbThreads > m_nbThreads) ? m_nbThreads : nbThreads;
+  if (nbParticipants > nbChunks)
+    nbParticipants = nbChunks;
+
+#ifdef VP_THREAD_POOL_OK
+  // Workers and callers already running a job process nested ranges sequentially
+  if (nbParticipants > 1 && m_impl->m_threadIndex.get() == 0 && m_impl->m_submit.tryLock()) {
+    // The number of threads may have been changed before the lock was acquired
+    if (nbParticipants > m_nbThreads)
+      nbParticipants = m_nbThreads;
+
+    if (nbParticipants > 1) {
+      Impl::Job job(task, grain, nbParticipants);
+      unsigned int size = end - begin;
+      for (unsigned int i = 0; i < nbParticipants; i++) {
+        job.m_slices[i].m_next = begin + (unsigned int) (((unsigned long long) size * i) / nbParticipants);
+        job.m_slices[i].m_end = begin + (unsigned int) (((unsigned long long) size * (i + 1)) / nbParticipants);
+      }
+      job.m_nbRunning = nbParticipants - 1;
+
+      try {
+        m_impl->startWorkers(m_nbThreads - 1);
+      }
+      catch (...) {
+        m_impl->m_submit.unlock();
+        throw;
+      }
+
+      m_impl->m_lock.lock();
+      m_impl->m_job = &job;
+      m_impl->m_generation++;
+      m_impl->m_cond.broadcast();
+      m_impl->m_lock.unlock();
+
+      // Mark the calling thread as busy so that nested jobs run sequentially
+      m_impl->m_threadIndex.set(1);
+      Impl::execute(job, 0);
+      m_impl->m_threadIndex.set(0);
+
+      m_impl->m_lock.lock();
+      while (job.m_nbRunning > 0) {
+        m_impl->m_cond.wait(m_impl->m_lock);
+      }
+      m_impl->m_job = NULL;
+      m_impl->m_lock.unlock();
+      m_impl->m_submit.unlock();
+
+      if (job.m_error.m_failed) {
+        job.m_error.rethrow();
+      }
+      return;
+    }
+    m_impl->m_submit.unlock();
+  }
+#endif
+
+  task(begin, end);
+}
@@ -0,0 +1,213 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the aligned and recycled memory of vpImage.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testImageBufferPool.cpp
+
+  \brief Test the alignment and the recycling of the vpImage memory, and the
+  images with padded rows created by vpImage::initAligned().
+*/
+
+#include <iostream>
+#include <stdlib.h>
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImageTools.h>
+#include <visp3/core/vpTime.h>
+
+namespace {
+  bool isAligned(const void *ptr, const size_t alignment)
+  {
+    return ((size_t) ptr) % alignment == 0;
+  }
+
+  template <class Type>
+  bool checkImage(const vpImage<Type> &I, const vpImage<Type> &Iref, const std::string &name)
+  {
+    if (I.getHeight() != Iref.getHeight() || I.getWidth() != Iref.getWidth()) {
+      std::cerr << name << ": bad size" << std::endl;
+      return false;
+    }
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        if (I[i][j] != Iref[i][j] || I(i, j) != Iref[i][j]) {
+          std::cerr << name << ": bad value at (" << i << ", " << j << ")" << std::endl;
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    vpImageBufferPool &pool = vpImageBufferPool::getInstance();
+    pool.clear();
+
+    // Alignment and recycling of the memory
+    const unsigned char *bitmap = NULL;
+    {
+      vpImage<unsigned char> I(479, 641);
+      if (! isAligned(I.bitmap, vpImageBufferPool::getAlignment()) || ! I.isContiguous()) {
+        std::cerr << "The bitmap is not aligned" << std::endl;
+        return EXIT_FAILURE;
+      }
+      bitmap = I.bitmap;
+    }
+    if (pool.getCachedSize() != 479*641) {
+      std::cerr << "The memory of the image was not given back to the pool: "
+                << pool.getCachedSize() << std::endl;
+      return EXIT_FAILURE;
+    }
+    {
+      vpImage<unsigned char> I(641, 479);
+      if (I.bitmap != bitmap || pool.getCachedSize() != 0) {
+        std::cerr << "The memory of the image was not recycled" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Padded rows
+    vpImage<unsigned char> Iref(37, 101);
+    for (unsigned int i = 0; i < Iref.getSize(); i++)
+      Iref.bitmap[i] = (unsigned char) rand();
+
+    vpImage<unsigned char> Ia;
+    Ia.initAligned(Iref.getHeight(), Iref.getWidth());
+    if (Ia.getStride() != 128 || Ia.isContiguous()) {
+      std::cerr << "Bad stride: " << Ia.getStride() << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i < Ia.getHeight(); i++) {
+      if (! isAligned(Ia[i], 64)) {
+        std::cerr << "Row " << i << " is not aligned" << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (unsigned int j = 0; j < Ia.getWidth(); j++)
+        Ia(i, j, Iref[i][j]);
+    }
+    if (! checkImage(Ia, Iref, "initAligned()"))
+      return EXIT_FAILURE;
+
+    vpImage<unsigned char> Icopy(Ia);
+    if (! Icopy.isContiguous() || ! checkImage(Icopy, Iref, "copy constructor"))
+      return EXIT_FAILURE;
+    Icopy = 0;
+    Icopy = Ia;
+    if (! Icopy.isContiguous() || ! checkImage(Icopy, Iref, "operator=") || ! (Icopy == Ia) || Ia != Iref)
+      return EXIT_FAILURE;
+
+    unsigned char min, max;
+    Ia.getMinMaxValue(min, max);
+    if (min != Iref.getMinValue() || max != Iref.getMaxValue() || Ia.getMinValue() != min || Ia.getMaxValue() != max) {
+      std::cerr << "Bad min / max values" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    vpImage<unsigned char> Isub;
+    Ia.sub(Ia, Iref, Isub);
+    if (Isub.getMaxValue() != 0) {
+      std::cerr << "Bad difference" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    vpImage<unsigned char> Iflip, Iflip_ref;
+    vpImageTools::flip(Iref, Iflip_ref);
+    vpImageTools::flip(Ia, Iflip);
+    vpImageTools::flip(Ia);
+    if (! checkImage(Iflip, Iflip_ref, "flip()") || ! checkImage(Ia, Iflip_ref, "in place flip()"))
+      return EXIT_FAILURE;
+
+    unsigned char lut[256];
+    for (unsigned int i = 0; i < 256; i++)
+      lut[i] = (unsigned char) (255 - i);
+    vpImage<unsigned char> Ilut = Iflip_ref;
+    Ilut.performLut(lut);
+    Ia.performLut(lut, 4);
+    if (! checkImage(Ia, Ilut, "performLut()"))
+      return EXIT_FAILURE;
+
+    vpImage<vpRGBa> Ic;
+    Ic.initAligned(5, 7, 32);
+    if (Ic.getStride() != 8 || ! isAligned(Ic[3], 32)) {
+      std::cerr << "Bad stride of the color image: " << Ic.getStride() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    unsigned int nbExceptions = 0;
+    try {
+      Ic.initAligned(5, 7, 2);
+    }
+    catch(const vpException &) {
+      nbExceptions++;
+    }
+    try {
+      Ic.initAligned(5, 7, 48);
+    }
+    catch(const vpException &) {
+      nbExceptions++;
+    }
+    if (nbExceptions != 2) {
+      std::cerr << "Invalid alignments were accepted" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Temporary images created for each frame
+    const unsigned int nb_iter = 200;
+    vpImage<vpRGBa> Iframe(1080, 1920);
+    double t_pool = 0.0, t_system = 0.0;
+    for (unsigned int k = 0; k < 2; k++) {
+      pool.setCapacity(k == 0 ? 256 << 20 : 0);
+      double t = vpTime::measureTimeMs();
+      for (unsigned int iter = 0; iter < nb_iter; iter++) {
+        vpImage<vpRGBa> Itmp(Iframe);
+        Itmp[iter][iter] = vpRGBa(255);
+      }
+      (k == 0 ? t_pool : t_system) = vpTime::measureTimeMs() - t;
+    }
+    pool.setCapacity(256 << 20);
+    std::cout << nb_iter << " copies of a 1920x1080 color image:" << std::endl;
+    std::cout << "  recycled memory:  " << t_pool << " ms" << std::endl;
+    std::cout << "  system allocator: " << t_system << " ms" << std::endl;
+
+    std::cout << "testImageBufferPool is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
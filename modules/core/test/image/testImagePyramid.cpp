@@ -0,0 +1,198 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test vpImagePyramid and vpImageFilter::getGaussPyramidal().
+ *
+ *****************************************************************************/
+
+/*!
+  \example testImagePyramid.cpp
+
+  \brief Check the levels of vpImagePyramid, that they are reused from one
+  image to the next one, and time vpImageFilter::getGaussPyramidal().
+*/
+
+#include <iostream>
+#include <stdlib.h>
+
+#include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpImagePyramid.h>
+#include <visp3/core/vpTime.h>
+
+namespace {
+  void randomImage(vpImage<unsigned char> &I)
+  {
+    for (unsigned int i = 0; i < I.getSize(); i++)
+      I.bitmap[i] = (unsigned char)(rand() % 256);
+  }
+
+  bool equal(const vpImage<unsigned char> &a, const vpImage<unsigned char> &b)
+  {
+    if (a.getHeight() != b.getHeight() || a.getWidth() != b.getWidth())
+      return false;
+    for (unsigned int i = 0; i < a.getSize(); i++) {
+      if (a.bitmap[i] != b.bitmap[i])
+        return false;
+    }
+    return true;
+  }
+
+  //! Decimation used by vpMbEdgeTracker before vpImagePyramid
+  void refSubsample(const vpImage<unsigned char> &I, vpImage<unsigned char> &Isub, const unsigned int scale)
+  {
+    Isub.resize(I.getHeight() / scale, I.getWidth() / scale);
+    for (unsigned int k = 0, ii = 0; k < Isub.getHeight(); k++, ii += scale)
+      for (unsigned int l = 0, jj = 0; l < Isub.getWidth(); l++, jj += scale)
+        Isub[k][l] = I[ii][jj];
+  }
+
+  void refGaussPyramidal(const vpImage<unsigned char> &I, vpImage<unsigned char> &GI)
+  {
+    vpImage<unsigned char> GIx;
+    vpImageFilter::getGaussXPyramidal(I, GIx);
+    vpImageFilter::getGaussYPyramidal(GIx, GI);
+  }
+}
+
+int main()
+{
+  try {
+    srand(0);
+
+#if !defined(VISP_HAVE_OPENCV)
+    // Same result as the per pixel filters, on odd sizes
+    const unsigned int sizes[][2] = { {4, 4}, {5, 7}, {33, 17}, {66, 35}, {641, 479} };
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+      vpImage<unsigned char> I(sizes[s][1], sizes[s][0]), GI, GI_ref;
+      randomImage(I);
+      refGaussPyramidal(I, GI_ref);
+      vpImageFilter::getGaussPyramidal(I, GI);
+      if (! equal(GI, GI_ref)) {
+        std::cerr << "getGaussPyramidal differs on a " << sizes[s][0] << "x" << sizes[s][1] << " image" << std::endl;
+        return EXIT_FAILURE;
+      }
+      vpImageFilter::getGaussPyramidal(I, I);
+      if (! equal(I, GI_ref)) {
+        std::cerr << "In place getGaussPyramidal differs" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+#endif
+
+    vpImage<unsigned char> I(1080, 1920), I2(1080, 1920), Iref, Itmp;
+    randomImage(I);
+    randomImage(I2);
+
+    // Gaussian pyramid: each level from the previous one
+    vpImagePyramid pyramid(4);
+    if (pyramid.isBuilt() || pyramid.getGeneration() != 0)
+      return EXIT_FAILURE;
+    pyramid.build(I);
+    if (&pyramid[0] != &I || pyramid.getGeneration() != 1) {
+      std::cerr << "Bad first level" << std::endl;
+      return EXIT_FAILURE;
+    }
+    Iref = I;
+    for (unsigned int l = 1; l < 4; l++) {
+      vpImageFilter::getGaussPyramidal(Iref, Itmp);
+      Iref = Itmp;
+      if (! equal(pyramid[l], Iref)) {
+        std::cerr << "Bad Gaussian level " << l << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // The levels are reused for the next image of the same size
+    const unsigned char *bitmap = pyramid[3].bitmap;
+    pyramid.build(I2);
+    if (pyramid[3].bitmap != bitmap || pyramid.getGeneration() != 2) {
+      std::cerr << "The levels were reallocated" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Subsampling: the same levels as the former decimation of vpMbEdgeTracker
+    pyramid.setReductionType(vpImagePyramid::SUBSAMPLING_REDUCTION);
+    pyramid.build(I);
+    for (unsigned int l = 1; l < 4; l++) {
+      refSubsample(I, Iref, 1u << l);
+      if (! equal(pyramid[l], Iref)) {
+        std::cerr << "Bad subsampled level " << l << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Access to a missing level, and to a pyramid that is not built
+    unsigned int nbExceptions = 0;
+    try {
+      pyramid[4];
+    }
+    catch(const vpImageException &) {
+      nbExceptions++;
+    }
+    pyramid.clear();
+    try {
+      pyramid[0];
+    }
+    catch(const vpImageException &) {
+      nbExceptions++;
+    }
+    if (nbExceptions != 2 || pyramid.isBuilt()) {
+      std::cerr << "Missing exception" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Timings
+    const unsigned int nb_iter = 20;
+    double t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      refGaussPyramidal(I, Iref);
+    const double t_ref = vpTime::measureTimeMs() - t;
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageFilter::getGaussPyramidal(I, Itmp);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "getGaussPyramidal (1920x1080): per pixel filters " << t_ref / nb_iter << " ms ; "
+              << t / nb_iter << " ms (speed-up x" << t_ref / t << ")" << std::endl;
+
+    pyramid.setReductionType(vpImagePyramid::GAUSSIAN_REDUCTION);
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      pyramid.build(I);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "4 levels Gaussian pyramid (1920x1080): " << t / nb_iter << " ms" << std::endl;
+
+    std::cout << "testImagePyramid is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
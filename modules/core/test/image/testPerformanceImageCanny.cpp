@@ -0,0 +1,255 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the Canny edge detector of vpImageFilter.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceImageCanny.cpp
+
+  \brief Check the edges found by the native Canny edge detector on a
+  synthetic image, and time it against the OpenCV one when ViSP is built with
+  OpenCV.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+
+#include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+
+namespace {
+  //! Synthetic scene: a rectangle and a disc on a noisy background
+  struct vpScene {
+    double r0, r1, c0, c1; // rectangle
+    double ci, cj, radius; // disc
+  };
+
+  void drawScene(const vpScene &s, vpImage<unsigned char> &I)
+  {
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        int v = 40;
+        if (i >= s.r0 && i < s.r1 && j >= s.c0 && j < s.c1)
+          v = 200;
+        else if (sqrt(vpMath::sqr(i - s.ci) + vpMath::sqr(j - s.cj)) < s.radius)
+          v = 140;
+        I[i][j] = (unsigned char)(v + rand() % 7 - 3);
+      }
+    }
+  }
+
+  //! Distance of a pixel to the closest contour of the scene
+  double contourDistance(const vpScene &s, const double i, const double j)
+  {
+    // The contours are between the last pixel inside and the first one outside
+    const double top = s.r0 - 0.5, bottom = s.r1 - 0.5, left = s.c0 - 0.5, right = s.c1 - 0.5;
+    double dRect;
+    if (i > top && i < bottom && j > left && j < right)
+      dRect = (std::min)((std::min)(i - top, bottom - i), (std::min)(j - left, right - j));
+    else {
+      const double di = (std::max)((std::max)(top - i, i - bottom), 0.0);
+      const double dj = (std::max)((std::max)(left - j, j - right), 0.0);
+      dRect = sqrt(di*di + dj*dj);
+    }
+    const double dDisc = std::fabs(sqrt(vpMath::sqr(i - s.ci) + vpMath::sqr(j - s.cj)) - s.radius);
+    return (std::min)(dRect, dDisc);
+  }
+
+  bool checkEdges(const std::string &name, const vpScene &s, const vpImage<unsigned char> &E)
+  {
+    // No edge far from the contours
+    for (unsigned int i = 0; i < E.getHeight(); i++) {
+      for (unsigned int j = 0; j < E.getWidth(); j++) {
+        if (E[i][j] == 255 && contourDistance(s, i, j) > 1.5) {
+          std::cerr << name << ": unexpected edge at (" << i << ", " << j << ")" << std::endl;
+          return false;
+        }
+        if (E[i][j] != 0 && E[i][j] != 255) {
+          std::cerr << name << ": bad value " << (int)E[i][j] << std::endl;
+          return false;
+        }
+      }
+    }
+
+    // The sides of the rectangle are found, with edges of one pixel wide
+    unsigned int nbFound = 0, nbSamples = 0;
+    for (unsigned int j = (unsigned int)s.c0 + 3; j + 3 < (unsigned int)s.c1; j++) {
+      const unsigned int rows[2] = { (unsigned int)s.r0, (unsigned int)s.r1 };
+      for (unsigned int k = 0; k < 2; k++) {
+        unsigned int nb = 0;
+        for (unsigned int i = rows[k] - 3; i < rows[k] + 3; i++)
+          nb += (E[i][j] == 255) ? 1 : 0;
+        if (nb > 1) {
+          std::cerr << name << ": edge of " << nb << " pixels at column " << j << std::endl;
+          return false;
+        }
+        nbFound += nb;
+        nbSamples++;
+      }
+    }
+    if (nbFound < 0.95 * nbSamples) {
+      std::cerr << name << ": only " << nbFound << " edge pixels on " << nbSamples << " along the rectangle" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  bool equal(const vpImage<unsigned char> &a, const vpImage<unsigned char> &b)
+  {
+    if (a.getHeight() != b.getHeight() || a.getWidth() != b.getWidth())
+      return false;
+    for (unsigned int i = 0; i < a.getSize(); i++) {
+      if (a.bitmap[i] != b.bitmap[i])
+        return false;
+    }
+    return true;
+  }
+
+  //! Check that all the edges of a are edges of b
+  bool included(const vpImage<unsigned char> &a, const vpImage<unsigned char> &b)
+  {
+    for (unsigned int i = 0; i < a.getSize(); i++) {
+      if (a.bitmap[i] == 255 && b.bitmap[i] != 255)
+        return false;
+    }
+    return true;
+  }
+
+  bool testScene(const unsigned int width, const unsigned int height, const unsigned int nb_iter)
+  {
+    vpScene s;
+    s.r0 = 0.2 * height; s.r1 = 0.6 * height; s.c0 = 0.1 * width; s.c1 = 0.45 * width;
+    s.ci = 0.5 * height; s.cj = 0.72 * width; s.radius = 0.2 * (std::min)(width, height);
+    vpImage<unsigned char> I(height, width), E, E2;
+    drawScene(s, I);
+
+    const unsigned int gaussianSizes[] = { 3, 5, 7 };
+    const unsigned int apertures[] = { 3, 5, 7 };
+    for (unsigned int g = 0; g < 3; g++) {
+      for (unsigned int a = 0; a < 3; a++) {
+        // Thresholds in the unit of the unnormalized Sobel derivatives
+        const double scale = (a == 0) ? 1 : ((a == 1) ? 16 : 256);
+        vpImageFilter::canny(I, E, gaussianSizes[g], 50 * scale, 100 * scale, apertures[a]);
+        if (! checkEdges("canny", s, E))
+          return false;
+      }
+    }
+
+    // Hysteresis: more edges with a lower first threshold, but not more than with a single low threshold
+    vpImage<unsigned char> E_high, E_low;
+    vpImageFilter::canny(I, E, 5, 20, 100, 3);
+    vpImageFilter::canny(I, E_high, 5, 100, 100, 3);
+    vpImageFilter::canny(I, E_low, 5, 20, 20, 3);
+    if (! included(E_high, E) || ! included(E, E_low)) {
+      std::cerr << "Bad hysteresis" << std::endl;
+      return false;
+    }
+
+    // No edge above the largest gradient
+    vpImageFilter::canny(I, E2, 5, 1e6, 1e6, 3);
+    for (unsigned int i = 0; i < E2.getSize(); i++) {
+      if (E2.bitmap[i] != 0) {
+        std::cerr << "Unexpected edge with a high threshold" << std::endl;
+        return false;
+      }
+    }
+
+    // In place
+    E2 = I;
+    vpImageFilter::canny(E2, E2, 5, 20, 100, 3);
+    if (! equal(E, E2)) {
+      std::cerr << "In place Canny differs" << std::endl;
+      return false;
+    }
+
+    // Same edges whatever the number of threads
+    vpThreadPool &pool = vpThreadPool::getInstance();
+    const unsigned int nbThreads = pool.getNumThreads();
+    pool.setNumThreads(4);
+    vpImageFilter::canny(I, E2, 5, 20, 100, 3);
+    pool.setNumThreads(nbThreads);
+    if (! equal(E, E2)) {
+      std::cerr << "Multi-threaded Canny differs" << std::endl;
+      return false;
+    }
+
+    double t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageFilter::canny(I, E, 5, 20, 100, 3, vpImageFilter::CANNY_VISP_BACKEND);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Canny (" << width << "x" << height << "): ViSP " << t / nb_iter << " ms" << std::endl;
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+    double t_cv = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageFilter::canny(I, E2, 5, 20, 100, 3, vpImageFilter::CANNY_OPENCV_BACKEND);
+    t_cv = vpTime::measureTimeMs() - t_cv;
+
+    // Share of the OpenCV edges that have a ViSP edge in their 3x3 neighborhood
+    unsigned int nbCv = 0, nbCommon = 0;
+    for (unsigned int i = 1; i + 1 < height; i++) {
+      for (unsigned int j = 1; j + 1 < width; j++) {
+        if (E2[i][j] != 255)
+          continue;
+        nbCv++;
+        bool found = false;
+        for (unsigned int k = i - 1; k <= i + 1; k++)
+          for (unsigned int l = j - 1; l <= j + 1; l++)
+            found = found || E[k][l] == 255;
+        nbCommon += found ? 1 : 0;
+      }
+    }
+    std::cout << "  OpenCV " << t_cv / nb_iter << " ms ; " << 100.0 * nbCommon / (std::max)(nbCv, 1u)
+              << "% of the OpenCV edges found" << std::endl;
+#endif
+
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    srand(0);
+    if (! testScene(64, 48, 1) || ! testScene(641, 479, 10) || ! testScene(1920, 1080, 5))
+      return EXIT_FAILURE;
+
+    std::cout << "testPerformanceImageCanny is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,287 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Benchmark the color conversions of vpImageConvert.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceImageConvert.cpp
+
+  \brief Compare the color conversions of vpImageConvert with the per pixel
+  code they replace, on a 1080p frame and on odd sizes, and time them.
+*/
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+
+namespace {
+  unsigned char saturate(const int c)
+  {
+    return (unsigned char)(c < 0 ? 0 : (c > 255 ? 255 : c));
+  }
+
+  // Per pixel conversions that were used before the vectorized kernels
+  void refColorToGrey(const unsigned char *src, unsigned char *grey, const unsigned int size,
+                      const unsigned int step, const bool bgr)
+  {
+    for (unsigned int i = 0; i < size; i++, src += step) {
+      const unsigned char r = bgr ? src[2] : src[0];
+      const unsigned char b = bgr ? src[0] : src[2];
+      grey[i] = (unsigned char)(0.2126 * r + 0.7152 * src[1] + 0.0722 * b);
+    }
+  }
+
+  void refYUYVToRGBa(const unsigned char *yuyv, unsigned char *rgba, const unsigned int size)
+  {
+    for (unsigned int c = size / 2; c > 0; c--, yuyv += 4, rgba += 8) {
+      const int cb = ((yuyv[1] - 128) * 454) >> 8;
+      const int cr = ((yuyv[3] - 128) * 359) >> 8;
+      const int cg = ((yuyv[1] - 128) * 88 + (yuyv[3] - 128) * 183) >> 8;
+      for (unsigned int k = 0; k < 2; k++) {
+        const int y = yuyv[2*k];
+        rgba[4*k]     = saturate(y + cr);
+        rgba[4*k + 1] = saturate(y - cg);
+        rgba[4*k + 2] = saturate(y + cb);
+        rgba[4*k + 3] = vpRGBa::alpha_default;
+      }
+    }
+  }
+
+  void refYUV422ToGrey(const unsigned char *yuv, unsigned char *grey, const unsigned int size,
+                       const unsigned int offset)
+  {
+    for (unsigned int i = 0; i < size; i++)
+      grey[i] = yuv[2*i + offset];
+  }
+
+  void refYUV420ToRGBa(const unsigned char *yuv, unsigned char *rgba, const unsigned int width,
+                       const unsigned int height)
+  {
+    const unsigned int size = width * height;
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        const unsigned int c = (i/2)*(width/2) + j/2;
+        const int U = (int)((yuv[size + c] - 128) * 0.354);
+        const int V = (int)((yuv[5*size/4 + c] - 128) * 0.707);
+        const int Y = yuv[i*width + j];
+        unsigned char *p = rgba + 4*(i*width + j);
+        p[0] = saturate(Y + 2*V);
+        p[1] = saturate(Y - U - V);
+        p[2] = saturate(Y + 5*U);
+        p[3] = vpRGBa::alpha_default;
+      }
+    }
+  }
+
+  std::vector<unsigned char> randomBuffer(const unsigned int size)
+  {
+    std::vector<unsigned char> buffer(size);
+    for (unsigned int i = 0; i < size; i++)
+      buffer[i] = (unsigned char)(rand() % 256);
+    return buffer;
+  }
+
+  //! Check that the buffers do not differ by more than tolerance
+  bool compare(const std::string &name, const std::vector<unsigned char> &a, const std::vector<unsigned char> &b,
+               const int tolerance)
+  {
+    for (size_t i = 0; i < a.size(); i++) {
+      if (std::abs((int)a[i] - (int)b[i]) > tolerance) {
+        std::cerr << name << ": difference at " << i << ", " << (int)a[i] << " instead of " << (int)b[i] << std::endl;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void print(const std::string &name, const unsigned int width, const unsigned int height, const double t_ref,
+             const double t, const unsigned int nb_iter)
+  {
+    std::cout << name << " (" << width << "x" << height << "): reference " << t_ref / nb_iter
+              << " ms ; vpImageConvert " << t / nb_iter << " ms (speed-up x" << t_ref / t << ")" << std::endl;
+  }
+
+  bool testSize(const unsigned int width, const unsigned int height, const unsigned int nb_iter)
+  {
+    const unsigned int size = width * height;
+    std::vector<unsigned char> rgba = randomBuffer(4*size), rgb = randomBuffer(3*size), yuv422 = randomBuffer(2*size);
+    std::vector<unsigned char> yuv420 = randomBuffer(size + 2*(width/2)*(height/2));
+    std::vector<unsigned char> grey_ref(size), grey(size), rgba_ref(4*size), rgba_out(4*size);
+    double t, t_ref;
+
+    // RGBa to grey, within +/-1 of the double precision formula
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      refColorToGrey(&rgba[0], &grey_ref[0], size, 4, false);
+    t_ref = vpTime::measureTimeMs() - t;
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageConvert::RGBaToGrey(&rgba[0], &grey[0], size);
+    t = vpTime::measureTimeMs() - t;
+    if (! compare("RGBaToGrey", grey, grey_ref, 1))
+      return false;
+    print("RGBaToGrey", width, height, t_ref, t, nb_iter);
+
+    // RGB to grey
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      refColorToGrey(&rgb[0], &grey_ref[0], size, 3, false);
+    t_ref = vpTime::measureTimeMs() - t;
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageConvert::RGBToGrey(&rgb[0], &grey[0], size);
+    t = vpTime::measureTimeMs() - t;
+    if (! compare("RGBToGrey", grey, grey_ref, 1))
+      return false;
+    print("RGBToGrey", width, height, t_ref, t, nb_iter);
+
+    // BGR to grey, with and without flip
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      refColorToGrey(&rgb[0], &grey_ref[0], size, 3, true);
+    t_ref = vpTime::measureTimeMs() - t;
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageConvert::BGRToGrey(&rgb[0], &grey[0], width, height, false);
+    t = vpTime::measureTimeMs() - t;
+    if (! compare("BGRToGrey", grey, grey_ref, 1))
+      return false;
+    print("BGRToGrey", width, height, t_ref, t, nb_iter);
+
+    vpImageConvert::BGRToGrey(&rgb[0], &grey[0], width, height, true);
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        if (std::abs((int)grey[i*width + j] - (int)grey_ref[(height - 1 - i)*width + j]) > 1) {
+          std::cerr << "BGRToGrey: bad flipped image" << std::endl;
+          return false;
+        }
+      }
+    }
+
+    // RGBa to grey through vpImage
+    vpImage<vpRGBa> I_rgba(height, width);
+    memcpy((unsigned char *)I_rgba.bitmap, &rgba[0], 4*size);
+    vpImage<unsigned char> I_grey;
+    vpImageConvert::convert(I_rgba, I_grey);
+    refColorToGrey(&rgba[0], &grey_ref[0], size, 4, false);
+    if (! compare("convert(vpImage<vpRGBa>)", std::vector<unsigned char>(I_grey.bitmap, I_grey.bitmap + size), grey_ref, 1))
+      return false;
+
+    // YUYV and UYVY to grey, bit exact
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      refYUV422ToGrey(&yuv422[0], &grey_ref[0], size, 0);
+    t_ref = vpTime::measureTimeMs() - t;
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageConvert::YUYVToGrey(&yuv422[0], &grey[0], size);
+    t = vpTime::measureTimeMs() - t;
+    if (! compare("YUYVToGrey", grey, grey_ref, 0))
+      return false;
+    print("YUYVToGrey", width, height, t_ref, t, nb_iter);
+
+    refYUV422ToGrey(&yuv422[0], &grey_ref[0], size, 1);
+    vpImageConvert::YUV422ToGrey(&yuv422[0], &grey[0], size);
+    if (! compare("YUV422ToGrey", grey, grey_ref, 0))
+      return false;
+
+    // YUYV to RGBa, bit exact
+    if (width % 2 == 0) {
+      t = vpTime::measureTimeMs();
+      for (unsigned int iter = 0; iter < nb_iter; iter++)
+        refYUYVToRGBa(&yuv422[0], &rgba_ref[0], size);
+      t_ref = vpTime::measureTimeMs() - t;
+      t = vpTime::measureTimeMs();
+      for (unsigned int iter = 0; iter < nb_iter; iter++)
+        vpImageConvert::YUYVToRGBa(&yuv422[0], &rgba_out[0], width, height);
+      t = vpTime::measureTimeMs() - t;
+      if (! compare("YUYVToRGBa", rgba_out, rgba_ref, 0))
+        return false;
+      print("YUYVToRGBa", width, height, t_ref, t, nb_iter);
+    }
+
+    // YUV420 to RGBa, bit exact
+    if (width % 2 == 0 && height % 2 == 0) {
+      t = vpTime::measureTimeMs();
+      for (unsigned int iter = 0; iter < nb_iter; iter++)
+        refYUV420ToRGBa(&yuv420[0], &rgba_ref[0], width, height);
+      t_ref = vpTime::measureTimeMs() - t;
+      t = vpTime::measureTimeMs();
+      for (unsigned int iter = 0; iter < nb_iter; iter++)
+        vpImageConvert::YUV420ToRGBa(&yuv420[0], &rgba_out[0], width, height);
+      t = vpTime::measureTimeMs() - t;
+      if (! compare("YUV420ToRGBa", rgba_out, rgba_ref, 0))
+        return false;
+      print("YUV420ToRGBa", width, height, t_ref, t, nb_iter);
+    }
+
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    srand(0);
+    // Odd sizes exercise the scalar tails of the vectorized loops
+    const unsigned int sizes[][2] = { {1, 1}, {7, 3}, {33, 17}, {66, 35}, {641, 479} };
+    for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+      if (! testSize(sizes[i][0], sizes[i][1], 1))
+        return EXIT_FAILURE;
+    }
+
+    // 1080p frame, above the threshold of the multi-threaded conversions
+    vpThreadPool &pool = vpThreadPool::getInstance();
+    const unsigned int nbThreads = pool.getNumThreads();
+    std::cout << "Single thread:" << std::endl;
+    pool.setNumThreads(1);
+    if (! testSize(1920, 1080, 10))
+      return EXIT_FAILURE;
+    std::cout << "4 threads:" << std::endl;
+    pool.setNumThreads(4);
+    if (! testSize(1920, 1080, 10))
+      return EXIT_FAILURE;
+    pool.setNumThreads(nbThreads);
+
+    std::cout << "testPerformanceImageConvert is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,301 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Benchmark the separable filters of vpImageFilter.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceImageFilter.cpp
+
+  \brief Compare the separable filters of vpImageFilter with the per pixel
+  code they replace, on a 1080p image and on odd sizes, and time them.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+
+namespace {
+  // Per pixel filters that were used before the row based implementation
+  template<class T>
+  void refFilterX(const vpImage<T> &I, vpImage<double> &dIx, const double *filter, const unsigned int size)
+  {
+    const unsigned int h = (size-1)/2;
+    dIx.resize(I.getHeight(), I.getWidth());
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        if (j < h)
+          dIx[i][j] = vpImageFilter::filterXLeftBorder(I, i, j, filter, size);
+        else if (j >= I.getWidth() - h)
+          dIx[i][j] = vpImageFilter::filterXRightBorder(I, i, j, filter, size);
+        else
+          dIx[i][j] = vpImageFilter::filterX(I, i, j, filter, size);
+      }
+    }
+  }
+
+  template<class T>
+  void refFilterY(const vpImage<T> &I, vpImage<double> &dIy, const double *filter, const unsigned int size)
+  {
+    const unsigned int h = (size-1)/2;
+    dIy.resize(I.getHeight(), I.getWidth());
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        if (i < h)
+          dIy[i][j] = vpImageFilter::filterYTopBorder(I, i, j, filter, size);
+        else if (i >= I.getHeight() - h)
+          dIy[i][j] = vpImageFilter::filterYBottomBorder(I, i, j, filter, size);
+        else
+          dIy[i][j] = vpImageFilter::filterY(I, i, j, filter, size);
+      }
+    }
+  }
+
+  template<class T>
+  void refGradX(const vpImage<T> &I, vpImage<double> &dIx, const double *filter, const unsigned int size)
+  {
+    const unsigned int h = (size-1)/2;
+    dIx.resize(I.getHeight(), I.getWidth(), 0.);
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = h; j + h < I.getWidth(); j++)
+        dIx[i][j] = vpImageFilter::derivativeFilterX(I, i, j, filter, size);
+    }
+  }
+
+  template<class T>
+  void refGradY(const vpImage<T> &I, vpImage<double> &dIy, const double *filter, const unsigned int size)
+  {
+    const unsigned int h = (size-1)/2;
+    dIy.resize(I.getHeight(), I.getWidth(), 0.);
+    for (unsigned int i = h; i + h < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++)
+        dIy[i][j] = vpImageFilter::derivativeFilterY(I, i, j, filter, size);
+    }
+  }
+
+  void refFilter(const vpImage<unsigned char> &I, vpImage<double> &GI, const double *filter, const unsigned int size)
+  {
+    vpImage<double> GIx;
+    refFilterX(I, GIx, filter, size);
+    refFilterY(GIx, GI, filter, size);
+  }
+
+  //! Check that the images do not differ by more than tolerance (relative to the magnitude of b)
+  template<class T1, class T2>
+  bool compare(const std::string &name, const vpImage<T1> &a, const vpImage<T2> &b, const double tolerance)
+  {
+    if (a.getHeight() != b.getHeight() || a.getWidth() != b.getWidth()) {
+      std::cerr << name << ": bad size" << std::endl;
+      return false;
+    }
+    for (unsigned int i = 0; i < a.getSize(); i++) {
+      const double va = (double)a.bitmap[i], vb = (double)b.bitmap[i];
+      if (std::fabs(va - vb) > tolerance * (1.0 + std::fabs(vb))) {
+        std::cerr << name << ": difference at " << i << ", " << va << " instead of " << vb << std::endl;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void print(const std::string &name, const unsigned int width, const unsigned int height, const double t_ref,
+             const double t, const unsigned int nb_iter)
+  {
+    std::cout << name << " (" << width << "x" << height << "): reference " << t_ref / nb_iter
+              << " ms ; vpImageFilter " << t / nb_iter << " ms (speed-up x" << t_ref / t << ")" << std::endl;
+  }
+
+  bool testSize(const unsigned int width, const unsigned int height, const unsigned int size,
+                const unsigned int nb_iter)
+  {
+    vpImage<unsigned char> I(height, width);
+    for (unsigned int i = 0; i < I.getSize(); i++)
+      I.bitmap[i] = (unsigned char)(rand() % 256);
+
+    std::vector<double> fg((size+1)/2), fd((size+1)/2);
+    std::vector<float> fgf((size+1)/2), fdf((size+1)/2);
+    vpImageFilter::getGaussianKernel(&fg[0], size);
+    vpImageFilter::getGaussianDerivativeKernel(&fd[0], size);
+    vpImageFilter::getGaussianKernel(&fgf[0], size);
+    vpImageFilter::getGaussianDerivativeKernel(&fdf[0], size);
+
+    vpImage<double> G_ref, G, Gtmp, Gtmp2;
+    vpImage<float> Gf;
+    vpImage<unsigned char> Gu;
+    double t, t_ref;
+
+    // Separable smoothing, identical in double precision
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      refFilter(I, G_ref, &fg[0], size);
+    t_ref = vpTime::measureTimeMs() - t;
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageFilter::gaussianBlur(I, G, size);
+    t = vpTime::measureTimeMs() - t;
+    if (! compare("gaussianBlur(double)", G, G_ref, 0.))
+      return false;
+    print("gaussianBlur(double)", width, height, t_ref, t, nb_iter);
+
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageFilter::gaussianBlur(I, Gf, size);
+    t = vpTime::measureTimeMs() - t;
+    if (! compare("gaussianBlur(float)", Gf, G_ref, 1e-5))
+      return false;
+    print("gaussianBlur(float)", width, height, t_ref, t, nb_iter);
+
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageFilter::gaussianBlur(I, Gu, size);
+    t = vpTime::measureTimeMs() - t;
+    for (unsigned int i = 0; i < Gu.getSize(); i++) {
+      if (std::fabs(Gu.bitmap[i] - G_ref.bitmap[i]) > 1.0) {
+        std::cerr << "gaussianBlur(unsigned char): difference at " << i << ", " << (int)Gu.bitmap[i]
+                  << " instead of " << G_ref.bitmap[i] << std::endl;
+        return false;
+      }
+    }
+    print("gaussianBlur(unsigned char)", width, height, t_ref, t, nb_iter);
+
+    vpImage<double> Id;
+    vpImageConvert::convert(I, Id);
+    refFilter(I, G_ref, &fg[0], size);
+    vpImageFilter::filter(Id, G, &fg[0], size);
+    if (! compare("filter(vpImage<double>)", G, G_ref, 0.))
+      return false;
+
+    // One direction filters
+    refFilterX(I, G_ref, &fg[0], size);
+    vpImageFilter::filterX(I, G, &fg[0], size);
+    if (! compare("filterX", G, G_ref, 0.))
+      return false;
+    refFilterY(Id, G_ref, &fg[0], size);
+    vpImageFilter::filterY(Id, G, &fg[0], size);
+    if (! compare("filterY", G, G_ref, 0.))
+      return false;
+
+    // Derivatives
+    refGradX(I, G_ref, &fd[0], size);
+    vpImageFilter::getGradX(I, G, &fd[0], size);
+    if (! compare("getGradX", G, G_ref, 0.))
+      return false;
+    vpImageFilter::getGradX(I, Gf, &fdf[0], size);
+    if (! compare("getGradX(float)", Gf, G_ref, 1e-4))
+      return false;
+    refGradY(Id, G_ref, &fd[0], size);
+    vpImageFilter::getGradY(Id, G, &fd[0], size);
+    if (! compare("getGradY", G, G_ref, 0.))
+      return false;
+    vpImageFilter::getGradY(I, Gf, &fdf[0], size);
+    if (! compare("getGradY(float)", Gf, G_ref, 1e-4))
+      return false;
+
+    // Gaussian smoothing followed by a derivative
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++) {
+      refFilterY(I, Gtmp, &fg[0], size);
+      refGradX(Gtmp, G_ref, &fd[0], size);
+    }
+    t_ref = vpTime::measureTimeMs() - t;
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageFilter::getGradXGauss2D(I, G, &fg[0], &fd[0], size);
+    t = vpTime::measureTimeMs() - t;
+    if (! compare("getGradXGauss2D", G, G_ref, 0.))
+      return false;
+    print("getGradXGauss2D(double)", width, height, t_ref, t, nb_iter);
+
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageFilter::getGradXGauss2D(I, Gf, &fgf[0], &fdf[0], size);
+    t = vpTime::measureTimeMs() - t;
+    if (! compare("getGradXGauss2D(float)", Gf, G_ref, 1e-4))
+      return false;
+    print("getGradXGauss2D(float)", width, height, t_ref, t, nb_iter);
+
+    refFilterX(I, Gtmp2, &fg[0], size);
+    refGradY(Gtmp2, G_ref, &fd[0], size);
+    vpImageFilter::getGradYGauss2D(I, G, &fg[0], &fd[0], size);
+    if (! compare("getGradYGauss2D", G, G_ref, 0.))
+      return false;
+    vpImageFilter::getGradYGauss2D(I, Gf, &fgf[0], &fdf[0], size);
+    if (! compare("getGradYGauss2D(float)", Gf, G_ref, 1e-4))
+      return false;
+
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    srand(0);
+    // Odd sizes exercise the scalar tails of the vectorized loops. The per pixel
+    // border code reads out of the image when it is smaller than the kernel.
+    const unsigned int sizes[][2] = { {7, 7}, {9, 5}, {33, 17}, {66, 35}, {641, 479} };
+    const unsigned int kernels[] = { 3, 5, 7, 9 };
+    for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+      for (unsigned int k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        if (sizes[i][0] < kernels[k] || sizes[i][1] < kernels[k])
+          continue;
+        if (! testSize(sizes[i][0], sizes[i][1], kernels[k], 1))
+          return EXIT_FAILURE;
+      }
+    }
+
+    // 1080p image, above the threshold of the multi-threaded filters
+    vpThreadPool &pool = vpThreadPool::getInstance();
+    const unsigned int nbThreads = pool.getNumThreads();
+    std::cout << "Single thread:" << std::endl;
+    pool.setNumThreads(1);
+    if (! testSize(1920, 1080, 7, 5))
+      return EXIT_FAILURE;
+    std::cout << "4 threads:" << std::endl;
+    pool.setNumThreads(4);
+    if (! testSize(1920, 1080, 7, 5))
+      return EXIT_FAILURE;
+    pool.setNumThreads(nbThreads);
+
+    std::cout << "testPerformanceImageFilter is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
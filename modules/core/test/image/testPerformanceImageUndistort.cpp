@@ -0,0 +1,222 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the undistortion remap tables.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceImageUndistort.cpp
+
+  \brief Check the images undistorted with vpImageUndistortMap against a double
+  precision bilinear interpolation, and time them against
+  vpImageTools::undistort() on VGA and 1080p images.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+
+#include <visp3/core/vpImageTools.h>
+#include <visp3/core/vpImageUndistortMap.h>
+#include <visp3/core/vpTime.h>
+
+namespace {
+  //! Smooth pattern with some noise, so that the interpolation error stays small
+  void drawPattern(vpImage<unsigned char> &I)
+  {
+    for (unsigned int i = 0; i < I.getHeight(); i++)
+      for (unsigned int j = 0; j < I.getWidth(); j++)
+        I[i][j] = (unsigned char)(127.5 + 100 * sin(0.05 * i) * cos(0.07 * j) + rand() % 21 - 10);
+  }
+
+  //! Undistortion in double precision with the conventions of vpImageUndistortMap
+  double reference(const vpImage<unsigned char> &I, const vpCameraParameters &cam, const unsigned int u,
+                   const unsigned int v)
+  {
+    const double du = u - cam.get_u0(), dv = v - cam.get_v0();
+    const double r2 = vpMath::sqr(du / cam.get_px()) + vpMath::sqr(dv / cam.get_py());
+    const double ud = cam.get_u0() + du * (1 + cam.get_kud() * r2);
+    const double vd = cam.get_v0() + dv * (1 + cam.get_kud() * r2);
+    const double uf = std::floor(ud), vf = std::floor(vd);
+    if (uf < 0 || vf < 0 || uf >= I.getWidth() - 1 || vf >= I.getHeight() - 1)
+      return 0;
+    const unsigned int i = (unsigned int)vf, j = (unsigned int)uf;
+    const double a = ud - uf, b = vd - vf;
+    return (1 - b) * ((1 - a) * I[i][j] + a * I[i][j + 1]) + b * ((1 - a) * I[i + 1][j] + a * I[i + 1][j + 1]);
+  }
+
+  template <class Type>
+  bool equal(const vpImage<Type> &a, const vpImage<Type> &b)
+  {
+    if (a.getHeight() != b.getHeight() || a.getWidth() != b.getWidth())
+      return false;
+    for (unsigned int i = 0; i < a.getHeight(); i++)
+      for (unsigned int j = 0; j < a.getWidth(); j++)
+        if (a[i][j] != b[i][j])
+          return false;
+    return true;
+  }
+
+  bool testSize(const unsigned int width, const unsigned int height, const unsigned int nb_iter)
+  {
+    // Barrel distortion of a wide angle lens
+    vpCameraParameters cam(0.9 * width, 0.9 * width, 0.5 * width + 3.2, 0.5 * height - 2.7, -0.25, 0.3);
+    vpImage<unsigned char> I(height, width), Iundist, Iundist2;
+    drawPattern(I);
+
+    vpImageUndistortMap map(cam, width, height);
+    map.remap(I, Iundist, 1);
+
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        if (std::fabs(Iundist[i][j] - reference(I, cam, j, i)) > 2.0) {
+          std::cerr << "Bad undistorted value at (" << i << ", " << j << "): " << (int)Iundist[i][j]
+                    << " instead of " << reference(I, cam, j, i) << std::endl;
+          return false;
+        }
+      }
+    }
+
+    // Same result whatever the number of threads, with padded rows and in place
+    map.remap(I, Iundist2, 4);
+    if (! equal(Iundist, Iundist2)) {
+      std::cerr << "Multi-threaded undistortion differs" << std::endl;
+      return false;
+    }
+    vpImage<unsigned char> Ia;
+    Ia.initAligned(height, width);
+    for (unsigned int i = 0; i < height; i++)
+      for (unsigned int j = 0; j < width; j++)
+        Ia[i][j] = I[i][j];
+    map.remap(Ia, Iundist2);
+    if (! equal(Iundist, Iundist2)) {
+      std::cerr << "Undistortion of an image with padded rows differs" << std::endl;
+      return false;
+    }
+    map.remap(Ia, Ia);
+    if (! equal(Iundist, Ia)) {
+      std::cerr << "In place undistortion differs" << std::endl;
+      return false;
+    }
+
+    // Color images: each channel as the grey level image
+    vpImage<vpRGBa> Ic(height, width), Icundist;
+    for (unsigned int k = 0; k < I.getSize(); k++)
+      Ic.bitmap[k] = vpRGBa(I.bitmap[k], (unsigned char)(255 - I.bitmap[k]), I.bitmap[k], 255);
+    map.remap(Ic, Icundist);
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        const vpRGBa &c = Icundist[i][j];
+        // The rounding of the inverted channel may differ by one
+        const bool outside = (c.A == 0);
+        if (c.R != Iundist[i][j] || c.B != Iundist[i][j] ||
+            (! outside && (std::abs(c.G + Iundist[i][j] - 255) > 1 || c.A != 255))) {
+          std::cerr << "Bad undistorted color at (" << i << ", " << j << ")" << std::endl;
+          return false;
+        }
+      }
+    }
+
+    // Close to vpImageTools::undistort() that truncates the interpolations
+    vpImageTools::undistort(I, cam, Iundist2, 1);
+    double meanDiff = 0;
+    for (unsigned int k = 0; k < I.getSize(); k++)
+      meanDiff += std::fabs((double)Iundist.bitmap[k] - Iundist2.bitmap[k]);
+    meanDiff /= I.getSize();
+    if (meanDiff > 1.0) {
+      std::cerr << "Mean difference with vpImageTools::undistort(): " << meanDiff << std::endl;
+      return false;
+    }
+
+    // Benchmark
+    double t_undistort = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageTools::undistort(I, cam, Iundist2);
+    t_undistort = (vpTime::measureTimeMs() - t_undistort) / nb_iter;
+    double t_map = vpTime::measureTimeMs();
+    vpImageUndistortMap map2(cam, width, height);
+    t_map = vpTime::measureTimeMs() - t_map;
+    double t_remap = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      map2.remap(I, Iundist);
+    t_remap = (vpTime::measureTimeMs() - t_remap) / nb_iter;
+
+    double t_undistort_color = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      vpImageTools::undistort(Ic, cam, Icundist);
+    t_undistort_color = (vpTime::measureTimeMs() - t_undistort_color) / nb_iter;
+    double t_remap_color = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      map2.remap(Ic, Icundist);
+    t_remap_color = (vpTime::measureTimeMs() - t_remap_color) / nb_iter;
+
+    std::cout << "Undistortion (" << width << "x" << height << "), tables computed in " << t_map << " ms" << std::endl;
+    std::cout << "  grey:  vpImageTools::undistort() " << t_undistort << " ms ; vpImageUndistortMap::remap() "
+              << t_remap << " ms" << std::endl;
+    std::cout << "  color: vpImageTools::undistort() " << t_undistort_color << " ms ; vpImageUndistortMap::remap() "
+              << t_remap_color << " ms" << std::endl;
+
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    srand(0);
+
+    // Without distortion the image is copied
+    vpImage<unsigned char> I(5, 7, 12), Iundist;
+    vpImageUndistortMap map(vpCameraParameters(600, 600, 3, 2), 7, 5);
+    map.remap(I, Iundist);
+    if (! map.isIdentity() || ! equal(I, Iundist)) {
+      std::cerr << "Bad undistortion without distortion" << std::endl;
+      return EXIT_FAILURE;
+    }
+    try {
+      map.remap(vpImage<unsigned char>(5, 8), Iundist);
+      std::cerr << "An image of a bad size was undistorted" << std::endl;
+      return EXIT_FAILURE;
+    }
+    catch(const vpException &) {
+    }
+
+    if (! testSize(37, 29, 1) || ! testSize(640, 480, 20) || ! testSize(1920, 1080, 10))
+      return EXIT_FAILURE;
+
+    std::cout << "testPerformanceImageUndistort is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
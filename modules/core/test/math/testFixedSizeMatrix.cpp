@@ -0,0 +1,176 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the fixed size matrices and vectors used for poses and twists.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testFixedSizeMatrix.cpp
+
+  \brief Test the storage and the products of the fixed size matrices and vectors
+  (vpHomogeneousMatrix, vpRotationMatrix, vpVelocityTwistMatrix, vpTranslationVector)
+  and compare their timing with the generic vpMatrix product.
+*/
+
+#include <iostream>
+#include <stdlib.h>
+
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpMatrix.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpVelocityTwistMatrix.h>
+
+namespace {
+  //! Check that the elements are stored inside the object and not on the heap.
+  bool isEmbedded(const vpArray2D<double> &A, const size_t objectSize) {
+    const char *begin = reinterpret_cast<const char *>(&A);
+    const char *elts = reinterpret_cast<const char *>(A.data);
+    return elts >= begin && elts + A.size()*sizeof(double) <= begin + objectSize;
+  }
+
+  bool equal(const vpArray2D<double> &A, const vpMatrix &B, const double epsilon=1e-12) {
+    if (A.getRows() != B.getRows() || A.getCols() != B.getCols())
+      return false;
+    for (unsigned int i = 0; i < A.getRows(); i++) {
+      for (unsigned int j = 0; j < A.getCols(); j++) {
+        if (! vpMath::equal(A[i][j], B[i][j], epsilon)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  vpMatrix toMatrix(const vpArray2D<double> &A) {
+    vpMatrix M(A.getRows(), A.getCols());
+    for (unsigned int i = 0; i < A.getRows(); i++)
+      for (unsigned int j = 0; j < A.getCols(); j++)
+        M[i][j] = A[i][j];
+    return M;
+  }
+}
+
+int main()
+{
+  try {
+    vpHomogeneousMatrix M1(0.1, -0.2, 0.3, vpMath::rad(10), vpMath::rad(-20), vpMath::rad(30));
+    vpHomogeneousMatrix M2(-0.4, 0.5, 1.2, vpMath::rad(-5), vpMath::rad(40), vpMath::rad(15));
+    vpHomogeneousMatrix M3(M1);
+    vpRotationMatrix R1(M1), R2(M2);
+    vpTranslationVector t1(M1), t2(M2);
+    vpVelocityTwistMatrix V1(M1), V2(M2);
+
+    if (! isEmbedded(M1, sizeof(M1)) || ! isEmbedded(M3, sizeof(M3)) || ! isEmbedded(R1, sizeof(R1))
+        || ! isEmbedded(t1, sizeof(t1)) || ! isEmbedded(V1, sizeof(V1))) {
+      std::cerr << "Fixed size elements are not embedded in the objects" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Products should be the same than the generic ones
+    if (! equal(M1 * M2, toMatrix(M1) * toMatrix(M2))) {
+      std::cerr << "Bad vpHomogeneousMatrix product" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (! equal(M1.inverse(), toMatrix(M1).inverseByLU(), 1e-9)) {
+      std::cerr << "Bad vpHomogeneousMatrix inverse" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (! equal(R1 * R2, toMatrix(R1) * toMatrix(R2))) {
+      std::cerr << "Bad vpRotationMatrix product" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (! equal(R1 * t2, toMatrix(R1) * toMatrix(t2))) {
+      std::cerr << "Bad vpRotationMatrix by vpTranslationVector product" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (! equal(V1 * V2, toMatrix(V1) * toMatrix(V2))) {
+      std::cerr << "Bad vpVelocityTwistMatrix product" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Copies and assignments should not share the storage
+    M3 = M2;
+    M3[0][3] = 10.;
+    if (vpMath::equal(M2[0][3], 10., 1e-12) || ! isEmbedded(M3, sizeof(M3))) {
+      std::cerr << "Bad vpHomogeneousMatrix assignment" << std::endl;
+      return EXIT_FAILURE;
+    }
+    vpTranslationVector t3(t1);
+    t3[0] = 10.;
+    if (vpMath::equal(t1[0], 10., 1e-12)) {
+      std::cerr << "Bad vpTranslationVector copy" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Fixed size arrays cannot be resized
+    bool exception_raised = false;
+    try {
+      vpArray2D<double> &A = M1;
+      A.resize(3, 3);
+    }
+    catch(const vpException &) {
+      exception_raised = true;
+    }
+    if (! exception_raised) {
+      std::cerr << "Resizing a fixed size array should raise an exception" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Micro benchmark: pose composition and inversion as done in the trackers
+    const unsigned int nb_iter = 100000;
+    vpMatrix A1 = toMatrix(M1), A2 = toMatrix(M2), A3;
+    double t = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < nb_iter; i++) {
+      A3 = A1 * A2;
+      A3 = A3 * A1;
+    }
+    double t_matrix = vpTime::measureTimeMs() - t;
+
+    t = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < nb_iter; i++) {
+      M3 = M1 * M2;
+      M3 = M3 * M1.inverse();
+    }
+    double t_homogeneous = vpTime::measureTimeMs() - t;
+
+    std::cout << nb_iter << " iterations of 2 products:" << std::endl;
+    std::cout << "  vpMatrix (heap allocated):                " << t_matrix << " ms" << std::endl;
+    std::cout << "  vpHomogeneousMatrix (with an inverse too): " << t_homogeneous << " ms" << std::endl;
+
+    std::cout << "testFixedSizeMatrix is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
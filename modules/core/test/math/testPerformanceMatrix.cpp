@@ -0,0 +1,296 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Benchmark the matrix products.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceMatrix.cpp
+
+  \brief Compare the blocked matrix products of vpMatrix with naive loops
+  for several matrix shapes, and check that the results are the same.
+*/
+
+#include <iostream>
+#include <stdlib.h>
+#include <cmath>
+#include <sstream>
+
+#include <visp3/core/vpGEMM.h>
+#include <visp3/core/vpGEMMKernel.h>
+#include <visp3/core/vpMatrix.h>
+#include <visp3/core/vpTime.h>
+
+namespace {
+  // Triple loops that were used before the blocked kernels
+  void naiveMult(const vpMatrix &A, const vpMatrix &B, vpMatrix &C)
+  {
+    C.resize(A.getRows(), B.getCols(), false);
+    for (unsigned int i = 0; i < A.getRows(); i++) {
+      for (unsigned int j = 0; j < B.getCols(); j++) {
+        double s = 0;
+        for (unsigned int k = 0; k < B.getRows(); k++)
+          s += A[i][k] * B[k][j];
+        C[i][j] = s;
+      }
+    }
+  }
+
+  void naiveAtA(const vpMatrix &A, vpMatrix &B)
+  {
+    B.resize(A.getCols(), A.getCols(), false);
+    for (unsigned int i = 0; i < A.getCols(); i++) {
+      for (unsigned int j = 0; j <= i; j++) {
+        double s = 0;
+        for (unsigned int k = 0; k < A.getRows(); k++)
+          s += A[k][i] * A[k][j];
+        B[i][j] = B[j][i] = s;
+      }
+    }
+  }
+
+  void naiveAAt(const vpMatrix &A, vpMatrix &B)
+  {
+    B.resize(A.getRows(), A.getRows(), false);
+    for (unsigned int i = 0; i < A.getRows(); i++) {
+      for (unsigned int j = i; j < A.getRows(); j++) {
+        double s = 0;
+        for (unsigned int k = 0; k < A.getCols(); k++)
+          s += A[i][k] * A[j][k];
+        B[i][j] = B[j][i] = s;
+      }
+    }
+  }
+
+  void naiveMultVector(const vpMatrix &A, const vpColVector &v, vpColVector &w)
+  {
+    w.resize(A.getRows());
+    for (unsigned int j = 0; j < A.getCols(); j++) {
+      double vj = v[j];
+      for (unsigned int i = 0; i < A.getRows(); i++)
+        w[i] += A[i][j] * vj;
+    }
+  }
+
+  vpMatrix randomMatrix(const unsigned int rows, const unsigned int cols)
+  {
+    vpMatrix M(rows, cols);
+    for (unsigned int i = 0; i < M.size(); i++)
+      M.data[i] = (double)rand() / RAND_MAX - 0.5;
+    return M;
+  }
+
+  /*
+    With an inner dimension that fits in one block (256) the kernels sum in the same
+    order as the loops above, so the results must be bit-identical (epsilon = 0).
+  */
+  bool equal(const vpArray2D<double> &A, const vpArray2D<double> &B, const double epsilon=1e-10)
+  {
+    if (A.getRows() != B.getRows() || A.getCols() != B.getCols())
+      return false;
+    double max = 0.0, diff = 0.0;
+    for (unsigned int i = 0; i < A.size(); i++) {
+      max = (std::max)(max, std::fabs(A.data[i]));
+      diff = (std::max)(diff, std::fabs(A.data[i] - B.data[i]));
+    }
+    return diff <= epsilon * (1.0 + max);
+  }
+
+  void print(const std::string &name, const double t_naive, const double t_blocked, const double t_vect)
+  {
+    std::cout << name << ": naive " << t_naive << " ms ; blocked scalar " << t_blocked
+              << " ms ; blocked " << vpGEMMKernel::getInstructionSet() << " " << t_vect
+              << " ms (speed-up x" << t_naive / t_vect << ")" << std::endl;
+  }
+
+  bool benchMult(const unsigned int m, const unsigned int k, const unsigned int n, const unsigned int nb_iter)
+  {
+    vpMatrix A = randomMatrix(m, k), B = randomMatrix(k, n), C_ref, C;
+    double t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      naiveMult(A, B, C_ref);
+    double t_naive = vpTime::measureTimeMs() - t;
+
+    double t_mode[2];
+    for (int mode = 0; mode < 2; mode++) {
+      vpGEMMKernel::setVectorization(mode == 1);
+      t = vpTime::measureTimeMs();
+      for (unsigned int iter = 0; iter < nb_iter; iter++)
+        vpMatrix::mult2Matrices(A, B, C);
+      t_mode[mode] = vpTime::measureTimeMs() - t;
+      if (! equal(C, C_ref, k <= 256 ? 0.0 : 1e-10)) {
+        std::cerr << "Bad product of (" << m << "x" << k << ") by (" << k << "x" << n << ")" << std::endl;
+        return false;
+      }
+    }
+    std::stringstream ss;
+    ss << "(" << m << "x" << k << ")*(" << k << "x" << n << ") x" << nb_iter;
+    print(ss.str(), t_naive, t_mode[0], t_mode[1]);
+    return true;
+  }
+
+  bool benchAtA(const unsigned int m, const unsigned int n, const unsigned int nb_iter)
+  {
+    vpMatrix A = randomMatrix(m, n), B_ref, B;
+    double t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      naiveAtA(A, B_ref);
+    double t_naive = vpTime::measureTimeMs() - t;
+
+    double t_mode[2];
+    for (int mode = 0; mode < 2; mode++) {
+      vpGEMMKernel::setVectorization(mode == 1);
+      t = vpTime::measureTimeMs();
+      for (unsigned int iter = 0; iter < nb_iter; iter++)
+        A.AtA(B);
+      t_mode[mode] = vpTime::measureTimeMs() - t;
+      if (! equal(B, B_ref, n <= 8 ? 0.0 : 1e-10)) {
+        std::cerr << "Bad AtA of (" << m << "x" << n << ")" << std::endl;
+        return false;
+      }
+    }
+    std::stringstream ss;
+    ss << "AtA (" << m << "x" << n << ") x" << nb_iter;
+    print(ss.str(), t_naive, t_mode[0], t_mode[1]);
+    return true;
+  }
+
+  bool benchAAt(const unsigned int m, const unsigned int n, const unsigned int nb_iter)
+  {
+    vpMatrix A = randomMatrix(m, n), B_ref, B;
+    double t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++)
+      naiveAAt(A, B_ref);
+    double t_naive = vpTime::measureTimeMs() - t;
+
+    double t_mode[2];
+    for (int mode = 0; mode < 2; mode++) {
+      vpGEMMKernel::setVectorization(mode == 1);
+      t = vpTime::measureTimeMs();
+      for (unsigned int iter = 0; iter < nb_iter; iter++)
+        A.AAt(B);
+      t_mode[mode] = vpTime::measureTimeMs() - t;
+      if (! equal(B, B_ref, n <= 256 ? 0.0 : 1e-10)) {
+        std::cerr << "Bad AAt of (" << m << "x" << n << ")" << std::endl;
+        return false;
+      }
+    }
+    std::stringstream ss;
+    ss << "AAt (" << m << "x" << n << ") x" << nb_iter;
+    print(ss.str(), t_naive, t_mode[0], t_mode[1]);
+    return true;
+  }
+
+  bool benchMultVector(const unsigned int m, const unsigned int n, const unsigned int nb_iter)
+  {
+    vpMatrix A = randomMatrix(m, n);
+    vpColVector v = randomMatrix(n, 1).getCol(0), w_ref, w;
+    double t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++) {
+      w_ref = 0.0;
+      naiveMultVector(A, v, w_ref);
+    }
+    double t_naive = vpTime::measureTimeMs() - t;
+
+    double t_mode[2];
+    for (int mode = 0; mode < 2; mode++) {
+      vpGEMMKernel::setVectorization(mode == 1);
+      t = vpTime::measureTimeMs();
+      for (unsigned int iter = 0; iter < nb_iter; iter++)
+        vpMatrix::multMatrixVector(A, v, w);
+      t_mode[mode] = vpTime::measureTimeMs() - t;
+      if (! equal(w, w_ref, 0.0)) {
+        std::cerr << "Bad product of (" << m << "x" << n << ") by a vector" << std::endl;
+        return false;
+      }
+    }
+    std::stringstream ss;
+    ss << "(" << m << "x" << n << ")*v x" << nb_iter;
+    print(ss.str(), t_naive, t_mode[0], t_mode[1]);
+    return true;
+  }
+
+  bool testGEMM()
+  {
+    // All the combinations of transpositions, with non square matrices
+    vpMatrix A = randomMatrix(7, 5), B = randomMatrix(5, 9), C = randomMatrix(7, 9);
+    vpMatrix AB_ref;
+    naiveMult(A, B, AB_ref);
+    for (unsigned int ops = 0; ops < 8; ops++) {
+      vpMatrix Aop = (ops & VP_GEMM_A_T) ? A.t() : A;
+      vpMatrix Bop = (ops & VP_GEMM_B_T) ? B.t() : B;
+      vpMatrix Cop = (ops & VP_GEMM_C_T) ? C.t() : C;
+      vpMatrix D, D_null;
+      vpGEMM(Aop, Bop, 2.0, Cop, -3.0, D, ops);
+      vpGEMM(Aop, Bop, 2.0, null, 0.0, D_null, ops);
+      if (! equal(D, AB_ref * 2.0 - C * 3.0) || ! equal(D_null, AB_ref * 2.0)) {
+        std::cerr << "Bad vpGEMM with operations " << ops << std::endl;
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    srand(0);
+    std::cout << "Instruction set: " << vpGEMMKernel::getInstructionSet() << std::endl;
+
+    if (! testGEMM())
+      return EXIT_FAILURE;
+
+    // Small matrices
+    if (! benchMult(6, 6, 6, 20000)) return EXIT_FAILURE;
+    // Interaction matrix by twist
+    if (! benchMultVector(20000, 6, 200)) return EXIT_FAILURE;
+    // Interaction matrix products used in the VVS loops
+    if (! benchAtA(20000, 6, 200)) return EXIT_FAILURE;
+    if (! benchMult(6, 20000, 6, 200)) return EXIT_FAILURE;
+    // Square and rectangular matrices
+    if (! benchMult(256, 256, 256, 5)) return EXIT_FAILURE;
+    if (! benchMult(500, 100, 300, 5)) return EXIT_FAILURE;
+    if (! benchMultVector(1000, 1000, 100)) return EXIT_FAILURE;
+    // Rows and columns left over by the 8 rows SIMD matrix by vector kernels
+    if (! benchMultVector(1003, 7, 1000)) return EXIT_FAILURE;
+    if (! benchMultVector(15, 1001, 1000)) return EXIT_FAILURE;
+    if (! benchAAt(300, 400, 5)) return EXIT_FAILURE;
+
+    vpGEMMKernel::setVectorization(true);
+    std::cout << "testPerformanceMatrix is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
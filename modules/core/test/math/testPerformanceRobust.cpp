@@ -0,0 +1,164 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the M-estimator.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceRobust.cpp
+
+  \brief Check that the weights computed by vpRobust::MEstimator() are the ones
+  given by the median absolute deviation computed with a full sort, and measure
+  the time spent to compute the weights of many residues.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpRobust.h>
+#include <visp3/core/vpTime.h>
+
+namespace {
+  const double noise_threshold = 0.0017;
+
+  //! Median as computed by vpRobust, with a full sort
+  double median(std::vector<double> v)
+  {
+    std::sort(v.begin(), v.end());
+    return v[(size_t)(ceil(v.size() / 2.0)) - 1];
+  }
+
+  //! Reference weights, computed from the residues with a null weight excluded from the median
+  void referenceWeights(const vpRobust::vpRobustEstimatorType method, const vpColVector &residues,
+                        const vpColVector &all_residues, vpColVector &weights)
+  {
+    std::vector<double> kept;
+    for (unsigned int i = 0; i < residues.getRows(); i++) {
+      if (std::fabs(weights[i]) > std::numeric_limits<double>::epsilon())
+        kept.push_back(residues[i]);
+    }
+    const double med = median(kept);
+    for (size_t i = 0; i < kept.size(); i++)
+      kept[i] = fabs(kept[i] - med);
+    const double sigma = std::max(1.4826 * median(kept), noise_threshold);
+
+    for (unsigned int i = 0; i < all_residues.getRows(); i++) {
+      const double x = fabs(all_residues[i] - med) / sigma;
+      if (method == vpRobust::TUKEY)
+        weights[i] = (fabs(x) <= 4.6851 && std::fabs(weights[i]) > std::numeric_limits<double>::epsilon())
+            ? vpMath::sqr(1 - vpMath::sqr(x / 4.6851)) : 0;
+      else if (method == vpRobust::CAUCHY)
+        weights[i] = 1 / (1 + vpMath::sqr(fabs(all_residues[i] - med) / (2.3849 * sigma)));
+      else if (std::fabs(weights[i]) > std::numeric_limits<double>::epsilon())
+        weights[i] = (fabs(x) <= 1.2107) ? 1 : 1.2107 / fabs(x);
+    }
+  }
+
+  void createResidues(vpColVector &residues, const unsigned int n, const bool sorted)
+  {
+    residues.resize(n);
+    for (unsigned int i = 0; i < n; i++) {
+      residues[i] = sorted ? 0.001 * i : (rand() % 2000) / 1000.0 - 1.0;
+      // Outliers
+      if (rand() % 10 == 0)
+        residues[i] *= 30;
+    }
+  }
+}
+
+int main()
+{
+  srand(0);
+  const vpRobust::vpRobustEstimatorType methods[] = { vpRobust::TUKEY, vpRobust::CAUCHY, vpRobust::HUBER };
+  const char *names[] = { "Tukey", "Cauchy", "Huber" };
+  const unsigned int sizes[] = { 1, 2, 5, 16, 101, 1000, 5001 };
+
+  vpRobust robust(0);
+  robust.setThreshold(noise_threshold);
+  for (unsigned int s = 0; s < 7; s++) {
+    for (unsigned int k = 0; k < 2; k++) {
+      vpColVector residues;
+      createResidues(residues, sizes[s], k == 1);
+      for (unsigned int m = 0; m < 3; m++) {
+        // All the residues, and the first half of the residues with a weight for all
+        vpColVector weights(sizes[s], 1.), ref(sizes[s], 1.);
+        robust.MEstimator(methods[m], residues, weights);
+        referenceWeights(methods[m], residues, residues, ref);
+        vpColVector half(sizes[s] / 2 + 1);
+        for (unsigned int i = 0; i < half.getRows(); i++)
+          half[i] = residues[i];
+        weights[0] = ref[0] = 1;
+        robust.MEstimator(methods[m], half, residues, weights);
+        referenceWeights(methods[m], half, residues, ref);
+        for (unsigned int i = 0; i < sizes[s]; i++) {
+          if (weights[i] != ref[i]) {
+            std::cerr << names[m] << " weight " << i << " of " << sizes[s] << " residues is " << weights[i]
+                      << " instead of " << ref[i] << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+
+        // Weights of the half of the residues alone, after the call with all the residues
+        vpColVector half_weights(half.getRows(), 1.), half_ref(half.getRows(), 1.);
+        robust.MEstimator(methods[m], half, half_weights);
+        referenceWeights(methods[m], half, half, half_ref);
+        for (unsigned int i = 0; i < half.getRows(); i++) {
+          if (half_weights[i] != half_ref[i]) {
+            std::cerr << names[m] << " weight " << i << " of " << half.getRows() << " residues is "
+                      << half_weights[i] << " instead of " << half_ref[i] << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+  }
+
+  // Benchmark
+  const unsigned int n = 20000, nb_iter = 100;
+  vpColVector residues;
+  createResidues(residues, n, false);
+  for (unsigned int m = 0; m < 3; m++) {
+    vpColVector weights(n, 1.);
+    double t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++) {
+      robust.MEstimator(methods[m], residues, weights);
+    }
+    t = vpTime::measureTimeMs() - t;
+    std::cout << names[m] << " weights of " << n << " residues: " << t / nb_iter << " ms" << std::endl;
+  }
+
+  std::cout << "testPerformanceRobust is ok!" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the weighted least squares solver.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testWeightedLeastSquares.cpp
+
+  \brief Compare vpWeightedLeastSquares with the SVD pseudo-inverse on N-by-6
+  systems, including a rank deficient one, and compare their timings.
+*/
+
+#include <iostream>
+#include <stdlib.h>
+#include <cmath>
+
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpWeightedLeastSquares.h>
+
+namespace {
+  vpMatrix randomMatrix(const unsigned int rows, const unsigned int cols)
+  {
+    vpMatrix M(rows, cols);
+    for (unsigned int i = 0; i < M.size(); i++)
+      M.data[i] = (double)rand() / RAND_MAX - 0.5;
+    return M;
+  }
+
+  bool equal(const vpColVector &a, const vpColVector &b, const double epsilon)
+  {
+    if (a.getRows() != b.getRows())
+      return false;
+    for (unsigned int i = 0; i < a.getRows(); i++) {
+      if (std::fabs(a[i] - b[i]) > epsilon * (1.0 + std::fabs(b[i])))
+        return false;
+    }
+    return true;
+  }
+
+  //! Reference solution: pseudo-inverse of W^(1/2) J
+  vpColVector reference(const vpMatrix &J, const vpColVector &e, const vpColVector &w)
+  {
+    vpMatrix WJ(J);
+    vpColVector We(e);
+    for (unsigned int i = 0; i < J.getRows(); i++) {
+      double sw = sqrt(w[i]);
+      for (unsigned int j = 0; j < J.getCols(); j++)
+        WJ[i][j] *= sw;
+      We[i] *= sw;
+    }
+    vpMatrix WJp;
+    WJ.pseudoInverse(WJp, 1e-6);
+    return WJp * We;
+  }
+}
+
+int main()
+{
+  try {
+    srand(0);
+    const unsigned int nb_rows = 5000;
+    vpMatrix J = randomMatrix(nb_rows, 6);
+    vpColVector e = randomMatrix(nb_rows, 1).getCol(0);
+    vpColVector w(nb_rows);
+    for (unsigned int i = 0; i < nb_rows; i++)
+      w[i] = (double)rand() / RAND_MAX;
+
+    // Well conditioned system, rows added one by one or all together
+    vpColVector x_ref = reference(J, e, w);
+    vpWeightedLeastSquares ls(6), ls_rows(6);
+    ls.addRows(J, e, w);
+    for (unsigned int i = 0; i < nb_rows; i++)
+      ls_rows.addRow(J[i], e[i], w[i]);
+    vpColVector x, x_rows;
+    unsigned int rank = ls.solve(x);
+    ls_rows.solve(x_rows);
+    if (rank != 6 || ! equal(x, x_ref, 1e-9) || ! equal(x_rows, x_ref, 1e-9)) {
+      std::cerr << "Bad solution: " << x.t() << " ; expected: " << x_ref.t() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Levenberg-Marquardt damping
+    double mu = 0.1;
+    vpMatrix A = ls.getJtWJ();
+    for (unsigned int i = 0; i < 6; i++)
+      A[i][i] += mu;
+    vpColVector x_lm_ref = A.inverseByLU() * ls.getJtWe();
+    vpColVector x_lm;
+    ls.solve(x_lm, mu);
+    if (! equal(x_lm, x_lm_ref, 1e-9)) {
+      std::cerr << "Bad damped solution: " << x_lm.t() << " ; expected: " << x_lm_ref.t() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Change of variables, as used to estimate some of the degrees of freedom of a pose
+    vpMatrix T = randomMatrix(6, 6);
+    T[2][2] = T[2][3] = 0.0;
+    vpWeightedLeastSquares ls_T(6), ls_JT(6);
+    ls_T.addRows(J, e, w);
+    ls_T.changeVariables(T);
+    ls_JT.addRows(J * T, e, w);
+    vpColVector x_T, x_JT;
+    ls_T.solve(x_T);
+    ls_JT.solve(x_JT);
+    if (! equal(x_T, x_JT, 1e-9) || ! equal(x_T, reference(J * T, e, w), 1e-9)) {
+      std::cerr << "Bad solution after a change of variables: " << x_T.t() << " ; expected: " << x_JT.t() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Rank deficient system: the last column is a combination of the first ones
+    for (unsigned int i = 0; i < nb_rows; i++)
+      J[i][5] = J[i][0] - 2 * J[i][3];
+    x_ref = reference(J, e, w);
+    ls.reset();
+    ls.addRows(J, e, w);
+    rank = ls.solve(x);
+    if (rank != 5 || ! equal(x, x_ref, 1e-6)) {
+      std::cerr << "Bad solution of the rank deficient system (rank " << rank << "): "
+                << x.t() << " ; expected: " << x_ref.t() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Timing compared to the pseudo-inverse of the interaction matrix
+    J = randomMatrix(nb_rows, 6);
+    const unsigned int nb_iter = 100;
+    double t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++) {
+      vpMatrix Jp;
+      J.pseudoInverse(Jp, 1e-16);
+      x_ref = Jp * e;
+    }
+    double t_svd = vpTime::measureTimeMs() - t;
+
+    t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < nb_iter; iter++) {
+      ls.reset();
+      ls.addRows(J, e);
+      ls.solve(x);
+    }
+    double t_ls = vpTime::measureTimeMs() - t;
+    if (! equal(x, x_ref, 1e-9)) {
+      std::cerr << "Bad solution: " << x.t() << " ; expected: " << x_ref.t() << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "(" << nb_rows << "x6) system solved " << nb_iter << " times:" << std::endl;
+    std::cout << "  pseudo-inverse:   " << t_svd << " ms" << std::endl;
+    std::cout << "  normal equations: " << t_ls << " ms" << std::endl;
+
+    std::cout << "testWeightedLeastSquares is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,225 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the thread pool.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testThreadPool.cpp
+
+  \brief Test the parallel-for of the thread pool.
+*/
+
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpHistogram.h>
+#include <visp3/core/vpMatrixException.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+
+namespace {
+  //! Sum with one accumulator per thread, with an unbalanced cost per index.
+  class SumTask : public vpThreadPool::Task {
+  public:
+    SumTask(const std::vector<unsigned int> &v) :
+      m_v(v), m_sums(vpThreadPool::getInstance().getNumThreads(), 0), m_visits(v.size(), 0) {
+    }
+
+    void operator()(const unsigned int begin, const unsigned int end) {
+      unsigned long long &sum = m_sums[vpThreadPool::getThreadIndex()];
+      for (unsigned int i = begin; i < end; i++) {
+        // Indexes at the end of the range are more expensive to force work stealing
+        unsigned int cost = i > m_v.size() / 2 ? 200 : 1;
+        unsigned long long val = 0;
+        for (unsigned int k = 0; k < cost; k++) {
+          val += m_v[i];
+        }
+        sum += val / cost;
+        m_visits[i]++;
+      }
+    }
+
+    unsigned long long getSum() const {
+      unsigned long long sum = 0;
+      for (size_t i = 0; i < m_sums.size(); i++) {
+        sum += m_sums[i];
+      }
+      return sum;
+    }
+
+    bool checkVisits() const {
+      for (size_t i = 0; i < m_visits.size(); i++) {
+        if (m_visits[i] != 1) {
+          std::cerr << "Index " << i << " processed " << m_visits[i] << " times" << std::endl;
+          return false;
+        }
+      }
+      return true;
+    }
+
+  private:
+    const std::vector<unsigned int> &m_v;
+    std::vector<unsigned long long> m_sums;
+    std::vector<unsigned int> m_visits;
+  };
+
+  //! Launch a parallel-for from inside a task, that must be run sequentially.
+  class NestedTask : public vpThreadPool::Task {
+  public:
+    NestedTask(const std::vector<unsigned int> &v) : m_results(10, 0), m_v(v) {
+    }
+
+    void operator()(const unsigned int begin, const unsigned int end) {
+      for (unsigned int i = begin; i < end; i++) {
+        SumTask task(m_v);
+        vpThreadPool::getInstance().parallelFor(0, (unsigned int) m_v.size(), task, 64);
+        m_results[i] = task.getSum();
+      }
+    }
+
+    std::vector<unsigned long long> m_results;
+
+  private:
+    const std::vector<unsigned int> &m_v;
+  };
+
+  class ThrowTask : public vpThreadPool::Task {
+  public:
+    void operator()(const unsigned int begin, const unsigned int end) {
+      for (unsigned int i = begin; i < end; i++) {
+        if (i == 777) {
+          throw vpMatrixException(vpMatrixException::matrixError, "Error raised at index 777");
+        }
+      }
+    }
+  };
+}
+
+int main() {
+  try {
+    vpThreadPool &pool = vpThreadPool::getInstance();
+    std::cout << "Number of CPU: " << vpThreadPool::getNumberOfCPU() << std::endl;
+    pool.setNumThreads(4);
+    std::cout << "Number of threads: " << pool.getNumThreads() << std::endl;
+
+    std::vector<unsigned int> v(100003);
+    unsigned long long sum_ref = 0;
+    for (size_t i = 0; i < v.size(); i++) {
+      v[i] = (unsigned int) (i % 97);
+      sum_ref += v[i];
+    }
+
+    // Parallel sum, several times to check that the workers are reused
+    for (unsigned int iter = 0; iter < 100; iter++) {
+      SumTask task(v);
+      pool.parallelFor(0, (unsigned int) v.size(), task, 256);
+      if (task.getSum() != sum_ref || !task.checkVisits()) {
+        std::cerr << "Bad sum: " << task.getSum() << " ; expected: " << sum_ref << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Nested parallel-for
+    NestedTask nested(v);
+    pool.parallelFor(0, (unsigned int) nested.m_results.size(), nested);
+    for (size_t i = 0; i < nested.m_results.size(); i++) {
+      if (nested.m_results[i] != sum_ref) {
+        std::cerr << "Bad nested sum: " << nested.m_results[i] << " ; expected: " << sum_ref << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Exceptions raised in a worker are rethrown in the calling thread
+    bool exception_raised = false, type_kept = false;
+    try {
+      ThrowTask task;
+      pool.parallelFor(0, 1000, task, 10);
+    }
+    catch (vpMatrixException &e) {
+      std::cout << "Catch expected exception: " << e.getStringMessage() << std::endl;
+      exception_raised = type_kept = e.getCode() == vpMatrixException::matrixError;
+    }
+    catch (vpException &e) {
+      std::cout << "Catch expected exception: " << e.getStringMessage() << std::endl;
+      exception_raised = e.getCode() == vpMatrixException::matrixError;
+    }
+    if (!exception_raised) {
+      std::cerr << "The exception raised by the task was not propagated" << std::endl;
+      return EXIT_FAILURE;
+    }
+#if (__cplusplus >= 201103L) || (defined(_MSC_VER) && _MSC_VER >= 1600)
+    if (!type_kept) {
+      std::cerr << "The exception raised by the task was sliced" << std::endl;
+      return EXIT_FAILURE;
+    }
+#else
+    (void) type_kept;
+#endif
+
+    // Histogram computed with the pool should be the same than the sequential one
+    vpImage<unsigned char> I(480, 640);
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      I.bitmap[i] = (unsigned char) ((i * 7 + i / 640) % 256);
+    }
+    vpHistogram histo_seq, histo_par;
+    histo_seq.calculate(I, 256, 1);
+    double t = vpTime::measureTimeMs();
+    for (unsigned int iter = 0; iter < 100; iter++) {
+      histo_par.calculate(I, 256, 4);
+    }
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Mean time for vpHistogram::calculate() with 4 threads: " << t / 100 << " ms" << std::endl;
+    for (unsigned int i = 0; i < 256; i++) {
+      if (histo_seq[i] != histo_par[i]) {
+        std::cerr << "Histograms differ at bin " << i << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Reduce the number of threads
+    pool.setNumThreads(2);
+    SumTask task(v);
+    pool.parallelFor(0, (unsigned int) v.size(), task, 256);
+    if (task.getSum() != sum_ref) {
+      std::cerr << "Bad sum with 2 threads: " << task.getSum() << " ; expected: " << sum_ref << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "testThreadPool is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -103,6 +103,9 @@
     is used when there was a problem performing basic tracking of the dot, but
     can also be used to find a certain type of dots in the full image.
 
+  To track many dots in the same image, as the dots of a calibration grid,
+  use trackDots() that tracks them in parallel.
+
   The following sample code available in tutorial-blob-tracker-live-firewire.cpp shows how to
   grab images from a firewire camera, track a blob and display the tracking
   results.
@@ -365,6 +368,7 @@ public:
 
   static void trackAndDisplay(vpDot2 dot[], const unsigned int &n, vpImage<unsigned char> &I,
                               std::vector<vpImagePoint> &cogs, vpImagePoint* cogStar = NULL);
+  static void trackDots(vpDot2 dot[], const unsigned int &n, const vpImage<unsigned char> &I);
 
 public:
   double m00; /*!< Considering the general distribution moments for \f$ N \f$
@@ -50,6 +50,7 @@
 #include <visp3/core/vpTrackingException.h>
 #include <visp3/core/vpMath.h>
 #include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpThreadPool.h>
 
 #include <visp3/blob/vpDot2.h>
 #include <math.h>
@@ -57,6 +58,54 @@
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  /*!
+    Tracking of the dots of a range that are selected. The errors are kept to
+    be thrown by the calling thread.
+  */
+  class vpDot2TrackTask : public vpThreadPool::Task
+  {
+  public:
+    vpDot2TrackTask(vpDot2 *dot, const vpImage<unsigned char> &I, const std::vector<unsigned char> &selected,
+                    std::vector<unsigned char> &lost, std::vector<int> &errorCodes,
+                    std::vector<std::string> &errorMessages)
+      : m_dot(dot), m_I(I), m_selected(selected), m_lost(lost), m_errorCodes(errorCodes),
+        m_errorMessages(errorMessages) {}
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      for (unsigned int i = begin; i < end; i++) {
+        if (! m_selected[i])
+          continue;
+        try {
+          m_dot[i].track(m_I);
+        }
+        catch(vpException &e) {
+          m_lost[i] = 1;
+          m_errorCodes[i] = e.getCode();
+          m_errorMessages[i] = e.getStringMessage();
+        }
+      }
+    }
+
+  private:
+    vpDot2 *m_dot;
+    const vpImage<unsigned char> &m_I;
+    const std::vector<unsigned char> &m_selected;
+    std::vector<unsigned char> &m_lost;
+    std::vector<int> &m_errorCodes;
+    std::vector<std::string> &m_errorMessages;
+  };
+
+  //! Bounding box of a dot that was rejected during the search of dots in an area.
+  struct vpDot2BoundingBox
+  {
+    int u_min, u_max, v_min, v_max;
+  };
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /******************************************************************************
  *
  *      CONSTRUCTORS AND DESTRUCTORS
@@ -1070,12 +1119,12 @@ void vpDot2::searchDotsInArea(const vpImage<unsigned char>& I,
   // start the search loop; for all points of the search grid,
   // test if the pixel belongs to a valid dot.
   // if it is so eventually add it to the vector of valid dots.
-  std::list<vpDot2> badDotsVector;
+  // Only the bounding box of the bad dots is used to reject the next germs
+  std::vector<vpDot2BoundingBox> badDotsVector;
   std::list<vpDot2>::iterator itnice;
-  std::list<vpDot2>::iterator itbad;
+  std::vector<vpDot2BoundingBox>::const_iterator itbad;
 
   vpDot2* dotToTest = NULL;
-  vpDot2 tmpDot;
 
   unsigned int area_u_min = (unsigned int) area.getLeft();
   unsigned int area_u_max = (unsigned int) area.getRight();
@@ -1100,7 +1149,7 @@ void vpDot2::searchDotsInArea(const vpImage<unsigned char>& I,
 
       itnice = niceDots.begin();
       while( itnice != niceDots.end() && good_germ == true) {
-        tmpDot = *itnice;
+        const vpDot2 &tmpDot = *itnice;
 
         cogTmpDot = tmpDot.getCog();
         double u0 = cogTmpDot.get_u();
@@ -1135,10 +1184,10 @@ void vpDot2::searchDotsInArea(const vpImage<unsigned char>& I,
       vpImagePoint cogBadDot;
 
       while( itbad != badDotsVector.end() && good_germ == true) {
-        if( (double)u >= vpBAD_DOT_VALUE.bbox_u_min
-            && (double)u <= vpBAD_DOT_VALUE.bbox_u_max &&
-            (double)v >= vpBAD_DOT_VALUE.bbox_v_min
-            && (double)v <= vpBAD_DOT_VALUE.bbox_v_max){
+        if( (double)u >= vpBAD_DOT_VALUE.u_min
+            && (double)u <= vpBAD_DOT_VALUE.u_max &&
+            (double)v >= vpBAD_DOT_VALUE.v_min
+            && (double)v <= vpBAD_DOT_VALUE.v_max){
           std::list<vpImagePoint>::const_iterator it_edges = ip_edges_list.begin();
           while (it_edges != ip_edges_list.end() && good_germ == true){
             // Test if the germ belong to a previously detected dot:
@@ -1217,7 +1266,7 @@ void vpDot2::searchDotsInArea(const vpImage<unsigned char>& I,
 
         while( itnice != niceDots.end() &&  stopLoop == false )
         {
-          tmpDot = *itnice;
+          const vpDot2 &tmpDot = *itnice;
 
           //double epsilon = 0.001; // detecte +sieurs points
           double epsilon = 3.0;
@@ -1267,7 +1316,12 @@ void vpDot2::searchDotsInArea(const vpImage<unsigned char>& I,
       }
       else {
         // Store bad dots
-        badDotsVector.push_front( *dotToTest );
+        vpDot2BoundingBox bbox;
+        bbox.u_min = dotToTest->bbox_u_min;
+        bbox.u_max = dotToTest->bbox_u_max;
+        bbox.v_min = dotToTest->bbox_v_min;
+        bbox.v_max = dotToTest->bbox_v_max;
+        badDotsVector.push_back( bbox );
       }
     }
   }
@@ -2543,11 +2597,9 @@ void vpDot2::trackAndDisplay(vpDot2 dot[], const unsigned int &n, vpImage<unsign
 {
 	unsigned int i;
 	// tracking
+	trackDots(dot, n, I);
 	for(i=0;i<n;++i)
-	{
-		dot[i].track(I);
 		cogs.push_back(dot[i].getCog());
-	}
 	// trajectories
 	for(i=n;i<cogs.size();++i)
 		vpDisplay::displayCircle(I,cogs[i],4,vpColor::green,true);
@@ -2564,6 +2616,44 @@ void vpDot2::trackAndDisplay(vpDot2 dot[], const unsigned int &n, vpImage<unsign
 	vpDisplay::flush(I);
 }
 
+/*!
+  Track a number of dots in an image. The result is the same as calling
+  track() for each dot, but the dots are tracked in parallel with
+  vpThreadPool. The dots with graphics enabled (see setGraphics()) are
+  tracked after the other ones by the calling thread, since they
+  draw in the display.
+
+  \param dot : Array of dots.
+  \param n : Number of dots, array dimension.
+  \param I : Image to process.
+
+  \exception vpTrackingException : If a dot is lost. All the other dots
+  are tracked before the exception of the first lost dot is thrown.
+
+  \sa track()
+*/
+void vpDot2::trackDots(vpDot2 dot[], const unsigned int &n, const vpImage<unsigned char> &I)
+{
+  // Not std::vector<bool> that can not be written concurrently
+  std::vector<unsigned char> withoutGraphics(n), withGraphics(n), lost(n, 0);
+  std::vector<int> errorCodes(n, 0);
+  std::vector<std::string> errorMessages(n);
+  for (unsigned int i = 0; i < n; i++) {
+    withGraphics[i] = dot[i].graphics ? 1 : 0;
+    withoutGraphics[i] = dot[i].graphics ? 0 : 1;
+  }
+
+  vpDot2TrackTask task(dot, I, withoutGraphics, lost, errorCodes, errorMessages);
+  vpThreadPool::getInstance().parallelFor(0, n, task);
+  vpDot2TrackTask graphicsTask(dot, I, withGraphics, lost, errorCodes, errorMessages);
+  graphicsTask(0, n);
+
+  for (unsigned int i = 0; i < n; i++) {
+    if (lost[i])
+      throw(vpTrackingException(errorCodes[i], errorMessages[i]));
+  }
+}
+
 /*!
 
   Display the dot center of gravity and its list of edges.
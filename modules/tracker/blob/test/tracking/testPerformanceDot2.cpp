@@ -0,0 +1,200 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the tracking of many dots.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceDot2.cpp
+
+  \brief Check that vpDot2::trackDots() gives the same dots as vpDot2::track()
+  called for each dot, whatever the number of threads and also when the dots
+  are searched around their previous position, and measure the time spent to
+  search and track the dots of a synthetic calibration grid.
+*/
+
+#include <iostream>
+#include <list>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/blob/vpDot2.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpTrackingException.h>
+
+namespace {
+  const unsigned int nb_rows = 8, nb_cols = 10;
+
+  //! Grid of black disks on a white background, translated by (du, dv)
+  void createImage(vpImage<unsigned char> &I, const double du, const double dv, const int missing=-1)
+  {
+    I.resize(480, 640, 255);
+    for (unsigned int r = 0; r < nb_rows; r++) {
+      for (unsigned int c = 0; c < nb_cols; c++) {
+        if ((int)(r * nb_cols + c) == missing)
+          continue;
+        const double u0 = 50 + 60 * c + du, v0 = 30 + 60 * r + dv;
+        for (int i = (int)v0 - 12; i <= (int)v0 + 12; i++) {
+          for (int j = (int)u0 - 12; j <= (int)u0 + 12; j++) {
+            if (vpMath::sqr(j - u0) + vpMath::sqr(i - v0) <= 100.)
+              I[i][j] = 20;
+          }
+        }
+      }
+    }
+  }
+
+  bool sameDot(const vpDot2 &a, const vpDot2 &b)
+  {
+    return a.getCog() == b.getCog() && a.m00 == b.m00 && a.m10 == b.m10 && a.m01 == b.m01 && a.m11 == b.m11 &&
+        a.m20 == b.m20 && a.m02 == b.m02 && a.getWidth() == b.getWidth() && a.getHeight() == b.getHeight() &&
+        a.getGrayLevelMin() == b.getGrayLevelMin() && a.getGrayLevelMax() == b.getGrayLevelMax() &&
+        a.getEdges() == b.getEdges();
+  }
+
+  /*!
+    Track the dots with trackDots() and with track() called for each dot and
+    compare the results. Return the number of lost dots, or -1 if the results
+    differ.
+  */
+  int compareTracking(std::vector<vpDot2> &dots, const vpImage<unsigned char> &I)
+  {
+    std::vector<vpDot2> ref = dots;
+    std::vector<bool> lost(ref.size(), false);
+    int nbLost = 0;
+    for (size_t i = 0; i < ref.size(); i++) {
+      try {
+        ref[i].track(I);
+      }
+      catch(const vpTrackingException &) {
+        lost[i] = true;
+        nbLost++;
+      }
+    }
+
+    bool thrown = false;
+    try {
+      vpDot2::trackDots(&dots[0], (unsigned int)dots.size(), I);
+    }
+    catch(const vpTrackingException &) {
+      thrown = true;
+    }
+    if (thrown != (nbLost > 0)) {
+      std::cerr << "trackDots() did not throw the exception of the lost dots" << std::endl;
+      return -1;
+    }
+    for (size_t i = 0; i < ref.size(); i++) {
+      if (! lost[i] && ! sameDot(ref[i], dots[i])) {
+        std::cerr << "Dot " << i << " differs from the one tracked alone" << std::endl;
+        return -1;
+      }
+    }
+    return nbLost;
+  }
+}
+
+int main()
+{
+  try {
+    vpImage<unsigned char> I;
+    createImage(I, 0, 0);
+
+    // Search the dots similar to the first one
+    vpDot2 blob;
+    blob.initTracking(I, vpImagePoint(30, 50));
+    std::list<vpDot2> found;
+    double t = vpTime::measureTimeMs();
+    blob.searchDotsInArea(I, found);
+    const double t_search = vpTime::measureTimeMs() - t;
+    if (found.size() != nb_rows * nb_cols) {
+      std::cerr << found.size() << " dots found instead of " << nb_rows * nb_cols << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::vector<vpDot2> init;
+    for (unsigned int r = 0; r < nb_rows; r++) {
+      for (unsigned int c = 0; c < nb_cols; c++) {
+        vpDot2 dot;
+        dot.initTracking(I, vpImagePoint(30 + 60 * r, 50 + 60 * c));
+        init.push_back(dot);
+      }
+    }
+
+    // Small motion, large motion that needs to search the dots, one missing dot
+    vpImage<unsigned char> I_small, I_large, I_missing;
+    createImage(I_small, 2.4, -1.7);
+    createImage(I_large, 14.3, 11.6);
+    createImage(I_missing, 2.4, -1.7, 23);
+    const unsigned int nb_threads[] = { 1, 4 };
+    for (unsigned int k = 0; k < 2; k++) {
+      vpThreadPool::getInstance().setNumThreads(nb_threads[k]);
+      std::vector<vpDot2> dots = init;
+      if (compareTracking(dots, I_small) != 0)
+        return EXIT_FAILURE;
+      dots = init;
+      if (compareTracking(dots, I_large) != 0)
+        return EXIT_FAILURE;
+      dots = init;
+      if (compareTracking(dots, I_missing) != 1)
+        return EXIT_FAILURE;
+    }
+    vpThreadPool::getInstance().setNumThreads(vpThreadPool::getNumberOfCPU());
+
+    // Benchmark
+    const unsigned int nb_iter = 20;
+    double t_track = 0, t_trackDots = 0;
+    for (unsigned int iter = 0; iter < nb_iter; iter++) {
+      const vpImage<unsigned char> &Icur = (iter % 2) ? I : I_small;
+      std::vector<vpDot2> dots = init;
+      t = vpTime::measureTimeMs();
+      for (size_t i = 0; i < dots.size(); i++)
+        dots[i].track(Icur);
+      t_track += vpTime::measureTimeMs() - t;
+
+      dots = init;
+      t = vpTime::measureTimeMs();
+      vpDot2::trackDots(&dots[0], (unsigned int)dots.size(), Icur);
+      t_trackDots += vpTime::measureTimeMs() - t;
+    }
+    std::cout << "Search of " << found.size() << " dots in the image: " << t_search << " ms" << std::endl;
+    std::cout << "Tracking of " << init.size() << " dots, per frame:" << std::endl;
+    std::cout << "  track() for each dot:  " << t_track / nb_iter << " ms" << std::endl;
+    std::cout << "  trackDots():           " << t_trackDots / nb_iter << " ms" << std::endl;
+
+    std::cout << "testPerformanceDot2 is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
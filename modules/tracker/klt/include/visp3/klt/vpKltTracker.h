@@ -0,0 +1,192 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * KLT (Kanade-Lucas-Tomasi) feature tracker working on ViSP images.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpKltTracker.h
+
+  \brief KLT (Kanade-Lucas-Tomasi) feature tracker working on ViSP images,
+  without third party library.
+*/
+
+#ifndef vpKltTracker_h
+#define vpKltTracker_h
+
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpColor.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImagePoint.h>
+
+/*!
+  \class vpKltTracker
+
+  \ingroup module_klt
+
+  \brief KLT (Kanade-Lucas-Tomasi) feature tracker working on ViSP images.
+
+  This class has the same interface as vpKltOpencv but does not require
+  OpenCV: the images are given as vpImage<unsigned char> and the features as
+  vpImagePoint, so that no conversion is needed at each frame.
+
+  The features are detected with the Shi-Tomasi detector (minimal eigenvalue
+  of the gradient matrix) or the Harris detector. The local maxima of the
+  response above the quality level are selected by decreasing response, the
+  minimal distance between the features being checked on a grid of cells of
+  size getMinDistance().
+
+  The features are tracked with the iterative pyramidal Lucas-Kanade method:
+  - the Gaussian pyramid of each image and the Scharr gradients of its levels
+    are computed once and shared by all the features. They are kept for the
+    next call to track(), where the image becomes the previous one;
+  - the patches are interpolated in fixed point, with SSE2 when available;
+  - the features are tracked in parallel with vpThreadPool. Each one is tracked
+    independently, so the result does not depend on the number of threads.
+
+  \code
+#include <visp3/klt/vpKltTracker.h>
+
+int main()
+{
+  vpImage<unsigned char> I;
+  // Acquire the first image in I
+
+  vpKltTracker tracker;
+  tracker.setMaxFeatures(200);
+  tracker.setWindowSize(10);
+  tracker.setQuality(0.01);
+  tracker.setMinDistance(15);
+  tracker.setPyramidLevels(3);
+  tracker.initTracking(I);
+
+  while (1) {
+    // Acquire a new image in I
+    tracker.track(I);
+    for (int i = 0; i < tracker.getNbFeatures(); i++) {
+      long id;
+      float x, y;
+      tracker.getFeature(i, id, x, y);
+    }
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpKltTracker
+{
+public:
+  vpKltTracker();
+  virtual ~vpKltTracker();
+
+  void addFeature(const float &x, const float &y);
+  void addFeature(const long &id, const float &x, const float &y);
+
+  void display(const vpImage<unsigned char> &I, const vpColor &color = vpColor::red, unsigned int thickness=1) const;
+  static void display(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &features,
+                      const std::vector<long> &featuresid, const vpColor &color = vpColor::green,
+                      unsigned int thickness=1);
+
+  //! Get the size of the averaging block used to detect the features.
+  int getBlockSize() const {return m_blockSize;}
+  void getFeature(const int &index, long &id, float &x, float &y) const;
+  //! Get the list of current features.
+  std::vector<vpImagePoint> getFeatures() const {return m_points[1];}
+  //! Get the unique id of each feature.
+  std::vector<long> getFeaturesId() const {return m_points_id;}
+  //! Get the free parameter of the Harris detector.
+  double getHarrisFreeParameter() const {return m_harris_k;}
+  //! Get the maximum number of features to track in the image.
+  int getMaxFeatures() const {return m_maxCount;}
+  //! Get the minimal Euclidean distance between detected corners during initialization.
+  double getMinDistance() const {return m_minDistance;}
+  //! Get the minimal eigen value threshold used to reject a point during the tracking.
+  double getMinEigThreshold() const {return m_minEigThreshold;}
+  //! Get the number of current features
+  int getNbFeatures() const { return (int)m_points[1].size(); }
+  //! Get the number of previous features.
+  int getNbPrevFeatures() const { return (int)m_points[0].size(); }
+  //! Get the list of previous features
+  std::vector<vpImagePoint> getPrevFeatures() const {return m_points[0];}
+  //! Get the maximal pyramid level.
+  int getPyramidLevels() const {return m_pyrMaxLevel;}
+  //! Get the parameter characterizing the minimal accepted quality of image corners.
+  double getQuality() const {return m_qualityLevel;}
+  //! Get the size of the window used to track the features.
+  int getWindowSize() const {return m_winSize;}
+
+  void initTracking(const vpImage<unsigned char> &I, const vpImage<unsigned char> *mask=NULL);
+  void initTracking(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &pts);
+  void initTracking(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &pts,
+                    const std::vector<long> &ids);
+
+  void track(const vpImage<unsigned char> &I);
+  void setBlockSize(const int blockSize);
+  void setHarrisFreeParameter(double harris_k);
+  void setInitialGuess(const std::vector<vpImagePoint> &guess_pts);
+  void setInitialGuess(const std::vector<vpImagePoint> &init_pts, const std::vector<vpImagePoint> &guess_pts,
+                       const std::vector<long> &fid);
+  void setMaxFeatures(const int maxCount);
+  void setMinDistance(double minDistance);
+  void setMinEigThreshold(double minEigThreshold);
+  void setPyramidLevels(const int pyrMaxLevel);
+  void setQuality(double qualityLevel);
+  void setUseHarris(const int useHarrisDetector);
+  void setWindowSize(const int winSize);
+  void suppressFeature(const int &index);
+
+protected:
+  void buildPyramid(const vpImage<unsigned char> &I, std::vector<vpImage<unsigned char> > &pyramid) const;
+  void computeGradients(const std::vector<vpImage<unsigned char> > &pyramid);
+  void detectFeatures(const vpImage<unsigned char> &I, const vpImage<unsigned char> *mask,
+                      std::vector<vpImagePoint> &features) const;
+
+  std::vector<vpImage<unsigned char> > m_pyramid[2]; //!< Pyramid of the previous [0] and current [1] image
+  std::vector<vpImage<short> > m_dIx, m_dIy;         //!< Gradients of the levels of the previous pyramid
+  std::vector<vpImagePoint> m_points[2]; //!< Previous [0] and current [1] keypoint location
+  std::vector<long> m_points_id;     //!< Keypoint id
+  int m_maxCount;
+  unsigned int m_maxIterations;
+  double m_epsilon;
+  int m_winSize;
+  double m_qualityLevel;
+  double m_minDistance;
+  double m_minEigThreshold;
+  double m_harris_k;
+  int m_blockSize;
+  int m_useHarrisDetector;
+  int m_pyrMaxLevel;
+  long m_next_points_id;
+  bool m_initial_guess;
+};
+
+#endif
@@ -0,0 +1,940 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * KLT (Kanade-Lucas-Tomasi) feature tracker working on ViSP images.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpKltTracker.cpp
+
+  \brief KLT (Kanade-Lucas-Tomasi) feature tracker working on ViSP images,
+  without third party library.
+*/
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <sstream>
+
+#include <visp3/core/vpDisplay.h>
+#include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTrackingException.h>
+#include <visp3/klt/vpKltTracker.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  // Fixed point precision of the bilinear interpolation weights
+  const int W_BITS = 14;
+  // The patches are interpolated with 5 bits of sub-pixel precision, the
+  // gradients without: the products are scaled back by 2^-20
+  const int PATCH_SHIFT = W_BITS - 5;
+  const double FLT_SCALE = 1. / (1 << 20);
+
+  struct vpBilinearWeights
+  {
+    int w00, w01, w10, w11;
+
+    vpBilinearWeights(const double a, const double b)
+    {
+      w00 = vpMath::round((1. - a) * (1. - b) * (1 << W_BITS));
+      w01 = vpMath::round(a * (1. - b) * (1 << W_BITS));
+      w10 = vpMath::round((1. - a) * b * (1 << W_BITS));
+      w11 = (1 << W_BITS) - w00 - w01 - w10;
+    }
+  };
+
+  /*!
+    Interpolate \e n consecutive pixels of a row: dst[x] is the rounded value of
+    (w00 src0[x] + w01 src0[x+1] + w10 src1[x] + w11 src1[x+1]) / 2^shift.
+    src0[n] and src1[n] are read.
+  */
+  template<class Type>
+  inline void interpolateRowScalar(const Type *src0, const Type *src1, const vpBilinearWeights &w, const int shift,
+                                   short *dst, int x, const int n)
+  {
+    const int round = 1 << (shift - 1);
+    for (; x < n; x++)
+      dst[x] = (short)((src0[x] * w.w00 + src0[x + 1] * w.w01 + src1[x] * w.w10 + src1[x + 1] * w.w11 + round) >> shift);
+  }
+
+  inline void interpolateRow(const unsigned char *src0, const unsigned char *src1, const vpBilinearWeights &w,
+                             short *dst, const int n)
+  {
+    int x = 0;
+#if VISP_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w0 = _mm_set_epi16((short)w.w01, (short)w.w00, (short)w.w01, (short)w.w00,
+                                     (short)w.w01, (short)w.w00, (short)w.w01, (short)w.w00);
+    const __m128i w1 = _mm_set_epi16((short)w.w11, (short)w.w10, (short)w.w11, (short)w.w10,
+                                     (short)w.w11, (short)w.w10, (short)w.w11, (short)w.w10);
+    const __m128i round = _mm_set1_epi32(1 << (PATCH_SHIFT - 1));
+    for (; x + 8 <= n; x += 8) {
+      const __m128i a0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src0 + x)), zero);
+      const __m128i a1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src0 + x + 1)), zero);
+      const __m128i b0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src1 + x)), zero);
+      const __m128i b1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src1 + x + 1)), zero);
+      __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a0, a1), w0),
+                                 _mm_madd_epi16(_mm_unpacklo_epi16(b0, b1), w1));
+      __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a0, a1), w0),
+                                 _mm_madd_epi16(_mm_unpackhi_epi16(b0, b1), w1));
+      lo = _mm_srai_epi32(_mm_add_epi32(lo, round), PATCH_SHIFT);
+      hi = _mm_srai_epi32(_mm_add_epi32(hi, round), PATCH_SHIFT);
+      _mm_storeu_si128((__m128i *)(dst + x), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    interpolateRowScalar(src0, src1, w, PATCH_SHIFT, dst, x, n);
+  }
+
+  inline void interpolateRow(const short *src0, const short *src1, const vpBilinearWeights &w, short *dst, const int n)
+  {
+    int x = 0;
+#if VISP_HAVE_SSE2
+    const __m128i w0 = _mm_set_epi16((short)w.w01, (short)w.w00, (short)w.w01, (short)w.w00,
+                                     (short)w.w01, (short)w.w00, (short)w.w01, (short)w.w00);
+    const __m128i w1 = _mm_set_epi16((short)w.w11, (short)w.w10, (short)w.w11, (short)w.w10,
+                                     (short)w.w11, (short)w.w10, (short)w.w11, (short)w.w10);
+    const __m128i round = _mm_set1_epi32(1 << (W_BITS - 1));
+    for (; x + 8 <= n; x += 8) {
+      const __m128i a0 = _mm_loadu_si128((const __m128i *)(src0 + x));
+      const __m128i a1 = _mm_loadu_si128((const __m128i *)(src0 + x + 1));
+      const __m128i b0 = _mm_loadu_si128((const __m128i *)(src1 + x));
+      const __m128i b1 = _mm_loadu_si128((const __m128i *)(src1 + x + 1));
+      __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a0, a1), w0),
+                                 _mm_madd_epi16(_mm_unpacklo_epi16(b0, b1), w1));
+      __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a0, a1), w0),
+                                 _mm_madd_epi16(_mm_unpackhi_epi16(b0, b1), w1));
+      lo = _mm_srai_epi32(_mm_add_epi32(lo, round), W_BITS);
+      hi = _mm_srai_epi32(_mm_add_epi32(hi, round), W_BITS);
+      _mm_storeu_si128((__m128i *)(dst + x), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    interpolateRowScalar(src0, src1, w, W_BITS, dst, x, n);
+  }
+
+  /*!
+    Return the sum of a[x] b[x] for x in [0, n). All the partial sums are
+    integers, so that the result does not depend on the SSE2 path.
+  */
+  inline double dotProduct(const short *a, const short *b, const int n)
+  {
+    int x = 0;
+    double sum = 0;
+#if VISP_HAVE_SSE2
+    __m128i vsum = _mm_setzero_si128();
+    for (; x + 8 <= n; x += 8)
+      vsum = _mm_add_epi32(vsum, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + x)),
+                                                _mm_loadu_si128((const __m128i *)(b + x))));
+    int buf[4];
+    _mm_storeu_si128((__m128i *)buf, vsum);
+    sum = (double)buf[0] + buf[1] + buf[2] + buf[3];
+#endif
+    for (; x < n; x++)
+      sum += a[x] * b[x];
+    return sum;
+  }
+
+  //! Scharr gradients of the rows of an image, with replicated border.
+  class vpScharrTask : public vpThreadPool::Task
+  {
+  public:
+    vpScharrTask(const vpImage<unsigned char> &I, vpImage<short> &dIx, vpImage<short> &dIy)
+      : m_I(I), m_dIx(dIx), m_dIy(dIy) {}
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      const int w = (int)m_I.getWidth(), h = (int)m_I.getHeight();
+      for (int i = (int)begin; i < (int)end; i++) {
+        const unsigned char *r0 = m_I[std::max(i - 1, 0)], *r1 = m_I[i], *r2 = m_I[std::min(i + 1, h - 1)];
+        short *dx = m_dIx[i], *dy = m_dIy[i];
+        for (int j = 0; j < w; j++) {
+          const int jm = std::max(j - 1, 0), jp = std::min(j + 1, w - 1);
+          dx[j] = (short)(3 * (r0[jp] + r2[jp] - r0[jm] - r2[jm]) + 10 * (r1[jp] - r1[jm]));
+          dy[j] = (short)(3 * (r2[jm] + r2[jp] - r0[jm] - r0[jp]) + 10 * (r2[j] - r0[j]));
+        }
+      }
+    }
+
+  private:
+    const vpImage<unsigned char> &m_I;
+    vpImage<short> &m_dIx;
+    vpImage<short> &m_dIy;
+  };
+
+  //! Corner response of the pixels of a range of rows.
+  class vpCornerResponseTask : public vpThreadPool::Task
+  {
+  public:
+    vpCornerResponseTask(const vpImage<unsigned char> &I, const int blockSize, const bool useHarris,
+                         const double harris_k, std::vector<float> &response)
+      : m_I(I), m_blockSize(blockSize), m_useHarris(useHarris), m_harris_k(harris_k), m_response(response) {}
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      const int w = (int)m_I.getWidth(), h = (int)m_I.getHeight();
+      const int r = m_blockSize / 2;
+      // Gradient products of the rows of the block, summed along the columns
+      std::vector<double> cxx((size_t)w), cxy((size_t)w), cyy((size_t)w);
+      for (int i = (int)begin; i < (int)end; i++) {
+        std::fill(cxx.begin(), cxx.end(), 0.);
+        std::fill(cxy.begin(), cxy.end(), 0.);
+        std::fill(cyy.begin(), cyy.end(), 0.);
+        for (int k = i - r; k < i - r + m_blockSize; k++) {
+          const int y = std::min(std::max(k, 0), h - 1);
+          const unsigned char *r0 = m_I[std::max(y - 1, 0)], *r1 = m_I[y], *r2 = m_I[std::min(y + 1, h - 1)];
+          for (int j = 0; j < w; j++) {
+            const int jm = std::max(j - 1, 0), jp = std::min(j + 1, w - 1);
+            const int dx = (r0[jp] + r2[jp] - r0[jm] - r2[jm]) + 2 * (r1[jp] - r1[jm]);
+            const int dy = (r2[jm] + r2[jp] - r0[jm] - r0[jp]) + 2 * (r2[j] - r0[j]);
+            cxx[(size_t)j] += dx * dx;
+            cxy[(size_t)j] += dx * dy;
+            cyy[(size_t)j] += dy * dy;
+          }
+        }
+        float *resp = &m_response[(size_t)i * (size_t)w];
+        for (int j = 0; j < w; j++) {
+          double a = 0, b = 0, c = 0;
+          for (int k = j - r; k < j - r + m_blockSize; k++) {
+            const size_t x = (size_t)std::min(std::max(k, 0), w - 1);
+            a += cxx[x];
+            b += cxy[x];
+            c += cyy[x];
+          }
+          if (m_useHarris)
+            resp[j] = (float)(a * c - b * b - m_harris_k * (a + c) * (a + c));
+          else
+            resp[j] = (float)(((a + c) - sqrt((a - c) * (a - c) + 4. * b * b)) / 2.);
+        }
+      }
+    }
+
+  private:
+    const vpImage<unsigned char> &m_I;
+    const int m_blockSize;
+    const bool m_useHarris;
+    const double m_harris_k;
+    std::vector<float> &m_response;
+  };
+
+  struct vpCorner
+  {
+    float response;
+    int index;
+    bool operator<(const vpCorner &c) const
+    {
+      return response > c.response || (response == c.response && index < c.index);
+    }
+  };
+
+  //! Pyramidal Lucas-Kanade tracking of a range of features.
+  class vpLucasKanadeTask : public vpThreadPool::Task
+  {
+  public:
+    vpLucasKanadeTask(const std::vector<vpImage<unsigned char> > &prevPyr,
+                      const std::vector<vpImage<short> > &dIx, const std::vector<vpImage<short> > &dIy,
+                      const std::vector<vpImage<unsigned char> > &nextPyr, const int nbLevels,
+                      const std::vector<vpImagePoint> &prevPts, std::vector<vpImagePoint> &nextPts,
+                      std::vector<unsigned char> &status, const bool useInitialFlow, const int winSize,
+                      const unsigned int maxIterations, const double epsilon, const double minEigThreshold)
+      : m_prevPyr(prevPyr), m_dIx(dIx), m_dIy(dIy), m_nextPyr(nextPyr), m_nbLevels(nbLevels), m_prevPts(prevPts),
+        m_nextPts(nextPts), m_status(status), m_useInitialFlow(useInitialFlow), m_winSize(winSize),
+        m_maxIterations(maxIterations), m_epsilon2(epsilon * epsilon), m_minEigThreshold(minEigThreshold)
+    {}
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      const size_t area = (size_t)(m_winSize * m_winSize);
+      std::vector<short> buffer(4 * area);
+      for (unsigned int i = begin; i < end; i++)
+        m_status[i] = trackFeature(i, &buffer[0], &buffer[area], &buffer[2 * area], &buffer[3 * area]) ? 1 : 0;
+    }
+
+  private:
+    /*!
+      Return true if the patch of side m_winSize starting at (ix, iy) and its
+      right and bottom neighbours are inside an image of size w x h.
+    */
+    inline bool inside(const int ix, const int iy, const int w, const int h) const
+    {
+      return ix >= 0 && iy >= 0 && ix + m_winSize < w && iy + m_winSize < h;
+    }
+
+    bool trackFeature(const unsigned int index, short *Ipatch, short *Ixpatch, short *Iypatch, short *Jpatch) const
+    {
+      const int W = m_winSize;
+      const double halfWin = (W - 1) * 0.5;
+      const double topScale = 1. / (1 << (m_nbLevels - 1));
+      const vpImagePoint &P0 = m_prevPts[index];
+      double nextU, nextV;
+      if (m_useInitialFlow) {
+        nextU = m_nextPts[index].get_u() * topScale;
+        nextV = m_nextPts[index].get_v() * topScale;
+      }
+      else {
+        nextU = P0.get_u() * topScale;
+        nextV = P0.get_v() * topScale;
+      }
+
+      for (int level = m_nbLevels - 1; level >= 0; level--) {
+        if (level < m_nbLevels - 1) {
+          nextU *= 2.;
+          nextV *= 2.;
+        }
+        const vpImage<unsigned char> &I = m_prevPyr[(size_t)level], &J = m_nextPyr[(size_t)level];
+        const vpImage<short> &dIx = m_dIx[(size_t)level], &dIy = m_dIy[(size_t)level];
+        const double scale = 1. / (1 << level);
+        const double prevU = P0.get_u() * scale - halfWin, prevV = P0.get_v() * scale - halfWin;
+        const int iprevU = (int)floor(prevU), iprevV = (int)floor(prevV);
+        if (! inside(iprevU, iprevV, (int)I.getWidth(), (int)I.getHeight())) {
+          if (level == 0)
+            return false;
+          continue;
+        }
+
+        // Patch and gradients of the previous image, and gradient matrix
+        const vpBilinearWeights wI(prevU - iprevU, prevV - iprevV);
+        double A11 = 0, A12 = 0, A22 = 0;
+        for (int y = 0; y < W; y++) {
+          const size_t offset = (size_t)(y * W);
+          interpolateRow(I[iprevV + y] + iprevU, I[iprevV + y + 1] + iprevU, wI, Ipatch + offset, W);
+          interpolateRow(dIx[iprevV + y] + iprevU, dIx[iprevV + y + 1] + iprevU, wI, Ixpatch + offset, W);
+          interpolateRow(dIy[iprevV + y] + iprevU, dIy[iprevV + y + 1] + iprevU, wI, Iypatch + offset, W);
+          A11 += dotProduct(Ixpatch + offset, Ixpatch + offset, W);
+          A12 += dotProduct(Ixpatch + offset, Iypatch + offset, W);
+          A22 += dotProduct(Iypatch + offset, Iypatch + offset, W);
+        }
+        A11 *= FLT_SCALE;
+        A12 *= FLT_SCALE;
+        A22 *= FLT_SCALE;
+
+        const double D = A11 * A22 - A12 * A12;
+        const double minEig = (A22 + A11 - sqrt((A11 - A22) * (A11 - A22) + 4. * A12 * A12)) / (2. * W * W);
+        if (minEig < m_minEigThreshold || D < FLT_EPSILON) {
+          if (level == 0)
+            return false;
+          continue;
+        }
+
+        double u = nextU - halfWin, v = nextV - halfWin;
+        double prevDeltaU = 0, prevDeltaV = 0;
+        for (unsigned int iter = 0; iter < m_maxIterations; iter++) {
+          const int inextU = (int)floor(u), inextV = (int)floor(v);
+          if (! inside(inextU, inextV, (int)J.getWidth(), (int)J.getHeight())) {
+            if (level == 0)
+              return false;
+            break;
+          }
+
+          const vpBilinearWeights wJ(u - inextU, v - inextV);
+          double b1 = 0, b2 = 0;
+          for (int y = 0; y < W; y++) {
+            const size_t offset = (size_t)(y * W);
+            short *diff = Jpatch + offset;
+            interpolateRow(J[inextV + y] + inextU, J[inextV + y + 1] + inextU, wJ, diff, W);
+            for (int x = 0; x < W; x++)
+              diff[x] = (short)(diff[x] - Ipatch[offset + (size_t)x]);
+            b1 += dotProduct(diff, Ixpatch + offset, W);
+            b2 += dotProduct(diff, Iypatch + offset, W);
+          }
+          b1 *= FLT_SCALE;
+          b2 *= FLT_SCALE;
+
+          const double deltaU = (A12 * b2 - A22 * b1) / D;
+          const double deltaV = (A12 * b1 - A11 * b2) / D;
+          u += deltaU;
+          v += deltaV;
+          if (deltaU * deltaU + deltaV * deltaV <= m_epsilon2)
+            break;
+          // Oscillation around the solution
+          if (iter > 0 && fabs(deltaU + prevDeltaU) < 0.01 && fabs(deltaV + prevDeltaV) < 0.01) {
+            u -= deltaU * 0.5;
+            v -= deltaV * 0.5;
+            break;
+          }
+          prevDeltaU = deltaU;
+          prevDeltaV = deltaV;
+        }
+        nextU = u + halfWin;
+        nextV = v + halfWin;
+      }
+
+      m_nextPts[index].set_uv(nextU, nextV);
+      return true;
+    }
+
+    const std::vector<vpImage<unsigned char> > &m_prevPyr;
+    const std::vector<vpImage<short> > &m_dIx;
+    const std::vector<vpImage<short> > &m_dIy;
+    const std::vector<vpImage<unsigned char> > &m_nextPyr;
+    const int m_nbLevels;
+    const std::vector<vpImagePoint> &m_prevPts;
+    std::vector<vpImagePoint> &m_nextPts;
+    std::vector<unsigned char> &m_status;
+    const bool m_useInitialFlow;
+    const int m_winSize;
+    const unsigned int m_maxIterations;
+    const double m_epsilon2;
+    const double m_minEigThreshold;
+  };
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor.
+ */
+vpKltTracker::vpKltTracker()
+  : m_dIx(), m_dIy(), m_points_id(), m_maxCount(500), m_maxIterations(20), m_epsilon(0.03), m_winSize(10),
+    m_qualityLevel(0.01), m_minDistance(15), m_minEigThreshold(1e-4), m_harris_k(0.04), m_blockSize(3),
+    m_useHarrisDetector(0), m_pyrMaxLevel(3), m_next_points_id(0), m_initial_guess(false)
+{
+}
+
+vpKltTracker::~vpKltTracker()
+{
+}
+
+/*!
+  Build the Gaussian pyramid of an image. The number of levels is limited to
+  getPyramidLevels()+1 and so that the window used to track the features fits
+  in the smallest level.
+*/
+void vpKltTracker::buildPyramid(const vpImage<unsigned char> &I, std::vector<vpImage<unsigned char> > &pyramid) const
+{
+  pyramid.resize(1);
+  pyramid[0] = I;
+  for (int level = 1; level <= m_pyrMaxLevel; level++) {
+    const vpImage<unsigned char> &prev = pyramid[(size_t)level - 1];
+    if ((int)prev.getWidth() / 2 < m_winSize + 2 || (int)prev.getHeight() / 2 < m_winSize + 2)
+      break;
+    pyramid.push_back(vpImage<unsigned char>());
+    vpImageFilter::getGaussPyramidal(pyramid[(size_t)level - 1], pyramid[(size_t)level]);
+  }
+}
+
+/*!
+  Compute the Scharr gradients of the levels of a pyramid in m_dIx and m_dIy.
+*/
+void vpKltTracker::computeGradients(const std::vector<vpImage<unsigned char> > &pyramid)
+{
+  m_dIx.resize(pyramid.size());
+  m_dIy.resize(pyramid.size());
+  for (size_t level = 0; level < pyramid.size(); level++) {
+    m_dIx[level].resize(pyramid[level].getHeight(), pyramid[level].getWidth());
+    m_dIy[level].resize(pyramid[level].getHeight(), pyramid[level].getWidth());
+    vpScharrTask task(pyramid[level], m_dIx[level], m_dIy[level]);
+    vpThreadPool::getInstance().parallelFor(0, pyramid[level].getHeight(), task, 16);
+  }
+}
+
+/*!
+  Detect the corners of an image, sorted by decreasing response.
+
+  \param I : Input image.
+  \param mask : If not NULL, the corners are only detected where the mask is not null.
+  \param features : Detected corners.
+*/
+void vpKltTracker::detectFeatures(const vpImage<unsigned char> &I, const vpImage<unsigned char> *mask,
+                                  std::vector<vpImagePoint> &features) const
+{
+  features.clear();
+  const int w = (int)I.getWidth(), h = (int)I.getHeight();
+  if (w < 3 || h < 3)
+    return;
+  if (mask != NULL && (mask->getWidth() != I.getWidth() || mask->getHeight() != I.getHeight()))
+    throw(vpException(vpException::dimensionError, "The mask and the image have not the same size"));
+
+  std::vector<float> response((size_t)w * (size_t)h);
+  vpCornerResponseTask task(I, std::max(m_blockSize, 1), m_useHarrisDetector != 0, m_harris_k, response);
+  vpThreadPool::getInstance().parallelFor(0, (unsigned int)h, task, 16);
+
+  // As in OpenCV, the quality level is relative to the best corner inside the mask
+  float maxResponse = 0;
+  if (mask == NULL)
+    maxResponse = *std::max_element(response.begin(), response.end());
+  else {
+    for (unsigned int k = 0; k < mask->getSize(); k++) {
+      if (mask->bitmap[k] != 0)
+        maxResponse = std::max(maxResponse, response[(size_t)k]);
+    }
+  }
+  if (maxResponse <= 0)
+    return;
+  const float threshold = (float)(m_qualityLevel * maxResponse);
+
+  // Local maxima of the response above the threshold
+  std::vector<vpCorner> corners;
+  for (int i = 1; i < h - 1; i++) {
+    for (int j = 1; j < w - 1; j++) {
+      const int index = i * w + j;
+      const float r = response[(size_t)index];
+      if (r < threshold || (mask != NULL && (*mask)[i][j] == 0))
+        continue;
+      bool isMax = true;
+      for (int k = -1; k <= 1 && isMax; k++) {
+        const float *row = &response[(size_t)(index + k * w)];
+        isMax = row[-1] <= r && row[0] <= r && row[1] <= r;
+      }
+      if (isMax) {
+        vpCorner c;
+        c.response = r;
+        c.index = index;
+        corners.push_back(c);
+      }
+    }
+  }
+  std::sort(corners.begin(), corners.end());
+
+  // Greedy selection with a minimal distance, checked on the neighbouring cells of a grid
+  const int cellSize = std::max(vpMath::round(m_minDistance), 1);
+  const int gridWidth = (w + cellSize - 1) / cellSize, gridHeight = (h + cellSize - 1) / cellSize;
+  std::vector<std::vector<int> > grid((size_t)(gridWidth * gridHeight));
+  const double minDist2 = m_minDistance * m_minDistance;
+  for (size_t n = 0; n < corners.size(); n++) {
+    if (m_maxCount > 0 && (int)features.size() >= m_maxCount)
+      break;
+    const int y = corners[n].index / w, x = corners[n].index % w;
+    const int cx = x / cellSize, cy = y / cellSize;
+    bool good = true;
+    if (m_minDistance >= 1) {
+      for (int gy = std::max(cy - 1, 0); gy <= std::min(cy + 1, gridHeight - 1) && good; gy++) {
+        for (int gx = std::max(cx - 1, 0); gx <= std::min(cx + 1, gridWidth - 1) && good; gx++) {
+          const std::vector<int> &cell = grid[(size_t)(gy * gridWidth + gx)];
+          for (size_t k = 0; k < cell.size() && good; k++) {
+            const double du = x - features[(size_t)cell[k]].get_u(), dv = y - features[(size_t)cell[k]].get_v();
+            good = du * du + dv * dv >= minDist2;
+          }
+        }
+      }
+    }
+    if (good) {
+      grid[(size_t)(cy * gridWidth + cx)].push_back((int)features.size());
+      features.push_back(vpImagePoint(y, x));
+    }
+  }
+}
+
+/*!
+  Initialise the tracking by extracting KLT keypoints on the provided image.
+
+  \param I : Grey level image used as input.
+  \param mask : Image mask used to restrict the keypoint detection area.
+  If mask is NULL, all the image will be considered.
+
+  \exception vpException::dimensionError : If the mask and the image have
+  not the same size.
+*/
+void vpKltTracker::initTracking(const vpImage<unsigned char> &I, const vpImage<unsigned char> *mask)
+{
+  m_next_points_id = 0;
+  m_initial_guess = false;
+
+  for (size_t i=0; i<2; i++) {
+    m_points[i].clear();
+  }
+
+  m_points_id.clear();
+
+  detectFeatures(I, mask, m_points[1]);
+  for (size_t i=0; i < m_points[1].size(); i++)
+    m_points_id.push_back(m_next_points_id++);
+
+  buildPyramid(I, m_pyramid[1]);
+  m_pyramid[0].clear();
+}
+
+/*!
+  Set the points that will be used as initialization during the next call to track().
+
+  \param I : Input image.
+  \param pts : Vector of points that should be tracked.
+*/
+void vpKltTracker::initTracking(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &pts)
+{
+  m_initial_guess = false;
+  m_points[1] = pts;
+  m_next_points_id = 0;
+  m_points_id.clear();
+  for(size_t i=0; i < m_points[1].size(); i++) {
+    m_points_id.push_back(m_next_points_id ++);
+  }
+
+  buildPyramid(I, m_pyramid[1]);
+  m_pyramid[0].clear();
+}
+
+/*!
+  Set the points and their ids that will be used as initialization during the
+  next call to track().
+
+  \param I : Input image.
+  \param pts : Vector of points that should be tracked.
+  \param ids : Ids of the points. If the size of this vector differs from the
+  one of \e pts, new ids are given to the points.
+*/
+void vpKltTracker::initTracking(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &pts,
+                                const std::vector<long> &ids)
+{
+  m_initial_guess = false;
+  m_points[1] = pts;
+  m_points_id.clear();
+
+  if(ids.size() != pts.size()){
+    m_next_points_id = 0;
+    for(size_t i=0; i < m_points[1].size(); i++)
+      m_points_id.push_back(m_next_points_id ++);
+  }
+  else{
+    long max = 0;
+    for(size_t i=0; i < m_points[1].size(); i++){
+      m_points_id.push_back(ids[i]);
+      if(ids[i] > max) max = ids[i];
+    }
+    m_next_points_id = max + 1;
+  }
+
+  buildPyramid(I, m_pyramid[1]);
+  m_pyramid[0].clear();
+}
+
+/*!
+   Track KLT keypoints using the iterative Lucas-Kanade method with pyramids.
+   The features that are lost are removed from the list of features.
+
+   \param I : Input image.
+
+   \exception vpTrackingException::fatalError : If there is no feature to track.
+ */
+void vpKltTracker::track(const vpImage<unsigned char> &I)
+{
+  if(m_points[1].size() == 0)
+    throw vpTrackingException(vpTrackingException::fatalError, "Not enough key points to track.");
+
+  const bool useInitialFlow = m_initial_guess;
+  if (m_initial_guess) {
+    m_initial_guess = false;
+  }
+  else {
+    std::swap(m_points[1], m_points[0]);
+    m_points[1] = m_points[0];
+  }
+
+  std::swap(m_pyramid[0], m_pyramid[1]);
+  buildPyramid(I, m_pyramid[1]);
+  if (m_pyramid[0].empty())
+    m_pyramid[0] = m_pyramid[1];
+  computeGradients(m_pyramid[0]);
+
+  const int nbLevels = (int)std::min(m_pyramid[0].size(), m_pyramid[1].size());
+  std::vector<unsigned char> status(m_points[0].size());
+  vpLucasKanadeTask task(m_pyramid[0], m_dIx, m_dIy, m_pyramid[1], nbLevels, m_points[0], m_points[1], status,
+                         useInitialFlow, m_winSize, m_maxIterations, m_epsilon, m_minEigThreshold);
+  vpThreadPool::getInstance().parallelFor(0, (unsigned int)status.size(), task, 8);
+
+  // Remove points that are lost
+  for (int i=(int)status.size()-1; i>=0; i--) {
+    if (status[(size_t)i] == 0) { // point is lost
+      m_points[0].erase(m_points[0].begin()+i);
+      m_points[1].erase(m_points[1].begin()+i);
+      m_points_id.erase(m_points_id.begin()+i);
+    }
+  }
+}
+
+/*!
+  Get the 'index'th feature image coordinates.  Beware that
+  getFeature(i,...) may not represent the same feature before and
+  after a tracking iteration (if a feature is lost, features are
+  shifted in the array).
+
+  \param index : Index of feature.
+  \param id : id of the feature.
+  \param x : x coordinate.
+  \param y : y coordinate.
+*/
+void vpKltTracker::getFeature(const int &index, long &id, float &x, float &y) const
+{
+  if ((size_t)index >= m_points[1].size()){
+    throw(vpException(vpException::badValue, "Feature [%d] doesn't exist", index));
+  }
+
+  x = (float)m_points[1][(size_t)index].get_u();
+  y = (float)m_points[1][(size_t)index].get_v();
+  id = m_points_id[(size_t)index];
+}
+
+/*!
+  Display features position and id.
+
+  \param I : Image used as background. Display should be initialized on it.
+  \param color : Color used to display the features.
+  \param thickness : Thickness of the drawings.
+  */
+void vpKltTracker::display(const vpImage<unsigned char> &I, const vpColor &color, unsigned int thickness) const
+{
+  vpKltTracker::display(I, m_points[1], m_points_id, color, thickness);
+}
+
+/*!
+
+  Display features list with ids.
+
+  \param I : The image used as background.
+
+  \param features : Vector of features.
+
+  \param featuresid : Vector of ids corresponding to the features.
+
+  \param color : Color used to display the points.
+
+  \param thickness : Thickness of the points
+*/
+void vpKltTracker::display(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &features,
+                           const std::vector<long> &featuresid, const vpColor &color, unsigned int thickness)
+{
+  for (size_t i = 0; i < features.size(); i++) {
+    vpDisplay::displayCross(I, features[i], 10, color, thickness);
+
+    if (i < featuresid.size()) {
+      std::ostringstream id;
+      id << featuresid[i];
+      vpDisplay::displayText(I, features[i] + vpImagePoint(0, 5), id.str(), color);
+    }
+  }
+}
+
+/*!
+  Set the size of the averaging block used to compute the corner response.
+
+  \param blockSize : Size of an average block for computing a derivative
+  covariation matrix over each pixel neighborhood. Default value is set to 3.
+*/
+void vpKltTracker::setBlockSize(const int blockSize)
+{
+  m_blockSize = blockSize;
+}
+
+/*!
+  Set the free parameter of the Harris detector.
+
+  \param harris_k : Free parameter of the Harris detector. Default value is set to 0.04.
+*/
+void vpKltTracker::setHarrisFreeParameter(double harris_k)
+{
+  m_harris_k = harris_k;
+}
+
+/*!
+  Set the points that will be used as initial guess during the next call to track().
+  A typical usage of this function is to predict the position of the features before the
+  next call to track().
+
+  \param guess_pts : Vector of points that should be tracked. The size of this vector should be the same as the
+  one returned by getFeatures(). If this is not the case, an exception is returned. Note also that the id of the
+  points is not modified.
+
+  \sa initTracking()
+*/
+void vpKltTracker::setInitialGuess(const std::vector<vpImagePoint> &guess_pts)
+{
+  if(guess_pts.size() != m_points[1].size()){
+    throw(vpException(vpException::badValue,
+                      "Cannot set initial guess: size feature vector [%d] and guess vector [%d] doesn't match",
+                      m_points[1].size(), guess_pts.size()));
+  }
+
+  m_points[0] = m_points[1];
+  m_points[1] = guess_pts;
+  m_initial_guess = true;
+}
+
+/*!
+  Set the points that will be used as initial guess during the next call to track().
+  A typical usage of this function is to predict the position of the features before the
+  next call to track().
+
+  \param init_pts : Initial points (could be obtained from getPrevFeatures() or getFeatures()).
+  \param guess_pts : Prediction of the new position of the initial points. The size of this vector must be the same as the size of the vector of initial points.
+  \param fid : Identifiers of the initial points.
+
+  \sa getPrevFeatures()
+  \sa getFeatures(), getFeaturesId
+  \sa initTracking()
+*/
+void vpKltTracker::setInitialGuess(const std::vector<vpImagePoint> &init_pts, const std::vector<vpImagePoint> &guess_pts,
+                                   const std::vector<long> &fid)
+{
+  if(guess_pts.size() != init_pts.size()){
+    throw(vpException(vpException::badValue,
+                      "Cannot set initial guess: size init vector [%d] and guess vector [%d] doesn't match",
+                      init_pts.size(), guess_pts.size()));
+  }
+
+  m_points[0] = init_pts;
+  m_points[1] = guess_pts;
+  m_points_id = fid;
+  m_initial_guess = true;
+}
+
+/*!
+  Set the maximum number of features to track in the image.
+
+  \param maxCount : Maximum number of features to detect and track. If not
+  positive, all the detected features are kept. Default value is set to 500.
+*/
+void vpKltTracker::setMaxFeatures(const int maxCount)
+{
+  m_maxCount = maxCount;
+}
+
+/*!
+  Set the minimal Euclidean distance between detected corners during initialization.
+
+  \param minDistance : Minimal possible Euclidean distance between the detected corners.
+  Default value is set to 15.
+*/
+void vpKltTracker::setMinDistance(double minDistance)
+{
+  m_minDistance = minDistance;
+}
+
+/*!
+  Set the minimal eigen value threshold used to reject a point during the tracking.
+
+  \param minEigThreshold : The algorithm calculates the minimum eigen value of a 2x2
+  normal matrix of optical flow equations, divided by number of pixels in a window;
+  if this value is less than minEigThreshold, then a corresponding feature is filtered
+  out and its flow is not processed, so it allows to remove bad points and get a performance boost.
+  Default value is set to 1e-4.
+*/
+void vpKltTracker::setMinEigThreshold(double minEigThreshold)
+{
+  m_minEigThreshold = minEigThreshold;
+}
+
+/*!
+  Set the maximal pyramid level. If the level is zero, then no pyramid is
+  computed for the optical flow.
+
+  \param pyrMaxLevel : 0-based maximal pyramid level number; if 0, pyramids are not used
+  (single level), if 1, two levels are used, and so on. Default value is set to 3.
+*/
+void vpKltTracker::setPyramidLevels(const int pyrMaxLevel)
+{
+  m_pyrMaxLevel = pyrMaxLevel;
+}
+
+/*!
+  Set the parameter characterizing the minimal accepted quality of image corners.
+
+  \param qualityLevel : Quality level parameter. Default value is set to 0.01.
+  The parameter value is multiplied by the best corner quality measure,
+  which is the minimal eigenvalue or the Harris function response.
+  The corners with the quality measure less than the product are rejected.
+  For example, if the best corner has the quality measure = 1500, and the
+  qualityLevel=0.01, then all the corners with the quality measure less than 15 are rejected.
+*/
+void vpKltTracker::setQuality(double qualityLevel)
+{
+  m_qualityLevel = qualityLevel;
+}
+
+/*!
+  Set the detector used to extract the features.
+
+  \param useHarrisDetector : If 0, the features are detected with the
+  Shi-Tomasi detector (minimal eigenvalue of the gradient matrix), otherwise
+  with the Harris detector. Default value is set to 0.
+*/
+void vpKltTracker::setUseHarris(const int useHarrisDetector)
+{
+  m_useHarrisDetector = useHarrisDetector;
+}
+
+/*!
+  Set the size of the window used to track the features.
+
+  \param winSize : Side length of the patch that is tracked around each feature.
+  Default value is set to 10.
+*/
+void vpKltTracker::setWindowSize(const int winSize)
+{
+  m_winSize = winSize;
+}
+
+/*!
+   Remove the feature with the given index as parameter.
+   \param index : Index of the feature to remove.
+ */
+void vpKltTracker::suppressFeature(const int &index)
+{
+  if ((size_t)index >= m_points[1].size()){
+    throw(vpException(vpException::badValue, "Feature [%d] doesn't exist", index));
+  }
+
+  m_points[1].erase(m_points[1].begin()+index);
+  m_points_id.erase(m_points_id.begin()+index);
+}
+
+/*!
+
+  Add a keypoint at the end of the feature list. The id of the feature is set to ensure that it is unique.
+  \param x,y : Coordinates of the feature in the image.
+
+*/
+void vpKltTracker::addFeature(const float &x, const float &y)
+{
+  m_points[1].push_back(vpImagePoint(y, x));
+  m_points_id.push_back(m_next_points_id++);
+}
+
+/*!
+
+  Add a keypoint at the end of the feature list.
+
+  \warning This function doesn't ensure that the id of the feature is unique.
+  You should rather use addFeature(const float &, const float &).
+
+  \param id : Feature id. Should be unique
+  \param x,y : Coordinates of the feature in the image.
+
+*/
+void vpKltTracker::addFeature(const long &id, const float &x, const float &y)
+{
+  m_points[1].push_back(vpImagePoint(y, x));
+  m_points_id.push_back(id);
+  if (id >= m_next_points_id)
+    m_next_points_id = id + 1;
+}
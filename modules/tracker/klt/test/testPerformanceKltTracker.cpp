@@ -0,0 +1,164 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the KLT tracker on a translated synthetic texture.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceKltTracker.cpp
+
+  \brief Check that vpKltTracker detects features on a synthetic texture and
+  retrieves their translation between two images, that the result does not
+  depend on the number of threads, and measure the time spent to track them.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/klt/vpKltTracker.h>
+
+namespace {
+  //! Smooth texture translated by (du, dv)
+  void createImage(vpImage<unsigned char> &I, const double du, const double dv)
+  {
+    I.resize(480, 640);
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        const double u = j - du, v = i - dv;
+        const double val = 128 + 30 * sin(0.21 * u + 0.05 * v) + 30 * sin(-0.07 * u + 0.19 * v)
+            + 25 * cos(0.13 * u + 0.11 * v + 1.) + 20 * sin(0.035 * u - 0.043 * v);
+        I[i][j] = (unsigned char)vpMath::round(std::max(0., std::min(255., val)));
+      }
+    }
+  }
+
+  bool sameFeatures(const std::vector<vpImagePoint> &a, const std::vector<vpImagePoint> &b)
+  {
+    if (a.size() != b.size())
+      return false;
+    for (size_t i = 0; i < a.size(); i++) {
+      if (a[i] != b[i])
+        return false;
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    const double du = 6.3, dv = -4.6;
+    vpImage<unsigned char> I0, I1;
+    createImage(I0, 0, 0);
+    createImage(I1, du, dv);
+
+    vpKltTracker tracker;
+    tracker.setMaxFeatures(300);
+    tracker.setWindowSize(15);
+    tracker.setQuality(0.01);
+    tracker.setMinDistance(10);
+    tracker.setPyramidLevels(3);
+    tracker.initTracking(I0);
+    const int nbDetected = tracker.getNbFeatures();
+    if (nbDetected < 100) {
+      std::cerr << "Only " << nbDetected << " features detected" << std::endl;
+      return EXIT_FAILURE;
+    }
+    // Minimal distance between the features
+    std::vector<vpImagePoint> features = tracker.getFeatures();
+    for (size_t i = 0; i < features.size(); i++) {
+      for (size_t j = i + 1; j < features.size(); j++) {
+        if (vpImagePoint::sqrDistance(features[i], features[j]) < 100.) {
+          std::cerr << "Features " << i << " and " << j << " are too close" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    vpThreadPool::getInstance().setNumThreads(1);
+    tracker.track(I1);
+    const std::vector<vpImagePoint> tracked = tracker.getFeatures();
+    const std::vector<vpImagePoint> initial = tracker.getPrevFeatures();
+    if (tracker.getNbFeatures() < nbDetected * 8 / 10) {
+      std::cerr << "Only " << tracker.getNbFeatures() << " features tracked on " << nbDetected << std::endl;
+      return EXIT_FAILURE;
+    }
+    double meanError = 0;
+    for (size_t i = 0; i < tracked.size(); i++) {
+      meanError += sqrt(vpMath::sqr(tracked[i].get_u() - initial[i].get_u() - du) +
+                        vpMath::sqr(tracked[i].get_v() - initial[i].get_v() - dv));
+    }
+    meanError /= tracked.size();
+    std::cout << tracked.size() << " features tracked on " << nbDetected << ", mean error: " << meanError << " pixel"
+              << std::endl;
+    if (meanError > 0.1) {
+      std::cerr << "The features are not tracked accurately" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Same result with several threads
+    vpThreadPool::getInstance().setNumThreads(4);
+    tracker.initTracking(I0);
+    tracker.track(I1);
+    if (! sameFeatures(tracker.getFeatures(), tracked)) {
+      std::cerr << "The tracked features depend on the number of threads" << std::endl;
+      return EXIT_FAILURE;
+    }
+    vpThreadPool::getInstance().setNumThreads(vpThreadPool::getNumberOfCPU());
+
+    // Benchmark
+    const unsigned int nb_iter = 20;
+    double t_init = 0, t_track = 0;
+    for (unsigned int iter = 0; iter < nb_iter; iter++) {
+      double t = vpTime::measureTimeMs();
+      tracker.initTracking(I0);
+      t_init += vpTime::measureTimeMs() - t;
+
+      t = vpTime::measureTimeMs();
+      tracker.track(I1);
+      t_track += vpTime::measureTimeMs() - t;
+    }
+    std::cout << "Detection of " << nbDetected << " features: " << t_init / nb_iter << " ms" << std::endl;
+    std::cout << "Tracking of " << nbDetected << " features: " << t_track / nb_iter << " ms" << std::endl;
+
+    std::cout << "testPerformanceKltTracker is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -160,6 +160,15 @@ public:
     return m_factorMBT;
   }
 
+  /*!
+    Return the maximum number of threads used to process the cameras.
+
+    \sa setNbCameraThreads()
+  */
+  inline unsigned int getNbCameraThreads() const {
+    return vpMbEdgeMultiTracker::getNbCameraThreads();
+  }
+
   virtual unsigned int getNbPolygon() const;
   virtual std::map<std::string, unsigned int> getEdgeMultiNbPolygon() const;
   virtual std::map<std::string, unsigned int> getKltMultiNbPolygon() const;
@@ -314,6 +323,20 @@ public:
   virtual void setMinPolygonAreaThresh(const double minPolygonAreaThresh, const std::string &cameraName,
       const std::string &name);
 
+  /*!
+    Set the maximum number of threads used to process the cameras, both for the
+    moving-edge and the KLT tracking.
+
+    \param nbThreads : Maximum number of threads. 1 processes the cameras sequentially
+    in the calling thread, 0 (default) uses vpThreadPool::getNumThreads() threads.
+
+    \sa vpMbEdgeMultiTracker::setNbCameraThreads(), vpMbKltMultiTracker::setNbCameraThreads()
+  */
+  virtual void setNbCameraThreads(const unsigned int nbThreads) {
+    vpMbEdgeMultiTracker::setNbCameraThreads(nbThreads);
+    vpMbKltMultiTracker::setNbCameraThreads(nbThreads);
+  }
+
   virtual void setNearClippingDistance(const double &dist);
   virtual void setNearClippingDistance(const std::string &cameraName, const double &dist);
 
@@ -76,9 +76,14 @@ protected:
   //! Map of pyramidal images for each camera
   std::map<std::string, std::vector<const vpImage<unsigned char>* > > m_mapOfPyramidalImages;
 
+  //! Map of the pyramids whose levels are pointed by m_mapOfPyramidalImages
+  std::map<std::string, vpImagePyramid> m_mapOfImagePyramids;
+
   //! Name of the reference camera
   std::string m_referenceCameraName;
 
+  //! Maximum number of threads used to process the cameras, 0 to use all the threads of vpThreadPool.
+  unsigned int m_nbCameraThreads;
 
 public:
   // Default constructor <==> equivalent to vpMbEdgeTracker
@@ -118,6 +123,13 @@ public:
 
   virtual std::vector<std::string> getCameraNames() const;
 
+  /*!
+    Return the maximum number of threads used to process the cameras.
+
+    \sa setNbCameraThreads()
+  */
+  inline unsigned int getNbCameraThreads() const { return m_nbCameraThreads; }
+
   virtual void getCameraParameters(vpCameraParameters &camera) const;
   virtual void getCameraParameters(vpCameraParameters &cam1, vpCameraParameters &cam2) const;
   virtual void getCameraParameters(const std::string &cameraName, vpCameraParameters &camera) const;
@@ -283,6 +295,20 @@ public:
   virtual void setMovingEdge(const vpMe &me);
   virtual void setMovingEdge(const std::string &cameraName, const vpMe &me);
 
+  /*!
+    Set the maximum number of threads used to process the cameras. The moving-edge
+    tracking, the visibility test and the computation of the interaction matrix and
+    of the residual of each camera are distributed over the threads of vpThreadPool;
+    each camera is processed by a single thread, so that the estimated pose does not
+    depend on the number of threads.
+
+    \param nbThreads : Maximum number of threads. 1 processes the cameras sequentially
+    in the calling thread, 0 (default) uses vpThreadPool::getNumThreads() threads.
+
+    \sa vpMbEdgeTracker::setNbMovingEdgeThreads()
+  */
+  virtual void setNbCameraThreads(const unsigned int nbThreads) { m_nbCameraThreads = nbThreads; }
+
   virtual void setNearClippingDistance(const double &dist);
   virtual void setNearClippingDistance(const std::string &cameraName, const double &dist);
 
@@ -333,6 +359,8 @@ protected:
     LINE, CYLINDER, CIRCLE
   } FeatureType;
 
+  class CameraTask;
+
   /** @name Protected Member Functions Inherited from vpMbEdgeMultiTracker */
   //@{
   virtual void cleanPyramid(std::map<std::string, std::vector<const vpImage<unsigned char>* > >& pyramid);
@@ -354,6 +382,12 @@ protected:
 
   virtual void initPyramid(const std::map<std::string, const vpImage<unsigned char> * >& mapOfImages,
       std::map<std::string, std::vector<const vpImage<unsigned char>* > >& pyramid);
+
+  void processCamera(CameraTask &task, const unsigned int index);
+
+  void runCameraTask(CameraTask &task);
+
+  virtual void trackMovingEdges(std::map<std::string, const vpImage<unsigned char> *> &mapOfImages);
   //@}
 };
 
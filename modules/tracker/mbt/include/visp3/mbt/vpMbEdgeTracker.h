@@ -45,6 +45,7 @@
 #ifndef vpMbEdgeTracker_HH
 #define vpMbEdgeTracker_HH
 
+#include <visp3/core/vpImagePyramid.h>
 #include <visp3/core/vpPoint.h>
 #include <visp3/mbt/vpMbTracker.h>
 #include <visp3/me/vpMe.h>
@@ -304,6 +305,9 @@ class VISP_EXPORT vpMbEdgeTracker: virtual public vpMbTracker
     
     //! Pyramid of image associated to the current image. This pyramid is computed in the init() and in the track() methods.
     std::vector< const vpImage<unsigned char>* > Ipyramid;
+
+    //! Levels pointed by Ipyramid, kept from one image to the next one.
+    vpImagePyramid imagePyramid;
     
     //! Current scale level used. This attribute must not be modified outside of the downScale() and upScale() methods, as it used to specify to some methods which set of distanceLine use. 
     unsigned int scaleLevel;
@@ -311,6 +315,9 @@ class VISP_EXPORT vpMbEdgeTracker: virtual public vpMbTracker
     //! Number of features used in the computation of the projection error
     unsigned int nbFeaturesForProjErrorComputation;
 
+    //! Maximum number of threads used to track the moving edges, 0 to use all the threads of vpThreadPool.
+    unsigned int nbMovingEdgeThreads;
+
 public:
   
   vpMbEdgeTracker(); 
@@ -348,6 +355,23 @@ public:
   */
   virtual inline vpMe getMovingEdge() const { return this->me;}
 
+  /*!
+    Return the pyramid of the last image given to init() or track(). Its levels
+    can be reused by other trackers working on the same image, as long as this
+    image exists, see vpImagePyramid::getGeneration().
+
+    \return The pyramid, built by subsampling the image.
+  */
+  const vpImagePyramid &getImagePyramid() const { return imagePyramid; }
+
+  /*!
+    Return the maximum number of threads used to track the moving edges of the
+    lines, cylinders and circles.
+
+    \sa setNbMovingEdgeThreads()
+  */
+  inline unsigned int getNbMovingEdgeThreads() const { return nbMovingEdgeThreads; }
+
   virtual unsigned int getNbPoints(const unsigned int level=0) const;
   
   /*!
@@ -459,6 +483,17 @@ public:
   
   void setMovingEdge(const vpMe &me);
 
+  /*!
+    Set the maximum number of threads used to track the moving edges. The lines,
+    cylinders and circles are distributed over the threads of vpThreadPool; each
+    feature is processed by a single thread, so that the results do not depend on
+    the number of threads.
+
+    \param nbThreads : Maximum number of threads. 1 tracks the features sequentially
+    in the calling thread, 0 (default) uses vpThreadPool::getNumThreads() threads.
+  */
+  inline void setNbMovingEdgeThreads(const unsigned int nbThreads) { nbMovingEdgeThreads = nbThreads; }
+
   virtual void setPose(const vpImage<unsigned char> &I, const vpHomogeneousMatrix& cdMo);
   
   void setScales(const std::vector<bool>& _scales);
@@ -477,6 +512,7 @@ protected:
   void addLine(vpPoint &p1, vpPoint &p2, int polygon = -1, std::string name = "");
   void addPolygon(vpMbtPolygon &p) ;
 
+  void buildPyramid(const vpImage<unsigned char>& I);
   void cleanPyramid(std::vector<const vpImage<unsigned char>* >& _pyramid);
   void computeProjectionError(const vpImage<unsigned char>& _I);
 
@@ -514,7 +550,9 @@ protected:
   unsigned int initMbtTracking(unsigned int &nberrors_lines, unsigned int &nberrors_cylinders, unsigned int &nberrors_circles);
   void initMovingEdge(const vpImage<unsigned char> &I, const vpHomogeneousMatrix &_cMo) ;
   void initPyramid(const vpImage<unsigned char>& _I, std::vector<const vpImage<unsigned char>* >& _pyramid);
+  void processMovingEdges(const vpImage<unsigned char> &I, const bool update);
   void reInitLevel(const unsigned int _lvl);
+  void releasePyramid();
   void reinitMovingEdge(const vpImage<unsigned char> &I, const vpHomogeneousMatrix &_cMo);
   void removeCircle(const std::string& name);
   void removeCylinder(const std::string& name);
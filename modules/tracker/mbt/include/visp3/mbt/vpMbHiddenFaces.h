@@ -51,6 +51,7 @@
   #include <visp3/ar/vpAROgre.h>
 #endif
 
+#include <algorithm>
 #include <vector>
 #include <limits>
 
@@ -71,6 +72,44 @@ class vpMbHiddenFaces
   //! Number of visible polygon
   unsigned int nbVisiblePolygon;
   vpMbScanLine scanlineRender;
+  //! Maximum translation of the camera to reuse the last visibility test
+  double visibilityCacheTranslation;
+  //! Maximum rotation of the camera (in rad) to reuse the last visibility test
+  double visibilityCacheRotation;
+  //! True if the visibility results stored in the cache can be reused
+  bool visibilityCacheValid;
+  //! Pose used for the last full visibility test
+  vpHomogeneousMatrix visibilityCacheMo;
+  //! Angles, camera parameters and image size used for the last full visibility test
+  std::vector<double> visibilityCacheParameters;
+  //! Visibility and appearance of the faces after the last full visibility test
+  std::vector<bool> visibilityCacheVisible, visibilityCacheAppearing;
+  //! Number of faces whose visibility has been tested during the last call to setVisible()
+  unsigned int nbFacesRecomputed;
+
+  //! Node of the bounding volume hierarchy of the faces
+  struct vpMbHiddenFacesBVHNode
+  {
+    //! Bounding box of the faces of the node in the object frame
+    double bbMin[3], bbMax[3];
+    //! Range [first, last[ of the faces of the node in bvhFaces
+    unsigned int first, last;
+    //! Index of the first of the two children, 0 for a leaf
+    unsigned int children;
+  };
+  //! Bounding volume hierarchy of the faces, built from their object frame coordinates
+  std::vector<vpMbHiddenFacesBVHNode> bvhNodes;
+  //! Faces sorted so that the faces of a node are contiguous
+  std::vector<unsigned int> bvhFaces;
+  //! True if the hierarchy matches the faces
+  bool bvhValid;
+  //! Number of faces culled by the hierarchy during the last call to computeClippedPolygons()
+  unsigned int nbFacesCulled;
+
+  void buildBVH();
+  bool isBVHNodeClipped(const vpMbHiddenFacesBVHNode &node, const vpHomogeneousMatrix &cMo,
+                        const vpCameraParameters &cam, const unsigned int clippingFlag,
+                        const double distNearClip, const double distFarClip) const;
   
 #ifdef VISP_HAVE_OGRE
   vpImage<unsigned char> ogreBackground;
@@ -88,6 +127,9 @@ class vpMbHiddenFaces
                            const vpImage<unsigned char> &I = vpImage<unsigned char>(),
                            const vpCameraParameters &cam = vpCameraParameters()) ;
 
+  std::vector<double> getVisibilityCacheParameters(const double &angleAppears, const double &angleDisappears,
+                                                   const vpImage<unsigned char> &I, const vpCameraParameters &cam) const;
+
   public :
                     vpMbHiddenFaces() ;
                   ~vpMbHiddenFaces() ;
@@ -111,6 +153,31 @@ class vpMbHiddenFaces
 
     vpMbScanLine& getMbScanLineRenderer() { return scanlineRender; }
 
+    /*!
+      Get the number of faces whose visibility has been tested during the last call to setVisible().
+      The other faces reused the results of a previous test.
+
+      \sa setVisibilityCacheThresholds()
+
+      \return Number of tested faces.
+    */
+    unsigned int getNbFacesRecomputed() const { return nbFacesRecomputed; }
+
+    /*!
+      Get the number of scanlines processed by the last call to computeScanLineRender().
+
+      \return Number of processed X and Y-axis scanlines, 0 if the previous render has been reused.
+    */
+    unsigned int getNbScanLinesRecomputed() const { return scanlineRender.getNbScanLinesComputed(); }
+
+    /*!
+      Get the number of faces that have been found entirely out of the clipping planes
+      thanks to the bounding volume hierarchy during the last call to computeClippedPolygons().
+
+      \return Number of culled faces.
+    */
+    unsigned int getNbFacesCulled() const { return nbFacesCulled; }
+
 #ifdef VISP_HAVE_OGRE
     void          displayOgre(const vpHomogeneousMatrix &cMo);
 #endif   
@@ -192,6 +259,8 @@ class vpMbHiddenFaces
     inline const PolygonType*  operator[](const unsigned int i) const { return Lpol[i];}
 
     void          reset();
+
+    void          setVisibilityCacheThresholds(const double &translation, const double &rotation);
     
 #ifdef VISP_HAVE_OGRE
     /*!
@@ -259,7 +328,10 @@ class vpMbHiddenFaces
 */
 template<class PolygonType>
 vpMbHiddenFaces<PolygonType>::vpMbHiddenFaces()
-  : Lpol(), nbVisiblePolygon(0), scanlineRender()
+  : Lpol(), nbVisiblePolygon(0), scanlineRender(), visibilityCacheTranslation(0.), visibilityCacheRotation(0.),
+    visibilityCacheValid(false), visibilityCacheMo(), visibilityCacheParameters(),
+    visibilityCacheVisible(), visibilityCacheAppearing(), nbFacesRecomputed(0),
+    bvhNodes(), bvhFaces(), bvhValid(false), nbFacesCulled(0)
 {
 #ifdef VISP_HAVE_OGRE
   ogreInitialised = false;
@@ -325,6 +397,8 @@ vpMbHiddenFaces<PolygonType>::addPolygon(PolygonType *p)
   for(unsigned int i = 0; i < p->nbpt; i++)
     p_new->p[i]= p->p[i];
   Lpol.push_back(p_new);
+  visibilityCacheValid = false;
+  bvhValid = false;
 }
 
 /*!
@@ -335,6 +409,8 @@ void
 vpMbHiddenFaces<PolygonType>::reset()
 {
   nbVisiblePolygon = 0;
+  visibilityCacheValid = false;
+  bvhValid = false;
   for(unsigned int i = 0 ; i < Lpol.size() ; i++){
     if (Lpol[i]!=NULL){
       delete Lpol[i] ;
@@ -367,9 +443,207 @@ vpMbHiddenFaces<PolygonType>::reset()
 #endif
 }
 
+/*!
+  Set the bounds under which the visibility of the faces is not tested again.
+
+  When the camera moved by less than \e translation and \e rotation since the last
+  visibility test, setVisible() only updates the coordinates of the faces in the camera
+  frame and keeps their previous visibility. The reference pose is the one of the
+  last test, so that small motions cannot accumulate. Faces using the level of detail
+  are always tested. The cache is not used with Ogre and it is invalidated when the
+  angles, the camera parameters, the image size or the faces change.
+
+  \warning As the hysteresis of the visibility test is skipped, the faces may appear
+  or disappear with a small delay. The cache is disabled by default.
+
+  \param translation : Maximum translation of the camera (in meter).
+  \param rotation : Maximum rotation of the camera (in rad).
+  Setting one of the bounds to 0 disables the cache.
+*/
+template<class PolygonType>
+void
+vpMbHiddenFaces<PolygonType>::setVisibilityCacheThresholds(const double &translation, const double &rotation)
+{
+  visibilityCacheTranslation = translation;
+  visibilityCacheRotation = rotation;
+  visibilityCacheValid = false;
+}
+
+/*!
+  Get the parameters that have to be unchanged to reuse the visibility cache.
+*/
+template<class PolygonType>
+std::vector<double>
+vpMbHiddenFaces<PolygonType>::getVisibilityCacheParameters(const double &angleAppears, const double &angleDisappears,
+                                                           const vpImage<unsigned char> &I,
+                                                           const vpCameraParameters &cam) const
+{
+  std::vector<double> parameters(9);
+  parameters[0] = angleAppears;
+  parameters[1] = angleDisappears;
+  parameters[2] = cam.get_px();
+  parameters[3] = cam.get_py();
+  parameters[4] = cam.get_u0();
+  parameters[5] = cam.get_v0();
+  parameters[6] = (double)I.getWidth();
+  parameters[7] = (double)I.getHeight();
+  parameters[8] = (double)Lpol.size();
+  return parameters;
+}
+
+/*!
+  Build the bounding volume hierarchy of the faces from the coordinates of their
+  points in the object frame. The faces are split at the median of the longest axis
+  of their centers until a node contains a few faces.
+*/
+template<class PolygonType>
+void
+vpMbHiddenFaces<PolygonType>::buildBVH()
+{
+  const unsigned int nbFaces = (unsigned int)Lpol.size();
+  const unsigned int leafSize = 4;
+
+  // Bounding box and center of each face
+  std::vector<double> faceBoxes(6 * nbFaces);
+  std::vector<std::pair<double, unsigned int> > centers(nbFaces);
+  for (unsigned int i = 0; i < nbFaces; i++){
+    double *box = &faceBoxes[6 * i];
+    for (unsigned int k = 0; k < 3; k++){
+      box[k] = std::numeric_limits<double>::max();
+      box[3 + k] = -std::numeric_limits<double>::max();
+    }
+    for (unsigned int j = 0; j < Lpol[i]->nbpt; j++){
+      const double P[3] = { Lpol[i]->p[j].get_oX(), Lpol[i]->p[j].get_oY(), Lpol[i]->p[j].get_oZ() };
+      for (unsigned int k = 0; k < 3; k++){
+        box[k] = (std::min)(box[k], P[k]);
+        box[3 + k] = (std::max)(box[3 + k], P[k]);
+      }
+    }
+  }
+
+  bvhFaces.resize(nbFaces);
+  for (unsigned int i = 0; i < nbFaces; i++)
+    bvhFaces[i] = i;
+
+  bvhNodes.clear();
+  bvhNodes.reserve(nbFaces > 0 ? 2 * ((nbFaces + leafSize - 1) / leafSize) : 1);
+  vpMbHiddenFacesBVHNode root;
+  root.first = 0;
+  root.last = nbFaces;
+  root.children = 0;
+  bvhNodes.push_back(root);
+
+  // The nodes are split in the order they are created
+  for (unsigned int n = 0; n < bvhNodes.size(); n++){
+    vpMbHiddenFacesBVHNode &node = bvhNodes[n];
+    double cMin[3], cMax[3];
+    for (unsigned int k = 0; k < 3; k++){
+      node.bbMin[k] = cMin[k] = std::numeric_limits<double>::max();
+      node.bbMax[k] = cMax[k] = -std::numeric_limits<double>::max();
+    }
+    for (unsigned int i = node.first; i < node.last; i++){
+      const double *box = &faceBoxes[6 * bvhFaces[i]];
+      if (box[0] > box[3]) // No point
+        continue;
+      for (unsigned int k = 0; k < 3; k++){
+        node.bbMin[k] = (std::min)(node.bbMin[k], box[k]);
+        node.bbMax[k] = (std::max)(node.bbMax[k], box[3 + k]);
+        const double c = 0.5 * (box[k] + box[3 + k]);
+        cMin[k] = (std::min)(cMin[k], c);
+        cMax[k] = (std::max)(cMax[k], c);
+      }
+    }
+
+    if (node.last - node.first <= leafSize)
+      continue;
+
+    unsigned int axis = 0;
+    for (unsigned int k = 1; k < 3; k++)
+      if (cMax[k] - cMin[k] > cMax[axis] - cMin[axis])
+        axis = k;
+
+    for (unsigned int i = node.first; i < node.last; i++){
+      const double *box = &faceBoxes[6 * bvhFaces[i]];
+      centers[i].first = 0.5 * (box[axis] + box[3 + axis]);
+      centers[i].second = bvhFaces[i];
+    }
+    const unsigned int middle = (node.first + node.last) / 2;
+    std::nth_element(centers.begin() + node.first, centers.begin() + middle, centers.begin() + node.last);
+    for (unsigned int i = node.first; i < node.last; i++)
+      bvhFaces[i] = centers[i].second;
+
+    vpMbHiddenFacesBVHNode left, right;
+    left.first = node.first;
+    left.last = right.first = middle;
+    right.last = node.last;
+    left.children = right.children = 0;
+    node.children = (unsigned int)bvhNodes.size();
+    // node is not valid anymore after the push_back()
+    bvhNodes.push_back(left);
+    bvhNodes.push_back(right);
+  }
+
+  bvhValid = true;
+}
+
+/*!
+  Test if all the faces of a node of the bounding volume hierarchy are entirely clipped,
+  ie if the corners of the bounding box of the node are all outside one of the clipping planes.
+  The test is conservative: a node is not clipped if a corner is close to a plane.
+*/
+template<class PolygonType>
+bool
+vpMbHiddenFaces<PolygonType>::isBVHNodeClipped(const vpMbHiddenFacesBVHNode &node, const vpHomogeneousMatrix &cMo,
+                                               const vpCameraParameters &cam, const unsigned int clippingFlag,
+                                               const double distNearClip, const double distFarClip) const
+{
+  if (node.bbMin[0] > node.bbMax[0]) // No point
+    return false;
+
+  const bool nearClipping = (clippingFlag & vpPolygon3D::NEAR_CLIPPING) || clippingFlag > vpPolygon3D::FAR_CLIPPING;
+  // The far plane is only used if the near clipping cannot move points beyond it
+  const bool farClipping = (clippingFlag & vpPolygon3D::FAR_CLIPPING) && (!nearClipping || distFarClip >= distNearClip);
+  const bool fovClipping = (clippingFlag > vpPolygon3D::FAR_CLIPPING) && cam.isFovComputed();
+  const unsigned int fovFlags[4] = { vpPolygon3D::LEFT_CLIPPING, vpPolygon3D::RIGHT_CLIPPING,
+                                     vpPolygon3D::UP_CLIPPING, vpPolygon3D::DOWN_CLIPPING };
+
+  bool outsideNear = nearClipping, outsideFar = farClipping;
+  bool outsideFov[4];
+  for (unsigned int k = 0; k < 4; k++)
+    outsideFov[k] = fovClipping && (clippingFlag & fovFlags[k]);
+
+  const double nearMargin = 1e-9 * (1. + std::fabs(distNearClip));
+  const double farMargin = 1e-9 * (1. + std::fabs(distFarClip));
+  for (unsigned int c = 0; c < 8; c++){
+    const double oX = (c & 1) ? node.bbMax[0] : node.bbMin[0];
+    const double oY = (c & 2) ? node.bbMax[1] : node.bbMin[1];
+    const double oZ = (c & 4) ? node.bbMax[2] : node.bbMin[2];
+    const double X = cMo[0][0]*oX + cMo[0][1]*oY + cMo[0][2]*oZ + cMo[0][3];
+    const double Y = cMo[1][0]*oX + cMo[1][1]*oY + cMo[1][2]*oZ + cMo[1][3];
+    const double Z = cMo[2][0]*oX + cMo[2][1]*oY + cMo[2][2]*oZ + cMo[2][3];
+
+    outsideNear = outsideNear && (Z < distNearClip - nearMargin);
+    outsideFar = outsideFar && (Z > distFarClip + farMargin);
+    if (fovClipping){
+      const std::vector<vpColVector> &fovNormals = cam.getFovNormals();
+      const double margin = 1e-9 * sqrt(X * X + Y * Y + Z * Z);
+      for (unsigned int k = 0; k < 4; k++)
+        outsideFov[k] = outsideFov[k] && (fovNormals[k][0] * X + fovNormals[k][1] * Y + fovNormals[k][2] * Z > margin);
+    }
+  }
+
+  return outsideNear || outsideFar || outsideFov[0] || outsideFov[1] || outsideFov[2] || outsideFov[3];
+}
+
 /*!
   Compute the clipped points of the polygons that have been added via addPolygon().
 
+  When all the polygons use the same clipping, a bounding volume hierarchy of the polygons,
+  built the first time this function is called after the polygons have been added, is used
+  to skip the clipping of the groups of polygons that are entirely out of the clipping planes.
+  The points of these polygons are still changed of frame and projected, as those of the
+  other polygons, only their clipped points are not computed: they are cleared.
+
   \param cMo : Pose that will be used to clip the polygons.
   \param cam : Camera parameters that will be used to clip the polygons.
 */
@@ -377,13 +651,59 @@ template<class PolygonType>
 void
 vpMbHiddenFaces<PolygonType>::computeClippedPolygons(const vpHomogeneousMatrix &cMo, const vpCameraParameters &cam)
 {
-  for (unsigned int i = 0; i < Lpol.size(); i++){
-    // For fast result we could just clip visible polygons.
-    // However clipping all of them gives us the possibility to return more information in the scanline visibility results
-//    if(Lpol[i]->isVisible())
-    {
-      Lpol[i]->changeFrame(cMo);
-      Lpol[i]->computePolygonClipped(cam);
+  nbFacesCulled = 0;
+
+  bool sameClipping = !Lpol.empty() && Lpol[0]->getClipping() != vpPolygon3D::NO_CLIPPING;
+  for (unsigned int i = 1; i < Lpol.size() && sameClipping; i++){
+    sameClipping = (Lpol[i]->getClipping() == Lpol[0]->getClipping() &&
+                    Lpol[i]->getNearClippingDistance() == Lpol[0]->getNearClippingDistance() &&
+                    Lpol[i]->getFarClippingDistance() == Lpol[0]->getFarClippingDistance());
+  }
+
+  if (!sameClipping){
+    for (unsigned int i = 0; i < Lpol.size(); i++){
+      // For fast result we could just clip visible polygons.
+      // However clipping all of them gives us the possibility to return more information in the scanline visibility results
+  //    if(Lpol[i]->isVisible())
+      {
+        Lpol[i]->changeFrame(cMo);
+        Lpol[i]->computePolygonClipped(cam);
+      }
+    }
+    return;
+  }
+
+  if (!bvhValid)
+    buildBVH();
+
+  const unsigned int clippingFlag = Lpol[0]->getClipping();
+  const double distNearClip = Lpol[0]->getNearClippingDistance();
+  const double distFarClip = Lpol[0]->getFarClippingDistance();
+
+  std::vector<unsigned int> stack(1, 0);
+  while (!stack.empty()){
+    const vpMbHiddenFacesBVHNode &node = bvhNodes[stack.back()];
+    stack.pop_back();
+
+    if (isBVHNodeClipped(node, cMo, cam, clippingFlag, distNearClip, distFarClip)){
+      for (unsigned int i = node.first; i < node.last; i++){
+        // changeFrame() also projects the points, so that they are up to date as for the other faces
+        PolygonType *polygon = Lpol[bvhFaces[i]];
+        polygon->changeFrame(cMo);
+        polygon->polyClipped.clear();
+      }
+      nbFacesCulled += node.last - node.first;
+    }
+    else if (node.children == 0){
+      for (unsigned int i = node.first; i < node.last; i++){
+        PolygonType *polygon = Lpol[bvhFaces[i]];
+        polygon->changeFrame(cMo);
+        polygon->computePolygonClipped(cam);
+      }
+    }
+    else {
+      stack.push_back(node.children + 1);
+      stack.push_back(node.children);
     }
   }
 }
@@ -462,9 +782,21 @@ vpMbHiddenFaces<PolygonType>::setVisiblePrivate(const vpHomogeneousMatrix &cMo,
                                                 const vpCameraParameters &cam)
 {  
   nbVisiblePolygon = 0;
+  nbFacesRecomputed = 0;
   changed = false;
   
   vpTranslationVector cameraPos;
+
+  bool useCache = false;
+  std::vector<double> cacheParameters;
+  if(!useOgre && visibilityCacheTranslation > 0. && visibilityCacheRotation > 0.){
+    cacheParameters = getVisibilityCacheParameters(angleAppears, angleDisappears, I, cam);
+    if(visibilityCacheValid && cacheParameters == visibilityCacheParameters){
+      vpHomogeneousMatrix cMc = visibilityCacheMo * cMo.inverse();
+      useCache = (cMc.getTranslationVector().euclideanNorm() <= visibilityCacheTranslation &&
+                  cMc.getThetaUVector().getTheta() <= visibilityCacheRotation);
+    }
+  }
   
   if(useOgre){
 #ifdef VISP_HAVE_OGRE
@@ -477,9 +809,31 @@ vpMbHiddenFaces<PolygonType>::setVisiblePrivate(const vpHomogeneousMatrix &cMo,
   
   for (unsigned int i = 0; i < Lpol.size(); i++){
     //std::cout << "Calling poly: " << i << std::endl;
+    if(useCache && !Lpol[i]->useLod){
+      Lpol[i]->changeFrame(cMo);
+      Lpol[i]->isvisible = visibilityCacheVisible[i];
+      Lpol[i]->isappearing = visibilityCacheAppearing[i];
+      if (Lpol[i]->isvisible)
+        nbVisiblePolygon ++;
+      continue;
+    }
+
+    nbFacesRecomputed ++;
     if (computeVisibility(cMo, angleAppears, angleDisappears, changed, useOgre, not_used, I, cam, cameraPos, i))
       nbVisiblePolygon ++;
   }
+
+  if(!cacheParameters.empty() && !useCache){
+    visibilityCacheMo = cMo;
+    visibilityCacheParameters = cacheParameters;
+    visibilityCacheVisible.resize(Lpol.size());
+    visibilityCacheAppearing.resize(Lpol.size());
+    for (unsigned int i = 0; i < Lpol.size(); i++){
+      visibilityCacheVisible[i] = Lpol[i]->isvisible;
+      visibilityCacheAppearing[i] = Lpol[i]->isappearing;
+    }
+    visibilityCacheValid = true;
+  }
   return nbVisiblePolygon;
 }
 
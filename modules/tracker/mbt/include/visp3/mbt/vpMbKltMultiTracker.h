@@ -81,6 +81,9 @@ protected:
   //! Name of the reference camera
   std::string m_referenceCameraName;
 
+  //! Maximum number of threads used to process the cameras, 0 to use all the threads of vpThreadPool.
+  unsigned int m_nbCameraThreads;
+
 public:
   vpMbKltMultiTracker();
   vpMbKltMultiTracker(const unsigned int nbCameras);
@@ -118,6 +121,13 @@ public:
 
   virtual std::vector<std::string> getCameraNames() const;
 
+  /*!
+    Return the maximum number of threads used to process the cameras.
+
+    \sa setNbCameraThreads()
+  */
+  inline unsigned int getNbCameraThreads() const { return m_nbCameraThreads; }
+
   virtual void getCameraParameters(vpCameraParameters &camera) const;
   virtual void getCameraParameters(vpCameraParameters &cam1, vpCameraParameters &cam2) const;
   virtual void getCameraParameters(const std::string &cameraName, vpCameraParameters &camera) const;
@@ -261,6 +271,17 @@ public:
 
   virtual void setMaskBorder(const unsigned int &e);
 
+  /*!
+    Set the maximum number of threads used to process the cameras. The KLT tracking and
+    the computation of the interaction matrix and of the residual of each camera are
+    distributed over the threads of vpThreadPool; each camera is processed by a single
+    thread, so that the estimated pose does not depend on the number of threads.
+
+    \param nbThreads : Maximum number of threads. 1 processes the cameras sequentially
+    in the calling thread, 0 (default) uses vpThreadPool::getNumThreads() threads.
+  */
+  virtual void setNbCameraThreads(const unsigned int nbThreads) { m_nbCameraThreads = nbThreads; }
+
   virtual void setMinLineLengthThresh(const double minLineLengthThresh, const std::string &name="");
 
   virtual void setMinPolygonAreaThresh(const double minPolygonAreaThresh, const std::string &name="");
@@ -301,6 +322,8 @@ public:
   //@}
 
 protected:
+  class CameraTask;
+
   /** @name Protected Member Functions Inherited from vpMbKltMultiTracker */
   //@{
   virtual void computeVVS(std::map<std::string, unsigned int> &mapOfNbInfos, vpColVector &w);
@@ -314,8 +337,12 @@ protected:
 
   virtual void postTracking(std::map<std::string, const vpImage<unsigned char> *> &mapOfImages,
       std::map<std::string, unsigned int> &mapOfNbInfos, vpColVector &w_klt);
+  void processCamera(CameraTask &task, const unsigned int index);
+
   using vpMbKltTracker::reinit;
   virtual void reinit(/* const vpImage<unsigned char>& I */);
+
+  void runCameraTask(CameraTask &task);
   //@}
 };
 
@@ -45,10 +45,13 @@
 
 #include <visp3/core/vpConfig.h>
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 
 #include <visp3/mbt/vpMbTracker.h>
-#include <visp3/klt/vpKltOpencv.h>
+#include <visp3/klt/vpKltTracker.h>
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+#  include <visp3/klt/vpKltOpencv.h>
+#endif
 #include <visp3/core/vpMeterPixelConversion.h>
 #include <visp3/core/vpPixelMeterConversion.h>
 #include <visp3/mbt/vpMbtKltXmlParser.h>
@@ -64,10 +67,12 @@
 /*!
   \class vpMbKltTracker
   \ingroup group_mbt_trackers
-  \warning This class is only available if OpenCV is installed, and used.
-  
   \brief Model based tracker using only KLT.
 
+  The KLT features are detected and tracked with vpKltTracker, which does not
+  require OpenCV. The vpKltOpencv based accessors are kept for compatibility
+  when OpenCV is available.
+
   The \ref tutorial-tracking-mb is a good starting point to use this class.
 
   The tracker requires the knowledge of the 3D model that could be provided in a vrml
@@ -229,12 +234,6 @@ class VISP_EXPORT vpMbKltTracker: virtual public vpMbTracker
   friend class vpMbEdgeKltMultiTracker;
 
 protected:
-  //! Temporary OpenCV image for fast conversion.
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-  cv::Mat cur;
-#else
-  IplImage *cur;
-#endif
   //! Initial pose.
   vpHomogeneousMatrix c0Mo;
   //! If true, compute the interaction matrix at each iteration of the minimization. Otherwise, compute it only on the first iteration.
@@ -254,7 +253,11 @@ protected:
   //! The estimated displacement of the pose between the current instant and the initial position.
   vpHomogeneousMatrix ctTc0;
   //! Points tracker.
-  vpKltOpencv tracker;
+  vpKltTracker tracker;
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100) && (VISP_HAVE_OPENCV_VERSION < 0x020408)
+  //! Buffer of the points returned by getKltPoints().
+  std::vector<CvPoint2D32f> kltPoints;
+#endif
   //!
   std::list<vpMbtDistanceKltPoints*> kltPolygons;
   //!
@@ -283,27 +286,26 @@ public:
   /*! Return the address of the Klt feature list. */
   virtual std::list<vpMbtDistanceKltPoints*> &getFeaturesKlt() { return kltPolygons; }
 
-  /*!
-    Get the current list of KLT points.
-            
-     \return the list of KLT points through vpKltOpencv.
-   */
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-  inline  std::vector<cv::Point2f> getKltPoints() const {return tracker.getFeatures();}
-#else
-  inline  CvPoint2D32f*   getKltPoints() {return tracker.getFeatures();}
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+  std::vector<cv::Point2f> getKltPoints() const;
+#elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+  CvPoint2D32f* getKltPoints();
 #endif
   
   std::vector<vpImagePoint> getKltImagePoints() const;
 
   std::map<int, vpImagePoint> getKltImagePointsWithId() const;
 
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+  vpKltOpencv getKltOpencv() const;
+#endif
+
   /*!
     Get the klt tracker at the current state.
-            
+
     \return klt tracker.
    */
-  inline  vpKltOpencv getKltOpencv() const { return tracker; }
+  inline  const vpKltTracker& getKltTracker() const { return tracker; }
 
   /*!
     Get the value of the gain used to compute the control law.
@@ -351,7 +353,10 @@ public:
 
   void setCameraParameters(const vpCameraParameters& cam);
 
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   virtual void setKltOpencv(const vpKltOpencv& t);
+#endif
+  virtual void setKltTracker(const vpKltTracker& t);
 
   /*!
     Set the value of the gain used to compute the control law.
@@ -442,7 +447,7 @@ protected:
                                             const vpHomogeneousMatrix &ctTc0_);
   void computeVVSPoseEstimation(const unsigned int iter, vpMatrix &L,
                                 const vpColVector &w, vpMatrix &L_true, vpMatrix &LVJ_true, double &normRes, double &normRes_1, vpColVector &w_true,
-                                vpColVector &R, vpMatrix &LTL, vpColVector &LTR, vpColVector &error_prev, vpColVector &v, double &mu,
+                                vpColVector &R, vpColVector &error_prev, vpColVector &v, double &mu,
                                 vpHomogeneousMatrix &cMoPrev, vpHomogeneousMatrix &ctTc0_Prev);
   void computeVVSWeights(const unsigned int iter, const unsigned int nbInfos, const vpColVector &R,
                          vpColVector &w_true, vpColVector &w, vpRobust &robust);
@@ -462,4 +467,4 @@ protected:
 };
 
 #endif
-#endif // VISP_HAVE_OPENCV
+#endif // VISP_HAVE_MODULE_KLT
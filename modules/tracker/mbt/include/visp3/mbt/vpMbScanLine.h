@@ -83,9 +83,9 @@ public:
   //! Structure to define a scanline intersection.
   struct vpMbScanLineSegment
   {
-    vpMbScanLineSegment() : type(START), edge(), p(0), P1(0), P2(0), Z1(0), Z2(0), ID(0), b_sample_Y(false) {};
+    vpMbScanLineSegment() : type(START), edge(0), p(0), P1(0), P2(0), Z1(0), Z2(0), ID(0), b_sample_Y(false) {};
     vpMbScanLineType type;
-    vpMbScanLineEdge edge;
+    unsigned int edge; // Index of the edge in the edges of the current scene (see getEdgeIndex()).
     double p; // This value can be either x or y-coordinate value depending if the structure is used in X or Y-axis scanlines computation.
     double P1, P2; // Same comment as previous value.
     double Z1, Z2;
@@ -133,8 +133,18 @@ private:
   unsigned int            maskBorder;
   vpImage<unsigned char>  mask;
   vpImage<int>            primitive_ids;
-  std::map<vpMbScanLineEdge, std::set<int>, vpMbScanLineEdgeComparator> visibility_samples;
+  std::map<vpMbScanLineEdge, unsigned int, vpMbScanLineEdgeComparator> edge_indices;
+  std::vector<std::vector<int> > visibility_samples; // Sorted samples of each edge
   double                  depthTreshold;
+  // Buffers kept from one drawScene() to the next to avoid reallocations.
+  std::vector<std::vector<vpMbScanLineSegment> > scanlinesX, scanlinesY, localScanlines;
+  vpImage<unsigned char>  maskX, maskY;
+  // Bounding box [top, bottom[ x [left, right[ of the pixels written by the last render.
+  unsigned int            dirtyTop, dirtyBottom, dirtyLeft, dirtyRight;
+  // Inputs of the last render, used to skip the rasterization of an identical scene.
+  std::vector<double>     sceneSignature;
+  bool                    sceneValid;
+  unsigned int            nbScanLinesComputed;
 
 public:
 #if defined(DEBUG_DISP)
@@ -159,6 +169,14 @@ public:
   double                        getDepthTreshold() { return depthTreshold; }
   unsigned int                  getMaskBorder() { return maskBorder; }
   const vpImage<unsigned char>& getMask() const  { return mask; }
+  /*!
+    Get the number of X and Y-axis scanlines processed by the last call to drawScene().
+    Only the scanlines crossed by a polygon are processed, and none when the scene
+    is identical to the previous one.
+
+    \return Number of processed scanlines.
+  */
+  unsigned int                  getNbScanLinesComputed() const { return nbScanLinesComputed; }
   const vpImage<int>&           getPrimitiveIDs() const  { return primitive_ids; }
 
   void                          queryLineVisibility(const vpPoint &a, const vpPoint &b,
@@ -171,34 +189,45 @@ public:
 
     \param treshold : New Threshold.
   */
-  void                          setDepthTreshold(const double &treshold) { depthTreshold = treshold; }
-  void                          setMaskBorder(const unsigned int &mb){ maskBorder = mb; }
+  void                          setDepthTreshold(const double &treshold) { depthTreshold = treshold; sceneValid = false; }
+  void                          setMaskBorder(const unsigned int &mb){ maskBorder = mb; sceneValid = false; }
 
 
 private:
   void createScanLinesFromLocals(std::vector<std::vector<vpMbScanLineSegment> > &scanlines,
                                  std::vector<std::vector<vpMbScanLineSegment> > &localScanlines,
-                                 const unsigned int &size);
+                                 const unsigned int &first, const unsigned int &last);
 
   void drawLineY(const vpColVector &a,
                  const vpColVector &b,
-                 const vpMbScanLineEdge &line_ID,
+                 const unsigned int edge,
                  const int ID,
-                 std::vector<std::vector<vpMbScanLineSegment> > &scanlines);
+                 std::vector<std::vector<vpMbScanLineSegment> > &scanlines,
+                 unsigned int &first, unsigned int &last);
 
   void drawLineX(const vpColVector &a,
                  const vpColVector &b,
-                 const vpMbScanLineEdge &line_ID,
+                 const unsigned int edge,
                  const int ID,
-                 std::vector<std::vector<vpMbScanLineSegment> > &scanlines);
+                 std::vector<std::vector<vpMbScanLineSegment> > &scanlines,
+                 unsigned int &first, unsigned int &last);
 
   void drawPolygonY(const std::vector<std::pair<vpPoint, unsigned int> > &polygon,
                     const int ID,
-                    std::vector<std::vector<vpMbScanLineSegment> > &scanlines);
+                    std::vector<std::vector<vpMbScanLineSegment> > &scanlines,
+                    unsigned int &first, unsigned int &last);
 
   void drawPolygonX(const std::vector<std::pair<vpPoint, unsigned int> > &polygon,
                     const int ID,
-                    std::vector<std::vector<vpMbScanLineSegment> > &scanlines);
+                    std::vector<std::vector<vpMbScanLineSegment> > &scanlines,
+                    unsigned int &first, unsigned int &last);
+
+  unsigned int getEdgeIndex(const vpPoint &a, const vpPoint &b);
+  void addVisibilitySample(const unsigned int edge, const int sample);
+
+  void clearDirtyRegion();
+  void extendDirtyRegion(const unsigned int top, const unsigned int bottom,
+                         const unsigned int left, const unsigned int right);
 
   // Static functions
   static vpMbScanLineEdge makeMbScanLineEdge(const vpPoint &a, const vpPoint &b);
@@ -584,6 +584,9 @@ protected:
   void createCylinderBBox(const vpPoint& p1, const vpPoint &p2, const double &radius, std::vector<std::vector<vpPoint> > &listFaces);
 
   void computeJTR(const vpMatrix& J, const vpColVector& R, vpColVector& JTR) const;
+  void computeVVSNormalEquations(const vpMatrix& J, const vpColVector& R, const double mu, vpColVector& v) const;
+  void computeVVSNormalEquations(const vpMatrix& J, const vpColVector& R, const vpMatrix& T, const double mu,
+                                 vpColVector& v) const;
   
 #ifdef VISP_HAVE_COIN3D
   virtual void extractGroup(SoVRMLGroup *sceneGraphVRML2, vpHomogeneousMatrix &transform, int &idFace);
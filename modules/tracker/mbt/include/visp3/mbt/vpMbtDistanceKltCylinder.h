@@ -40,12 +40,15 @@
 
 #include <visp3/core/vpConfig.h>
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 
 #include <map>
 
 #include <visp3/core/vpPolygon3D.h>
-#include <visp3/klt/vpKltOpencv.h>
+#include <visp3/klt/vpKltTracker.h>
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+#  include <visp3/klt/vpKltOpencv.h>
+#endif
 #include <visp3/core/vpPlane.h>
 #include <visp3/core/vpDisplay.h>
 #include <visp3/core/vpGEMM.h>
@@ -110,6 +113,8 @@ public:
 private:
   double              computeZ(const double &x, const double &y);
   bool                isTrackedFeature(const int id);
+  template <class KltTracker> unsigned int computeNbDetected(const KltTracker& _tracker);
+  template <class KltTracker> void initFromTracker(const KltTracker& _tracker, const vpHomogeneousMatrix &cMo);
 
 //private:
 //#ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -133,7 +138,10 @@ public:
 
   void                buildFrom(const vpPoint &p1, const vpPoint &p2, const double &r);
 
+  unsigned int        computeNbDetectedCurrent(const vpKltTracker& _tracker);
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   unsigned int        computeNbDetectedCurrent(const vpKltOpencv& _tracker);
+#endif
   void                computeInteractionMatrixAndResidu(const vpHomogeneousMatrix &cMc0, vpColVector& _R, vpMatrix& _J);
 
   void                display(const vpImage<unsigned char> &I, const vpHomogeneousMatrix &cMo, const vpCameraParameters &cam, const vpColor col, const unsigned int thickness = 1, const bool displayFullModel = false);
@@ -186,7 +194,10 @@ public:
   */
   inline  bool        isTracked() const {return isTrackedKltCylinder;}
 
+  void                init(const vpKltTracker& _tracker, const vpHomogeneousMatrix &cMo);
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   void                init(const vpKltOpencv& _tracker, const vpHomogeneousMatrix &cMo);
+#endif
 
   void                removeOutliers(const vpColVector& weight, const double &threshold_outlier);
 
@@ -204,13 +215,14 @@ public:
   */
   inline void         setTracked(const bool& track) {this->isTrackedKltCylinder = track;}
 
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+  void updateMask(vpImage<unsigned char> &mask, unsigned char _nb = 255, unsigned int _shiftBorder = 0);
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020408)
   void updateMask(cv::Mat &mask, unsigned char _nb = 255, unsigned int _shiftBorder = 0);
-#else
+#elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   void updateMask(IplImage* mask, unsigned char _nb = 255, unsigned int _shiftBorder = 0);
 #endif
 };
 
 #endif
 
-#endif // VISP_HAVE_OPENCV
+#endif // VISP_HAVE_MODULE_KLT
@@ -41,12 +41,15 @@
 
 #include <visp3/core/vpConfig.h>
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 
 #include <map>
 
 #include <visp3/core/vpPolygon3D.h>
-#include <visp3/klt/vpKltOpencv.h>
+#include <visp3/klt/vpKltTracker.h>
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+#  include <visp3/klt/vpKltOpencv.h>
+#endif
 #include <visp3/core/vpPlane.h>
 #include <visp3/core/vpDisplay.h>
 #include <visp3/core/vpGEMM.h>
@@ -111,6 +114,8 @@ private:
   double              compute_1_over_Z(const double x, const double y);
   void                computeP_mu_t(const double x_in, const double y_in, double& x_out, double& y_out, const vpMatrix& cHc0);
   bool                isTrackedFeature(const int id);
+  template <class KltTracker> unsigned int computeNbDetected(const KltTracker& _tracker);
+  template <class KltTracker> void initFromTracker(const KltTracker& _tracker);
 
 //private:
 //#ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -131,7 +136,10 @@ public:
                       vpMbtDistanceKltPoints();
   virtual             ~vpMbtDistanceKltPoints();
 
+  unsigned int        computeNbDetectedCurrent(const vpKltTracker& _tracker);
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   unsigned int        computeNbDetectedCurrent(const vpKltOpencv& _tracker);
+#endif
   void                computeHomography(const vpHomogeneousMatrix& _cTc0, vpHomography& cHc0);
   void                computeInteractionMatrixAndResidu(vpColVector& _R, vpMatrix& _J);
 
@@ -176,7 +184,10 @@ public:
 
   inline  bool        hasEnoughPoints() const {return enoughPoints;}
 
+          void        init(const vpKltTracker& _tracker);
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
           void        init(const vpKltOpencv& _tracker);
+#endif
 
   /*!
    Return if the klt points are used for tracking.
@@ -201,13 +212,14 @@ public:
   */
   inline void setTracked(const bool& track) {this->isTrackedKltPoints = track;}
 
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+  void updateMask(vpImage<unsigned char> &mask, unsigned char _nb = 255, unsigned int _shiftBorder = 0);
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020408)
   void updateMask(cv::Mat &mask, unsigned char _nb = 255, unsigned int _shiftBorder = 0);
-#else
+#elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   void updateMask(IplImage* mask, unsigned char _nb = 255, unsigned int _shiftBorder = 0);
 #endif
 };
 
 #endif
 
-#endif // VISP_HAVE_OPENCV
+#endif // VISP_HAVE_MODULE_KLT
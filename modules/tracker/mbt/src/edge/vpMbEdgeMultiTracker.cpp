@@ -45,15 +45,84 @@
 #include <visp3/core/vpDebug.h>
 #include <visp3/mbt/vpMbEdgeMultiTracker.h>
 #include <visp3/core/vpExponentialMap.h>
+#include <visp3/core/vpThreadPool.h>
 #include <visp3/core/vpTrackingException.h>
 #include <visp3/core/vpVelocityTwistMatrix.h>
 
+/*!
+  Task used to run a stage of the tracking on each camera in the threads of vpThreadPool.
+  A camera is processed by a single thread in vpMbEdgeMultiTracker::processCamera().
+*/
+class vpMbEdgeMultiTracker::CameraTask : public vpThreadPool::Task
+{
+public:
+  typedef enum {
+    TRACK_MOVING_EDGE,
+    UPDATE_VISIBILITY,
+    UPDATE_MOVING_EDGE,
+    INIT_MOVING_EDGE,
+    VVS_FIRST_PHASE,
+    VVS_SECOND_PHASE
+  } Stage;
+
+  CameraTask(vpMbEdgeMultiTracker &tracker, std::map<std::string, const vpImage<unsigned char> *> &mapOfImages,
+             const Stage stage)
+    : m_tracker(tracker), m_stage(stage), m_names(), m_trackers(), m_images(), m_lvl(0), m_iter(0), m_cMc(),
+      m_cVo(), m_rowOffsets(), m_nbLines(), m_nbCylinders(), m_nbCircles(), m_counts(), m_factors(),
+      m_errorLines(), m_errorCylinders(), m_errorCircles(), m_L(NULL), m_factor(NULL), m_w(NULL), m_error(NULL)
+  {
+    for (std::map<std::string, vpMbEdgeTracker *>::const_iterator it = tracker.m_mapOfEdgeTrackers.begin();
+         it != tracker.m_mapOfEdgeTrackers.end(); ++it) {
+      m_names.push_back(it->first);
+      m_trackers.push_back(it->second);
+      m_images.push_back(mapOfImages[it->first]);
+    }
+  }
+
+  void operator()(const unsigned int begin, const unsigned int end)
+  {
+    for (unsigned int i = begin; i < end; i++)
+      m_tracker.processCamera(*this, i);
+  }
+
+  vpMbEdgeMultiTracker &m_tracker;
+  Stage m_stage;
+  std::vector<std::string> m_names;
+  std::vector<vpMbEdgeTracker *> m_trackers;
+  std::vector<const vpImage<unsigned char> *> m_images;
+
+  // Virtual visual servoing: the rows of camera i are [m_rowOffsets[i], m_rowOffsets[i+1])
+  // in the stacked interaction matrix m_L and in the stacked vectors m_factor, m_w and m_error.
+  unsigned int m_lvl;
+  unsigned int m_iter;
+  std::vector<vpHomogeneousMatrix> m_cMc;
+  std::vector<vpVelocityTwistMatrix> m_cVo;
+  std::vector<unsigned int> m_rowOffsets;
+  std::vector<unsigned int> m_nbLines;
+  std::vector<unsigned int> m_nbCylinders;
+  std::vector<unsigned int> m_nbCircles;
+  std::vector<double> m_counts;
+  std::vector<vpColVector> m_factors;
+  std::vector<vpColVector> m_errorLines;
+  std::vector<vpColVector> m_errorCylinders;
+  std::vector<vpColVector> m_errorCircles;
+  vpMatrix *m_L;
+  vpColVector *m_factor;
+  vpColVector *m_w;
+  vpColVector *m_error;
+
+private:
+  CameraTask(const CameraTask &);
+  CameraTask &operator=(const CameraTask &);
+};
+
 
 /*!
   Basic constructor
 */
 vpMbEdgeMultiTracker::vpMbEdgeMultiTracker() : m_mapOfCameraTransformationMatrix(), m_mapOfEdgeTrackers(),
-    m_mapOfPyramidalImages(), m_referenceCameraName("Camera") {
+    m_mapOfPyramidalImages(), m_mapOfImagePyramids(), m_referenceCameraName("Camera"),
+    m_nbCameraThreads(0) {
   m_mapOfEdgeTrackers["Camera"] = new vpMbEdgeTracker();
 
   //Add default camera transformation matrix
@@ -66,7 +135,8 @@ vpMbEdgeMultiTracker::vpMbEdgeMultiTracker() : m_mapOfCameraTransformationMatrix
   \param nbCameras : Number of cameras to use.
 */
 vpMbEdgeMultiTracker::vpMbEdgeMultiTracker(const unsigned int nbCameras) : m_mapOfCameraTransformationMatrix(),
-    m_mapOfEdgeTrackers(), m_mapOfPyramidalImages(), m_referenceCameraName("Camera") {
+    m_mapOfEdgeTrackers(), m_mapOfPyramidalImages(), m_mapOfImagePyramids(), m_referenceCameraName("Camera"),
+    m_nbCameraThreads(0) {
 
   if(nbCameras == 0) {
     throw vpException(vpTrackingException::fatalError, "Cannot construct a vpMbEdgeMultiTracker with no camera !");
@@ -107,7 +177,8 @@ vpMbEdgeMultiTracker::vpMbEdgeMultiTracker(const unsigned int nbCameras) : m_map
   \param cameraNames : List of camera names.
 */
 vpMbEdgeMultiTracker::vpMbEdgeMultiTracker(const std::vector<std::string> &cameraNames) : m_mapOfCameraTransformationMatrix(),
-    m_mapOfEdgeTrackers(), m_mapOfPyramidalImages(), m_referenceCameraName("Camera") {
+    m_mapOfEdgeTrackers(), m_mapOfPyramidalImages(), m_mapOfImagePyramids(), m_referenceCameraName("Camera"),
+    m_nbCameraThreads(0) {
 
   if(cameraNames.empty()) {
     throw vpException(vpTrackingException::fatalError, "Cannot construct a vpMbEdgeMultiTracker with no camera !");
@@ -138,16 +209,8 @@ vpMbEdgeMultiTracker::~vpMbEdgeMultiTracker() {
 void vpMbEdgeMultiTracker::cleanPyramid(std::map<std::string, std::vector<const vpImage<unsigned char>* > >& pyramid) {
   for(std::map<std::string, std::vector<const vpImage<unsigned char>* > >::iterator it1 = pyramid.begin();
       it1 != pyramid.end(); ++it1) {
-    if(it1->second.size() > 0){
-      it1->second[0] = NULL;
-      for(size_t i = 1; i < it1->second.size(); i++) {
-        if(it1->second[i] != NULL) {
-          delete it1->second[i];
-          it1->second[i] = NULL;
-        }
-      }
-      it1->second.clear();
-    }
+    // The levels belong to m_mapOfImagePyramids and are kept for the next images
+    it1->second.clear();
   }
 }
 
@@ -189,6 +252,11 @@ void vpMbEdgeMultiTracker::computeVVS(std::map<std::string, const vpImage<unsign
   std::map<std::string, unsigned int> mapOfNumberOfCylinders;
   std::map<std::string, unsigned int> mapOfNumberOfCircles;
 
+  CameraTask task(*this, mapOfImages, CameraTask::VVS_FIRST_PHASE);
+  const unsigned int nbCameras = (unsigned int)task.m_trackers.size();
+  task.m_lvl = lvl;
+  task.m_rowOffsets.push_back(0);
+
   for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it1 = m_mapOfEdgeTrackers.begin();
       it1 != m_mapOfEdgeTrackers.end(); ++it1) {
     unsigned int nrows = 0;
@@ -204,6 +272,10 @@ void vpMbEdgeMultiTracker::computeVVS(std::map<std::string, const vpImage<unsign
     mapOfNumberOfCircles[it1->first] = ncircles;
 
     nbrow += nrows;
+    task.m_rowOffsets.push_back(nbrow);
+    task.m_nbLines.push_back(nlines);
+    task.m_nbCylinders.push_back(ncylinders);
+    task.m_nbCircles.push_back(ncircles);
     //nberrors_lines += nlines;
     //nberrors_cylinders += ncylinders;
     //nberrors_circles += ncircles;
@@ -237,7 +309,6 @@ void vpMbEdgeMultiTracker::computeVVS(std::map<std::string, const vpImage<unsign
   unsigned int iter = 0;
   vpColVector weighted_error;
   vpColVector factor;
-  std::map<std::string, vpColVector> mapOfFactors;
 
   //Parametre pour la premiere phase d'asservissement
   bool reloop = true;
@@ -252,58 +323,57 @@ void vpMbEdgeMultiTracker::computeVVS(std::map<std::string, const vpImage<unsign
     mapOfVelocityTwist[it->first] = cVo;
   }
 
+  for(unsigned int i = 0; i < nbCameras; i++) {
+    task.m_cMc.push_back(m_mapOfCameraTransformationMatrix[task.m_names[i]]);
+    task.m_cVo.push_back(mapOfVelocityTwist[task.m_names[i]]);
+  }
+
+  // Each camera writes its rows of the stacked system
+  task.m_counts.resize(nbCameras);
+  task.m_factors.resize(nbCameras);
+  task.m_errorLines.resize(nbCameras);
+  task.m_errorCylinders.resize(nbCameras);
+  task.m_errorCircles.resize(nbCameras);
+  task.m_L = &L;
+  task.m_factor = &factor;
+  task.m_w = &m_w;
+  task.m_error = &m_error;
+
 //  std::cout << "\n\n\ncMo used before the first phase=\n" << cMo << std::endl;
 
   /*** First phase ***/
 
   while(reloop == true && iter < 10)
   {
-    m_w.resize(0);
-    m_error.resize(0);
-
-    for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
-        it != m_mapOfEdgeTrackers.end(); ++it) {
-      it->second->cMo = m_mapOfCameraTransformationMatrix[it->first] * cMo;
-    }
-
     if(iter == 0)
     {
       weighted_error.resize(nerror);
 
-      for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
-          it != m_mapOfEdgeTrackers.end(); ++it) {
-        it->second->m_w.resize(mapOfNumberOfRows[it->first]);
-        it->second->m_w = 0;
+      for(unsigned int i = 0; i < nbCameras; i++) {
+        const unsigned int nrows = task.m_rowOffsets[i+1] - task.m_rowOffsets[i];
+        task.m_trackers[i]->m_w.resize(nrows);
+        task.m_trackers[i]->m_w = 0;
 
-        it->second->m_error.resize(mapOfNumberOfRows[it->first]);
+        task.m_trackers[i]->m_error.resize(nrows);
 
-        mapOfFactors[it->first].resize(mapOfNumberOfRows[it->first]);
-        mapOfFactors[it->first] = 1;
+        task.m_factors[i].resize(nrows);
+        task.m_factors[i] = 1;
       }
     }
 
-    double count = 0;
     reloop = false;
 
-    L = vpMatrix();
-    factor = vpColVector();
-
+    L.resize(nbrow, 6, false);
+    factor.resize(nbrow, false);
+    m_w.resize(nbrow, false);
+    m_error.resize(nbrow, false);
 
-    for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
-        it != m_mapOfEdgeTrackers.end(); ++it) {
-      vpMatrix L_tmp(mapOfNumberOfRows[it->first], 6);
+    task.m_iter = iter;
+    runCameraTask(task);
 
-      double count_tmp = 0.0;
-      it->second->computeVVSFirstPhase(*mapOfImages[it->first], iter, L_tmp, mapOfFactors[it->first], count_tmp,
-          it->second->m_error, it->second->m_w, lvl);
-      count += count_tmp;
-
-      L_tmp = L_tmp*mapOfVelocityTwist[it->first];
-
-      L.stack(L_tmp);
-      factor.stack(mapOfFactors[it->first]);
-      m_w.stack(it->second->m_w);
-      m_error.stack(it->second->m_error);
+    double count = 0;
+    for(unsigned int i = 0; i < nbCameras; i++) {
+      count += task.m_counts[i];
     }
 
     count = count / (double) nbrow;
@@ -366,10 +436,14 @@ void vpMbEdgeMultiTracker::computeVVS(std::map<std::string, const vpImage<unsign
   double r =1e3-1;
 
   //while ( ((int)((residu_1 - r)*1e8) != 0 )  && (iter<30))
+  task.m_stage = CameraTask::VVS_SECOND_PHASE;
+
   while(std::fabs((residu_1 - r)*1e8) > std::numeric_limits<double>::epsilon() && (iter<30))
   {
-    L.resize(0,0);
-    m_error.resize(0);
+    L.resize(nbrow, 6, false);
+    m_error.resize(nbrow, false);
+
+    runCameraTask(task);
 
     error_lines.resize(0);
     error_cylinders.resize(0);
@@ -379,32 +453,14 @@ void vpMbEdgeMultiTracker::computeVVS(std::map<std::string, const vpImage<unsign
     std::map<std::string, vpColVector> mapOfErrorCylinders;
     std::map<std::string, vpColVector> mapOfErrorCircles;
 
-    for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it = m_mapOfEdgeTrackers.begin();
-        it != m_mapOfEdgeTrackers.end(); ++it) {
-      vpMatrix L_tmp(mapOfNumberOfRows[it->first], 6);
-      vpColVector error_lines_tmp(mapOfNumberOfLines[it->first]);
-      vpColVector error_cylinders_tmp(mapOfNumberOfCylinders[it->first]);
-      vpColVector error_circles_tmp(mapOfNumberOfCircles[it->first]);
-
-      it->second->cMo = m_mapOfCameraTransformationMatrix[it->first]*cMo;
-
-      vpColVector error_tmp;
-      error_tmp.resize(mapOfNumberOfRows[it->first]);
-
-      it->second->computeVVSSecondPhase(*mapOfImages[it->first], L_tmp, error_lines_tmp,
-          error_cylinders_tmp, error_circles_tmp, error_tmp, lvl);
-      L_tmp = L_tmp*mapOfVelocityTwist[it->first];
+    for(unsigned int i = 0; i < nbCameras; i++) {
+      error_lines.stack(task.m_errorLines[i]);
+      error_cylinders.stack(task.m_errorCylinders[i]);
+      error_circles.stack(task.m_errorCircles[i]);
 
-      L.stack(L_tmp);
-      m_error.stack(error_tmp);
-
-      error_lines.stack(error_lines_tmp);
-      error_cylinders.stack(error_cylinders_tmp);
-      error_circles.stack(error_circles_tmp);
-
-      mapOfErrorLines[it->first] = error_lines_tmp;
-      mapOfErrorCylinders[it->first] = error_cylinders_tmp;
-      mapOfErrorCircles[it->first] = error_circles_tmp;
+      mapOfErrorLines[task.m_names[i]] = task.m_errorLines[i];
+      mapOfErrorCylinders[task.m_names[i]] = task.m_errorCylinders[i];
+      mapOfErrorCircles[task.m_names[i]] = task.m_errorCircles[i];
     }
 
     bool reStartFromLastIncrement = false;
@@ -1648,9 +1704,16 @@ void vpMbEdgeMultiTracker::initPyramid(const std::map<std::string, const vpImage
 {
   for(std::map<std::string, const vpImage<unsigned char> * >::const_iterator it = mapOfImages.begin();
       it != mapOfImages.end(); ++it) {
-    pyramid[it->first].resize(scales.size());
-
-    vpMbEdgeTracker::initPyramid(*it->second, pyramid[it->first]);
+    vpImagePyramid &imagePyramid = m_mapOfImagePyramids[it->first];
+    imagePyramid.setReductionType(vpImagePyramid::SUBSAMPLING_REDUCTION);
+    imagePyramid.setNbLevels((unsigned int)scales.size());
+    imagePyramid.build(*it->second);
+
+    std::vector<const vpImage<unsigned char>* > &levels = pyramid[it->first];
+    levels.resize(scales.size());
+    for(size_t i = 0; i < levels.size(); i++) {
+      levels[i] = scales[i] ? &imagePyramid[(unsigned int)i] : NULL;
+    }
   }
 }
 
@@ -1858,6 +1921,100 @@ void vpMbEdgeMultiTracker::loadModel(const std::string &modelFile, const bool ve
   modelInitialised = true;
 }
 
+/*!
+  Apply the current stage of \e task to one camera. Only the data of this camera are
+  modified, so that the cameras can be processed concurrently.
+
+  \param task : Task describing the stage and holding the data of all the cameras.
+  \param index : Index of the camera, in the order of the map of trackers.
+*/
+void vpMbEdgeMultiTracker::processCamera(CameraTask &task, const unsigned int index) {
+  vpMbEdgeTracker *tracker = task.m_trackers[index];
+  const vpImage<unsigned char> &I = *task.m_images[index];
+
+  switch(task.m_stage) {
+  case CameraTask::TRACK_MOVING_EDGE:
+    tracker->trackMovingEdge(I);
+    break;
+
+  case CameraTask::UPDATE_VISIBILITY: {
+    bool newvisibleface = false;
+    tracker->visibleFace(I, tracker->cMo, newvisibleface);
+
+    if(useScanLine) {
+      tracker->faces.computeClippedPolygons(tracker->cMo, tracker->cam);
+      tracker->faces.computeScanLineRender(tracker->cam, I.getWidth(), I.getHeight());
+    }
+    break;
+  }
+
+  case CameraTask::UPDATE_MOVING_EDGE:
+    tracker->updateMovingEdge(I);
+    break;
+
+  case CameraTask::INIT_MOVING_EDGE:
+    tracker->initMovingEdge(I, tracker->cMo);
+
+    // Reinit the moving edge for the lines which need it.
+    tracker->reinitMovingEdge(I, tracker->cMo);
+
+    if(computeProjError) {
+      //Compute the projection error
+      tracker->computeProjectionError(I);
+    }
+    break;
+
+  case CameraTask::VVS_FIRST_PHASE: {
+    const unsigned int offset = task.m_rowOffsets[index];
+    const unsigned int nrows = task.m_rowOffsets[index+1] - offset;
+    vpMatrix L_tmp(nrows, 6);
+
+    tracker->cMo = task.m_cMc[index] * cMo;
+
+    double count_tmp = 0.0;
+    tracker->computeVVSFirstPhase(I, task.m_iter, L_tmp, task.m_factors[index], count_tmp,
+        tracker->m_error, tracker->m_w, task.m_lvl);
+    task.m_counts[index] = count_tmp;
+
+    L_tmp = L_tmp*task.m_cVo[index];
+
+    for(unsigned int i = 0; i < nrows; i++) {
+      for(unsigned int j = 0; j < 6; j++) {
+        (*task.m_L)[offset+i][j] = L_tmp[i][j];
+      }
+      (*task.m_factor)[offset+i] = task.m_factors[index][i];
+      (*task.m_w)[offset+i] = tracker->m_w[i];
+      (*task.m_error)[offset+i] = tracker->m_error[i];
+    }
+    break;
+  }
+
+  case CameraTask::VVS_SECOND_PHASE: {
+    const unsigned int offset = task.m_rowOffsets[index];
+    const unsigned int nrows = task.m_rowOffsets[index+1] - offset;
+    vpMatrix L_tmp(nrows, 6);
+    vpColVector error_tmp(nrows);
+    task.m_errorLines[index].resize(task.m_nbLines[index]);
+    task.m_errorCylinders[index].resize(task.m_nbCylinders[index]);
+    task.m_errorCircles[index].resize(task.m_nbCircles[index]);
+
+    tracker->cMo = task.m_cMc[index] * cMo;
+
+    tracker->computeVVSSecondPhase(I, L_tmp, task.m_errorLines[index], task.m_errorCylinders[index],
+        task.m_errorCircles[index], error_tmp, task.m_lvl);
+    L_tmp = L_tmp*task.m_cVo[index];
+
+    for(unsigned int i = 0; i < nrows; i++) {
+      for(unsigned int j = 0; j < 6; j++) {
+        (*task.m_L)[offset+i][j] = L_tmp[i][j];
+      }
+      (*task.m_error)[offset+i] = error_tmp[i];
+    }
+    break;
+  }
+  }
+}
+
 /*!
   Re-initialize the model used by the tracker.
 
@@ -2012,6 +2169,21 @@ void vpMbEdgeMultiTracker::resetTracker() {
   this->setScales(scales);
 }
 
+/*!
+  Run the current stage of \e task on all the cameras, using at most
+  getNbCameraThreads() threads of vpThreadPool.
+
+  \param task : Task to run.
+*/
+void vpMbEdgeMultiTracker::runCameraTask(CameraTask &task) {
+  const unsigned int nbCameras = (unsigned int) task.m_trackers.size();
+  if(m_nbCameraThreads == 1) {
+    task(0, nbCameras);
+  } else {
+    vpThreadPool::getInstance().parallelFor(0, nbCameras, task, 1, m_nbCameraThreads);
+  }
+}
+
 /*!
   Set the angle used to test polygons appearance.
   If the angle between the normal of the polygon and the line going
@@ -2890,23 +3062,23 @@ void vpMbEdgeMultiTracker::track(std::map<std::string, const vpImage<unsigned ch
             it1 != m_mapOfEdgeTrackers.end(); ++it1) {
           //Downscale for each camera
           it1->second->downScale(lvl);
+        }
 
-          //Track moving edges
-          try {
-            it1->second->trackMovingEdge(*m_mapOfPyramidalImages[it1->first][lvl]);
-          } catch(...) {
-            vpTRACE("Error in moving edge tracking") ;
-            throw ;
-          }
+        std::map<std::string, const vpImage<unsigned char> *> mapOfPyramidImages;
+        for(std::map<std::string, std::vector<const vpImage<unsigned char>* > >::const_iterator
+            it = m_mapOfPyramidalImages.begin(); it != m_mapOfPyramidalImages.end(); ++it) {
+          mapOfPyramidImages[it->first] = it->second[lvl];
         }
 
+        //Track moving edges
         try {
-          std::map<std::string, const vpImage<unsigned char> *> mapOfPyramidImages;
-          for(std::map<std::string, std::vector<const vpImage<unsigned char>* > >::const_iterator
-              it = m_mapOfPyramidalImages.begin(); it != m_mapOfPyramidalImages.end(); ++it) {
-            mapOfPyramidImages[it->first] = it->second[lvl];
-          }
+          trackMovingEdges(mapOfPyramidImages);
+        } catch(...) {
+          vpTRACE("Error in moving edge tracking") ;
+          throw ;
+        }
 
+        try {
           computeVVS(mapOfPyramidImages, lvl);
         } catch(...) {
           covarianceMatrix = -1;
@@ -2945,42 +3117,19 @@ void vpMbEdgeMultiTracker::track(std::map<std::string, const vpImage<unsigned ch
         }
 
         // Looking for new visible face
-        bool newvisibleface = false;
-        for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-            it != m_mapOfEdgeTrackers.end(); ++it) {
-          it->second->visibleFace(*mapOfImages[it->first], it->second->cMo, newvisibleface);
+        CameraTask task(*this, mapOfImages, CameraTask::UPDATE_VISIBILITY);
+        if(useOgre) {
+          // The Ogre renderers are not shared between threads
+          task(0, (unsigned int) task.m_trackers.size());
+        } else {
+          runCameraTask(task);
         }
 
-        if(useScanLine) {
-          for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-                      it != m_mapOfEdgeTrackers.end(); ++it) {
-            it->second->faces.computeClippedPolygons(it->second->cMo, it->second->cam);
-            it->second->faces.computeScanLineRender(it->second->cam, mapOfImages[it->first]->getWidth(),
-                mapOfImages[it->first]->getHeight());
-          }
-        }
+        task.m_stage = CameraTask::UPDATE_MOVING_EDGE;
+        runCameraTask(task);
 
-        try {
-          for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-                      it != m_mapOfEdgeTrackers.end(); ++it) {
-            it->second->updateMovingEdge(*mapOfImages[it->first]);
-          }
-        } catch(...) {
-          throw; // throw the original exception
-        }
-
-        for(std::map<std::string, vpMbEdgeTracker*>::const_iterator it = m_mapOfEdgeTrackers.begin();
-            it != m_mapOfEdgeTrackers.end(); ++it) {
-          it->second->initMovingEdge(*mapOfImages[it->first], it->second->cMo);
-
-          // Reinit the moving edge for the lines which need it.
-          it->second->reinitMovingEdge(*mapOfImages[it->first], it->second->cMo);
-
-          if(computeProjError) {
-            //Compute the projection error
-            it->second->computeProjectionError(*mapOfImages[it->first]);
-          }
-        }
+        task.m_stage = CameraTask::INIT_MOVING_EDGE;
+        runCameraTask(task);
 
         computeProjectionError();
 
@@ -3018,3 +3167,14 @@ void vpMbEdgeMultiTracker::track(std::map<std::string, const vpImage<unsigned ch
 
   cleanPyramid(m_mapOfPyramidalImages);
 }
+
+/*!
+  Track the moving edges of each camera in its image. The cameras are distributed over
+  getNbCameraThreads() threads.
+
+  \param mapOfImages : Map of images.
+*/
+void vpMbEdgeMultiTracker::trackMovingEdges(std::map<std::string, const vpImage<unsigned char> *> &mapOfImages) {
+  CameraTask task(*this, mapOfImages, CameraTask::TRACK_MOVING_EDGE);
+  runCameraTask(task);
+}
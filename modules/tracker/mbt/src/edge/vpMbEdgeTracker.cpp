@@ -55,6 +55,7 @@
 #include <visp3/mbt/vpMbtDistanceLine.h>
 #include <visp3/mbt/vpMbtXmlParser.h>
 #include <visp3/core/vpPolygon3D.h>
+#include <visp3/core/vpThreadPool.h>
 #include <visp3/core/vpVelocityTwistMatrix.h>
 
 #include <limits>
@@ -70,7 +71,8 @@
 vpMbEdgeTracker::vpMbEdgeTracker()
   : compute_interaction(1), lambda(1), me(), lines(1), circles(1), cylinders(1), nline(0), ncircle(0), ncylinder(0),
     nbvisiblepolygone(0), percentageGdPt(0.4), scales(1),
-    Ipyramid(0), scaleLevel(0), nbFeaturesForProjErrorComputation(0)
+    Ipyramid(0), imagePyramid(1, vpImagePyramid::SUBSAMPLING_REDUCTION), scaleLevel(0),
+    nbFeaturesForProjErrorComputation(0), nbMovingEdgeThreads(0)
 {
   angleAppears = vpMath::rad(89);
   angleDisappears = vpMath::rad(89);
@@ -123,7 +125,7 @@ vpMbEdgeTracker::~vpMbEdgeTracker()
     }
     circles[i].clear();
   }
-  cleanPyramid(Ipyramid);
+  releasePyramid();
 }
 
 /*! 
@@ -739,22 +741,16 @@ vpMbEdgeTracker::computeVVSFirstPhasePoseEstimation(const unsigned int nerror, c
   }
 
   vpColVector v;
-  vpMatrix LTL;
-  vpColVector LTR;
 
   if(isoJoIdentity_){
-      LTL = L.AtA();
-      computeJTR(L, weighted_error, LTR);
-      v = -0.7*LTL.pseudoInverse(LTL.getRows()*std::numeric_limits<double>::epsilon())*LTR;
+      computeVVSNormalEquations(L, weighted_error, 0.0, v);
+      v = -0.7*v;
   }
   else{
       cVo.buildFrom(cMo);
-      vpMatrix LVJ = (L*cVo*oJo);
-      vpMatrix LVJTLVJ = (LVJ).AtA();
-      vpColVector LVJTR;
-      computeJTR(LVJ, weighted_error, LVJTR);
-      v = -0.7*LVJTLVJ.pseudoInverse(LVJTLVJ.getRows()*std::numeric_limits<double>::epsilon())*LVJTR;
-      v = cVo * v;
+      const vpMatrix VJ = cVo*oJo;
+      computeVVSNormalEquations(L, weighted_error, VJ, 0.0, v);
+      v = -0.7*(cVo*v);
   }
 
   cMo =  vpExponentialMap::direct(v).inverse() * cMo;
@@ -852,8 +848,6 @@ vpMbEdgeTracker::computeVVSSecondPhasePoseEstimation(const unsigned int nerror,
   double wi;
   double eri;
 
-  vpMatrix LTL;
-  vpColVector LTR;
 
   L_true = L;
   W_true = vpColVector(nerror);
@@ -895,16 +889,11 @@ vpMbEdgeTracker::computeVVSSecondPhasePoseEstimation(const unsigned int nerror,
 
   vpColVector v;
   if(isoJoIdentity_){
-    LTL = L.AtA();
-    computeJTR(L, weighted_error, LTR);
-
     switch(m_optimizationMethod){
     case vpMbTracker::LEVENBERG_MARQUARDT_OPT:
     {
-      vpMatrix LMA(LTL.getRows(), LTL.getCols());
-      LMA.eye();
-      vpMatrix LTLmuI = LTL + (LMA*mu);
-      v = -lambda*LTLmuI.pseudoInverse(LTLmuI.getRows()*std::numeric_limits<double>::epsilon())*LTR;
+      computeVVSNormalEquations(L, weighted_error, mu, v);
+      v = -lambda*v;
 
       if(iter != 0)
         mu /= 10.0;
@@ -915,24 +904,18 @@ vpMbEdgeTracker::computeVVSSecondPhasePoseEstimation(const unsigned int nerror,
     }
     case vpMbTracker::GAUSS_NEWTON_OPT:
     default:
-      v = -lambda*LTL.pseudoInverse(LTL.getRows()*std::numeric_limits<double>::epsilon())*LTR;
+      computeVVSNormalEquations(L, weighted_error, 0.0, v);
+      v = -lambda*v;
     }
   }
   else{
     cVo.buildFrom(cMo);
-    vpMatrix LVJ = (L*cVo*oJo);
-    vpMatrix LVJTLVJ = (LVJ).AtA();
-    vpColVector LVJTR;
-    computeJTR(LVJ, weighted_error, LVJTR);
-
+    const vpMatrix VJ = cVo*oJo;
     switch(m_optimizationMethod){
     case vpMbTracker::LEVENBERG_MARQUARDT_OPT:
     {
-      vpMatrix LMA(LVJTLVJ.getRows(), LVJTLVJ.getCols());
-      LMA.eye();
-      vpMatrix LTLmuI = LVJTLVJ + (LMA*mu);
-      v = -lambda*LTLmuI.pseudoInverse(LTLmuI.getRows()*std::numeric_limits<double>::epsilon())*LVJTR;
-      v = cVo * v;
+      computeVVSNormalEquations(L, weighted_error, VJ, mu, v);
+      v = -lambda*(cVo*v);
 
       if(iter != 0)
         mu /= 10.0;
@@ -944,8 +927,8 @@ vpMbEdgeTracker::computeVVSSecondPhasePoseEstimation(const unsigned int nerror,
     case vpMbTracker::GAUSS_NEWTON_OPT:
     default:
     {
-      v = -lambda*LVJTLVJ.pseudoInverse(LVJTLVJ.getRows()*std::numeric_limits<double>::epsilon())*LVJTR;
-      v = cVo * v;
+      computeVVSNormalEquations(L, weighted_error, VJ, 0.0, v);
+      v = -lambda*(cVo*v);
       break;
     }
     }
@@ -1178,7 +1161,7 @@ vpMbEdgeTracker::testTracking()
 void
 vpMbEdgeTracker::track(const vpImage<unsigned char> &I)
 { 
-  initPyramid(I, Ipyramid);
+  buildPyramid(I);
   
 //  for (int lvl = ((int)scales.size()-1); lvl >= 0; lvl -= 1)
   unsigned int lvl = (unsigned int)scales.size();
@@ -1296,7 +1279,7 @@ vpMbEdgeTracker::track(const vpImage<unsigned char> &I)
     }
   } while(lvl != 0);
   
-  cleanPyramid(Ipyramid);
+  releasePyramid();
 }
 
 /*!
@@ -1329,7 +1312,7 @@ void vpMbEdgeTracker::init(const vpImage<unsigned char>& I)
   if(clippingFlag > 2)
     cam.computeFov(I.getWidth(), I.getHeight());
   
-  initPyramid(I, Ipyramid);
+  buildPyramid(I);
   visibleFace(I, cMo, a);
   unsigned int i = (unsigned int)scales.size();
 
@@ -1352,7 +1335,7 @@ void vpMbEdgeTracker::init(const vpImage<unsigned char>& I)
     }
   } while(i != 0);
   
-  cleanPyramid(Ipyramid);
+  releasePyramid();
 }
 
 /*!
@@ -1715,43 +1698,142 @@ vpMbEdgeTracker::initMovingEdge(const vpImage<unsigned char> &I, const vpHomogen
 }
 
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  /*!
+    Track or update the moving edges of the features of one scale level. The index
+    range covers the lines, then the cylinders, then the circles; each feature only
+    modifies its own moving edges so that the features can be processed in any order.
+  */
+  class vpMovingEdgeTask : public vpThreadPool::Task
+  {
+  public:
+    vpMovingEdgeTask(const vpImage<unsigned char> &I, const vpHomogeneousMatrix &cMo, const bool update,
+                     const std::vector<vpMbtDistanceLine *> &lines,
+                     const std::vector<vpMbtDistanceCylinder *> &cylinders,
+                     const std::vector<vpMbtDistanceCircle *> &circles)
+      : m_I(I), m_cMo(cMo), m_update(update), m_lines(lines), m_cylinders(cylinders), m_circles(circles)
+    {
+    }
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      const unsigned int nbLines = (unsigned int)m_lines.size();
+      const unsigned int nbLinesCylinders = nbLines + (unsigned int)m_cylinders.size();
+      for (unsigned int k = begin; k < end; k++) {
+        if (k < nbLines)
+          processLine(m_lines[k]);
+        else if (k < nbLinesCylinders)
+          processCylinder(m_cylinders[k - nbLines]);
+        else
+          processCircle(m_circles[k - nbLinesCylinders]);
+      }
+    }
+
+  private:
+    void processLine(vpMbtDistanceLine *l)
+    {
+      if (m_update) {
+        l->updateMovingEdge(m_I, m_cMo);
+        if (l->nbFeatureTotal == 0 && l->isVisible())
+          l->Reinit = true;
+      }
+      else if (l->isVisible()) {
+        if (l->meline.size() == 0)
+          l->initMovingEdge(m_I, m_cMo);
+        l->trackMovingEdge(m_I, m_cMo);
+      }
+    }
+
+    void processCylinder(vpMbtDistanceCylinder *cy)
+    {
+      if (m_update) {
+        cy->updateMovingEdge(m_I, m_cMo);
+        if ((cy->nbFeaturel1 == 0 || cy->nbFeaturel2 == 0) && cy->isVisible())
+          cy->Reinit = true;
+      }
+      else if (cy->isVisible()) {
+        if (cy->meline1 == NULL || cy->meline2 == NULL)
+          cy->initMovingEdge(m_I, m_cMo);
+        cy->trackMovingEdge(m_I, m_cMo);
+      }
+    }
+
+    void processCircle(vpMbtDistanceCircle *ci)
+    {
+      if (m_update) {
+        ci->updateMovingEdge(m_I, m_cMo);
+        if (ci->nbFeature == 0 && ci->isVisible())
+          ci->Reinit = true;
+      }
+      else if (ci->isVisible()) {
+        if (ci->meEllipse == NULL)
+          ci->initMovingEdge(m_I, m_cMo);
+        ci->trackMovingEdge(m_I, m_cMo);
+      }
+    }
+
+    const vpImage<unsigned char> &m_I;
+    const vpHomogeneousMatrix &m_cMo;
+    bool m_update;
+    const std::vector<vpMbtDistanceLine *> &m_lines;
+    const std::vector<vpMbtDistanceCylinder *> &m_cylinders;
+    const std::vector<vpMbtDistanceCircle *> &m_circles;
+  };
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
-  Track the moving edges in the image.
-  
+  Track or update the moving edges of the tracked features of the current scale
+  level, using up to nbMovingEdgeThreads threads.
+
   \param I : the image.
+  \param update : If true call updateMovingEdge() on the features, otherwise trackMovingEdge().
 */
 void
-vpMbEdgeTracker::trackMovingEdge(const vpImage<unsigned char> &I)
+vpMbEdgeTracker::processMovingEdges(const vpImage<unsigned char> &I, const bool update)
 {
+  std::vector<vpMbtDistanceLine *> trackedLines;
+  std::vector<vpMbtDistanceCylinder *> trackedCylinders;
+  std::vector<vpMbtDistanceCircle *> trackedCircles;
+
+  trackedLines.reserve(lines[scaleLevel].size());
   for(std::list<vpMbtDistanceLine*>::const_iterator it=lines[scaleLevel].begin(); it!=lines[scaleLevel].end(); ++it){
-    vpMbtDistanceLine *l = *it;
-    if(l->isVisible() && l->isTracked()){
-      if(l->meline.size() == 0){
-        l->initMovingEdge(I, cMo);
-      }
-      l->trackMovingEdge(I, cMo) ;
-    }
+    if((*it)->isTracked())
+      trackedLines.push_back(*it);
   }
 
+  trackedCylinders.reserve(cylinders[scaleLevel].size());
   for(std::list<vpMbtDistanceCylinder*>::const_iterator it=cylinders[scaleLevel].begin(); it!=cylinders[scaleLevel].end(); ++it){
-    vpMbtDistanceCylinder *cy = *it;
-    if(cy->isVisible() && cy->isTracked()) {
-        if(cy->meline1 == NULL || cy->meline2 == NULL){
-          cy->initMovingEdge(I, cMo);
-        }
-        cy->trackMovingEdge(I, cMo) ;
-    }
+    if((*it)->isTracked())
+      trackedCylinders.push_back(*it);
   }
 
+  trackedCircles.reserve(circles[scaleLevel].size());
   for(std::list<vpMbtDistanceCircle*>::const_iterator it=circles[scaleLevel].begin(); it!=circles[scaleLevel].end(); ++it){
-    vpMbtDistanceCircle *ci = *it;
-    if(ci->isVisible() && ci->isTracked()){
-      if(ci->meEllipse == NULL){
-        ci->initMovingEdge(I, cMo);
-      }
-      ci->trackMovingEdge(I, cMo) ;
-    }
+    if((*it)->isTracked())
+      trackedCircles.push_back(*it);
   }
+
+  vpMovingEdgeTask task(I, cMo, update, trackedLines, trackedCylinders, trackedCircles);
+  const unsigned int nbFeatures = (unsigned int)(trackedLines.size() + trackedCylinders.size() + trackedCircles.size());
+  if (nbMovingEdgeThreads == 1)
+    task(0, nbFeatures);
+  else
+    vpThreadPool::getInstance().parallelFor(0, nbFeatures, task, 1, nbMovingEdgeThreads);
+}
+
+/*!
+  Track the moving edges in the image.
+  
+  \param I : the image.
+
+  \sa setNbMovingEdgeThreads()
+*/
+void
+vpMbEdgeTracker::trackMovingEdge(const vpImage<unsigned char> &I)
+{
+  processMovingEdges(I, false);
 }
 
 
@@ -1759,42 +1841,13 @@ vpMbEdgeTracker::trackMovingEdge(const vpImage<unsigned char> &I)
   Update the moving edges at the end of the virtual visual servoing.
   
   \param I : the image.
+
+  \sa setNbMovingEdgeThreads()
 */
 void
 vpMbEdgeTracker::updateMovingEdge(const vpImage<unsigned char> &I)
 {
-  vpMbtDistanceLine *l ;
-  for(std::list<vpMbtDistanceLine*>::const_iterator it=lines[scaleLevel].begin(); it!=lines[scaleLevel].end(); ++it){
-    if((*it)->isTracked()){
-      l = *it;
-      l->updateMovingEdge(I, cMo) ;
-      if (l->nbFeatureTotal == 0 && l->isVisible()){
-        l->Reinit = true;
-      }
-    }
-  }
-
-  vpMbtDistanceCylinder *cy ;
-  for(std::list<vpMbtDistanceCylinder*>::const_iterator it=cylinders[scaleLevel].begin(); it!=cylinders[scaleLevel].end(); ++it){
-    if((*it)->isTracked()){
-      cy = *it;
-      cy->updateMovingEdge(I, cMo) ;
-      if((cy->nbFeaturel1 == 0 || cy->nbFeaturel2 == 0) && cy->isVisible()){
-        cy->Reinit = true;
-      }
-    }
-  }
-
-  vpMbtDistanceCircle *ci ;
-  for(std::list<vpMbtDistanceCircle*>::const_iterator it=circles[scaleLevel].begin(); it!=circles[scaleLevel].end(); ++it){
-    if((*it)->isTracked()){
-      ci = *it;
-      ci->updateMovingEdge(I, cMo) ;
-      if(ci->nbFeature == 0  && ci->isVisible()){
-        ci->Reinit = true;
-      }
-    }
-  }
+  processMovingEdges(I, true);
 }
 
 void
@@ -2845,6 +2898,38 @@ vpMbEdgeTracker::initPyramid(const vpImage<unsigned char>& _I, std::vector< cons
   }
 }
 
+/*!
+  Compute the pyramid of the image in parameter in the imagePyramid attribute and
+  point the elements of Ipyramid to its levels, or to NULL for the levels of the
+  scales that are not used. The levels are computed by subsampling the image like
+  initPyramid() does without OpenCV, but they are kept from one image to the next
+  one instead of being allocated for every image.
+
+  \param I : The input image.
+
+  \sa releasePyramid()
+*/
+void
+vpMbEdgeTracker::buildPyramid(const vpImage<unsigned char>& I)
+{
+  imagePyramid.setNbLevels((unsigned int)scales.size());
+  imagePyramid.build(I);
+
+  Ipyramid.resize(scales.size());
+  for (unsigned int i = 0; i < Ipyramid.size(); i++)
+    Ipyramid[i] = scales[i] ? &imagePyramid[i] : NULL;
+}
+
+/*!
+  Reset the pointers set by buildPyramid(). The levels of the pyramid are kept
+  for the next image.
+*/
+void
+vpMbEdgeTracker::releasePyramid()
+{
+  Ipyramid.clear();
+}
+
 /*!
   Clean the pyramid of image allocated with the initPyramid() method. The vector
   has a size equal to zero at the end of the method. 
@@ -293,8 +293,9 @@ vpMbtMeLine::seekExtremities(const vpImage<unsigned char> &I)
   P.init((int) PExt[0].ifloat, (int)PExt[0].jfloat, delta_1, 0, sign) ;
   P.setDisplay(selectDisplay) ;
 
-  unsigned int  memory_range = me->getRange() ;
-  me->setRange(1);
+  // The extremities are sought within +/- 1 pixel, without modifying the
+  // moving edges parameters that are shared by all the tracked features
+  const unsigned int range = 1 ;
 
   for (int i=0 ; i < 3 ; i++)
   {
@@ -306,9 +307,9 @@ vpMbtMeLine::seekExtremities(const vpImage<unsigned char> &I)
       if (vpDEBUG_ENABLE(3)) vpDisplay::displayCross(I,P.i,P.j,5,vpColor::cyan) ;
     }
     else
-    if(!outOfImage(P.i, P.j, (int)(me->getRange()+me->getMaskSize()+1), (int)rows, (int)cols))
+    if(!outOfImage(P.i, P.j, (int)(range+me->getMaskSize()+1), (int)rows, (int)cols))
     {
-      P.track(I,me,false) ;
+      P.track(I,me,false,range) ;
 
       if (P.getState() == vpMeSite::NO_SUPPRESSION)
       {
@@ -333,9 +334,9 @@ vpMbtMeLine::seekExtremities(const vpImage<unsigned char> &I)
     }
 
     else
-    if(!outOfImage(P.i, P.j, (int)(me->getRange()+me->getMaskSize()+1), (int)rows, (int)cols))
+    if(!outOfImage(P.i, P.j, (int)(range+me->getMaskSize()+1), (int)rows, (int)cols))
     {
-      P.track(I,me,false) ;
+      P.track(I,me,false,range) ;
 
       if (P.getState() == vpMeSite::NO_SUPPRESSION)
       {
@@ -347,8 +348,6 @@ vpMbtMeLine::seekExtremities(const vpImage<unsigned char> &I)
     }
   }
 	
-  me->setRange(memory_range);
-	
   vpCDEBUG(1) <<"end vpMeLine::sample() : " ;
   vpCDEBUG(1) << n_sample << " point inserted in the list " << std::endl  ;
 }
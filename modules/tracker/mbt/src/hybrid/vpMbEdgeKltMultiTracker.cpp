@@ -240,8 +240,6 @@ void vpMbEdgeKltMultiTracker::computeVVS(std::map<std::string, const vpImage<uns
   vpColVector v;
   vpHomography H;
 
-  vpMatrix LTL;
-  vpColVector LTR;
 
   while( ((int)((residu - residu_1)*1e8) !=0 )  && (iter<maxIter) ){
     L = new vpMatrix();
@@ -450,16 +448,11 @@ void vpMbEdgeKltMultiTracker::computeVVS(std::map<std::string, const vpImage<uns
       residu = sqrt(num/den);
 
       if(isoJoIdentity) {
-        LTL = L->AtA();
-        computeJTR(*L, *R, LTR);
-
         switch(m_optimizationMethod) {
         case vpMbTracker::LEVENBERG_MARQUARDT_OPT:
         {
-          vpMatrix LMA(LTL.getRows(), LTL.getCols());
-          LMA.eye();
-          vpMatrix LTLmuI = LTL + (LMA*mu);
-          v = -lambda*LTLmuI.pseudoInverse(LTLmuI.getRows()*std::numeric_limits<double>::epsilon())*LTR;
+          computeVVSNormalEquations(*L, *R, mu, v);
+          v = -lambda*v;
 
           if(iter != 0) {
             mu /= 10.0;
@@ -471,26 +464,20 @@ void vpMbEdgeKltMultiTracker::computeVVS(std::map<std::string, const vpImage<uns
         }
         case vpMbTracker::GAUSS_NEWTON_OPT:
         default:
-          v = -lambda * LTL.pseudoInverse(LTL.getRows()*std::numeric_limits<double>::epsilon()) * LTR;
+          computeVVSNormalEquations(*L, *R, 0.0, v);
+          v = -lambda*v;
           break;
         }
       }
       else {
         vpVelocityTwistMatrix cVo;
         cVo.buildFrom(cMo);
-        vpMatrix LVJ = ((*L)*cVo*oJo);
-        vpMatrix LVJTLVJ = (LVJ).AtA();
-        vpColVector LVJTR;
-        computeJTR(LVJ, *R, LVJTR);
-
+        const vpMatrix VJ = cVo*oJo;
         switch(m_optimizationMethod) {
         case vpMbTracker::LEVENBERG_MARQUARDT_OPT:
         {
-          vpMatrix LMA(LVJTLVJ.getRows(), LVJTLVJ.getCols());
-          LMA.eye();
-          vpMatrix LTLmuI = LVJTLVJ + (LMA*mu);
-          v = -lambda*LTLmuI.pseudoInverse(LTLmuI.getRows()*std::numeric_limits<double>::epsilon())*LVJTR;
-          v = cVo * v;
+          computeVVSNormalEquations(*L, *R, VJ, mu, v);
+          v = -lambda*(cVo*v);
 
           if(iter != 0) {
             mu /= 10.0;
@@ -503,8 +490,8 @@ void vpMbEdgeKltMultiTracker::computeVVS(std::map<std::string, const vpImage<uns
         case vpMbTracker::GAUSS_NEWTON_OPT:
         default:
         {
-          v = -lambda*LVJTLVJ.pseudoInverse(LVJTLVJ.getRows()*std::numeric_limits<double>::epsilon())*LVJTR;
-          v = cVo * v;
+          computeVVSNormalEquations(*L, *R, VJ, 0.0, v);
+          v = -lambda*(cVo*v);
           break;
         }
         }
@@ -2237,15 +2224,12 @@ unsigned int vpMbEdgeKltMultiTracker::trackFirstLoop(std::map<std::string, const
 }
 
 void vpMbEdgeKltMultiTracker::trackMovingEdges(std::map<std::string, const vpImage<unsigned char> *> &mapOfImages) {
-  for(std::map<std::string, vpMbEdgeTracker *>::const_iterator it1 = m_mapOfEdgeTrackers.begin();
-      it1 != m_mapOfEdgeTrackers.end(); ++it1) {
-    //Track moving edges
-    try {
-      it1->second->trackMovingEdge(*mapOfImages[it1->first]);
-    } catch(...) {
-      std::cerr << "Error in moving edge tracking" << std::endl;
-      throw ;
-    }
+  //Track moving edges, the cameras being distributed over the threads
+  try {
+    vpMbEdgeMultiTracker::trackMovingEdges(mapOfImages);
+  } catch(...) {
+    std::cerr << "Error in moving edge tracking" << std::endl;
+    throw ;
   }
 }
 
@@ -43,7 +43,7 @@
 #include <visp3/core/vpTrackingException.h>
 #include <visp3/core/vpVelocityTwistMatrix.h>
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 
 vpMbEdgeKltTracker::vpMbEdgeKltTracker()
   : compute_interaction(true), lambda(0.8), thresholdKLT(2.), thresholdMBT(2.), maxIter(200)
@@ -79,7 +79,7 @@ vpMbEdgeKltTracker::init(const vpImage<unsigned char>& I)
 {
   vpMbKltTracker::init(I);
   
-  initPyramid(I, Ipyramid);
+  buildPyramid(I);
 
   vpMbEdgeTracker::resetMovingEdge();
 
@@ -93,7 +93,7 @@ vpMbEdgeKltTracker::init(const vpImage<unsigned char>& I)
     }
   } while(i != 0);
   
-  cleanPyramid(Ipyramid);
+  releasePyramid();
 }
 
 /*!
@@ -118,7 +118,7 @@ vpMbEdgeKltTracker::setPose( const vpImage<unsigned char> &I, const vpHomogeneou
       faces.computeScanLineRender(cam, I.getWidth(), I.getHeight());
     }
 
-    initPyramid(I, Ipyramid);
+    buildPyramid(I);
 
     unsigned int i = (unsigned int)scales.size();
     do {
@@ -130,7 +130,7 @@ vpMbEdgeKltTracker::setPose( const vpImage<unsigned char> &I, const vpHomogeneou
       }
     } while(i != 0);
     
-    cleanPyramid(Ipyramid);
+    releasePyramid();
 }
 
 /*!
@@ -620,8 +620,6 @@ vpMbEdgeKltTracker::computeVVS(const vpImage<unsigned char>& I, const unsigned i
   vpRobust robust_mbt(0), robust_klt(0);
   vpHomography H;
 
-  vpMatrix LTL;
-  vpColVector LTR;
   
   double factorMBT = 1.0;
   double factorKLT = 1.0;
@@ -791,16 +789,11 @@ vpMbEdgeKltTracker::computeVVS(const vpImage<unsigned char>& I, const unsigned i
       residu = sqrt(num/den);
 
       if(isoJoIdentity){
-          LTL = L->AtA();
-          computeJTR(*L, *R, LTR);
-
           switch(m_optimizationMethod){
           case vpMbTracker::LEVENBERG_MARQUARDT_OPT:
           {
-            vpMatrix LMA(LTL.getRows(), LTL.getCols());
-            LMA.eye();
-            vpMatrix LTLmuI = LTL + (LMA*mu);
-            v = -lambda*LTLmuI.pseudoInverse(LTLmuI.getRows()*std::numeric_limits<double>::epsilon())*LTR;
+            computeVVSNormalEquations(*L, *R, mu, v);
+            v = -lambda*v;
 
             if(iter != 0)
               mu /= 10.0;
@@ -811,25 +804,19 @@ vpMbEdgeKltTracker::computeVVS(const vpImage<unsigned char>& I, const unsigned i
           }
           case vpMbTracker::GAUSS_NEWTON_OPT:
           default:
-            v = -lambda * LTL.pseudoInverse(LTL.getRows()*std::numeric_limits<double>::epsilon()) * LTR;
+            computeVVSNormalEquations(*L, *R, 0.0, v);
+            v = -lambda*v;
           }
       }
       else{
           vpVelocityTwistMatrix cVo;
           cVo.buildFrom(cMo);
-          vpMatrix LVJ = ((*L)*cVo*oJo);
-          vpMatrix LVJTLVJ = (LVJ).AtA();
-          vpColVector LVJTR;
-          computeJTR(LVJ, *R, LVJTR);
-
+          const vpMatrix VJ = cVo*oJo;
           switch(m_optimizationMethod){
           case vpMbTracker::LEVENBERG_MARQUARDT_OPT:
           {
-            vpMatrix LMA(LVJTLVJ.getRows(), LVJTLVJ.getCols());
-            LMA.eye();
-            vpMatrix LTLmuI = LVJTLVJ + (LMA*mu);
-            v = -lambda*LTLmuI.pseudoInverse(LTLmuI.getRows()*std::numeric_limits<double>::epsilon())*LVJTR;
-            v = cVo * v;
+            computeVVSNormalEquations(*L, *R, VJ, mu, v);
+            v = -lambda*(cVo*v);
 
             if(iter != 0)
               mu /= 10.0;
@@ -841,8 +828,8 @@ vpMbEdgeKltTracker::computeVVS(const vpImage<unsigned char>& I, const unsigned i
           case vpMbTracker::GAUSS_NEWTON_OPT:
           default:
           {
-            v = -lambda*LVJTLVJ.pseudoInverse(LVJTLVJ.getRows()*std::numeric_limits<double>::epsilon())*LVJTR;
-            v = cVo * v;
+            computeVVSNormalEquations(*L, *R, VJ, 0.0, v);
+            v = -lambda*(cVo*v);
             break;
           }
           }
@@ -910,7 +897,7 @@ vpMbEdgeKltTracker::track(const vpImage<unsigned char>& I)
     
     // AY : Removed as edge tracked, if necessary, is reinitialized in postTracking()
 
-//    initPyramid(I, Ipyramid);
+//    buildPyramid(I);
     
 //    unsigned int i = (unsigned int)scales.size();
 //    do {
@@ -922,7 +909,7 @@ vpMbEdgeKltTracker::track(const vpImage<unsigned char>& I)
 //      }
 //    } while(i != 0);
     
-//    cleanPyramid(Ipyramid);
+//    releasePyramid();
   }
 }
 
@@ -1304,13 +1291,6 @@ vpMbEdgeKltTracker::reInitModel(const vpImage<unsigned char>& I, const char* cad
                                 const vpHomogeneousMatrix& cMo_, const bool verbose)
 {
   // Reinit klt
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
-  if(cur != NULL){
-    cvReleaseImage(&cur);
-    cur = NULL;
-  }
-#endif
-
   // delete the Klt Polygon features
   vpMbtDistanceKltPoints *kltpoly;
   for(std::list<vpMbtDistanceKltPoints*>::const_iterator it=kltPolygons.begin(); it!=kltPolygons.end(); ++it){
@@ -1395,4 +1375,4 @@ vpMbEdgeKltTracker::reInitModel(const vpImage<unsigned char>& I, const char* cad
 #elif !defined(VISP_BUILD_SHARED_LIBS)
 // Work arround to avoid warning: libvisp_mbt.a(vpMbEdgeKltTracker.cpp.o) has no symbols
 void dummy_vpMbEdgeKltTracker() {};
-#endif //VISP_HAVE_OPENCV
+#endif //VISP_HAVE_MODULE_KLT
@@ -46,16 +46,68 @@
 
 #if (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
 
+#include <visp3/core/vpThreadPool.h>
 #include <visp3/core/vpTrackingException.h>
 #include <visp3/core/vpVelocityTwistMatrix.h>
 #include <visp3/mbt/vpMbKltMultiTracker.h>
 
+/*!
+  Task used to run a stage of the tracking on each camera in the threads of vpThreadPool.
+  A camera is processed by a single thread in vpMbKltMultiTracker::processCamera().
+*/
+class vpMbKltMultiTracker::CameraTask : public vpThreadPool::Task
+{
+public:
+  typedef enum {
+    PRE_TRACKING,
+    VVS
+  } Stage;
+
+  CameraTask(vpMbKltMultiTracker &tracker, const Stage stage)
+    : m_tracker(tracker), m_stage(stage), m_names(), m_trackers(), m_images(), m_nbInfos(), m_nbFaceUsed(),
+      m_cMc(), m_cVo(), m_rowOffsets(), m_L(NULL), m_R(NULL)
+  {
+    for (std::map<std::string, vpMbKltTracker *>::const_iterator it = tracker.m_mapOfKltTrackers.begin();
+         it != tracker.m_mapOfKltTrackers.end(); ++it) {
+      m_names.push_back(it->first);
+      m_trackers.push_back(it->second);
+    }
+  }
+
+  void operator()(const unsigned int begin, const unsigned int end)
+  {
+    for (unsigned int i = begin; i < end; i++)
+      m_tracker.processCamera(*this, i);
+  }
+
+  vpMbKltMultiTracker &m_tracker;
+  Stage m_stage;
+  std::vector<std::string> m_names;
+  std::vector<vpMbKltTracker *> m_trackers;
+  std::vector<const vpImage<unsigned char> *> m_images;
+  std::vector<unsigned int> m_nbInfos;
+  std::vector<unsigned int> m_nbFaceUsed;
+
+  // Virtual visual servoing: the rows of camera i are [m_rowOffsets[i], m_rowOffsets[i+1])
+  // in the stacked interaction matrix m_L and in the stacked residual m_R.
+  std::vector<vpHomogeneousMatrix> m_cMc;
+  std::vector<vpVelocityTwistMatrix> m_cVo;
+  std::vector<unsigned int> m_rowOffsets;
+  vpMatrix *m_L;
+  vpColVector *m_R;
+
+private:
+  CameraTask(const CameraTask &);
+  CameraTask &operator=(const CameraTask &);
+};
+
 
 /*!
   Basic constructor
 */
 vpMbKltMultiTracker::vpMbKltMultiTracker() : m_mapOfCameraTransformationMatrix(), m_mapOfKltTrackers(),
-    m_referenceCameraName("Camera") {
+    m_referenceCameraName("Camera"),
+    m_nbCameraThreads(0) {
   m_mapOfKltTrackers["Camera"] = new vpMbKltTracker();
 
   //Add default camera transformation matrix
@@ -68,7 +120,8 @@ vpMbKltMultiTracker::vpMbKltMultiTracker() : m_mapOfCameraTransformationMatrix()
   \param nbCameras : Number of cameras to use.
 */
 vpMbKltMultiTracker::vpMbKltMultiTracker(const unsigned int nbCameras) : m_mapOfCameraTransformationMatrix(),
-    m_mapOfKltTrackers(), m_referenceCameraName("Camera") {
+    m_mapOfKltTrackers(), m_referenceCameraName("Camera"),
+    m_nbCameraThreads(0) {
 
   if(nbCameras == 0) {
     throw vpException(vpTrackingException::fatalError, "Cannot construct a vpMbkltMultiTracker with no camera !");
@@ -108,7 +161,8 @@ vpMbKltMultiTracker::vpMbKltMultiTracker(const unsigned int nbCameras) : m_mapOf
   \param cameraNames : List of camera names.
 */
 vpMbKltMultiTracker::vpMbKltMultiTracker(const std::vector<std::string> &cameraNames) : m_mapOfCameraTransformationMatrix(),
-    m_mapOfKltTrackers(), m_referenceCameraName("Camera") {
+    m_mapOfKltTrackers(), m_referenceCameraName("Camera"),
+    m_nbCameraThreads(0) {
   if(cameraNames.empty()) {
     throw vpException(vpTrackingException::fatalError, "Cannot construct a vpMbKltMultiTracker with no camera !");
   }
@@ -170,8 +224,6 @@ void vpMbKltMultiTracker::computeVVS(std::map<std::string, unsigned int> &mapOfN
     mapOfRobusts[it->first] = vpRobust(2*mapOfNbInfos[it->first]);
   }
 
-  vpMatrix LTL;
-  vpColVector LTR;
   vpHomogeneousMatrix cMoPrev;
   vpHomogeneousMatrix ctTc0_Prev;
   vpColVector error_prev(2*nbInfos);
@@ -189,40 +241,24 @@ void vpMbKltMultiTracker::computeVVS(std::map<std::string, unsigned int> &mapOfN
     mapOfVelocityTwist[it->first] = cVo;
   }
 
-  while( ((int)((normRes - normRes_1)*1e8) != 0 )  && (iter<maxIter) ) {
-    L.resize(0,0);
-    R.resize(0);
-
-    for(std::map<std::string, vpMbKltTracker*>::const_iterator it1 = m_mapOfKltTrackers.begin();
-        it1 != m_mapOfKltTrackers.end(); ++it1) {
-      unsigned int shift = 0;
-      vpColVector R_current;  // residu
-      vpMatrix L_current;     // interaction matrix
-      vpHomography H_current;
-
-      R_current.resize(2 * mapOfNbInfos[it1->first]);
-      L_current.resize(2 * mapOfNbInfos[it1->first], 6, 0);
-
-      //Use the ctTc0 variable instead of the formula in the monocular case
-      //to ensure that we have the same result than vpMbKltTracker
-      //as some slight differences can occur due to numerical imprecision
-      if(m_mapOfKltTrackers.size() == 1) {
-        computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
-            it1->second->kltPolygons, it1->second->kltCylinders, ctTc0);
-      } else {
-        vpHomogeneousMatrix c_curr_tTc_curr0 = m_mapOfCameraTransformationMatrix[it1->first] *
-            cMo * it1->second->c0Mo.inverse();
-        computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
-            it1->second->kltPolygons, it1->second->kltCylinders, c_curr_tTc_curr0);
-      }
+  // Each camera writes its rows of the stacked residu and interaction matrix
+  CameraTask task(*this, CameraTask::VVS);
+  task.m_rowOffsets.push_back(0);
+  for(size_t i = 0; i < task.m_names.size(); i++) {
+    task.m_rowOffsets.push_back(task.m_rowOffsets.back() + 2*mapOfNbInfos[task.m_names[i]]);
+    if(m_mapOfKltTrackers.size() > 1) {
+      task.m_cMc.push_back(m_mapOfCameraTransformationMatrix[task.m_names[i]]);
+    }
+    task.m_cVo.push_back(mapOfVelocityTwist[task.m_names[i]]);
+  }
+  task.m_L = &L;
+  task.m_R = &R;
 
-      //VelocityTwistMatrix
-      L_current = L_current*mapOfVelocityTwist[it1->first];
+  while( ((int)((normRes - normRes_1)*1e8) != 0 )  && (iter<maxIter) ) {
+    L.resize(task.m_rowOffsets.back(), 6, false);
+    R.resize(task.m_rowOffsets.back(), false);
 
-      //Stack residu and interaction matrix
-      R.stack(R_current);
-      L.stack(L_current);
-    }
+    runCameraTask(task);
 
     bool reStartFromLastIncrement = false;
     computeVVSCheckLevenbergMarquardtKlt(iter, nbInfos, cMoPrev, error_prev, ctTc0_Prev, mu, reStartFromLastIncrement);
@@ -230,7 +266,7 @@ void vpMbKltMultiTracker::computeVVS(std::map<std::string, unsigned int> &mapOfN
     if(!reStartFromLastIncrement) {
       vpMbKltMultiTracker::computeVVSWeights(iter, nbInfos, mapOfNbInfos, R, w_true, w, mapOfRobusts, 2.0);
 
-      computeVVSPoseEstimation(iter, L, w, L_true, LVJ_true, normRes, normRes_1, w_true, R, LTL, LTR,
+      computeVVSPoseEstimation(iter, L, w, L_true, LVJ_true, normRes, normRes_1, w_true, R,
           error_prev, v, mu, cMoPrev, ctTc0_Prev);
     } // endif(!reStartFromLastIncrement)
 
@@ -1559,19 +1595,74 @@ void vpMbKltMultiTracker::loadModel(const std::string &modelFile, const bool ver
 void vpMbKltMultiTracker::preTracking(std::map<std::string, const vpImage<unsigned char> *> &mapOfImages,
     std::map<std::string, unsigned int> &mapOfNbInfos,
     std::map<std::string, unsigned int> &mapOfNbFaceUsed) {
-  for(std::map<std::string, vpMbKltTracker*>::const_iterator it = m_mapOfKltTrackers.begin();
-      it != m_mapOfKltTrackers.end(); ++it) {
-    mapOfNbInfos[it->first] = 0;
-    mapOfNbFaceUsed[it->first] = 0;
+  CameraTask task(*this, CameraTask::PRE_TRACKING);
+  for(size_t i = 0; i < task.m_names.size(); i++) {
+    task.m_images.push_back(mapOfImages[task.m_names[i]]);
+  }
+  task.m_nbInfos.resize(task.m_names.size(), 0);
+  task.m_nbFaceUsed.resize(task.m_names.size(), 0);
+
+  runCameraTask(task);
+
+  for(size_t i = 0; i < task.m_names.size(); i++) {
+    mapOfNbInfos[task.m_names[i]] = task.m_nbInfos[i];
+    mapOfNbFaceUsed[task.m_names[i]] = task.m_nbFaceUsed[i];
   }
+}
 
-  for (std::map<std::string, vpMbKltTracker*>::const_iterator it =
-      m_mapOfKltTrackers.begin(); it != m_mapOfKltTrackers.end(); ++it) {
+/*!
+  Apply the current stage of \e task to one camera. Only the data of this camera are
+  modified, so that the cameras can be processed concurrently.
+
+  \param task : Task describing the stage and holding the data of all the cameras.
+  \param index : Index of the camera, in the order of the map of trackers.
+*/
+void vpMbKltMultiTracker::processCamera(CameraTask &task, const unsigned int index) {
+  vpMbKltTracker *tracker = task.m_trackers[index];
+
+  switch(task.m_stage) {
+  case CameraTask::PRE_TRACKING:
     try {
-      it->second->preTracking(*mapOfImages[it->first], mapOfNbInfos[it->first], mapOfNbFaceUsed[it->first]);
+      tracker->preTracking(*task.m_images[index], task.m_nbInfos[index], task.m_nbFaceUsed[index]);
     } catch (/*vpException &e*/...) {
 //      throw e;
     }
+    break;
+
+  case CameraTask::VVS: {
+    const unsigned int offset = task.m_rowOffsets[index];
+    const unsigned int nrows = task.m_rowOffsets[index+1] - offset;
+    unsigned int shift = 0;
+    vpColVector R_current;  // residu
+    vpMatrix L_current;     // interaction matrix
+    vpHomography H_current;
+
+    R_current.resize(nrows);
+    L_current.resize(nrows, 6, 0);
+
+    //Use the ctTc0 variable instead of the formula in the monocular case
+    //to ensure that we have the same result than vpMbKltTracker
+    //as some slight differences can occur due to numerical imprecision
+    if(task.m_trackers.size() == 1) {
+      computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
+          tracker->kltPolygons, tracker->kltCylinders, ctTc0);
+    } else {
+      vpHomogeneousMatrix c_curr_tTc_curr0 = task.m_cMc[index] * cMo * tracker->c0Mo.inverse();
+      computeVVSInteractionMatrixAndResidu(shift, R_current, L_current, H_current,
+          tracker->kltPolygons, tracker->kltCylinders, c_curr_tTc_curr0);
+    }
+
+    //VelocityTwistMatrix
+    L_current = L_current*task.m_cVo[index];
+
+    for(unsigned int i = 0; i < nrows; i++) {
+      for(unsigned int j = 0; j < 6; j++) {
+        (*task.m_L)[offset+i][j] = L_current[i][j];
+      }
+      (*task.m_R)[offset+i] = R_current[i];
+    }
+    break;
+  }
   }
 }
 
@@ -1775,6 +1866,21 @@ void vpMbKltMultiTracker::resetTracker() {
 #endif
 }
 
+/*!
+  Run the current stage of \e task on all the cameras, using at most
+  getNbCameraThreads() threads of vpThreadPool.
+
+  \param task : Task to run.
+*/
+void vpMbKltMultiTracker::runCameraTask(CameraTask &task) {
+  const unsigned int nbCameras = (unsigned int) task.m_trackers.size();
+  if(m_nbCameraThreads == 1) {
+    task(0, nbCameras);
+  } else {
+    vpThreadPool::getInstance().parallelFor(0, nbCameras, task, 1, m_nbCameraThreads);
+  }
+}
+
 /*!
   Set the angle used to test polygons appearance.
   If the angle between the normal of the polygon and the line going
@@ -41,24 +41,21 @@
 #include <visp3/core/vpVelocityTwistMatrix.h>
 #include <visp3/core/vpTrackingException.h>
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 
 #if defined(__APPLE__) && defined(__MACH__) // Apple OSX and iOS (Darwin)
 #  include <TargetConditionals.h> // To detect OSX or IOS using TARGET_OS_IPHONE or TARGET_OS_IOS macro
 #endif
 
 vpMbKltTracker::vpMbKltTracker()
-  :
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-    cur(),
-#else
-    cur(NULL),
-#endif
-    c0Mo(), compute_interaction(true),
+  : c0Mo(), compute_interaction(true),
     firstInitialisation(true), maskBorder(5), lambda(0.8), maxIter(200), threshold_outlier(0.5),
-    percentGood(0.6), ctTc0(), tracker(), kltPolygons(), kltCylinders(), circles_disp()
+    percentGood(0.6), ctTc0(), tracker(),
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100) && (VISP_HAVE_OPENCV_VERSION < 0x020408)
+    kltPoints(),
+#endif
+    kltPolygons(), kltCylinders(), circles_disp()
 {  
-  tracker.setTrackerId(1);
   tracker.setUseHarris(1);
   tracker.setMaxFeatures(10000);
   tracker.setWindowSize(5);
@@ -82,13 +79,6 @@ vpMbKltTracker::vpMbKltTracker()
 */
 vpMbKltTracker::~vpMbKltTracker()
 {
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
-  if(cur != NULL){
-    cvReleaseImage(&cur);
-    cur = NULL;
-  }
-#endif
-
   // delete the Klt Polygon features
   vpMbtDistanceKltPoints *kltpoly;
   for(std::list<vpMbtDistanceKltPoints*>::const_iterator it=kltPolygons.begin(); it!=kltPolygons.end(); ++it){
@@ -160,8 +150,6 @@ vpMbKltTracker::reinit(const vpImage<unsigned char>& I)
   c0Mo = cMo;
   ctTc0.eye();
 
-  vpImageConvert::convert(I, cur);
-
   cam.computeFov(I.getWidth(), I.getHeight());
 
   if(useScanLine){
@@ -170,17 +158,12 @@ vpMbKltTracker::reinit(const vpImage<unsigned char>& I)
   }
   
   // mask
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-  cv::Mat mask((int)I.getRows(), (int)I.getCols(), CV_8UC1, cv::Scalar(0));
-#else
-  IplImage* mask = cvCreateImage(cvSize((int)I.getWidth(), (int)I.getHeight()), IPL_DEPTH_8U, 1);
-  cvZero(mask);
-#endif
+  vpImage<unsigned char> mask(I.getHeight(), I.getWidth(), 0);
 
   vpMbtDistanceKltPoints *kltpoly;
   vpMbtDistanceKltCylinder *kltPolyCylinder;
   if(useScanLine){
-    vpImageConvert::convert(faces.getMbScanLineRenderer().getMask(), mask);
+    mask = faces.getMbScanLineRenderer().getMask();
   }
   else{
     unsigned char val = 255/* - i*15*/;
@@ -213,8 +196,8 @@ vpMbKltTracker::reinit(const vpImage<unsigned char>& I)
     }
   }
   
-  tracker.initTracking(cur, mask);
-//  tracker.track(cur); // AY: Not sure to be usefull but makes sure that the points are valid for tracking and avoid too fast reinitialisations.
+  tracker.initTracking(I, &mask);
+//  tracker.track(I); // AY: Not sure to be usefull but makes sure that the points are valid for tracking and avoid too fast reinitialisations.
 //  vpCTRACE << "init klt. detected " << tracker.getNbFeatures() << " points" << std::endl;
 
   for(std::list<vpMbtDistanceKltPoints*>::const_iterator it=kltPolygons.begin(); it!=kltPolygons.end(); ++it){
@@ -230,10 +213,6 @@ vpMbKltTracker::reinit(const vpImage<unsigned char>& I)
     if(kltPolyCylinder->isTracked())
       kltPolyCylinder->init(tracker, cMo);
   }
-
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
-  cvReleaseImage(&mask);
-#endif
 }
 
 /*!
@@ -245,13 +224,6 @@ vpMbKltTracker::resetTracker()
 {
   cMo.eye();
   
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
-  if(cur != NULL){
-    cvReleaseImage(&cur);
-    cur = NULL;
-  }
-#endif
-
   // delete the Klt Polygon features
   vpMbtDistanceKltPoints *kltpoly;
   for(std::list<vpMbtDistanceKltPoints*>::const_iterator it=kltPolygons.begin(); it!=kltPolygons.end(); ++it){
@@ -289,7 +261,6 @@ vpMbKltTracker::resetTracker()
   firstInitialisation = true;
   computeCovariance = false;
 
-  tracker.setTrackerId(1);
   tracker.setUseHarris(1);
   
   tracker.setMaxFeatures(10000);
@@ -326,9 +297,7 @@ vpMbKltTracker::resetTracker()
 /*!
   Get the current list of KLT points.
   
-  \warning Contrary to getKltPoints which returns a pointer on CvPoint2D32f. This function convert and copy the openCV KLT points into vpImagePoints.
-  
-  \return the list of KLT points through vpKltOpencv.
+  \return the list of KLT points as vpImagePoints.
 */
 std::vector<vpImagePoint> 
 vpMbKltTracker::getKltImagePoints() const
@@ -347,9 +316,7 @@ vpMbKltTracker::getKltImagePoints() const
 /*!
   Get the current list of KLT points and their id.
   
-  \warning Contrary to getKltPoints which returns a pointer on CvPoint2D32f. This function convert and copy the openCV KLT points into vpImagePoints.
-  
-  \return the list of KLT points and their id through vpKltOpencv.
+  \return the list of KLT points and their id.
 */
 std::map<int, vpImagePoint> 
 vpMbKltTracker::getKltImagePointsWithId() const
@@ -369,6 +336,80 @@ vpMbKltTracker::getKltImagePointsWithId() const
   return kltPoints;
 }
 
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+/*!
+  Get the current list of KLT points.
+
+  \warning The points are converted from the vpKltTracker features at each call.
+
+  \return the list of KLT points.
+*/
+std::vector<cv::Point2f>
+vpMbKltTracker::getKltPoints() const
+{
+  std::vector<cv::Point2f> points;
+  points.reserve((size_t)tracker.getNbFeatures());
+  for (int i = 0; i < tracker.getNbFeatures(); i ++){
+    long id;
+    float x_tmp, y_tmp;
+    tracker.getFeature(i, id, x_tmp, y_tmp);
+    points.push_back(cv::Point2f(x_tmp, y_tmp));
+  }
+
+  return points;
+}
+#elif defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+/*!
+  Get the current list of KLT points.
+
+  \warning The points are converted from the vpKltTracker features at each call.
+  The returned pointer is valid until the next call to this function.
+
+  \return the list of KLT points.
+*/
+CvPoint2D32f*
+vpMbKltTracker::getKltPoints()
+{
+  kltPoints.resize((size_t)tracker.getNbFeatures());
+  for (int i = 0; i < tracker.getNbFeatures(); i ++){
+    long id;
+    float x_tmp, y_tmp;
+    tracker.getFeature(i, id, x_tmp, y_tmp);
+    kltPoints[(size_t)i].x = x_tmp;
+    kltPoints[(size_t)i].y = y_tmp;
+  }
+
+  return kltPoints.empty() ? NULL : &kltPoints[0];
+}
+#endif
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+/*!
+  Get an OpenCV klt tracker with the settings of the tracker.
+
+  \warning Since the features are tracked by a vpKltTracker, the returned
+  tracker only holds the settings: it has no features. Use getKltTracker(),
+  getKltPoints() or getKltImagePoints() to get the tracked features.
+
+  \return klt tracker.
+*/
+vpKltOpencv
+vpMbKltTracker::getKltOpencv() const
+{
+  vpKltOpencv t;
+  t.setTrackerId(1);
+  t.setUseHarris(1);
+  t.setMaxFeatures(tracker.getMaxFeatures());
+  t.setWindowSize(tracker.getWindowSize());
+  t.setQuality(tracker.getQuality());
+  t.setMinDistance(tracker.getMinDistance());
+  t.setHarrisFreeParameter(tracker.getHarrisFreeParameter());
+  t.setBlockSize(tracker.getBlockSize());
+  t.setPyramidLevels(tracker.getPyramidLevels());
+
+  return t;
+}
+
 /*!
   Set the new value of the klt tracker.
 
@@ -384,6 +425,23 @@ vpMbKltTracker::setKltOpencv(const vpKltOpencv& t){
   tracker.setBlockSize(t.getBlockSize());
   tracker.setPyramidLevels(t.getPyramidLevels());
 }
+#endif
+
+/*!
+  Set the new value of the klt tracker.
+
+  \param t : Klt tracker containing the new values.
+*/
+void
+vpMbKltTracker::setKltTracker(const vpKltTracker& t){
+  tracker.setMaxFeatures(t.getMaxFeatures());
+  tracker.setWindowSize(t.getWindowSize());
+  tracker.setQuality(t.getQuality());
+  tracker.setMinDistance(t.getMinDistance());
+  tracker.setHarrisFreeParameter(t.getHarrisFreeParameter());
+  tracker.setBlockSize(t.getBlockSize());
+  tracker.setPyramidLevels(t.getPyramidLevels());
+}
 
 /*!
   Set the camera parameters.
@@ -435,26 +493,9 @@ vpMbKltTracker::setPose(const vpImage<unsigned char> &I, const vpHomogeneousMatr
   {
     vpMbtDistanceKltPoints *kltpoly;
 
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-    std::vector<cv::Point2f> init_pts;
+    std::vector<vpImagePoint> init_pts;
     std::vector<long> init_ids;
-    std::vector<cv::Point2f> guess_pts;
-#else
-    unsigned int nbp = 0;
-    for(std::list<vpMbtDistanceKltPoints*>::const_iterator it=kltPolygons.begin(); it!=kltPolygons.end(); ++it) {
-      kltpoly = *it;
-      if(kltpoly->polygon->isVisible() && kltpoly->polygon->getNbPoint() > 2)
-        nbp += (*it)->getCurrentNumberPoints();
-    }
-
-    CvPoint2D32f* init_pts = NULL;
-    init_pts = (CvPoint2D32f*)cvAlloc(tracker.getMaxFeatures()*sizeof(init_pts[0]));
-    long *init_ids = (long*)cvAlloc((unsigned int)tracker.getMaxFeatures()*sizeof(long));
-    unsigned int iter_pts = 0;
-
-    CvPoint2D32f* guess_pts = NULL;
-    guess_pts = (CvPoint2D32f*)cvAlloc(tracker.getMaxFeatures()*sizeof(guess_pts[0]));
-#endif
+    std::vector<vpImagePoint> guess_pts;
 
     vpHomogeneousMatrix cdMc = cdMo * cMo.inverse();
     vpHomogeneousMatrix cMcd = cdMc.inverse();
@@ -497,18 +538,11 @@ vpMbKltTracker::setPose(const vpImage<unsigned char> &I, const vpHomogeneousMatr
           vpColVector cdp(3);
           cdp[0] = iter->second.get_j(); cdp[1] = iter->second.get_i(); cdp[2] = 1.0;
 
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-          cv::Point2f p((float)cdp[0], (float)cdp[1]);
-          init_pts.push_back(p);
-#  if TARGET_OS_IPHONE
-          init_ids.push_back((size_t)(kltpoly->getCurrentPointsInd())[(int)iter->first]);
-#  else
-          init_ids.push_back((size_t)(kltpoly->getCurrentPointsInd())[(size_t)iter->first]);
-#  endif
+          init_pts.push_back(vpImagePoint(cdp[1], cdp[0]));
+#if TARGET_OS_IPHONE
+          init_ids.push_back((long)(kltpoly->getCurrentPointsInd())[(int)iter->first]);
 #else
-          init_pts[iter_pts].x = (float)cdp[0];
-          init_pts[iter_pts].y = (float)cdp[1];
-          init_ids[iter_pts] = (kltpoly->getCurrentPointsInd())[(size_t)iter->first];
+          init_ids.push_back((long)(kltpoly->getCurrentPointsInd())[(size_t)iter->first]);
 #endif
 
           double p_mu_t_2 = cdp[0] * cdGc[2][0] + cdp[1] * cdGc[2][1] + cdGc[2][2];
@@ -523,33 +557,12 @@ vpMbKltTracker::setPose(const vpImage<unsigned char> &I, const vpHomogeneousMatr
           cdp[1] = (cdp[0] * cdGc[1][0] + cdp[1] * cdGc[1][1] + cdGc[1][2]) / p_mu_t_2;
 
           //Set value to the KLT tracker
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-          cv::Point2f p_guess((float)cdp[0], (float)cdp[1]);
-          guess_pts.push_back(p_guess);
-#else
-          guess_pts[iter_pts].x = (float)cdp[0];
-          guess_pts[iter_pts++].y = (float)cdp[1];
-#endif
+          guess_pts.push_back(vpImagePoint(cdp[1], cdp[0]));
         }
       }
     }
 
-    vpImageConvert::convert(I, cur);
-
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
     tracker.setInitialGuess(init_pts, guess_pts, init_ids);
-#else
-    tracker.setInitialGuess(&init_pts, &guess_pts, init_ids, iter_pts);
-
-    if(init_pts) cvFree(&init_pts);
-    init_pts = NULL;
-
-    if(guess_pts) cvFree(&guess_pts);
-    guess_pts = NULL;
-
-    if(init_ids)cvFree(&init_ids);
-    init_ids = NULL;
-#endif
 
     bool reInitialisation = false;
     if(!useOgre)
@@ -624,8 +637,7 @@ vpMbKltTracker::initFaceFromLines(vpMbtPolygon &polygon)
 void
 vpMbKltTracker::preTracking(const vpImage<unsigned char>& I, unsigned int &nbInfos, unsigned int &nbFaceUsed)
 {
-  vpImageConvert::convert(I, cur);
-  tracker.track(cur);
+  tracker.track(I);
   
   nbInfos = 0;
   nbFaceUsed = 0;
@@ -752,8 +764,6 @@ vpMbKltTracker::computeVVS(const unsigned int &nbInfos, vpColVector &w)
   vpColVector w_true;
   vpRobust robust(2*nbInfos);
 
-  vpMatrix LTL;
-  vpColVector LTR;
   vpHomogeneousMatrix cMoPrev;
   vpHomogeneousMatrix ctTc0_Prev;
   vpColVector error_prev(2*nbInfos);
@@ -779,7 +789,7 @@ vpMbKltTracker::computeVVS(const unsigned int &nbInfos, vpColVector &w)
     if(!reStartFromLastIncrement){
       computeVVSWeights(iter, nbInfos, R, w_true, w, robust);
 
-      computeVVSPoseEstimation(iter, L, w, L_true, LVJ_true, normRes, normRes_1, w_true, R, LTL, LTR,
+      computeVVSPoseEstimation(iter, L, w, L_true, LVJ_true, normRes, normRes_1, w_true, R,
           error_prev, v, mu, cMoPrev, ctTc0_Prev);
     } // endif(!reStartFromLastIncrement)
     
@@ -872,7 +882,7 @@ vpMbKltTracker::computeVVSInteractionMatrixAndResidu(unsigned int shift, vpColVe
 void
 vpMbKltTracker::computeVVSPoseEstimation(const unsigned int iter, vpMatrix &L,
     const vpColVector &w, vpMatrix &L_true, vpMatrix &LVJ_true, double &normRes, double &normRes_1, vpColVector &w_true,
-    vpColVector &R, vpMatrix &LTL, vpColVector &LTR, vpColVector &error_prev, vpColVector &v, double &mu,
+    vpColVector &R, vpColVector &error_prev, vpColVector &v, double &mu,
     vpHomogeneousMatrix &cMoPrev, vpHomogeneousMatrix &ctTc0_Prev) {
   m_error = R;
   if(computeCovariance){
@@ -901,16 +911,11 @@ vpMbKltTracker::computeVVSPoseEstimation(const unsigned int iter, vpMatrix &L,
   }
 
   if(isoJoIdentity){
-      LTL = L.AtA();
-      computeJTR(L, R, LTR);
-
       switch(m_optimizationMethod){
       case vpMbTracker::LEVENBERG_MARQUARDT_OPT:
       {
-        vpMatrix LMA(LTL.getRows(), LTL.getCols());
-        LMA.eye();
-        vpMatrix LTLmuI = LTL + (LMA*mu);
-        v = -lambda*LTLmuI.pseudoInverse(LTLmuI.getRows()*std::numeric_limits<double>::epsilon())*LTR;
+        computeVVSNormalEquations(L, R, mu, v);
+        v = -lambda*v;
 
         if(iter != 0)
           mu /= 10.0;
@@ -920,25 +925,19 @@ vpMbKltTracker::computeVVSPoseEstimation(const unsigned int iter, vpMatrix &L,
       }
       case vpMbTracker::GAUSS_NEWTON_OPT:
       default:
-        v = -lambda * LTL.pseudoInverse(LTL.getRows()*std::numeric_limits<double>::epsilon()) * LTR;
+        computeVVSNormalEquations(L, R, 0.0, v);
+        v = -lambda*v;
       }
   }
   else{
       vpVelocityTwistMatrix cVo;
       cVo.buildFrom(cMo);
-      vpMatrix LVJ = (L*cVo*oJo);
-      vpMatrix LVJTLVJ = (LVJ).AtA();
-      vpColVector LVJTR;
-      computeJTR(LVJ, R, LVJTR);
-
+      const vpMatrix VJ = cVo*oJo;
       switch(m_optimizationMethod){
       case vpMbTracker::LEVENBERG_MARQUARDT_OPT:
       {
-        vpMatrix LMA(LVJTLVJ.getRows(), LVJTLVJ.getCols());
-        LMA.eye();
-        vpMatrix LTLmuI = LVJTLVJ + (LMA*mu);
-        v = -lambda*LTLmuI.pseudoInverse(LTLmuI.getRows()*std::numeric_limits<double>::epsilon())*LVJTR;
-        v = cVo * v;
+        computeVVSNormalEquations(L, R, VJ, mu, v);
+        v = -lambda*(cVo*v);
 
         if(iter != 0)
           mu /= 10.0;
@@ -949,8 +948,8 @@ vpMbKltTracker::computeVVSPoseEstimation(const unsigned int iter, vpMatrix &L,
       case vpMbTracker::GAUSS_NEWTON_OPT:
       default:
       {
-        v = -lambda*LVJTLVJ.pseudoInverse(LVJTLVJ.getRows()*std::numeric_limits<double>::epsilon())*LVJTR;
-        v = cVo * v;
+        computeVVSNormalEquations(L, R, VJ, 0.0, v);
+        v = -lambda*(cVo*v);
         break;
       }
       }
@@ -1413,13 +1412,6 @@ vpMbKltTracker::reInitModel(const vpImage<unsigned char>& I, const char* cad_nam
 {
   this->cMo.eye();
 
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
-  if(cur != NULL){
-    cvReleaseImage(&cur);
-    cur = NULL;
-  }
-#endif
-
   firstInitialisation = true;
 
 
@@ -1482,4 +1474,4 @@ vpMbKltTracker::setUseKltTracking(const std::string &name, const bool &useKltTra
 #elif !defined(VISP_BUILD_SHARED_LIBS)
 // Work arround to avoid warning: libvisp_mbt.a(vpMbKltTracker.cpp.o) has no symbols
 void dummy_vpMbKltTracker() {};
-#endif //VISP_HAVE_OPENCV
+#endif //VISP_HAVE_MODULE_KLT
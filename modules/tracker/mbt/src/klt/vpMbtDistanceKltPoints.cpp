@@ -39,7 +39,7 @@
 #include <visp3/mbt/vpMbtDistanceKltPoints.h>
 #include <visp3/core/vpPolygon.h>
 
-#if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
+#if defined(VISP_HAVE_MODULE_KLT)
 
 #if defined(VISP_HAVE_CLIPPER)
 #  include <clipper.hpp> // clipper private library
@@ -75,10 +75,29 @@ vpMbtDistanceKltPoints::~vpMbtDistanceKltPoints()
   map detected in the image, are parsed in order to extract the id of the points
   that are indeed in the face.
 
+  \param _tracker : ViSP KLT Tracker.
+*/
+void
+vpMbtDistanceKltPoints::init(const vpKltTracker& _tracker)
+{
+  initFromTracker(_tracker);
+}
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+/*!
+  Initialise the face to track from the points of an OpenCV KLT tracker.
+
   \param _tracker : ViSP OpenCV KLT Tracker.
 */
 void
 vpMbtDistanceKltPoints::init(const vpKltOpencv& _tracker)
+{
+  initFromTracker(_tracker);
+}
+#endif
+
+template <class KltTracker> void
+vpMbtDistanceKltPoints::initFromTracker(const KltTracker& _tracker)
 {
   // extract ids of the points in the face
   nbPointsInit = 0;
@@ -145,7 +164,28 @@ vpMbtDistanceKltPoints::init(const vpKltOpencv& _tracker)
   \return the number of points that are tracked in this face and in this instanciation of the tracker
 */
 unsigned int
+vpMbtDistanceKltPoints::computeNbDetectedCurrent(const vpKltTracker& _tracker)
+{
+  return computeNbDetected(_tracker);
+}
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+/*!
+  compute the number of point of an OpenCV KLT tracker that corresponds to the
+  points of the face
+
+  \param _tracker : the OpenCV KLT tracker
+  \return the number of points that are tracked in this face and in this instanciation of the tracker
+*/
+unsigned int
 vpMbtDistanceKltPoints::computeNbDetectedCurrent(const vpKltOpencv& _tracker)
+{
+  return computeNbDetected(_tracker);
+}
+#endif
+
+template <class KltTracker> unsigned int
+vpMbtDistanceKltPoints::computeNbDetected(const KltTracker& _tracker)
 {
   long id;
   float x, y;
@@ -345,6 +385,63 @@ vpMbtDistanceKltPoints::isTrackedFeature(const int _id)
   \param shiftBorder : Optionnal shift for the border in pixel (sort of built-in erosion) to avoid to consider pixels near the limits of the face.
 */
 void
+vpMbtDistanceKltPoints::updateMask(vpImage<unsigned char> &mask, unsigned char nb, unsigned int shiftBorder)
+{
+  int width  = (int)mask.getWidth();
+  int height = (int)mask.getHeight();
+
+  int i_min, i_max, j_min, j_max;
+  std::vector<vpImagePoint> roi;
+  polygon->getRoiClipped(cam, roi);
+  vpPolygon3D::getMinMaxRoi(roi, i_min, i_max, j_min,j_max);
+
+  /* check image boundaries */
+  if(i_min > height){ //underflow
+    i_min = 0;
+  }
+  if(i_max > height){
+    i_max = height;
+  }
+  if(j_min > width){ //underflow
+    j_min = 0;
+  }
+  if(j_max > width){
+    j_max = width;
+  }
+
+  double shiftBorder_d = (double) shiftBorder;
+  for(int i=i_min; i< i_max; i++){
+    double i_d = (double) i;
+    for(int j=j_min; j< j_max; j++){
+      double j_d = (double) j;
+      if(shiftBorder != 0){
+        if( vpPolygon::isInside(roi, i_d, j_d)
+            && vpPolygon::isInside(roi, i_d+shiftBorder_d, j_d+shiftBorder_d)
+            && vpPolygon::isInside(roi, i_d-shiftBorder_d, j_d+shiftBorder_d)
+            && vpPolygon::isInside(roi, i_d+shiftBorder_d, j_d-shiftBorder_d)
+            && vpPolygon::isInside(roi, i_d-shiftBorder_d, j_d-shiftBorder_d) ){
+          mask[i][j] = nb;
+        }
+      }
+      else{
+        if(vpPolygon::isInside(roi, i, j)){
+          mask[i][j] = nb;
+        }
+      }
+    }
+  }
+}
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
+/*!
+  Modification of all the pixels of an OpenCV mask that are in the roi to the
+  value of _nb (default is 255).
+
+  \param mask : the mask to update (0, not in the object, _nb otherwise).
+  \param nb : Optionnal value to set to the pixels included in the face.
+  \param shiftBorder : Optionnal shift for the border in pixel (sort of built-in erosion) to avoid to consider pixels near the limits of the face.
+*/
+void
 vpMbtDistanceKltPoints::updateMask(
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
     cv::Mat &mask,
@@ -433,6 +530,7 @@ vpMbtDistanceKltPoints::updateMask(
   }
 #endif
 }
+#endif
 
 /*!
   This method removes the outliers. A point is considered as outlier when its
@@ -493,7 +591,7 @@ vpMbtDistanceKltPoints::displayPrimitive(const vpImage<unsigned char>& _I)
 
     iP.set_i( vpMath::round( iP.get_i() + 7 ) );
     iP.set_j( vpMath::round( iP.get_j() + 7 ) );
-    char ide[10];
+    char ide[24];
     sprintf(ide, "%ld", static_cast<long int>(id));
     vpDisplay::displayText(_I, iP, ide, vpColor::red);
   }
@@ -518,7 +616,7 @@ vpMbtDistanceKltPoints::displayPrimitive(const vpImage<vpRGBa>& _I)
 
     iP.set_i( vpMath::round( iP.get_i() + 7 ) );
     iP.set_j( vpMath::round( iP.get_j() + 7 ) );
-    char ide[10];
+    char ide[24];
     sprintf(ide, "%ld", static_cast<long int>(id));
     vpDisplay::displayText(_I, iP, ide, vpColor::red);
   }
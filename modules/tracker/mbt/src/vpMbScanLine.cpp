@@ -44,6 +44,7 @@
 #include <cmath>
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <utility>
 
@@ -60,7 +61,9 @@
 
 vpMbScanLine::vpMbScanLine()
   : w(0), h(0), K(), maskBorder(0), mask(), primitive_ids(),
-    visibility_samples(), depthTreshold(1e-06)
+    edge_indices(), visibility_samples(), depthTreshold(1e-06), scanlinesX(), scanlinesY(), localScanlines(),
+    maskX(), maskY(), dirtyTop(0), dirtyBottom(0), dirtyLeft(0), dirtyRight(0),
+    sceneSignature(), sceneValid(false), nbScanLinesComputed(0)
 #if defined(DEBUG_DISP)
   ,dispMaskDebug(NULL), dispLineDebug(NULL), linedebugImg()
 #endif
@@ -86,15 +89,18 @@ vpMbScanLine::~vpMbScanLine()
 
   \param a : First point of the line.
   \param b : Second point of the line.
-  \param edge : Pair with the two points of the line.
+  \param edge : Index of the line given by getEdgeIndex().
   \param ID : Id of the given line (has to be know when using queries).
   \param scanlines : Resulting intersections.
+  \param first : First index of the modified scanlines, updated if needed.
+  \param last : Index following the last modified scanline, updated if needed.
 */
 void vpMbScanLine::drawLineY(const vpColVector &a,
                const vpColVector &b,
-               const vpMbScanLineEdge &edge,
+               const unsigned int edge,
                const int ID,
-               std::vector<std::vector<vpMbScanLineSegment> > &scanlines)
+               std::vector<std::vector<vpMbScanLineSegment> > &scanlines,
+               unsigned int &first, unsigned int &last)
 {
   double x0 = a[0] / a[2];
   double y0 = a[1] / a[2];
@@ -118,7 +124,8 @@ void vpMbScanLine::drawLineY(const vpColVector &a,
 
   const bool b_sample_Y = (std::fabs(y0 - y1) > std::fabs(x0 - x1));
 
-  for(unsigned int y = _y0 ; y < _y1 ; ++y)
+  unsigned int y = _y0;
+  for( ; y < _y1 ; ++y)
   {
       const double x = x0 + (x1 - x0) * (y - y0) / (y1 - y0);
       const double alpha = getAlpha(y, y0 * z0, z0, y1 * z1, z1);
@@ -132,6 +139,12 @@ void vpMbScanLine::drawLineY(const vpColVector &a,
       s.b_sample_Y = b_sample_Y;
       scanlines[y].push_back(s);
   }
+
+  if (y > _y0)
+  {
+    first = std::min(first, _y0);
+    last = std::max(last, y);
+  }
 }
 
 /*!
@@ -139,15 +152,18 @@ void vpMbScanLine::drawLineY(const vpColVector &a,
 
   \param a : First point of the line.
   \param b : Second point of the line.
-  \param edge : Pair with the two points of the line.
+  \param edge : Index of the line given by getEdgeIndex().
   \param ID : Id of the given line (has to be know when using queries).
   \param scanlines : Resulting intersections.
+  \param first : First index of the modified scanlines, updated if needed.
+  \param last : Index following the last modified scanline, updated if needed.
 */
 void vpMbScanLine::drawLineX(const vpColVector &a,
                const vpColVector &b,
-               const vpMbScanLineEdge &edge,
+               const unsigned int edge,
                const int ID,
-               std::vector<std::vector<vpMbScanLineSegment> > &scanlines)
+               std::vector<std::vector<vpMbScanLineSegment> > &scanlines,
+               unsigned int &first, unsigned int &last)
 {
   double x0 = a[0] / a[2];
   double y0 = a[1] / a[2];
@@ -171,7 +187,8 @@ void vpMbScanLine::drawLineX(const vpColVector &a,
 
   const bool b_sample_Y = (std::fabs(y0 - y1) > std::fabs(x0 - x1));
 
-  for(unsigned int x = _x0 ; x < _x1 ; ++x)
+  unsigned int x = _x0;
+  for( ; x < _x1 ; ++x)
   {
       const double y = y0 + (y1 - y0) * (x - x0) / (x1 - x0);
       const double alpha = getAlpha(x, x0 * z0, z0, x1 * z1, z1);
@@ -185,6 +202,12 @@ void vpMbScanLine::drawLineX(const vpColVector &a,
       s.b_sample_Y = b_sample_Y;
       scanlines[x].push_back(s);
   }
+
+  if (x > _x0)
+  {
+    first = std::min(first, _x0);
+    last = std::max(last, x);
+  }
 }
 
 
@@ -194,11 +217,14 @@ void vpMbScanLine::drawLineX(const vpColVector &a,
   \param polygon : Polygon composed by an array of lines.
   \param ID : ID of the polygon (has to be know when using queries).
   \param scanlines : Resulting intersections.
+  \param first : First index of the modified scanlines, updated if needed.
+  \param last : Index following the last modified scanline, updated if needed.
 */
 void
 vpMbScanLine::drawPolygonY(const std::vector<std::pair<vpPoint, unsigned int> > &polygon,
                   const int ID,
-                  std::vector<std::vector<vpMbScanLineSegment> > &scanlines)
+                  std::vector<std::vector<vpMbScanLineSegment> > &scanlines,
+                  unsigned int &first, unsigned int &last)
 {
   if (polygon.size() < 2)
     return;
@@ -211,14 +237,13 @@ vpMbScanLine::drawPolygonY(const std::vector<std::pair<vpPoint, unsigned int> >
 
     drawLineY(p1,
               p2,
-              makeMbScanLineEdge(polygon.front().first, polygon.back().first),
+              getEdgeIndex(polygon.front().first, polygon.back().first),
               ID,
-              scanlines);
+              scanlines, first, last);
     return;
   }
 
-  std::vector<std::vector<vpMbScanLineSegment> > local_scanlines;
-  local_scanlines.resize(h);
+  unsigned int local_first = h, local_last = 0;
 
   for(size_t i = 0 ; i < polygon.size() ; ++i)
   {
@@ -226,10 +251,16 @@ vpMbScanLine::drawPolygonY(const std::vector<std::pair<vpPoint, unsigned int> >
     createVectorFromPoint(polygon[i].first, p1, K);
     createVectorFromPoint(polygon[(i + 1) % polygon.size()].first, p2, K);
 
-    drawLineY(p1, p2, makeMbScanLineEdge(polygon[i].first, polygon[(i + 1) % polygon.size()].first), ID, local_scanlines);
+    drawLineY(p1, p2, getEdgeIndex(polygon[i].first, polygon[(i + 1) % polygon.size()].first), ID,
+              localScanlines, local_first, local_last);
   }
 
-  createScanLinesFromLocals(scanlines,local_scanlines,h);
+  if (local_first < local_last)
+  {
+    createScanLinesFromLocals(scanlines, localScanlines, local_first, local_last);
+    first = std::min(first, local_first);
+    last = std::max(last, local_last);
+  }
 }
 
 /*!
@@ -238,11 +269,14 @@ vpMbScanLine::drawPolygonY(const std::vector<std::pair<vpPoint, unsigned int> >
   \param polygon : Polygon composed by an array of lines.
   \param ID : ID of the polygon (has to be know when using queries).
   \param scanlines : Resulting intersections.
+  \param first : First index of the modified scanlines, updated if needed.
+  \param last : Index following the last modified scanline, updated if needed.
 */
 void
 vpMbScanLine::drawPolygonX(const std::vector<std::pair<vpPoint, unsigned int> > &polygon,
                   const int ID,
-                  std::vector<std::vector<vpMbScanLineSegment> > &scanlines)
+                  std::vector<std::vector<vpMbScanLineSegment> > &scanlines,
+                  unsigned int &first, unsigned int &last)
 {
   if (polygon.size() < 2)
       return;
@@ -255,14 +289,13 @@ vpMbScanLine::drawPolygonX(const std::vector<std::pair<vpPoint, unsigned int> >
 
     drawLineX(p1,
               p2,
-              makeMbScanLineEdge(polygon.front().first, polygon.back().first),
+              getEdgeIndex(polygon.front().first, polygon.back().first),
               ID,
-              scanlines);
+              scanlines, first, last);
     return;
   }
 
-  std::vector<std::vector<vpMbScanLineSegment> > local_scanlines;
-  local_scanlines.resize(w);
+  unsigned int local_first = w, local_last = 0;
 
   for(size_t i = 0 ; i < polygon.size() ; ++i)
   {
@@ -270,10 +303,16 @@ vpMbScanLine::drawPolygonX(const std::vector<std::pair<vpPoint, unsigned int> >
     createVectorFromPoint(polygon[i].first, p1, K);
     createVectorFromPoint(polygon[(i + 1) % polygon.size()].first, p2, K);
 
-    drawLineX(p1, p2, makeMbScanLineEdge(polygon[i].first, polygon[(i + 1) % polygon.size()].first), ID, local_scanlines);
+    drawLineX(p1, p2, getEdgeIndex(polygon[i].first, polygon[(i + 1) % polygon.size()].first), ID,
+              localScanlines, local_first, local_last);
   }
 
-  createScanLinesFromLocals(scanlines,local_scanlines,w);
+  if (local_first < local_last)
+  {
+    createScanLinesFromLocals(scanlines, localScanlines, local_first, local_last);
+    first = std::min(first, local_first);
+    last = std::max(last, local_last);
+  }
 }
 
 /*!
@@ -281,16 +320,19 @@ vpMbScanLine::drawPolygonX(const std::vector<std::pair<vpPoint, unsigned int> >
   It also marks the computed intersections as starting or ending points.
   This function will only be called by the drawPolygons functions.
 
+  The processed local scanlines are emptied so that they can be reused by the next polygon.
+
   \param scanlines : Global scanline vector.
   \param localScanlines : Local scanline vector (X or Y-axis).
-  \param size : Corresponding size (typically the width or the height).
+  \param first : First index of the local scanlines to consider.
+  \param last : Index following the last local scanline to consider.
 */
 void
 vpMbScanLine::createScanLinesFromLocals(std::vector<std::vector<vpMbScanLineSegment> > &scanlines,
                                         std::vector<std::vector<vpMbScanLineSegment> > &localScanlines,
-                                        const unsigned int &size)
+                                        const unsigned int &first, const unsigned int &last)
 {
-  for(unsigned int j = 0 ; j < size ; ++j)
+  for(unsigned int j = first ; j < last ; ++j)
   {
       std::vector<vpMbScanLineSegment> &scanline = localScanlines[j];
       sort(scanline.begin(), scanline.end(), vpMbScanLineSegmentComparator()); // Not sure its necessary
@@ -318,12 +360,18 @@ vpMbScanLine::createScanLinesFromLocals(std::vector<std::vector<vpMbScanLineSegm
           }
           scanlines[j].push_back(s);
       }
+      scanline.clear();
   }
 }
 
 /*!
   Render a scene of polygons and compute scanlines intersections in order to use queries.
 
+  The buffers are kept from one call to the next: only the region covered by the
+  previous render is cleared and only the scanlines crossed by a polygon are processed.
+  When the polygons, the camera parameters and the size are exactly the same as during
+  the previous call, the previous render is kept as is.
+
   \param polygons : List of polygons composed by arrays of lines.
   \param listPolyIndices : List of polygons IDs (has to be know when using queries).
   \param cam : Camera parameters.
@@ -335,39 +383,83 @@ vpMbScanLine::drawScene(const std::vector<std::vector<std::pair<vpPoint, unsigne
                         std::vector<int> listPolyIndices,
                         const vpCameraParameters &cam, unsigned int width, unsigned int height)
 {
-  this->w = width;
-  this->h = height;
-  this->K = cam;
-
-  visibility_samples.clear();
-
-  std::vector<std::vector<vpMbScanLineSegment> > scanlinesY;
-  scanlinesY.resize(h);
-  std::vector<std::vector<vpMbScanLineSegment> > scanlinesX;
-  scanlinesX.resize(w);
+  // Signature of the scene: everything the render depends on
+  std::vector<double> signature;
+  signature.reserve(8 * polygons.size() + 4);
+  signature.push_back(cam.get_px());
+  signature.push_back(cam.get_py());
+  signature.push_back(cam.get_u0());
+  signature.push_back(cam.get_v0());
+  for(unsigned int ID = 0 ; ID < polygons.size() ; ++ID)
+  {
+      const std::vector<std::pair<vpPoint, unsigned int> > &polygon = *(polygons[ID]);
+      signature.push_back((double)listPolyIndices[ID]);
+      signature.push_back((double)polygon.size());
+      for(size_t i = 0 ; i < polygon.size() ; ++i)
+      {
+          signature.push_back(polygon[i].first.get_X());
+          signature.push_back(polygon[i].first.get_Y());
+          signature.push_back(polygon[i].first.get_Z());
+      }
+  }
 
-  mask.resize(h,w,0);
+  if (sceneValid && width == w && height == h && signature == sceneSignature)
+  {
+      nbScanLinesComputed = 0;
+      return;
+  }
+  sceneSignature.swap(signature);
+  sceneValid = true;
 
-  vpImage<unsigned char> maskY(h,w,0);
-  vpImage<unsigned char> maskX(h,w,0);
+  if (width != w || height != h || mask.getHeight() != height || mask.getWidth() != width)
+  {
+      this->w = width;
+      this->h = height;
+
+      scanlinesY.clear();
+      scanlinesY.resize(h);
+      scanlinesX.clear();
+      scanlinesX.resize(w);
+      localScanlines.clear();
+      localScanlines.resize(std::max(w, h));
+
+      mask.resize(h, w, 0);
+      maskY.resize(h, w, 0);
+      maskX.resize(h, w, 0);
+      primitive_ids.resize(h, w, -1);
+
+      dirtyTop = dirtyBottom = dirtyLeft = dirtyRight = 0;
+  }
+  else
+  {
+      clearDirtyRegion();
+  }
+  this->K = cam;
 
-  primitive_ids.resize(h, w, -1);
+  edge_indices.clear();
+  for(size_t i = 0 ; i < visibility_samples.size() ; ++i)
+      visibility_samples[i].clear();
 
+  unsigned int firstY = h, lastY = 0;
+  unsigned int firstX = w, lastX = 0;
   for(unsigned int ID = 0 ; ID < polygons.size() ; ++ID)
   {
-      drawPolygonY(*(polygons[ID]), listPolyIndices[ID], scanlinesY);
-      drawPolygonX(*(polygons[ID]), listPolyIndices[ID], scanlinesX);
+      drawPolygonY(*(polygons[ID]), listPolyIndices[ID], scanlinesY, firstY, lastY);
+      drawPolygonX(*(polygons[ID]), listPolyIndices[ID], scanlinesX, firstX, lastX);
   }
+  nbScanLinesComputed = (lastY > firstY ? lastY - firstY : 0) + (lastX > firstX ? lastX - firstX : 0);
 
   // Y
+  // Scanlines outside [firstY, lastY[ are empty and would not change anything
   int last_ID = -1;
   vpMbScanLineSegment last_visible;
-  for(unsigned int y = 0 ; y < scanlinesY.size() ; ++y)
+  std::vector<std::pair<double, vpMbScanLineSegment> > stack;
+  for(unsigned int y = firstY ; y < lastY ; ++y)
   {
       std::vector<vpMbScanLineSegment> &scanline = scanlinesY[y];
       sort(scanline.begin(), scanline.end(), vpMbScanLineSegmentComparator());
 
-      std::vector<std::pair<double, vpMbScanLineSegment> > stack;
+      stack.clear();
       for(size_t i = 0 ; i < scanline.size() ; ++i)
       {
           const vpMbScanLineSegment &s = scanline[i];
@@ -406,15 +498,15 @@ vpMbScanLine::drawScene(const std::vector<std::vector<std::pair<vpPoint, unsigne
                   {
                   case POINT:
                       if (new_ID == -1 || s.Z1 - depthTreshold <= stack.front().first)
-                          visibility_samples[s.edge].insert((int)y);
+                          addVisibilitySample(s.edge, (int)y);
                       break;
                   case START:
                       if (new_ID == s.ID)
-                          visibility_samples[s.edge].insert((int)y);
+                          addVisibilitySample(s.edge, (int)y);
                       break;
                   case END:
                       if (last_ID == s.ID)
-                          visibility_samples[s.edge].insert((int)y);
+                          addVisibilitySample(s.edge, (int)y);
                       break;
                   }
 
@@ -423,7 +515,8 @@ vpMbScanLine::drawScene(const std::vector<std::vector<std::pair<vpPoint, unsigne
               {
                   const unsigned int x0 = std::max<unsigned int>(0, (unsigned int)(std::ceil(last_visible.p)));
                   const double x1 = std::min<double>(w, s.p);
-                  for(unsigned int x = x0 + maskBorder ; x < x1 - maskBorder; ++x)
+                  unsigned int x = x0 + maskBorder;
+                  for( ; x < x1 - maskBorder; ++x)
                   {
                       primitive_ids[(unsigned int)y][(unsigned int)x] = last_visible.ID;
 
@@ -432,6 +525,8 @@ vpMbScanLine::drawScene(const std::vector<std::vector<std::pair<vpPoint, unsigne
                       else
                         mask[(unsigned int)y][(unsigned int)x] = 255;
                   }
+                  if (x > x0 + maskBorder)
+                    extendDirtyRegion(y, y + 1, x0 + maskBorder, x);
               }
 
               last_ID = new_ID;
@@ -442,16 +537,17 @@ vpMbScanLine::drawScene(const std::vector<std::vector<std::pair<vpPoint, unsigne
               }
           }
       }
+      scanline.clear();
   }
 
   // X
   last_ID = -1;
-  for(unsigned int x = 0 ; x < scanlinesX.size() ; ++x)
+  for(unsigned int x = firstX ; x < lastX ; ++x)
   {
       std::vector<vpMbScanLineSegment> &scanline = scanlinesX[x];
       sort(scanline.begin(), scanline.end(), vpMbScanLineSegmentComparator());
 
-      std::vector<std::pair<double, vpMbScanLineSegment> > stack;
+      stack.clear();
       for(size_t i = 0 ; i < scanline.size() ; ++i)
       {
           const vpMbScanLineSegment &s = scanline[i];
@@ -490,15 +586,15 @@ vpMbScanLine::drawScene(const std::vector<std::vector<std::pair<vpPoint, unsigne
                   {
                   case POINT:
                       if (new_ID == -1 || s.Z1 - depthTreshold <= stack.front().first)
-                          visibility_samples[s.edge].insert((int)x);
+                          addVisibilitySample(s.edge, (int)x);
                       break;
                   case START:
                       if (new_ID == s.ID)
-                          visibility_samples[s.edge].insert((int)x);
+                          addVisibilitySample(s.edge, (int)x);
                       break;
                   case END:
                       if (last_ID == s.ID)
-                          visibility_samples[s.edge].insert((int)x);
+                          addVisibilitySample(s.edge, (int)x);
                       break;
                   }
 
@@ -507,11 +603,14 @@ vpMbScanLine::drawScene(const std::vector<std::vector<std::pair<vpPoint, unsigne
               {
                   const unsigned int y0 = std::max<unsigned int>(0, (unsigned int)(std::ceil(last_visible.p)));
                   const double y1 = std::min<double>(h, s.p);
-                  for(unsigned int y = y0 + maskBorder ; y < y1 - maskBorder; ++y)
+                  unsigned int y = y0 + maskBorder;
+                  for( ; y < y1 - maskBorder; ++y)
                   {
                       //primitive_ids[(unsigned int)y][(unsigned int)x] = last_visible.ID;
                       maskX[(unsigned int)y][(unsigned int)x] = 255;
                   }
+                  if (y > y0 + maskBorder)
+                    extendDirtyRegion(y0 + maskBorder, y, x, x + 1);
               }
 
               last_ID = new_ID;
@@ -522,11 +621,13 @@ vpMbScanLine::drawScene(const std::vector<std::vector<std::pair<vpPoint, unsigne
               }
           }
       }
+      scanline.clear();
   }
 
+  // maskX and maskY are null outside of the dirty region
   if(maskBorder != 0)
-    for(unsigned int i = 0 ; i < h ; i++)
-      for(unsigned int j = 0 ; j < w ; j++)
+    for(unsigned int i = dirtyTop ; i < dirtyBottom ; i++)
+      for(unsigned int j = dirtyLeft ; j < dirtyRight ; j++)
         if(maskX[i][j] == 255 && maskY[i][j] == 255)
           mask[i][j] = 255;
 
@@ -564,9 +665,103 @@ vpMbScanLine::drawScene(const std::vector<std::vector<std::pair<vpPoint, unsigne
 
 }
 
+/*!
+  Get the index of the edge defined by two points in the current scene, and register
+  it if needed. Edges shared by several polygons get the same index.
+
+  \param a : First point of the line.
+  \param b : Second point of the line.
+
+  \return Index of the edge, used to store its visibility samples.
+*/
+unsigned int
+vpMbScanLine::getEdgeIndex(const vpPoint &a, const vpPoint &b)
+{
+  const std::pair<std::map<vpMbScanLineEdge, unsigned int, vpMbScanLineEdgeComparator>::iterator, bool> it =
+      edge_indices.insert(std::make_pair(makeMbScanLineEdge(a, b), (unsigned int)edge_indices.size()));
+  if (it.second && visibility_samples.size() < edge_indices.size())
+    visibility_samples.resize(edge_indices.size());
+
+  return it.first->second;
+}
+
+/*!
+  Add a visible sample to an edge, keeping the samples sorted and unique.
+
+  \param edge : Index of the edge.
+  \param sample : Index of the visible scanline.
+*/
+void
+vpMbScanLine::addVisibilitySample(const unsigned int edge, const int sample)
+{
+  std::vector<int> &samples = visibility_samples[edge];
+  if (samples.empty() || samples.back() < sample)
+    samples.push_back(sample);
+  else
+  {
+    std::vector<int>::iterator it = std::lower_bound(samples.begin(), samples.end(), sample);
+    if (*it != sample)
+      samples.insert(it, sample);
+  }
+}
+
+/*!
+  Reset the pixels of the masks and of the primitive ids that have been written by the
+  previous render, and empty the dirty region.
+*/
+void
+vpMbScanLine::clearDirtyRegion()
+{
+  if (dirtyTop < dirtyBottom && dirtyLeft < dirtyRight)
+  {
+    const unsigned int size = dirtyRight - dirtyLeft;
+    for(unsigned int i = dirtyTop ; i < dirtyBottom ; i++)
+    {
+      memset(mask[i] + dirtyLeft, 0, size * sizeof(unsigned char));
+      memset(maskX[i] + dirtyLeft, 0, size * sizeof(unsigned char));
+      memset(maskY[i] + dirtyLeft, 0, size * sizeof(unsigned char));
+      std::fill(primitive_ids[i] + dirtyLeft, primitive_ids[i] + dirtyRight, -1);
+    }
+  }
+
+  dirtyTop = dirtyBottom = dirtyLeft = dirtyRight = 0;
+}
+
+/*!
+  Extend the dirty region so that it contains the given area.
+
+  \param top : First row of the area.
+  \param bottom : Row following the last row of the area.
+  \param left : First column of the area.
+  \param right : Column following the last column of the area.
+*/
+void
+vpMbScanLine::extendDirtyRegion(const unsigned int top, const unsigned int bottom,
+                                const unsigned int left, const unsigned int right)
+{
+  if (dirtyTop >= dirtyBottom || dirtyLeft >= dirtyRight)
+  {
+    dirtyTop = top;
+    dirtyBottom = bottom;
+    dirtyLeft = left;
+    dirtyRight = right;
+  }
+  else
+  {
+    dirtyTop = std::min(dirtyTop, top);
+    dirtyBottom = std::max(dirtyBottom, bottom);
+    dirtyLeft = std::min(dirtyLeft, left);
+    dirtyRight = std::max(dirtyRight, right);
+  }
+}
+
 /*!
   Test the visibility of a line. As a result, a subsampled line of the given one with all its visible parts.
 
+  The line must be an edge of one of the polygons given to the last call to drawScene(),
+  otherwise no visible part is returned. The query only reads the result of the render,
+  so that several lines can be queried at the same time from different threads.
+
   \param a : First point of the line.
   \param b : Second point of the line.
   \param lines : List of lines corresponding of the visible parts of the given line.
@@ -588,7 +783,7 @@ vpMbScanLine::queryLineVisibility(const vpPoint &a, const vpPoint &b,
   double y1 = _b[1] / _b[2];
   double z1 = _b[2];
 
-  vpMbScanLineEdge edge = makeMbScanLineEdge(a, b);
+  const vpMbScanLineEdge edge = makeMbScanLineEdge(a, b);
   lines.clear();
 
   if(displayResults){
@@ -604,7 +799,11 @@ vpMbScanLine::queryLineVisibility(const vpPoint &a, const vpPoint &b,
 #endif
   }
 
-  if (!visibility_samples.count(edge))
+  // Lookup without operator[] so that concurrent queries only read the map.
+  // An edge that has not been rendered has no visible part.
+  std::map<vpMbScanLineEdge, unsigned int, vpMbScanLineEdgeComparator>::const_iterator it_edge =
+      edge_indices.find(edge);
+  if (it_edge == edge_indices.end())
       return;
 
   // Initialized as the biggest difference between the two points is on the X-axis
@@ -646,12 +845,12 @@ vpMbScanLine::queryLineVisibility(const vpPoint &a, const vpPoint &b,
   const int _v0 = std::max(0, int(std::ceil(*v0)));
   const int _v1 = std::min<int>((int)(size - 1), (int)(std::ceil(*v1) - 1));
 
-  const std::set<int> &visible_samples = visibility_samples[edge];
+  const std::vector<int> &visible_samples = visibility_samples[it_edge->second];
   int last = _v0;
   vpPoint line_start;
   vpPoint line_end;
   bool b_line_started = false;
-  for(std::set<int>::const_iterator it = visible_samples.begin() ; it != visible_samples.end() ; ++it)
+  for(std::vector<int>::const_iterator it = visible_samples.begin() ; it != visible_samples.end() ; ++it)
   {
       const int v = *it;
       const double alpha = getAlpha(v, (*v0) * (*w0), (*w0), (*v1) * (*w1), (*w1));
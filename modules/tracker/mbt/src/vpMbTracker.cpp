@@ -68,6 +68,7 @@
 #endif
 #include <visp3/mbt/vpMbTracker.h>
 #include <visp3/core/vpMatrixException.h>
+#include <visp3/core/vpWeightedLeastSquares.h>
 #include <visp3/core/vpIoTools.h>
 
 #ifdef VISP_HAVE_COIN3D
@@ -2378,6 +2379,48 @@ vpMbTracker::computeJTR(const vpMatrix& interaction, const vpColVector& error, v
   }
 }
 
+/*!
+  Solve \f$ (J^T J + \mu I) v = J^T R \f$, with J the interaction matrix and R
+  the vector of residu, both already weighted.
+
+  The rows of J are accumulated in the normal equations, that are solved by a
+  Cholesky decomposition. The SVD pseudo-inverse of \f$ J^T J + \mu I \f$ is only
+  computed when this matrix is badly conditioned.
+
+  \param J : The interaction matrix (size Nx6).
+  \param R : The residu vector (size Nx1).
+  \param mu : Levenberg-Marquardt damping, 0 for a Gauss-Newton step.
+  \param v : The solution (size 6x1).
+*/
+void
+vpMbTracker::computeVVSNormalEquations(const vpMatrix& J, const vpColVector& R, const double mu, vpColVector& v) const
+{
+  vpWeightedLeastSquares normalEquations(J.getCols());
+  normalEquations.addRows(J, R);
+  normalEquations.solve(v, mu, J.getCols()*std::numeric_limits<double>::epsilon());
+}
+
+/*!
+  Solve \f$ ((JT)^T JT + \mu I) v = (JT)^T R \f$ without building the matrix JT:
+  the rows of J are accumulated in the normal equations, that are then multiplied
+  by T.
+
+  \param J : The interaction matrix (size Nx6).
+  \param R : The residu vector (size Nx1).
+  \param T : The change of variables, typically \f$ {^c}V_o \; {^o}J_o \f$ (size 6x6).
+  \param mu : Levenberg-Marquardt damping, 0 for a Gauss-Newton step.
+  \param v : The solution (size 6x1).
+*/
+void
+vpMbTracker::computeVVSNormalEquations(const vpMatrix& J, const vpColVector& R, const vpMatrix& T, const double mu,
+                                       vpColVector& v) const
+{
+  vpWeightedLeastSquares normalEquations(J.getCols());
+  normalEquations.addRows(J, R);
+  normalEquations.changeVariables(T);
+  normalEquations.solve(v, mu, T.getCols()*std::numeric_limits<double>::epsilon());
+}
+
 /*!
   Get a 1x6 vpColVector representing the estimated degrees of freedom.
   vpColVector[0] = 1 if translation on X is estimated, 0 otherwise;
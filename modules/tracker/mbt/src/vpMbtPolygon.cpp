@@ -39,6 +39,8 @@
  *****************************************************************************/
 
 #include <limits.h>
+#include <cmath>
+#include <limits>
 
 #include <visp3/core/vpConfig.h>
 /*!
@@ -49,6 +51,23 @@
 #include <visp3/mbt/vpMbtPolygon.h>
 #include <visp3/core/vpPolygon.h>
 
+namespace
+{
+// Same as vpColVector::normalize() for a 3-vector
+void normalize(double v[3])
+{
+  double sum_square = 0.0;
+  for (unsigned int i = 0; i < 3; i++)
+    sum_square += v[i] * v[i];
+
+  if (std::fabs(sum_square) > std::numeric_limits<double>::epsilon()) {
+    double norm = sqrt(sum_square);
+    for (unsigned int i = 0; i < 3; i++)
+      v[i] /= norm;
+  }
+}
+}
+
 /*!
   Basic constructor.
 */
@@ -158,31 +177,33 @@ vpMbtPolygon::isVisible(const vpHomogeneousMatrix &cMo, const double alpha, cons
   //Check visibility from normal
   //Newell's Method for calculating the normal of an arbitrary 3D polygon
   //https://www.opengl.org/wiki/Calculating_a_Surface_Normal
-  vpColVector faceNormal(3);
-  vpColVector currentVertex, nextVertex;
+  // Computed on the stack, in the same order as with vpColVector, since this
+  // test is done for each face of the model at each frame.
+  double faceNormal[3] = { 0., 0., 0. };
   for(unsigned int  i = 0; i<nbpt; i++) {
-    currentVertex = p[i].cP;
-    nextVertex = p[(i+1) % nbpt].cP;
+    const vpPoint &currentVertex = p[i];
+    const vpPoint &nextVertex = p[(i+1) % nbpt];
 
-    faceNormal[0] += (currentVertex[1] - nextVertex[1]) * (currentVertex[2] + nextVertex[2]);
-    faceNormal[1] += (currentVertex[2] - nextVertex[2]) * (currentVertex[0] + nextVertex[0]);
-    faceNormal[2] += (currentVertex[0] - nextVertex[0]) * (currentVertex[1] + nextVertex[1]);
+    faceNormal[0] += (currentVertex.get_Y() - nextVertex.get_Y()) * (currentVertex.get_Z() + nextVertex.get_Z());
+    faceNormal[1] += (currentVertex.get_Z() - nextVertex.get_Z()) * (currentVertex.get_X() + nextVertex.get_X());
+    faceNormal[2] += (currentVertex.get_X() - nextVertex.get_X()) * (currentVertex.get_Y() + nextVertex.get_Y());
   }
-  faceNormal.normalize();
+  normalize(faceNormal);
 
-  vpColVector e4(3) ;
-  vpPoint pt;
+  // The sum starts from the coordinates of a default vpPoint (0, 0, 1)
+  double sum[3] = { 0., 0., 1. };
   for (unsigned int i = 0; i < nbpt; i += 1){
-    pt.set_X(pt.get_X() + p[i].get_X());
-    pt.set_Y(pt.get_Y() + p[i].get_Y());
-    pt.set_Z(pt.get_Z() + p[i].get_Z());
+    sum[0] = sum[0] + p[i].get_X();
+    sum[1] = sum[1] + p[i].get_Y();
+    sum[2] = sum[2] + p[i].get_Z();
   }
-  e4[0] = -pt.get_X() / (double)nbpt;
-  e4[1] = -pt.get_Y() / (double)nbpt;
-  e4[2] = -pt.get_Z() / (double)nbpt;
-  e4.normalize();
+  double e4[3];
+  e4[0] = -sum[0] / (double)nbpt;
+  e4[1] = -sum[1] / (double)nbpt;
+  e4[2] = -sum[2] / (double)nbpt;
+  normalize(e4);
 
-  double angle = acos(vpColVector::dotProd(e4, faceNormal));
+  double angle = acos(0. + e4[0] * faceNormal[0] + e4[1] * faceNormal[1] + e4[2] * faceNormal[2]);
 
 //  vpCTRACE << angle << "/" << vpMath::deg(angle) << "/" << vpMath::deg(alpha) << std::endl;
 
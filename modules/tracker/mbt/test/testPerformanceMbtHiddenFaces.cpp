@@ -0,0 +1,374 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the clipping of the faces of a large model.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceMbtHiddenFaces.cpp
+
+  \brief Check that vpMbHiddenFaces::computeClippedPolygons() gives the clipped
+  polygons of each face clipped alone, that the faces entirely inside or outside
+  the clipping planes are not modified or removed, and measure the time spent to
+  clip the faces of a model made of many small boxes. Check also that the scanline
+  render and the visibility test are only computed again when the pose or the
+  parameters change.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/mbt/vpMbHiddenFaces.h>
+
+namespace {
+  //! Grid of nx x ny x nz boxes of side 5cm, one every 10cm
+  void createModel(vpMbHiddenFaces<vpMbtPolygon> &faces, const int nx, const int ny, const int nz)
+  {
+    const int quad[6][4] = { {0, 1, 2, 3}, {1, 6, 5, 2}, {4, 5, 6, 7}, {0, 3, 4, 7}, {5, 4, 3, 2}, {0, 7, 6, 1} };
+    const double corner[8][3] = { {0, 0, 0}, {0, 0, -1}, {1, 0, -1}, {1, 0, 0},
+                                  {1, 1, 0}, {1, 1, -1}, {0, 1, -1}, {0, 1, 0} };
+    int index = 0;
+    for (int i = 0; i < nx; i++) {
+      for (int j = 0; j < ny; j++) {
+        for (int k = 0; k < nz; k++) {
+          for (int f = 0; f < 6; f++) {
+            vpMbtPolygon polygon;
+            polygon.setNbPoint(4);
+            polygon.setIndex(index++);
+            for (unsigned int v = 0; v < 4; v++) {
+              const double *c = corner[quad[f][v]];
+              polygon.addPoint(v, vpPoint(0.1 * i + 0.05 * c[0], 0.1 * j + 0.05 * c[1], 0.1 * k + 0.05 * c[2]));
+            }
+            faces.addPolygon(&polygon);
+          }
+        }
+      }
+    }
+    for (unsigned int i = 0; i < faces.size(); i++) {
+      faces[i]->setClipping(vpPolygon3D::NEAR_CLIPPING | vpPolygon3D::FAR_CLIPPING | vpPolygon3D::FOV_CLIPPING);
+      faces[i]->setNearClippingDistance(0.1);
+      faces[i]->setFarClippingDistance(3.0);
+    }
+  }
+
+  bool samePoint(const vpPoint &a, const vpPoint &b)
+  {
+    return a.get_X() == b.get_X() && a.get_Y() == b.get_Y() && a.get_Z() == b.get_Z() && a.get_x() == b.get_x() &&
+        a.get_y() == b.get_y();
+  }
+
+  /*!
+    Side of the face with respect to its clipping planes: -1 if all its points are
+    outside one of the planes, 1 if all its points are strictly inside all the
+    planes, 0 otherwise.
+  */
+  int clippingSide(const vpMbtPolygon &face, const vpCameraParameters &cam)
+  {
+    const std::vector<vpColVector> &normals = cam.getFovNormals();
+    const unsigned int flag = face.getClipping();
+    bool inside = true;
+    for (unsigned int plane = 0; plane < 6; plane++) {
+      // The near clipping is also used with the field of view clipping
+      if (! (flag & (1u << plane)) && ! (plane == 0 && flag > vpPolygon3D::FAR_CLIPPING))
+        continue;
+      unsigned int nbOutside = 0;
+      for (unsigned int j = 0; j < face.nbpt; j++) {
+        const vpPoint &P = face.p[j];
+        double d;
+        if (plane == 0)
+          d = face.getNearClippingDistance() - P.get_Z();
+        else if (plane == 1)
+          d = P.get_Z() - face.getFarClippingDistance();
+        else
+          d = normals[plane - 2][0] * P.get_X() + normals[plane - 2][1] * P.get_Y() + normals[plane - 2][2] * P.get_Z();
+        if (d > 1e-6)
+          nbOutside++;
+        else if (d > -1e-6)
+          inside = false;
+      }
+      if (nbOutside == face.nbpt)
+        return -1;
+      if (nbOutside > 0)
+        inside = false;
+    }
+    return inside ? 1 : 0;
+  }
+
+  //! Render the scanlines of the faces seen from \e cMo and check the number of scanlines computed
+  bool testRender(vpMbHiddenFaces<vpMbtPolygon> &faces, const vpHomogeneousMatrix &cMo,
+                  const vpCameraParameters &cam, const unsigned int w, const unsigned int h, const bool computed)
+  {
+    faces.computeClippedPolygons(cMo, cam);
+    faces.computeScanLineRender(cam, w, h);
+    const unsigned int nbScanLines = faces.getNbScanLinesRecomputed();
+    if ((nbScanLines > 0) != computed) {
+      std::cerr << nbScanLines << " scanlines computed, the render should" << (computed ? "" : " not")
+                << " have been computed again" << std::endl;
+      return false;
+    }
+
+    // Same render as the one of new faces
+    vpMbHiddenFaces<vpMbtPolygon> ref;
+    for (unsigned int i = 0; i < faces.size(); i++)
+      ref.addPolygon(faces[i]);
+    ref.getMbScanLineRenderer().setMaskBorder(faces.getMbScanLineRenderer().getMaskBorder());
+    ref.getMbScanLineRenderer().setDepthTreshold(faces.getMbScanLineRenderer().getDepthTreshold());
+    ref.computeClippedPolygons(cMo, cam);
+    ref.computeScanLineRender(cam, w, h);
+    const vpImage<int> &ids = faces.getMbScanLineRenderer().getPrimitiveIDs();
+    const vpImage<int> &ref_ids = ref.getMbScanLineRenderer().getPrimitiveIDs();
+    const vpImage<unsigned char> &mask = faces.getMbScanLineRenderer().getMask();
+    const vpImage<unsigned char> &ref_mask = ref.getMbScanLineRenderer().getMask();
+    if (ids.getWidth() != ref_ids.getWidth() || ids.getHeight() != ref_ids.getHeight()) {
+      std::cerr << "The render has a wrong size" << std::endl;
+      return false;
+    }
+    for (unsigned int i = 0; i < ids.getHeight(); i++) {
+      for (unsigned int j = 0; j < ids.getWidth(); j++) {
+        if (ids[i][j] != ref_ids[i][j] || mask[i][j] != ref_mask[i][j]) {
+          std::cerr << "The render differs from the one of new faces at (" << i << ", " << j << ")" << std::endl;
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  //! Test the visibility of the faces seen from \e cMo and check the number of faces tested
+  bool testVisibility(vpMbHiddenFaces<vpMbtPolygon> &faces, const vpImage<unsigned char> &I,
+                      const vpCameraParameters &cam, const vpHomogeneousMatrix &cMo, const double angle,
+                      const unsigned int nbRecomputed)
+  {
+    bool changed;
+    const unsigned int nbVisible = faces.setVisible(I, cam, cMo, angle, angle, changed);
+    if (faces.getNbFacesRecomputed() != nbRecomputed) {
+      std::cerr << "The visibility of " << faces.getNbFacesRecomputed() << " faces has been tested instead of "
+                << nbRecomputed << std::endl;
+      return false;
+    }
+    if (nbVisible == 0) {
+      std::cerr << "No visible face" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  //! Check when the scanline render and the visibility of the faces are computed again
+  bool testCaches()
+  {
+    vpMbHiddenFaces<vpMbtPolygon> faces;
+    createModel(faces, 3, 3, 2);
+    for (unsigned int i = 0; i < faces.size(); i++)
+      faces[i]->setClipping(vpPolygon3D::NO_CLIPPING);
+    const unsigned int n = faces.size();
+
+    vpCameraParameters cam(600, 600, 320, 240);
+    const vpHomogeneousMatrix cMo(-0.15, -0.1, 0.8, vpMath::rad(10), vpMath::rad(-20), 0);
+    const vpHomogeneousMatrix cMo_near = vpHomogeneousMatrix(0.001, 0, 0, 0, 0, 0) * cMo;
+    const vpHomogeneousMatrix cMo_far = vpHomogeneousMatrix(0.02, 0, 0, 0, 0, 0) * cMo;
+
+    // The render is skipped only with the same pose, camera and size
+    if (! testRender(faces, cMo, cam, 640, 480, true) || ! testRender(faces, cMo, cam, 640, 480, false)
+        || ! testRender(faces, cMo_near, cam, 640, 480, true) || ! testRender(faces, cMo_near, cam, 640, 480, false)
+        || ! testRender(faces, cMo_near, cam, 320, 240, true)
+        || ! testRender(faces, cMo_near, vpCameraParameters(500, 500, 320, 240), 320, 240, true)) {
+      std::cerr << "Wrong scanline render" << std::endl;
+      return false;
+    }
+    faces.getMbScanLineRenderer().setMaskBorder(faces.getMbScanLineRenderer().getMaskBorder() + 1);
+    if (! testRender(faces, cMo_near, vpCameraParameters(500, 500, 320, 240), 320, 240, true)) {
+      std::cerr << "The scanline render is not computed again after a change of the mask border" << std::endl;
+      return false;
+    }
+
+    // Without the cache, the visibility is always tested
+    vpImage<unsigned char> I(480, 640);
+    const double angle = vpMath::rad(80);
+    if (! testVisibility(faces, I, cam, cMo, angle, n) || ! testVisibility(faces, I, cam, cMo, angle, n)) {
+      std::cerr << "Wrong visibility without cache" << std::endl;
+      return false;
+    }
+
+    // With the cache, the visibility is tested again only if the camera moved too much since the last test
+    // or if the parameters changed
+    faces.setVisibilityCacheThresholds(0.005, vpMath::rad(1));
+    if (! testVisibility(faces, I, cam, cMo, angle, n) || ! testVisibility(faces, I, cam, cMo, angle, 0)
+        || ! testVisibility(faces, I, cam, cMo_near, angle, 0) || ! testVisibility(faces, I, cam, cMo_far, angle, n)
+        || ! testVisibility(faces, I, cam, cMo_far, angle, 0)
+        || ! testVisibility(faces, I, cam, cMo_far, vpMath::rad(70), n)
+        || ! testVisibility(faces, I, vpCameraParameters(500, 500, 320, 240), cMo_far, vpMath::rad(70), n)) {
+      std::cerr << "Wrong visibility with cache" << std::endl;
+      return false;
+    }
+
+    // A face added invalidates the cache
+    vpMbtPolygon polygon(*faces[0]);
+    polygon.setIndex((int)n);
+    faces.addPolygon(&polygon);
+    if (! testVisibility(faces, I, vpCameraParameters(500, 500, 320, 240), cMo_far, vpMath::rad(70), n + 1)) {
+      std::cerr << "Wrong visibility after a face is added" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  bool testClipping(vpMbHiddenFaces<vpMbtPolygon> &faces, const vpHomogeneousMatrix &cMo,
+                    const vpCameraParameters &cam, unsigned int &nbInside, unsigned int &nbOutside)
+  {
+    faces.computeClippedPolygons(cMo, cam);
+    for (unsigned int i = 0; i < faces.size(); i++) {
+      // The face clipped alone
+      vpMbtPolygon ref(*faces[i]);
+      ref.changeFrame(cMo);
+      ref.computePolygonClipped(cam);
+
+      const std::vector<std::pair<vpPoint, unsigned int> > &clipped = faces[i]->polyClipped;
+      if (clipped.size() != ref.polyClipped.size()) {
+        std::cerr << "Face " << i << " has " << clipped.size() << " clipped points instead of "
+                  << ref.polyClipped.size() << std::endl;
+        return false;
+      }
+      for (size_t k = 0; k < clipped.size(); k++) {
+        if (! samePoint(clipped[k].first, ref.polyClipped[k].first) || clipped[k].second != ref.polyClipped[k].second) {
+          std::cerr << "Clipped point " << k << " of face " << i << " differs from the reference" << std::endl;
+          return false;
+        }
+      }
+      // The points of all the faces, culled or not, are in the camera frame and projected
+      for (unsigned int j = 0; j < ref.nbpt; j++) {
+        vpPoint P = ref.p[j];
+        P.changeFrame(cMo);
+        P.projection();
+        if (! samePoint(faces[i]->p[j], P)) {
+          std::cerr << "Point " << j << " of face " << i << " is not in the camera frame or not projected"
+                    << std::endl;
+          return false;
+        }
+      }
+
+      const int side = clippingSide(ref, cam);
+      if (side < 0) {
+        nbOutside++;
+        if (! clipped.empty()) {
+          std::cerr << "Face " << i << " is out of the field of view but is not clipped" << std::endl;
+          return false;
+        }
+      }
+      else if (side > 0) {
+        nbInside++;
+        bool same = (clipped.size() == ref.nbpt);
+        for (unsigned int j = 0; same && j < ref.nbpt; j++)
+          same = samePoint(clipped[j].first, ref.p[j]) && clipped[j].second == vpPolygon3D::NO_CLIPPING;
+        if (! same) {
+          std::cerr << "Face " << i << " is in the field of view but is clipped" << std::endl;
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    if (! testCaches())
+      return EXIT_FAILURE;
+
+    vpMbHiddenFaces<vpMbtPolygon> faces;
+    createModel(faces, 24, 24, 15);
+
+    vpCameraParameters cam(600, 600, 320, 240);
+    cam.computeFov(640, 480);
+
+    // Model partially seen, seen from inside, and out of the field of view
+    const vpHomogeneousMatrix poses[] = { vpHomogeneousMatrix(-1.0, -1.0, 0.4, vpMath::rad(10), vpMath::rad(-20), 0),
+                                          vpHomogeneousMatrix(-1.2, -1.2, -0.7, 0, 0, 0),
+                                          vpHomogeneousMatrix(-2.2, -1.0, 0.4, vpMath::rad(10), vpMath::rad(-20), 0),
+                                          vpHomogeneousMatrix(-10.0, -1.0, 0.4, 0, 0, 0) };
+    unsigned int nbInside = 0, nbOutside = 0;
+    for (unsigned int i = 0; i < 4; i++) {
+      if (! testClipping(faces, poses[i], cam, nbInside, nbOutside))
+        return EXIT_FAILURE;
+    }
+    if (nbInside == 0 || nbOutside == 0) {
+      std::cerr << "The faces are not seen from both sides of the clipping planes" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (faces.getNbFacesCulled() != faces.size()) {
+      std::cerr << "Only " << faces.getNbFacesCulled() << " faces culled on " << faces.size()
+                << " with the model out of the field of view" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Without a common clipping, each face is clipped alone
+    faces[0]->setClipping(vpPolygon3D::NEAR_CLIPPING);
+    if (! testClipping(faces, poses[0], cam, nbInside, nbOutside))
+      return EXIT_FAILURE;
+    faces[0]->setClipping(vpPolygon3D::NEAR_CLIPPING | vpPolygon3D::FAR_CLIPPING | vpPolygon3D::FOV_CLIPPING);
+
+    // Benchmark
+    const unsigned int nb_iter = 10;
+    vpHomogeneousMatrix cMo = poses[0];
+    double t_linear = 0, t_clip = 0;
+    unsigned int nbCulled = 0;
+    for (unsigned int iter = 0; iter < nb_iter; iter++) {
+      cMo = vpHomogeneousMatrix(0.002, 0.001, 0, 0, vpMath::rad(0.2), 0) * cMo;
+
+      double t = vpTime::measureTimeMs();
+      for (unsigned int i = 0; i < faces.size(); i++) {
+        faces[i]->changeFrame(cMo);
+        faces[i]->computePolygonClipped(cam);
+      }
+      t_linear += vpTime::measureTimeMs() - t;
+
+      t = vpTime::measureTimeMs();
+      faces.computeClippedPolygons(cMo, cam);
+      t_clip += vpTime::measureTimeMs() - t;
+      nbCulled += faces.getNbFacesCulled();
+    }
+    std::cout << "Clipping of " << faces.size() << " faces (" << nbCulled / nb_iter << " culled), per frame:"
+              << std::endl;
+    std::cout << "  each face clipped alone:    " << t_linear / nb_iter << " ms" << std::endl;
+    std::cout << "  computeClippedPolygons():   " << t_clip / nb_iter << " ms" << std::endl;
+
+    std::cout << "testPerformanceMbtHiddenFaces is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
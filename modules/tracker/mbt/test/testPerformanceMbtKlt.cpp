@@ -0,0 +1,271 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the KLT model-based trackers.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceMbtKlt.cpp
+
+  \brief Check that vpMbKltTracker and vpMbEdgeKltTracker, which track the
+  keypoints with vpKltTracker, follow a textured box along a synthetic motion,
+  with and without the scanline visibility test, and measure the tracking time.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/mbt/vpMbEdgeKltTracker.h>
+#include <visp3/mbt/vpMbKltTracker.h>
+
+#if defined(VISP_HAVE_MODULE_KLT)
+
+namespace {
+  //! Corners and faces of a 16.5 x 6.8 x 8 cm box
+  const double corners[8][3] = { {0, 0, 0}, {0, 0, -0.08}, {0.165, 0, -0.08}, {0.165, 0, 0},
+                                 {0.165, 0.068, 0}, {0.165, 0.068, -0.08}, {0, 0.068, -0.08}, {0, 0.068, 0} };
+  const int faces[6][4] = { {0, 1, 2, 3}, {1, 6, 5, 2}, {4, 5, 6, 7}, {0, 3, 4, 7}, {5, 4, 3, 2}, {0, 7, 6, 1} };
+  const double boxMin[3] = { 0, 0, -0.08 };
+  const double boxMax[3] = { 0.165, 0.068, 0 };
+
+  //! Temporary directory of the user
+  std::string tempDirectory()
+  {
+#if defined(_WIN32)
+    std::string directory = "C:/temp/" + vpIoTools::getUserName();
+#else
+    std::string directory = "/tmp/" + vpIoTools::getUserName();
+#endif
+    if (! vpIoTools::checkDirectory(directory))
+      vpIoTools::makeDirectory(directory);
+    return directory;
+  }
+
+  //! Save the box as a CAO model
+  void saveModel(const std::string &filename)
+  {
+    std::ofstream file(filename.c_str());
+    file << "V1\n8\n";
+    for (unsigned int i = 0; i < 8; i++)
+      file << corners[i][0] << " " << corners[i][1] << " " << corners[i][2] << "\n";
+    file << "0\n0\n6\n";
+    for (unsigned int i = 0; i < 6; i++)
+      file << "4 " << faces[i][0] << " " << faces[i][1] << " " << faces[i][2] << " " << faces[i][3] << "\n";
+    file << "0\n0\n";
+  }
+
+  //! Pseudo-random value in [0, 1] of a node of a 3D lattice
+  double latticeValue(const int i, const int j, const int k)
+  {
+    unsigned int h = (unsigned int)i * 73856093u ^ (unsigned int)j * 19349663u ^ (unsigned int)k * 83492791u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return (h & 0xffff) / 65535.;
+  }
+
+  //! Trilinear interpolation of the lattice values, with a lattice step of \e step meters
+  double noise(const double X, const double Y, const double Z, const double step)
+  {
+    const double x = X / step, y = Y / step, z = Z / step;
+    const int i = (int)floor(x), j = (int)floor(y), k = (int)floor(z);
+    const double a = x - i, b = y - j, c = z - k;
+    double v = 0;
+    for (int di = 0; di < 2; di++)
+      for (int dj = 0; dj < 2; dj++)
+        for (int dk = 0; dk < 2; dk++)
+          v += (di ? a : 1 - a) * (dj ? b : 1 - b) * (dk ? c : 1 - c) * latticeValue(i + di, j + dj, k + dk);
+    return v;
+  }
+
+  //! Random texture painted on the box, a function of the 3D point so that it sticks to the faces
+  double texture(const double X, const double Y, const double Z)
+  {
+    return 120. * (noise(X, Y, Z, 0.004) - 0.5) + 60. * (noise(X, Y, Z, 0.012) - 0.5);
+  }
+
+  //! Render the textured box with a different mean gray level on each face, by ray casting
+  void render(vpImage<unsigned char> &I, const vpHomogeneousMatrix &cMo, const vpCameraParameters &cam)
+  {
+    const vpHomogeneousMatrix oMc = cMo.inverse();
+    const double origin[3] = { oMc[0][3], oMc[1][3], oMc[2][3] };
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        const double x = (j - cam.get_u0()) / cam.get_px(), y = (i - cam.get_v0()) / cam.get_py();
+        double dir[3];
+        for (unsigned int d = 0; d < 3; d++)
+          dir[d] = oMc[d][0] * x + oMc[d][1] * y + oMc[d][2];
+
+        // Slab intersection of the ray with the box
+        double t_near = 0, t_far = 1e9;
+        unsigned int axis = 0;
+        bool hit = true;
+        for (unsigned int d = 0; d < 3 && hit; d++) {
+          if (std::fabs(dir[d]) < 1e-12) {
+            hit = (origin[d] >= boxMin[d] && origin[d] <= boxMax[d]);
+            continue;
+          }
+          double t0 = (boxMin[d] - origin[d]) / dir[d], t1 = (boxMax[d] - origin[d]) / dir[d];
+          if (t0 > t1)
+            std::swap(t0, t1);
+          if (t0 > t_near) {
+            t_near = t0;
+            axis = d;
+          }
+          t_far = std::min(t_far, t1);
+          hit = (t_near <= t_far);
+        }
+
+        if (hit) {
+          const double X = origin[0] + t_near * dir[0], Y = origin[1] + t_near * dir[1], Z = origin[2] + t_near * dir[2];
+          const double val = 80. + 35. * axis + texture(X, Y, Z);
+          I[i][j] = (unsigned char) vpMath::round(std::max(0., std::min(255., val)));
+        }
+        else
+          I[i][j] = (unsigned char) (40 + ((i * 7 + j * 13) % 11));
+      }
+    }
+  }
+
+  //! Translation and rotation errors between two poses
+  void poseError(const vpHomogeneousMatrix &cMo, const vpHomogeneousMatrix &cMo_est, double &t_err, double &r_err)
+  {
+    vpHomogeneousMatrix cdMc = cMo * cMo_est.inverse();
+    t_err = cdMc.getTranslationVector().euclideanNorm();
+    r_err = vpMath::deg(vpThetaUVector(cdMc.getRotationMatrix()).getTheta());
+  }
+
+  //! Track the box along a synthetic motion, return false if the pose drifts
+  bool track(vpMbTracker &tracker, const std::string &name, const std::string &model, const bool scanline)
+  {
+    vpCameraParameters cam(839, 839, 325, 243);
+    vpImage<unsigned char> I(480, 640);
+    vpHomogeneousMatrix cMo(-0.08, -0.03, 0.45, vpMath::rad(30), vpMath::rad(-25), vpMath::rad(10));
+    render(I, cMo, cam);
+
+    tracker.setCameraParameters(cam);
+    tracker.setAngleAppear(vpMath::rad(70));
+    tracker.setAngleDisappear(vpMath::rad(80));
+    tracker.setNearClippingDistance(0.1);
+    tracker.setFarClippingDistance(100.0);
+    tracker.setClipping(tracker.getClipping() | vpMbtPolygon::FOV_CLIPPING);
+    tracker.setScanLineVisibilityTest(scanline);
+    // vpMbtDistanceLine::buildFrom() uses rand()
+    srand(0);
+    tracker.loadModel(model);
+    tracker.initFromPose(I, cMo);
+
+    const unsigned int nbFrames = 30;
+    double time = 0, t_err_max = 0, r_err_max = 0;
+    for (unsigned int iter = 0; iter < nbFrames; iter++) {
+      vpHomogeneousMatrix d(0.002 * sin(iter * 0.3), 0.0015, 0.001 * cos(iter * 0.2), vpMath::rad(0.8),
+                            vpMath::rad(0.6 * sin(iter * 0.1)), vpMath::rad(0.5));
+      cMo = cMo * d;
+      render(I, cMo, cam);
+      double t = vpTime::measureTimeMs();
+      tracker.track(I);
+      time += vpTime::measureTimeMs() - t;
+
+      vpHomogeneousMatrix cMo_est;
+      tracker.getPose(cMo_est);
+      double t_err, r_err;
+      poseError(cMo, cMo_est, t_err, r_err);
+      t_err_max = std::max(t_err_max, t_err);
+      r_err_max = std::max(r_err_max, r_err);
+    }
+
+    std::cout << name << (scanline ? " with" : " without") << " scanline: " << time / nbFrames
+              << " ms per frame, max error " << t_err_max * 1000. << " mm, " << r_err_max << " deg" << std::endl;
+    if (t_err_max > 0.005 || r_err_max > 1.) {
+      std::cerr << name << " drifted away from the box" << std::endl;
+      return false;
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    const std::string model = tempDirectory() + "/testPerformanceMbtKlt.cao";
+    saveModel(model);
+
+    for (int scanline = 0; scanline < 2; scanline++) {
+      vpMbKltTracker klt;
+      klt.setMaskBorder(5);
+      if (! track(klt, "vpMbKltTracker", model, scanline != 0))
+        return EXIT_FAILURE;
+      // The background is sharper than the box: the detection threshold must only depend on the faces
+      if (klt.getNbKltPoints() < 300) {
+        std::cerr << "vpMbKltTracker only tracks " << klt.getNbKltPoints() << " points" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if ((int)klt.getKltImagePoints().size() != klt.getKltTracker().getNbFeatures()) {
+        std::cerr << "vpMbKltTracker does not expose the tracked points" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      vpMbEdgeKltTracker hybrid;
+      vpMe me;
+      me.setMaskSize(5);
+      me.setMaskNumber(180);
+      me.setRange(8);
+      me.setThreshold(10000);
+      me.setMu1(0.5);
+      me.setMu2(0.5);
+      me.setSampleStep(4);
+      hybrid.setMovingEdge(me);
+      if (! track(hybrid, "vpMbEdgeKltTracker", model, scanline != 0))
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "testPerformanceMbtKlt is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "This test requires the klt module." << std::endl;
+  return EXIT_SUCCESS;
+}
+#endif
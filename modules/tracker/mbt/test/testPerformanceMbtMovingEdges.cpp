@@ -0,0 +1,303 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the parallel tracking of the moving edges of vpMbEdgeTracker.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceMbtMovingEdges.cpp
+
+  \brief Check that vpMbEdgeTracker gives the same poses whatever the number
+  of threads used to track the moving edges, with and without the scanline
+  visibility test, that the scanline visibility queries are repeatable, and
+  measure the tracking time.
+*/
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpPolygon.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/mbt/vpMbEdgeTracker.h>
+
+namespace {
+  //! Corners and faces of a 16.5 x 6.8 x 8 cm box
+  const double corners[8][3] = { {0, 0, 0}, {0, 0, -0.08}, {0.165, 0, -0.08}, {0.165, 0, 0},
+                                 {0.165, 0.068, 0}, {0.165, 0.068, -0.08}, {0, 0.068, -0.08}, {0, 0.068, 0} };
+  const int faces[6][4] = { {0, 1, 2, 3}, {1, 6, 5, 2}, {4, 5, 6, 7}, {0, 3, 4, 7}, {5, 4, 3, 2}, {0, 7, 6, 1} };
+
+  //! Temporary directory of the user
+  std::string tempDirectory()
+  {
+#if defined(_WIN32)
+    std::string directory = "C:/temp/" + vpIoTools::getUserName();
+#else
+    std::string directory = "/tmp/" + vpIoTools::getUserName();
+#endif
+    if (! vpIoTools::checkDirectory(directory))
+      vpIoTools::makeDirectory(directory);
+    return directory;
+  }
+
+  //! Save the box as a CAO model
+  void saveModel(const std::string &filename)
+  {
+    std::ofstream file(filename.c_str());
+    file << "V1\n8\n";
+    for (unsigned int i = 0; i < 8; i++)
+      file << corners[i][0] << " " << corners[i][1] << " " << corners[i][2] << "\n";
+    file << "0\n0\n6\n";
+    for (unsigned int i = 0; i < 6; i++)
+      file << "4 " << faces[i][0] << " " << faces[i][1] << " " << faces[i][2] << " " << faces[i][3] << "\n";
+    file << "0\n0\n";
+  }
+
+  //! Render the visible faces of the box with a different gray level each on a textured background
+  void render(vpImage<unsigned char> &I, const vpHomogeneousMatrix &cMo, const vpCameraParameters &cam)
+  {
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++)
+        I[i][j] = (unsigned char) (40 + ((i * 7 + j * 13) % 11));
+    }
+    for (unsigned int f = 0; f < 6; f++) {
+      std::vector<vpImagePoint> ips;
+      double cP[4][3];
+      for (unsigned int k = 0; k < 4; k++) {
+        const double *c = corners[faces[f][k]];
+        vpPoint P(c[0], c[1], c[2]);
+        P.track(cMo);
+        cP[k][0] = P.get_X();
+        cP[k][1] = P.get_Y();
+        cP[k][2] = P.get_Z();
+        vpImagePoint ip;
+        vpMeterPixelConversion::convertPoint(cam, P.get_x(), P.get_y(), ip);
+        ips.push_back(ip);
+      }
+      // Back face culling
+      vpColVector u(3), v(3), o(3);
+      for (unsigned int d = 0; d < 3; d++) {
+        u[d] = cP[1][d] - cP[0][d];
+        v[d] = cP[2][d] - cP[0][d];
+        o[d] = cP[0][d];
+      }
+      if (vpColVector::dotProd(vpColVector::crossProd(u, v), o) >= 0)
+        continue;
+      vpPolygon polygon(ips);
+      vpRect r = polygon.getBoundingBox();
+      for (int i = std::max(0, (int) r.getTop()); i <= std::min((int) I.getHeight() - 1, (int) r.getBottom() + 1); i++) {
+        for (int j = std::max(0, (int) r.getLeft()); j <= std::min((int) I.getWidth() - 1, (int) r.getRight() + 1); j++) {
+          if (polygon.isInside(vpImagePoint(i, j)))
+            I[i][j] = (unsigned char) (90 + 30 * f + ((i + j) % 3));
+        }
+      }
+    }
+  }
+
+  //! Track the box along a synthetic motion, return the estimated poses
+  std::vector<vpHomogeneousMatrix> track(const std::string &model, const unsigned int nbThreads, const bool scanline,
+                                         const unsigned int nbFrames, vpHomogeneousMatrix &cMo_last, double &time)
+  {
+    vpCameraParameters cam(839, 839, 325, 243);
+    vpImage<unsigned char> I(480, 640);
+    vpHomogeneousMatrix cMo(-0.08, -0.03, 0.45, vpMath::rad(30), vpMath::rad(-25), vpMath::rad(10));
+    render(I, cMo, cam);
+
+    vpMbEdgeTracker tracker;
+    vpMe me;
+    me.setMaskSize(5);
+    me.setMaskNumber(180);
+    me.setRange(8);
+    me.setThreshold(10000);
+    me.setMu1(0.5);
+    me.setMu2(0.5);
+    me.setSampleStep(4);
+    tracker.setMovingEdge(me);
+    tracker.setCameraParameters(cam);
+    tracker.setAngleAppear(vpMath::rad(70));
+    tracker.setAngleDisappear(vpMath::rad(80));
+    tracker.setNearClippingDistance(0.1);
+    tracker.setFarClippingDistance(100.0);
+    tracker.setClipping(tracker.getClipping() | vpMbtPolygon::FOV_CLIPPING);
+    tracker.setScanLineVisibilityTest(scanline);
+    tracker.setNbMovingEdgeThreads(nbThreads);
+    // vpMbtDistanceLine::buildFrom() uses rand(), the runs must start with the same seed
+    srand(0);
+    tracker.loadModel(model);
+    tracker.initFromPose(I, cMo);
+
+    std::vector<vpHomogeneousMatrix> poses;
+    time = 0;
+    for (unsigned int iter = 0; iter < nbFrames; iter++) {
+      vpHomogeneousMatrix d(0.002 * sin(iter * 0.3), 0.0015, 0.001 * cos(iter * 0.2), vpMath::rad(0.8),
+                            vpMath::rad(0.6 * sin(iter * 0.1)), vpMath::rad(0.5));
+      cMo = cMo * d;
+      render(I, cMo, cam);
+      double t = vpTime::measureTimeMs();
+      tracker.track(I);
+      time += vpTime::measureTimeMs() - t;
+      vpHomogeneousMatrix cMo_est;
+      tracker.getPose(cMo_est);
+      poses.push_back(cMo_est);
+    }
+    cMo_last = cMo;
+    return poses;
+  }
+
+  bool samePoses(const std::vector<vpHomogeneousMatrix> &a, const std::vector<vpHomogeneousMatrix> &b)
+  {
+    if (a.size() != b.size())
+      return false;
+    for (size_t i = 0; i < a.size(); i++) {
+      for (unsigned int j = 0; j < 16; j++) {
+        if (a[i].data[j] != b[i].data[j])
+          return false;
+      }
+    }
+    return true;
+  }
+
+  bool samePoint(const vpPoint &a, const vpPoint &b)
+  {
+    return a.get_X() == b.get_X() && a.get_Y() == b.get_Y() && a.get_Z() == b.get_Z();
+  }
+
+  //! Query the visible parts of the edges of the box twice, and a line that is not an edge of the box
+  bool testScanLineQueries()
+  {
+    vpCameraParameters cam(839, 839, 325, 243);
+    vpHomogeneousMatrix cMo(-0.08, -0.03, 0.45, vpMath::rad(30), vpMath::rad(-25), vpMath::rad(10));
+    vpMbHiddenFaces<vpMbtPolygon> hiddenFaces;
+    for (unsigned int f = 0; f < 6; f++) {
+      vpMbtPolygon polygon;
+      polygon.setNbPoint(4);
+      polygon.setIndex((int) f);
+      for (unsigned int k = 0; k < 4; k++) {
+        const double *c = corners[faces[f][k]];
+        polygon.addPoint(k, vpPoint(c[0], c[1], c[2]));
+      }
+      hiddenFaces.addPolygon(&polygon);
+    }
+    hiddenFaces.computeClippedPolygons(cMo, cam);
+    hiddenFaces.computeScanLineRender(cam, 640, 480);
+
+    unsigned int nbVisibleEdges = 0;
+    for (unsigned int f = 0; f < hiddenFaces.size(); f++) {
+      const std::vector<std::pair<vpPoint, unsigned int> > &clipped = hiddenFaces[f]->polyClipped;
+      for (size_t k = 0; k < clipped.size(); k++) {
+        const vpPoint &a = clipped[k].first, &b = clipped[(k + 1) % clipped.size()].first;
+        std::vector<std::pair<vpPoint, vpPoint> > lines, lines2;
+        hiddenFaces.computeScanLineQuery(a, b, lines);
+        hiddenFaces.computeScanLineQuery(a, b, lines2);
+        if (lines.size() != lines2.size()) {
+          std::cerr << "Two queries of the same edge give different results" << std::endl;
+          return false;
+        }
+        for (size_t i = 0; i < lines.size(); i++) {
+          if (! samePoint(lines[i].first, lines2[i].first) || ! samePoint(lines[i].second, lines2[i].second)) {
+            std::cerr << "Two queries of the same edge give different results" << std::endl;
+            return false;
+          }
+        }
+        if (! lines.empty())
+          nbVisibleEdges++;
+      }
+    }
+    if (nbVisibleEdges == 0) {
+      std::cerr << "No visible edge" << std::endl;
+      return false;
+    }
+
+    // A line that is not an edge of the rendered polygons has no visible part
+    const vpPoint &a = hiddenFaces[0]->polyClipped[0].first;
+    vpPoint b(a);
+    b.set_X(a.get_X() + 0.01);
+    std::vector<std::pair<vpPoint, vpPoint> > lines;
+    hiddenFaces.computeScanLineQuery(a, b, lines);
+    if (! lines.empty()) {
+      std::cerr << "A line that is not an edge has visible parts" << std::endl;
+      return false;
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    vpThreadPool::getInstance().setNumThreads(4);
+    const std::string model = tempDirectory() + "/testPerformanceMbtMovingEdges.cao";
+    saveModel(model);
+
+    if (! testScanLineQueries())
+      return EXIT_FAILURE;
+
+    const unsigned int nbFrames = 30;
+    for (int scanline = 0; scanline < 2; scanline++) {
+      vpHomogeneousMatrix cMo;
+      double t_1, t_4, t_4bis;
+      std::vector<vpHomogeneousMatrix> poses_1 = track(model, 1, scanline != 0, nbFrames, cMo, t_1);
+      std::vector<vpHomogeneousMatrix> poses_4 = track(model, 4, scanline != 0, nbFrames, cMo, t_4);
+      std::vector<vpHomogeneousMatrix> poses_4bis = track(model, 4, scanline != 0, nbFrames, cMo, t_4bis);
+      if (! samePoses(poses_1, poses_4) || ! samePoses(poses_4, poses_4bis)) {
+        std::cerr << "The poses depend on the number of threads" << (scanline ? " with" : " without")
+                  << " the scanline visibility test" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      vpPoseVector error(poses_1.back() * cMo.inverse());
+      for (unsigned int i = 0; i < 3; i++) {
+        if (std::fabs(error[i]) > 0.005 || std::fabs(error[i + 3]) > vpMath::rad(2)) {
+          std::cerr << "The box is lost" << (scanline ? " with" : " without") << " the scanline visibility test"
+                    << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      std::cout << "Tracking time" << (scanline ? " with" : " without") << " the scanline visibility test: "
+                << t_1 / nbFrames << " ms per frame with 1 thread, " << t_4 / nbFrames << " ms with 4 threads"
+                << std::endl;
+    }
+    remove(model.c_str());
+
+    std::cout << "testPerformanceMbtMovingEdges is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
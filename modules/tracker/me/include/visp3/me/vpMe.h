@@ -49,6 +49,8 @@
 #include <visp3/core/vpMath.h>
 #include <visp3/core/vpImage.h>
 
+#include <vector>
+
 /*!
   \class vpMe
   \ingroup module_me
@@ -108,6 +110,22 @@ public:
     \return the value of mask.
   */
   inline vpMatrix* getMask() const { return mask; }
+  /*!
+    Get a mask as 16 bits integers, equal to getMask()[index]. The rows are
+    stored one after the other, each one being padded with zeros to
+    getIntegerMaskStride() elements so that they can be processed with SIMD
+    instructions.
+
+    \param index : Index of the mask, lower than getMaskNumber().
+  */
+  inline const short *getIntegerMask(const unsigned int index) const {
+    return &mask_int[index * mask_size * mask_int_stride];
+  }
+  /*!
+    Get the number of elements between two rows of the masks returned by
+    getIntegerMask(). It is a multiple of 8 greater or equal to the mask size.
+  */
+  inline unsigned int getIntegerMaskStride() const { return mask_int_stride; }
   /*!
     Return the number of mask  applied to determine the object contour. The number of mask determines the precision of
     the normal of the edge for every sample. If precision is 2deg, then there
@@ -282,6 +300,11 @@ public:
     \param t : new threshold.
   */
   void setThreshold(const double &t) { threshold = t ; }
+
+private:
+  //! The masks as integers, with padded rows, see getIntegerMask()
+  std::vector<short> mask_int;
+  unsigned int mask_int_stride;
   };
 
 
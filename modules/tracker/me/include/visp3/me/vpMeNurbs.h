@@ -119,7 +119,7 @@ int main()
   
   \note In case of an edge which is not smooth, it can be interesting to use the
   canny detection to find the extremities. In this case, use the method
-  setEnableCannyDetection to enable it. Warning : This function requires OpenCV.
+  setEnableCannyDetection to enable it.
 */
 
 class VISP_EXPORT vpMeNurbs : public vpMeTracker
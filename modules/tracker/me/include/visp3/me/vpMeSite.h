@@ -129,6 +129,15 @@ public:
   void track(const vpImage<unsigned char>& im,
 	     const vpMe *me,
 	     const  bool test_contraste=true);
+  void track(const vpImage<unsigned char>& im,
+	     const vpMe *me,
+	     const  bool test_contraste,
+	     const unsigned int range);
+  void track(const vpImage<unsigned char>& im,
+	     const vpMe *me,
+	     const double *conv,
+	     const unsigned int range,
+	     const  bool test_contraste);
   
   /*!
     Set the angle of tangent at site
@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Batched search of moving edges sites.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpMeSiteBatch.h
+  \brief Batched search of moving edges sites.
+*/
+
+#ifndef vpMeSiteBatch_H
+#define vpMeSiteBatch_H
+
+#include <vector>
+
+#include <visp3/core/vpImage.h>
+#include <visp3/me/vpMe.h>
+#include <visp3/me/vpMeSite.h>
+
+/*!
+  \class vpMeSiteBatch
+  \ingroup module_me
+
+  \brief Search of a set of moving edges sites in a single pass.
+
+  vpMeSite::track() searches one site at a time. This class rather copies the
+  position, the normal direction and the mask sign of all the sites to track in
+  contiguous arrays, computes the position of all the query pixels along the
+  normals, then the convolutions of all of them with the integer masks of
+  vpMe, using SSE2 when available. Each site finally selects its most likely
+  query pixel exactly as vpMeSite::track() does, so that the results are the
+  same.
+
+  The arrays are kept from one call to the next one: once the first images
+  have been processed, tracking does not allocate memory. vpMeTracker::track()
+  uses this class, so vpMeLine, vpMeEllipse, vpMeNurbs and the moving edges of
+  the model-based trackers benefit from it.
+
+  \code
+#include <visp3/me/vpMeSiteBatch.h>
+
+void track(const vpImage<unsigned char> &I, const vpMe &me, std::vector<vpMeSite> &sites, vpMeSiteBatch &batch)
+{
+  batch.clear();
+  for (size_t k = 0; k < sites.size(); k++)
+    batch.add(sites[k]);
+  batch.track(I, &me); // Updates the sites
+}
+  \endcode
+*/
+class VISP_EXPORT vpMeSiteBatch
+{
+public:
+  vpMeSiteBatch();
+
+  void add(vpMeSite &site);
+  void clear();
+  //! Return the site of index \e k, in the order of add().
+  inline vpMeSite &getSite(const unsigned int k) const { return *m_sites[k]; }
+  //! Return the number of sites to track.
+  inline unsigned int size() const { return (unsigned int)m_sites.size(); }
+
+  void track(const vpImage<unsigned char> &I, const vpMe *me, const bool test_contraste=true);
+  void track(const vpImage<unsigned char> &I, const vpMe *me, const bool test_contraste, const unsigned int range);
+
+  static int convolution(const vpImage<unsigned char> &I, const vpMe *me, const int i, const int j,
+                         const unsigned int index_mask);
+  static unsigned int getMaskIndex(const double alpha, const vpMe *me);
+  static bool isOutOfImage(const int i, const int j, const int half, const int rows, const int cols);
+
+private:
+  //! Sites updated by track(), not owned
+  std::vector<vpMeSite *> m_sites;
+  std::vector<double> m_ifloat;
+  std::vector<double> m_jfloat;
+  std::vector<double> m_alpha;
+  std::vector<int> m_maskSign;
+  std::vector<unsigned int> m_maskIndex;
+  //! Offset in the image of the top left pixel of the mask of each query pixel, -1 outside the image
+  std::vector<int> m_offsets;
+  //! Convolution of each query pixel
+  std::vector<double> m_convolutions;
+};
+
+#endif
@@ -46,6 +46,7 @@
 
 #include <visp3/core/vpColVector.h>
 #include <visp3/me/vpMeSite.h>
+#include <visp3/me/vpMeSiteBatch.h>
 #include <visp3/me/vpMe.h>
 #include <visp3/core/vpTracker.h>
 
@@ -79,6 +80,10 @@ protected:
 protected:
   vpMeSite::vpMeSiteDisplayType selectDisplay ;
 
+private:
+  //! Sites searched together by initTracking() and track()
+  vpMeSiteBatch m_siteBatch;
+
 public:
   // Constructor/Destructor
   vpMeTracker() ;
@@ -379,6 +379,13 @@ vpMe::initMask()
 
   calcul_masques(angle, mask_size, mask ) ;
 
+  // The masks hold integers in [-100, 100], their rows are padded for SIMD loads of 8 elements
+  mask_int_stride = (mask_size + 7) & ~7u;
+  mask_int.assign(n_mask * mask_size * mask_int_stride, 0);
+  for (unsigned int m = 0; m < n_mask; m++)
+    for (unsigned int a = 0; a < mask_size; a++)
+      for (unsigned int b = 0; b < mask_size; b++)
+        mask_int[(m * mask_size + a) * mask_int_stride + b] = (short)vpMath::round(mask[m][a][b]);
 }
 
 
@@ -403,7 +410,7 @@ vpMe::print( )
 vpMe::vpMe()
   : threshold(1500), mu1(0.5), mu2(0.5), min_samplestep(4), anglestep(1), mask_sign(0),
     range(4), sample_step(10), ntotal_sample(0), points_to_track(500), mask_size(5),
-    n_mask(180), strip(2), mask(NULL)
+    n_mask(180), strip(2), mask(NULL), mask_int(), mask_int_stride(0)
 {
   //ntotal_sample = 0; // not sure that it is used
   //points_to_track = 500; // not sure that it is used
@@ -415,7 +422,7 @@ vpMe::vpMe()
 vpMe::vpMe(const vpMe &me)
   : threshold(1500), mu1(0.5), mu2(0.5), min_samplestep(4), anglestep(1), mask_sign(0),
     range(4), sample_step(10), ntotal_sample(0), points_to_track(500), mask_size(5),
-    n_mask(180), strip(2), mask(NULL)
+    n_mask(180), strip(2), mask(NULL), mask_int(), mask_int_stride(0)
 {
   *this = me;
 }
@@ -56,14 +56,6 @@
 #include <stdlib.h>
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
-#ifdef VISP_HAVE_OPENCV
-#  if (VISP_HAVE_OPENCV_VERSION >= 0x020101) // Require opencv >= 2.1.1
-//#    include <opencv2/imgproc/imgproc.hpp>
-#    include <opencv2/imgproc/imgproc_c.h>
-#  else
-#    include <cv.h>
-#  endif
-#endif
 
 double computeDelta(double deltai, double deltaj);
 void findAngle(const vpImage<unsigned char> &I, const vpImagePoint &iP,
@@ -96,6 +88,20 @@ bool outOfImage( vpImagePoint iP , int half , int rows , int cols)
 	 ||(iP.get_j() < half + 1) || (iP.get_j() > (cols - half - 3) )) ;
 }
 
+//Canny edges of the sub image of I defined by rect. The native canny detector
+//never marks the pixels on the image borders, so it is run on a window one
+//pixel larger on each side to also get the edges on the sub image borders.
+static
+void cannySubImage(const vpImage<unsigned char> &I, const vpRect &rect,
+                   double th1, double th2, vpImage<unsigned char> &Isub)
+{
+  vpImage<unsigned char> Iwin;
+  vpImagePoint topLeft = rect.getTopLeft() - vpImagePoint(1, 1);
+  vpImageTools::crop(I, vpRect(topLeft, rect.getWidth() + 2, rect.getHeight() + 2), Iwin);
+  vpImageFilter::canny(Iwin, Iwin, 3, th1, th2, 3);
+  vpImageTools::crop(Iwin, 1., 1., (unsigned int)rect.getHeight(), (unsigned int)rect.getWidth(), Isub);
+}
+
 //if iP is a edge point, it computes the angle corresponding to the
 //highest convolution result. the angle is between 0 an 179.
 //The result gives the angle in RADIAN + pi/2 (to deal with the moving edeg alpha angle)
@@ -162,9 +168,9 @@ vpImagePoint findFirstBorder(const vpImage<unsigned char>& Isub, const vpImagePo
   double dist = 1e6;
   double dist_1 = 1e6;
   vpImagePoint index(-1,-1);
-  for (unsigned int i = 0; i <= Isub.getHeight(); i++)
+  for (unsigned int i = 0; i < Isub.getHeight(); i++)
   {
-    for (unsigned int j = 0; j <= Isub.getWidth(); j++)
+    for (unsigned int j = 0; j < Isub.getWidth(); j++)
     {
       if(i == 0 || i == Isub.getHeight()-1 || j == 0 || j == Isub.getWidth()-1)
       {
@@ -536,20 +542,19 @@ vpMeNurbs::seekExtremities(const vpImage<unsigned char> &I)
   The any vpMesite  are initialize at this points.
   
   This method is practicle when the edge is not smooth.
-  
-  \note To use the canny detection, OpenCV has to be installed.
+
+  The sites inside the window around an extremity are replaced by the
+  points of the contour found there. If no site is left outside the
+  window, the method returns without adding any point.
 
   \param I : Image in which the edge appears.
 */
-#if (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION < 0x030000))
 void
 vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> &I)
-#else
-void
-vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
-#endif
 {
-#if (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION < 0x030000))
+  if (list.empty())
+    return;
+
   vpMeSite pt = list.front();
   vpImagePoint firstPoint(pt.ifloat,pt.jfloat);
   pt = list.back();
@@ -564,8 +569,6 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     
     vpDisplay::displayRectangle(I,rect,vpColor::green);
     
-    vpImageTools::crop(I,rect,Isub);
-    
     vpImagePoint lastPtInSubIm(begin[0]);
     double u = 0.0;
     double step =0.0001;
@@ -580,17 +583,7 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     if( u > 0)
       lastPtInSubIm = nurbs.computeCurvePoint(u);
     
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-    vpImageFilter::canny(Isub, Isub, 3, cannyTh1, 3);
-#else
-    IplImage* Ip = NULL;
-    vpImageConvert::convert(Isub, Ip);
-    
-    IplImage* dst = cvCreateImage( cvSize((int)Isub.getWidth(), (int)Isub.getHeight()), 8, 1 );
-    cvCanny( Ip, dst, cannyTh1, cannyTh2, 3 );
-    
-    vpImageConvert::convert(dst, Isub);
-#endif
+    cannySubImage(I, rect, cannyTh1, cannyTh2, Isub);
     
     vpImagePoint firstBorder(-1,-1);
     
@@ -631,15 +624,21 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     
     if (findCenterPoint(&ip_edges_list))
     {
-      for(std::list<vpMeSite>::iterator it=list.begin(); it!=list.end(); /*++it*/){
-        vpMeSite s = *it;
-        vpImagePoint iP(s.ifloat,s.jfloat);
+      while (!list.empty()) {
+        vpImagePoint iP(list.front().ifloat, list.front().jfloat);
         if (inRectangle(iP,rect))
-          it = list.erase(it) ;
+          list.pop_front();
         else
           break;
       }
+      if (list.empty()) {
+        delete[] begin;
+        beginPtFound = 0;
+        return;
+      }
 
+      // The points are added in front of the first site left, in the same
+      // order as they are added after the last site at the end of the edge
       std::list<vpMeSite>::iterator itList=list.begin();
       double convlt;
       double delta = 0;
@@ -664,9 +663,7 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
             findAngle(I, iPtemp, me, delta, convlt);
             pix.init(iPtemp.get_i(), iPtemp.get_j(), delta, convlt);
             pix.setDisplay(selectDisplay);
-            --itList;
-            list.insert(itList, pix);
-            ++itList;
+            list.push_front(pix);
             addedPt.push_front(pix);
             nbr++;
           }
@@ -701,8 +698,6 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     
     vpDisplay::displayRectangle(I,rect,vpColor::green);
     
-    vpImageTools::crop(I,rect,Isub);
-    
     vpImagePoint lastPtInSubIm(end[0]);
     double u = 1.0;
     double step =0.0001;
@@ -717,17 +712,7 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     if( u < 1.0)
       lastPtInSubIm = nurbs.computeCurvePoint(u);
     
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
-    vpImageFilter::canny(Isub, Isub, 3, cannyTh1, 3);
-#else
-    IplImage* Ip = NULL;
-    vpImageConvert::convert(Isub, Ip);
-
-    IplImage* dst = cvCreateImage( cvSize((int)Isub.getWidth(), (int)Isub.getHeight()), 8, 1 );
-    cvCanny( Ip, dst, cannyTh1, cannyTh2, 3 );
-
-    vpImageConvert::convert(dst, Isub);
-#endif
+    cannySubImage(I, rect, cannyTh1, cannyTh2, Isub);
     
     vpImagePoint firstBorder(-1,-1);
     
@@ -770,20 +755,19 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     
     if (findCenterPoint(&ip_edges_list))
     {
-//      list.end();
       vpMeSite s;
-      while(true)//{//!list.outside())
-      {
-        s = list.back();//list.value() ;
-        vpImagePoint iP(s.ifloat,s.jfloat);
+      while (!list.empty()) {
+        vpImagePoint iP(list.back().ifloat, list.back().jfloat);
         if (inRectangle(iP,rect))
-        {
-          list.erase(list.end()) ;
-//          list.end();
-        }
+          list.pop_back();
         else
           break;
       }
+      if (list.empty()) {
+        delete[] end;
+        endPtFound = 0;
+        return;
+      }
 
       std::list<vpMeSite>::iterator itList = list.end();
       --itList; // Move on the last element
@@ -834,9 +818,6 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     /* if (end != NULL) */ delete[] end;
     endPtFound = 0;
   }
-#else
-  vpTRACE("To use the canny detection, OpenCV has to be installed.");
-#endif
 }
 
 
@@ -1047,8 +1028,11 @@ vpMeNurbs::track(const vpImage<unsigned char> &I)
   localReSample(I);
 
   seekExtremities(I);
-  if(enableCannyDetection)
+  if(enableCannyDetection) {
     seekExtremitiesCanny(I);
+    if (list.size() <= 1)
+      throw(vpTrackingException(vpTrackingException::notEnoughPointError, "Not enough valid me to track"));
+  }
 
 //   nurbs.globalCurveInterp(list);
   nurbs.globalCurveApprox(list,nbControlPoints);
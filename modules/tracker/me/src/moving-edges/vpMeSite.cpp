@@ -45,25 +45,13 @@
 
 
 #include <visp3/me/vpMeSite.h>
+#include <visp3/me/vpMeSiteBatch.h>
 #include <visp3/me/vpMe.h>
 #include <visp3/core/vpTrackingException.h>
 #include <stdlib.h>
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
-#include <visp3/me/vpMeSite.h>
-
-
-#ifndef DOXYGEN_SHOULD_SKIP_THIS
-static
-bool horsImage(int i , int j, int half, int rows, int cols)
-{
-  //return((i < half + 1) || ( i > (rows - half - 3) )||(j < half + 1) || (j > (cols - half - 3) )) ;
-  int half_1 = half + 1;
-  int half_3 = half + 3;
-  //return((i < half + 1) || ( i > (rows - half - 3) )||(j < half + 1) || (j > (cols - half - 3) )) ;
-  return( (0 < (half_1 - i) ) || ( (i - rows + half_3) > 0 ) || ( 0 < (half_1 -j) ) || ( (j - cols + half_3)  > 0 ) ) ;
-}
-#endif
+#include <vector>
 
 void
 vpMeSite::init()
@@ -306,221 +294,128 @@ vpMeSite::getSign(const vpImage<unsigned char> &I, const int range)
 double
 vpMeSite::convolution(const vpImage<unsigned char>&I, const  vpMe *me)
 {
-  int half;
   int height_ = static_cast<int>(I.getHeight());
   int width_  = static_cast<int>(I.getWidth());
+  int half = (static_cast<int>(me->getMaskSize()) - 1) >> 1 ;
 
-  double conv = 0.0 ;
-  unsigned int msize = me->getMaskSize();
-  half = (static_cast<int>(msize) - 1) >> 1 ;
-
-  if(horsImage( i , j , half + me->getStrip() , height_, width_))
+  if(vpMeSiteBatch::isOutOfImage( i , j , half + me->getStrip() , height_, width_))
   {
-    conv = 0.0 ;
     i = 0 ; j = 0 ;
+    return 0.0 ;
   }
-  else
-  {
-    // Calculate tangent angle from normal
-    double theta  = alpha+M_PI/2;
-    // Move tangent angle to within 0->M_PI for a positive
-    // mask index
-    while (theta<0) theta += M_PI;
-    while (theta>M_PI) theta -= M_PI;
 
-    // Convert radians to degrees
-    int thetadeg = vpMath::round(theta * 180 / M_PI) ;
+  // The integer masks give the same sums as the double ones
+  unsigned int index_mask = vpMeSiteBatch::getMaskIndex(alpha, me);
+  return mask_sign * vpMeSiteBatch::convolution(I, me, i, j, index_mask);
+}
 
-    if(abs(thetadeg) == 180 )
-    {
-      thetadeg= 0 ;
-    }
 
-    unsigned int index_mask = (unsigned int)(thetadeg/(double)me->getAngleStep());
+/*!
 
-    unsigned int i_ = static_cast<unsigned int>(i);
-    unsigned int j_ = static_cast<unsigned int>(j);
-    unsigned int half_ = static_cast<unsigned int>(half);
+  Specific function for ME.
 
-    unsigned int ihalf = i_-half_ ;
-    unsigned int jhalf = j_-half_ ;
+  \warning To display the moving edges graphics a call to vpDisplay::flush()
+  is needed.
 
-    for(unsigned int a = 0 ; a < msize ; a++ )
-    {
-      unsigned int ihalfa = ihalf+a ;
-      for(unsigned int b = 0 ; b < msize ; b++ )
-      {
-        conv += mask_sign* me->getMask()[index_mask][a][b] *
-            //	  I(i-half+a,j-half+b) ;
-            I(ihalfa,jhalf+b) ;
-      }
-    }
+*/
+void
+vpMeSite::track(const vpImage<unsigned char>& I,
+                const vpMe *me,
+                const bool test_contraste)
+{
+  track(I, me, test_contraste, me->getRange()) ;
+}
+
+/*!
+
+  Same as track(const vpImage<unsigned char>&, const vpMe *, const bool), but
+  the correspondent of the site is sought within +/- \e range pixels instead of
+  vpMe::getRange(). The moving edges parameters are not modified, so that they
+  can be shared by sites tracked in several threads.
+
+*/
+void
+vpMeSite::track(const vpImage<unsigned char>& I,
+                const vpMe *me,
+                const bool test_contraste,
+                const unsigned int range_)
+{
+  // range = +/- range of pixels within which the correspondent
+  // of the current pixel will be sought
+  int range = (int)range_ ;
+  unsigned int nb_queries = 2 * (unsigned int)range + 1 ;
+
+  // Convolutions of the query sites, on the stack for the usual ranges
+  double conv_buffer[64] ;
+  std::vector<double> conv_vector ;
+  double *conv = conv_buffer ;
+  if (nb_queries > 64) {
+    conv_vector.resize(nb_queries) ;
+    conv = &conv_vector[0] ;
+  }
+
+  int height_ = static_cast<int>(I.getHeight());
+  int width_  = static_cast<int>(I.getWidth());
+  int half = (static_cast<int>(me->getMaskSize()) - 1) >> 1 ;
+  unsigned int index_mask = vpMeSiteBatch::getMaskIndex(alpha, me);
 
+  double salpha = sin(alpha);
+  double calpha = cos(alpha);
+  for(int k = -range ; k <= range ; k++)
+  {
+    int ik = (int)(ifloat+k*salpha);
+    int jk = (int)(jfloat+k*calpha);
+    if(vpMeSiteBatch::isOutOfImage(ik, jk, half + me->getStrip(), height_, width_))
+      conv[k + range] = 0.0 ;
+    else
+      conv[k + range] = mask_sign * vpMeSiteBatch::convolution(I, me, ik, jk, index_mask) ;
   }
 
-  return(conv) ;
+  track(I, me, conv, range_, test_contraste) ;
 }
 
-
 /*!
 
-  Specific function for ME.
+  Select the most likely of the 2*range+1 query sites along the normal to the
+  contour, given their convolutions. The query sites are the ones of
+  getQueryList(). vpMeSiteBatch computes the convolutions of several sites at
+  once before calling this function.
 
-  \warning To display the moving edges graphics a call to vpDisplay::flush()
-  is needed.
+  \param I : Image, used to check the borders and to display the query sites.
+  \param me : Moving edges parameters.
+  \param conv : Convolutions of the query sites, from -range to range.
+  \param range_ : The query sites are within +/- \e range_ pixels of the site.
+  \param test_contraste : If true, the convolution of the selected query site
+  must be close to the one of the site in the previous image.
 
 */
 void
 vpMeSite::track(const vpImage<unsigned char>& I,
                 const vpMe *me,
+                const double *conv,
+                const unsigned int range_,
                 const bool test_contraste)
 {
-  //   vpMeSite  *list_query_pixels ;
-  //   int  max_rank =0 ;
-  //   int max_rank1=0 ;
-  //   int max_rank2 = 0;
-  //   double  convolution = 0 ;
-  //   double  max_convolution = 0 ;
-  //   double max = 0 ;
-  //   double contraste = 0;
-  //   //  vpDisplay::display(I) ;
-  //   //  vpERROR_TRACE("getclcik %d",me->getRange()) ;
-  //   //  vpDisplay::getClick(I) ;
-  //
-  //   // range = +/- range of pixels within which the correspondent
-  //   // of the current pixel will be sought
-  //   int range  = me->getRange() ;
-  //
-  //   //  std::cout << i << "  " << j<<"  " << range << "  " << suppress  << std::endl ;
-  //   list_query_pixels = getQueryList(I, range) ;
-  //
-  //   double  contraste_max = 1 + me->getMu2();
-  //   double  contraste_min = 1 - me->getMu1();
-  //
-  //   // array in which likelihood ratios will be stored
-  //   double  *likelihood= new double[ 2 * range + 1 ] ;
-  //
-  //   int ii_1 = i ;
-  //   int jj_1 = j ;
-  //   i_1 = i ;
-  //   j_1 = j ;
-  //   double threshold;
-  //   threshold = me->getThreshold();
-  //
-  //   //    std::cout <<"---------------------"<<std::endl ;
-  //   for(int n = 0 ; n < 2 * range + 1 ; n++)
-  //     {
-  //
-  //       //   convolution results
-  //       convolution = list_query_pixels[n].convolution(I, me) ;
-  //
-  //       // luminance ratio of reference pixel to potential correspondent pixel
-  //       // the luminance must be similar, hence the ratio value should
-  //       // lay between, for instance, 0.5 and 1.5 (parameter tolerance)
-  //       if( test_contraste )
-  // 	{
-  // 	  // Include this to eliminate temporal calculation
-  // 	  if (convlt==0)
-  // 	    {
-  // 	      std::cout << "vpMeSite::track : Division by zero  convlt = 0" << std::endl ;
-  // 	      delete []list_query_pixels ;
-  // 	      delete []likelihood;
-  // 	      throw(vpTrackingException(vpTrackingException::initializationError,
-  // 					"Division by zero")) ;
-  // 	    }
-  //
-  // // 	  contraste = fabs(convolution / convlt) ;
-  // 	  contraste = convolution / convlt ;
-  // 	  // likelihood ratios
-  // 	  if((contraste > contraste_min) && (contraste < contraste_max))
-  // 	    likelihood[n] = fabs(convolution + convlt ) ;
-  // 	  else
-  // 	    likelihood[n] = 0 ;
-  // 	}
-  //       else
-  // 	likelihood[n] = fabs(2*convolution) ;
-  //
-  //
-  //       // establishment of the maximal likelihood ratios's  rank
-  //       // in the array, the value of the likelihood ratio can now be
-  //     // referenced by its rank in the array
-  //     if (likelihood[n] > max)
-  //     {
-  //       max_convolution= convolution;
-  //       max = likelihood[n] ;
-  //       max_rank = n ;
-  //       max_rank2 = max_rank1;
-  //       max_rank1 = max_rank;
-  //     }
-  //
-  //   }
-  //
-  //   // test on the likelihood threshold if threshold==-1 then
-  //   // the me->threshold is  selected
-  //
-  //   vpImagePoint ip;
-  //
-  //   //  if (test_contrast)
-  //   if(max > threshold)
-  //     {
-  //       if ((selectDisplay==RANGE_RESULT)||(selectDisplay==RESULT))
-  // 	{
-  // 	  ip.set_i( list_query_pixels[max_rank].i );
-  // 	  ip.set_j( list_query_pixels[max_rank].j );
-  // 	  vpDisplay::displayPoint(I, ip, vpColor::red);
-  // 	}
-  //
-  //       *this = list_query_pixels[max_rank] ;//The vpMeSite is replaced by the vpMeSite of max likelihood
-  //       normGradient =  vpMath::sqr(max_convolution);
-  //
-  //       convlt = max_convolution;
-  //       i_1 = ii_1; //list_query_pixels[max_rank].i ;
-  //       j_1 = jj_1; //list_query_pixels[max_rank].j ;
-  //       delete []list_query_pixels ;
-  //       delete []likelihood;
-  //     }
-  //   else //none of the query sites is better than the threshold
-  //     {
-  //       if ((selectDisplay==RANGE_RESULT)||(selectDisplay==RESULT))
-  // 	{
-  // 	  ip.set_i( list_query_pixels[max_rank].i );
-  // 	  ip.set_j( list_query_pixels[max_rank].j );
-  // 	  vpDisplay::displayPoint(I, ip, vpColor::green);
-  // 	}
-  //       normGradient = 0 ;
-  //       if(max == 0)
-  // 	suppress = 1; // contrast suppression
-  //       else
-  // 	suppress = 2; // threshold suppression
-  //
-  //       delete []list_query_pixels ;
-  //       delete []likelihood; // modif portage
-  //     }
-
-  vpMeSite  *list_query_pixels ;
   int  max_rank =-1 ;
-  //   int max_rank1=-1 ;
-  //   int max_rank2 = -1;
   double  max_convolution = 0 ;
   double max = 0 ;
   double contraste = 0;
-  //  vpDisplay::display(I) ;
-  //  vpERROR_TRACE("getclcik %d",me->range) ;
-  //  vpDisplay::getClick(I) ;
 
-  // range = +/- range of pixels within which the correspondent
-  // of the current pixel will be sought
-  unsigned int range  = me->getRange() ;
+  int range = (int)range_ ;
+  unsigned int nb_queries = 2 * (unsigned int)range + 1 ;
 
-  //  std::cout << i << "  " << j<<"  " << range << "  " << suppress  << std::endl ;
-  list_query_pixels = getQueryList(I, (int)range) ;
+  double salpha = sin(alpha);
+  double calpha = cos(alpha);
+
+  // Display
+  if ((selectDisplay==RANGE_RESULT)||(selectDisplay==RANGE)) {
+    for(int k = -range ; k <= range ; k++)
+      vpDisplay::displayCross(I, vpImagePoint(ifloat+k*salpha, jfloat+k*calpha), 1, vpColor::yellow) ;
+  }
 
   double  contraste_max = 1 + me->getMu2();
   double  contraste_min = 1 - me->getMu1();
 
-  // array in which likelihood ratios will be stored
-  double  *likelihood= new double[ 2 * range + 1 ] ;
-
   int ii_1 = i ;
   int jj_1 = j ;
   i_1 = i ;
@@ -529,77 +424,76 @@ vpMeSite::track(const vpImage<unsigned char>& I,
   threshold = me->getThreshold() ;
   double diff = 1e6;
 
-  //    std::cout <<"---------------------"<<std::endl ;
-  for(unsigned int n = 0 ; n < 2 * range + 1 ; n++)
+  for(unsigned int n = 0 ; n < nb_queries ; n++)
   {
-    //   convolution results
-    double convolution_ = list_query_pixels[n].convolution(I, me) ;
-
     // luminance ratio of reference pixel to potential correspondent pixel
     // the luminance must be similar, hence the ratio value should
     // lay between, for instance, 0.5 and 1.5 (parameter tolerance)
     if( test_contraste )
     {
-      likelihood[n] = fabs(convolution_ + convlt );
-      if (likelihood[n]> threshold)
+      double likelihood = fabs(conv[n] + convlt );
+      if (likelihood > threshold)
       {
-        contraste = convolution_ / convlt;
+        contraste = conv[n] / convlt;
         if((contraste > contraste_min) && (contraste < contraste_max) && fabs(1-contraste) < diff)
         {
           diff = fabs(1-contraste);
-          max_convolution= convolution_;
-          max = likelihood[n] ;
+          max_convolution= conv[n];
+          max = likelihood ;
           max_rank = (int)n ;
-          // 	    max_rank2 = max_rank1;
-          // 	    max_rank1 = max_rank;
         }
       }
     }
 
     else
     {
-      likelihood[n] = fabs(2*convolution_) ;
-      if (likelihood[n] > max  && likelihood[n] > threshold)
+      double likelihood = fabs(2*conv[n]) ;
+      if (likelihood > max  && likelihood > threshold)
       {
-        max_convolution= convolution_;
-        max = likelihood[n] ;
+        max_convolution= conv[n];
+        max = likelihood ;
         max_rank = (int)n ;
-        //           max_rank2 = max_rank1;
-        //           max_rank1 = max_rank;
       }
     }
   }
-  
-  // test on the likelihood threshold if threshold==-1 then
-  // the me->threshold is  selected
 
   vpImagePoint ip;
 
-  //  if (test_contrast)
   if(max_rank >= 0)
   {
+    // The site is replaced by the query site of max likelihood
+    int k = max_rank - range ;
+    ifloat = ifloat + k*salpha ;
+    jfloat = jfloat + k*calpha ;
+    i = (int)ifloat ;
+    j = (int)jfloat ;
+    int half = (static_cast<int>(me->getMaskSize()) - 1) >> 1 ;
+    if(vpMeSiteBatch::isOutOfImage(i, j, half + me->getStrip(), (int)I.getHeight(), (int)I.getWidth())) {
+      i = 0 ; j = 0 ;
+    }
+    v = 0 ;
+    weight = 1 ;
+    setState(NO_SUPPRESSION) ;
+
     if ((selectDisplay==RANGE_RESULT)||(selectDisplay==RESULT))
     {
-      ip.set_i( list_query_pixels[max_rank].i );
-      ip.set_j( list_query_pixels[max_rank].j );
+      ip.set_i( i );
+      ip.set_j( j );
       vpDisplay::displayPoint(I, ip, vpColor::red);
     }
-		
-    *this = list_query_pixels[max_rank] ;//The vpMeSite2 is replaced by the vpMeSite2 of max likelihood
+
     normGradient =  vpMath::sqr(max_convolution);
 
     convlt = max_convolution;
-    i_1 = ii_1; //list_query_pixels[max_rank].i ;
-    j_1 = jj_1; //list_query_pixels[max_rank].j ;
-    delete []list_query_pixels ;
-    delete []likelihood;
+    i_1 = ii_1;
+    j_1 = jj_1;
   }
   else //none of the query sites is better than the threshold
   {
     if ((selectDisplay==RANGE_RESULT)||(selectDisplay==RESULT))
     {
-      ip.set_i( list_query_pixels[0].i );
-      ip.set_j( list_query_pixels[0].j );
+      ip.set_i( (int)(ifloat-range*salpha) );
+      ip.set_j( (int)(jfloat-range*calpha) );
       vpDisplay::displayPoint(I, ip, vpColor::green);
     }
     normGradient = 0 ;
@@ -608,9 +502,6 @@ vpMeSite::track(const vpImage<unsigned char>& I,
       state = CONSTRAST; // contrast suppression
     else
       state = THRESHOLD; // threshold suppression
-
-    delete []list_query_pixels ;
-    delete []likelihood; // modif portage
   }
 }
 
@@ -0,0 +1,224 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Batched search of moving edges sites.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpMeSiteBatch.cpp
+  \brief Batched search of moving edges sites.
+*/
+
+#include <cmath>
+
+#include <visp3/me/vpMeSiteBatch.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+namespace {
+  /*
+    Convolution of the msize x msize pixels starting at p with an integer mask
+    whose rows are padded with zeros to mstride elements. The SSE2 version reads
+    the padding columns of the image too: they are multiplied by 0, and the
+    margin kept by vpMeSiteBatch::isOutOfImage() below the mask ensures that
+    they are inside the image.
+  */
+  inline int convolve(const unsigned char *p, const unsigned int stride, const short *mask,
+                      const unsigned int msize, const unsigned int mstride)
+  {
+#if VISP_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (unsigned int a = 0; a < msize; a++, p += stride, mask += mstride) {
+      for (unsigned int b = 0; b < mstride; b += 8) {
+        const __m128i pixels = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + b)), zero);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(pixels, _mm_loadu_si128((const __m128i *)(mask + b))));
+      }
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(acc);
+#else
+    int conv = 0;
+    for (unsigned int a = 0; a < msize; a++, p += stride, mask += mstride)
+      for (unsigned int b = 0; b < msize; b++)
+        conv += mask[b] * p[b];
+    return conv;
+#endif
+  }
+}
+
+vpMeSiteBatch::vpMeSiteBatch()
+  : m_sites(), m_ifloat(), m_jfloat(), m_alpha(), m_maskSign(), m_maskIndex(), m_offsets(), m_convolutions()
+{
+}
+
+/*!
+  Add a site to track. The site is not copied: it is updated by track() and
+  must outlive it.
+*/
+void vpMeSiteBatch::add(vpMeSite &site)
+{
+  m_sites.push_back(&site);
+  m_ifloat.push_back(site.ifloat);
+  m_jfloat.push_back(site.jfloat);
+  m_alpha.push_back(site.alpha);
+  m_maskSign.push_back(site.mask_sign);
+}
+
+/*!
+  Remove all the sites. The memory is kept for the next ones.
+*/
+void vpMeSiteBatch::clear()
+{
+  m_sites.clear();
+  m_ifloat.clear();
+  m_jfloat.clear();
+  m_alpha.clear();
+  m_maskSign.clear();
+}
+
+/*!
+  Track all the sites given to add() in the image \e I, as vpMeSite::track()
+  would do for each of them.
+
+  \param I : Image.
+  \param me : Moving edges parameters.
+  \param test_contraste : If true, the convolution of the selected query pixel
+  must be close to the one of the site in the previous image.
+*/
+void vpMeSiteBatch::track(const vpImage<unsigned char> &I, const vpMe *me, const bool test_contraste)
+{
+  track(I, me, test_contraste, me->getRange());
+}
+
+/*!
+  Track all the sites given to add() in the image \e I, searching their
+  correspondent within +/- \e range_ pixels instead of vpMe::getRange().
+
+  \param I : Image.
+  \param me : Moving edges parameters, not modified.
+  \param test_contraste : If true, the convolution of the selected query pixel
+  must be close to the one of the site in the previous image.
+  \param range_ : Range of the search along the normal of the sites.
+*/
+void vpMeSiteBatch::track(const vpImage<unsigned char> &I, const vpMe *me, const bool test_contraste,
+                          const unsigned int range_)
+{
+  const unsigned int nbSites = size();
+  const int range = (int)range_;
+  const unsigned int nbQueries = 2 * (unsigned int)range + 1;
+  const unsigned int msize = me->getMaskSize();
+  const unsigned int mstride = me->getIntegerMaskStride();
+  const int half = ((int)msize - 1) >> 1;
+  const int rows = (int)I.getHeight(), cols = (int)I.getWidth();
+  const int stride = (int)I.getStride();
+
+  m_maskIndex.resize(nbSites);
+  m_offsets.resize(nbSites * nbQueries);
+  m_convolutions.resize(nbSites * nbQueries);
+
+  // Position of all the query pixels along the normals
+  for (unsigned int s = 0; s < nbSites; s++) {
+    const double salpha = sin(m_alpha[s]);
+    const double calpha = cos(m_alpha[s]);
+    m_maskIndex[s] = getMaskIndex(m_alpha[s], me);
+    int *offsets = &m_offsets[s * nbQueries];
+    for (int k = -range; k <= range; k++) {
+      const int i = (int)(m_ifloat[s] + k * salpha);
+      const int j = (int)(m_jfloat[s] + k * calpha);
+      offsets[k + range] = isOutOfImage(i, j, half + me->getStrip(), rows, cols) ? -1 : (i - half) * stride + (j - half);
+    }
+  }
+
+  // Convolutions of all the query pixels
+  for (unsigned int s = 0; s < nbSites; s++) {
+    const short *mask = me->getIntegerMask(m_maskIndex[s]);
+    const int *offsets = &m_offsets[s * nbQueries];
+    double *conv = &m_convolutions[s * nbQueries];
+    for (unsigned int n = 0; n < nbQueries; n++)
+      conv[n] = (offsets[n] < 0) ? 0.0 : m_maskSign[s] * convolve(I.bitmap + offsets[n], (unsigned int)stride, mask,
+                                                                    msize, mstride);
+  }
+
+  // Most likely query pixel of each site
+  for (unsigned int s = 0; s < nbSites; s++)
+    m_sites[s]->track(I, me, &m_convolutions[s * nbQueries], range_, test_contraste);
+}
+
+/*!
+  Return the convolution of the mask of index \e index_mask with the image
+  around the pixel (i, j). The pixel has to be far enough from the borders, see
+  isOutOfImage(). The result is the same as with the masks of vpMe::getMask().
+*/
+int vpMeSiteBatch::convolution(const vpImage<unsigned char> &I, const vpMe *me, const int i, const int j,
+                               const unsigned int index_mask)
+{
+  const unsigned int msize = me->getMaskSize();
+  const int half = ((int)msize - 1) >> 1;
+  return convolve(I[i - half] + j - half, I.getStride(), me->getIntegerMask(index_mask), msize,
+                  me->getIntegerMaskStride());
+}
+
+/*!
+  Return the index of the mask of vpMe whose orientation is the closest to the
+  tangent of a contour of normal \e alpha.
+*/
+unsigned int vpMeSiteBatch::getMaskIndex(const double alpha, const vpMe *me)
+{
+  // Calculate tangent angle from normal
+  double theta = alpha + M_PI / 2;
+  // Move tangent angle to within 0->M_PI for a positive mask index
+  while (theta < 0) theta += M_PI;
+  while (theta > M_PI) theta -= M_PI;
+
+  // Convert radians to degrees
+  int thetadeg = vpMath::round(theta * 180 / M_PI);
+  if (abs(thetadeg) == 180)
+    thetadeg = 0;
+
+  const unsigned int index_mask = (unsigned int)(thetadeg / (double)me->getAngleStep());
+  return (index_mask < me->getMaskNumber()) ? index_mask : me->getMaskNumber() - 1;
+}
+
+/*!
+  Return true if a mask of half size \e half centered on the pixel (i, j) is
+  too close to the borders of a \e rows x \e cols image.
+*/
+bool vpMeSiteBatch::isOutOfImage(const int i, const int j, const int half, const int rows, const int cols)
+{
+  const int half_1 = half + 1;
+  const int half_3 = half + 3;
+  return ((0 < (half_1 - i)) || ((i - rows + half_3) > 0) || (0 < (half_1 - j)) || ((j - cols + half_3) > 0));
+}
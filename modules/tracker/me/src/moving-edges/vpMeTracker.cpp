@@ -62,7 +62,7 @@ vpMeTracker::init()
 }
 
 vpMeTracker::vpMeTracker()
-  : list(), me(NULL), init_range(1), nGoodElement(0), selectDisplay(vpMeSite::NONE)
+  : list(), me(NULL), init_range(1), nGoodElement(0), selectDisplay(vpMeSite::NONE), m_siteBatch()
 #ifdef VISP_BUILD_DEPRECATED_FUNCTIONS
   , query_range (0), display_point(false)
 #endif
@@ -72,7 +72,7 @@ vpMeTracker::vpMeTracker()
 
 vpMeTracker::vpMeTracker(const vpMeTracker& meTracker)
   : vpTracker(meTracker),
-    list(), me(NULL), init_range(1), nGoodElement(0), selectDisplay(vpMeSite::NONE)
+    list(), me(NULL), init_range(1), nGoodElement(0), selectDisplay(vpMeSite::NONE), m_siteBatch()
 #ifdef VISP_BUILD_DEPRECATED_FUNCTIONS
     , query_range (0), display_point(false)
 #endif
@@ -173,38 +173,24 @@ vpMeTracker::initTracking(const vpImage<unsigned char>& I)
       "Moving edges not initialized")) ;
   }
 
-  // Must set range to 0
-  unsigned int range_tmp = me->getRange();
-  me->setRange(init_range);
-
   nGoodElement=0;
 
-  int d = 0;
-  vpImagePoint ip1, ip2;
-
-  // Loop through list of sites to track
+  // Track all the sites that haven't been suppressed in a single pass
+  m_siteBatch.clear();
   for(std::list<vpMeSite>::iterator it=list.begin(); it!=list.end(); ++it){
-    vpMeSite refp = *it;//current reference pixel
-
-    d++ ;
-    // If element hasn't been suppressed
-    if(refp.getState() == vpMeSite::NO_SUPPRESSION)
-    {
-      try {
-        refp.track(I,me,false);
-      }
-      catch(...)
-      {
-        // EM verifier quel signal est de sortie !!!
-        vpERROR_TRACE("Error caught") ;
-        throw ;
-      }
-      if(refp.getState() == vpMeSite::NO_SUPPRESSION) nGoodElement++;
-    }
+    if(it->getState() == vpMeSite::NO_SUPPRESSION)
+      m_siteBatch.add(*it);
+  }
+  // Search within init_range, without modifying the shared parameters
+  m_siteBatch.track(I, me, false, init_range);
 
+  for(unsigned int k = 0; k < m_siteBatch.size(); k++) {
+    const vpMeSite &refp = m_siteBatch.getSite(k);
+    if(refp.getState() == vpMeSite::NO_SUPPRESSION) nGoodElement++;
 
 #if (DEBUG_LEVEL2)
     {
+      vpImagePoint ip1, ip2;
       double a,b ;
       a = refp.i_1 - refp.i ;
       b = refp.j_1 - refp.j ;
@@ -217,7 +203,6 @@ vpMeTracker::initTracking(const vpImage<unsigned char>& I)
       }
     }
 #endif
-    *it = refp;
   }
 
   /*
@@ -238,8 +223,6 @@ vpMeTracker::initTracking(const vpImage<unsigned char>& I)
   return res ;
   }
   */
-
-  me->setRange(range_tmp);
 }
 
 /*!
@@ -267,50 +250,37 @@ vpMeTracker::track(const vpImage<unsigned char>& I)
 
   }
 
-  vpImagePoint ip1, ip2;
   nGoodElement=0;
-  //  int d =0;
-  // Loop through list of sites to track
+
+  // Track all the sites that haven't been suppressed in a single pass
+  m_siteBatch.clear();
   for(std::list<vpMeSite>::iterator it=list.begin(); it!=list.end(); ++it){
-    vpMeSite s = *it;//current reference pixel
+    if(it->getState() == vpMeSite::NO_SUPPRESSION)
+      m_siteBatch.add(*it);
+  }
+  m_siteBatch.track(I, me, true);
 
-    //    d++ ;
-    // If element hasn't been suppressed
-    if(s.getState() == vpMeSite::NO_SUPPRESSION)
+  for(unsigned int k = 0; k < m_siteBatch.size(); k++) {
+    const vpMeSite &s = m_siteBatch.getSite(k);
+    if(s.getState() != vpMeSite::THRESHOLD)
     {
-
-      try{
-        //	vpERROR_TRACE("%d",d ) ;
-        //	vpERROR_TRACE("range %d",me->range) ;
-        s.track(I,me,true);
-      }
-      catch(vpTrackingException)
-      {
-        vpERROR_TRACE("catch exception ") ;
-        s.setState(vpMeSite::THRESHOLD);
-      }
-
-      if(s.getState() != vpMeSite::THRESHOLD)
-      {
-        nGoodElement++;
+      nGoodElement++;
 
 #if (DEBUG_LEVEL2)
-        {
-          double a,b ;
-          a = s.i_1 - s.i ;
-          b = s.j_1 - s.j ;
-          if(s.getState() == vpMeSite::NO_SUPPRESSION) {
-            ip1.set_i( s.i );
-            ip1.set_j( s.j );
-            ip2.set_i( s.i+a*5 );
-            ip2.set_j( s.j+b*5 );
-            vpDisplay::displayArrow(I, ip1, ip2, vpColor::green) ;
-          }
+      {
+        vpImagePoint ip1, ip2;
+        double a,b ;
+        a = s.i_1 - s.i ;
+        b = s.j_1 - s.j ;
+        if(s.getState() == vpMeSite::NO_SUPPRESSION) {
+          ip1.set_i( s.i );
+          ip1.set_j( s.j );
+          ip2.set_i( s.i+a*5 );
+          ip2.set_j( s.j+b*5 );
+          vpDisplay::displayArrow(I, ip1, ip2, vpColor::green) ;
         }
-#endif
-
       }
-      *it = s;
+#endif
     }
   }
 }
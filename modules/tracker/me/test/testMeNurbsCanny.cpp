@@ -0,0 +1,187 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the tracking of a nurbs with the canny detection of the extremities.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testMeNurbsCanny.cpp
+
+  \brief Track the top edge of a synthetic rectangle with vpMeNurbs when the
+  canny detection of the extremities is enabled, and run the canny detection
+  on both extremities, including when all the sites are inside its window.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <list>
+#include <stdlib.h>
+
+#include <visp3/core/vpRect.h>
+#include <visp3/me/vpMeNurbs.h>
+
+namespace {
+  //! Dark rectangle on a bright background, with corners where the edge stops
+  void drawRectangle(vpImage<unsigned char> &I, const vpRect &rect)
+  {
+    for (unsigned int i = 0; i < I.getHeight(); i++)
+      for (unsigned int j = 0; j < I.getWidth(); j++)
+        I[i][j] = (i >= rect.getTop() && i <= rect.getBottom() && j >= rect.getLeft() && j <= rect.getRight())
+            ? 50 : 200;
+  }
+
+  //! Distance of a point to the border of the rectangle
+  double distanceToBorder(const vpImagePoint &ip, const vpRect &rect)
+  {
+    const double di = (std::max)((std::max)(rect.getTop() - ip.get_i(), ip.get_i() - rect.getBottom()), 0.);
+    const double dj = (std::max)((std::max)(rect.getLeft() - ip.get_j(), ip.get_j() - rect.getRight()), 0.);
+    if (di > 0 || dj > 0)
+      return sqrt(di * di + dj * dj);
+    return (std::min)((std::min)(ip.get_i() - rect.getTop(), rect.getBottom() - ip.get_i()),
+                      (std::min)(ip.get_j() - rect.getLeft(), rect.getRight() - ip.get_j()));
+  }
+
+  //! Run the canny detection once the extremities were not found three times, as vpMeNurbs::track() does
+  void seekExtremitiesCanny(vpMeNurbs &nurbs, const vpImage<unsigned char> &I)
+  {
+    for (unsigned int n = 0; n < 3; n++)
+      nurbs.seekExtremities(I);
+    nurbs.seekExtremitiesCanny(I);
+  }
+
+  //! Check that the tracked sites are on the border of the rectangle and count those below its top edge
+  bool checkSites(const vpMeNurbs &nurbs, const vpRect &rect, unsigned int &nbSites, unsigned int &nbBelowTop)
+  {
+    const std::list<vpMeSite> sites = nurbs.getMeList();
+    nbSites = nbBelowTop = 0;
+    for (std::list<vpMeSite>::const_iterator it = sites.begin(); it != sites.end(); ++it) {
+      if (it->getState() != vpMeSite::NO_SUPPRESSION)
+        continue;
+      const vpImagePoint ip(it->ifloat, it->jfloat);
+      const double d = distanceToBorder(ip, rect);
+      if (d > 3) {
+        std::cerr << "The site " << ip << " is " << d << " pixels away from the rectangle" << std::endl;
+        return false;
+      }
+      nbSites++;
+      nbBelowTop += (ip.get_i() > rect.getTop() + 3) ? 1 : 0;
+    }
+    return true;
+  }
+
+  //! Nurbs initialized on the top edge of the rectangle, between the fractions first and last of its width
+  void initNurbs(vpMeNurbs &nurbs, vpMe &me, const vpImage<unsigned char> &I, const vpRect &rect,
+                 const double first, const double last)
+  {
+    me.setRange(10);
+    me.setSampleStep(5);
+    me.setThreshold(1000);
+    nurbs.setMe(&me);
+    nurbs.setDisplay(vpMeSite::NONE);
+    nurbs.setNbControlPoints(6);
+    nurbs.setEnableCannyDetection(true);
+    nurbs.setCannyThreshold(50, 150);
+
+    std::list<vpImagePoint> ptList;
+    for (unsigned int k = 0; k < 5; k++)
+      ptList.push_back(vpImagePoint(rect.getTop(),
+                                    rect.getLeft() + (first + 0.25 * k * (last - first)) * rect.getWidth()));
+    nurbs.initTracking(I, ptList);
+  }
+}
+
+int main()
+{
+  try {
+    vpImage<unsigned char> I(480, 640);
+    unsigned int nbSites, nbBelowTop;
+
+    // The extremities of the top edge stop on the corners while the rectangle moves down
+    {
+      vpRect rect(200, 150, 250, 200);
+      drawRectangle(I, rect);
+      vpMe me;
+      vpMeNurbs nurbs;
+      initNurbs(nurbs, me, I, rect, 0.1, 0.9);
+      for (unsigned int n = 0; n < 20; n++) {
+        rect.setTop(rect.getTop() + 0.5);
+        drawRectangle(I, rect);
+        nurbs.track(I);
+      }
+      if (! checkSites(nurbs, rect, nbSites, nbBelowTop))
+        return EXIT_FAILURE;
+      if (nbSites < 10) {
+        std::cerr << "Only " << nbSites << " sites are tracked" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // The canny detection follows the contour around both corners
+    {
+      vpRect rect(200, 150, 250, 200);
+      drawRectangle(I, rect);
+      vpMe me;
+      vpMeNurbs nurbs;
+      initNurbs(nurbs, me, I, rect, 0., 1.);
+      seekExtremitiesCanny(nurbs, I);
+      if (! checkSites(nurbs, rect, nbSites, nbBelowTop))
+        return EXIT_FAILURE;
+      if (nbBelowTop < 2) {
+        std::cerr << "No site added by the canny detection along the sides" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // All the sites are inside the window of the canny detection
+    {
+      vpRect rect(200, 150, 250, 200);
+      drawRectangle(I, rect);
+      vpMe me;
+      vpMeNurbs nurbs;
+      initNurbs(nurbs, me, I, rect, 0., 1.);
+      std::list<vpMeSite> sites = nurbs.getMeList();
+      sites.resize(2);
+      nurbs.setMeList(sites);
+      seekExtremitiesCanny(nurbs, I);
+      if (! nurbs.getMeList().empty()) {
+        std::cerr << nurbs.getMeList().size() << " sites left instead of none" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    std::cout << "testMeNurbsCanny is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,301 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the batched search of moving edges sites.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceMeSite.cpp
+
+  \brief Check that vpMeSite::track() and vpMeSiteBatch give the results of
+  the former search along the normals with the double precision masks, and
+  measure how many sites are tracked per millisecond.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpTime.h>
+#include <visp3/me/vpMeLine.h>
+#include <visp3/me/vpMeSiteBatch.h>
+
+namespace {
+  //! Grey level disc of radius r centered on (ci, cj), with an antialiased border
+  void drawDisc(vpImage<unsigned char> &I, const double ci, const double cj, const double r)
+  {
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        const double d = sqrt(vpMath::sqr(i - ci) + vpMath::sqr(j - cj)) - r;
+        const double t = (std::min)((std::max)(0.5 - d / 2, 0.0), 1.0);
+        I[i][j] = (unsigned char)(60 + 140 * t + rand() % 5);
+      }
+    }
+  }
+
+  //! Former search of vpMeSite::track(), with the query sites and the double precision masks
+  void referenceTrack(vpMeSite &site, const vpImage<unsigned char> &I, const vpMe &me, const bool test_contraste)
+  {
+    const int range = (int)me.getRange();
+    const double salpha = sin(site.alpha), calpha = cos(site.alpha);
+    const int half = ((int)me.getMaskSize() - 1) >> 1;
+    const double contraste_max = 1 + me.getMu2(), contraste_min = 1 - me.getMu1();
+    int max_rank = -1;
+    double max_convolution = 0, max = 0, contraste = 0, diff = 1e6;
+    vpMeSite best;
+    const int ii_1 = site.i, jj_1 = site.j;
+    site.i_1 = site.i;
+    site.j_1 = site.j;
+    for (int k = -range; k <= range; k++) {
+      vpMeSite pel;
+      pel.init(site.ifloat + k * salpha, site.jfloat + k * calpha, site.alpha, site.convlt, site.mask_sign);
+
+      double conv = 0;
+      const int margin = half + me.getStrip();
+      if (pel.i < margin + 1 || pel.i > (int)I.getHeight() - margin - 3 || pel.j < margin + 1 ||
+          pel.j > (int)I.getWidth() - margin - 3) {
+        pel.i = 0;
+        pel.j = 0;
+      }
+      else {
+        const vpMatrix &mask = me.getMask()[vpMeSiteBatch::getMaskIndex(site.alpha, &me)];
+        for (unsigned int a = 0; a < me.getMaskSize(); a++)
+          for (unsigned int b = 0; b < me.getMaskSize(); b++)
+            conv += pel.mask_sign * mask[a][b] * I[pel.i - half + (int)a][pel.j - half + (int)b];
+      }
+
+      if (test_contraste) {
+        const double likelihood = fabs(conv + site.convlt);
+        if (likelihood > me.getThreshold()) {
+          contraste = conv / site.convlt;
+          if (contraste > contraste_min && contraste < contraste_max && fabs(1 - contraste) < diff) {
+            diff = fabs(1 - contraste);
+            max_convolution = conv;
+            max = likelihood;
+            max_rank = k + range;
+            best = pel;
+          }
+        }
+      }
+      else {
+        const double likelihood = fabs(2 * conv);
+        if (likelihood > max && likelihood > me.getThreshold()) {
+          max_convolution = conv;
+          max = likelihood;
+          max_rank = k + range;
+          best = pel;
+        }
+      }
+    }
+
+    if (max_rank >= 0) {
+      site = best;
+      site.normGradient = vpMath::sqr(max_convolution);
+      site.convlt = max_convolution;
+      site.i_1 = ii_1;
+      site.j_1 = jj_1;
+    }
+    else {
+      site.normGradient = 0;
+      site.setState(std::fabs(contraste) > std::numeric_limits<double>::epsilon() ? vpMeSite::CONSTRAST
+                                                                                 : vpMeSite::THRESHOLD);
+    }
+  }
+
+  bool sameSite(const vpMeSite &a, const vpMeSite &b)
+  {
+    return a.i == b.i && a.j == b.j && a.i_1 == b.i_1 && a.j_1 == b.j_1 && a.ifloat == b.ifloat &&
+        a.jfloat == b.jfloat && a.convlt == b.convlt && a.normGradient == b.normGradient &&
+        a.weight == b.weight && a.getState() == b.getState();
+  }
+
+  //! Sites on the border of the disc, with a normal direction slightly perturbed
+  std::vector<vpMeSite> sampleDisc(const double ci, const double cj, const double r, const unsigned int n)
+  {
+    std::vector<vpMeSite> sites(n);
+    for (unsigned int k = 0; k < n; k++) {
+      const double t = 2 * M_PI * k / n;
+      const double rk = r + (rand() % 7 - 3);
+      sites[k].init(ci + rk * sin(t), cj + rk * cos(t), t + 0.05 * (rand() % 5 - 2), 0, 1);
+      sites[k].setState(vpMeSite::NO_SUPPRESSION);
+    }
+    return sites;
+  }
+
+  bool testSearch(const vpImage<unsigned char> &I0, const vpImage<unsigned char> &I1, vpMe &me,
+                  const std::vector<vpMeSite> &init)
+  {
+    vpMeSiteBatch batch;
+    for (unsigned int t = 0; t < 2; t++) {
+      // First the initialization without contrast test, then the tracking in the next image
+      const bool test_contraste = (t == 1);
+      const vpImage<unsigned char> &I = (t == 0) ? I0 : I1;
+
+      std::vector<vpMeSite> ref = init, sites = init, batchSites = init;
+      if (t == 1) {
+        for (size_t k = 0; k < init.size(); k++) {
+          referenceTrack(ref[k], I0, me, false);
+          sites[k] = batchSites[k] = ref[k];
+        }
+      }
+
+      batch.clear();
+      for (size_t k = 0; k < init.size(); k++) {
+        referenceTrack(ref[k], I, me, test_contraste);
+        sites[k].track(I, &me, test_contraste);
+        batch.add(batchSites[k]);
+      }
+      batch.track(I, &me, test_contraste);
+
+      unsigned int nbTracked = 0;
+      for (size_t k = 0; k < init.size(); k++) {
+        if (! sameSite(ref[k], sites[k]) || ! sameSite(ref[k], batchSites[k])) {
+          std::cerr << "Site " << k << " differs from the reference with a " << me.getMaskSize()
+                    << " mask and a range of " << me.getRange() << std::endl;
+          return false;
+        }
+        nbTracked += (ref[k].getState() == vpMeSite::NO_SUPPRESSION) ? 1 : 0;
+      }
+      if (nbTracked < init.size() / 2) {
+        std::cerr << "Only " << nbTracked << " sites tracked on " << init.size() << std::endl;
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    srand(0);
+    vpImage<unsigned char> I0(480, 640), I1(480, 640);
+    drawDisc(I0, 240, 320, 150);
+    drawDisc(I1, 241.5, 318.7, 151);
+
+    const std::vector<vpMeSite> sites = sampleDisc(240, 320, 150, 500);
+
+    // Results of the former search
+    const unsigned int maskSizes[] = { 3, 5, 7, 9 };
+    const unsigned int ranges[] = { 4, 40 };
+    for (unsigned int m = 0; m < 4; m++) {
+      for (unsigned int r = 0; r < 2; r++) {
+        vpMe me;
+        me.setMaskSize(maskSizes[m]);
+        me.setRange(ranges[r]);
+        me.setThreshold(1000);
+        if (! testSearch(I0, I1, me, sites))
+          return EXIT_FAILURE;
+      }
+    }
+
+    // Sites near the borders are suppressed
+    {
+      vpMe me;
+      vpMeSite site;
+      site.init(2, 300, 0, 0, 1);
+      site.track(I0, &me, false);
+      if (site.getState() != vpMeSite::THRESHOLD) {
+        std::cerr << "A site out of the image was tracked" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // A line tracked through the moving edges tracker
+    {
+      vpImage<unsigned char> L0(240, 320), L1(240, 320);
+      for (unsigned int i = 0; i < L0.getHeight(); i++) {
+        for (unsigned int j = 0; j < L0.getWidth(); j++) {
+          L0[i][j] = (j < 0.5 * i + 100) ? 50 : 200;
+          L1[i][j] = (j < 0.5 * i + 102) ? 50 : 200;
+        }
+      }
+      vpMe me;
+      me.setSampleStep(5);
+      vpMeLine line;
+      line.setMe(&me);
+      line.initTracking(L0, vpImagePoint(40, 120), vpImagePoint(200, 200));
+      line.track(L1);
+      const double expectedRho = 102 * cos(atan(0.5)), expectedTheta = atan2(1.0, -0.5);
+      if (std::fabs(std::fabs(line.getRho()) - expectedRho) > 1.0 ||
+          std::fabs(vpMath::sqr(sin(line.getTheta())) - vpMath::sqr(sin(expectedTheta))) > 1e-2) {
+        std::cerr << "Bad line: rho = " << line.getRho() << ", theta = " << line.getTheta() << " instead of "
+                  << expectedRho << ", " << expectedTheta << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Benchmark
+    vpMe me;
+    me.setThreshold(1000);
+    const std::vector<vpMeSite> many = sampleDisc(240, 320, 150, 5000);
+    std::vector<vpMeSite> tracked = many;
+    for (size_t k = 0; k < many.size(); k++)
+      tracked[k].track(I0, &me, false);
+    const unsigned int nb_iter = 20;
+    double t_ref = 0, t_site = 0, t_batch = 0;
+    vpMeSiteBatch batch;
+    for (unsigned int iter = 0; iter < nb_iter; iter++) {
+      std::vector<vpMeSite> s = tracked;
+      double t = vpTime::measureTimeMs();
+      for (size_t k = 0; k < s.size(); k++)
+        referenceTrack(s[k], I1, me, true);
+      t_ref += vpTime::measureTimeMs() - t;
+
+      s = tracked;
+      t = vpTime::measureTimeMs();
+      for (size_t k = 0; k < s.size(); k++)
+        s[k].track(I1, &me, true);
+      t_site += vpTime::measureTimeMs() - t;
+
+      s = tracked;
+      t = vpTime::measureTimeMs();
+      batch.clear();
+      for (size_t k = 0; k < s.size(); k++)
+        batch.add(s[k]);
+      batch.track(I1, &me, true);
+      t_batch += vpTime::measureTimeMs() - t;
+    }
+    const double nbSites = (double)many.size() * nb_iter;
+    std::cout << "Sites tracked per ms (5x5 masks, range 4):" << std::endl;
+    std::cout << "  former search:    " << nbSites / t_ref << std::endl;
+    std::cout << "  vpMeSite::track(): " << nbSites / t_site << std::endl;
+    std::cout << "  vpMeSiteBatch:     " << nbSites / t_batch << std::endl;
+
+    std::cout << "testPerformanceMeSite is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
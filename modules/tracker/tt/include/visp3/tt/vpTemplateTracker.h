@@ -50,6 +50,7 @@
 #include <visp3/tt/vpTemplateTrackerZone.h>
 #include <visp3/tt/vpTemplateTrackerWarp.h>
 #include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpImagePyramid.h>
 
 /*!
   \class vpTemplateTracker
@@ -82,10 +83,14 @@ class VISP_EXPORT vpTemplateTracker
 
     vpTemplateTrackerPointCompo *ptTemplateCompo;    //pour ESM
     vpTemplateTrackerPointCompo **ptTemplateCompoPyr;   //pour ESM
+    vpTemplateTrackerPointSoA   *ptTemplateSoA;    //pour inverse compo et ESM
+    vpTemplateTrackerPointSoA  **ptTemplateSoAPyr;
     vpTemplateTrackerZone               *zoneTracked;
     vpTemplateTrackerZone               *zoneTrackedPyr;
     
     vpImage<unsigned char>     *pyr_IDes;
+    //! Pyramid of the current image, kept from one image to the next one
+    vpImagePyramid              pyr_I;
     
     vpMatrix                    H;
     vpMatrix                    Hdesire;
@@ -166,7 +171,7 @@ class VISP_EXPORT vpTemplateTracker
         ptTemplateInit(false), templateSize(0), templateSizePyr(NULL), ptTemplateSelect(NULL),
         ptTemplateSelectPyr(NULL), ptTemplateSelectInit(false), templateSelectSize(0),
         ptTemplateSupp(NULL), ptTemplateSuppPyr(NULL), ptTemplateCompo(NULL), ptTemplateCompoPyr(NULL),
-        zoneTracked(NULL), zoneTrackedPyr(NULL), pyr_IDes(NULL), H(), Hdesire(), HdesirePyr(NULL),
+        ptTemplateSoA(NULL), ptTemplateSoAPyr(NULL), zoneTracked(NULL), zoneTrackedPyr(NULL), pyr_IDes(NULL), pyr_I(), H(), Hdesire(), HdesirePyr(NULL),
         HLM(), HLMdesire(), HLMdesirePyr(NULL), HLMdesireInverse(), HLMdesireInversePyr(NULL),
         G(), gain(0), thresholdGradient(0), costFunctionVerification(false),
         blur(false), useBrent(false), nbIterBrent(0), taillef(0), fgG(NULL), fgdG(NULL),
@@ -259,6 +264,7 @@ class VISP_EXPORT vpTemplateTracker
 
     void            computeOptimalBrentGain(const vpImage<unsigned char> &I,vpColVector &tp,double tMI,vpColVector &direction,double &alpha);
     virtual double  getCost(const vpImage<unsigned char> &I, const vpColVector &tp) = 0;
+    unsigned int    computeWarpedTemplate(const vpImage<unsigned char> &I, const vpColVector &tp);
     void            getGaussianBluredImage(const vpImage<unsigned char> &I){ vpImageFilter::filter(I, BI,fgG,taillef); }
     virtual void    initHessienDesired(const vpImage<unsigned char> &I)=0;
     virtual void    initHessienDesiredPyr(const vpImage<unsigned char> &I);
@@ -267,6 +273,8 @@ class VISP_EXPORT vpTemplateTracker
     virtual void    initTrackingPyr(const vpImage<unsigned char>& I,vpTemplateTrackerZone &zone);
     virtual void    trackNoPyr(const vpImage<unsigned char> &I) = 0;
     virtual void    trackPyr(const vpImage<unsigned char> &I);
+    void            sumProducts(const std::vector<const double *> &a, const std::vector<const double *> &b,
+                                const unsigned int n, double *sums) const;
 };
 #endif
 
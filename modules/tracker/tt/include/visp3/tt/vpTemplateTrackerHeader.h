@@ -45,6 +45,7 @@
 #define vpTemplateTrackerHeader_hh
 
 #include <stdio.h>
+#include <vector>
 
 /*!
   \struct vpTemplateTrackerZPoint
@@ -86,6 +87,38 @@ struct vpTemplateTrackerPointCompo {
     vpTemplateTrackerPointCompo() : dW(NULL) {}
 };
 
+/*!
+  \struct vpTemplateTrackerPointSoA
+  \ingroup group_tt_tools
+
+  Template points used by a tracker stored as a structure of arrays, with their
+  steepest descent images. The inverse compositional and ESM trackers process
+  all the points in one pass over these arrays at each iteration.
+*/
+struct vpTemplateTrackerPointSoA {
+    //! Coordinates of the points in the reference image
+    std::vector<double> x, y;
+    //! Reference gray level and gradient
+    std::vector<double> val, dx, dy;
+    //! Steepest descent images, one row of size() values per parameter
+    std::vector<double> sd;
+    //! Derivatives of the warp for p=0, as expected by vpTemplateTrackerWarp::dWarpCompo()
+    std::vector<double> dWdp0;
+    //! Coordinates of the warped points, computed at each iteration
+    std::vector<double> x2, y2;
+    //! Gray level at the warped points, 0 if outside the image
+    std::vector<double> Iw;
+    //! True if the warped point is inside the image
+    std::vector<unsigned char> inside;
+
+    //! Number of points.
+    unsigned int size() const { return (unsigned int)x.size(); }
+    //! Steepest descent image of the parameter \e k.
+    double *getSD(const unsigned int k) { return sd.empty() ? NULL : &sd[k * x.size()]; }
+    //! Steepest descent image of the parameter \e k.
+    const double *getSD(const unsigned int k) const { return sd.empty() ? NULL : &sd[k * x.size()]; }
+};
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 struct vpTemplateTrackerPointSuppMIInv {
     double et;
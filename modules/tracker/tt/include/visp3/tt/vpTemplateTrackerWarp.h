@@ -182,6 +182,10 @@ class VISP_EXPORT vpTemplateTrackerWarp
     /*!
       Warp a list of points.
 
+      The default implementation warps the points one by one with warpX(). The
+      warping functions reimplement it to warp all the points in one loop,
+      which is used by the trackers at each iteration.
+
       \param ut0 : List of u coordinates of the points.
       \param vt0 : List of v coordinates of the points.
       \param nb_pt : Number of points to consider.
@@ -189,7 +193,7 @@ class VISP_EXPORT vpTemplateTrackerWarp
       \param u : Resulting u coordinates.
       \param v : resulting v coordinates.
     */
-    void warp(const double *ut0,const double *vt0,int nb_pt,const vpColVector& p,double *u,double *v);
+    virtual void warp(const double *ut0,const double *vt0,int nb_pt,const vpColVector& p,double *u,double *v);
 
     /*!
       Warp a point.
@@ -210,6 +210,18 @@ class VISP_EXPORT vpTemplateTrackerWarpHomographySL3: public vpTemplateTrackerWa
     */
     void warpX(const int &i,const int &j,double &i2,double &j2,const vpColVector &ParamM);
 
+    /*!
+      Warp a list of points in one loop.
+
+      \param ut0 : List of u coordinates of the points.
+      \param vt0 : List of v coordinates of the points.
+      \param nb_pt : Number of points to consider.
+      \param ParamM : Parameters of the warp.
+      \param u : Resulting u coordinates.
+      \param v : resulting v coordinates.
+    */
+    void warp(const double *ut0,const double *vt0,int nb_pt,const vpColVector& ParamM,double *u,double *v);
+
     #ifndef DOXYGEN_SHOULD_SKIP_THIS
     void warpXInv(const vpColVector &/*vX*/,vpColVector &/*vXres*/,const vpColVector &/*ParamM*/) {}
     #endif
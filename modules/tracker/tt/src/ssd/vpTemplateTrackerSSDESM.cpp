@@ -64,23 +64,36 @@ void vpTemplateTrackerSSDESM::initHessienDesired(const vpImage<unsigned char> &I
 
 void vpTemplateTrackerSSDESM::initCompInverse(const vpImage<unsigned char> &/*I*/)
 {
-  //std::cout<<"Initialise precomputed value of ESM with templateSize: "<< templateSize<<std::endl;
-  ptTemplateCompo=new vpTemplateTrackerPointCompo[templateSize];
+  if(ptTemplateSoA==NULL)
+    ptTemplateSoA=new vpTemplateTrackerPointSoA;
+  vpTemplateTrackerPointSoA &pts=*ptTemplateSoA;
+  pts.x.resize(templateSize);
+  pts.y.resize(templateSize);
+  pts.val.resize(templateSize);
+  pts.dx.resize(templateSize);
+  pts.dy.resize(templateSize);
+  pts.dWdp0.resize(templateSize*2*nbParam);
+  pts.sd.resize(templateSize*nbParam);
+
   int i,j;
   //direct
   for(unsigned int point=0;point<templateSize;point++)
   {
     i=ptTemplate[point].y;
     j=ptTemplate[point].x;
-    ptTemplateCompo[point].dW=new double[2*nbParam];
+    pts.x[point]=j;pts.y[point]=i;
+    pts.val[point]=ptTemplate[point].val;
+    pts.dx[point]=ptTemplate[point].dx;
+    pts.dy[point]=ptTemplate[point].dy;
     X1[0]=j;X1[1]=i;
     Warp->computeDenom(X1,p);
-    Warp->getdWdp0(i,j,ptTemplateCompo[point].dW);
+    Warp->getdWdp0(i,j,&pts.dWdp0[point*2*nbParam]);
 
   }
 
   //inverse
   HInv=0;
+  double *dWpt=new double[nbParam];
   for(unsigned int point=0;point<templateSize;point++)
   {
     i=ptTemplate[point].y;
@@ -88,13 +101,17 @@ void vpTemplateTrackerSSDESM::initCompInverse(const vpImage<unsigned char> &/*I*
 
     X1[0]=j;X1[1]=i;
     Warp->computeDenom(X1,p);
-    ptTemplate[point].dW=new double[nbParam];
-    Warp->getdW0(i,j,ptTemplate[point].dy,ptTemplate[point].dx,ptTemplate[point].dW);
+    Warp->getdW0(i,j,ptTemplate[point].dy,ptTemplate[point].dx,dWpt);
 
     for(unsigned int it=0;it<nbParam;it++)
       for(unsigned int jt=0;jt<nbParam;jt++)
-        HInv[it][jt]+=ptTemplate[point].dW[it]*ptTemplate[point].dW[jt];
+        HInv[it][jt]+=dWpt[it]*dWpt[jt];
+
+    // Steepest descent images, one row per parameter
+    for(unsigned int it=0;it<nbParam;it++)
+      pts.sd[it*templateSize+point]=dWpt[it];
   }
+  delete[] dWpt;
   vpMatrix::computeHLM(HInv,lambdaDep,HLMInv);
 
 compoInitialised=true;
@@ -107,76 +124,83 @@ void vpTemplateTrackerSSDESM::trackNoPyr(const vpImage<unsigned char> &I)
   vpImageFilter::getGradXGauss2D(I, dIx, fgG,fgdG,taillef);
   vpImageFilter::getGradYGauss2D(I, dIy, fgG,fgdG,taillef);
 
-  double IW,dIWx,dIWy;
-  double Tij;
+  double dIWx,dIWy;
   unsigned int iteration=0;
-  int i,j;
   double i2,j2;
   double alpha=2.;
+
+  vpTemplateTrackerPointSoA &pts=*ptTemplateSoA;
+  const unsigned int nbPoints=pts.size();
+  // Error and direct steepest descent images, 0 for the points outside the image
+  std::vector<double> er(nbPoints);
+  std::vector<double> tempt(nbParam*nbPoints);
+  // GInv, erreur, GDir and the upper part of HDir summed over the points
+  const unsigned int nbSums=2*nbParam+1+nbParam*(nbParam+1)/2;
+  std::vector<const double *> a(nbSums), b(nbSums);
+  std::vector<double> sums(nbSums);
   do
   {
-    unsigned int Nbpoint=0;
-    double erreur=0;
     dp=0;
-    HDir=0;
-    GDir=0;
-    GInv=0;
-    Warp->computeCoeff(p);
-    for(unsigned int point=0;point<templateSize;point++)
-    {
-      i=ptTemplate[point].y;
-      j=ptTemplate[point].x;
-      X1[0]=j;X1[1]=i;
-
-      Warp->computeDenom(X1,p);
-      Warp->warpX(X1,X2,p);
+    unsigned int Nbpoint=computeWarpedTemplate(I,p);
+    if(Nbpoint==0) {
+      throw(vpTrackingException(vpTrackingException::notEnoughPointError, "No points in the template"));
+    }
 
-      j2=X2[0];i2=X2[1];
-      if((i2>=0)&&(j2>=0)&&(i2<I.getHeight()-1)&&(j2<I.getWidth()-1))
+    for(unsigned int point=0;point<nbPoints;point++)
+    {
+      if(pts.inside[point])
       {
         //INVERSE
-        Tij=ptTemplate[point].val;
-        if(!blur)
-          IW=I.getValue(i2,j2);
-        else
-          IW=BI.getValue(i2,j2);
-        Nbpoint++;
-        double er=(Tij-IW);
-        for(unsigned int it=0;it<nbParam;it++)
-          GInv[it]+=er*ptTemplate[point].dW[it];
-
-        erreur+=er*er;
+        er[point]=pts.val[point]-pts.Iw[point];
 
         //DIRECT
-        //dIWx=dIx.getValue(i2,j2);
-        //dIWy=dIy.getValue(i2,j2);
-
-        dIWx=dIx.getValue(i2,j2)+ptTemplate[point].dx;
-        dIWy=dIy.getValue(i2,j2)+ptTemplate[point].dy;
+        j2=pts.x2[point];i2=pts.y2[point];
+        dIWx=dIx.getValue(i2,j2)+pts.dx[point];
+        dIWy=dIy.getValue(i2,j2)+pts.dy[point];
 
         //Calcul du Hessien
-        //Warp->dWarp(X1,X2,p,dW);
-        Warp->dWarpCompo(X1,X2,p,ptTemplateCompo[point].dW,dW);
-
-        double *tempt=new double[nbParam];
-        for(unsigned int it=0;it<nbParam;it++)
-          tempt[it]=dW[0][it]*dIWx+dW[1][it]*dIWy;
+        X1[0]=pts.x[point];X1[1]=pts.y[point];
+        X2[0]=j2;X2[1]=i2;
+        Warp->computeDenom(X1,p);
+        Warp->dWarpCompo(X1,X2,p,&pts.dWdp0[point*2*nbParam],dW);
 
         for(unsigned int it=0;it<nbParam;it++)
-          for(unsigned int jt=0;jt<nbParam;jt++)
-            HDir[it][jt]+=tempt[it]*tempt[jt];
-
+          tempt[it*nbPoints+point]=dW[0][it]*dIWx+dW[1][it]*dIWy;
+      }
+      else
+      {
+        er[point]=0.;
         for(unsigned int it=0;it<nbParam;it++)
-          GDir[it]+=er*tempt[it];
-        delete[] tempt;
+          tempt[it*nbPoints+point]=0.;
       }
+    }
 
-
+    unsigned int k=0;
+    for(unsigned int it=0;it<nbParam;it++,k++)
+    {
+      a[k]=&er[0];b[k]=pts.getSD(it);
     }
-    if(Nbpoint==0) {
-      //std::cout<<"plus de point dans template suivi"<<std::endl;
-      throw(vpTrackingException(vpTrackingException::notEnoughPointError, "No points in the template"));
+    a[k]=b[k]=&er[0];k++;
+    for(unsigned int it=0;it<nbParam;it++,k++)
+    {
+      a[k]=&er[0];b[k]=&tempt[it*nbPoints];
     }
+    for(unsigned int it=0;it<nbParam;it++)
+      for(unsigned int jt=it;jt<nbParam;jt++,k++)
+      {
+        a[k]=&tempt[it*nbPoints];b[k]=&tempt[jt*nbPoints];
+      }
+    sumProducts(a,b,nbPoints,&sums[0]);
+
+    k=0;
+    for(unsigned int it=0;it<nbParam;it++,k++)
+      GInv[it]=sums[k];
+    double erreur=sums[k++];
+    for(unsigned int it=0;it<nbParam;it++,k++)
+      GDir[it]=sums[k];
+    for(unsigned int it=0;it<nbParam;it++)
+      for(unsigned int jt=it;jt<nbParam;jt++,k++)
+        HDir[it][jt]=HDir[jt][it]=sums[k];
 
     vpMatrix::computeHLM(HDir,lambdaDep,HLMDir);
 
@@ -50,27 +50,42 @@ vpTemplateTrackerSSDInverseCompositional::vpTemplateTrackerSSDInverseComposition
 
 void vpTemplateTrackerSSDInverseCompositional::initCompInverse(const vpImage<unsigned char> &/*I*/)
 {
-
-  H=0;
-  int i,j;
-
+  // Points used to compute the displacement
+  std::vector<unsigned int> points;
   for(unsigned int point=0;point<templateSize;point++)
   {
     if((!useTemplateSelect)||(ptTemplateSelect[point]))
-    {
-      i=ptTemplate[point].y;
-      j=ptTemplate[point].x;
-      X1[0]=j;X1[1]=i;
-      Warp->computeDenom(X1,p);
-      ptTemplate[point].dW=new double[nbParam];
+      points.push_back(point);
+  }
+  const unsigned int nbPoints=(unsigned int)points.size();
 
-      Warp->getdW0(i,j,ptTemplate[point].dy,ptTemplate[point].dx,ptTemplate[point].dW);
+  if(ptTemplateSoA==NULL)
+    ptTemplateSoA=new vpTemplateTrackerPointSoA;
+  vpTemplateTrackerPointSoA &pts=*ptTemplateSoA;
+  pts.x.resize(nbPoints);
+  pts.y.resize(nbPoints);
+  pts.val.resize(nbPoints);
+  pts.sd.resize(nbPoints*nbParam);
 
-      for(unsigned int it=0;it<nbParam;it++)
-        for(unsigned int jt=0;jt<nbParam;jt++)
-          H[it][jt]+=ptTemplate[point].dW[it]*ptTemplate[point].dW[jt];
-    }
+  H=0;
+  int i,j;
+  std::vector<double> dWpts(nbPoints*nbParam);
 
+  for(unsigned int n=0;n<nbPoints;n++)
+  {
+    const vpTemplateTrackerPoint &pt=ptTemplate[points[n]];
+    i=pt.y;
+    j=pt.x;
+    pts.x[n]=j;pts.y[n]=i;pts.val[n]=pt.val;
+    X1[0]=j;X1[1]=i;
+    Warp->computeDenom(X1,p);
+    double *dWpt=&dWpts[n*nbParam];
+
+    Warp->getdW0(i,j,pt.dy,pt.dx,dWpt);
+
+    for(unsigned int it=0;it<nbParam;it++)
+      for(unsigned int jt=0;jt<nbParam;jt++)
+        H[it][jt]+=dWpt[it]*dWpt[jt];
   }
   HInv=H;
   vpMatrix HLMtemp(nbParam,nbParam);
@@ -78,25 +93,19 @@ void vpTemplateTrackerSSDInverseCompositional::initCompInverse(const vpImage<uns
 
   HCompInverse.resize(nbParam,nbParam);
   HCompInverse=HLMtemp.inverseByLU();
-  //std::cout<<Hinverse<<std::endl;
   vpColVector dWtemp(nbParam);
   vpColVector HiGtemp(nbParam);
 
-  for(unsigned int point=0;point<templateSize;point++)
+  // Steepest descent images, one row per parameter
+  for(unsigned int n=0;n<nbPoints;n++)
   {
-    if((!useTemplateSelect)||(ptTemplateSelect[point]))
-    {
-      //i=ptTemplate[point].y;
-      //j=ptTemplate[point].x;
-      for(unsigned int it=0;it<nbParam;it++)
-        dWtemp[it]=ptTemplate[point].dW[it];
-      
-      HiGtemp	= -1.*HCompInverse*dWtemp;
-      ptTemplate[point].HiG=new double[nbParam];
-
-      for(unsigned int it=0;it<nbParam;it++)
-        ptTemplate[point].HiG[it]=HiGtemp[it];
-    }
+    for(unsigned int it=0;it<nbParam;it++)
+      dWtemp[it]=dWpts[n*nbParam+it];
+
+    HiGtemp	= -1.*HCompInverse*dWtemp;
+
+    for(unsigned int it=0;it<nbParam;it++)
+      pts.sd[it*nbPoints+n]=HiGtemp[it];
   }
   compoInitialised=true;
 }
@@ -112,59 +121,39 @@ void vpTemplateTrackerSSDInverseCompositional::trackNoPyr(const vpImage<unsigned
     vpImageFilter::filter(I, BI,fgG,taillef);
 
   vpColVector dpinv(nbParam);
-  double IW;
-  double Tij;
   unsigned int iteration=0;
-  int i,j;
-  double i2,j2;
   double alpha=2.;
-  //vpTemplateTrackerPointtest *pt;
   initPosEvalRMS(p);
 
-  vpTemplateTrackerPoint *pt;
+  vpTemplateTrackerPointSoA &pts=*ptTemplateSoA;
+  const unsigned int nbPoints=pts.size();
+  // The error is 0 for the points outside the image, so that all the points can be summed
+  std::vector<double> er(nbPoints);
+  std::vector<const double *> a(nbParam+1), b(nbParam+1);
+  std::vector<double> sums(nbParam+1);
   do
   {
-    unsigned int Nbpoint=0;
-    double erreur=0;
-    dp=0;
-    Warp->computeCoeff(p);
-    for(unsigned int point=0;point<templateSize;point++)
-    {
-      if((!useTemplateSelect)||(ptTemplateSelect[point]))
-      {
-        //pt=&ptTemplatetest[point];
-        pt=&ptTemplate[point];
-        i=pt->y;
-        j=pt->x;
-        X1[0]=j;X1[1]=i;
-        Warp->computeDenom(X1,p);
-        Warp->warpX(X1,X2,p);
-        j2=X2[0];i2=X2[1];
-
-        if((i2>=0)&&(j2>=0)&&(i2<I.getHeight()-1)&&(j2<I.getWidth()-1))
-        {
-          Tij=pt->val;
-          if(!blur)
-            IW=I.getValue(i2,j2);
-          else
-            IW=BI.getValue(i2,j2);
-          Nbpoint++;
-          double er=(Tij-IW);
-          for(unsigned int it=0;it<nbParam;it++)
-            dp[it]+=er*pt->HiG[it];
-
-          erreur+=er*er;
-        }
-      }
-    }
-    //std::cout << "npoint: " << Nbpoint << std::endl;
+    unsigned int Nbpoint=computeWarpedTemplate(I,p);
     if(Nbpoint==0) {
-      //std::cout<<"plus de point dans template suivi"<<std::endl;
       deletePosEvalRMS();
       throw(vpTrackingException(vpTrackingException::notEnoughPointError, "No points in the template"));
     }
+    for(unsigned int n=0;n<nbPoints;n++)
+      er[n]=pts.inside[n] ? pts.val[n]-pts.Iw[n] : 0.;
+
+    // dp = sum(er*HiG), erreur = sum(er*er)
+    for(unsigned int it=0;it<nbParam;it++)
+    {
+      a[it]=&er[0];
+      b[it]=pts.getSD(it);
+    }
+    a[nbParam]=b[nbParam]=&er[0];
+    sumProducts(a,b,nbPoints,&sums[0]);
+    for(unsigned int it=0;it<nbParam;it++)
+      dp[it]=sums[it];
+    double erreur=sums[nbParam];
+
     dp=gain*dp;
-    //std::cout<<erreur/Nbpoint<<","<<GetCost(I,p)<<std::endl;
     if(useBrent)
     {
       alpha=2.;
@@ -176,8 +165,6 @@ void vpTemplateTrackerSSDInverseCompositional::trackNoPyr(const vpImage<unsigned
     iteration++;
 
     computeEvalRMS(p);
-    //std::cout << "iteration: " << iteration << " max: " << iterationMax << std::endl;
-    //std::cout << "evolRMS: " <<  evolRMS << " threshold: " << threshold_RMS << std::endl;
   }
   while(/*( erreur_prec-erreur<50) &&*/ (iteration < iterationMax)&&(evolRMS>threshold_RMS));
 
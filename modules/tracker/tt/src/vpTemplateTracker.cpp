@@ -37,16 +37,142 @@
  *
  *****************************************************************************/
 
+#include <visp3/core/vpThreadPool.h>
 #include <visp3/tt/vpTemplateTracker.h>
 #include <visp3/tt/vpTemplateTrackerBSpline.h>
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+namespace {
+  //! Value returned by vpImage<Type>::getValue() for an interpolated value
+  inline double toImageValue(const double value, const unsigned char *) { return (double)(unsigned char)vpMath::round(value); }
+  inline double toImageValue(const double value, const double *) { return value; }
+
+  /*
+    Interpolation of vpImage<Type>::getValue() for a point (i, j) that satisfies
+    0 <= i < height-1 and 0 <= j < width-1, so that no clamping is needed.
+  */
+  template<class Type>
+  inline double getValueInside(const vpImage<Type> &I, const double i, const double j)
+  {
+    const unsigned int iround = (unsigned int)i, jround = (unsigned int)j;
+    const double rratio = i - (double)iround, cratio = j - (double)jround;
+    const double rfrac = 1.0 - rratio, cfrac = 1.0 - cratio;
+    const Type *r0 = I[iround] + jround, *r1 = I[iround + 1] + jround;
+    const double value = ((double)r0[0] * rfrac + (double)r1[0] * rratio) * cfrac
+        + ((double)r0[1] * rfrac + (double)r1[1] * rratio) * cratio;
+    return toImageValue(value, r0);
+  }
+
+  //! Test of the warped points against the image borders and bilinear interpolation of the image
+  template<class Type>
+  class vpWarpedTemplateTask : public vpThreadPool::Task
+  {
+  public:
+    vpWarpedTemplateTask(const vpImage<Type> &I, const unsigned int height, const unsigned int width,
+                         vpTemplateTrackerPointSoA &pts)
+      : m_I(I), m_imax(height - 1), m_jmax(width - 1), m_pts(pts) {}
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      const double *x2 = &m_pts.x2[0], *y2 = &m_pts.y2[0];
+      unsigned char *inside = &m_pts.inside[0];
+      double *Iw = &m_pts.Iw[0];
+      for (unsigned int n = begin; n < end; n++) {
+        const double i2 = y2[n], j2 = x2[n];
+        inside[n] = ((i2 >= 0) && (j2 >= 0) && (i2 < m_imax) && (j2 < m_jmax)) ? 1 : 0;
+      }
+
+      unsigned int n = begin;
+#if VISP_HAVE_SSE2
+      // Two points at a time, with the operations of getValueInside() in the same order
+      const __m128d one = _mm_set1_pd(1.0);
+      for (; n + 1 < end; n += 2) {
+        if (! inside[n] || ! inside[n + 1])
+          break;
+        const __m128d vi = _mm_loadu_pd(y2 + n), vj = _mm_loadu_pd(x2 + n);
+        const __m128i ii = _mm_cvttpd_epi32(vi), jj = _mm_cvttpd_epi32(vj);
+        const int i0 = _mm_cvtsi128_si32(ii), i1 = _mm_cvtsi128_si32(_mm_shuffle_epi32(ii, 1));
+        const int j0 = _mm_cvtsi128_si32(jj), j1 = _mm_cvtsi128_si32(_mm_shuffle_epi32(jj, 1));
+        const Type *a0 = m_I[i0] + j0, *b0 = m_I[i0 + 1] + j0;
+        const Type *a1 = m_I[i1] + j1, *b1 = m_I[i1 + 1] + j1;
+
+        const __m128d rratio = _mm_sub_pd(vi, _mm_cvtepi32_pd(ii)), cratio = _mm_sub_pd(vj, _mm_cvtepi32_pd(jj));
+        const __m128d rfrac = _mm_sub_pd(one, rratio), cfrac = _mm_sub_pd(one, cratio);
+        const __m128d p00 = _mm_set_pd((double)a1[0], (double)a0[0]), p10 = _mm_set_pd((double)b1[0], (double)b0[0]);
+        const __m128d p01 = _mm_set_pd((double)a1[1], (double)a0[1]), p11 = _mm_set_pd((double)b1[1], (double)b0[1]);
+        const __m128d c0 = _mm_add_pd(_mm_mul_pd(p00, rfrac), _mm_mul_pd(p10, rratio));
+        const __m128d c1 = _mm_add_pd(_mm_mul_pd(p01, rfrac), _mm_mul_pd(p11, rratio));
+        double value[2];
+        _mm_storeu_pd(value, _mm_add_pd(_mm_mul_pd(c0, cfrac), _mm_mul_pd(c1, cratio)));
+        Iw[n] = toImageValue(value[0], a0);
+        Iw[n + 1] = toImageValue(value[1], a0);
+      }
+#endif
+      for (; n < end; n++)
+        Iw[n] = inside[n] ? getValueInside(m_I, y2[n], x2[n]) : 0.;
+    }
+
+  private:
+    const vpImage<Type> &m_I;
+    const double m_imax, m_jmax;
+    vpTemplateTrackerPointSoA &m_pts;
+  };
+
+  //! Sums of the products of two arrays, each sum being computed in the order of the points
+  class vpSumProductsTask : public vpThreadPool::Task
+  {
+  public:
+    vpSumProductsTask(const std::vector<const double *> &a, const std::vector<const double *> &b,
+                      const unsigned int n, double *sums)
+      : m_a(a), m_b(b), m_n(n), m_sums(sums) {}
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      unsigned int k = begin;
+      // Four independent sums in the same loop
+      for (; k + 4 <= end; k += 4) {
+        const double *a0 = m_a[k], *a1 = m_a[k + 1], *a2 = m_a[k + 2], *a3 = m_a[k + 3];
+        const double *b0 = m_b[k], *b1 = m_b[k + 1], *b2 = m_b[k + 2], *b3 = m_b[k + 3];
+        double s0 = 0., s1 = 0., s2 = 0., s3 = 0.;
+        for (unsigned int i = 0; i < m_n; i++) {
+          s0 += a0[i] * b0[i];
+          s1 += a1[i] * b1[i];
+          s2 += a2[i] * b2[i];
+          s3 += a3[i] * b3[i];
+        }
+        m_sums[k] = s0;
+        m_sums[k + 1] = s1;
+        m_sums[k + 2] = s2;
+        m_sums[k + 3] = s3;
+      }
+      for (; k < end; k++) {
+        const double *a = m_a[k], *b = m_b[k];
+        double sum = 0.;
+        for (unsigned int i = 0; i < m_n; i++)
+          sum += a[i] * b[i];
+        m_sums[k] = sum;
+      }
+    }
+
+  private:
+    const std::vector<const double *> &m_a, &m_b;
+    const unsigned int m_n;
+    double *m_sums;
+  };
+}
+
 vpTemplateTracker::vpTemplateTracker(vpTemplateTrackerWarp *_warp)
   : nbLvlPyr(1), l0Pyr(0), pyrInitialised(false), ptTemplate(NULL), ptTemplatePyr(NULL),
     ptTemplateInit(false), templateSize(0), templateSizePyr(NULL),
     ptTemplateSelect(NULL), ptTemplateSelectPyr(NULL), ptTemplateSelectInit(false),
     templateSelectSize(0), ptTemplateSupp(NULL), ptTemplateSuppPyr(NULL),
-    ptTemplateCompo(NULL), ptTemplateCompoPyr(NULL), zoneTracked(NULL), zoneTrackedPyr(NULL),
-    pyr_IDes(NULL), H(), Hdesire(), HdesirePyr(), HLM(), HLMdesire(), HLMdesirePyr(),
+    ptTemplateCompo(NULL), ptTemplateCompoPyr(NULL), ptTemplateSoA(NULL), ptTemplateSoAPyr(NULL),
+    zoneTracked(NULL), zoneTrackedPyr(NULL),
+    pyr_IDes(NULL), pyr_I(), H(), Hdesire(), HdesirePyr(), HLM(), HLMdesire(), HLMdesirePyr(),
     HLMdesireInverse(), HLMdesireInversePyr(), G(), gain(1.), thresholdGradient(40),
     costFunctionVerification(false), blur(true), useBrent(false), nbIterBrent(3),
     taillef(7), fgG(NULL), fgdG(NULL), ratioPixelIn(0), mod_i(1), mod_j(1), nbParam(0),
@@ -212,6 +338,14 @@ void vpTemplateTracker::resetTracker()
       ptTemplateCompoPyr = NULL;
     }
 
+    if (ptTemplateSoAPyr) {
+      for(unsigned int i=0;i<nbLvlPyr;i++)
+        delete ptTemplateSoAPyr[i];
+      delete[] ptTemplateSoAPyr;
+      ptTemplateSoAPyr = NULL;
+    }
+    ptTemplateSoA = NULL;
+
     if (ptTemplateSuppPyr) {
       for(unsigned int i=0;i<nbLvlPyr;i++)
       {
@@ -291,6 +425,10 @@ void vpTemplateTracker::resetTracker()
       delete[] ptTemplateCompo;
       ptTemplateCompo = NULL;
     }
+    if (ptTemplateSoA) {
+      delete ptTemplateSoA;
+      ptTemplateSoA = NULL;
+    }
     if (ptTemplateSupp) {
       for(unsigned int point=0;point<templateSize;point++)
       {
@@ -613,11 +751,13 @@ void vpTemplateTracker::initPyramidal(unsigned int nbLvl, unsigned int l0)
   ptTemplateSelectPyr=new bool*[nbLvlPyr];
   ptTemplateSuppPyr=new vpTemplateTrackerPointSuppMIInv*[nbLvlPyr];
   ptTemplateCompoPyr=new vpTemplateTrackerPointCompo*[nbLvlPyr];
+  ptTemplateSoAPyr=new vpTemplateTrackerPointSoA*[nbLvlPyr];
   for(unsigned int i=0; i< nbLvlPyr; i++) {
     ptTemplatePyr[i]       = NULL;
     ptTemplateSuppPyr[i]   = NULL;
     ptTemplateSelectPyr[i] = NULL;
     ptTemplateCompoPyr[i]  = NULL;
+    ptTemplateSoAPyr[i]    = NULL;
   }
   templateSizePyr=new unsigned int[nbLvlPyr];
   HdesirePyr=new vpMatrix[nbLvlPyr];
@@ -758,11 +898,13 @@ void vpTemplateTracker::initHessienDesiredPyr(const vpImage<unsigned char> &I)
   //ptTemplateCompo=ptTemplateCompoPyr[0];
   ptTemplate=ptTemplatePyr[0];
   ptTemplateSelect=ptTemplateSelectPyr[0];
+  ptTemplateSoA=ptTemplateSoAPyr[0];
 //  ptTemplateSupp=new vpTemplateTrackerPointSuppMIInv[templateSize];
   try{
       initHessienDesired(I);
       ptTemplateSuppPyr[0]=ptTemplateSupp;
       ptTemplateCompoPyr[0]=ptTemplateCompo;
+      ptTemplateSoAPyr[0]=ptTemplateSoA;
       HdesirePyr[0]=Hdesire;
       HLMdesirePyr[0]=HLMdesire;
       HLMdesireInversePyr[0]=HLMdesireInverse;
@@ -770,6 +912,7 @@ void vpTemplateTracker::initHessienDesiredPyr(const vpImage<unsigned char> &I)
   catch(vpException &e){
       ptTemplateSuppPyr[0]=ptTemplateSupp;
       ptTemplateCompoPyr[0]=ptTemplateCompo;
+      ptTemplateSoAPyr[0]=ptTemplateSoA;
       HdesirePyr[0]=Hdesire;
       HLMdesirePyr[0]=HLMdesire;
       HLMdesireInversePyr[0]=HLMdesireInverse;
@@ -786,12 +929,14 @@ void vpTemplateTracker::initHessienDesiredPyr(const vpImage<unsigned char> &I)
       templateSize=templateSizePyr[i];
       ptTemplate=ptTemplatePyr[i];
       ptTemplateSelect=ptTemplateSelectPyr[i];
+      ptTemplateSoA=ptTemplateSoAPyr[i];
       //ptTemplateSupp=ptTemplateSuppPyr[i];
       //ptTemplateCompo=ptTemplateCompoPyr[i];
       try{
         initHessienDesired(Itemp);
         ptTemplateSuppPyr[i]=ptTemplateSupp;
         ptTemplateCompoPyr[i]=ptTemplateCompo;
+        ptTemplateSoAPyr[i]=ptTemplateSoA;
         HdesirePyr[i]=Hdesire;
         HLMdesirePyr[i]=HLMdesire;
         HLMdesireInversePyr[i]=HLMdesireInverse;
@@ -799,6 +944,7 @@ void vpTemplateTracker::initHessienDesiredPyr(const vpImage<unsigned char> &I)
       catch(vpException &e){
           ptTemplateSuppPyr[i]=ptTemplateSupp;
           ptTemplateCompoPyr[i]=ptTemplateCompo;
+          ptTemplateSoAPyr[i]=ptTemplateSoA;
           HdesirePyr[i]=Hdesire;
           HLMdesirePyr[i]=HLMdesire;
           HLMdesireInversePyr[i]=HLMdesireInverse;
@@ -824,23 +970,20 @@ void vpTemplateTracker::track(const vpImage<unsigned char> &I)
 void vpTemplateTracker::trackPyr(const vpImage<unsigned char> &I)
 {
   //vpTRACE("trackPyr");
-  vpImage<unsigned char> *pyr_I;
-//  pyr_I=new vpImage<unsigned char>[nbLvlPyr+1]; // Why +1 ?
-  pyr_I=new vpImage<unsigned char>[nbLvlPyr]; // Why +1 ?
-  pyr_I[0]=I;
-
   try
   {
       vpColVector ptemp(nbParam);
       if(nbLvlPyr>1)
       {
+        // The levels are reused from one image to the next one
+        pyr_I.setNbLevels(nbLvlPyr);
+        pyr_I.build(I);
     //    vpColVector *p_sauv=new vpColVector[nbLvlPyr];
     //    for(unsigned int i=0;i<nbLvlPyr;i++)p_sauv[i].resize(nbParam);
 
     //    p_sauv[0]=p;
         for(unsigned int i=1;i<nbLvlPyr;i++)
         {
-          vpImageFilter::getGaussPyramidal(pyr_I[i-1],pyr_I[i]);
           //test getParamPyramidDown
           /*vpColVector vX_test(2);vX_test[0]=15.;vX_test[1]=30.;
           vpColVector vX_test2(2);
@@ -874,6 +1017,7 @@ void vpTemplateTracker::trackPyr(const vpImage<unsigned char> &I)
             ptTemplateSelect=ptTemplateSelectPyr[i];
             ptTemplateSupp=ptTemplateSuppPyr[i];
             ptTemplateCompo=ptTemplateCompoPyr[i];
+            ptTemplateSoA=ptTemplateSoAPyr[i];
             H=HdesirePyr[i];
             HLM=HLMdesirePyr[i];
             HLMdesireInverse=HLMdesireInversePyr[i];
@@ -918,10 +1062,8 @@ void vpTemplateTracker::trackPyr(const vpImage<unsigned char> &I)
         //std::cout<<"reviens a tracker de base"<<std::endl;
         trackRobust(I);
       }
-      delete[] pyr_I;
   }
   catch(vpException &e){
-      delete[] pyr_I;
       throw(vpTrackingException(vpTrackingException::badValue, e.getMessage()));
   }
 }
@@ -945,3 +1087,61 @@ void vpTemplateTracker::trackRobust(const vpImage<unsigned char> &I)
   else
     trackNoPyr(I);
 }
+
+/*!
+  Warp the points of the template stored in ptTemplateSoA with the parameters
+  \e tp, and get the gray level of the image at the warped points. The points
+  are warped in one pass by vpTemplateTrackerWarp::warp(), then the bilinear
+  interpolation is done on the threads of vpThreadPool.
+
+  \param I : Current image. If the blur is enabled, the gray levels are taken
+  in the blurred image BI.
+  \param tp : Parameters of the warp.
+
+  \return Number of warped points inside the image. The points outside the image
+  have their inside flag set to 0 and a gray level of 0.
+*/
+unsigned int vpTemplateTracker::computeWarpedTemplate(const vpImage<unsigned char> &I, const vpColVector &tp)
+{
+  vpTemplateTrackerPointSoA &pts = *ptTemplateSoA;
+  const unsigned int n = pts.size();
+  pts.x2.resize(n);
+  pts.y2.resize(n);
+  pts.Iw.resize(n);
+  pts.inside.resize(n);
+  if (n == 0)
+    return 0;
+
+  Warp->warp(&pts.x[0], &pts.y[0], (int)n, tp, &pts.x2[0], &pts.y2[0]);
+
+  if (blur) {
+    vpWarpedTemplateTask<double> task(BI, I.getHeight(), I.getWidth(), pts);
+    vpThreadPool::getInstance().parallelFor(0, n, task, 2048);
+  }
+  else {
+    vpWarpedTemplateTask<unsigned char> task(I, I.getHeight(), I.getWidth(), pts);
+    vpThreadPool::getInstance().parallelFor(0, n, task, 2048);
+  }
+
+  unsigned int nbInside = 0;
+  for (unsigned int i = 0; i < n; i++)
+    nbInside += pts.inside[i];
+  return nbInside;
+}
+
+/*!
+  Compute the sums \f$ sums[k] = \sum_{i<n} a[k][i] b[k][i] \f$. The sums are
+  distributed over the threads of vpThreadPool, each one being accumulated in
+  the order of the points so that the result does not depend on the number of
+  threads.
+
+  \param a, b : Arrays of \e n values, a.size() == b.size().
+  \param n : Number of values in each array.
+  \param sums : Resulting sums, a.size() values.
+*/
+void vpTemplateTracker::sumProducts(const std::vector<const double *> &a, const std::vector<const double *> &b,
+                                    const unsigned int n, double *sums) const
+{
+  vpSumProductsTask task(a, b, n, sums);
+  vpThreadPool::getInstance().parallelFor(0, (unsigned int)a.size(), task, 4);
+}
@@ -121,6 +121,23 @@ void vpTemplateTrackerWarpHomography::warpX(const vpColVector &vX,vpColVector &v
     throw(vpTrackingException(vpTrackingException::fatalError,"Division by zero in vpTemplateTrackerWarpHomography::warpX()"));
 }
 
+void vpTemplateTrackerWarpHomography::warp(const double *ut0,const double *vt0,int nb_pt,const vpColVector& ParamM,double *u,double *v)
+{
+  const double a00=1+ParamM[0], a01=ParamM[3], a02=ParamM[6];
+  const double a10=ParamM[1], a11=1+ParamM[4], a12=ParamM[7];
+  for(int i=0;i<nb_pt;i++)
+  {
+    denom=(1./(ParamM[2]*ut0[i]+ParamM[5]*vt0[i]+1.));
+    if(denom>0)
+    {
+      u[i]=(a00*ut0[i]+a01*vt0[i]+a02)*denom;
+      v[i]=(a10*ut0[i]+a11*vt0[i]+a12)*denom;
+    }
+    else
+      throw(vpTrackingException(vpTrackingException::fatalError,"Division by zero in vpTemplateTrackerWarpHomography::warp()"));
+  }
+}
+
 void vpTemplateTrackerWarpHomography::dWarp(const vpColVector &X1,const vpColVector &X2,const vpColVector &/*ParamM*/,vpMatrix &dW_)
 {
   double j=X1[0];
@@ -94,6 +94,17 @@ void vpTemplateTrackerWarpRT::warpX(const vpColVector &vX,vpColVector &vXres,con
   vXres[1]=(sin(ParamM[0])*vX[0]) + (cos(ParamM[0])*vX[1]) + ParamM[2];
 }
 
+void vpTemplateTrackerWarpRT::warp(const double *ut0,const double *vt0,int nb_pt,const vpColVector& ParamM,double *u,double *v)
+{
+  const double c=cos(ParamM[0]);
+  const double s=sin(ParamM[0]);
+  for(int i=0;i<nb_pt;i++)
+  {
+    u[i]=(c*ut0[i]) - (s*vt0[i]) + ParamM[1];
+    v[i]=(s*ut0[i]) + (c*vt0[i]) + ParamM[2];
+  }
+}
+
 void vpTemplateTrackerWarpRT::dWarp(const vpColVector &X1,const vpColVector &/*X2*/,const vpColVector &ParamM,vpMatrix &dW_)
 {
   double j=X1[0];
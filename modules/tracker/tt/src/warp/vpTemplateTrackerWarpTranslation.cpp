@@ -89,6 +89,15 @@ void vpTemplateTrackerWarpTranslation::warpX(const vpColVector &vX,vpColVector &
   vXres[1]=vX[1]+ParamM[1];
 }
 
+void vpTemplateTrackerWarpTranslation::warp(const double *ut0,const double *vt0,int nb_pt,const vpColVector& ParamM,double *u,double *v)
+{
+  for(int i=0;i<nb_pt;i++)
+  {
+    u[i]=ut0[i]+ParamM[0];
+    v[i]=vt0[i]+ParamM[1];
+  }
+}
+
 void vpTemplateTrackerWarpTranslation::dWarp(const vpColVector &/*X1*/,const vpColVector &/*X2*/,const vpColVector &/*ParamM*/,
                                              vpMatrix &dW_)
 {
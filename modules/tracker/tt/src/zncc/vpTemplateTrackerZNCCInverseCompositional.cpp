@@ -54,22 +54,34 @@ void vpTemplateTrackerZNCCInverseCompositional::initCompInverse(const vpImage<un
   vpImageFilter::getGradXGauss2D(I, dIx, fgG,fgdG,taillef);
   vpImageFilter::getGradYGauss2D(I, dIy, fgG,fgdG,taillef);
 
+  if(ptTemplateSoA==NULL)
+    ptTemplateSoA=new vpTemplateTrackerPointSoA;
+  vpTemplateTrackerPointSoA &pts=*ptTemplateSoA;
+  pts.x.resize(templateSize);
+  pts.y.resize(templateSize);
+  pts.val.resize(templateSize);
+  pts.sd.resize(templateSize*nbParam);
+
+  double *dWpt=new double[nbParam];
   for(unsigned int point=0;point<templateSize;point++)
   {
     int i=ptTemplate[point].y;
     int j=ptTemplate[point].x;
+    pts.x[point]=j;pts.y[point]=i;pts.val[point]=ptTemplate[point].val;
 
     X1[0]=j;X1[1]=i;
     Warp->computeDenom(X1,p);
-    ptTemplate[point].dW=new double[nbParam];
 
     double dx=ptTemplate[point].dx;
     double dy=ptTemplate[point].dy;
-    //std::cout<<ptTemplate[point].dx<<","<<ptTemplate[point].dy<<std::endl;
 
-    Warp->getdW0(i,j,dy,dx,ptTemplate[point].dW);
+    Warp->getdW0(i,j,dy,dx,dWpt);
 
+    // Steepest descent images, one row per parameter
+    for(unsigned int it=0;it<nbParam;it++)
+      pts.sd[it*templateSize+point]=dWpt[it];
   }
+  delete[] dWpt;
   //vpTRACE("fin Comp Inverse");
   compoInitialised=true;
 }
@@ -90,6 +102,7 @@ void vpTemplateTrackerZNCCInverseCompositional::initHessienDesired(const vpImage
   vpImageFilter::getGradX(dIy, dIyx, fgdG,taillef);
   vpImageFilter::getGradY(dIy, dIyy, fgdG,taillef);
 
+  const vpTemplateTrackerPointSoA &pts=*ptTemplateSoA;
   Warp->computeCoeff(p);
   double Ic,dIcx=0.,dIcy=0.;
   double Iref;
@@ -128,7 +141,7 @@ void vpTemplateTrackerZNCCInverseCompositional::initHessienDesired(const vpImage
       moyIc+=Ic;
 
       for(unsigned int it=0;it<nbParam;it++)
-        moydIrefdp[it]+=ptTemplate[point].dW[it];
+        moydIrefdp[it]+=pts.getSD(it)[point];
 
 
       Warp->dWarp(X1,X2,p,dW);
@@ -202,14 +215,14 @@ void vpTemplateTrackerZNCCInverseCompositional::initHessienDesired(const vpImage
         {
           sIcd2Iref[it][jt] +=prodIc*(dW[0][it]*(dW[0][jt]*d_Ixx+dW[1][jt]*d_Ixy)
               +dW[1][it]*(dW[0][jt]*d_Ixy+dW[1][jt]*d_Iyy)-moyd2Iref[it][jt]);
-          sdIrefdIref[it][jt] +=(ptTemplate[point].dW[it]-moydIrefdp[it])*(ptTemplate[point].dW[jt]-moydIrefdp[jt]);
+          sdIrefdIref[it][jt] +=(pts.getSD(it)[point]-moydIrefdp[it])*(pts.getSD(jt)[point]-moydIrefdp[jt]);
         }
 
 
       delete[] tempt;
 
       for(unsigned int it=0;it<nbParam;it++)
-        sIcdIref[it]+=prodIc*(ptTemplate[point].dW[it]-moydIrefdp[it]);
+        sIcdIref[it]+=prodIc*(pts.getSD(it)[point]-moydIrefdp[it]);
 
       covarIref+=(Iref-moyIref)*(Iref-moyIref);
       covarIc+=(Ic-moyIc)*(Ic-moyIc);
@@ -245,96 +258,71 @@ void vpTemplateTrackerZNCCInverseCompositional::trackNoPyr(const vpImage<unsigne
   if(blur)
     vpImageFilter::filter(I, BI,fgG,taillef);
 
-  //double erreur=0;
   vpColVector dpinv(nbParam);
-  double Ic;
-  double Iref;
   unsigned int iteration=0;
-  int i,j;
-  double i2,j2;
   initPosEvalRMS(p);
+
+  vpTemplateTrackerPointSoA &pts=*ptTemplateSoA;
+  const unsigned int nbPoints=pts.size();
+  // Steepest descent images minus their mean over the template
+  std::vector<double> sdCentered(pts.sd.size());
+  for(unsigned int it=0;it<nbParam;it++)
+  {
+    const double *sd=pts.getSD(it);
+    for(unsigned int n=0;n<nbPoints;n++)
+      sdCentered[it*nbPoints+n]=sd[n]-moydIrefdp[it];
+  }
+  // Centered gray levels, 0 for the points outside the image
+  std::vector<double> dIref(nbPoints), dIc(nbPoints);
+  std::vector<const double *> a(2*nbParam+3), b(2*nbParam+3);
+  std::vector<double> sums(2*nbParam+3);
   do
   {
-    unsigned int Nbpoint=0;
-    //erreur=0;
     G=0;
-    Warp->computeCoeff(p);
-    double moyIref=0;
-    double moyIc=0;
-    for(unsigned int point=0;point<templateSize;point++)
+    unsigned int Nbpoint=computeWarpedTemplate(I,p);
+    if(Nbpoint > 0)
     {
-      i=ptTemplate[point].y;
-      j=ptTemplate[point].x;
-      X1[0]=j;X1[1]=i;
-
-      Warp->computeDenom(X1,p);
-      Warp->warpX(X1,X2,p);
-
-      j2=X2[0];i2=X2[1];
-      if((i2>=0)&&(j2>=0)&&(i2<I.getHeight()-1)&&(j2<I.getWidth()-1))
+      double moyIref=0;
+      double moyIc=0;
+      for(unsigned int n=0;n<nbPoints;n++)
       {
-        Iref=ptTemplate[point].val;
-
-        if(!blur)
-          Ic=I.getValue(i2,j2);
-        else
-          Ic=BI.getValue(i2,j2);
-
-        Nbpoint++;
-        moyIref+=Iref;
-        moyIc+=Ic;
+        if(pts.inside[n])
+        {
+          moyIref+=pts.val[n];
+          moyIc+=pts.Iw[n];
+        }
       }
-
-
-    }
-    if(Nbpoint > 0)
-    {
       moyIref=moyIref/Nbpoint;
       moyIc=moyIc/Nbpoint;
-      double sIcIref=0;
-      double covarIref=0,covarIc=0;
-      vpColVector sIcdIref(nbParam);sIcdIref=0;
-      vpColVector sIrefdIref(nbParam);sIrefdIref=0;
-
-
-      for(unsigned int point=0;point<templateSize;point++)
+      for(unsigned int n=0;n<nbPoints;n++)
       {
-        i=ptTemplate[point].y;
-        j=ptTemplate[point].x;
-        X1[0]=j;X1[1]=i;
-
-        Warp->computeDenom(X1,p);
-        Warp->warpX(X1,X2,p);
-
-        j2=X2[0];i2=X2[1];
-        if((i2>=0)&&(j2>=0)&&(i2<I.getHeight()-1)&&(j2<I.getWidth()-1))
-        {
-          Iref=ptTemplate[point].val;
-
-          if(!blur)
-            Ic=I.getValue(i2,j2);
-          else
-            Ic=BI.getValue(i2,j2);
-
-
-          double prod=(Ic-moyIc);
-          for(unsigned int it=0;it<nbParam;it++)
-            sIcdIref[it]+=prod*(ptTemplate[point].dW[it]-moydIrefdp[it]);
-          for(unsigned int it=0;it<nbParam;it++)
-            sIrefdIref[it]+=(Iref-moyIref)*(ptTemplate[point].dW[it]-moydIrefdp[it]);
-
-          //double er=(Iref-Ic);
-          //erreur+=(er*er);
-          //denom+=(Iref-moyIref)*(Iref-moyIref)*(Ic-moyIc)*(Ic-moyIc);
-          covarIref+=(Iref-moyIref)*(Iref-moyIref);
-          covarIc+=(Ic-moyIc)*(Ic-moyIc);
-          sIcIref+=(Iref-moyIref)*(Ic-moyIc);
-        }
+        dIref[n]=pts.inside[n] ? pts.val[n]-moyIref : 0.;
+        dIc[n]=pts.inside[n] ? pts.Iw[n]-moyIc : 0.;
+      }
 
+      // sIcdIref, sIrefdIref, covarIref, covarIc and sIcIref summed over the points
+      for(unsigned int it=0;it<nbParam;it++)
+      {
+        a[it]=&dIc[0];
+        b[it]=&sdCentered[it*nbPoints];
+        a[nbParam+it]=&dIref[0];
+        b[nbParam+it]=&sdCentered[it*nbPoints];
+      }
+      a[2*nbParam]=b[2*nbParam]=&dIref[0];
+      a[2*nbParam+1]=b[2*nbParam+1]=&dIc[0];
+      a[2*nbParam+2]=&dIref[0];b[2*nbParam+2]=&dIc[0];
+      sumProducts(a,b,nbPoints,&sums[0]);
 
+      vpColVector sIcdIref(nbParam);
+      vpColVector sIrefdIref(nbParam);
+      for(unsigned int it=0;it<nbParam;it++)
+      {
+        sIcdIref[it]=sums[it];
+        sIrefdIref[it]=sums[nbParam+it];
       }
-      covarIref=sqrt(covarIref);
-      covarIc=sqrt(covarIc);
+      double covarIref=sqrt(sums[2*nbParam]);
+      double covarIc=sqrt(sums[2*nbParam+1]);
+      double sIcIref=sums[2*nbParam+2];
       double denom=covarIref*covarIc;
 
       //if(denom==0.0)
@@ -372,7 +360,6 @@ void vpTemplateTrackerZNCCInverseCompositional::trackNoPyr(const vpImage<unsigne
   }
   while( (!diverge &&(evolRMS>threshold_RMS) && (iteration < iterationMax)));
 
-  //std::cout<<"erreur "<<erreur<<std::endl;
   nbIteration=iteration;
 
   deletePosEvalRMS();
@@ -0,0 +1,252 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the SSD inverse compositional template tracker.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceTemplateTracker.cpp
+
+  \brief Check that vpTemplateTrackerSSDInverseCompositional, which warps and
+  samples the template points in batch, gives the same parameters and residuals
+  as the per-point implementation on a synthetic sequence, for the affine,
+  homography and SRT warps and with 1 or 4 threads, and measure the tracking time.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/tt/vpTemplateTrackerSSDInverseCompositional.h>
+#include <visp3/tt/vpTemplateTrackerWarpAffine.h>
+#include <visp3/tt/vpTemplateTrackerWarpHomography.h>
+#include <visp3/tt/vpTemplateTrackerWarpSRT.h>
+
+namespace {
+  /*!
+    Inverse compositional tracker that can also track with the former implementation,
+    which warps, samples and accumulates the template points one at a time.
+  */
+  class vpPerPointSSDInverseCompositional : public vpTemplateTrackerSSDInverseCompositional
+  {
+  public:
+    explicit vpPerPointSSDInverseCompositional(vpTemplateTrackerWarp *warp)
+      : vpTemplateTrackerSSDInverseCompositional(warp), HiG(), residual(0) {}
+
+    using vpTemplateTrackerSSD::getCost;
+
+    //! Steepest descent images of each template point, as computed by the former initCompInverse()
+    void initPerPoint()
+    {
+      std::vector<double> dW(templateSize * nbParam);
+      vpMatrix Hpp(nbParam, nbParam);
+      for (unsigned int point = 0; point < templateSize; point++) {
+        int i = ptTemplate[point].y;
+        int j = ptTemplate[point].x;
+        X1[0] = j; X1[1] = i;
+        Warp->computeDenom(X1, p);
+        Warp->getdW0(i, j, ptTemplate[point].dy, ptTemplate[point].dx, &dW[point * nbParam]);
+        for (unsigned int it = 0; it < nbParam; it++)
+          for (unsigned int jt = 0; jt < nbParam; jt++)
+            Hpp[it][jt] += dW[point * nbParam + it] * dW[point * nbParam + jt];
+      }
+      vpMatrix HLMtemp(nbParam, nbParam);
+      vpMatrix::computeHLM(Hpp, lambdaDep, HLMtemp);
+      vpMatrix HinvLM = HLMtemp.inverseByLU();
+
+      HiG.resize(templateSize * nbParam);
+      vpColVector dWtemp(nbParam), HiGtemp(nbParam);
+      for (unsigned int point = 0; point < templateSize; point++) {
+        for (unsigned int it = 0; it < nbParam; it++)
+          dWtemp[it] = dW[point * nbParam + it];
+        HiGtemp = -1. * HinvLM * dWtemp;
+        for (unsigned int it = 0; it < nbParam; it++)
+          HiG[point * nbParam + it] = HiGtemp[it];
+      }
+    }
+
+    //! Former trackNoPyr()
+    void trackPerPoint(const vpImage<unsigned char> &I)
+    {
+      if (blur)
+        vpImageFilter::filter(I, BI, fgG, taillef);
+
+      vpColVector dpinv(nbParam);
+      unsigned int iteration = 0;
+      initPosEvalRMS(p);
+      do {
+        unsigned int Nbpoint = 0;
+        double erreur = 0;
+        dp = 0;
+        Warp->computeCoeff(p);
+        for (unsigned int point = 0; point < templateSize; point++) {
+          vpTemplateTrackerPoint *pt = &ptTemplate[point];
+          int i = pt->y;
+          int j = pt->x;
+          X1[0] = j; X1[1] = i;
+          Warp->computeDenom(X1, p);
+          Warp->warpX(X1, X2, p);
+          double j2 = X2[0], i2 = X2[1];
+          if ((i2 >= 0) && (j2 >= 0) && (i2 < I.getHeight() - 1) && (j2 < I.getWidth() - 1)) {
+            double IW = blur ? BI.getValue(i2, j2) : I.getValue(i2, j2);
+            Nbpoint++;
+            double er = (pt->val - IW);
+            for (unsigned int it = 0; it < nbParam; it++)
+              dp[it] += er * HiG[point * nbParam + it];
+            erreur += er * er;
+          }
+        }
+        if (Nbpoint == 0)
+          throw(vpTrackingException(vpTrackingException::notEnoughPointError, "No points in the template"));
+        residual = erreur / Nbpoint;
+        dp = gain * dp;
+        Warp->getParamInverse(dp, dpinv);
+        Warp->pRondp(p, dpinv, p);
+        iteration++;
+        computeEvalRMS(p);
+      } while ((iteration < iterationMax) && (evolRMS > threshold_RMS));
+      nbIteration = iteration;
+    }
+
+    //! Mean of the squared errors of the last iteration of trackPerPoint()
+    double getResidual() const { return residual; }
+
+  private:
+    std::vector<double> HiG;
+    double residual;
+  };
+
+  //! Smooth texture
+  double texture(const double u, const double v)
+  {
+    return 128. + 50. * sin(0.11 * u + 0.05 * v) + 40. * cos(0.07 * v - 0.03 * u)
+        + 20. * sin(0.23 * u) * cos(0.19 * v);
+  }
+
+  //! Image of the texture moved by a similarity of center (320, 240)
+  void render(vpImage<unsigned char> &I, const double scale, const double angle, const double tu, const double tv)
+  {
+    const double c = cos(angle) / scale, s = sin(angle) / scale;
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        const double du = j - 320. - tu, dv = i - 240. - tv;
+        I[i][j] = (unsigned char) vpMath::round(texture(320. + c * du + s * dv, 240. - s * du + c * dv));
+      }
+    }
+  }
+
+  bool sameVector(const vpColVector &a, const vpColVector &b)
+  {
+    if (a.size() != b.size())
+      return false;
+    for (unsigned int i = 0; i < a.size(); i++) {
+      if (a[i] != b[i])
+        return false;
+    }
+    return true;
+  }
+
+  //! Track the sequence with both implementations
+  template<class Warp>
+  bool testWarp(const char *name, const unsigned int nbThreads)
+  {
+    vpThreadPool::getInstance().setNumThreads(nbThreads);
+    vpImage<unsigned char> I(480, 640);
+    render(I, 1., 0., 0., 0.);
+
+    std::vector<vpImagePoint> corners;
+    corners.push_back(vpImagePoint(140, 220));
+    corners.push_back(vpImagePoint(140, 420));
+    corners.push_back(vpImagePoint(340, 420));
+    corners.push_back(vpImagePoint(340, 220));
+
+    Warp warp, warp_ref;
+    vpPerPointSSDInverseCompositional tracker(&warp), ref(&warp_ref);
+    tracker.initFromPoints(I, corners, true);
+    ref.initFromPoints(I, corners, true);
+    ref.initPerPoint();
+
+    const unsigned int nbFrames = 10;
+    double t_batch = 0, t_per_point = 0;
+    for (unsigned int k = 1; k <= nbFrames; k++) {
+      render(I, 1. + 0.004 * k, vpMath::rad(0.6 * k), 1.2 * k, -0.8 * k);
+
+      double t = vpTime::measureTimeMs();
+      tracker.track(I);
+      t_batch += vpTime::measureTimeMs() - t;
+      t = vpTime::measureTimeMs();
+      ref.trackPerPoint(I);
+      t_per_point += vpTime::measureTimeMs() - t;
+
+      if (! sameVector(tracker.getp(), ref.getp()) || tracker.getNbIteration() != ref.getNbIteration()) {
+        std::cerr << "Frame " << k << " with the " << name << " warp and " << nbThreads
+                  << " threads: the parameters differ from those of the per-point tracker" << std::endl;
+        return false;
+      }
+      const double residual = tracker.getCost(I);
+      if (residual != ref.getCost(I)) {
+        std::cerr << "Frame " << k << " with the " << name << " warp: the residuals differ" << std::endl;
+        return false;
+      }
+      if (residual > 2. || ref.getResidual() > 2.) {
+        std::cerr << "Frame " << k << " with the " << name << " warp: the template is lost, residual "
+                  << residual << std::endl;
+        return false;
+      }
+    }
+    std::cout << name << " warp, " << nbThreads << " threads: " << t_batch / nbFrames << " ms per frame, "
+              << t_per_point / nbFrames << " ms with the per-point tracker" << std::endl;
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    for (unsigned int nbThreads = 1; nbThreads <= 4; nbThreads += 3) {
+      if (! testWarp<vpTemplateTrackerWarpAffine>("affine", nbThreads)
+          || ! testWarp<vpTemplateTrackerWarpHomography>("homography", nbThreads)
+          || ! testWarp<vpTemplateTrackerWarpSRT>("SRT", nbThreads))
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "testPerformanceTemplateTracker is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -44,6 +44,7 @@
 #include <visp3/tt/vpTemplateTracker.h>
 #include <visp3/tt/vpTemplateTrackerHeader.h>
 #include <visp3/core/vpImageFilter.h>
+#include <visp3/tt_mi/vpTemplateTrackerMIHistogram.h>
 
 /*!
   \class vpTemplateTrackerMI
@@ -111,6 +112,9 @@ protected:
   vpMatrix    covarianceMatrix;
   bool        computeCovariance;
 
+  //! Samples of the joint histogram, accumulated at once in Prt, PrtD or PrtTout
+  vpTemplateTrackerMIHistogram histogram;
+
 protected:
   void    computeGradient();
   void    computeHessien(vpMatrix &H);
@@ -122,6 +126,7 @@ protected:
   double  getNormalizedCost(const vpImage<unsigned char> &I, const vpColVector &tp);
   double  getNormalizedCost(const vpImage<unsigned char> &I){return getNormalizedCost(I,p);}
   virtual void    initHessienDesired(const vpImage<unsigned char> &I)=0;
+  void    initTemplateSoA();
   virtual void    trackNoPyr(const vpImage<unsigned char> &I)=0;
   void    zeroProbabilities();
 
@@ -150,7 +155,7 @@ public:
       temp(NULL), Prt(NULL), dPrt(NULL), Pt(NULL), Pr(NULL), d2Prt(NULL), PrtTout(NULL),
       dprtemp(NULL), PrtD(NULL), dPrtD(NULL), influBspline(0), bspline(0), Nc(0), Ncb(0),
       d2Ix(), d2Iy(), d2Ixy(), MI_preEstimation(0), MI_postEstimation(0),
-      NMI_preEstimation(0), NMI_postEstimation(0), covarianceMatrix(), computeCovariance(false)
+      NMI_preEstimation(0), NMI_postEstimation(0), covarianceMatrix(), computeCovariance(false), histogram()
   {}
   vpTemplateTrackerMI(vpTemplateTrackerWarp *_warp);
   ~vpTemplateTrackerMI();
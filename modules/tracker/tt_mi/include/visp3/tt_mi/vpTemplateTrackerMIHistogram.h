@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Joint histogram of the mutual information template trackers.
+ *
+ *****************************************************************************/
+/*!
+ \file vpTemplateTrackerMIHistogram.h
+ \brief Joint histogram and its derivatives computed by B-spline Parzen windowing.
+*/
+
+#ifndef vpTemplateTrackerMIHistogram_hh
+#define vpTemplateTrackerMIHistogram_hh
+
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/*
+  Accumulation of the joint histogram of the mutual information trackers, and
+  of its first and second derivatives with respect to the warp parameters.
+
+  The trackers add one sample per point of the template that is in the image,
+  then computePrt() accumulates all the samples at once:
+  - the samples are split into blocks of fixed size. Each block is accumulated
+    by a task of vpThreadPool in its own partial histogram, and the partial
+    histograms are then summed in the order of the blocks. The result only
+    depends on the order of the samples, not on the number of threads;
+  - the derivatives of the B-spline weights of the columns of the histogram
+    are polynomials of the residual et. Rather than adding its derivatives to
+    its bspline*bspline bins, a sample adds dW*et^k and dW*dW^T*et^k, weighted
+    by the B-spline of the rows, to the first column of its bins only. These
+    sums are expanded to the other columns at the end. With a third order
+    B-spline, the second derivative of the B-spline is constant and each
+    sample adds its second derivatives to 3 bins instead of 9;
+  - the second derivatives are symmetric, only their upper triangle is
+    accumulated, two values at a time with SSE2 when available.
+
+  The result is the same as the one of the functions of
+  vpTemplateTrackerMIBSpline called point by point, up to rounding, except
+  that PutTotPVBspline4() and PutTotPVBspline3NoSecond() put a sample one
+  column to the left of the other functions: the bins of a sample start at
+  column ct for all the B-spline orders and contribution types.
+*/
+class VISP_EXPORT vpTemplateTrackerMIHistogram
+{
+public:
+  //! What a sample adds to the histogram
+  typedef enum {
+    PRT,            //!< The joint probability only
+    PRT_DPRT,       //!< The joint probability and its first derivatives
+    PRT_DPRT_D2PRT  //!< The joint probability and its first and second derivatives
+  } vpContributionType;
+
+  vpTemplateTrackerMIHistogram();
+
+  void add(const int cr, const double er, const int ct, const double et, const double *dW,
+           const vpContributionType type);
+  void computePrt(double *Prt, double *dPrt, double *d2Prt, const int nbPoints);
+  void reset(const int bspline, const int Nc, const unsigned int nbParam);
+  //! Number of samples.
+  unsigned int size() const { return (unsigned int)m_samples.size(); }
+
+private:
+  //! Bins and residuals of a sample, with the index of its derivatives in m_dW
+  struct vpSample {
+    int cr, ct;
+    double er, et;
+    unsigned int dWIndex;
+    int type;
+  };
+
+  int m_bspline;
+  int m_Nc;
+  unsigned int m_nbParam;
+  std::vector<vpSample> m_samples;
+  std::vector<double> m_dW;
+  // Largest vpContributionType of the samples
+  int m_maxType;
+  // Partial histograms of the blocks of samples
+  std::vector<double> m_blocks;
+
+  class AccumulationTask;
+};
+
+#endif
+#endif
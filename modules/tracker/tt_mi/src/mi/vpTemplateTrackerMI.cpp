@@ -75,7 +75,7 @@ vpTemplateTrackerMI::vpTemplateTrackerMI(vpTemplateTrackerWarp *_warp)
     temp(NULL), Prt(NULL), dPrt(NULL), Pt(NULL), Pr(NULL), d2Prt(NULL), PrtTout(NULL),
     dprtemp(NULL), PrtD(NULL), dPrtD(NULL), influBspline(0), bspline(3), Nc(8), Ncb(0),
     d2Ix(), d2Iy(), d2Ixy(), MI_preEstimation(0), MI_postEstimation(0),
-    NMI_preEstimation(0), NMI_postEstimation(0), covarianceMatrix(), computeCovariance(false)
+    NMI_preEstimation(0), NMI_postEstimation(0), covarianceMatrix(), computeCovariance(false), histogram()
 {
   Ncb=Nc+bspline;
   influBspline=bspline*bspline;
@@ -138,35 +138,19 @@ double vpTemplateTrackerMI::getCost(const vpImage<unsigned char> &I, const vpCol
   double IW;
 
   unsigned int Ncb_ = (unsigned int) Ncb;
-  unsigned int Nc_  = (unsigned int) Nc;
-  unsigned int influBspline_  = (unsigned int) influBspline;
 
-  memset(Prt, 0, Ncb_*Ncb_*sizeof(double));
-  memset(PrtD, 0, Nc_*Nc_*influBspline_*sizeof(double));
+  if(ptTemplateSoA==NULL || ptTemplateSoA->size()!=templateSize)
+    initTemplateSoA();
+  const vpTemplateTrackerPointSoA &pts=*ptTemplateSoA;
+  Nbpoint=(int)computeWarpedTemplate(I,tp);
 
-  //Warp->ComputeMAtWarp(tp);
-  Warp->computeCoeff(tp);
+  histogram.reset(bspline,Nc,nbParam);
   for(unsigned int point=0;point<templateSize;point++)
   {
-    int i=ptTemplate[point].y;
-    int j=ptTemplate[point].x;
-    X1[0]=j;X1[1]=i;
-
-    Warp->computeDenom(X1,tp);
-    Warp->warpX(X1,X2,tp);
-    double j2=X2[0];
-    double i2=X2[1];
-
-    //Tij=Templ[i-(int)Triangle->GetMiny()][j-(int)Triangle->GetMinx()];
-    if((i2>=0)&&(j2>=0)&&(i2<I.getHeight()-1)&&(j2<I.getWidth()-1))
+    if(pts.inside[point])
     {
-      Nbpoint++;
-
-      double Tij=ptTemplate[point].val;
-      if(!blur)
-        IW=I.getValue(i2,j2);
-      else
-        IW=BI.getValue(i2,j2);
+      double Tij=pts.val[point];
+      IW=pts.Iw[point];
 
       int cr=(int)((IW*(Nc-1))/255.);
       int ct=(int)((Tij*(Nc-1))/255.);
@@ -174,33 +158,15 @@ double vpTemplateTrackerMI::getCost(const vpImage<unsigned char> &I, const vpCol
       double et=((double)Tij*(Nc-1))/255.-ct;
 
       //Calcul de l'histogramme joint par interpolation bilinÃaire (Bspline ordre 1)
-      vpTemplateTrackerMIBSpline::PutPVBsplineD(PrtD, cr, er, ct, et, Nc, 1.,bspline);
+      histogram.add(cr,er,ct,et,NULL,vpTemplateTrackerMIHistogram::PRT);
     }
   }
+  histogram.computePrt(Prt,NULL,NULL,Nbpoint);
 
   ratioPixelIn=(double)Nbpoint/(double)templateSize;
 
-  double *pt=PrtD;
-  for(int r=0;r<Nc;r++)
-    for(int t=0;t<Nc;t++)
-    {
-      for(int i=0;i<influBspline;i++)
-      {
-        int r2,t2;
-        r2=r+i/bspline;
-        t2=t+i%bspline;
-        Prt[r2*Ncb+t2]+=*pt;
-
-        pt++;
-      }
-    }
-
   if(Nbpoint==0)
     return 0;
-  for(unsigned int r=0;r<Ncb_;r++)
-    for(unsigned int t=0;t<Ncb_;t++)
-      //printf("%f ",Prt[r*Ncb+t]);
-      Prt[r*Ncb_+t]=Prt[r*Ncb_+t]/Nbpoint;
   //calcul Pr;
   memset(Pr, 0, Ncb_*sizeof(double));
   for(unsigned int r=0;r<Ncb_;r++)
@@ -311,6 +277,26 @@ double vpTemplateTrackerMI::getNormalizedCost(const vpImage<unsigned char> &I, c
   return -MI;
 }
 
+/*!
+  Store the points of the template in ptTemplateSoA, in order to warp them all
+  at once with computeWarpedTemplate().
+*/
+void vpTemplateTrackerMI::initTemplateSoA()
+{
+  if(ptTemplateSoA==NULL)
+    ptTemplateSoA=new vpTemplateTrackerPointSoA;
+  vpTemplateTrackerPointSoA &pts=*ptTemplateSoA;
+  pts.x.resize(templateSize);
+  pts.y.resize(templateSize);
+  pts.val.resize(templateSize);
+  for(unsigned int point=0;point<templateSize;point++)
+  {
+    pts.x[point]=ptTemplate[point].x;
+    pts.y[point]=ptTemplate[point].y;
+    pts.val[point]=ptTemplate[point].val;
+  }
+}
+
 vpTemplateTrackerMI::~vpTemplateTrackerMI()
 {
   if (Pt) delete[] Pt;
@@ -39,10 +39,6 @@
 
 #include <visp3/tt_mi/vpTemplateTrackerMIESM.h>
 
-#ifdef VISP_HAVE_OPENMP
-#include <omp.h>
-#endif
-
 vpTemplateTrackerMIESM::vpTemplateTrackerMIESM(vpTemplateTrackerWarp *_warp)
   : vpTemplateTrackerMI(_warp), minimizationMethod(USE_NEWTON), CompoInitialised(false),
     HDirect(), HInverse(), HdesireDirect(), HdesireInverse(), GDirect(), GInverse()
@@ -359,12 +355,8 @@ void vpTemplateTrackerMIESM::trackNoPyr(const vpImage<unsigned char> &I)
       zeroProbabilities();
 
       Warp->computeCoeff(p);
-#ifdef VISP_HAVE_OPENMP
-      int nthreads = omp_get_num_procs() ;
-      //std::cout << "file: " __FILE__ << " line: " << __LINE__ << " function: " << __FUNCTION__ << " nthread: " << nthreads << std::endl;
-      omp_set_num_threads(nthreads);
-#pragma omp parallel for private(point, i,j,i2,j2) default(shared)
-#endif
+      // Sequential: the points share X1, X2, Nbpoint and the state that
+      // computeDenom() leaves in the warp.
       for(point=0;point<(int)templateSize;point++)
       {
         i=ptTemplate[point].y;
@@ -39,10 +39,6 @@
 
 #include <visp3/tt_mi/vpTemplateTrackerMIForwardAdditional.h>
 
-#ifdef VISP_HAVE_OPENMP
-#include <omp.h>
-#endif
-
 vpTemplateTrackerMIForwardAdditional::vpTemplateTrackerMIForwardAdditional(vpTemplateTrackerWarp *_warp)
   : vpTemplateTrackerMI(_warp), minimizationMethod(USE_NEWTON), evolRMS(0), x_pos(NULL), y_pos(NULL),
     threshold_RMS(0), p_prec(), G_prec(), KQuasiNewton()
@@ -74,7 +70,7 @@ void vpTemplateTrackerMIForwardAdditional::initHessienDesired(const vpImage<unsi
 
   Nbpoint=0;
 
-  zeroProbabilities();
+  histogram.reset(bspline,Nc,nbParam);
   Warp->computeCoeff(p);
   for(unsigned int point=0;point<templateSize;point++)
   {
@@ -108,23 +104,20 @@ void vpTemplateTrackerMIForwardAdditional::initHessienDesired(const vpImage<unsi
       //std::cout<<"test"<<std::endl;
       Warp->dWarp(X1,X2,p,dW);
 
-      double *tptemp=new double[nbParam];
       for(unsigned int it=0;it<nbParam;it++)
-        tptemp[it] =dW[0][it]*dx+dW[1][it]*dy;
+        temp[it] =dW[0][it]*dx+dW[1][it]*dy;
 
       if(ApproxHessian==HESSIAN_NONSECOND)
-        vpTemplateTrackerMIBSpline::PutTotPVBsplineNoSecond(PrtTout, cr, er, ct, et, Nc, tptemp, nbParam, bspline);
+        histogram.add(cr,er,ct,et,temp,vpTemplateTrackerMIHistogram::PRT_DPRT);
       else if(ApproxHessian==HESSIAN_0 || ApproxHessian==HESSIAN_NEW)
-        vpTemplateTrackerMIBSpline::PutTotPVBspline(PrtTout, cr, er, ct, et, Nc, tptemp, nbParam, bspline);
-
-      delete[] tptemp;
+        histogram.add(cr,er,ct,et,temp,vpTemplateTrackerMIHistogram::PRT_DPRT_D2PRT);
     }
   }
 
   if(Nbpoint>0)
   {
     double MI;
-    computeProba(Nbpoint);
+    histogram.computePrt(Prt,dPrt,d2Prt,Nbpoint);
     computeMI(MI);
     computeHessien(Hdesire);
 
@@ -176,15 +169,11 @@ void vpTemplateTrackerMIForwardAdditional::trackNoPyr(const vpImage<unsigned cha
     MI=0;
     //erreur=0;
 
-    zeroProbabilities();
-
+    histogram.reset(bspline,Nc,nbParam);
     Warp->computeCoeff(p);
-#ifdef VISP_HAVE_OPENMP
-    int nthreads = omp_get_num_procs() ;
-    //std::cout << "file: " __FILE__ << " line: " << __LINE__ << " function: " << __FUNCTION__ << " nthread: " << nthreads << std::endl;
-    omp_set_num_threads(nthreads);
-#pragma omp parallel for default(shared)
-#endif
+    // Sequential: the points share X1, X2, dW, temp, Nbpoint and the state that
+    // computeDenom() leaves in the warp. The histogram is accumulated in parallel
+    // by computePrt().
     for(int point=0;point<(int)templateSize;point++)
     {
       int i=ptTemplate[point].y;
@@ -221,18 +210,12 @@ void vpTemplateTrackerMIForwardAdditional::trackNoPyr(const vpImage<unsigned cha
         //Calcul de l'histogramme joint par interpolation bilinÃaire (Bspline ordre 1)
         Warp->dWarp(X1,X2,p,dW);
 
-        //double *tptemp=temp;
-        double *tptemp=new double[nbParam];;
         for(unsigned int it=0;it<nbParam;it++)
-          tptemp[it] =(dW[0][it]*dx+dW[1][it]*dy);
-        //*tptemp++ =dW[0][it]*dIWx+dW[1][it]*dIWy;
-        //std::cout<<cr<<"   "<<ct<<"  ; ";
+          temp[it] =(dW[0][it]*dx+dW[1][it]*dy);
         if(ApproxHessian==HESSIAN_NONSECOND||hessianComputation==vpTemplateTrackerMI::USE_HESSIEN_DESIRE)
-          vpTemplateTrackerMIBSpline::PutTotPVBsplineNoSecond(PrtTout, cr, er, ct, et, Nc, tptemp, nbParam, bspline);
+          histogram.add(cr,er,ct,et,temp,vpTemplateTrackerMIHistogram::PRT_DPRT);
         else if(ApproxHessian==HESSIAN_0 || ApproxHessian==HESSIAN_NEW)
-          vpTemplateTrackerMIBSpline::PutTotPVBspline(PrtTout, cr, er, ct, et, Nc, tptemp, nbParam, bspline);
-
-        delete[] tptemp;
+          histogram.add(cr,er,ct,et,temp,vpTemplateTrackerMIHistogram::PRT_DPRT_D2PRT);
       }
     }
 
@@ -246,7 +229,7 @@ void vpTemplateTrackerMIForwardAdditional::trackNoPyr(const vpImage<unsigned cha
     }
     else
     {
-      computeProba(Nbpoint);
+      histogram.computePrt(Prt,dPrt,d2Prt,Nbpoint);
       computeMI(MI);
       //std::cout<<iteration<<"\tMI= "<<MI<<std::endl;
       computeHessien(H);
@@ -96,8 +96,7 @@ void vpTemplateTrackerMIForwardCompositional::initHessienDesired(const vpImage<u
   Nbpoint=0;
   //erreur=0;
 
-  zeroProbabilities();
-
+  histogram.reset(bspline,Nc,nbParam);
   Warp->computeCoeff(p);
   for(unsigned int point=0;point<templateSize;point++)
   {
@@ -131,20 +130,19 @@ void vpTemplateTrackerMIForwardCompositional::initHessienDesired(const vpImage<u
 
       Warp->dWarpCompo(X1,X2,p,ptTemplate[point].dW,dW);
 
-      double *tptemp=new double[nbParam];
       for(unsigned int it=0;it<nbParam;it++)
-        tptemp[it] =dW[0][it]*dx+dW[1][it]*dy;
+        temp[it] =dW[0][it]*dx+dW[1][it]*dy;
 
       //calcul de l'erreur
       //erreur+=(Tij-IW)*(Tij-IW);
 
-      vpTemplateTrackerMIBSpline::PutTotPVBspline(PrtTout, cr, er, ct, et, Nc,tptemp, nbParam, bspline);
-
-      delete[] tptemp;
+      histogram.add(cr,er,ct,et,temp,vpTemplateTrackerMIHistogram::PRT_DPRT_D2PRT);
     }
   }
+  if(Nbpoint==0)
+    throw(vpTrackingException(vpTrackingException::notEnoughPointError, "No points in the template"));
+  histogram.computePrt(Prt,dPrt,d2Prt,Nbpoint);
   double MI;
-  computeProba(Nbpoint);
   computeMI(MI);
   computeHessien(Hdesire);
 
@@ -195,8 +193,7 @@ void vpTemplateTrackerMIForwardCompositional::trackNoPyr(const vpImage<unsigned
     MI=0;
     //erreur=0;
 
-    zeroProbabilities();
-
+    histogram.reset(bspline,Nc,nbParam);
     Warp->computeCoeff(p);
 
     for(unsigned int point=0;point<templateSize;point++)
@@ -227,20 +224,17 @@ void vpTemplateTrackerMIForwardCompositional::trackNoPyr(const vpImage<unsigned
 
         Warp->dWarpCompo(X1,X2,p,ptTemplate[point].dW,dW);
 
-        double *tptemp=new double[nbParam];
         for(unsigned int it=0;it<nbParam;it++)
-          tptemp[it] =dW[0][it]*dx+dW[1][it]*dy;
+          temp[it] =dW[0][it]*dx+dW[1][it]*dy;
 
 
         //calcul de l'erreur
         //erreur+=(Tij-IW)*(Tij-IW);
 
         if(ApproxHessian==HESSIAN_NONSECOND||hessianComputation==vpTemplateTrackerMI::USE_HESSIEN_DESIRE)
-          vpTemplateTrackerMIBSpline::PutTotPVBsplineNoSecond(PrtTout, cr, er, ct, et, Nc, tptemp, nbParam, bspline);
+          histogram.add(cr,er,ct,et,temp,vpTemplateTrackerMIHistogram::PRT_DPRT);
         else if(ApproxHessian==HESSIAN_0|| ApproxHessian==HESSIAN_NEW)
-          vpTemplateTrackerMIBSpline::PutTotPVBspline(PrtTout, cr, er, ct, et, Nc, tptemp, nbParam, bspline);
-
-        delete[] tptemp;
+          histogram.add(cr,er,ct,et,temp,vpTemplateTrackerMIHistogram::PRT_DPRT_D2PRT);
 
       }
     }
@@ -253,7 +247,7 @@ void vpTemplateTrackerMIForwardCompositional::trackNoPyr(const vpImage<unsigned
     }
     else
     {
-      computeProba(Nbpoint);
+      histogram.computePrt(Prt,dPrt,d2Prt,Nbpoint);
       computeMI(MI);
       if(hessianComputation!=vpTemplateTrackerMI::USE_HESSIEN_DESIRE)
         computeHessien(H);
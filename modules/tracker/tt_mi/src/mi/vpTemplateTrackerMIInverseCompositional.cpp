@@ -149,80 +149,35 @@ void vpTemplateTrackerMIInverseCompositional::initHessienDesired(const vpImage<u
   if(blur)
     vpImageFilter::filter(I, BI,fgG,taillef);
 
-  zeroProbabilities();
-  Warp->computeCoeff(p);
-
-  // AY : Optim
-  //    unsigned int totParam = (bspline * bspline)*(1+nbParam+nbParam*nbParam);
-  //    unsigned int size = (1 + nbParam + nbParam*nbParam)*bspline;
-  //    double *ptb;
+  initTemplateSoA();
+  const vpTemplateTrackerPointSoA &pts=*ptTemplateSoA;
+  Nbpoint=(int)computeWarpedTemplate(I,p);
 
+  histogram.reset(bspline,Nc,nbParam);
   for(unsigned int point=0;point<templateSize;point++)
   {
-    int i=ptTemplate[point].y;
-    int j=ptTemplate[point].x;
-    X1[0]=j;
-    X1[1]=i;
-
-    Warp->computeDenom(X1,p);
-    Warp->warpX(X1,X2,p);
-
-    double j2=X2[0];
-    double i2=X2[1];
-
-    if((i2>=0)&&(j2>=0)&&(i2<I.getHeight()-1)&&(j2<I.getWidth()-1))
+    if(pts.inside[point] && (ptTemplateSelect[point] || !useTemplateSelect))
     {
-      Nbpoint++;
-      //Tij=ptTemplate[point].val;
-
-      if(blur)
-        IW=BI.getValue(i2,j2);
-      else
-        IW=I.getValue(i2,j2);
+      IW=pts.Iw[point];
 
       ct=ptTemplateSupp[point].ct;
       et=ptTemplateSupp[point].et;
       cr=(int)((IW*(Nc-1))/255.);
       er=((double)IW*(Nc-1))/255.-cr;
 
-      //calcul de l'erreur
-      //erreur+=(Tij-IW)*(Tij-IW);
-
-      if( ApproxHessian==HESSIAN_NONSECOND && (ptTemplateSelect[point] || !useTemplateSelect) )
-      {
-        vpTemplateTrackerMIBSpline::PutTotPVBsplineNoSecond(PrtTout, cr, er, ct, et, Nc, ptTemplate[point].dW, nbParam, bspline);
-      }
-      else if ((ApproxHessian==HESSIAN_0||ApproxHessian==HESSIAN_NEW) && (ptTemplateSelect[point] || !useTemplateSelect))
-      {
-        if(bspline==3){
-          vpTemplateTrackerMIBSpline::PutTotPVBspline3(PrtTout, cr, er, ct, et, Nc, ptTemplate[point].dW, nbParam);
-          //                    {
-          //                        if(et>0.5){ct++;}
-          //                        if(er>0.5){cr++;}
-          //                        int index = (cr*Nc+ct)*totParam;
-          //                        double *ptb = &PrtTout[index];
-          //                        vpTemplateTrackerMIBSpline::PutTotPVBspline3(ptb, er, ptTemplateSupp[point].BtInit, size);
-          //                    }
-        }
-        else{
-          vpTemplateTrackerMIBSpline::PutTotPVBspline4(PrtTout, cr, er, ct, et, Nc, ptTemplate[point].dW, nbParam);
-
-          //                    {
-          //                        // ################### AY : Optim
-          //                        unsigned int index = (cr*Nc+ct)*totParam;
-          //                        ptb = &PrtTout[index];
-          //                        vpTemplateTrackerMIBSpline::PutTotPVBspline4(ptb, er, ptTemplateSupp[point].BtInit, size);
-          //                        // ###################
-          //                    }
-        }
-      }
-      else if (ptTemplateSelect[point] || !useTemplateSelect)
-        vpTemplateTrackerMIBSpline::PutTotPVBsplinePrt(PrtTout, cr, er, ct, et, Nc,nbParam, bspline);
+      if(ApproxHessian==HESSIAN_NONSECOND)
+        histogram.add(cr,er,ct,et,ptTemplate[point].dW,vpTemplateTrackerMIHistogram::PRT_DPRT);
+      else if(ApproxHessian==HESSIAN_0||ApproxHessian==HESSIAN_NEW)
+        histogram.add(cr,er,ct,et,ptTemplate[point].dW,vpTemplateTrackerMIHistogram::PRT_DPRT_D2PRT);
+      else
+        histogram.add(cr,er,ct,et,NULL,vpTemplateTrackerMIHistogram::PRT);
     }
   }
+  if(Nbpoint==0)
+    throw(vpTrackingException(vpTrackingException::notEnoughPointError, "No points in the template"));
+  histogram.computePrt(Prt,dPrt,d2Prt,Nbpoint);
 
   double MI;
-  computeProba(Nbpoint);
   computeMI(MI);
   computeHessien(Hdesire);
 
@@ -271,63 +226,31 @@ void vpTemplateTrackerMIInverseCompositional::trackNoPyr(const vpImage<unsigned
     MIprec=MI;
     MI=0;
 
-    zeroProbabilities();
-
-    Warp->computeCoeff(p);
+    const vpTemplateTrackerPointSoA &pts=*ptTemplateSoA;
+    Nbpoint=(int)computeWarpedTemplate(I,p);
 
+    histogram.reset(bspline,Nc,nbParam);
+    for(unsigned int point=0;point<templateSize;point++)
     {
-      for(int point=0;point<(int)templateSize;point++)
+      if(pts.inside[point])
       {
-        vpColVector x1(2),x2(2);
-        double i2,j2;
-
-        x1[0]=(double)ptTemplate[point].x;
-        x1[1]=(double)ptTemplate[point].y;
-
-        Warp->computeDenom(x1,p); // A modif pour parallelisation mais ne pose pas de pb avec warp utilises dans DECSA
-        Warp->warpX(x1,x2,p);
-
-        j2=x2[0];
-        i2=x2[1];
-
-        if((i2>=0)&&(j2>=0)&&(i2<I.getHeight()-1)&&(j2<I.getWidth()-1))
-        {
-          //if(m_ptCurrentMask == NULL ||(m_ptCurrentMask->getWidth() == I.getWidth() && m_ptCurrentMask->getHeight() == I.getHeight() && (*m_ptCurrentMask)[(unsigned int)i2][(unsigned int)j2] > 128))
-          {
-            Nbpoint++;
-            double IW;
-            if(!blur)
-              IW=(double)I.getValue(i2,j2);
-            else
-              IW=BI.getValue(i2,j2);
-
-            int ct=ptTemplateSupp[point].ct;
-            double et=ptTemplateSupp[point].et;
-            double tmp = IW*(((double)Nc)-1.f)/255.f;
-            int cr=(int)tmp;
-            double er=tmp-(double)cr;
-
-            if( (ApproxHessian==HESSIAN_NONSECOND||hessianComputation==vpTemplateTrackerMI::USE_HESSIEN_DESIRE) && (ptTemplateSelect[point] || !useTemplateSelect) )
-            {
-              vpTemplateTrackerMIBSpline::PutTotPVBsplineNoSecond(Prt, dPrt, cr, er, ct, et, Ncb, ptTemplate[point].dW, nbParam, bspline);
-            }
-            else if (ptTemplateSelect[point] || !useTemplateSelect)
-            {
-              if(bspline==3){
-                vpTemplateTrackerMIBSpline::PutTotPVBspline3(Prt, dPrt, d2Prt, cr, er, ct, et, Ncb, ptTemplate[point].dW, nbParam);
-              }
-              else{
-                vpTemplateTrackerMIBSpline::PutTotPVBspline4(Prt, dPrt, d2Prt, cr, er, ct, et, Ncb, ptTemplate[point].dW, nbParam);
-              }
-            }
-            else{
-              vpTemplateTrackerMIBSpline::PutTotPVBsplinePrt(Prt, cr, er, ct, et, Ncb,nbParam, bspline);
-            }
-          }
-
-        }
+        double IW=pts.Iw[point];
+
+        int ct=ptTemplateSupp[point].ct;
+        double et=ptTemplateSupp[point].et;
+        double tmp = IW*(((double)Nc)-1.f)/255.f;
+        int cr=(int)tmp;
+        double er=tmp-(double)cr;
+
+        if( (ApproxHessian==HESSIAN_NONSECOND||hessianComputation==vpTemplateTrackerMI::USE_HESSIEN_DESIRE) && (ptTemplateSelect[point] || !useTemplateSelect) )
+          histogram.add(cr,er,ct,et,ptTemplate[point].dW,vpTemplateTrackerMIHistogram::PRT_DPRT);
+        else if (ptTemplateSelect[point] || !useTemplateSelect)
+          histogram.add(cr,er,ct,et,ptTemplate[point].dW,vpTemplateTrackerMIHistogram::PRT_DPRT_D2PRT);
+        else
+          histogram.add(cr,er,ct,et,NULL,vpTemplateTrackerMIHistogram::PRT);
       }
     }
+    histogram.computePrt(Prt,dPrt,d2Prt,Nbpoint);
 
     if(Nbpoint==0)
     {
@@ -339,23 +262,6 @@ void vpTemplateTrackerMIInverseCompositional::trackNoPyr(const vpImage<unsigned
     }
     else
     {
-      //            computeProba(Nbpoint);
-
-      unsigned int indd, indd2;
-      indd = indd2 = 0;
-      unsigned int Ncb_ = (unsigned int)Ncb;
-      for(unsigned int i=0;i<Ncb_*Ncb_;i++){
-        Prt[i]=Prt[i]/Nbpoint;
-        for(unsigned int j=0;j<nbParam;j++){
-          dPrt[indd]=dPrt[indd]/Nbpoint;
-          indd++;
-          for(unsigned int k=0;k<nbParam;k++){
-            d2Prt[indd2]=d2Prt[indd2]/Nbpoint;
-            indd2++;
-          }
-        }
-      }
-
       computeMI(MI);
 
       if(hessianComputation!=vpTemplateTrackerMI::USE_HESSIEN_DESIRE){
@@ -0,0 +1,329 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Joint histogram of the mutual information template trackers.
+ *
+ *****************************************************************************/
+#include <algorithm>
+#include <string.h>
+
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/tt_mi/vpTemplateTrackerMIHistogram.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+namespace {
+  //! Number of samples of a block, that is accumulated in its own partial histogram
+  const unsigned int blockSize = 8192;
+
+  /*
+    Coefficients of the derivatives of the B-spline weights of the columns, as
+    polynomials of the residual: dB[it](e) = sum_k dBCoef[it][k]*e^k and
+    d2B[it](e) = sum_k d2BCoef[it][k]*e^k, with e in ]-0.5, 0.5] for the third
+    order B-spline and in [0, 1[ for the fourth order one.
+  */
+  const double dBCoef3[3][2] = { { -0.5, 1. }, { 0., -2. }, { 0.5, 1. } };
+  const double d2BCoef3[3][1] = { { 1. }, { -2. }, { 1. } };
+  const double dBCoef4[4][3] = { { -0.5, 1., -0.5 }, { 0., -2., 1.5 }, { 0.5, 1., -1.5 }, { 0., 0., 0.5 } };
+  const double d2BCoef4[4][2] = { { 1., -1. }, { -2., 3. }, { 1., -3. }, { 0., 1. } };
+
+  //! dst[i] += v*src[i] for i < n
+  inline void addProduct(double *dst, const double v, const double *src, const unsigned int n)
+  {
+    unsigned int i = 0;
+#if VISP_HAVE_SSE2
+    const __m128d vv = _mm_set1_pd(v);
+    for (; i + 1 < n; i += 2)
+      _mm_storeu_pd(dst + i, _mm_add_pd(_mm_loadu_pd(dst + i), _mm_mul_pd(vv, _mm_loadu_pd(src + i))));
+#endif
+    for (; i < n; i++)
+      dst[i] += v * src[i];
+  }
+
+  //! dst[i] += src[i] for i < n
+  inline void addArray(double *dst, const double *src, const unsigned int n)
+  {
+    unsigned int i = 0;
+#if VISP_HAVE_SSE2
+    for (; i + 1 < n; i += 2)
+      _mm_storeu_pd(dst + i, _mm_add_pd(_mm_loadu_pd(dst + i), _mm_loadu_pd(src + i)));
+#endif
+    for (; i < n; i++)
+      dst[i] += src[i];
+  }
+
+  /*
+    B-spline weights of the bins of a gray level of bin c and residual e. The
+    first bin is returned in c, and e is moved to the interval of the
+    polynomials of dBCoef3 or dBCoef4.
+  */
+  inline void bsplineWeights(const int bspline, int &c, double &e, double *B)
+  {
+    if (bspline == 3) {
+      if (e > 0.5) {
+        c++;
+        e -= 1.;
+      }
+      B[0] = 0.5 * (0.5 - e) * (0.5 - e);
+      B[1] = 0.75 - e * e;
+      B[2] = 0.5 * (0.5 + e) * (0.5 + e);
+    }
+    else {
+      const double f = 1. - e;
+      B[0] = f * f * f / 6.;
+      B[1] = e * e * e / 2. - e * e + 4. / 6.;
+      B[2] = f * f * f / 2. - f * f + 4. / 6.;
+      B[3] = e * e * e / 6.;
+    }
+  }
+}
+
+/*
+  Accumulation of the blocks of samples [begin, end) in their partial histograms.
+
+  A partial histogram stores the joint probability of the Ncb*Ncb bins, then
+  for each bin the nbMoments1 sums of dW*et^k and the nbMoments2 sums of the
+  upper triangle of dW*dW^T*et^k of the samples whose first column is this bin.
+*/
+class vpTemplateTrackerMIHistogram::AccumulationTask : public vpThreadPool::Task
+{
+public:
+  AccumulationTask(vpTemplateTrackerMIHistogram &histogram, const unsigned int nbMoments1,
+                   const unsigned int nbMoments2)
+    : m_h(histogram), m_nbMoments1(nbMoments1), m_nbMoments2(nbMoments2) {}
+
+  //! Size of a partial histogram
+  unsigned int blockLength() const
+  {
+    const unsigned int Ncb = (unsigned int)(m_h.m_Nc + m_h.m_bspline);
+    return Ncb * Ncb * (1 + cellLength());
+  }
+
+  //! Number of sums stored for each bin
+  unsigned int cellLength() const
+  {
+    const unsigned int P = m_h.m_nbParam;
+    return m_nbMoments1 * P + m_nbMoments2 * (P * (P + 1) / 2);
+  }
+
+  void operator()(const unsigned int begin, const unsigned int end)
+  {
+    for (unsigned int block = begin; block < end; block++) {
+      if (m_h.m_bspline == 3)
+        accumulate<3>(block);
+      else
+        accumulate<4>(block);
+    }
+  }
+
+private:
+  //! Accumulate a block with a B-spline of order b
+  template <int b> void accumulate(const unsigned int block)
+  {
+    const unsigned int Ncb = (unsigned int)(m_h.m_Nc + b);
+    const unsigned int P = m_h.m_nbParam;
+    const unsigned int Psym = P * (P + 1) / 2;
+    const unsigned int cell = cellLength();
+    std::vector<double> dWdWt(Psym);
+
+    double *Prt = &m_h.m_blocks[block * blockLength()];
+    double *moments = Prt + Ncb * Ncb;
+    memset(Prt, 0, blockLength() * sizeof(double));
+
+    const unsigned int last = std::min((block + 1) * blockSize, m_h.size());
+    for (unsigned int n = block * blockSize; n < last; n++) {
+      const vpSample &sample = m_h.m_samples[n];
+      double Br[4], Bt[4];
+      int row = sample.cr, col = sample.ct;
+      double er = sample.er, et = sample.et;
+      bsplineWeights(b, row, er, Br);
+      bsplineWeights(b, col, et, Bt);
+
+      for (int ir = 0; ir < b; ir++) {
+        double *pt = &Prt[(unsigned int)(row + ir) * Ncb + (unsigned int)col];
+        for (int it = 0; it < b; it++)
+          pt[it] += Br[ir] * Bt[it];
+      }
+
+      if (sample.type == PRT)
+        continue;
+
+      const double *dW = &m_h.m_dW[sample.dWIndex];
+      if (sample.type == PRT_DPRT_D2PRT) {
+        unsigned int k = 0;
+        for (unsigned int i = 0; i < P; i++)
+          for (unsigned int j = i; j < P; j++)
+            dWdWt[k++] = dW[i] * dW[j];
+      }
+      const double etPow[3] = { 1., et, et * et };
+      for (int ir = 0; ir < b; ir++) {
+        double *pt = &moments[((unsigned int)(row + ir) * Ncb + (unsigned int)col) * cell];
+        for (unsigned int k = 0; k < m_nbMoments1; k++)
+          addProduct(pt + k * P, Br[ir] * etPow[k], dW, P);
+        if (sample.type == PRT_DPRT_D2PRT) {
+          pt += m_nbMoments1 * P;
+          for (unsigned int k = 0; k < m_nbMoments2; k++)
+            addProduct(pt + k * Psym, Br[ir] * etPow[k], &dWdWt[0], Psym);
+        }
+      }
+    }
+  }
+
+  vpTemplateTrackerMIHistogram &m_h;
+  const unsigned int m_nbMoments1, m_nbMoments2;
+};
+
+vpTemplateTrackerMIHistogram::vpTemplateTrackerMIHistogram()
+  : m_bspline(3), m_Nc(8), m_nbParam(0), m_samples(), m_dW(), m_maxType(PRT), m_blocks()
+{
+}
+
+/*
+  Remove all the samples and set the parameters of the histogram.
+  \param bspline : Order of the B-spline, 3 or 4.
+  \param Nc : Number of bins of the joint histogram.
+  \param nbParam : Number of parameters of the warp.
+*/
+void vpTemplateTrackerMIHistogram::reset(const int bspline, const int Nc, const unsigned int nbParam)
+{
+  m_bspline = (bspline == 4) ? 4 : 3;
+  m_Nc = Nc;
+  m_nbParam = nbParam;
+  m_samples.clear();
+  m_dW.clear();
+  m_maxType = PRT;
+}
+
+/*
+  Add a sample to the histogram.
+  \param cr, er : Bin and residual of the gray level in the first image.
+  \param ct, et : Bin and residual of the gray level in the second image.
+  \param dW : Derivatives of the gray level with respect to the parameters, nbParam values.
+  Not used if \e type is PRT.
+  \param type : What the sample adds to the histogram.
+*/
+void vpTemplateTrackerMIHistogram::add(const int cr, const double er, const int ct, const double et,
+                                       const double *dW, const vpContributionType type)
+{
+  vpSample sample;
+  sample.cr = cr;
+  sample.ct = ct;
+  sample.er = er;
+  sample.et = et;
+  sample.dWIndex = (unsigned int)m_dW.size();
+  sample.type = type;
+  m_samples.push_back(sample);
+  if (type != PRT) {
+    m_dW.insert(m_dW.end(), dW, dW + m_nbParam);
+    m_maxType = std::max(m_maxType, (int)type);
+  }
+}
+
+/*
+  Set the joint histogram Prt, its first derivatives dPrt and second
+  derivatives d2Prt, of size (Nc+bspline)^2, (Nc+bspline)^2*nbParam and
+  (Nc+bspline)^2*nbParam^2, to the sum of the contributions of the samples,
+  divided by \e nbPoints. This gives the same bins as
+  vpTemplateTrackerMIBSpline::PutTotPVBspline() and
+  vpTemplateTrackerMIBSpline::PutTotPVBsplineNoSecond() with Ncb=Nc+bspline,
+  and as vpTemplateTrackerMIBSpline::PutPVBsplineD() followed by the fold of
+  PrtD into Prt done by vpTemplateTrackerMI::getCost().
+
+  The derivatives that no sample adds are set to 0. dPrt and d2Prt may be
+  NULL if no sample of type PRT_DPRT or PRT_DPRT_D2PRT was added.
+*/
+void vpTemplateTrackerMIHistogram::computePrt(double *Prt, double *dPrt, double *d2Prt, const int nbPoints)
+{
+  const bool third = (m_bspline == 3);
+  const unsigned int b = (unsigned int)m_bspline;
+  const unsigned int nbMoments1 = (m_maxType >= PRT_DPRT) ? b - 1 : 0;
+  const unsigned int nbMoments2 = (m_maxType == PRT_DPRT_D2PRT) ? b - 2 : 0;
+  AccumulationTask task(*this, nbMoments1, nbMoments2);
+
+  const unsigned int nbBlocks = std::max((size() + blockSize - 1) / blockSize, 1u);
+  const unsigned int length = task.blockLength();
+  m_blocks.resize(nbBlocks * length);
+  vpThreadPool::getInstance().parallelFor(0, nbBlocks, task, 1);
+  for (unsigned int block = 1; block < nbBlocks; block++)
+    addArray(&m_blocks[0], &m_blocks[block * length], length);
+
+  // Expand the sums of the first columns to the bins
+  const unsigned int Ncb = (unsigned int)m_Nc + b;
+  const unsigned int P = m_nbParam;
+  const unsigned int cell = task.cellLength();
+  const double scale = (nbPoints > 0) ? 1. / nbPoints : 1.;
+  const double *moments = &m_blocks[Ncb * Ncb];
+
+  for (unsigned int bin = 0; bin < Ncb * Ncb; bin++)
+    Prt[bin] = m_blocks[bin] * scale;
+  if (dPrt != NULL)
+    memset(dPrt, 0, Ncb * Ncb * P * sizeof(double));
+  if (d2Prt != NULL)
+    memset(d2Prt, 0, Ncb * Ncb * P * P * sizeof(double));
+  if (nbMoments1 == 0)
+    return;
+
+  std::vector<double> d2(P * (P + 1) / 2);
+  for (unsigned int r = 0; r < Ncb; r++) {
+    for (unsigned int c = 0; c < Ncb; c++) {
+      const double *m1 = &moments[(r * Ncb + c) * cell];
+      const double *m2 = m1 + nbMoments1 * P;
+      for (unsigned int it = 0; it < b && c + it < Ncb; it++) {
+        const unsigned int bin = r * Ncb + c + it;
+        const double *coef1 = third ? dBCoef3[it] : dBCoef4[it];
+        for (unsigned int k = 0; k < nbMoments1; k++)
+          addProduct(&dPrt[bin * P], -coef1[k] * scale, m1 + k * P, P);
+
+        if (nbMoments2 == 0)
+          continue;
+        const double *coef2 = third ? d2BCoef3[it] : d2BCoef4[it];
+        std::fill(d2.begin(), d2.end(), 0.);
+        for (unsigned int k = 0; k < nbMoments2; k++)
+          addProduct(&d2[0], coef2[k] * scale, m2 + k * d2.size(), (unsigned int)d2.size());
+        double *pt = &d2Prt[bin * P * P];
+        unsigned int k = 0;
+        for (unsigned int i = 0; i < P; i++) {
+          for (unsigned int j = i; j < P; j++, k++) {
+            pt[i * P + j] += d2[k];
+            if (j != i)
+              pt[j * P + i] += d2[k];
+          }
+        }
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,287 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the joint histogram of the mutual information trackers.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceMIHistogram.cpp
+
+  \brief Check that vpTemplateTrackerMIHistogram gives the same joint histogram,
+  mutual information, gradient and Hessian as the per-point functions of
+  vpTemplateTrackerMIBSpline, with third and fourth order B-splines, 6 and 8
+  parameters and with 1 or 4 threads, and measure the accumulation time.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/tt/vpTemplateTrackerWarpAffine.h>
+#include <visp3/tt/vpTemplateTrackerWarpHomography.h>
+#include <visp3/tt_mi/vpTemplateTrackerMIBSpline.h>
+#include <visp3/tt_mi/vpTemplateTrackerMIForwardAdditional.h>
+#include <visp3/tt_mi/vpTemplateTrackerMIHistogram.h>
+
+namespace {
+  //! Sample of the joint histogram, as added by the trackers
+  struct vpSample {
+    int cr, ct;
+    double er, et;
+    vpTemplateTrackerMIHistogram::vpContributionType type;
+  };
+
+  /*!
+    Tracker whose joint histogram is filled either point by point with
+    vpTemplateTrackerMIBSpline, as the former trackers did, or with
+    vpTemplateTrackerMIHistogram.
+  */
+  class vpMIHistogramTester : public vpTemplateTrackerMIForwardAdditional
+  {
+  public:
+    vpMIHistogramTester(vpTemplateTrackerWarp *warp, const vpBsplineType bsplineType)
+      : vpTemplateTrackerMIForwardAdditional(warp), MI(0)
+    {
+      setBspline(bsplineType);
+      setNc(8);
+    }
+
+    //! Accumulate the samples point by point in Prt, dPrt and d2Prt
+    void accumulatePerPoint(const std::vector<vpSample> &samples, const std::vector<double> &dW)
+    {
+      zeroProbabilities();
+      for (unsigned int n = 0; n < samples.size(); n++) {
+        int cr = samples[n].cr, ct = samples[n].ct;
+        double er = samples[n].er, et = samples[n].et;
+        double *val = const_cast<double *>(&dW[n * nbParam]);
+        // PutTotPVBspline4() and PutTotPVBspline3NoSecond() put the sample one
+        // column to the left of the other functions
+        if (samples[n].type == vpTemplateTrackerMIHistogram::PRT_DPRT_D2PRT) {
+          if (bspline == 3)
+            vpTemplateTrackerMIBSpline::PutTotPVBspline3(Prt, dPrt, d2Prt, cr, er, ct, et, Ncb, val, nbParam);
+          else
+            vpTemplateTrackerMIBSpline::PutTotPVBspline4(Prt, dPrt, d2Prt, cr, er, ct + 1, et, Ncb, val, nbParam);
+        }
+        else if (samples[n].type == vpTemplateTrackerMIHistogram::PRT_DPRT) {
+          if (bspline == 3)
+            ct++;
+          vpTemplateTrackerMIBSpline::PutTotPVBsplineNoSecond(Prt, dPrt, cr, er, ct, et, Ncb, val, nbParam, bspline);
+        }
+        else if (bspline == 3)
+          vpTemplateTrackerMIBSpline::PutTotPVBspline3Prt(Prt, cr, er, ct, et, Ncb);
+        else
+          vpTemplateTrackerMIBSpline::PutTotPVBspline4Prt(Prt, cr, er, ct, et, Ncb);
+      }
+      const double nbPoints = (double)samples.size();
+      for (int i = 0; i < Ncb * Ncb; i++) {
+        Prt[i] /= nbPoints;
+        for (unsigned int j = 0; j < nbParam; j++)
+          dPrt[i * nbParam + j] /= nbPoints;
+        for (unsigned int j = 0; j < nbParam * nbParam; j++)
+          d2Prt[i * nbParam * nbParam + j] /= nbPoints;
+      }
+    }
+
+    //! Accumulate the samples at once in Prt, dPrt and d2Prt with vpTemplateTrackerMIHistogram
+    void accumulate(const std::vector<vpSample> &samples, const std::vector<double> &dW)
+    {
+      histogram.reset(bspline, Nc, nbParam);
+      for (unsigned int n = 0; n < samples.size(); n++)
+        histogram.add(samples[n].cr, samples[n].er, samples[n].ct, samples[n].et, &dW[n * nbParam],
+                      samples[n].type);
+      histogram.computePrt(Prt, dPrt, d2Prt, (int)samples.size());
+    }
+
+    //! Compute the mutual information, its gradient and its Hessian from the histogram
+    void computeCost(const vpHessienApproximationType approx)
+    {
+      ApproxHessian = approx;
+      MI = 0;
+      computeMI(MI);
+      computeGradient();
+      computeHessien(H);
+    }
+
+    std::vector<double> getPrt() const { return std::vector<double>(Prt, Prt + Ncb * Ncb); }
+    std::vector<double> getdPrt() const { return std::vector<double>(dPrt, dPrt + Ncb * Ncb * nbParam); }
+    std::vector<double> getd2Prt() const
+    {
+      return std::vector<double>(d2Prt, d2Prt + Ncb * Ncb * nbParam * nbParam);
+    }
+
+    double MI;
+    using vpTemplateTrackerMIForwardAdditional::G;
+    using vpTemplateTrackerMIForwardAdditional::H;
+  };
+
+  //! Gray level of a smooth texture in [0, 255]
+  double texture(const double u, const double v)
+  {
+    return 127.5 + 60. * sin(0.11 * u + 0.05 * v) + 45. * cos(0.07 * v - 0.03 * u)
+        + 22. * sin(0.23 * u) * cos(0.19 * v);
+  }
+
+  //! Samples of a 200x200 template, with their derivatives with respect to the parameters
+  void createSamples(const unsigned int nbParam, const vpTemplateTrackerMIHistogram::vpContributionType type,
+                     std::vector<vpSample> &samples, std::vector<double> &dW)
+  {
+    const int Nc = 8;
+    samples.clear();
+    dW.clear();
+    for (unsigned int i = 0; i < 200; i++) {
+      for (unsigned int j = 0; j < 200; j++) {
+        const double Tij = texture(j, i), IW = texture(j + 3.7, i - 2.2);
+        vpSample sample;
+        sample.cr = (int)((Tij * (Nc - 1)) / 255.);
+        sample.er = (Tij * (Nc - 1)) / 255. - sample.cr;
+        sample.ct = (int)((IW * (Nc - 1)) / 255.);
+        sample.et = (IW * (Nc - 1)) / 255. - sample.ct;
+        // As in the inverse compositional tracker, some points only add their probability
+        sample.type = ((i + j) % 5 == 0) ? vpTemplateTrackerMIHistogram::PRT : type;
+        samples.push_back(sample);
+        for (unsigned int it = 0; it < nbParam; it++)
+          dW.push_back(0.02 * ((double)j - 100.) * cos(0.3 * it + 0.01 * i) + 0.5 * sin(0.7 * it + 0.02 * j));
+      }
+    }
+  }
+
+  bool closeVectors(const std::vector<double> &a, const std::vector<double> &b, const double tolerance)
+  {
+    double norm = 0, error = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+      norm = std::max(norm, std::fabs(a[i]));
+      error = std::max(error, std::fabs(a[i] - b[i]));
+    }
+    return error <= tolerance * std::max(norm, 1.);
+  }
+
+  bool closeCosts(const vpMIHistogramTester &a, const vpMIHistogramTester &b, const double tolerance)
+  {
+    std::vector<double> Ga(a.G.data, a.G.data + a.G.size()), Gb(b.G.data, b.G.data + b.G.size());
+    std::vector<double> Ha(a.H.data, a.H.data + a.H.size()), Hb(b.H.data, b.H.data + b.H.size());
+    return std::fabs(a.MI - b.MI) <= tolerance * std::max(std::fabs(a.MI), 1.) && closeVectors(Ga, Gb, tolerance)
+        && closeVectors(Ha, Hb, tolerance);
+  }
+
+  //! Compare the histogram engine to the per-point accumulation
+  template<class Warp>
+  bool testHistogram(const char *name, const vpTemplateTrackerMI::vpBsplineType bspline,
+                     const vpTemplateTrackerMIHistogram::vpContributionType type)
+  {
+    Warp warp;
+    vpMIHistogramTester ref(&warp, bspline), tester(&warp, bspline);
+    std::vector<vpSample> samples;
+    std::vector<double> dW;
+    createSamples(warp.getNbParam(), type, samples, dW);
+
+    const unsigned int nbRuns = 5;
+    double t_per_point = 0, t_engine = 0;
+    for (unsigned int run = 0; run < nbRuns; run++) {
+      double t = vpTime::measureTimeMs();
+      ref.accumulatePerPoint(samples, dW);
+      t_per_point += vpTime::measureTimeMs() - t;
+      t = vpTime::measureTimeMs();
+      tester.accumulate(samples, dW);
+      t_engine += vpTime::measureTimeMs() - t;
+    }
+
+    const double tolerance = 1e-12;
+    if (! closeVectors(tester.getPrt(), ref.getPrt(), tolerance)
+        || (type != vpTemplateTrackerMIHistogram::PRT && ! closeVectors(tester.getdPrt(), ref.getdPrt(), tolerance))
+        || (type == vpTemplateTrackerMIHistogram::PRT_DPRT_D2PRT
+            && ! closeVectors(tester.getd2Prt(), ref.getd2Prt(), tolerance))) {
+      std::cerr << name << ": the histogram differs from the per-point one" << std::endl;
+      return false;
+    }
+
+    const vpTemplateTrackerMI::vpHessienApproximationType approx =
+        (type == vpTemplateTrackerMIHistogram::PRT_DPRT_D2PRT) ? vpTemplateTrackerMI::HESSIAN_0
+                                                                : vpTemplateTrackerMI::HESSIAN_NONSECOND;
+    ref.computeCost(approx);
+    tester.computeCost(approx);
+    if (! closeCosts(tester, ref, 1e-9)) {
+      std::cerr << name << ": the mutual information, gradient or Hessian differ from the per-point ones"
+                << std::endl;
+      return false;
+    }
+
+    // The histogram does not depend on the number of threads
+    vpThreadPool::getInstance().setNumThreads(4);
+    vpMIHistogramTester tester4(&warp, bspline);
+    tester4.accumulate(samples, dW);
+    vpThreadPool::getInstance().setNumThreads(1);
+    if (tester4.getPrt() != tester.getPrt() || tester4.getdPrt() != tester.getdPrt()
+        || tester4.getd2Prt() != tester.getd2Prt()) {
+      std::cerr << name << ": the histogram depends on the number of threads" << std::endl;
+      return false;
+    }
+
+    std::cout << name << ": " << t_engine / nbRuns << " ms, " << t_per_point / nbRuns
+              << " ms with the per-point functions" << std::endl;
+    return true;
+  }
+
+  template<class Warp>
+  bool testWarp(const char *name)
+  {
+    const char *types[3] = { "Prt", "Prt, dPrt", "Prt, dPrt, d2Prt" };
+    for (int type = 0; type < 3; type++) {
+      for (int bspline = 3; bspline <= 4; bspline++) {
+        std::string title = std::string(name) + ", B-spline of order " + (bspline == 3 ? "3" : "4") + ", " + types[type];
+        if (! testHistogram<Warp>(title.c_str(), (vpTemplateTrackerMI::vpBsplineType)bspline,
+                                  (vpTemplateTrackerMIHistogram::vpContributionType)type))
+          return false;
+      }
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    vpThreadPool::getInstance().setNumThreads(1);
+    if (! testWarp<vpTemplateTrackerWarpAffine>("affine") || ! testWarp<vpTemplateTrackerWarpHomography>("homography"))
+      return EXIT_FAILURE;
+
+    std::cout << "testPerformanceMIHistogram is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,242 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Approximate nearest neighbour index of keypoint descriptors.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpDescriptorIndex.h
+  \brief Approximate nearest neighbour index of keypoint descriptors.
+*/
+
+#ifndef vpDescriptorIndex_h
+#define vpDescriptorIndex_h
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \class vpDescriptorIndex
+  \ingroup group_vision_keypoints
+
+  \brief Approximate nearest neighbour index of a large set of keypoint
+  descriptors, used by vpKeyPoint to match the query descriptors with the
+  reference ones.
+
+  - Binary descriptors (ORB, BRISK, BRIEF, ...), compared with the Hamming
+    distance, are indexed by a multi-probe locality sensitive hashing
+    \cite Lv07: each hash table keys the descriptors with a random subset
+    of their bits, and the buckets whose key differs from the key of the
+    query by at most setMultiProbeLevel() bits are probed.
+  - Float descriptors (SIFT, SURF, ...), compared with the L2 distance, are
+    indexed by a forest of randomized kd-trees \cite Silpa-Anan08: the trees
+    are explored together, nearest branches first, until setNbChecks()
+    descriptors have been compared.
+
+  When the probes find less than \e k candidates for a query, its
+  neighbours are searched exhaustively, so that each query always gets
+  \e k neighbours if the index has at least \e k descriptors.
+
+  The index does not copy the descriptors: they must stay valid and
+  unchanged as long as the index is used. The queries are processed in
+  parallel by the threads of vpThreadPool.
+
+  The index can be saved once built and loaded again with the same
+  descriptors to avoid building it at each start. The loading checks the
+  descriptors against a checksum saved with the index, except for the index
+  stored in a vpLearningDataFile together with its descriptors.
+
+  \code
+#include <visp3/vision/vpDescriptorIndex.h>
+
+int main()
+{
+  std::vector<unsigned char> train(1000 * 32), query(10 * 32);
+  // ... fill train and query with 32 bytes ORB descriptors
+
+  vpDescriptorIndex index;
+  index.build(&train[0], 1000, 32);
+
+  std::vector<int> indexes;
+  std::vector<float> distances;
+  index.knnSearch(&query[0], 10, 2, indexes, distances);
+  // indexes[2*i] and indexes[2*i+1] are the two nearest neighbours of the i-th query
+}
+  \endcode
+*/
+class VISP_EXPORT vpDescriptorIndex
+{
+  friend class vpLearningDataFile;
+
+public:
+  //! Kind of indexed descriptors.
+  typedef enum {
+    NO_DESCRIPTOR,   /*!< The index is empty. */
+    BINARY_DESCRIPTOR, /*!< Bytes compared with the Hamming distance. */
+    FLOAT_DESCRIPTOR /*!< Floats compared with the L2 distance. */
+  } vpDescriptorType;
+
+  vpDescriptorIndex();
+
+  void build(const unsigned char *descriptors, const unsigned int nbDescriptors, const unsigned int descriptorSize);
+  void build(const float *descriptors, const unsigned int nbDescriptors, const unsigned int descriptorSize);
+  void clear();
+
+  //! Indexed descriptors, NULL if the index is empty.
+  inline const void *getDescriptors() const { return m_descriptors; }
+  //! Number of bytes of a binary descriptor, or of floats of a float descriptor.
+  inline unsigned int getDescriptorSize() const { return m_descriptorSize; }
+  //! Kind of indexed descriptors.
+  inline vpDescriptorType getDescriptorType() const { return m_descriptorType; }
+  //! Number of bits of the keys of the hash tables.
+  inline unsigned int getKeySize() const { return m_keySize; }
+  //! Maximum number of bits flipped to probe the neighbour buckets.
+  inline unsigned int getMultiProbeLevel() const { return m_multiProbeLevel; }
+  //! Maximum number of descriptors compared to a query in the kd-trees.
+  inline unsigned int getNbChecks() const { return m_nbChecks; }
+  //! Number of indexed descriptors.
+  inline unsigned int getNbDescriptors() const { return m_nbDescriptors; }
+  //! Number of hash tables.
+  inline unsigned int getNbTables() const { return m_nbTables; }
+  //! Maximum number of threads, 0 meaning all the threads of vpThreadPool.
+  inline unsigned int getNbThreads() const { return m_nbThreads; }
+  //! Number of kd-trees.
+  inline unsigned int getNbTrees() const { return m_nbTrees; }
+
+  bool isCompatible(const void *descriptors, const unsigned int nbDescriptors, const unsigned int descriptorSize,
+                    const vpDescriptorType descriptorType) const;
+  //! Return true if no descriptor is indexed.
+  inline bool empty() const { return m_nbDescriptors == 0; }
+
+  void knnSearch(const unsigned char *queries, const unsigned int nbQueries, const unsigned int k,
+                 std::vector<int> &indexes, std::vector<float> &distances) const;
+  void knnSearch(const float *queries, const unsigned int nbQueries, const unsigned int k,
+                 std::vector<int> &indexes, std::vector<float> &distances) const;
+
+  bool load(const std::string &filename, const unsigned char *descriptors, const unsigned int nbDescriptors,
+            const unsigned int descriptorSize);
+  bool load(const std::string &filename, const float *descriptors, const unsigned int nbDescriptors,
+            const unsigned int descriptorSize);
+  bool load(std::istream &stream, const unsigned char *descriptors, const unsigned int nbDescriptors,
+            const unsigned int descriptorSize);
+  bool load(std::istream &stream, const float *descriptors, const unsigned int nbDescriptors,
+            const unsigned int descriptorSize);
+  void save(const std::string &filename) const;
+  void save(std::ostream &stream) const;
+
+  /*!
+    Set the number of bits of the keys of the hash tables used for binary
+    descriptors. Longer keys give smaller buckets, faster but less accurate
+    searches. Taken into account by the next build().
+  */
+  inline void setKeySize(const unsigned int keySize) { m_keySize = keySize; }
+  /*!
+    Set the maximum number of bits flipped in the key of a query to probe
+    the neighbour buckets of the hash tables. Increasing the level increases
+    the recall and the search time.
+  */
+  inline void setMultiProbeLevel(const unsigned int level) { m_multiProbeLevel = level; }
+  /*!
+    Set the maximum number of descriptors compared to a query in the
+    kd-trees. Increasing it increases the recall and the search time.
+  */
+  inline void setNbChecks(const unsigned int nbChecks) { m_nbChecks = nbChecks; }
+  //! Set the number of hash tables. Taken into account by the next build().
+  inline void setNbTables(const unsigned int nbTables) { m_nbTables = nbTables; }
+  /*!
+    Set the maximum number of threads used to process the queries. With 0,
+    all the threads of vpThreadPool are used.
+  */
+  inline void setNbThreads(const unsigned int nbThreads) { m_nbThreads = nbThreads; }
+  //! Set the number of kd-trees. Taken into account by the next build().
+  inline void setNbTrees(const unsigned int nbTrees) { m_nbTrees = nbTrees; }
+
+private:
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  //! Node of a kd-tree
+  struct Node {
+    //! Split dimension, -1 for a leaf
+    int dim;
+    //! Split value
+    float value;
+    //! Left child of a node, first point of a leaf
+    unsigned int first;
+    //! Right child of a node, end of the points of a leaf
+    unsigned int last;
+  };
+
+  //! Build a hash table or a kd-tree
+  class BuildTask;
+  //! Search the neighbours of a range of queries
+  class SearchTask;
+#endif
+
+  void buildIndex(const void *descriptors, const unsigned int nbDescriptors, const unsigned int descriptorSize,
+                  const vpDescriptorType descriptorType);
+  void buildHashTable(const unsigned int table);
+  void buildKeyPrefixes(const unsigned int table);
+  void buildTree(const unsigned int tree);
+  unsigned int computeChecksum() const;
+  bool loadIndex(std::istream &stream, const void *descriptors, const unsigned int nbDescriptors,
+                 const unsigned int descriptorSize, const vpDescriptorType descriptorType,
+                 const bool checkDescriptors = true);
+  void search(const void *queries, const unsigned int nbQueries, const unsigned int k, std::vector<int> &indexes,
+              std::vector<float> &distances) const;
+
+  const void *m_descriptors;
+  unsigned int m_descriptorSize;
+  vpDescriptorType m_descriptorType;
+  unsigned int m_keySize;
+  unsigned int m_multiProbeLevel;
+  unsigned int m_nbChecks;
+  unsigned int m_nbDescriptors;
+  unsigned int m_nbTables;
+  unsigned int m_nbThreads;
+  unsigned int m_nbTrees;
+  //! Bits of the keys of each hash table
+  std::vector<std::vector<unsigned int> > m_keyBits;
+  //! Sorted keys of each hash table
+  std::vector<std::vector<unsigned int> > m_keys;
+  //! Descriptors of each hash table, in the order of the keys
+  std::vector<std::vector<unsigned int> > m_buckets;
+  //! Position of the first key of each prefix, for each hash table
+  std::vector<std::vector<unsigned int> > m_prefixes;
+  //! Nodes of each kd-tree, the root first
+  std::vector<std::vector<Node> > m_nodes;
+  //! Descriptors of each kd-tree, in the order of the leaves
+  std::vector<std::vector<unsigned int> > m_points;
+};
+
+#endif
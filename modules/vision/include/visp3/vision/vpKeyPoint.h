@@ -63,6 +63,8 @@
 #include <visp3/core/vpConvert.h>
 #include <visp3/core/vpMeterPixelConversion.h>
 #include <visp3/core/vpCylinder.h>
+#include <visp3/vision/vpDescriptorIndex.h>
+#include <visp3/vision/vpLearningDataFile.h>
 
 // Require at least OpenCV >= 2.1.1
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
@@ -307,6 +309,8 @@ public:
   vpKeyPoint(const std::vector<std::string> &detectorNames, const std::vector<std::string> &extractorNames,
              const std::string &matcherName="BruteForce", const vpFilterMatchingType &filterType=ratioDistanceThreshold);
 
+  void buildDescriptorIndex();
+
   unsigned int buildReference(const vpImage<unsigned char> &I);
   unsigned int buildReference(const vpImage<unsigned char> &I,
                               const vpImagePoint &iP, const unsigned int height, const unsigned int width);
@@ -353,6 +357,9 @@ public:
                    std::vector<vpPoint> &inliers, std::vector<unsigned int> &inlierIndex,
                    double &elapsedTime, bool (*func)(vpHomogeneousMatrix *)=NULL);
 
+  static void convertLearningData(const std::string &filename, const bool binaryMode,
+                                  const std::string &mappedFilename);
+
   void createImageMatching(vpImage<unsigned char> &IRef, vpImage<unsigned char> &ICurrent, vpImage<unsigned char> &IMatching);
   void createImageMatching(vpImage<unsigned char> &ICurrent, vpImage<unsigned char> &IMatching);
 
@@ -407,6 +414,16 @@ public:
     return m_covarianceMatrix;
   }
 
+  /*!
+    Get the approximate nearest neighbour index of the train descriptors, for instance to tune its recall with
+    vpDescriptorIndex::setNbChecks() or vpDescriptorIndex::setMultiProbeLevel().
+
+    \return The index used by the matching when setUseDescriptorIndex() is enabled.
+  */
+  inline vpDescriptorIndex &getDescriptorIndex() {
+    return m_descriptorIndex;
+  }
+
   /*!
     Get the elapsed time to compute the keypoint detection.
 
@@ -618,6 +635,10 @@ public:
   /*!
      Get the train descriptors matrix.
 
+     When the learning data were loaded from a file saved by saveMappedLearningData(), the matrix refers to the
+     memory where the file is mapped, that is not reference counted by OpenCV: it is only valid until the learning
+     data are loaded again, reset() is called or this object is destroyed. Use cv::Mat::clone() to keep it longer.
+
      \return : Matrix with descriptors values at each row for each train keypoints (or reference keypoints).
    */
   inline cv::Mat getTrainDescriptors() const {
@@ -668,6 +689,7 @@ public:
   void reset();
 
   void saveLearningData(const std::string &filename, const bool binaryMode=false, const bool saveTrainingImages=true);
+  void saveMappedLearningData(const std::string &filename, const bool saveTrainingImages=true);
 
   /*!
     Set if the covariance matrix has to be computed in the Virtual Visual Servoing approach.
@@ -979,6 +1001,19 @@ public:
   }
 #endif
 
+  /*!
+    Set if the query descriptors are matched with an approximate nearest neighbour index of the train descriptors
+    (see vpDescriptorIndex) instead of the matcher. The search time grows much slower than with a brute force
+    matcher when the train descriptors are accumulated from many views. The index is built by the first matching
+    after the learning, or by buildDescriptorIndex(), and is saved and loaded with the learning data.
+    It needs CV_8U or CV_32F descriptors and is not used when the train keypoints are matched to the query keypoints.
+
+    \param useDescriptorIndex : True to match with the index.
+   */
+  inline void setUseDescriptorIndex(const bool useDescriptorIndex) {
+    m_useDescriptorIndex = useDescriptorIndex;
+  }
+
   /*!
     Set if we want to match the train keypoints to the query keypoints.
 
@@ -1023,6 +1058,8 @@ private:
   vpMatrix m_covarianceMatrix;
   //! Current id associated to the training image used for the learning.
   int m_currentImageId;
+  //! Approximate nearest neighbour index of the train descriptors.
+  vpDescriptorIndex m_descriptorIndex;
   //! Method (based on descriptor distances) to decide if the object is present or not.
   vpDetectionMethodType m_detectionMethod;
   //! Detection score to decide if the object is present or not.
@@ -1051,6 +1088,8 @@ private:
   vpImageFormatType m_imageFormat;
   //! List of k-nearest neighbors for each detected keypoints (if the method chosen is based upon on knn).
   std::vector<std::vector<cv::DMatch> > m_knnMatches;
+  //! Mapped learning file whose data are used by the train descriptors.
+  vpLearningDataFile m_learningDataFile;
   //! Map descriptor enum type to string.
   std::map<vpFeatureDescriptorType, std::string> m_mapOfDescriptorNames;
   //! Map detector enum type to string.
@@ -1116,6 +1155,8 @@ private:
 #endif
   //! Flag set if a percentage value is used to determine the number of inliers for the Ransac method.
   bool m_useConsensusPercentage;
+  //! Flag set if the query descriptors are matched with the index of the train descriptors.
+  bool m_useDescriptorIndex;
   //! Flag set if a knn matching method must be used.
   bool m_useKnn;
   //! Flag set if we want to match the train keypoints to the query keypoints, useful when there is only one train image
@@ -1144,6 +1185,12 @@ private:
 
   void initFeatureNames();
 
+  bool loadDescriptorIndex(const std::string &filename);
+  void loadMappedLearningData(const std::string &filename, const bool append, const int startClassId,
+                              const int startImageId);
+
+  std::map<int, std::string> saveTrainingImageFiles(const std::string &parent);
+
   inline size_t myKeypointHash(const cv::KeyPoint &kp) {
     size_t _Val = 2166136261U, scale = 16777619U;
     Cv32suf u;
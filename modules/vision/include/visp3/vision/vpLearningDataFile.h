@@ -0,0 +1,154 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Memory mapped file of keypoint learning data.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpLearningDataFile.h
+  \brief Memory mapped file of keypoint learning data.
+*/
+
+#ifndef vpLearningDataFile_h
+#define vpLearningDataFile_h
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/vision/vpDescriptorIndex.h>
+
+/*!
+  \class vpLearningDataFile
+  \ingroup group_vision_keypoints
+
+  \brief File of keypoint learning data that is mapped in memory instead of
+  being parsed, used by vpKeyPoint::saveMappedLearningData() and
+  vpKeyPoint::loadLearningData().
+
+  The file is a versioned little endian container made of a 64 bytes
+  header, a table of sections and the sections themselves, each one aligned
+  on 64 bytes:
+  - the keypoints, stored as an array of vpLearningDataFile::KeyPoint;
+  - the descriptors, stored as a row major matrix;
+  - optionally the 3D coordinates of the keypoints, stored as 3 floats per
+    keypoint;
+  - optionally the identifiers and paths of the training images;
+  - optionally the index of the descriptors saved by vpDescriptorIndex.
+
+  On a little endian host providing \c mmap() or \c MapViewOfFile(), open()
+  only reads the header and the table of sections, and maps the file in
+  memory: the getters return pointers to the mapped data, that are read
+  from the disk by the system when they are first accessed. The mapping is
+  private, so that the data can be modified in memory without modifying the
+  file. Otherwise, each section is read in memory, and converted to the host
+  byte order, the first time it is requested.
+
+  The data stay valid as long as the file is open. Copies of a
+  vpLearningDataFile share the same mapping, which is released when the
+  last copy is closed or destroyed. The getters can be called concurrently
+  from several threads, the sections read on demand being protected by a
+  mutex.
+
+  \code
+#include <visp3/vision/vpLearningDataFile.h>
+
+int main()
+{
+  vpLearningDataFile file;
+  file.open("learning_data.bin");
+  const vpLearningDataFile::KeyPoint *keyPoints = file.getKeyPoints();
+  const unsigned char *descriptors = (const unsigned char *) file.getDescriptors();
+  // descriptors + i * file.getDescriptorSize() * file.getDescriptorElementSize() is the descriptor of keyPoints[i]
+}
+  \endcode
+*/
+class VISP_EXPORT vpLearningDataFile
+{
+public:
+  //! Keypoint stored in the file, 32 bytes.
+  struct KeyPoint {
+    float u;        //!< Horizontal coordinate in the training image.
+    float v;        //!< Vertical coordinate in the training image.
+    float size;     //!< Diameter of the neighbourhood.
+    float angle;    //!< Orientation in degrees.
+    float response; //!< Response of the detector.
+    int octave;     //!< Pyramid layer where the keypoint was detected.
+    int classId;    //!< Identifier of the keypoint.
+    int imageId;    //!< Identifier of the training image, -1 if none.
+  };
+
+  vpLearningDataFile();
+  vpLearningDataFile(const vpLearningDataFile &file);
+  virtual ~vpLearningDataFile();
+
+  void close();
+
+  const void *getDescriptors() const;
+  unsigned int getDescriptorElementSize() const;
+  unsigned int getDescriptorSize() const;
+  int getDescriptorType() const;
+  std::map<int, std::string> getImages() const;
+  bool getIndex(vpDescriptorIndex &index) const;
+  const KeyPoint *getKeyPoints() const;
+  unsigned int getNbDescriptors() const;
+  const float *getPoints3D() const;
+
+  bool hasIndex() const;
+  bool hasPoints3D() const;
+
+  static bool isLearningDataFile(const std::string &filename);
+  //! Return true if a file is open.
+  inline bool isOpen() const { return m_data != NULL; }
+  bool isMapped() const;
+
+  void open(const std::string &filename, const bool map = true);
+
+  vpLearningDataFile &operator=(const vpLearningDataFile &file);
+
+  static void save(const std::string &filename, const std::vector<KeyPoint> &keyPoints, const void *descriptors,
+                   const unsigned int descriptorSize, const int descriptorType,
+                   const unsigned int descriptorElementSize, const std::vector<float> &points3D,
+                   const std::map<int, std::string> &images, const vpDescriptorIndex *index = NULL);
+
+private:
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  //! Mapping or content of an open file, shared by the copies
+  class Data;
+#endif
+
+  const char *getSection(const unsigned int type, size_t &size) const;
+
+  Data *m_data;
+};
+
+#endif
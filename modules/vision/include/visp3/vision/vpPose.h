@@ -67,6 +67,14 @@
   \brief Class used for pose computation from N points (pose from point only).
   Some of the algorithms implemented in this class are described in \cite Marchand16a.
 
+  The points are given with addPoint() or addPoints(). Their coordinates in the
+  object frame and in the image plane are copied in a contiguous array of
+  correspondences, on which all the pose estimation methods and the RANSAC
+  work. The list of vpPoint listP is kept for compatibility: it remains the
+  reference set of points, and the correspondences are copied from it at each
+  pose computation, so that the points modified or replaced directly in listP
+  are taken into account.
+
   \note It is also possible to estimate a pose from other features using vpPoseFeatures class.
 
   To see how to use this class you can follow the \ref tutorial-pose-estimation.
@@ -87,7 +95,11 @@ public:
       DEMENTHON_LOWE   , /*!< Non linear Lowe aproach initialized by Dementhon approach */
       VIRTUAL_VS       , /*!< Non linear virtual visual servoing approach that needs an initialization from Lagrange or Dementhon aproach */
       DEMENTHON_VIRTUAL_VS, /*!< Non linear virtual visual servoing approach initialized by Dementhon approach */
-      LAGRANGE_VIRTUAL_VS   /*!< Non linear virtual visual servoing approach initialized by Lagrange approach */
+      LAGRANGE_VIRTUAL_VS, /*!< Non linear virtual visual servoing approach initialized by Lagrange approach */
+      P3P              , /*!< Minimal P3P approach on the three first points, the other points remove the ambiguity (does't need an initialization) */
+      EPNP             , /*!< Linear EPnP approach, in O(n) (does't need an initialization) */
+      EPNP_VIRTUAL_VS  , /*!< Non linear virtual visual servoing approach initialized by EPnP approach */
+      PROSAC             /*!< Robust PROSAC approach with P3P hypotheses, adaptive number of trials and EPnP final fit (does't need an initialization) */
     } vpPoseMethodType;
 
   enum FILTERING_RANSAC_FLAGS {
@@ -97,6 +109,16 @@ public:
     CHECK_DEGENERATE_POINTS           = 0x8   /*!< Check for degenerate points during the RANSAC. */
   };
 
+  /*!
+    2D-3D correspondence used by the pose estimation methods: coordinates of
+    a point in the object frame and in the image plane. The correspondences
+    are stored contiguously, without the vectors allocated by vpPoint.
+  */
+  struct Correspondence {
+    double oX, oY, oZ; //!< Coordinates of the point in the object frame
+    double x, y;       //!< Coordinates of the point in the image plane
+  };
+
   unsigned int npt ;             //!< Number of point used in pose computation
   std::list<vpPoint> listP ;     //!< Array of point (use here class vpPoint)
 
@@ -108,7 +130,11 @@ protected :
 private:
   int vvsIterMax ; //! define the maximum number of iteration in VVS
   //! variable used in the Dementhon approach
-  std::vector<vpPoint> c3d ;
+  std::vector<Correspondence> c3d ;
+  //! Correspondences of the points of listP, used by the pose estimation methods
+  std::vector<Correspondence> correspondences;
+  //! True for the poses of the RANSAC given the correspondences without listP
+  bool correspondencesOnly;
   //! Flag used to specify if the covariance matrix has to be computed or not.
   bool computeCovariance;
   //! Covariance matrix
@@ -121,74 +147,23 @@ private:
   double ransacThreshold;
   double distanceToPlaneForCoplanarityTest;
   int ransacFlags;
-  std::vector<vpPoint> listOfPoints;
   bool useParallelRansac;
   int nbParallelRansacThreads;
+  //! Quality of the points, used to order the samples of the PROSAC
+  std::vector<double> prosacQuality;
 
 
-  //For parallel RANSAC
-  class RansacFunctor {
-  public:
-    RansacFunctor(const vpHomogeneousMatrix &cMo_,
-                  const unsigned int ransacNbInlierConsensus_, const int ransacMaxTrials_,
-                  const double ransacThreshold_, const unsigned int initial_seed_,
-                  const bool checkDegeneratePoints_, const std::vector<vpPoint> &listOfUniquePoints_,
-                  bool (*func_)(vpHomogeneousMatrix *)) :
-      m_best_consensus(), m_checkDegeneratePoints(checkDegeneratePoints_), m_cMo(cMo_), m_foundSolution(false),
-      m_func(func_), m_initial_seed(initial_seed_), m_listOfUniquePoints(listOfUniquePoints_), m_nbInliers(0),
-      m_ransacMaxTrials(ransacMaxTrials_), m_ransacNbInlierConsensus(ransacNbInlierConsensus_), m_ransacThreshold(ransacThreshold_) {
-    }
-
-    RansacFunctor() :
-      m_best_consensus(),m_checkDegeneratePoints(false), m_cMo(), m_foundSolution(false), m_func(NULL),
-      m_initial_seed(0), m_listOfUniquePoints(), m_nbInliers(0), m_ransacMaxTrials(), m_ransacNbInlierConsensus(),
-      m_ransacThreshold() {
-    }
-
-    void operator()() {
-      m_foundSolution = poseRansacImpl();
-    }
-
-    // Access the return value.
-    bool getResult() const {
-      return m_foundSolution;
-    }
-
-    std::vector<unsigned int> getBestConsensus() const {
-      return m_best_consensus;
-    }
-
-    vpHomogeneousMatrix getEstimatedPose() const {
-      return m_cMo;
-    }
-
-    unsigned int getNbInliers() const {
-      return m_nbInliers;
-    }
-
-  private:
-    std::vector<unsigned int> m_best_consensus;
-    bool m_checkDegeneratePoints;
-    vpHomogeneousMatrix m_cMo;
-    bool m_foundSolution;
-    bool (*m_func)(vpHomogeneousMatrix *);
-    unsigned int m_initial_seed;
-    std::vector<vpPoint> m_listOfUniquePoints;
-    unsigned int m_nbInliers;
-    int m_ransacMaxTrials;
-    unsigned int m_ransacNbInlierConsensus;
-    double m_ransacThreshold;
-
-    bool poseRansacImpl();
-  };
-
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
-  static vpThread::Return poseRansacImplThread(vpThread::Args arg);
-#endif
+  //Estimation problem of the RANSAC, solved by vpRansacEngine
+  class RansacProblem;
 
 
 protected:
   double computeResidualDementhon(const vpHomogeneousMatrix &cMo) ;
+  void updateCorrespondences() ;
+  void updateRansacInliers() ;
+
+  static unsigned int computeP3P(const Correspondence &P1, const Correspondence &P2, const Correspondence &P3,
+                                 vpHomogeneousMatrix cMo[4]) ;
 
   // method used in poseDementhonPlan()
   int calculArbreDementhon(vpMatrix &b, vpColVector &U, vpHomogeneousMatrix &cMo) ;
@@ -212,9 +187,12 @@ public:
   void init() ;
   void poseDementhonPlan(vpHomogeneousMatrix &cMo) ;
   void poseDementhonNonPlan(vpHomogeneousMatrix &cMo) ;
+  void poseEPnP(vpHomogeneousMatrix &cMo) ;
   void poseLagrangePlan(vpHomogeneousMatrix &cMo, const int coplanar_plane_type=0) ;
   void poseLagrangeNonPlan(vpHomogeneousMatrix &cMo) ;
   void poseLowe(vpHomogeneousMatrix & cMo) ;
+  void poseP3P(vpHomogeneousMatrix &cMo) ;
+  bool poseProsac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMatrix *)=NULL) ;
   bool poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMatrix *)=NULL) ;
   void poseVirtualVSrobust(vpHomogeneousMatrix & cMo) ;
   void poseVirtualVS(vpHomogeneousMatrix & cMo) ;
@@ -281,7 +259,7 @@ public:
     Set the number of threads for the parallel RANSAC implementation.
 
     \note You have to enable the parallel version with setUseParallelRansac().
-    If the number of threads is 0, the number of threads to use is automatically determined with OpenMP.
+    If the number of threads is 0, all the threads of vpThreadPool are used.
     \sa setUseParallelRansac
   */
   inline void setNbParallelRansacThreads(const int nb) {
@@ -298,14 +276,30 @@ public:
   }
 
   /*!
-    Set if parallel RANSAC version should be used or not.
+    Set if parallel RANSAC version should be used or not. The parallel
+    version gives the same pose as the sequential one.
 
-    \note Need Pthread.
+    \note Need Pthread or Windows threads, see vpThreadPool.
   */
   inline void setUseParallelRansac(const bool use) {
     useParallelRansac = use;
   }
 
+  /*!
+    Set the quality of the points, used by the PROSAC to draw first the
+    samples among the points of best quality, e.g. the opposite of the
+    distances between the descriptors of matched keypoints.
+
+    \param quality : Quality of each point, in the order of addition. The
+    higher the better. If the vector is empty or if its size differs from
+    the number of points, the points are supposed to be added by decreasing
+    quality.
+    \sa poseProsac()
+  */
+  inline void setProsacQuality(const std::vector<double> &quality) {
+    prosacQuality = quality;
+  }
+
   /*!
     Get the vector of points.
 
@@ -38,6 +38,7 @@
 #include <visp3/vision/vpHomography.h>
 #include <visp3/core/vpColVector.h>
 #include <visp3/core/vpRansac.h>
+#include <visp3/core/vpRansacEngine.h>
 
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpDisplay.h>
@@ -304,6 +305,139 @@ vpHomography::computeResidual(vpColVector &x, vpColVector &M, vpColVector &d)
 #endif //#ifndef DOXYGEN_SHOULD_SKIP_THIS
 
 
+
+namespace {
+/*!
+  Estimation of an homography from matched points, solved by vpRansacEngine.
+  A model is the homography aHb normalized by its last element, and the error
+  of a couple of points is the distance between ^a p and aHb ^b p. As in the
+  former implementation, a couple of points whose error equals the threshold
+  is an inlier.
+*/
+class HomographyRansacProblem : public vpRansacEngine::Problem
+{
+public:
+  HomographyRansacProblem(const std::vector<double> &xb, const std::vector<double> &yb,
+                          const std::vector<double> &xa, const std::vector<double> &ya,
+                          const double threshold, const bool normalization)
+    : m_xb(xb), m_yb(yb), m_xa(xa), m_ya(ya), m_threshold(threshold), m_normalization(normalization)
+  {
+  }
+
+  unsigned int getNbData() const { return (unsigned int) m_xb.size(); }
+  unsigned int getSampleSize() const { return 4; }
+  bool isThresholdInclusive() const { return true; }
+
+  // Three of the four points are colinear in one of the images
+  bool isDegenerate(const unsigned int *sample) const
+  {
+    for (unsigned int i = 0; i < 2; i++) {
+      for (unsigned int j = i + 1; j < 3; j++) {
+        for (unsigned int k = j + 1; k < 4; k++) {
+          if (isColinear(m_xa, m_ya, sample[i], sample[j], sample[k]) ||
+              isColinear(m_xb, m_yb, sample[i], sample[j], sample[k])) {
+            return true;
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  unsigned int computeModels(const unsigned int *sample, std::vector<vpColVector> &models) const
+  {
+    std::vector<double> xb(4), yb(4), xa(4), ya(4);
+    for (unsigned int i = 0; i < 4; i++) {
+      xb[i] = m_xb[sample[i]];
+      yb[i] = m_yb[sample[i]];
+      xa[i] = m_xa[sample[i]];
+      ya[i] = m_ya[sample[i]];
+    }
+
+    vpColVector model;
+    if (! fit(xb, yb, xa, ya, model)) {
+      return 0;
+    }
+
+    // Residual of the sample
+    double errors[4];
+    double r = 0;
+    computeErrors(model, xb, yb, xa, ya, 0, 4, errors);
+    for (unsigned int i = 0; i < 4; i++) {
+      r += errors[i] * errors[i];
+    }
+    if (sqrt(r / 4) >= m_threshold) {
+      return 0;
+    }
+    models.push_back(model);
+    return 1;
+  }
+
+  void computeErrors(const vpColVector &model, const unsigned int begin, const unsigned int end, double *errors) const
+  {
+    computeErrors(model, m_xb, m_yb, m_xa, m_ya, begin, end, errors);
+  }
+
+  bool refineModel(const std::vector<unsigned int> &inliers, vpColVector &model) const
+  {
+    const size_t n = inliers.size();
+    std::vector<double> xb(n), yb(n), xa(n), ya(n);
+    for (size_t i = 0; i < n; i++) {
+      xb[i] = m_xb[inliers[i]];
+      yb[i] = m_yb[inliers[i]];
+      xa[i] = m_xa[inliers[i]];
+      ya[i] = m_ya[inliers[i]];
+    }
+    return fit(xb, yb, xa, ya, model);
+  }
+
+private:
+  static bool isColinear(const std::vector<double> &x, const std::vector<double> &y,
+                         const unsigned int i, const unsigned int j, const unsigned int k)
+  {
+    const double cross = (x[j] - x[i]) * (y[k] - y[i]) - (y[j] - y[i]) * (x[k] - x[i]);
+    return cross * cross < vpEps;
+  }
+
+  // Homography estimated with the DLT
+  bool fit(const std::vector<double> &xb, const std::vector<double> &yb,
+           const std::vector<double> &xa, const std::vector<double> &ya, vpColVector &model) const
+  {
+    vpHomography aHb;
+    try {
+      vpHomography::DLT(xb, yb, xa, ya, aHb, m_normalization);
+    }
+    catch(...) {
+      return false;
+    }
+    aHb /= aHb[2][2];
+    model.resize(9, false);
+    for (unsigned int i = 0; i < 9; i++) {
+      model[i] = aHb.data[i];
+    }
+    return true;
+  }
+
+  static void computeErrors(const vpColVector &model, const std::vector<double> &xb, const std::vector<double> &yb,
+                            const std::vector<double> &xa, const std::vector<double> &ya,
+                            const unsigned int begin, const unsigned int end, double *errors)
+  {
+    const double *h = model.data;
+    const double *pxb = &xb[0], *pyb = &yb[0], *pxa = &xa[0], *pya = &ya[0];
+    for (unsigned int i = begin; i < end; i++) {
+      const double z = h[6] * pxb[i] + h[7] * pyb[i] + h[8];
+      const double dx = (h[0] * pxb[i] + h[1] * pyb[i] + h[2]) / z - pxa[i];
+      const double dy = (h[3] * pxb[i] + h[4] * pyb[i] + h[5]) / z - pya[i];
+      errors[i - begin] = sqrt(dx * dx + dy * dy);
+    }
+  }
+
+  const std::vector<double> &m_xb, &m_yb, &m_xa, &m_ya;
+  const double m_threshold;
+  const bool m_normalization;
+};
+}
+
 void
 vpHomography::initRansac(unsigned int n,
 			 double *xb, double *yb,
@@ -329,6 +463,13 @@ vpHomography::initRansac(unsigned int n,
   homography matrix by resolving \f$^a{\bf p} = ^a{\bf H}_b\; ^b{\bf p}\f$
   using Ransac algorithm.
 
+  The hypotheses are computed from samples of 4 couples of points with the
+  DLT and evaluated in parallel by vpRansacEngine, with a maximum of 1000
+  trials. The degenerate samples, where three points are colinear, are drawn
+  again without counting a trial. The best hypotheses are refined with the
+  DLT from their inliers (LO-RANSAC \cite Chum03), and the search stops when
+  a hypothesis has \e nbInliersConsensus inliers or after 1000 trials.
+
   \param xb, yb : Coordinates vector of matched points in image b. These coordinates are expressed in meters.
   \param xa, ya : Coordinates vector of matched points in image a. These coordinates are expressed in meters.
   \param aHb : Estimated homography that relies the transformation from image a to image b.
@@ -345,7 +486,9 @@ vpHomography::initRansac(unsigned int n,
   \param normalization : When set to true, the coordinates of the points are normalized. The normalization
   carried out is the one preconized by Hartley.
 
-  \return true if the homography could be computed, false otherwise.
+  \return true if the homography could be computed with at least \e nbInliersConsensus inliers, false otherwise.
+
+  \exception vpException::fatalError : If no nondegenerate sample is drawn after 1000 attempts.
 
 */
 bool vpHomography::ransac(const std::vector<double> &xb, const std::vector<double> &yb,
@@ -366,169 +509,55 @@ bool vpHomography::ransac(const std::vector<double> &xb, const std::vector<doubl
   if(n<4)
     throw(vpException(vpException::fatalError, "There must be at least 4 matched points"));
 
-  vpUniRand random((const long)time(NULL)) ;
+  HomographyRansacProblem problem(xb, yb, xa, ya, threshold, normalization);
+  vpRansacEngine engine;
+  engine.setThreshold(threshold);
+  engine.setMaxTrials(1000);
+  engine.setNbInliersToReachConsensus(nbInliersConsensus);
+  // The search must go on until the consensus is reached
+  engine.setConfidence(0);
 
+  vpColVector model;
   std::vector<unsigned int> best_consensus;
-  std::vector<unsigned int> cur_consensus;
-  std::vector<unsigned int> cur_outliers;
-  std::vector<unsigned int> cur_randoms;
-
-  std::vector<unsigned int> rand_ind;
-
-  unsigned int nbMinRandom = 4 ;
-  unsigned int ransacMaxTrials = 1000;
-  unsigned int maxDegenerateIter = 1000;
-
-  unsigned int nbTrials = 0;
-  unsigned int nbDegenerateIter = 0;
-  unsigned int nbInliers = 0;
+  bool foundSolution = engine.estimate(problem, model, best_consensus);
+  if (engine.isDegenerateLimitReached()) {
+    vpERROR_TRACE("Unable to select a nondegenerate data set");
+    throw(vpException(vpException::fatalError, "Unable to select a nondegenerate data set"));
+  }
 
-  bool foundSolution = false;
+  inliers.assign(n, false);
+  for (size_t i = 0; i < best_consensus.size(); i++)
+    inliers[best_consensus[i]] = true;
 
-  std::vector<double> xa_rand(nbMinRandom);
-  std::vector<double> ya_rand(nbMinRandom);
-  std::vector<double> xb_rand(nbMinRandom);
-  std::vector<double> yb_rand(nbMinRandom);
+  if (! foundSolution || best_consensus.size() < nbInliersConsensus)
+    return false;
 
-  if (inliers.size() != n)
-    inliers.resize(n);
+  std::vector<double> xa_best(best_consensus.size());
+  std::vector<double> ya_best(best_consensus.size());
+  std::vector<double> xb_best(best_consensus.size());
+  std::vector<double> yb_best(best_consensus.size());
 
-  while (nbTrials < ransacMaxTrials && nbInliers < nbInliersConsensus)
+  for(unsigned i = 0 ; i < best_consensus.size(); i++)
   {
-    cur_outliers.clear();
-    cur_randoms.clear();
-
-    bool degenerate = true;
-    while(degenerate == true){
-      std::vector<bool> usedPt(n, false);
-
-      rand_ind.clear();
-      for(unsigned int i = 0; i < nbMinRandom; i++)
-      {
-        // Generate random indicies in the range 0..n
-        unsigned int r = (unsigned int)ceil(random()*n) -1;
-        while(usedPt[r]) {
-          r = (unsigned int)ceil(random()*n) -1;
-        }
-        usedPt[r] = true;
-        rand_ind.push_back(r);
-
-        xa_rand[i] = xa[r];
-        ya_rand[i] = ya[r];
-        xb_rand[i] = xb[r];
-        yb_rand[i] = yb[r];
-      }
-
-      try{
-        if (! vpHomography::degenerateConfiguration(xb_rand, yb_rand, xa_rand, ya_rand)) {
-          vpHomography::DLT(xb_rand, yb_rand, xa_rand, ya_rand, aHb, normalization);
-         degenerate = false;
-        }
-      }
-      catch(...){
-        degenerate = true;
-      }
-
-      nbDegenerateIter ++;
-
-      if (nbDegenerateIter > maxDegenerateIter){
-        vpERROR_TRACE("Unable to select a nondegenerate data set");
-        throw(vpException(vpException::fatalError, "Unable to select a nondegenerate data set"));
-      }
-    }
-
-    aHb /= aHb[2][2] ;
-
-    // Computing Residual
-    double r = 0;
-    vpColVector a(3), b(3), c(3) ;
-    for (unsigned int i=0 ; i < nbMinRandom ; i++) {
-      a[0] = xa_rand[i] ; a[1] = ya_rand[i] ; a[2] = 1 ;
-      b[0] = xb_rand[i] ; b[1] = yb_rand[i] ; b[2] = 1 ;
-
-      c = aHb*b; c /= c[2] ;
-      r += (a-c).sumSquare() ;
-      //cout << "point " <<i << "  " << (a-c).sumSquare()  <<endl ;;
-    }
-
-    // Finding inliers & ouliers
-    r = sqrt(r/nbMinRandom);
-    //std::cout << "Candidate residual: " << r << std::endl;
-    if (r < threshold)
-    {
-      unsigned int nbInliersCur = 0;
-      for (unsigned int i = 0; i < n ; i++)
-      {
-        a[0] = xa[i] ; a[1] = ya[i] ; a[2] = 1 ;
-        b[0] = xb[i] ; b[1] = yb[i] ; b[2] = 1 ;
-
-        c = aHb*b ; c /= c[2] ;
-        double error = sqrt((a-c).sumSquare()) ;
-        if(error <= threshold){
-          nbInliersCur++;
-          cur_consensus.push_back(i);
-          inliers[i] = true;
-        }
-        else{
-          cur_outliers.push_back(i);
-          inliers[i] = false;
-        }
-      }
-      //std::cout << "nb inliers that matches: " << nbInliersCur << std::endl;
-      if(nbInliersCur > nbInliers)
-      {
-        foundSolution = true;
-        best_consensus = cur_consensus;
-        nbInliers = nbInliersCur;
-      }
-
-      cur_consensus.clear();
-    }
-
-    nbTrials++;
-    if(nbTrials >= ransacMaxTrials){
-      vpERROR_TRACE("Ransac reached the maximum number of trials");
-      foundSolution = true;
-    }
+    xa_best[i] = xa[best_consensus[i]];
+    ya_best[i] = ya[best_consensus[i]];
+    xb_best[i] = xb[best_consensus[i]];
+    yb_best[i] = yb[best_consensus[i]];
   }
 
-  if(foundSolution){
-    if(nbInliers >= nbInliersConsensus)
-    {
-      std::vector<double> xa_best(best_consensus.size());
-      std::vector<double> ya_best(best_consensus.size());
-      std::vector<double> xb_best(best_consensus.size());
-      std::vector<double> yb_best(best_consensus.size());
-
-      for(unsigned i = 0 ; i < best_consensus.size(); i++)
-      {
-        xa_best[i] = xa[best_consensus[i]];
-        ya_best[i] = ya[best_consensus[i]];
-        xb_best[i] = xb[best_consensus[i]];
-        yb_best[i] = yb[best_consensus[i]];
-      }
-
-      vpHomography::DLT(xb_best, yb_best, xa_best, ya_best, aHb, normalization) ;
-      aHb /= aHb[2][2];
-
-      residual = 0 ;
-      vpColVector a(3), b(3), c(3);
-      for (unsigned int i=0 ; i < best_consensus.size() ; i++) {
-        a[0] = xa_best[i] ; a[1] = ya_best[i] ; a[2] = 1 ;
-        b[0] = xb_best[i] ; b[1] = yb_best[i] ; b[2] = 1 ;
+  vpHomography::DLT(xb_best, yb_best, xa_best, ya_best, aHb, normalization) ;
+  aHb /= aHb[2][2];
 
-        c = aHb*b ; c /= c[2] ;
-        residual += (a-c).sumSquare() ;
-      }
+  residual = 0 ;
+  vpColVector a(3), b(3), c(3);
+  for (unsigned int i=0 ; i < best_consensus.size() ; i++) {
+    a[0] = xa_best[i] ; a[1] = ya_best[i] ; a[2] = 1 ;
+    b[0] = xb_best[i] ; b[1] = yb_best[i] ; b[2] = 1 ;
 
-      residual = sqrt(residual/best_consensus.size());
-      return true;
-    }
-    else {
-      return false;
-    }
-  }
-  else {
-    return false;
+    c = aHb*b ; c /= c[2] ;
+    residual += (a-c).sumSquare() ;
   }
+
+  residual = sqrt(residual/best_consensus.size());
+  return true;
 }
@@ -0,0 +1,1103 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Approximate nearest neighbour index of keypoint descriptors.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpDescriptorIndex.cpp
+  \brief Approximate nearest neighbour index of keypoint descriptors.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/vision/vpDescriptorIndex.h>
+
+namespace {
+//! Maximum number of descriptors in a leaf of a kd-tree
+const unsigned int leafSize = 8;
+//! Number of dimensions of largest variance among which a kd-tree node is split
+const unsigned int nbSplitDimensions = 5;
+//! Number of descriptors used to compute the variance of a kd-tree node
+const unsigned int varianceSampleSize = 100;
+//! Maximum number of bits of the prefixes of the keys
+const unsigned int maxPrefixSize = 24;
+//! Maximum number of hash tables or kd-trees of a file
+const unsigned int maxNbStructures = 1024;
+//! Number of queries processed together by a thread
+const unsigned int queryGrainSize = 16;
+//! Identifier and version of the files
+const char fileMagic[4] = { 'V', 'P', 'D', 'I' };
+const unsigned int fileVersion = 2;
+
+/*!
+  Minimal random number generator of Park and Miller \cite Park:1988, so that
+  an index built from the same descriptors is always the same.
+*/
+class RandomGenerator
+{
+public:
+  explicit RandomGenerator(const long seed) : m_x(seed % 2147483647)
+  {
+    if (m_x <= 0)
+      m_x += 2147483646;
+  }
+
+  //! Uniform random index in [0, n)
+  unsigned int operator()(const unsigned int n)
+  {
+    const long a = 16807, m = 2147483647, q = 127773, r = 2836;
+    const long k = m_x / q;
+    m_x = a * (m_x - k * q) - k * r;
+    if (m_x < 0)
+      m_x += m;
+    return std::min((unsigned int) (n * ((m_x - 1) / (double) (m - 1))), n - 1);
+  }
+
+private:
+  long m_x;
+};
+
+//! Number of bits set
+inline unsigned int bitCount(unsigned int x)
+{
+#if defined(__GNUC__)
+  return (unsigned int) __builtin_popcount(x);
+#else
+  x = x - ((x >> 1) & 0x55555555u);
+  x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+  return (((x + (x >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#endif
+}
+
+//! Hamming distance between two binary descriptors
+inline float hammingDistance(const unsigned char *a, const unsigned char *b, const unsigned int size)
+{
+  unsigned int distance = 0, i = 0;
+  for (; i + sizeof(unsigned int) <= size; i += sizeof(unsigned int)) {
+    unsigned int x, y;
+    memcpy(&x, a + i, sizeof(x));
+    memcpy(&y, b + i, sizeof(y));
+    distance += bitCount(x ^ y);
+  }
+  for (; i < size; i++) {
+    distance += bitCount((unsigned int) (a[i] ^ b[i]));
+  }
+  return (float) distance;
+}
+
+//! Squared L2 distance between two float descriptors, with independent sums that can be vectorized
+inline float squaredDistance(const float *a, const float *b, const unsigned int size)
+{
+  float d0 = 0, d1 = 0, d2 = 0, d3 = 0;
+  unsigned int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const float e0 = a[i] - b[i], e1 = a[i + 1] - b[i + 1], e2 = a[i + 2] - b[i + 2], e3 = a[i + 3] - b[i + 3];
+    d0 += e0 * e0;
+    d1 += e1 * e1;
+    d2 += e2 * e2;
+    d3 += e3 * e3;
+  }
+  for (; i < size; i++) {
+    const float e = a[i] - b[i];
+    d0 += e * e;
+  }
+  return (d0 + d1) + (d2 + d3);
+}
+
+//! Insert a neighbour in the k nearest ones, sorted by increasing distance
+inline void insertNeighbour(int *indexes, float *distances, const unsigned int k, unsigned int &nbNeighbours,
+                            const int index, const float distance)
+{
+  if (nbNeighbours == k && distance >= distances[k - 1]) {
+    return;
+  }
+  unsigned int i = nbNeighbours < k ? nbNeighbours++ : k - 1;
+  for (; i > 0 && distances[i - 1] > distance; i--) {
+    indexes[i] = indexes[i - 1];
+    distances[i] = distances[i - 1];
+  }
+  indexes[i] = index;
+  distances[i] = distance;
+}
+
+//! Key of a binary descriptor made of the given bits
+inline unsigned int computeKey(const unsigned char *descriptor, const std::vector<unsigned int> &bits)
+{
+  unsigned int key = 0;
+  for (unsigned int j = 0; j < bits.size(); j++) {
+    key |= ((descriptor[bits[j] >> 3] >> (bits[j] & 7)) & 1u) << j;
+  }
+  return key;
+}
+
+//! Number of bits of the prefixes of a table of prefixes
+inline unsigned int prefixSize(const std::vector<unsigned int> &prefixes)
+{
+  unsigned int size = 0;
+  while ((2u << size) < prefixes.size()) {
+    size++;
+  }
+  return size;
+}
+
+//! Branch of a kd-tree to explore, the nearest one being on top of the heap
+struct Branch {
+  float bound;
+  unsigned int tree;
+  unsigned int node;
+
+  bool operator<(const Branch &branch) const { return bound > branch.bound; }
+};
+
+//! Order of the dimensions by decreasing variance
+class GreaterVariance
+{
+public:
+  explicit GreaterVariance(const std::vector<double> &variance) : m_variance(variance) {}
+  bool operator()(const unsigned int a, const unsigned int b) const
+  {
+    return m_variance[a] > m_variance[b] || (m_variance[a] == m_variance[b] && a < b);
+  }
+
+private:
+  const std::vector<double> &m_variance;
+};
+
+//! Coordinate of a descriptor along a dimension
+class Coordinate
+{
+public:
+  Coordinate(const float *descriptors, const unsigned int size, const unsigned int dim)
+    : m_descriptors(descriptors), m_size(size), m_dim(dim)
+  {
+  }
+  float operator()(const unsigned int i) const { return m_descriptors[(size_t) i * m_size + m_dim]; }
+
+private:
+  const float *m_descriptors;
+  unsigned int m_size;
+  unsigned int m_dim;
+};
+
+//! True for the descriptors whose coordinate is below a value
+class LowerCoordinate
+{
+public:
+  LowerCoordinate(const Coordinate &coordinate, const float value) : m_coordinate(coordinate), m_value(value) {}
+  bool operator()(const unsigned int i) const { return m_coordinate(i) < m_value; }
+
+private:
+  Coordinate m_coordinate;
+  float m_value;
+};
+
+//! Order of the descriptors by increasing coordinate
+class LessCoordinate
+{
+public:
+  explicit LessCoordinate(const Coordinate &coordinate) : m_coordinate(coordinate) {}
+  bool operator()(const unsigned int a, const unsigned int b) const { return m_coordinate(a) < m_coordinate(b); }
+
+private:
+  Coordinate m_coordinate;
+};
+
+//! Write unsigned int in little endian
+void writeBinaryUInt(std::ostream &stream, const std::vector<unsigned int> &values)
+{
+  if (values.empty()) {
+    return;
+  }
+  std::vector<unsigned char> bytes(4 * values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    for (unsigned int j = 0; j < 4; j++) {
+      bytes[4 * i + j] = (unsigned char) ((values[i] >> (8 * j)) & 0xFF);
+    }
+  }
+  stream.write((const char *) &bytes[0], (std::streamsize) bytes.size());
+}
+
+//! Read unsigned int stored in little endian
+bool readBinaryUInt(std::istream &stream, std::vector<unsigned int> &values)
+{
+  if (values.empty()) {
+    return true;
+  }
+  std::vector<unsigned char> bytes(4 * values.size());
+  if (!stream.read((char *) &bytes[0], (std::streamsize) bytes.size())) {
+    return false;
+  }
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = (unsigned int) bytes[4 * i] | ((unsigned int) bytes[4 * i + 1] << 8) |
+                ((unsigned int) bytes[4 * i + 2] << 16) | ((unsigned int) bytes[4 * i + 3] << 24);
+  }
+  return true;
+}
+
+inline unsigned int floatToUInt(const float value)
+{
+  unsigned int bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline float uintToFloat(const unsigned int bits)
+{
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+class vpDescriptorIndex::BuildTask : public vpThreadPool::Task
+{
+public:
+  explicit BuildTask(vpDescriptorIndex &index) : m_index(index) {}
+
+  void operator()(const unsigned int begin, const unsigned int end)
+  {
+    for (unsigned int i = begin; i < end; i++) {
+      if (m_index.m_descriptorType == BINARY_DESCRIPTOR) {
+        m_index.buildHashTable(i);
+      }
+      else {
+        m_index.buildTree(i);
+      }
+    }
+  }
+
+private:
+  vpDescriptorIndex &m_index;
+};
+
+class vpDescriptorIndex::SearchTask : public vpThreadPool::Task
+{
+public:
+  SearchTask(const vpDescriptorIndex &index, const void *queries, const unsigned int k, std::vector<int> &indexes,
+             std::vector<float> &distances)
+    : m_index(index), m_queries(queries), m_k(k), m_indexes(indexes), m_distances(distances),
+      m_threads(vpThreadPool::getInstance().getNumThreads())
+  {
+  }
+
+  void operator()(const unsigned int begin, const unsigned int end)
+  {
+    ThreadData &data = m_threads[vpThreadPool::getThreadIndex()];
+    const unsigned int nbDescriptors = m_index.m_nbDescriptors;
+    if (data.stamps.size() != nbDescriptors) {
+      data.stamps.assign(nbDescriptors, 0);
+    }
+
+    const unsigned int size = m_index.m_descriptorSize;
+    const unsigned int nbNeighbours = std::min(m_k, nbDescriptors);
+    for (unsigned int i = begin; i < end; i++) {
+      data.stamp++;
+      data.indexes = &m_indexes[(size_t) i * m_k];
+      data.distances = &m_distances[(size_t) i * m_k];
+      data.nbNeighbours = 0;
+
+      // The neighbours of the queries for which the index does not give
+      // enough candidates are searched exhaustively
+      if (m_index.m_descriptorType == BINARY_DESCRIPTOR) {
+        const unsigned char *query = static_cast<const unsigned char *>(m_queries) + (size_t) i * size;
+        searchHashTables(query, data);
+        if (data.nbNeighbours < nbNeighbours) {
+          searchAll(query, data);
+        }
+      }
+      else {
+        const float *query = static_cast<const float *>(m_queries) + (size_t) i * size;
+        searchTrees(query, data);
+        if (data.nbNeighbours < nbNeighbours) {
+          searchAll(query, data);
+        }
+        for (unsigned int j = 0; j < data.nbNeighbours; j++) {
+          data.distances[j] = sqrt(data.distances[j]);
+        }
+      }
+    }
+  }
+
+private:
+  //! Search state of a thread
+  struct ThreadData {
+    ThreadData()
+      : stamps(), stamp(0), heap(), indexes(NULL), distances(NULL), nbNeighbours(0), nbChecks(0)
+    {
+    }
+
+    //! Last query compared to each descriptor
+    std::vector<unsigned int> stamps;
+    //! Current query
+    unsigned int stamp;
+    //! Branches of the kd-trees to explore
+    std::vector<Branch> heap;
+    //! Neighbours of the current query
+    int *indexes;
+    float *distances;
+    unsigned int nbNeighbours;
+    //! Number of descriptors compared to the current query
+    unsigned int nbChecks;
+  };
+
+  //! Compare a descriptor to the query, if not done yet
+  inline void check(const unsigned char *query, const unsigned int i, ThreadData &data) const
+  {
+    if (data.stamps[i] != data.stamp) {
+      data.stamps[i] = data.stamp;
+      const unsigned int size = m_index.m_descriptorSize;
+      const unsigned char *descriptor = static_cast<const unsigned char *>(m_index.m_descriptors) + (size_t) i * size;
+      insertNeighbour(data.indexes, data.distances, m_k, data.nbNeighbours, (int) i,
+                      hammingDistance(query, descriptor, size));
+    }
+  }
+
+  inline void check(const float *query, const unsigned int i, ThreadData &data) const
+  {
+    if (data.stamps[i] != data.stamp) {
+      data.stamps[i] = data.stamp;
+      data.nbChecks++;
+      const unsigned int size = m_index.m_descriptorSize;
+      const float *descriptor = static_cast<const float *>(m_index.m_descriptors) + (size_t) i * size;
+      insertNeighbour(data.indexes, data.distances, m_k, data.nbNeighbours, (int) i,
+                      squaredDistance(query, descriptor, size));
+    }
+  }
+
+  //! Exhaustive search
+  template <typename Type> void searchAll(const Type *query, ThreadData &data) const
+  {
+    for (unsigned int i = 0; i < m_index.m_nbDescriptors; i++) {
+      check(query, i, data);
+    }
+  }
+
+  /*!
+    Check the descriptors of the bucket of a key and of the buckets whose key
+    differs by at most level bits from the bit firstBit. The prefix of a key
+    is its shift last bits.
+  */
+  void probe(const unsigned char *query, const unsigned int table, const unsigned int key, const unsigned int shift,
+             const unsigned int firstBit, const unsigned int level, ThreadData &data) const
+  {
+    // A prefix has about one key, so that the keys are searched linearly
+    const std::vector<unsigned int> &keys = m_index.m_keys[table];
+    const std::vector<unsigned int> &prefixes = m_index.m_prefixes[table];
+    const unsigned int prefix = shift < 32 ? key >> shift : 0;
+    for (unsigned int i = prefixes[prefix]; i < prefixes[prefix + 1] && keys[i] <= key; i++) {
+      if (keys[i] == key) {
+        check(query, m_index.m_buckets[table][i], data);
+      }
+    }
+
+    if (level > 0) {
+      const unsigned int keySize = (unsigned int) m_index.m_keyBits[table].size();
+      for (unsigned int b = firstBit; b < keySize; b++) {
+        probe(query, table, key ^ (1u << b), shift, b + 1, level - 1, data);
+      }
+    }
+  }
+
+  void searchHashTables(const unsigned char *query, ThreadData &data) const
+  {
+    for (unsigned int t = 0; t < m_index.m_keys.size(); t++) {
+      const unsigned int shift = (unsigned int) m_index.m_keyBits[t].size() - prefixSize(m_index.m_prefixes[t]);
+      probe(query, t, computeKey(query, m_index.m_keyBits[t]), shift, 0, m_index.m_multiProbeLevel, data);
+    }
+  }
+
+  //! Go down a kd-tree to the leaf of the query and remember the other branches
+  void explore(const float *query, const unsigned int tree, unsigned int node, const float bound,
+               ThreadData &data) const
+  {
+    const std::vector<Node> &nodes = m_index.m_nodes[tree];
+    while (nodes[node].dim >= 0) {
+      const Node &n = nodes[node];
+      const float diff = query[n.dim] - n.value;
+      const unsigned int nearChild = diff < 0 ? n.first : n.last;
+      const unsigned int farChild = diff < 0 ? n.last : n.first;
+      // The distance to the split plane bounds the distance to the descriptors of the far branch
+      const float farBound = std::max(bound, diff * diff);
+      if (data.nbNeighbours < m_k || farBound < data.distances[m_k - 1]) {
+        Branch branch;
+        branch.bound = farBound;
+        branch.tree = tree;
+        branch.node = farChild;
+        data.heap.push_back(branch);
+        std::push_heap(data.heap.begin(), data.heap.end());
+      }
+      node = nearChild;
+    }
+
+    const std::vector<unsigned int> &points = m_index.m_points[tree];
+    for (unsigned int i = nodes[node].first; i < nodes[node].last; i++) {
+      check(query, points[i], data);
+    }
+  }
+
+  void searchTrees(const float *query, ThreadData &data) const
+  {
+    data.heap.clear();
+    data.nbChecks = 0;
+    for (unsigned int t = 0; t < m_index.m_nodes.size(); t++) {
+      explore(query, t, 0, 0.f, data);
+    }
+
+    while (!data.heap.empty() && data.nbChecks < m_index.m_nbChecks) {
+      const Branch branch = data.heap.front();
+      std::pop_heap(data.heap.begin(), data.heap.end());
+      data.heap.pop_back();
+      if (data.nbNeighbours == m_k && branch.bound >= data.distances[m_k - 1]) {
+        break;
+      }
+      explore(query, branch.tree, branch.node, branch.bound, data);
+    }
+  }
+
+  const vpDescriptorIndex &m_index;
+  const void *m_queries;
+  const unsigned int m_k;
+  std::vector<int> &m_indexes;
+  std::vector<float> &m_distances;
+  std::vector<ThreadData> m_threads;
+};
+#endif
+
+/*!
+  Default constructor. Binary descriptors are indexed by 12 hash tables
+  with 20 bits keys probed up to 2 flipped bits, float descriptors by 4
+  kd-trees explored up to 128 compared descriptors. The queries are
+  processed by all the threads of vpThreadPool.
+*/
+vpDescriptorIndex::vpDescriptorIndex()
+  : m_descriptors(NULL), m_descriptorSize(0), m_descriptorType(NO_DESCRIPTOR), m_keySize(20), m_multiProbeLevel(2),
+    m_nbChecks(128), m_nbDescriptors(0), m_nbTables(12), m_nbThreads(0), m_nbTrees(4), m_keyBits(), m_keys(),
+    m_buckets(), m_nodes(), m_points()
+{
+}
+
+/*!
+  Build the index of binary descriptors, compared with the Hamming distance.
+  The hash tables are built in parallel.
+
+  \param descriptors : Descriptors stored row by row, that must stay valid
+  and unchanged as long as the index is used.
+  \param nbDescriptors : Number of descriptors.
+  \param descriptorSize : Number of bytes of a descriptor.
+*/
+void vpDescriptorIndex::build(const unsigned char *descriptors, const unsigned int nbDescriptors,
+                              const unsigned int descriptorSize)
+{
+  buildIndex(descriptors, nbDescriptors, descriptorSize, BINARY_DESCRIPTOR);
+}
+
+/*!
+  Build the index of float descriptors, compared with the L2 distance. The
+  kd-trees are built in parallel.
+
+  \param descriptors : Descriptors stored row by row, that must stay valid
+  and unchanged as long as the index is used.
+  \param nbDescriptors : Number of descriptors.
+  \param descriptorSize : Number of floats of a descriptor.
+*/
+void vpDescriptorIndex::build(const float *descriptors, const unsigned int nbDescriptors,
+                              const unsigned int descriptorSize)
+{
+  buildIndex(descriptors, nbDescriptors, descriptorSize, FLOAT_DESCRIPTOR);
+}
+
+void vpDescriptorIndex::buildIndex(const void *descriptors, const unsigned int nbDescriptors,
+                                   const unsigned int descriptorSize, const vpDescriptorType descriptorType)
+{
+  clear();
+  if (nbDescriptors == 0) {
+    return;
+  }
+  if (descriptors == NULL || descriptorSize == 0) {
+    throw vpException(vpException::badValue, "Cannot index descriptors of size %d", descriptorSize);
+  }
+
+  m_descriptors = descriptors;
+  m_descriptorSize = descriptorSize;
+  m_descriptorType = descriptorType;
+  m_nbDescriptors = nbDescriptors;
+
+  unsigned int nbStructures;
+  if (descriptorType == BINARY_DESCRIPTOR) {
+    nbStructures = m_nbTables;
+    m_keyBits.resize(nbStructures);
+    m_keys.resize(nbStructures);
+    m_buckets.resize(nbStructures);
+    m_prefixes.resize(nbStructures);
+  }
+  else {
+    nbStructures = m_nbTrees;
+    m_nodes.resize(nbStructures);
+    m_points.resize(nbStructures);
+  }
+
+  BuildTask task(*this);
+  vpThreadPool::getInstance().parallelFor(0, nbStructures, task, 1, m_nbThreads);
+}
+
+/*!
+  Build a hash table: the key of a descriptor is made of random bits of the
+  descriptor, and the descriptors are sorted by key.
+*/
+void vpDescriptorIndex::buildHashTable(const unsigned int table)
+{
+  RandomGenerator random((long) table + 1);
+  const unsigned int nbBits = 8 * m_descriptorSize;
+  const unsigned int keySize = std::max(1u, std::min(std::min(m_keySize, nbBits), 32u));
+
+  // Draw the bits of the key without replacement
+  std::vector<unsigned int> &bits = m_keyBits[table];
+  bits.resize(nbBits);
+  for (unsigned int i = 0; i < nbBits; i++) {
+    bits[i] = i;
+  }
+  for (unsigned int i = 0; i < keySize; i++) {
+    std::swap(bits[i], bits[i + random(nbBits - i)]);
+  }
+  bits.resize(keySize);
+
+  const unsigned char *descriptors = static_cast<const unsigned char *>(m_descriptors);
+  std::vector<std::pair<unsigned int, unsigned int> > entries(m_nbDescriptors);
+  for (unsigned int i = 0; i < m_nbDescriptors; i++) {
+    entries[i] = std::make_pair(computeKey(descriptors + (size_t) i * m_descriptorSize, bits), i);
+  }
+  std::sort(entries.begin(), entries.end());
+
+  std::vector<unsigned int> &keys = m_keys[table];
+  std::vector<unsigned int> &buckets = m_buckets[table];
+  keys.resize(m_nbDescriptors);
+  buckets.resize(m_nbDescriptors);
+  for (unsigned int i = 0; i < m_nbDescriptors; i++) {
+    keys[i] = entries[i].first;
+    buckets[i] = entries[i].second;
+  }
+  buildKeyPrefixes(table);
+}
+
+/*!
+  Index the sorted keys of a hash table by their first bits, with about one
+  key per prefix, so that the keys of a bucket are found without a binary
+  search.
+*/
+void vpDescriptorIndex::buildKeyPrefixes(const unsigned int table)
+{
+  const std::vector<unsigned int> &keys = m_keys[table];
+  const unsigned int keySize = (unsigned int) m_keyBits[table].size();
+  unsigned int size = 0;
+  while (size < std::min(keySize, maxPrefixSize) && (2u << size) <= m_nbDescriptors) {
+    size++;
+  }
+  const unsigned int shift = keySize - size;
+
+  // Number of keys whose prefix is lower than each prefix
+  std::vector<unsigned int> &prefixes = m_prefixes[table];
+  prefixes.assign((1u << size) + 1, 0);
+  for (unsigned int i = 0; i < keys.size(); i++) {
+    prefixes[(shift < 32 ? keys[i] >> shift : 0) + 1]++;
+  }
+  for (unsigned int i = 1; i < prefixes.size(); i++) {
+    prefixes[i] += prefixes[i - 1];
+  }
+}
+
+/*!
+  Build a randomized kd-tree: a node is split at the mean of a dimension
+  drawn among the ones of largest variance.
+*/
+void vpDescriptorIndex::buildTree(const unsigned int tree)
+{
+  RandomGenerator random((long) tree + 1);
+  const float *descriptors = static_cast<const float *>(m_descriptors);
+  const unsigned int size = m_descriptorSize;
+  const unsigned int nbDims = std::min(nbSplitDimensions, size);
+
+  std::vector<unsigned int> &points = m_points[tree];
+  points.resize(m_nbDescriptors);
+  for (unsigned int i = 0; i < m_nbDescriptors; i++) {
+    points[i] = i;
+  }
+
+  std::vector<Node> &nodes = m_nodes[tree];
+  nodes.assign(1, Node());
+  std::vector<double> mean(size), variance(size);
+  std::vector<unsigned int> dims(size);
+  // Node to split, its first point and the end of its points
+  std::vector<unsigned int> stack;
+  stack.push_back(0);
+  stack.push_back(0);
+  stack.push_back(m_nbDescriptors);
+  while (!stack.empty()) {
+    const unsigned int last = stack.back();
+    stack.pop_back();
+    const unsigned int first = stack.back();
+    stack.pop_back();
+    const unsigned int node = stack.back();
+    stack.pop_back();
+
+    if (last - first <= leafSize) {
+      nodes[node].dim = -1;
+      nodes[node].value = 0;
+      nodes[node].first = first;
+      nodes[node].last = last;
+      continue;
+    }
+
+    // Mean and variance of the first points
+    const unsigned int nbSamples = std::min(last - first, varianceSampleSize);
+    std::fill(mean.begin(), mean.end(), 0.);
+    std::fill(variance.begin(), variance.end(), 0.);
+    for (unsigned int i = 0; i < nbSamples; i++) {
+      const float *descriptor = descriptors + (size_t) points[first + i] * size;
+      for (unsigned int j = 0; j < size; j++) {
+        mean[j] += descriptor[j];
+        variance[j] += descriptor[j] * descriptor[j];
+      }
+    }
+    for (unsigned int j = 0; j < size; j++) {
+      mean[j] /= nbSamples;
+      variance[j] = variance[j] / nbSamples - mean[j] * mean[j];
+      dims[j] = j;
+    }
+
+    std::partial_sort(dims.begin(), dims.begin() + nbDims, dims.end(), GreaterVariance(variance));
+    const unsigned int dim = dims[random(nbDims)];
+    const Coordinate coordinate(descriptors, size, dim);
+    float value = (float) mean[dim];
+    unsigned int *begin = &points[0] + first, *end = &points[0] + last;
+    unsigned int *middle = std::partition(begin, end, LowerCoordinate(coordinate, value));
+    if (middle == begin || middle == end) {
+      // Split at the median when the mean does not separate the points
+      middle = begin + (last - first) / 2;
+      std::nth_element(begin, middle, end, LessCoordinate(coordinate));
+      value = coordinate(*middle);
+    }
+
+    const unsigned int left = (unsigned int) nodes.size();
+    const unsigned int split = first + (unsigned int) (middle - begin);
+    nodes.resize(left + 2);
+    nodes[node].dim = (int) dim;
+    nodes[node].value = value;
+    nodes[node].first = left;
+    nodes[node].last = left + 1;
+    stack.push_back(left + 1);
+    stack.push_back(split);
+    stack.push_back(last);
+    stack.push_back(left);
+    stack.push_back(first);
+    stack.push_back(split);
+  }
+}
+
+/*!
+  Release the index.
+*/
+void vpDescriptorIndex::clear()
+{
+  m_descriptors = NULL;
+  m_descriptorSize = 0;
+  m_descriptorType = NO_DESCRIPTOR;
+  m_nbDescriptors = 0;
+  m_keyBits.clear();
+  m_keys.clear();
+  m_buckets.clear();
+  m_prefixes.clear();
+  m_nodes.clear();
+  m_points.clear();
+}
+
+//! FNV-1a hash of all the indexed descriptors, independent of the endianness.
+unsigned int vpDescriptorIndex::computeChecksum() const
+{
+  const size_t size = (size_t) m_nbDescriptors * m_descriptorSize;
+  unsigned int checksum = 2166136261u;
+  if (m_descriptorType == BINARY_DESCRIPTOR) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(m_descriptors);
+    for (size_t i = 0; i < size; i++) {
+      checksum = (checksum ^ bytes[i]) * 16777619u;
+    }
+  }
+  else {
+    const float *values = static_cast<const float *>(m_descriptors);
+    for (size_t i = 0; i < size; i++) {
+      const unsigned int bits = floatToUInt(values[i]);
+      for (unsigned int b = 0; b < 4; b++) {
+        checksum = (checksum ^ ((bits >> (8 * b)) & 0xFF)) * 16777619u;
+      }
+    }
+  }
+  return checksum;
+}
+
+/*!
+  Return true if the index was built or loaded for these descriptors.
+
+  \param descriptors : Descriptors stored row by row.
+  \param nbDescriptors : Number of descriptors.
+  \param descriptorSize : Number of bytes of a binary descriptor, or of
+  floats of a float descriptor.
+  \param descriptorType : Kind of descriptors.
+*/
+bool vpDescriptorIndex::isCompatible(const void *descriptors, const unsigned int nbDescriptors,
+                                     const unsigned int descriptorSize, const vpDescriptorType descriptorType) const
+{
+  return m_nbDescriptors > 0 && m_descriptors == descriptors && m_nbDescriptors == nbDescriptors &&
+         m_descriptorSize == descriptorSize && m_descriptorType == descriptorType;
+}
+
+/*!
+  Search the k nearest neighbours of binary descriptors in the index. The
+  queries are processed in parallel.
+
+  \param queries : Query descriptors stored row by row, with the size of the
+  indexed ones.
+  \param nbQueries : Number of queries.
+  \param k : Number of neighbours of a query.
+  \param indexes : Indexes of the neighbours: indexes[i*k+j] is the j-th
+  nearest neighbour of the i-th query, -1 if the index has less than \e k
+  descriptors.
+  \param distances : Hamming distances of the neighbours.
+*/
+void vpDescriptorIndex::knnSearch(const unsigned char *queries, const unsigned int nbQueries, const unsigned int k,
+                                  std::vector<int> &indexes, std::vector<float> &distances) const
+{
+  if (m_descriptorType == FLOAT_DESCRIPTOR) {
+    throw vpException(vpException::badValue, "The index is not built for binary descriptors");
+  }
+  search(queries, nbQueries, k, indexes, distances);
+}
+
+/*!
+  Search the k nearest neighbours of float descriptors in the index. The
+  queries are processed in parallel.
+
+  \param queries : Query descriptors stored row by row, with the size of the
+  indexed ones.
+  \param nbQueries : Number of queries.
+  \param k : Number of neighbours of a query.
+  \param indexes : Indexes of the neighbours: indexes[i*k+j] is the j-th
+  nearest neighbour of the i-th query, -1 if the index has less than \e k
+  descriptors.
+  \param distances : L2 distances of the neighbours.
+*/
+void vpDescriptorIndex::knnSearch(const float *queries, const unsigned int nbQueries, const unsigned int k,
+                                  std::vector<int> &indexes, std::vector<float> &distances) const
+{
+  if (m_descriptorType == BINARY_DESCRIPTOR) {
+    throw vpException(vpException::badValue, "The index is not built for float descriptors");
+  }
+  search(queries, nbQueries, k, indexes, distances);
+}
+
+void vpDescriptorIndex::search(const void *queries, const unsigned int nbQueries, const unsigned int k,
+                               std::vector<int> &indexes, std::vector<float> &distances) const
+{
+  indexes.assign((size_t) nbQueries * k, -1);
+  distances.assign((size_t) nbQueries * k, std::numeric_limits<float>::max());
+  if (nbQueries == 0 || k == 0 || m_nbDescriptors == 0) {
+    return;
+  }
+  if (queries == NULL) {
+    throw vpException(vpException::badValue, "No query descriptors");
+  }
+
+  SearchTask task(*this, queries, k, indexes, distances);
+  vpThreadPool::getInstance().parallelFor(0, nbQueries, task, queryGrainSize, m_nbThreads);
+}
+
+/*!
+  Load an index saved by save() for binary descriptors.
+
+  \param filename : Name of the file.
+  \param descriptors : Indexed descriptors, that must stay valid and
+  unchanged as long as the index is used.
+  \param nbDescriptors : Number of descriptors.
+  \param descriptorSize : Number of bytes of a descriptor.
+
+  \return false if the file cannot be read or was not saved for these
+  descriptors. The index is then empty and must be built.
+*/
+bool vpDescriptorIndex::load(const std::string &filename, const unsigned char *descriptors,
+                             const unsigned int nbDescriptors, const unsigned int descriptorSize)
+{
+  std::ifstream file(filename.c_str(), std::ifstream::binary);
+  return loadIndex(file, descriptors, nbDescriptors, descriptorSize, BINARY_DESCRIPTOR);
+}
+
+/*!
+  Load an index saved by save() for float descriptors.
+
+  \param filename : Name of the file.
+  \param descriptors : Indexed descriptors, that must stay valid and
+  unchanged as long as the index is used.
+  \param nbDescriptors : Number of descriptors.
+  \param descriptorSize : Number of floats of a descriptor.
+
+  \return false if the file cannot be read or was not saved for these
+  descriptors. The index is then empty and must be built.
+*/
+bool vpDescriptorIndex::load(const std::string &filename, const float *descriptors, const unsigned int nbDescriptors,
+                             const unsigned int descriptorSize)
+{
+  std::ifstream file(filename.c_str(), std::ifstream::binary);
+  return loadIndex(file, descriptors, nbDescriptors, descriptorSize, FLOAT_DESCRIPTOR);
+}
+
+/*!
+  Load an index saved by save(std::ostream &) const for binary descriptors.
+
+  \param stream : Binary stream positioned at the beginning of the index.
+  \param descriptors : Indexed descriptors, that must stay valid and
+  unchanged as long as the index is used.
+  \param nbDescriptors : Number of descriptors.
+  \param descriptorSize : Number of bytes of a descriptor.
+
+  \return false if the stream cannot be read or the index was not saved for
+  these descriptors. The index is then empty and must be built.
+*/
+bool vpDescriptorIndex::load(std::istream &stream, const unsigned char *descriptors, const unsigned int nbDescriptors,
+                             const unsigned int descriptorSize)
+{
+  return loadIndex(stream, descriptors, nbDescriptors, descriptorSize, BINARY_DESCRIPTOR);
+}
+
+/*!
+  Load an index saved by save(std::ostream &) const for float descriptors.
+
+  \param stream : Binary stream positioned at the beginning of the index.
+  \param descriptors : Indexed descriptors, that must stay valid and
+  unchanged as long as the index is used.
+  \param nbDescriptors : Number of descriptors.
+  \param descriptorSize : Number of floats of a descriptor.
+
+  \return false if the stream cannot be read or the index was not saved for
+  these descriptors. The index is then empty and must be built.
+*/
+bool vpDescriptorIndex::load(std::istream &stream, const float *descriptors, const unsigned int nbDescriptors,
+                             const unsigned int descriptorSize)
+{
+  return loadIndex(stream, descriptors, nbDescriptors, descriptorSize, FLOAT_DESCRIPTOR);
+}
+
+//! Load an index saved by save(std::ostream &) const, computing the checksum of the descriptors only if asked.
+bool vpDescriptorIndex::loadIndex(std::istream &stream, const void *descriptors, const unsigned int nbDescriptors,
+                                  const unsigned int descriptorSize, const vpDescriptorType descriptorType,
+                                  const bool checkDescriptors)
+{
+  clear();
+  if (!stream || descriptors == NULL || nbDescriptors == 0) {
+    return false;
+  }
+
+  char magic[4];
+  std::vector<unsigned int> header(6);
+  if (!stream.read(magic, 4) || !std::equal(magic, magic + 4, fileMagic) || !readBinaryUInt(stream, header) ||
+      header[0] != fileVersion || header[1] != (unsigned int) descriptorType || header[2] != nbDescriptors ||
+      header[3] != descriptorSize || header[5] > maxNbStructures) {
+    return false;
+  }
+
+  m_descriptors = descriptors;
+  m_descriptorSize = descriptorSize;
+  m_descriptorType = descriptorType;
+  m_nbDescriptors = nbDescriptors;
+  if (checkDescriptors && header[4] != computeChecksum()) {
+    clear();
+    return false;
+  }
+
+  const unsigned int nbStructures = header[5];
+  std::vector<unsigned int> size(1);
+  bool valid = true;
+  if (descriptorType == BINARY_DESCRIPTOR) {
+    m_keyBits.resize(nbStructures);
+    m_keys.resize(nbStructures);
+    m_buckets.resize(nbStructures);
+    m_prefixes.resize(nbStructures);
+    for (unsigned int t = 0; t < nbStructures && valid; t++) {
+      valid = readBinaryUInt(stream, size) && size[0] > 0 && size[0] <= 32 && size[0] <= 8 * descriptorSize;
+      if (valid) {
+        m_keyBits[t].resize(size[0]);
+        m_keys[t].resize(nbDescriptors);
+        m_buckets[t].resize(nbDescriptors);
+        valid = readBinaryUInt(stream, m_keyBits[t]) && readBinaryUInt(stream, m_keys[t]) &&
+                readBinaryUInt(stream, m_buckets[t]);
+      }
+      for (unsigned int i = 0; i < m_keyBits[t].size() && valid; i++) {
+        valid = m_keyBits[t][i] < 8 * descriptorSize;
+      }
+      for (unsigned int i = 0; i < m_buckets[t].size() && valid; i++) {
+        valid = m_buckets[t][i] < nbDescriptors && (i == 0 || m_keys[t][i - 1] <= m_keys[t][i]) &&
+                (size[0] == 32 || (m_keys[t][i] >> size[0]) == 0);
+      }
+      if (valid) {
+        buildKeyPrefixes(t);
+      }
+    }
+    if (valid) {
+      m_nbTables = nbStructures;
+      if (nbStructures > 0) {
+        m_keySize = (unsigned int) m_keyBits[0].size();
+      }
+    }
+  }
+  else {
+    m_nodes.resize(nbStructures);
+    m_points.resize(nbStructures);
+    for (unsigned int t = 0; t < nbStructures && valid; t++) {
+      valid = readBinaryUInt(stream, size) && size[0] > 0 && size[0] <= 2 * nbDescriptors;
+      std::vector<unsigned int> buffer;
+      if (valid) {
+        buffer.resize(4 * size[0]);
+        m_points[t].resize(nbDescriptors);
+        valid = readBinaryUInt(stream, buffer) && readBinaryUInt(stream, m_points[t]);
+      }
+      if (valid) {
+        std::vector<Node> &nodes = m_nodes[t];
+        nodes.resize(size[0]);
+        for (unsigned int i = 0; i < nodes.size() && valid; i++) {
+          nodes[i].dim = (int) buffer[4 * i];
+          nodes[i].value = uintToFloat(buffer[4 * i + 1]);
+          nodes[i].first = buffer[4 * i + 2];
+          nodes[i].last = buffer[4 * i + 3];
+          // The children follow their parent, so that the trees have no cycle
+          if (nodes[i].dim >= 0) {
+            valid = (unsigned int) nodes[i].dim < descriptorSize && nodes[i].first > i && nodes[i].last > i &&
+                    nodes[i].first < size[0] && nodes[i].last < size[0];
+          }
+          else {
+            valid = nodes[i].first <= nodes[i].last && nodes[i].last <= nbDescriptors;
+          }
+        }
+      }
+      for (unsigned int i = 0; i < m_points[t].size() && valid; i++) {
+        valid = m_points[t][i] < nbDescriptors;
+      }
+    }
+    if (valid) {
+      m_nbTrees = nbStructures;
+    }
+  }
+
+  if (!valid) {
+    clear();
+  }
+  return valid;
+}
+
+/*!
+  Save the index in a file, to load it with load() instead of building it
+  again. The file is in little endian and stores a checksum of the indexed
+  descriptors.
+
+  \param filename : Name of the file.
+*/
+void vpDescriptorIndex::save(const std::string &filename) const
+{
+  if (empty()) {
+    throw vpException(vpException::notInitialized, "The index is empty");
+  }
+
+  std::ofstream file(filename.c_str(), std::ofstream::binary);
+  if (!file.is_open()) {
+    throw vpException(vpException::ioError, "Cannot create the file: %s", filename.c_str());
+  }
+  save(file);
+}
+
+/*!
+  Save the index in a binary stream, for example to embed it in another
+  file. The data are written as by save(const std::string &) const.
+
+  \param stream : Binary output stream.
+*/
+void vpDescriptorIndex::save(std::ostream &stream) const
+{
+  if (empty()) {
+    throw vpException(vpException::notInitialized, "The index is empty");
+  }
+
+  const bool binary = m_descriptorType == BINARY_DESCRIPTOR;
+  std::vector<unsigned int> header(6);
+  header[0] = fileVersion;
+  header[1] = (unsigned int) m_descriptorType;
+  header[2] = m_nbDescriptors;
+  header[3] = m_descriptorSize;
+  header[4] = computeChecksum();
+  header[5] = (unsigned int) (binary ? m_keys.size() : m_nodes.size());
+  stream.write(fileMagic, 4);
+  writeBinaryUInt(stream, header);
+
+  std::vector<unsigned int> size(1);
+  if (binary) {
+    for (unsigned int t = 0; t < m_keys.size(); t++) {
+      size[0] = (unsigned int) m_keyBits[t].size();
+      writeBinaryUInt(stream, size);
+      writeBinaryUInt(stream, m_keyBits[t]);
+      writeBinaryUInt(stream, m_keys[t]);
+      writeBinaryUInt(stream, m_buckets[t]);
+    }
+  }
+  else {
+    for (unsigned int t = 0; t < m_nodes.size(); t++) {
+      const std::vector<Node> &nodes = m_nodes[t];
+      std::vector<unsigned int> buffer(4 * nodes.size());
+      for (unsigned int i = 0; i < nodes.size(); i++) {
+        buffer[4 * i] = (unsigned int) nodes[i].dim;
+        buffer[4 * i + 1] = floatToUInt(nodes[i].value);
+        buffer[4 * i + 2] = nodes[i].first;
+        buffer[4 * i + 3] = nodes[i].last;
+      }
+      size[0] = (unsigned int) nodes.size();
+      writeBinaryUInt(stream, size);
+      writeBinaryUInt(stream, buffer);
+      writeBinaryUInt(stream, m_points[t]);
+    }
+  }
+
+  if (!stream) {
+    throw vpException(vpException::ioError, "Cannot write the index");
+  }
+}
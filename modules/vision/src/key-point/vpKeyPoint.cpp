@@ -301,10 +301,11 @@ namespace {
  */
 vpKeyPoint::vpKeyPoint(const vpFeatureDetectorType &detectorType, const vpFeatureDescriptorType &descriptorType,
                        const std::string &matcherName, const vpFilterMatchingType &filterType)
-  : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
+  : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_descriptorIndex(),
+    m_detectionMethod(detectionScore),
     m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(),
     m_detectors(), m_extractionTime(0.), m_extractorNames(), m_extractors(), m_filteredMatches(), m_filterType(filterType),
-    m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
+    m_imageFormat(jpgImageFormat), m_knnMatches(), m_learningDataFile(), m_mapOfImageId(), m_mapOfImages(),
     m_matcher(), m_matcherName(matcherName),
     m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85), m_matchingTime(0.),
     m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100), m_objectFilteredPoints(),
@@ -315,7 +316,7 @@ vpKeyPoint::vpKeyPoint(const vpFeatureDetectorType &detectorType, const vpFeatur
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
 #endif
-    m_useConsensusPercentage(false),
+    m_useConsensusPercentage(false), m_useDescriptorIndex(false),
     m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true), m_useSingleMatchFilter(true)
 {
   initFeatureNames();
@@ -336,10 +337,11 @@ vpKeyPoint::vpKeyPoint(const vpFeatureDetectorType &detectorType, const vpFeatur
  */
 vpKeyPoint::vpKeyPoint(const std::string &detectorName, const std::string &extractorName,
                        const std::string &matcherName, const vpFilterMatchingType &filterType)
-  : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
+  : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_descriptorIndex(),
+    m_detectionMethod(detectionScore),
     m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(),
     m_detectors(), m_extractionTime(0.), m_extractorNames(), m_extractors(), m_filteredMatches(), m_filterType(filterType),
-    m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
+    m_imageFormat(jpgImageFormat), m_knnMatches(), m_learningDataFile(), m_mapOfImageId(), m_mapOfImages(),
     m_matcher(), m_matcherName(matcherName),
     m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85), m_matchingTime(0.),
     m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100), m_objectFilteredPoints(),
@@ -350,7 +352,7 @@ vpKeyPoint::vpKeyPoint(const std::string &detectorName, const std::string &extra
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
 #endif
-    m_useConsensusPercentage(false),
+    m_useConsensusPercentage(false), m_useDescriptorIndex(false),
     m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true), m_useSingleMatchFilter(true)
 {
   initFeatureNames();
@@ -371,11 +373,12 @@ vpKeyPoint::vpKeyPoint(const std::string &detectorName, const std::string &extra
  */
 vpKeyPoint::vpKeyPoint(const std::vector<std::string> &detectorNames, const std::vector<std::string> &extractorNames,
                        const std::string &matcherName, const vpFilterMatchingType &filterType)
-  : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
+  : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_descriptorIndex(),
+    m_detectionMethod(detectionScore),
     m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(detectorNames),
     m_detectors(), m_extractionTime(0.), m_extractorNames(extractorNames), m_extractors(), m_filteredMatches(),
-    m_filterType(filterType), m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
-    m_matcher(),
+    m_filterType(filterType), m_imageFormat(jpgImageFormat), m_knnMatches(), m_learningDataFile(), m_mapOfImageId(),
+    m_mapOfImages(), m_matcher(),
     m_matcherName(matcherName), m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85), m_matchingTime(0.),
     m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100), m_objectFilteredPoints(),
     m_poseTime(0.), m_queryDescriptors(), m_queryFilteredKeyPoints(), m_queryKeyPoints(),
@@ -385,7 +388,7 @@ vpKeyPoint::vpKeyPoint(const std::vector<std::string> &detectorNames, const std:
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
 #endif
-    m_useConsensusPercentage(false),
+    m_useConsensusPercentage(false), m_useDescriptorIndex(false),
     m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true), m_useSingleMatchFilter(true)
 {
   initFeatureNames();
@@ -536,6 +539,8 @@ unsigned int vpKeyPoint::buildReference(const vpImage<unsigned char> &I,
   //Add train descriptors in matcher object
   m_matcher->clear();
   m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  //The index of the train descriptors is built by the next matching
+  m_descriptorIndex.clear();
 
   return static_cast<unsigned int>(m_trainKeyPoints.size());
 }
@@ -637,6 +642,8 @@ void vpKeyPoint::buildReference(const vpImage<unsigned char> &I, const std::vect
   //Add train descriptors in matcher object
   m_matcher->clear();
   m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  //The index of the train descriptors is built by the next matching
+  m_descriptorIndex.clear();
 
   _reference_computed = true;
 }
@@ -1177,6 +1184,23 @@ double vpKeyPoint::computePoseEstimationError(const std::vector<std::pair<cv::Ke
   return std::accumulate(errors.begin(), errors.end(), 0.0) / errors.size();
 }
 
+/*!
+   Convert a learning file saved by saveLearningData() into a file saved by saveMappedLearningData(), that is loaded
+   much faster by loadLearningData(). The training images are saved again in PNG format in the directory of the
+   converted file.
+
+   \param filename : Path of the learning file.
+   \param binaryMode : If true, the learning file is in binary mode, otherwise it is in XML mode.
+   \param mappedFilename : Path of the converted file.
+ */
+void vpKeyPoint::convertLearningData(const std::string &filename, const bool binaryMode,
+                                     const std::string &mappedFilename) {
+  vpKeyPoint keyPoint;
+  keyPoint.setImageFormat(pngImageFormat);
+  keyPoint.loadLearningData(filename, binaryMode);
+  keyPoint.saveMappedLearningData(mappedFilename, true);
+}
+
 /*!
    Initialize the size of the matching image (case with a matching side by side between IRef and ICurrent).
 
@@ -1668,6 +1692,10 @@ void vpKeyPoint::filterMatches() {
 
     if(m_filterType == stdAndRatioDistanceThreshold) {
       for(size_t i = 0; i < m_knnMatches.size(); i++) {
+        if(m_knnMatches[i].empty()) {
+          continue;
+        }
+
         double dist = m_knnMatches[i][0].distance;
         mean += dist;
         distance_vec[i] = dist;
@@ -2280,6 +2308,41 @@ void vpKeyPoint::initFeatureNames() {
 #endif
 }
 
+/*!
+   Build the approximate nearest neighbour index of the train descriptors used to match the query descriptors when
+   setUseDescriptorIndex() is enabled. It is done by the first matching after the learning if this method is not
+   called. Nothing is done if the index is already built for the train descriptors.
+
+   Binary descriptors (CV_8U) are indexed by hash tables, float descriptors (CV_32F) by kd-trees, see
+   vpDescriptorIndex.
+ */
+void vpKeyPoint::buildDescriptorIndex() {
+  if(m_trainDescriptors.empty()) {
+    m_descriptorIndex.clear();
+    return;
+  }
+
+  if(!m_trainDescriptors.isContinuous()) {
+    m_trainDescriptors = m_trainDescriptors.clone();
+  }
+
+  unsigned int nbDescriptors = (unsigned int) m_trainDescriptors.rows;
+  unsigned int descriptorSize = (unsigned int) m_trainDescriptors.cols;
+  if(m_trainDescriptors.type() == CV_8U) {
+    if(!m_descriptorIndex.isCompatible(m_trainDescriptors.data, nbDescriptors, descriptorSize,
+                                       vpDescriptorIndex::BINARY_DESCRIPTOR)) {
+      m_descriptorIndex.build(m_trainDescriptors.ptr<unsigned char>(0), nbDescriptors, descriptorSize);
+    }
+  } else if(m_trainDescriptors.type() == CV_32F) {
+    if(!m_descriptorIndex.isCompatible(m_trainDescriptors.data, nbDescriptors, descriptorSize,
+                                       vpDescriptorIndex::FLOAT_DESCRIPTOR)) {
+      m_descriptorIndex.build(m_trainDescriptors.ptr<float>(0), nbDescriptors, descriptorSize);
+    }
+  } else {
+    throw vpException(vpException::badValue, "The descriptor index needs CV_8U or CV_32F descriptors !");
+  }
+}
+
 /*!
    Initialize a matcher based on its name.
 
@@ -2490,12 +2553,50 @@ void vpKeyPoint::loadConfigFile(const std::string &configFile) {
 }
 #endif
 
+/*!
+   Load the index of the train descriptors saved by saveLearningData(), or stored in the mapped learning file by
+   saveMappedLearningData(). The index file is checked against a checksum of all the train descriptors, while the index
+   of the mapped learning file, saved with its descriptors, is loaded without reading them.
+
+   \param filename : Path of the index file, used if the mapped learning file has no index.
+   \return True if the index was saved for the train descriptors, false otherwise.
+ */
+bool vpKeyPoint::loadDescriptorIndex(const std::string &filename) {
+  if(m_trainDescriptors.empty() || !m_trainDescriptors.isContinuous()) {
+    return false;
+  }
+
+  if(m_learningDataFile.isOpen() && m_learningDataFile.hasIndex() &&
+     m_learningDataFile.getDescriptors() == (const void *) m_trainDescriptors.data) {
+    return m_learningDataFile.getIndex(m_descriptorIndex);
+  }
+
+  if(!vpIoTools::checkFilename(filename)) {
+    return false;
+  }
+
+  unsigned int nbDescriptors = (unsigned int) m_trainDescriptors.rows;
+  unsigned int descriptorSize = (unsigned int) m_trainDescriptors.cols;
+  if(m_trainDescriptors.type() == CV_8U) {
+    return m_descriptorIndex.load(filename, m_trainDescriptors.ptr<unsigned char>(0), nbDescriptors, descriptorSize);
+  } else if(m_trainDescriptors.type() == CV_32F) {
+    return m_descriptorIndex.load(filename, m_trainDescriptors.ptr<float>(0), nbDescriptors, descriptorSize);
+  }
+  return false;
+}
+
 /*!
    Load learning data saved on disk.
 
    \param filename : Path of the learning file.
    \param binaryMode : If true, the learning file is in a binary mode, otherwise it is in XML mode.
    \param append : If true, concatenate the learning data, otherwise reset the variables.
+
+   A file saved by saveMappedLearningData() is detected whatever \e binaryMode. It is mapped in memory and, unless
+   the data are appended, the train descriptors use the mapped memory without copy (see vpLearningDataFile).
+
+   When setUseDescriptorIndex() is enabled, the index saved with the learning data, in the mapped file or in the file
+   \e filename.index, is loaded if it matches the train descriptors, so that it is not built again.
  */
 void vpKeyPoint::loadLearningData(const std::string &filename, const bool binaryMode, const bool append) {
   int startClassId = 0;
@@ -2527,7 +2628,9 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
     parent += "/";
   }
 
-  if(binaryMode) {
+  if(vpLearningDataFile::isLearningDataFile(filename)) {
+    loadMappedLearningData(filename, append, startClassId, startImageId);
+  } else if(binaryMode) {
     std::ifstream file(filename.c_str(), std::ifstream::binary);
     if(!file.is_open()){
       throw vpException(vpException::ioError, "Cannot open the file.");
@@ -2697,7 +2800,7 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
     }
 
     if(!append || m_trainDescriptors.empty()) {
-      trainDescriptorsTmp.copyTo(m_trainDescriptors);
+      m_trainDescriptors = trainDescriptorsTmp;
     } else {
       cv::vconcat(m_trainDescriptors, trainDescriptorsTmp, m_trainDescriptors);
     }
@@ -2903,7 +3006,7 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
     }
 
     if(!append || m_trainDescriptors.empty()) {
-      trainDescriptorsTmp.copyTo(m_trainDescriptors);
+      m_trainDescriptors = trainDescriptorsTmp;
     } else {
       cv::vconcat(m_trainDescriptors, trainDescriptorsTmp, m_trainDescriptors);
     }
@@ -2929,6 +3032,18 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
   m_matcher->clear();
   m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
 
+  //Release the mapped learning file once its descriptors are not used anymore
+  if(m_learningDataFile.isOpen() && m_learningDataFile.getDescriptors() != (const void *) m_trainDescriptors.data) {
+    m_learningDataFile.close();
+  }
+
+  //Load the index saved with the learning data, if it is up to date, otherwise
+  //it is built by the next matching
+  m_descriptorIndex.clear();
+  if(m_useDescriptorIndex) {
+    loadDescriptorIndex(filename + ".index");
+  }
+
   //Set _reference_computed to true as we load a learning file
   _reference_computed = true;
 
@@ -2936,6 +3051,86 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
    m_currentImageId = (int) m_mapOfImages.size();
 }
 
+/*!
+   Load learning data saved by saveMappedLearningData(). Unless the data are appended, the train descriptors use the
+   memory where the file is mapped, the mapping being kept in m_learningDataFile.
+
+   \param filename : Path of the learning file.
+   \param append : If true, concatenate the learning data.
+   \param startClassId : Offset added to the class ids of the keypoints.
+   \param startImageId : Offset added to the ids of the training images.
+ */
+void vpKeyPoint::loadMappedLearningData(const std::string &filename, const bool append, const int startClassId,
+                                        const int startImageId) {
+  vpLearningDataFile file;
+  file.open(filename);
+
+  const int descriptorType = file.getDescriptorType();
+  if((unsigned int) CV_ELEM_SIZE(descriptorType) != file.getDescriptorElementSize()) {
+    throw vpException(vpException::ioError, "Invalid type of descriptors in the file: %s", filename.c_str());
+  }
+
+  //Read info about training images
+  std::map<int, std::string> images = file.getImages();
+#ifdef VISP_HAVE_MODULE_IO
+  //Get parent directory
+  std::string parent = vpIoTools::getParent(filename);
+  if(!parent.empty()) {
+    parent += "/";
+  }
+
+  for(std::map<int, std::string>::const_iterator it = images.begin(); it != images.end(); ++it) {
+    vpImage<unsigned char> I;
+    if(vpIoTools::isAbsolutePathname(it->second)) {
+      vpImageIo::read(I, it->second);
+    } else {
+      vpImageIo::read(I, parent + it->second);
+    }
+    m_mapOfImages[it->first + startImageId] = I;
+  }
+#else
+  if(!images.empty()) {
+    std::cout << "Warning: The learning file contains image data that will not be loaded as visp_io module "
+        "is not available !" << std::endl;
+  }
+#endif
+
+  //Read the keypoints and their 3D coordinates
+  const unsigned int nbDescriptors = file.getNbDescriptors();
+  const vpLearningDataFile::KeyPoint *keyPoints = file.getKeyPoints();
+  const float *points3D = file.getPoints3D();
+  m_trainKeyPoints.reserve(m_trainKeyPoints.size() + nbDescriptors);
+  for(unsigned int i = 0; i < nbDescriptors; i++) {
+    const vpLearningDataFile::KeyPoint &keyPoint = keyPoints[i];
+    m_trainKeyPoints.push_back(cv::KeyPoint(cv::Point2f(keyPoint.u, keyPoint.v), keyPoint.size, keyPoint.angle,
+                                            keyPoint.response, keyPoint.octave, keyPoint.classId + startClassId));
+#ifdef VISP_HAVE_MODULE_IO
+    //No training images if image_id == -1
+    if(keyPoint.imageId != -1) {
+      m_mapOfImageId[m_trainKeyPoints.back().class_id] = keyPoint.imageId + startImageId;
+    }
+#endif
+
+    if(points3D != NULL) {
+      m_trainPoints.push_back(cv::Point3f(points3D[3*i], points3D[3*i + 1], points3D[3*i + 2]));
+    }
+  }
+
+  //The descriptors are used where they are mapped: the mapping is private, so they can be modified in memory
+  cv::Mat trainDescriptorsTmp;
+  if(nbDescriptors > 0) {
+    trainDescriptorsTmp = cv::Mat((int) nbDescriptors, (int) file.getDescriptorSize(), descriptorType,
+                                  const_cast<void *>(file.getDescriptors()));
+  }
+
+  if(!append || m_trainDescriptors.empty()) {
+    m_trainDescriptors = trainDescriptorsTmp;
+    m_learningDataFile = file;
+  } else {
+    cv::vconcat(m_trainDescriptors, trainDescriptorsTmp, m_trainDescriptors);
+  }
+}
+
 /*!
    Match keypoints based on distance between their descriptors.
 
@@ -2948,7 +3143,46 @@ void vpKeyPoint::match(const cv::Mat &trainDescriptors, const cv::Mat &queryDesc
                        std::vector<cv::DMatch> &matches, double &elapsedTime) {
   double t = vpTime::measureTimeMs();
 
-  if(m_useKnn) {
+  if(m_useDescriptorIndex && !m_useMatchTrainToQuery && &trainDescriptors == &m_trainDescriptors) {
+    //Match query descriptors to the index of the train descriptors
+    buildDescriptorIndex();
+
+    const unsigned int k = m_useKnn ? 2 : 1;
+    std::vector<int> indexes;
+    std::vector<float> distances;
+    cv::Mat queries = queryDescriptors.isContinuous() ? queryDescriptors : queryDescriptors.clone();
+    if(queries.rows > 0 && !m_descriptorIndex.empty()) {
+      if(queries.cols != (int) m_descriptorIndex.getDescriptorSize()) {
+        throw vpException(vpException::dimensionError, "The query and train descriptors have different sizes !");
+      }
+
+      if(queries.type() == CV_8U) {
+        m_descriptorIndex.knnSearch(queries.ptr<unsigned char>(0), (unsigned int) queries.rows, k, indexes, distances);
+      } else if(queries.type() == CV_32F) {
+        m_descriptorIndex.knnSearch(queries.ptr<float>(0), (unsigned int) queries.rows, k, indexes, distances);
+      } else {
+        throw vpException(vpException::badValue, "The descriptor index needs CV_8U or CV_32F descriptors !");
+      }
+    }
+
+    //As with knnMatch(), there is one list of neighbours per query, with less than k neighbours if there are less
+    //than k train descriptors, and the queries without neighbour are not matched
+    m_knnMatches.clear();
+    matches.clear();
+    for(int i = 0; i < queries.rows && !indexes.empty(); i++) {
+      std::vector<cv::DMatch> knn;
+      for(unsigned int j = 0; j < k && indexes[i*k + j] >= 0; j++) {
+        knn.push_back(cv::DMatch(i, indexes[i*k + j], distances[i*k + j]));
+      }
+
+      if(!knn.empty()) {
+        matches.push_back(knn.front());
+      }
+      if(m_useKnn) {
+        m_knnMatches.push_back(knn);
+      }
+    }
+  } else if(m_useKnn) {
     m_knnMatches.clear();
 
     if(m_useMatchTrainToQuery) {
@@ -3643,11 +3877,13 @@ void vpKeyPoint::reset() {
   referenceImagePointsList.clear(); currentImagePointsList.clear(); matchedReferencePoints.clear(); _reference_computed = false;
 
 
-  m_computeCovariance = false; m_covarianceMatrix = vpMatrix(); m_currentImageId = 0; m_detectionMethod = detectionScore;
+  m_computeCovariance = false; m_covarianceMatrix = vpMatrix(); m_currentImageId = 0; m_descriptorIndex = vpDescriptorIndex();
+  m_detectionMethod = detectionScore;
   m_detectionScore = 0.15; m_detectionThreshold = 100.0; m_detectionTime = 0.0; m_detectorNames.clear();
   m_detectors.clear(); m_extractionTime = 0.0; m_extractorNames.clear(); m_extractors.clear(); m_filteredMatches.clear();
   m_filterType = ratioDistanceThreshold;
-  m_imageFormat = jpgImageFormat; m_knnMatches.clear(); m_mapOfImageId.clear(); m_mapOfImages.clear();
+  m_imageFormat = jpgImageFormat; m_knnMatches.clear(); m_learningDataFile.close(); m_mapOfImageId.clear();
+  m_mapOfImages.clear();
   m_matcher = cv::Ptr<cv::DescriptorMatcher>(); m_matcherName = "BruteForce-Hamming";
   m_matches.clear(); m_matchingFactorThreshold = 2.0; m_matchingRatioThreshold = 0.85; m_matchingTime = 0.0;
   m_matchRansacKeyPointsToPoints.clear(); m_nbRansacIterations = 200; m_nbRansacMinInlierCount = 100;
@@ -3659,7 +3895,7 @@ void vpKeyPoint::reset() {
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
   m_useBruteForceCrossCheck = true;
 #endif
-  m_useConsensusPercentage = false;
+  m_useConsensusPercentage = false; m_useDescriptorIndex = false;
   m_useKnn = true; //as m_filterType == ratioDistanceThreshold
   m_useMatchTrainToQuery = false; m_useRansacVVS = true; m_useSingleMatchFilter = true;
 
@@ -3675,6 +3911,9 @@ void vpKeyPoint::reset() {
    \param filename : Path of the save file
    \param binaryMode : If true, the data are saved in binary mode, otherwise in XML mode
    \param saveTrainingImages : If true, save also the training images on disk
+
+   When setUseDescriptorIndex() is enabled, the index of the train descriptors is also saved in the file
+   \e filename.index, to be loaded by loadLearningData().
  */
 void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode, const bool saveTrainingImages) {
   std::string parent = vpIoTools::getParent(filename);
@@ -3684,50 +3923,7 @@ void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode,
 
   std::map<int, std::string> mapOfImgPath;
   if(saveTrainingImages) {
-#ifdef VISP_HAVE_MODULE_IO
-    //Save the training image files in the same directory
-    int cpt = 0;
-
-    for(std::map<int, vpImage<unsigned char> >::const_iterator it = m_mapOfImages.begin(); it != m_mapOfImages.end(); ++it, cpt++) {
-      if(cpt > 999) {
-        throw vpException(vpException::fatalError, "The number of training images to save is too big !");
-      }
-
-      char buffer[4];
-      sprintf(buffer, "%03d", cpt);
-      std::stringstream ss;
-      ss << "train_image_" << buffer;
-
-      switch(m_imageFormat) {
-      case jpgImageFormat:
-        ss << ".jpg";
-        break;
-
-      case pngImageFormat:
-        ss << ".png";
-        break;
-
-      case ppmImageFormat:
-        ss << ".ppm";
-        break;
-
-      case pgmImageFormat:
-        ss << ".pgm";
-        break;
-
-      default:
-        ss << ".png";
-        break;
-      }
-
-      std::string imgFilename = ss.str();
-      mapOfImgPath[it->first] = imgFilename;
-      vpImageIo::write(it->second, parent + (!parent.empty() ? "/" : "") + imgFilename);
-    }
-#else
-    std::cout << "Warning: in vpKeyPoint::saveLearningData() training images are not saved because "
-        "visp_io module is not available !" << std::endl;
-#endif
+    mapOfImgPath = saveTrainingImageFiles(parent);
   }
 
   bool have3DInfo = m_trainPoints.size() > 0;
@@ -4105,6 +4301,131 @@ void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode,
     std::cerr << "Error: libxml2 is required !" << std::endl;
 #endif
   }
+
+  if(m_useDescriptorIndex && !m_trainDescriptors.empty()) {
+    buildDescriptorIndex();
+    m_descriptorIndex.save(filename + ".index");
+  }
+}
+
+/*!
+   Save the training images in the directory of a learning file.
+
+   \param parent : Directory of the learning file.
+   \return The paths of the saved images, relative to \e parent, indexed by the ids of the images.
+ */
+std::map<int, std::string> vpKeyPoint::saveTrainingImageFiles(const std::string &parent) {
+  std::map<int, std::string> mapOfImgPath;
+#ifdef VISP_HAVE_MODULE_IO
+  //Save the training image files in the same directory
+  int cpt = 0;
+
+  for(std::map<int, vpImage<unsigned char> >::const_iterator it = m_mapOfImages.begin(); it != m_mapOfImages.end(); ++it, cpt++) {
+    if(cpt > 999) {
+      throw vpException(vpException::fatalError, "The number of training images to save is too big !");
+    }
+
+    char buffer[4];
+    sprintf(buffer, "%03d", cpt);
+    std::stringstream ss;
+    ss << "train_image_" << buffer;
+
+    switch(m_imageFormat) {
+    case jpgImageFormat:
+      ss << ".jpg";
+      break;
+
+    case pngImageFormat:
+      ss << ".png";
+      break;
+
+    case ppmImageFormat:
+      ss << ".ppm";
+      break;
+
+    case pgmImageFormat:
+      ss << ".pgm";
+      break;
+
+    default:
+      ss << ".png";
+      break;
+    }
+
+    std::string imgFilename = ss.str();
+    mapOfImgPath[it->first] = imgFilename;
+    vpImageIo::write(it->second, parent + (!parent.empty() ? "/" : "") + imgFilename);
+  }
+#else
+  (void)parent;
+  std::cout << "Warning: training images are not saved because visp_io module is not available !" << std::endl;
+#endif
+
+  return mapOfImgPath;
+}
+
+/*!
+   Save the learning data in a binary file that is mapped in memory by loadLearningData() instead of being parsed,
+   which is much faster than loading a file saved by saveLearningData() (see vpLearningDataFile).
+
+   \param filename : Path of the save file.
+   \param saveTrainingImages : If true, save also the training images on disk.
+
+   When setUseDescriptorIndex() is enabled, the index of the train descriptors is stored in the file.
+ */
+void vpKeyPoint::saveMappedLearningData(const std::string &filename, const bool saveTrainingImages) {
+  std::string parent = vpIoTools::getParent(filename);
+  if(!parent.empty()) {
+    vpIoTools::makeDirectory(parent);
+  }
+
+  std::map<int, std::string> mapOfImgPath;
+  if(saveTrainingImages) {
+    mapOfImgPath = saveTrainingImageFiles(parent);
+  }
+
+  bool have3DInfo = m_trainPoints.size() > 0;
+  if(have3DInfo && m_trainPoints.size() != m_trainKeyPoints.size()) {
+    throw vpException(vpException::fatalError, "List of keypoints and list of 3D points have different size !");
+  }
+  if(m_trainDescriptors.rows != (int) m_trainKeyPoints.size() || m_trainDescriptors.channels() != 1) {
+    throw vpException(vpException::fatalError, "List of keypoints and descriptors have different size !");
+  }
+
+  std::vector<vpLearningDataFile::KeyPoint> keyPoints(m_trainKeyPoints.size());
+  for(size_t i = 0; i < m_trainKeyPoints.size(); i++) {
+    vpLearningDataFile::KeyPoint &keyPoint = keyPoints[i];
+    keyPoint.u = m_trainKeyPoints[i].pt.x;
+    keyPoint.v = m_trainKeyPoints[i].pt.y;
+    keyPoint.size = m_trainKeyPoints[i].size;
+    keyPoint.angle = m_trainKeyPoints[i].angle;
+    keyPoint.response = m_trainKeyPoints[i].response;
+    keyPoint.octave = m_trainKeyPoints[i].octave;
+    keyPoint.classId = m_trainKeyPoints[i].class_id;
+#ifdef VISP_HAVE_MODULE_IO
+    std::map<int, int>::const_iterator it_findImgId = m_mapOfImageId.find(m_trainKeyPoints[i].class_id);
+    keyPoint.imageId = (saveTrainingImages && it_findImgId != m_mapOfImageId.end()) ? it_findImgId->second : -1;
+#else
+    keyPoint.imageId = -1;
+#endif
+  }
+
+  std::vector<float> points3D(3 * m_trainPoints.size());
+  for(size_t i = 0; i < m_trainPoints.size(); i++) {
+    points3D[3*i] = m_trainPoints[i].x;
+    points3D[3*i + 1] = m_trainPoints[i].y;
+    points3D[3*i + 2] = m_trainPoints[i].z;
+  }
+
+  const vpDescriptorIndex *index = NULL;
+  if(m_useDescriptorIndex && !m_trainDescriptors.empty()) {
+    buildDescriptorIndex();
+    index = &m_descriptorIndex;
+  }
+
+  cv::Mat descriptors = m_trainDescriptors.isContinuous() ? m_trainDescriptors : m_trainDescriptors.clone();
+  vpLearningDataFile::save(filename, keyPoints, descriptors.data, (unsigned int) descriptors.cols, descriptors.type(),
+                           (unsigned int) descriptors.elemSize(), points3D, mapOfImgPath, index);
 }
 
 #if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x030000)
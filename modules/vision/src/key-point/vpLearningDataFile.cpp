@@ -0,0 +1,794 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Memory mapped file of keypoint learning data.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpLearningDataFile.cpp
+  \brief Memory mapped file of keypoint learning data.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdint.h>
+#include <stdio.h>
+#include <streambuf>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMutex.h>
+#include <visp3/vision/vpLearningDataFile.h>
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+#  define VP_LEARNING_DATA_FILE_LOCK
+#endif
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define VISP_HAVE_FILE_MAPPING
+#elif defined(_WIN32)
+#  include <windows.h>
+#  define VISP_HAVE_FILE_MAPPING
+#endif
+
+namespace {
+//! Identifier of the files
+const char fileMagic[8] = { 'V', 'P', 'L', 'D', 'A', 'T', 'A', '\0' };
+//! Version of the format written by save()
+const unsigned int fileVersion = 1;
+//! Size of the header and of an entry of the table of sections
+const unsigned int headerSize = 64, sectionEntrySize = 32;
+//! Offset of the checksum in the header
+const unsigned int checksumOffset = 60;
+//! Alignment of the sections in the file
+const uint64_t sectionAlignment = 64;
+//! Maximum number of sections of a file
+const unsigned int maxNbSections = 64;
+
+//! Types of the sections
+const unsigned int keyPointSection = 1, descriptorSection = 2, point3DSection = 3, imageSection = 4,
+                   indexSection = 5;
+
+//! The keypoints are mapped as they are stored
+typedef char keyPointSizeCheck[sizeof(vpLearningDataFile::KeyPoint) == 32 ? 1 : -1];
+
+inline bool isLittleEndian()
+{
+  const unsigned int one = 1;
+  unsigned char byte;
+  memcpy(&byte, &one, 1);
+  return byte == 1;
+}
+
+//! Reverse the bytes of each element of an array
+void swapBytes(char *data, const size_t size, const unsigned int elementSize)
+{
+  for (size_t i = 0; i + elementSize <= size; i += elementSize) {
+    std::reverse(data + i, data + i + elementSize);
+  }
+}
+
+inline unsigned int readUInt(const unsigned char *bytes)
+{
+  return (unsigned int) bytes[0] | ((unsigned int) bytes[1] << 8) | ((unsigned int) bytes[2] << 16) |
+         ((unsigned int) bytes[3] << 24);
+}
+
+inline void writeUInt(unsigned char *bytes, const unsigned int value)
+{
+  for (unsigned int i = 0; i < 4; i++) {
+    bytes[i] = (unsigned char) ((value >> (8 * i)) & 0xFF);
+  }
+}
+
+//! Append an unsigned int in little endian
+inline void appendUInt(std::vector<unsigned char> &bytes, const unsigned int value)
+{
+  bytes.resize(bytes.size() + 4);
+  writeUInt(&bytes[bytes.size() - 4], value);
+}
+
+//! FNV-1a hash of the header and of the table of sections
+unsigned int computeChecksum(const unsigned char *bytes, const size_t size, unsigned int hash = 2166136261u)
+{
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+inline uint64_t alignSection(const uint64_t offset)
+{
+  return (offset + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+}
+
+//! Read only stream buffer over bytes in memory
+class MemoryBuffer : public std::streambuf
+{
+public:
+  MemoryBuffer(const char *data, const size_t size)
+  {
+    char *begin = const_cast<char *>(data);
+    setg(begin, begin, begin + size);
+  }
+};
+
+//! Section to write
+struct SectionData {
+  SectionData(const unsigned int type_, const char *data_, const size_t size_) : type(type_), data(data_), size(size_)
+  {
+  }
+
+  unsigned int type;
+  const char *data;
+  size_t size;
+};
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+class vpLearningDataFile::Data
+{
+public:
+  //! Entry of the table of sections
+  struct Section {
+    unsigned int type;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  //! Lock of the sections read when the file is not mapped, released by the destructor
+  class Lock
+  {
+  public:
+    explicit Lock(Data &data) : m_data(data) { m_data.lock(); }
+    ~Lock() { m_data.unlock(); }
+
+  private:
+    Lock(const Lock &);
+    Lock &operator=(const Lock &);
+
+    Data &m_data;
+  };
+
+  Data()
+    : refCount(1), stream(), mapping(NULL), mappingSize(0), sections(), buffers(), nbDescriptors(0),
+      descriptorSize(0), descriptorType(0), descriptorElementSize(0)
+#ifdef VP_LEARNING_DATA_FILE_LOCK
+      , m_mutex()
+#endif
+  {
+  }
+
+  ~Data() { unmap(); }
+
+  //! Map the whole file in memory, return false if not possible
+  bool map(const std::string &filename)
+  {
+#if !defined(_WIN32) && defined(VISP_HAVE_FILE_MAPPING)
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0 &&
+        (uint64_t) (size_t) status.st_size == (uint64_t) status.st_size) {
+      // The private mapping is copy-on-write: the data can be modified without modifying the file
+      void *address = mmap(NULL, (size_t) status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      if (address != MAP_FAILED) {
+        mapping = (char *) address;
+        mappingSize = (size_t) status.st_size;
+      }
+    }
+    ::close(fd);
+#elif defined(_WIN32)
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0 &&
+        (uint64_t) (size_t) size.QuadPart == (uint64_t) size.QuadPart) {
+      HANDLE fileMapping = CreateFileMapping(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+      if (fileMapping != NULL) {
+        // The view keeps the mapping alive once its handle is closed
+        void *address = MapViewOfFile(fileMapping, FILE_MAP_COPY, 0, 0, 0);
+        if (address != NULL) {
+          mapping = (char *) address;
+          mappingSize = (size_t) size.QuadPart;
+        }
+        CloseHandle(fileMapping);
+      }
+    }
+    CloseHandle(file);
+#else
+    (void)filename;
+#endif
+    return mapping != NULL;
+  }
+
+  void unmap()
+  {
+    if (mapping != NULL) {
+#if !defined(_WIN32) && defined(VISP_HAVE_FILE_MAPPING)
+      munmap(mapping, mappingSize);
+#elif defined(_WIN32)
+      UnmapViewOfFile(mapping);
+#endif
+      mapping = NULL;
+      mappingSize = 0;
+    }
+  }
+
+  //! Section of a given type, NULL if the file has none
+  const Section *findSection(const unsigned int type) const
+  {
+    for (size_t i = 0; i < sections.size(); i++) {
+      if (sections[i].type == type) {
+        return &sections[i];
+      }
+    }
+    return NULL;
+  }
+
+  unsigned int refCount;
+  //! File from which the sections are read when it is not mapped
+  std::ifstream stream;
+  char *mapping;
+  size_t mappingSize;
+  std::vector<Section> sections;
+  //! Sections already read when the file is not mapped
+  std::map<unsigned int, std::vector<char> > buffers;
+  unsigned int nbDescriptors;
+  unsigned int descriptorSize;
+  int descriptorType;
+  unsigned int descriptorElementSize;
+
+private:
+  Data(const Data &);
+  Data &operator=(const Data &);
+
+  void lock()
+  {
+#ifdef VP_LEARNING_DATA_FILE_LOCK
+    m_mutex.lock();
+#endif
+  }
+
+  void unlock()
+  {
+#ifdef VP_LEARNING_DATA_FILE_LOCK
+    m_mutex.unlock();
+#endif
+  }
+
+#ifdef VP_LEARNING_DATA_FILE_LOCK
+  //! Protects the stream and the buffers, since the getters read the sections on demand
+  vpMutex m_mutex;
+#endif
+};
+#endif
+
+/*!
+  Default constructor: no file is open.
+*/
+vpLearningDataFile::vpLearningDataFile() : m_data(NULL) {}
+
+/*!
+  Copy constructor: the copy shares the file open by \e file.
+*/
+vpLearningDataFile::vpLearningDataFile(const vpLearningDataFile &file) : m_data(file.m_data)
+{
+  if (m_data != NULL) {
+    m_data->refCount++;
+  }
+}
+
+/*!
+  Destructor that closes the file.
+*/
+vpLearningDataFile::~vpLearningDataFile() { close(); }
+
+/*!
+  Close the file. The data returned by the getters are not valid anymore,
+  unless the file is still open by a copy of this object.
+*/
+void vpLearningDataFile::close()
+{
+  if (m_data != NULL && --m_data->refCount == 0) {
+    delete m_data;
+  }
+  m_data = NULL;
+}
+
+/*!
+  Descriptors, stored as a row major matrix of getNbDescriptors() rows and
+  getDescriptorSize() columns, each element being of
+  getDescriptorElementSize() bytes, in the byte order of the host. NULL if
+  the file has no descriptor.
+
+  When the file is mapped, the memory is a private copy of the file: it can
+  be modified without modifying the file.
+*/
+const void *vpLearningDataFile::getDescriptors() const
+{
+  size_t size;
+  return getSection(descriptorSection, size);
+}
+
+/*!
+  Number of bytes of an element of a descriptor.
+*/
+unsigned int vpLearningDataFile::getDescriptorElementSize() const
+{
+  return m_data != NULL ? m_data->descriptorElementSize : 0;
+}
+
+/*!
+  Number of elements of a descriptor.
+*/
+unsigned int vpLearningDataFile::getDescriptorSize() const { return m_data != NULL ? m_data->descriptorSize : 0; }
+
+/*!
+  Type of the descriptors given to save(), for example the OpenCV type of
+  the descriptor matrix.
+*/
+int vpLearningDataFile::getDescriptorType() const { return m_data != NULL ? m_data->descriptorType : 0; }
+
+/*!
+  Paths of the training images, relative to the directory of the file if
+  they are not absolute, indexed by the identifiers of the images.
+*/
+std::map<int, std::string> vpLearningDataFile::getImages() const
+{
+  std::map<int, std::string> images;
+  size_t size;
+  const unsigned char *bytes = (const unsigned char *) getSection(imageSection, size);
+  if (bytes == NULL) {
+    return images;
+  }
+
+  if (size < 4) {
+    throw vpException(vpException::ioError, "Corrupted image section");
+  }
+  size_t position = 4;
+  const unsigned int nbImages = readUInt(bytes);
+  for (unsigned int i = 0; i < nbImages; i++) {
+    if (position + 8 > size) {
+      throw vpException(vpException::ioError, "Corrupted image section");
+    }
+    const int id = (int) readUInt(bytes + position);
+    const unsigned int length = readUInt(bytes + position + 4);
+    position += 8;
+    if (length > size - position) {
+      throw vpException(vpException::ioError, "Corrupted image section");
+    }
+    images[id] = std::string((const char *) bytes + position, length);
+    position += length;
+  }
+  return images;
+}
+
+/*!
+  Load the index of the descriptors stored in the file.
+
+  The index and the descriptors are written together by save(), so the
+  descriptors are not checked against the checksum of the index: the
+  loading does not read them.
+
+  \param index : Index of the descriptors returned by getDescriptors(), that
+  must stay valid as long as the index is used.
+
+  \return false if the file has no index or if its index does not match the
+  number, size or type of its descriptors. The index is then empty and must
+  be built.
+*/
+bool vpLearningDataFile::getIndex(vpDescriptorIndex &index) const
+{
+  index.clear();
+  size_t size;
+  const char *data = getSection(indexSection, size);
+  const void *descriptors = getDescriptors();
+  if (data == NULL || descriptors == NULL) {
+    return false;
+  }
+
+  MemoryBuffer buffer(data, size);
+  std::istream stream(&buffer);
+  if (m_data->descriptorElementSize == 1) {
+    return index.loadIndex(stream, descriptors, m_data->nbDescriptors, m_data->descriptorSize,
+                           vpDescriptorIndex::BINARY_DESCRIPTOR, false);
+  }
+  else if (m_data->descriptorElementSize == sizeof(float)) {
+    return index.loadIndex(stream, descriptors, m_data->nbDescriptors, m_data->descriptorSize,
+                           vpDescriptorIndex::FLOAT_DESCRIPTOR, false);
+  }
+  return false;
+}
+
+/*!
+  Keypoints, in the order of the descriptors. NULL if the file has no
+  keypoint.
+*/
+const vpLearningDataFile::KeyPoint *vpLearningDataFile::getKeyPoints() const
+{
+  size_t size;
+  return (const KeyPoint *) getSection(keyPointSection, size);
+}
+
+/*!
+  Number of keypoints and of descriptors.
+*/
+unsigned int vpLearningDataFile::getNbDescriptors() const { return m_data != NULL ? m_data->nbDescriptors : 0; }
+
+/*!
+  3D coordinates X, Y, Z of the keypoints, NULL if the file has none.
+*/
+const float *vpLearningDataFile::getPoints3D() const
+{
+  size_t size;
+  return (const float *) getSection(point3DSection, size);
+}
+
+const char *vpLearningDataFile::getSection(const unsigned int type, size_t &size) const
+{
+  size = 0;
+  const Data::Section *section = m_data != NULL ? m_data->findSection(type) : NULL;
+  if (section == NULL || section->size == 0) {
+    return NULL;
+  }
+  size = (size_t) section->size;
+  if (m_data->mapping != NULL) {
+    return m_data->mapping + section->offset;
+  }
+
+  // The buffers are not moved when another one is inserted, so that the pointers returned stay valid
+  Data::Lock lock(*m_data);
+  std::map<unsigned int, std::vector<char> >::iterator it = m_data->buffers.find(type);
+  if (it == m_data->buffers.end()) {
+    std::vector<char> buffer(size);
+    m_data->stream.clear();
+    if (!m_data->stream.seekg((std::streamoff) section->offset) ||
+        !m_data->stream.read(&buffer[0], (std::streamsize) size)) {
+      throw vpException(vpException::ioError, "Cannot read the section %u of the file", type);
+    }
+    if (!isLittleEndian()) {
+      if (type == keyPointSection || type == point3DSection) {
+        swapBytes(&buffer[0], size, 4);
+      }
+      else if (type == descriptorSection) {
+        swapBytes(&buffer[0], size, m_data->descriptorElementSize);
+      }
+    }
+    it = m_data->buffers.insert(std::make_pair(type, std::vector<char>())).first;
+    it->second.swap(buffer);
+  }
+  return &it->second[0];
+}
+
+/*!
+  Return true if the file has an index of the descriptors.
+*/
+bool vpLearningDataFile::hasIndex() const { return m_data != NULL && m_data->findSection(indexSection) != NULL; }
+
+/*!
+  Return true if the file has the 3D coordinates of the keypoints.
+*/
+bool vpLearningDataFile::hasPoints3D() const
+{
+  const Data::Section *section = m_data != NULL ? m_data->findSection(point3DSection) : NULL;
+  return section != NULL && section->size > 0;
+}
+
+/*!
+  Return true if the file starts with the identifier of the files written
+  by save(), without checking its content.
+*/
+bool vpLearningDataFile::isLearningDataFile(const std::string &filename)
+{
+  std::ifstream file(filename.c_str(), std::ifstream::binary);
+  char magic[8];
+  return file.read(magic, 8) && std::equal(magic, magic + 8, fileMagic);
+}
+
+/*!
+  Return true if the file is mapped in memory, false if its sections are
+  read in memory.
+*/
+bool vpLearningDataFile::isMapped() const { return m_data != NULL && m_data->mapping != NULL; }
+
+/*!
+  Open a file written by save(). Only the header and the table of sections
+  are read: the sections are read when they are requested.
+
+  \param filename : Name of the file.
+  \param map : If true, the file is mapped in memory when the host allows
+  it. Otherwise the sections are read in memory.
+
+  \exception vpException::ioError : The file cannot be read, or its header
+  or its table of sections are corrupted.
+*/
+void vpLearningDataFile::open(const std::string &filename, const bool map)
+{
+  close();
+  Data *data = new Data;
+  try {
+    data->stream.open(filename.c_str(), std::ifstream::binary);
+    if (!data->stream.is_open()) {
+      throw vpException(vpException::ioError, "Cannot open the file: %s", filename.c_str());
+    }
+    data->stream.seekg(0, std::ios::end);
+    const uint64_t fileSize = (uint64_t) data->stream.tellg();
+    data->stream.seekg(0, std::ios::beg);
+
+    std::vector<unsigned char> header(headerSize);
+    if (!data->stream.read((char *) &header[0], headerSize) ||
+        !std::equal(header.begin(), header.begin() + 8, (const unsigned char *) fileMagic)) {
+      throw vpException(vpException::ioError, "The file is not a learning data file: %s", filename.c_str());
+    }
+    if (readUInt(&header[8]) != fileVersion) {
+      throw vpException(vpException::ioError, "Unsupported version %u of the file: %s", readUInt(&header[8]),
+                        filename.c_str());
+    }
+    const unsigned int tableOffset = readUInt(&header[12]), nbSections = readUInt(&header[16]);
+    if (tableOffset < headerSize || nbSections > maxNbSections ||
+        tableOffset + (uint64_t) nbSections * sectionEntrySize > fileSize) {
+      throw vpException(vpException::ioError, "Corrupted header of the file: %s", filename.c_str());
+    }
+
+    std::vector<unsigned char> table(nbSections * sectionEntrySize + 1);
+    data->stream.seekg(tableOffset);
+    if (!data->stream.read((char *) &table[0], (std::streamsize) (table.size() - 1)) ||
+        computeChecksum(&table[0], table.size() - 1, computeChecksum(&header[0], checksumOffset)) !=
+            readUInt(&header[checksumOffset])) {
+      throw vpException(vpException::ioError, "Corrupted header of the file: %s", filename.c_str());
+    }
+
+    data->nbDescriptors = readUInt(&header[20]);
+    data->descriptorSize = readUInt(&header[24]);
+    data->descriptorType = (int) readUInt(&header[28]);
+    data->descriptorElementSize = readUInt(&header[32]);
+    const unsigned int elementSize = data->descriptorElementSize;
+    if (elementSize != 1 && elementSize != 2 && elementSize != 4 && elementSize != 8) {
+      throw vpException(vpException::ioError, "Corrupted header of the file: %s", filename.c_str());
+    }
+
+    // Sizes of the known sections, the unknown ones are ignored
+    const uint64_t nbDescriptors = data->nbDescriptors;
+    for (unsigned int i = 0; i < nbSections; i++) {
+      const unsigned char *entry = &table[i * sectionEntrySize];
+      Data::Section section;
+      section.type = readUInt(entry);
+      section.offset = readUInt(entry + 8) | ((uint64_t) readUInt(entry + 12) << 32);
+      section.size = readUInt(entry + 16) | ((uint64_t) readUInt(entry + 20) << 32);
+      bool valid = section.offset % sectionAlignment == 0 && section.offset <= fileSize &&
+                   section.size <= fileSize - section.offset && data->findSection(section.type) == NULL;
+      if (section.type == keyPointSection) {
+        valid = valid && section.size == nbDescriptors * sizeof(KeyPoint);
+      }
+      else if (section.type == descriptorSection) {
+        valid = valid && section.size == nbDescriptors * data->descriptorSize * elementSize;
+      }
+      else if (section.type == point3DSection) {
+        valid = valid && (section.size == 0 || section.size == nbDescriptors * 3 * sizeof(float));
+      }
+      if (!valid) {
+        throw vpException(vpException::ioError, "Corrupted section %u of the file: %s", section.type,
+                          filename.c_str());
+      }
+      data->sections.push_back(section);
+    }
+    if (data->findSection(keyPointSection) == NULL || data->findSection(descriptorSection) == NULL) {
+      throw vpException(vpException::ioError, "Missing sections in the file: %s", filename.c_str());
+    }
+
+    // The mapped data are used as they are stored, in little endian
+    if (map && isLittleEndian() && data->map(filename) && data->mappingSize == fileSize) {
+      data->stream.close();
+    }
+    else {
+      data->unmap();
+    }
+  }
+  catch (...) {
+    delete data;
+    throw;
+  }
+  m_data = data;
+}
+
+/*!
+  Copy operator: this object shares the file open by \e file.
+*/
+vpLearningDataFile &vpLearningDataFile::operator=(const vpLearningDataFile &file)
+{
+  if (file.m_data != NULL) {
+    file.m_data->refCount++;
+  }
+  close();
+  m_data = file.m_data;
+  return *this;
+}
+
+/*!
+  Write learning data in a file, to be open with open().
+
+  The file is first written under a temporary name, then renamed, so that a
+  file is never left partially written. On UNIX, a file can be replaced
+  while it is mapped by another vpLearningDataFile, which keeps the former
+  content. On Windows, the replacement of a mapped file fails.
+
+  \param filename : Name of the file.
+  \param keyPoints : Keypoints.
+  \param descriptors : Descriptors of the keypoints, stored as a row major
+  matrix of keyPoints.size() rows, in the byte order of the host.
+  \param descriptorSize : Number of elements of a descriptor.
+  \param descriptorType : Type of the descriptors, returned by
+  getDescriptorType().
+  \param descriptorElementSize : Number of bytes of an element of a
+  descriptor, 1, 2, 4 or 8.
+  \param points3D : 3D coordinates X, Y, Z of the keypoints, or empty.
+  \param images : Paths of the training images indexed by their identifiers.
+  \param index : Index of \e descriptors to store in the file, or NULL.
+
+  \exception vpException::badValue : The sizes of the data do not match.
+  \exception vpException::ioError : The file cannot be written.
+*/
+void vpLearningDataFile::save(const std::string &filename, const std::vector<KeyPoint> &keyPoints,
+                              const void *descriptors, const unsigned int descriptorSize, const int descriptorType,
+                              const unsigned int descriptorElementSize, const std::vector<float> &points3D,
+                              const std::map<int, std::string> &images, const vpDescriptorIndex *index)
+{
+  const unsigned int elementSize = descriptorElementSize;
+  const size_t nbDescriptors = keyPoints.size();
+  if (elementSize != 1 && elementSize != 2 && elementSize != 4 && elementSize != 8) {
+    throw vpException(vpException::badValue, "Invalid size of the elements of the descriptors: %u", elementSize);
+  }
+  if ((descriptors == NULL && nbDescriptors * descriptorSize > 0) ||
+      (!points3D.empty() && points3D.size() != 3 * nbDescriptors) || nbDescriptors != (unsigned int) nbDescriptors) {
+    throw vpException(vpException::badValue, "The keypoints, the descriptors and the 3D points do not match");
+  }
+  if (index != NULL && (index->getDescriptors() != descriptors || index->getNbDescriptors() != nbDescriptors)) {
+    throw vpException(vpException::badValue, "The index is not built for the descriptors");
+  }
+
+  // Sections converted in little endian
+  const bool littleEndian = isLittleEndian();
+  std::vector<SectionData> sections;
+  std::vector<char> keyPointData(nbDescriptors * sizeof(KeyPoint));
+  if (!keyPointData.empty()) {
+    memcpy(&keyPointData[0], &keyPoints[0], keyPointData.size());
+    if (!littleEndian) {
+      swapBytes(&keyPointData[0], keyPointData.size(), 4);
+    }
+  }
+  sections.push_back(SectionData(keyPointSection, keyPointData.empty() ? NULL : &keyPointData[0], keyPointData.size()));
+
+  std::vector<char> descriptorData;
+  const size_t descriptorDataSize = nbDescriptors * descriptorSize * elementSize;
+  if (!littleEndian && elementSize > 1 && descriptorDataSize > 0) {
+    descriptorData.assign((const char *) descriptors, (const char *) descriptors + descriptorDataSize);
+    swapBytes(&descriptorData[0], descriptorData.size(), elementSize);
+    descriptors = &descriptorData[0];
+  }
+  sections.push_back(SectionData(descriptorSection, (const char *) descriptors, descriptorDataSize));
+
+  std::vector<char> point3DData(points3D.size() * sizeof(float));
+  if (!point3DData.empty()) {
+    memcpy(&point3DData[0], &points3D[0], point3DData.size());
+    if (!littleEndian) {
+      swapBytes(&point3DData[0], point3DData.size(), 4);
+    }
+    sections.push_back(SectionData(point3DSection, &point3DData[0], point3DData.size()));
+  }
+
+  std::vector<unsigned char> imageData;
+  if (!images.empty()) {
+    appendUInt(imageData, (unsigned int) images.size());
+    for (std::map<int, std::string>::const_iterator it = images.begin(); it != images.end(); ++it) {
+      appendUInt(imageData, (unsigned int) it->first);
+      appendUInt(imageData, (unsigned int) it->second.size());
+      imageData.insert(imageData.end(), it->second.begin(), it->second.end());
+    }
+    sections.push_back(SectionData(imageSection, (const char *) &imageData[0], imageData.size()));
+  }
+
+  std::string indexData;
+  if (index != NULL && !index->empty()) {
+    std::ostringstream stream(std::ios::out | std::ios::binary);
+    index->save(stream);
+    indexData = stream.str();
+    sections.push_back(SectionData(indexSection, indexData.data(), indexData.size()));
+  }
+
+  // Header and table of sections
+  std::vector<unsigned char> header(headerSize + sections.size() * sectionEntrySize, 0);
+  std::copy(fileMagic, fileMagic + 8, header.begin());
+  writeUInt(&header[8], fileVersion);
+  writeUInt(&header[12], headerSize);
+  writeUInt(&header[16], (unsigned int) sections.size());
+  writeUInt(&header[20], (unsigned int) nbDescriptors);
+  writeUInt(&header[24], descriptorSize);
+  writeUInt(&header[28], (unsigned int) descriptorType);
+  writeUInt(&header[32], elementSize);
+  std::vector<uint64_t> offsets(sections.size());
+  uint64_t offset = header.size();
+  for (size_t i = 0; i < sections.size(); i++) {
+    offsets[i] = offset = alignSection(offset);
+    unsigned char *entry = &header[headerSize + i * sectionEntrySize];
+    writeUInt(entry, sections[i].type);
+    writeUInt(entry + 8, (unsigned int) (offset & 0xFFFFFFFF));
+    writeUInt(entry + 12, (unsigned int) (offset >> 32));
+    writeUInt(entry + 16, (unsigned int) ((uint64_t) sections[i].size & 0xFFFFFFFF));
+    writeUInt(entry + 20, (unsigned int) ((uint64_t) sections[i].size >> 32));
+    offset += sections[i].size;
+  }
+  const unsigned int headerChecksum = computeChecksum(&header[0], checksumOffset);
+  writeUInt(&header[checksumOffset], computeChecksum(&header[headerSize], header.size() - headerSize, headerChecksum));
+
+  const std::string temporaryFilename = filename + ".tmp";
+  {
+    std::ofstream file(temporaryFilename.c_str(), std::ofstream::binary);
+    if (!file.is_open()) {
+      throw vpException(vpException::ioError, "Cannot create the file: %s", temporaryFilename.c_str());
+    }
+    file.write((const char *) &header[0], (std::streamsize) header.size());
+    const char padding[sectionAlignment] = { 0 };
+    uint64_t position = header.size();
+    for (size_t i = 0; i < sections.size(); i++) {
+      file.write(padding, (std::streamsize) (offsets[i] - position));
+      if (sections[i].size > 0) {
+        file.write(sections[i].data, (std::streamsize) sections[i].size);
+      }
+      position = offsets[i] + sections[i].size;
+    }
+    if (!file) {
+      file.close();
+      remove(temporaryFilename.c_str());
+      throw vpException(vpException::ioError, "Cannot write the file: %s", temporaryFilename.c_str());
+    }
+  }
+
+#if defined(_WIN32)
+  // rename() does not replace an existing file on Windows
+  if (!MoveFileExA(temporaryFilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+  if (rename(temporaryFilename.c_str(), filename.c_str()) != 0) {
+#endif
+    remove(temporaryFilename.c_str());
+    throw vpException(vpException::ioError, "Cannot write the file: %s", filename.c_str());
+  }
+}
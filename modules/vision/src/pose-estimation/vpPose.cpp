@@ -56,6 +56,33 @@ pour faire du calcul de pose par difference methode
 #include <limits>   // numeric_limits
 
 #define DEBUG_LEVEL1 0
+
+namespace {
+  //! Coordinates of a point in the object frame and in the image plane
+  vpPose::Correspondence toCorrespondence(const vpPoint &P)
+  {
+    vpPose::Correspondence c;
+    c.oX = P.get_oX();
+    c.oY = P.get_oY();
+    c.oZ = P.get_oZ();
+    c.x = P.get_x();
+    c.y = P.get_y();
+    return c;
+  }
+
+  //! Squared reprojection error of a correspondence with the pose cMo
+  double squaredReprojectionError(const vpPose::Correspondence &P, const vpHomogeneousMatrix &cMo)
+  {
+    // Projection of the point with the pose
+    double X = cMo[0][0]*P.oX + cMo[0][1]*P.oY + cMo[0][2]*P.oZ + cMo[0][3] ;
+    double Y = cMo[1][0]*P.oX + cMo[1][1]*P.oY + cMo[1][2]*P.oZ + cMo[1][3] ;
+    double Z = cMo[2][0]*P.oX + cMo[2][1]*P.oY + cMo[2][2]*P.oZ + cMo[2][3] ;
+    double d = 1/Z ;
+
+    return vpMath::sqr(P.x-X*d) + vpMath::sqr(P.y-Y*d) ;
+  }
+}
+
 /*!
   Basic initialisation that is called by the constructors.
 */
@@ -68,6 +95,9 @@ vpPose::init()
   npt = 0 ;
   listP.clear();
   c3d.clear();
+  correspondences.clear();
+  correspondencesOnly = false;
+  prosacQuality.clear();
 
   lambda = 0.25 ;
 
@@ -90,11 +120,12 @@ vpPose::init()
 
 /*! Default constructor. */
 vpPose::vpPose()
-  : npt(0), listP(), residual(0), lambda(0.25), vvsIterMax(200), c3d(),
+  : npt(0), listP(), residual(0), lambda(0.25), vvsIterMax(200), c3d(), correspondences(), correspondencesOnly(false),
     computeCovariance(false), covarianceMatrix(),
     ransacNbInlierConsensus(4), ransacMaxTrials(1000), ransacInliers(), ransacInlierIndex(), ransacThreshold(0.0001),
     distanceToPlaneForCoplanarityTest(0.001), ransacFlags(PREFILTER_DUPLICATE_POINTS),
-    listOfPoints(), useParallelRansac(false), nbParallelRansacThreads(0) //0 means that OpenMP is used to get the number of CPU threads
+    useParallelRansac(false), nbParallelRansacThreads(0), //0 means that OpenMP is used to get the number of CPU threads
+    prosacQuality()
 {
 #if (DEBUG_LEVEL1)
   std::cout << "begin vpPose::vpPose() " << std::endl ;
@@ -130,6 +161,8 @@ void
 vpPose::clearPoint()
 {
   listP.clear();
+  correspondences.clear();
+  prosacQuality.clear();
   npt = 0 ;
 }
 
@@ -145,7 +178,6 @@ void
 vpPose::addPoint(const vpPoint& newP)
 {
   listP.push_back(newP);
-  listOfPoints.push_back(newP);
   npt++ ;
 }
 
@@ -160,7 +192,25 @@ vpPose::addPoint(const vpPoint& newP)
 void
 vpPose::addPoints(const std::vector<vpPoint> &lP) {
   listP.insert(listP.end(), lP.begin(), lP.end());
-  listOfPoints.insert(listOfPoints.end(), lP.begin(), lP.end());
+  npt = (unsigned int) listP.size();
+}
+
+/*!
+  Copy the points of listP in the correspondences used by the pose estimation
+  methods. Since listP may have been modified directly, even in place, the
+  copy is done before each pose computation, except for the poses of the
+  RANSAC that are given their correspondences without listP.
+*/
+void
+vpPose::updateCorrespondences()
+{
+  if (correspondencesOnly)
+    return;
+
+  correspondences.clear();
+  correspondences.reserve(listP.size());
+  for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+    correspondences.push_back(toCorrespondence(*it));
   npt = (unsigned int) listP.size();
 }
 
@@ -184,6 +234,7 @@ vpPose::setDistanceToPlaneForCoplanarityTest(double d)
 bool
 vpPose::coplanar(int &coplanar_plane_type)
 {
+  updateCorrespondences() ;
   coplanar_plane_type = 0;
   if (npt <2)
   {
@@ -196,26 +247,26 @@ vpPose::coplanar(int &coplanar_plane_type)
 
   double x1=0,x2=0,x3=0,y1=0,y2=0,y3=0,z1=0,z2=0,z3=0 ;
 
-  std::list<vpPoint>::const_iterator it = listP.begin();
+  std::vector<Correspondence>::const_iterator it = correspondences.begin();
 
-  vpPoint P1, P2, P3 ;
+  Correspondence P1, P2, P3 ;
 
   // Get three 3D points that are not collinear and that is not at origin
   bool degenerate = true;
   bool not_on_origin = true;
-  std::list<vpPoint>::const_iterator it_tmp;
+  std::vector<Correspondence>::const_iterator it_tmp;
 
-  std::list<vpPoint>::const_iterator it_i, it_j, it_k;
-  for (it_i=listP.begin(); it_i != listP.end(); ++it_i) {
+  std::vector<Correspondence>::const_iterator it_i, it_j, it_k;
+  for (it_i=correspondences.begin(); it_i != correspondences.end(); ++it_i) {
     if (degenerate == false) {
       //std::cout << "Found a non degenerate configuration" << std::endl;
       break;
     }
     P1 = *it_i;
     // Test if point is on origin
-    if ((std::fabs(P1.get_oX()) <= std::numeric_limits<double>::epsilon())
-        && (std::fabs(P1.get_oY()) <= std::numeric_limits<double>::epsilon())
-        && (std::fabs(P1.get_oZ()) <= std::numeric_limits<double>::epsilon())) {
+    if ((std::fabs(P1.oX) <= std::numeric_limits<double>::epsilon())
+        && (std::fabs(P1.oY) <= std::numeric_limits<double>::epsilon())
+        && (std::fabs(P1.oZ) <= std::numeric_limits<double>::epsilon())) {
        not_on_origin = false;
     }
     else {
@@ -223,15 +274,15 @@ vpPose::coplanar(int &coplanar_plane_type)
     }
     if (not_on_origin) {
       it_tmp = it_i; ++it_tmp; // j = i+1
-      for (it_j=it_tmp; it_j != listP.end(); ++it_j) {
+      for (it_j=it_tmp; it_j != correspondences.end(); ++it_j) {
         if (degenerate == false) {
           //std::cout << "Found a non degenerate configuration" << std::endl;
           break;
         }
         P2 = *it_j;
-        if ((std::fabs(P2.get_oX()) <= std::numeric_limits<double>::epsilon())
-            && (std::fabs(P2.get_oY()) <= std::numeric_limits<double>::epsilon())
-            && (std::fabs(P2.get_oZ()) <= std::numeric_limits<double>::epsilon())) {
+        if ((std::fabs(P2.oX) <= std::numeric_limits<double>::epsilon())
+            && (std::fabs(P2.oY) <= std::numeric_limits<double>::epsilon())
+            && (std::fabs(P2.oZ) <= std::numeric_limits<double>::epsilon())) {
           not_on_origin = false;
         }
         else {
@@ -239,28 +290,28 @@ vpPose::coplanar(int &coplanar_plane_type)
         }
         if (not_on_origin) {
           it_tmp = it_j; ++it_tmp; // k = j+1
-          for (it_k=it_tmp; it_k != listP.end(); ++it_k) {
+          for (it_k=it_tmp; it_k != correspondences.end(); ++it_k) {
             P3 = *it_k;
-            if ((std::fabs(P3.get_oX()) <= std::numeric_limits<double>::epsilon())
-                && (std::fabs(P3.get_oY()) <= std::numeric_limits<double>::epsilon())
-                && (std::fabs(P3.get_oZ()) <= std::numeric_limits<double>::epsilon())) {
+            if ((std::fabs(P3.oX) <= std::numeric_limits<double>::epsilon())
+                && (std::fabs(P3.oY) <= std::numeric_limits<double>::epsilon())
+                && (std::fabs(P3.oZ) <= std::numeric_limits<double>::epsilon())) {
               not_on_origin = false;
             }
             else {
               not_on_origin = true;
             }
             if (not_on_origin) {
-              x1 = P1.get_oX() ;
-              x2 = P2.get_oX() ;
-              x3 = P3.get_oX() ;
+              x1 = P1.oX ;
+              x2 = P2.oX ;
+              x3 = P3.oX ;
 
-              y1 = P1.get_oY() ;
-              y2 = P2.get_oY() ;
-              y3 = P3.get_oY() ;
+              y1 = P1.oY ;
+              y2 = P2.oY ;
+              y3 = P3.oY ;
 
-              z1 = P1.get_oZ() ;
-              z2 = P2.get_oZ() ;
-              z3 = P3.get_oZ() ;
+              z1 = P1.oZ ;
+              z2 = P2.oZ ;
+              z3 = P3.oZ ;
 
               vpColVector a_b(3), b_c(3), cross_prod;
               a_b[0] = x1-x2; a_b[1] = y1-y2; a_b[2] = z1-z2;
@@ -304,10 +355,10 @@ vpPose::coplanar(int &coplanar_plane_type)
 
   double  D = sqrt(vpMath::sqr(a)+vpMath::sqr(b)+vpMath::sqr(c)) ;
 
-  for(it=listP.begin(); it != listP.end(); ++it)
+  for(it=correspondences.begin(); it != correspondences.end(); ++it)
   {
     P1 = *it ;
-    double dist = (a*P1.get_oX() + b*P1.get_oY()+c*P1.get_oZ()+d)/D ;
+    double dist = (a*P1.oX + b*P1.oY+c*P1.oZ+d)/D ;
     //std::cout << "dist= " << dist << std::endl;
 
     if (fabs(dist) > distanceToPlaneForCoplanarityTest)
@@ -337,16 +388,13 @@ double
 vpPose::computeResidual(const vpHomogeneousMatrix &cMo) const
 {
   double residual_ = 0 ;
-  vpPoint P ;
-  for(std::list<vpPoint>::const_iterator it=listP.begin(); it != listP.end(); ++it)
-  {
-    P = *it;
-    double x = P.get_x() ;
-    double y = P.get_y() ;
-
-    P.track(cMo) ;
-
-    residual_ += vpMath::sqr(x-P.get_x()) + vpMath::sqr(y-P.get_y())  ;
+  if (correspondencesOnly) {
+    for(std::vector<Correspondence>::const_iterator it=correspondences.begin(); it != correspondences.end(); ++it)
+      residual_ += squaredReprojectionError(*it, cMo) ;
+  }
+  else {
+    for(std::list<vpPoint>::const_iterator it=listP.begin(); it != listP.end(); ++it)
+      residual_ += squaredReprojectionError(toCorrespondence(*it), cMo) ;
   }
   return residual_ ;
 }
@@ -366,11 +414,17 @@ vpPose::computeResidual(const vpHomogeneousMatrix &cMo) const
   - vpPose::DEMENTHON_VIRTUAL_VS: Non linear virtual visual servoing approach initialized by Dementhon approach
   - vpPose::LAGRANGE_VIRTUAL_VS: Non linear virtual visual servoing approach initialized by Lagrange approach
   - vpPose::RANSAC: Robust Ransac aproach (does't need an initialization)
+  - vpPose::P3P: Minimal P3P approach on the three first points, the other points remove the ambiguity
+  - vpPose::EPNP: Linear EPnP approach (does't need an initialization)
+  - vpPose::EPNP_VIRTUAL_VS: Non linear virtual visual servoing approach initialized by EPnP approach
+  - vpPose::PROSAC: Robust PROSAC approach with P3P hypotheses and EPnP final fit (does't need an initialization)
 
 */
 bool
 vpPose::computePose(vpPoseMethodType method, vpHomogeneousMatrix& cMo, bool (*func)(vpHomogeneousMatrix *))
 {
+  updateCorrespondences() ;
+
   if (npt <4)
   {
     vpERROR_TRACE("Not enough point (%d) to compute the pose  ",npt) ;
@@ -498,6 +552,15 @@ vpPose::computePose(vpPoseMethodType method, vpHomogeneousMatrix& cMo, bool (*fu
       throw ;
     }
     break;
+  case P3P:
+    poseP3P(cMo);
+    break;
+  case EPNP:
+  case EPNP_VIRTUAL_VS:
+    poseEPnP(cMo);
+    break;
+  case PROSAC:
+    return poseProsac(cMo, func);
   case LOWE :
   case VIRTUAL_VS:
     break ;
@@ -508,10 +571,14 @@ vpPose::computePose(vpPoseMethodType method, vpHomogeneousMatrix& cMo, bool (*fu
   case LAGRANGE :
   case DEMENTHON :
   case RANSAC :
+  case P3P :
+  case EPNP :
+  case PROSAC :
     break ;
   case VIRTUAL_VS:
   case LAGRANGE_VIRTUAL_VS:
   case DEMENTHON_VIRTUAL_VS:
+  case EPNP_VIRTUAL_VS:
     {
       try
       {
@@ -61,21 +61,22 @@ Dementhon and Davis in their 1995 paper \cite Dementhon95.
 void
 vpPose::poseDementhonNonPlan(vpHomogeneousMatrix &cMo)
 {
+  updateCorrespondences() ;
   double normI = 0., normJ = 0.;
   double Z0 = 0.;
   //double seuil=1.0;
   double f=1.;
 
-  vpPoint p0 = listP.front() ;
+  Correspondence p0 = correspondences.front() ;
 
   c3d.clear();
-  vpPoint P;
-  for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+  Correspondence P;
+  for (std::vector<Correspondence>::const_iterator it = correspondences.begin(); it != correspondences.end(); ++it)
   {
     P = (*it);
-    P.set_oX(P.get_oX()-p0.get_oX()) ;
-    P.set_oY(P.get_oY()-p0.get_oY()) ;
-    P.set_oZ(P.get_oZ()-p0.get_oZ()) ;
+    P.oX -= p0.oX ;
+    P.oY -= p0.oY ;
+    P.oZ -= p0.oZ ;
     c3d.push_back(P) ;
   }
 
@@ -83,9 +84,9 @@ vpPose::poseDementhonNonPlan(vpHomogeneousMatrix &cMo)
 
   for (unsigned int i=0 ; i < npt ; i++)
   {
-    a[i][0]=c3d[i].get_oX();
-    a[i][1]=c3d[i].get_oY();
-    a[i][2]=c3d[i].get_oZ();
+    a[i][0]=c3d[i].oX;
+    a[i][1]=c3d[i].oY;
+    a[i][2]=c3d[i].oZ;
   }
 
   //std::cout << a << std::endl ;
@@ -131,8 +132,8 @@ vpPose::poseDementhonNonPlan(vpHomogeneousMatrix &cMo)
     vpColVector yprim(npt) ;
     for (unsigned int i=0;i<npt;i++)
     {
-      xprim[i]=(1+ eps[i])*c3d[i].get_x() - c3d[0].get_x();
-      yprim[i]=(1+ eps[i])*c3d[i].get_y() - c3d[0].get_y();
+      xprim[i]=(1+ eps[i])*c3d[i].x - c3d[0].x;
+      yprim[i]=(1+ eps[i])*c3d[i].y - c3d[0].y;
     }
     I = b*xprim ;
     J = b*yprim ;
@@ -154,7 +155,7 @@ vpPose::poseDementhonNonPlan(vpHomogeneousMatrix &cMo)
     for (unsigned int i=0; i<npt; i++)
     {
       //double      epsi_1 = eps[i] ;
-      eps[i]=(c3d[i].get_oX()*k[0]+c3d[i].get_oY()*k[1]+c3d[i].get_oZ()*k[2])/Z0;
+      eps[i]=(c3d[i].oX*k[0]+c3d[i].oY*k[1]+c3d[i].oZ*k[2])/Z0;
       //seuil+=fabs(eps[i]-epsi_1);
     }
     if (npt==0)
@@ -172,21 +173,21 @@ vpPose::poseDementhonNonPlan(vpHomogeneousMatrix &cMo)
   cMo[0][0]=I[0];
   cMo[0][1]=I[1];
   cMo[0][2]=I[2];
-  cMo[0][3]=c3d[0].get_x()*2/(normI+normJ);
+  cMo[0][3]=c3d[0].x*2/(normI+normJ);
 
   cMo[1][0]=J[0];
   cMo[1][1]=J[1];
   cMo[1][2]=J[2];
-  cMo[1][3]=c3d[0].get_y()*2/(normI+normJ);
+  cMo[1][3]=c3d[0].y*2/(normI+normJ);
 
   cMo[2][0]=k[0];
   cMo[2][1]=k[1];
   cMo[2][2]=k[2];
   cMo[2][3]=Z0;
 
-  cMo[0][3] -= (p0.get_oX()*cMo[0][0]+p0.get_oY()*cMo[0][1]+p0.get_oZ()*cMo[0][2]);
-  cMo[1][3] -= (p0.get_oX()*cMo[1][0]+p0.get_oY()*cMo[1][1]+p0.get_oZ()*cMo[1][2]);
-  cMo[2][3] -= (p0.get_oX()*cMo[2][0]+p0.get_oY()*cMo[2][1]+p0.get_oZ()*cMo[2][2]);
+  cMo[0][3] -= (p0.oX*cMo[0][0]+p0.oY*cMo[0][1]+p0.oZ*cMo[0][2]);
+  cMo[1][3] -= (p0.oX*cMo[1][0]+p0.oY*cMo[1][1]+p0.oZ*cMo[1][2]);
+  cMo[2][3] -= (p0.oX*cMo[2][0]+p0.oY*cMo[2][1]+p0.oZ*cMo[2][2]);
 }
 
 
@@ -297,7 +298,7 @@ vpPose::calculArbreDementhon(vpMatrix &b, vpColVector &U,
   for(unsigned int i = 0; i < npt; i++)
   {
     double z ;
-    z = cMo[2][0]*c3d[i].get_oX()+cMo[2][1]*c3d[i].get_oY()+cMo[2][2]*c3d[i].get_oZ() + cMo[2][3];
+    z = cMo[2][0]*c3d[i].oX+cMo[2][1]*c3d[i].oY+cMo[2][2]*c3d[i].oZ + cMo[2][3];
     if (z <= 0.0) erreur = -1;
   }
 
@@ -311,14 +312,14 @@ vpPose::calculArbreDementhon(vpMatrix &b, vpColVector &U,
     unsigned int k=0;
     for(unsigned int i = 0; i < npt; i++)
     {
-      xi[k] = c3d[i].get_x();
-      yi[k] = c3d[i].get_y();
+      xi[k] = c3d[i].x;
+      yi[k] = c3d[i].y;
 
       if (k != 0)
       { // On ne prend pas le 1er point
-        eps[0][k] = (cMo[2][0]*c3d[i].get_oX() +
-          cMo[2][1]*c3d[i].get_oY() +
-          cMo[2][2]*c3d[i].get_oZ())/cMo[2][3];
+        eps[0][k] = (cMo[2][0]*c3d[i].oX +
+          cMo[2][1]*c3d[i].oY +
+          cMo[2][2]*c3d[i].oZ)/cMo[2][3];
       }
       k++;
     }
@@ -410,8 +411,8 @@ vpPose::calculArbreDementhon(vpMatrix &b, vpColVector &U,
         for(unsigned int i = 0; i < npt; i++)
         {
           if (k != 0) { // On ne prend pas le 1er point
-            eps[cpt][k] = (cMo1[2][0]*c3d[i].get_oX() + cMo1[2][1]*c3d[i].get_oY()
-              + cMo1[2][2]*c3d[i].get_oZ())/cMo1[2][3];
+            eps[cpt][k] = (cMo1[2][0]*c3d[i].oX + cMo1[2][1]*c3d[i].oY
+              + cMo1[2][2]*c3d[i].oZ)/cMo1[2][3];
           }
           k++;
         }
@@ -424,8 +425,8 @@ vpPose::calculArbreDementhon(vpMatrix &b, vpColVector &U,
         for(unsigned int i = 0; i < npt; i++)
         {
           if (k != 0) { // On ne prend pas le 1er point
-            eps[cpt][k] = (cMo2[2][0]*c3d[i].get_oX() + cMo2[2][1]*c3d[i].get_oY()
-              + cMo2[2][2]*c3d[i].get_oZ())/cMo2[2][3];
+            eps[cpt][k] = (cMo2[2][0]*c3d[i].oX + cMo2[2][1]*c3d[i].oY
+              + cMo2[2][2]*c3d[i].oZ)/cMo2[2][3];
           }
           k++;
         }
@@ -468,22 +469,23 @@ Dementhon in his PhD.
 void
 vpPose::poseDementhonPlan(vpHomogeneousMatrix &cMo)
 { 
+  updateCorrespondences() ;
 #if (DEBUG_LEVEL1)
   std::cout << "begin CCalculPose::PoseDementhonPlan()" << std::endl ;
 #endif
 
   unsigned int i,j,k ;
 
-  vpPoint p0 = listP.front() ;
+  Correspondence p0 = correspondences.front() ;
 
-  vpPoint P ;
+  Correspondence P ;
   c3d.clear();
-  for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+  for (std::vector<Correspondence>::const_iterator it = correspondences.begin(); it != correspondences.end(); ++it)
   {
     P = *it;
-    P.set_oX(P.get_oX()-p0.get_oX()) ;
-    P.set_oY(P.get_oY()-p0.get_oY()) ;
-    P.set_oZ(P.get_oZ()-p0.get_oZ()) ;
+    P.oX -= p0.oX ;
+    P.oY -= p0.oY ;
+    P.oZ -= p0.oZ ;
     c3d.push_back(P);
   }
 
@@ -501,9 +503,9 @@ vpPose::poseDementhonPlan(vpHomogeneousMatrix &cMo)
 
   for (i=1 ; i < npt ; i++)
   {
-    a[i-1][0]=c3d[i].get_oX();
-    a[i-1][1]=c3d[i].get_oY();
-    a[i-1][2]=c3d[i].get_oZ();
+    a[i-1][0]=c3d[i].oX;
+    a[i-1][1]=c3d[i].oY;
+    a[i-1][2]=c3d[i].oZ;
   }
 
   // calcul a^T a
@@ -597,8 +599,8 @@ vpPose::poseDementhonPlan(vpHomogeneousMatrix &cMo)
   //calcul de la premiere solution
   for (i = 0; i < npt; i++)
   {
-    xi[i] = c3d[i].get_x() ;
-    yi[i] = c3d[i].get_y() ;
+    xi[i] = c3d[i].x ;
+    yi[i] = c3d[i].y ;
   }
 
   vpColVector I0(3) ; I0 = 0 ;
@@ -661,9 +663,9 @@ vpPose::poseDementhonPlan(vpHomogeneousMatrix &cMo)
     if (s1<=s2) cMo = cMo1f ; else cMo = cMo2f ;
   }
 
-  cMo[0][3] -= p0.get_oX()*cMo[0][0]+p0.get_oY()*cMo[0][1]+p0.get_oZ()*cMo[0][2];
-  cMo[1][3] -= p0.get_oX()*cMo[1][0]+p0.get_oY()*cMo[1][1]+p0.get_oZ()*cMo[1][2];
-  cMo[2][3] -= p0.get_oX()*cMo[2][0]+p0.get_oY()*cMo[2][1]+p0.get_oZ()*cMo[2][2];
+  cMo[0][3] -= p0.oX*cMo[0][0]+p0.oY*cMo[0][1]+p0.oZ*cMo[0][2];
+  cMo[1][3] -= p0.oX*cMo[1][0]+p0.oY*cMo[1][1]+p0.oZ*cMo[1][2];
+  cMo[2][3] -= p0.oX*cMo[2][0]+p0.oY*cMo[2][1]+p0.oZ*cMo[2][2];
 
 #if (DEBUG_LEVEL1)
   std::cout << "end CCalculPose::PoseDementhonPlan()" << std::endl ;
@@ -691,14 +693,14 @@ double vpPose::computeResidualDementhon(const vpHomogeneousMatrix &cMo)
   for (unsigned int i =0 ; i < npt ; i++)
   {
 
-    double X = c3d[i].get_oX()*cMo[0][0]+c3d[i].get_oY()*cMo[0][1]+c3d[i].get_oZ()*cMo[0][2] + cMo[0][3];
-    double Y = c3d[i].get_oX()*cMo[1][0]+c3d[i].get_oY()*cMo[1][1]+c3d[i].get_oZ()*cMo[1][2] + cMo[1][3];
-    double Z = c3d[i].get_oX()*cMo[2][0]+c3d[i].get_oY()*cMo[2][1]+c3d[i].get_oZ()*cMo[2][2] + cMo[2][3];
+    double X = c3d[i].oX*cMo[0][0]+c3d[i].oY*cMo[0][1]+c3d[i].oZ*cMo[0][2] + cMo[0][3];
+    double Y = c3d[i].oX*cMo[1][0]+c3d[i].oY*cMo[1][1]+c3d[i].oZ*cMo[1][2] + cMo[1][3];
+    double Z = c3d[i].oX*cMo[2][0]+c3d[i].oY*cMo[2][1]+c3d[i].oZ*cMo[2][2] + cMo[2][3];
 
     double x = X/Z ;
     double y = Y/Z ;
 
-    residual_ += vpMath::sqr(x-c3d[i].get_x()) +  vpMath::sqr(y-c3d[i].get_y())  ;
+    residual_ += vpMath::sqr(x-c3d[i].x) +  vpMath::sqr(y-c3d[i].y)  ;
   }
   return residual_ ;
 }
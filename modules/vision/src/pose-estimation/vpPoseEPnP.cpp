@@ -0,0 +1,371 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Pose computation with the EPnP method.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpPoseEPnP.cpp
+  \brief Pose estimation from n points using the EPnP method.
+*/
+
+#include <cmath>
+#include <float.h>
+#include <vector>
+
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpMatrix.h>
+#include <visp3/vision/vpPose.h>
+#include <visp3/vision/vpPoseException.h>
+
+namespace {
+  //! Index of the products in the order b00, b01, b11, b02, b12, b22, b03, ...
+  inline unsigned int productIndex(const unsigned int k, const unsigned int l)
+  {
+    return l*(l+1)/2 + k;
+  }
+
+  //! Indexes of the singular values sorted by increasing value
+  std::vector<unsigned int> sortedIndex(const vpColVector &w)
+  {
+    std::vector<unsigned int> index(w.getRows());
+    for (unsigned int i = 0; i < index.size(); i++)
+      index[i] = i;
+    for (unsigned int i = 1; i < index.size(); i++) {
+      for (unsigned int j = i; j > 0 && w[index[j]] < w[index[j-1]]; j--)
+        std::swap(index[j], index[j-1]);
+    }
+    return index;
+  }
+
+  /*!
+    Rigid transformation that maps the points oP on the points cP in the
+    least squares sense.
+  */
+  void absoluteOrientation(const std::vector<vpPose::Correspondence> &oP, const std::vector<double> &cP,
+                           vpHomogeneousMatrix &cMo)
+  {
+    const unsigned int n = (unsigned int) oP.size();
+    double oc[3] = { 0, 0, 0 }, cc[3] = { 0, 0, 0 };
+    for (unsigned int i = 0; i < n; i++) {
+      oc[0] += oP[i].oX;
+      oc[1] += oP[i].oY;
+      oc[2] += oP[i].oZ;
+      for (unsigned int r = 0; r < 3; r++)
+        cc[r] += cP[3*i+r];
+    }
+    for (unsigned int r = 0; r < 3; r++) {
+      oc[r] /= n;
+      cc[r] /= n;
+    }
+
+    vpMatrix H(3, 3);
+    for (unsigned int i = 0; i < n; i++) {
+      const double o[3] = { oP[i].oX - oc[0], oP[i].oY - oc[1], oP[i].oZ - oc[2] };
+      for (unsigned int r = 0; r < 3; r++) {
+        const double c = cP[3*i+r] - cc[r];
+        for (unsigned int s = 0; s < 3; s++)
+          H[r][s] += c*o[s];
+      }
+    }
+
+    // H = U S V^T and R = U V^T, with the sign of the axis of the smallest
+    // singular value changed if R is a reflection
+    vpColVector w;
+    vpMatrix V;
+    H.svd(w, V);
+    const unsigned int smallest = sortedIndex(w)[0];
+    for (unsigned int iter = 0; iter < 2; iter++) {
+      for (unsigned int r = 0; r < 3; r++) {
+        for (unsigned int s = 0; s < 3; s++)
+          cMo[r][s] = H[r][0]*V[s][0] + H[r][1]*V[s][1] + H[r][2]*V[s][2];
+      }
+      const double det = cMo[0][0]*(cMo[1][1]*cMo[2][2] - cMo[1][2]*cMo[2][1])
+          - cMo[0][1]*(cMo[1][0]*cMo[2][2] - cMo[1][2]*cMo[2][0])
+          + cMo[0][2]*(cMo[1][0]*cMo[2][1] - cMo[1][1]*cMo[2][0]);
+      if (det > 0)
+        break;
+      for (unsigned int r = 0; r < 3; r++)
+        H[r][smallest] = -H[r][smallest];
+    }
+    for (unsigned int r = 0; r < 3; r++)
+      cMo[r][3] = cc[r] - (cMo[r][0]*oc[0] + cMo[r][1]*oc[1] + cMo[r][2]*oc[2]);
+  }
+}
+
+/*!
+  Compute the pose with the EPnP method \cite Lepetit09. The object points
+  are expressed as a weighted sum of four control points (three if the
+  object is planar), whose coordinates in the camera frame are given by a
+  linear system solved in O(n). The scale of the solution is estimated from
+  the distances between the control points and refined with Gauss-Newton
+  iterations.
+
+  This method does not need an initialization and is well suited to a large
+  number of points. At least 4 points are required.
+
+  \param cMo : Computed pose.
+*/
+void
+vpPose::poseEPnP(vpHomogeneousMatrix &cMo)
+{
+  updateCorrespondences() ;
+  const unsigned int n = (unsigned int) correspondences.size();
+  if (n < 4) {
+    throw(vpPoseException(vpPoseException::notEnoughPointError, "At least 4 points are required by EPnP")) ;
+  }
+
+  // Control points: centroid of the object points and principal axes
+  double c0[3] = { 0, 0, 0 };
+  for (std::vector<Correspondence>::const_iterator it = correspondences.begin(); it != correspondences.end(); ++it) {
+    c0[0] += it->oX;
+    c0[1] += it->oY;
+    c0[2] += it->oZ;
+  }
+  for (unsigned int r = 0; r < 3; r++)
+    c0[r] /= n;
+
+  vpMatrix C(3, 3);
+  for (std::vector<Correspondence>::const_iterator it = correspondences.begin(); it != correspondences.end(); ++it) {
+    const double d[3] = { it->oX - c0[0], it->oY - c0[1], it->oZ - c0[2] };
+    for (unsigned int r = 0; r < 3; r++) {
+      for (unsigned int s = 0; s < 3; s++)
+        C[r][s] += d[r]*d[s];
+    }
+  }
+  vpColVector eigenValues;
+  vpMatrix E;
+  C.svd(eigenValues, E);
+  std::vector<unsigned int> axes = sortedIndex(eigenValues);
+  std::swap(axes[0], axes[2]);
+  if (eigenValues[axes[0]] < DBL_EPSILON) {
+    throw(vpPoseException(vpPoseException::poseError, "The object points are all the same")) ;
+  }
+  // Planar object: the control points are in the plane of the points
+  const unsigned int nc = (eigenValues[axes[2]] < 1e-6*eigenValues[axes[0]]) ? 3 : 4;
+
+  double cw[4][3], scale[3];
+  for (unsigned int r = 0; r < 3; r++)
+    cw[0][r] = c0[r];
+  for (unsigned int k = 1; k < nc; k++) {
+    scale[k-1] = sqrt(eigenValues[axes[k-1]]/n);
+    for (unsigned int r = 0; r < 3; r++)
+      cw[k][r] = c0[r] + scale[k-1]*E[r][axes[k-1]];
+  }
+
+  // Barycentric coordinates of the points and normal equations M^T M of
+  // the projection of the points with the unknown control points
+  const unsigned int nu = 3*nc;
+  std::vector<double> alphas(n*nc);
+  vpMatrix MtM(nu, nu);
+  std::vector<double> m1(nu), m2(nu);
+  for (unsigned int i = 0; i < n; i++) {
+    const Correspondence &P = correspondences[i];
+    const double d[3] = { P.oX - c0[0], P.oY - c0[1], P.oZ - c0[2] };
+    double *a = &alphas[i*nc];
+    a[0] = 1.;
+    for (unsigned int k = 1; k < nc; k++) {
+      const unsigned int axis = axes[k-1];
+      a[k] = (d[0]*E[0][axis] + d[1]*E[1][axis] + d[2]*E[2][axis])/scale[k-1];
+      a[0] -= a[k];
+    }
+    for (unsigned int k = 0; k < nc; k++) {
+      m1[3*k] = a[k]; m1[3*k+1] = 0.;   m1[3*k+2] = -a[k]*P.x;
+      m2[3*k] = 0.;   m2[3*k+1] = a[k]; m2[3*k+2] = -a[k]*P.y;
+    }
+    for (unsigned int r = 0; r < nu; r++) {
+      double *row = MtM[r];
+      for (unsigned int s = r; s < nu; s++)
+        row[s] += m1[r]*m1[s] + m2[r]*m2[s];
+    }
+  }
+  for (unsigned int r = 0; r < nu; r++) {
+    for (unsigned int s = 0; s < r; s++)
+      MtM[r][s] = MtM[s][r];
+  }
+
+  // The control points are a combination of the nc eigenvectors of M^T M
+  // associated to the smallest eigenvalues
+  vpColVector w;
+  vpMatrix V;
+  MtM.svd(w, V);
+  const std::vector<unsigned int> kernel = sortedIndex(w);
+  const unsigned int N = nc;
+
+  // Distance constraints between the control points, linear in the
+  // products b_k b_l of the coefficients of the eigenvectors
+  const unsigned int nbPairs = nc*(nc-1)/2, nbProducts = N*(N+1)/2;
+  vpMatrix L(nbPairs, nbProducts);
+  vpColVector rho(nbPairs);
+  unsigned int p = 0;
+  for (unsigned int a = 0; a < nc; a++) {
+    for (unsigned int b = a+1; b < nc; b++, p++) {
+      double dv[4][3];
+      for (unsigned int k = 0; k < N; k++) {
+        for (unsigned int r = 0; r < 3; r++)
+          dv[k][r] = V[3*a+r][kernel[k]] - V[3*b+r][kernel[k]];
+      }
+      for (unsigned int l = 0; l < N; l++) {
+        for (unsigned int k = 0; k <= l; k++) {
+          const double dot = dv[k][0]*dv[l][0] + dv[k][1]*dv[l][1] + dv[k][2]*dv[l][2];
+          L[p][productIndex(k, l)] = (k == l) ? dot : 2.*dot;
+        }
+      }
+      rho[p] = vpMath::sqr(cw[a][0]-cw[b][0]) + vpMath::sqr(cw[a][1]-cw[b][1]) + vpMath::sqr(cw[a][2]-cw[b][2]);
+    }
+  }
+
+  double r_min = DBL_MAX;
+  std::vector<double> cP(3*n);
+  // Three approximations of the coefficients, with the products
+  // {b00, b01, ..., b0N}, {b00, b01, b11} and {b00, b01, b11, b02, b12}
+  for (unsigned int approx = 0; approx < (N == 4 ? 3u : 2u); approx++) {
+    std::vector<unsigned int> columns;
+    if (approx == 0) {
+      for (unsigned int l = 0; l < N; l++)
+        columns.push_back(productIndex(0, l));
+    }
+    else {
+      columns.push_back(productIndex(0, 0));
+      columns.push_back(productIndex(0, 1));
+      columns.push_back(productIndex(1, 1));
+      if (approx == 2) {
+        columns.push_back(productIndex(0, 2));
+        columns.push_back(productIndex(1, 2));
+      }
+    }
+    vpMatrix Ls(nbPairs, (unsigned int) columns.size());
+    for (unsigned int r = 0; r < nbPairs; r++) {
+      for (unsigned int c = 0; c < columns.size(); c++)
+        Ls[r][c] = L[r][columns[c]];
+    }
+    vpColVector B;
+    Ls.solveBySVD(rho, B);
+
+    double beta[4] = { 0, 0, 0, 0 };
+    if (approx == 0) {
+      beta[0] = sqrt(std::fabs(B[0]));
+      if (beta[0] < DBL_EPSILON)
+        continue;
+      const double sign = (B[0] < 0) ? -1. : 1.;
+      for (unsigned int l = 1; l < N; l++)
+        beta[l] = sign*B[l]/beta[0];
+    }
+    else {
+      if (B[0] < 0) {
+        beta[0] = sqrt(-B[0]);
+        beta[1] = (B[2] < 0) ? sqrt(-B[2]) : 0.;
+      }
+      else {
+        beta[0] = sqrt(B[0]);
+        beta[1] = (B[2] > 0) ? sqrt(B[2]) : 0.;
+      }
+      if (B[1] < 0)
+        beta[0] = -beta[0];
+      if (approx == 2 && std::fabs(beta[0]) > DBL_EPSILON)
+        beta[2] = B[3]/beta[0];
+    }
+
+    // Gauss-Newton refinement of the coefficients on the distance constraints
+    vpMatrix J(nbPairs, N);
+    vpColVector e(nbPairs), delta;
+    for (unsigned int iter = 0; iter < 5; iter++) {
+      for (unsigned int r = 0; r < nbPairs; r++) {
+        double f = 0.;
+        for (unsigned int m = 0; m < N; m++)
+          J[r][m] = 0.;
+        for (unsigned int l = 0; l < N; l++) {
+          for (unsigned int k = 0; k <= l; k++) {
+            const double Lkl = L[r][productIndex(k, l)];
+            f += Lkl*beta[k]*beta[l];
+            J[r][k] += Lkl*beta[l];
+            J[r][l] += Lkl*beta[k];
+          }
+        }
+        e[r] = rho[r] - f;
+      }
+      J.solveBySVD(e, delta);
+      for (unsigned int m = 0; m < N; m++)
+        beta[m] += delta[m];
+    }
+
+    // Control points and object points in the camera frame
+    double cc[4][3];
+    for (unsigned int k = 0; k < nc; k++) {
+      for (unsigned int r = 0; r < 3; r++) {
+        cc[k][r] = 0.;
+        for (unsigned int m = 0; m < N; m++)
+          cc[k][r] += beta[m]*V[3*k+r][kernel[m]];
+      }
+    }
+    for (unsigned int i = 0; i < n; i++) {
+      const double *a = &alphas[i*nc];
+      for (unsigned int r = 0; r < 3; r++) {
+        cP[3*i+r] = 0.;
+        for (unsigned int k = 0; k < nc; k++)
+          cP[3*i+r] += a[k]*cc[k][r];
+      }
+    }
+    // The points have to be in front of the camera
+    if (cP[2] < 0) {
+      for (unsigned int i = 0; i < 3*n; i++)
+        cP[i] = -cP[i];
+    }
+
+    vpHomogeneousMatrix cMo_approx;
+    absoluteOrientation(correspondences, cP, cMo_approx);
+    const double r = computeResidual(cMo_approx);
+    if (r < r_min) {
+      r_min = r;
+      cMo = cMo_approx;
+    }
+  }
+
+  // With 4 non coplanar points, the kernel is 4-dimensional and the
+  // approximations of the coefficients are not reliable: the solutions of the
+  // P3P on the three first points are also considered
+  if (n == 4 && nc == 4) {
+    vpHomogeneousMatrix solutions[4];
+    const unsigned int nbSolutions = computeP3P(correspondences[0], correspondences[1], correspondences[2], solutions);
+    for (unsigned int i = 0; i < nbSolutions; i++) {
+      const double r = computeResidual(solutions[i]);
+      if (r < r_min) {
+        r_min = r;
+        cMo = solutions[i];
+      }
+    }
+  }
+
+  if (r_min == DBL_MAX) {
+    throw(vpPoseException(vpPoseException::poseError, "EPnP failed to estimate the pose")) ;
+  }
+}
@@ -245,6 +245,7 @@ lagrange (vpMatrix &a, vpMatrix &b, vpColVector &x1, vpColVector &x2)
 void
 vpPose::poseLagrangePlan(vpHomogeneousMatrix &cMo, const int coplanar_plane_type)
 {
+  updateCorrespondences() ;
 
 #if (DEBUG_LEVEL1)
   std::cout << "begin vpPose::PoseLagrange(...) " << std::endl ;
@@ -260,64 +261,63 @@ vpPose::poseLagrangePlan(vpHomogeneousMatrix &cMo, const int coplanar_plane_type
 
     vpMatrix a(nl,3)  ;
     vpMatrix b(nl,6);
-    vpPoint P ;
     i=0 ;
 
     if (coplanar_plane_type == 1) { // plane ax=d
-      for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+      for (std::vector<Correspondence>::const_iterator it = correspondences.begin(); it != correspondences.end(); ++it)
       {
-        P = *it ;
-        a[k][0]   = -P.get_oY();
+        const Correspondence &P = *it ;
+        a[k][0]   = -P.oY;
         a[k][1]   = 0.0;
-        a[k][2]   = P.get_oY()*P.get_x();
+        a[k][2]   = P.oY*P.x;
 
         a[k+1][0] = 0.0;
-        a[k+1][1] = -P.get_oY();
-        a[k+1][2] = P.get_oY()*P.get_y();
+        a[k+1][1] = -P.oY;
+        a[k+1][2] = P.oY*P.y;
 
-        b[k][0]   = -P.get_oZ();
+        b[k][0]   = -P.oZ;
         b[k][1]   = 0.0;
-        b[k][2]   = P.get_oZ()*P.get_x();
+        b[k][2]   = P.oZ*P.x;
         b[k][3]   =  -1.0;
         b[k][4]   =  0.0;
-        b[k][5]   =  P.get_x();
+        b[k][5]   =  P.x;
 
         b[k+1][0] =  0.0;
-        b[k+1][1] = -P.get_oZ();
-        b[k+1][2] =  P.get_oZ()*P.get_y();
+        b[k+1][1] = -P.oZ;
+        b[k+1][2] =  P.oZ*P.y;
         b[k+1][3] =  0.0;
         b[k+1][4] = -1.0;
-        b[k+1][5] =  P.get_y();
+        b[k+1][5] =  P.y;
 
         k += 2;
       }
 
     }
     else if (coplanar_plane_type == 2) {  // plane by=d
-      for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+      for (std::vector<Correspondence>::const_iterator it = correspondences.begin(); it != correspondences.end(); ++it)
       {
-        P = *it ;
-        a[k][0]   = -P.get_oX();
+        const Correspondence &P = *it ;
+        a[k][0]   = -P.oX;
         a[k][1]   = 0.0;
-        a[k][2]   = P.get_oX()*P.get_x();
+        a[k][2]   = P.oX*P.x;
 
         a[k+1][0] = 0.0;
-        a[k+1][1] = -P.get_oX();
-        a[k+1][2] = P.get_oX()*P.get_y();
+        a[k+1][1] = -P.oX;
+        a[k+1][2] = P.oX*P.y;
 
-        b[k][0]   = -P.get_oZ();
+        b[k][0]   = -P.oZ;
         b[k][1]   = 0.0;
-        b[k][2]   = P.get_oZ()*P.get_x();
+        b[k][2]   = P.oZ*P.x;
         b[k][3]   =  -1.0;
         b[k][4]   =  0.0;
-        b[k][5]   =  P.get_x();
+        b[k][5]   =  P.x;
 
         b[k+1][0] =  0.0;
-        b[k+1][1] = -P.get_oZ();
-        b[k+1][2] =  P.get_oZ()*P.get_y();
+        b[k+1][1] = -P.oZ;
+        b[k+1][2] =  P.oZ*P.y;
         b[k+1][3] =  0.0;
         b[k+1][4] = -1.0;
-        b[k+1][5] =  P.get_y();
+        b[k+1][5] =  P.y;
 
         k += 2;
       }
@@ -325,30 +325,30 @@ vpPose::poseLagrangePlan(vpHomogeneousMatrix &cMo, const int coplanar_plane_type
     }
     else { // plane cz=d or any other
 
-      for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+      for (std::vector<Correspondence>::const_iterator it = correspondences.begin(); it != correspondences.end(); ++it)
       {
-        P = *it ;
-        a[k][0]   = -P.get_oX();
+        const Correspondence &P = *it ;
+        a[k][0]   = -P.oX;
         a[k][1]   = 0.0;
-        a[k][2]   = P.get_oX()*P.get_x();
+        a[k][2]   = P.oX*P.x;
 
         a[k+1][0] = 0.0;
-        a[k+1][1] = -P.get_oX();
-        a[k+1][2] = P.get_oX()*P.get_y();
+        a[k+1][1] = -P.oX;
+        a[k+1][2] = P.oX*P.y;
 
-        b[k][0]   = -P.get_oY();
+        b[k][0]   = -P.oY;
         b[k][1]   = 0.0;
-        b[k][2]   = P.get_oY()*P.get_x();
+        b[k][2]   = P.oY*P.x;
         b[k][3]   =  -1.0;
         b[k][4]   =  0.0;
-        b[k][5]   =  P.get_x();
+        b[k][5]   =  P.x;
 
         b[k+1][0] =  0.0;
-        b[k+1][1] = -P.get_oY();
-        b[k+1][2] =  P.get_oY()*P.get_y();
+        b[k+1][1] = -P.oY;
+        b[k+1][2] =  P.oY*P.y;
         b[k+1][3] =  0.0;
         b[k+1][4] = -1.0;
-        b[k+1][5] =  P.get_y();
+        b[k+1][5] =  P.y;
 
         k += 2;
       }
@@ -464,6 +464,7 @@ vpPose::poseLagrangePlan(vpHomogeneousMatrix &cMo, const int coplanar_plane_type
 void
 vpPose::poseLagrangeNonPlan(vpHomogeneousMatrix &cMo)
 {
+  updateCorrespondences() ;
 
 #if (DEBUG_LEVEL1)
   std::cout << "begin CPose::PoseLagrange(...) " << std::endl ;
@@ -479,42 +480,41 @@ vpPose::poseLagrangeNonPlan(vpHomogeneousMatrix &cMo)
     vpMatrix b(nl,9);
     b =0 ;
 
-    vpPoint P ;
     i=0 ;
-    for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+    for (std::vector<Correspondence>::const_iterator it = correspondences.begin(); it != correspondences.end(); ++it)
     {
-      P = *it;
-      a[k][0]   = -P.get_oX();
+      const Correspondence &P = *it;
+      a[k][0]   = -P.oX;
       a[k][1]   = 0.0;
-      a[k][2]   = P.get_oX()*P.get_x();
+      a[k][2]   = P.oX*P.x;
 
       a[k+1][0] = 0.0;
-      a[k+1][1] = -P.get_oX();
-      a[k+1][2] = P.get_oX()*P.get_y();
+      a[k+1][1] = -P.oX;
+      a[k+1][2] = P.oX*P.y;
 
-      b[k][0]   = -P.get_oY();
+      b[k][0]   = -P.oY;
       b[k][1]   = 0.0;
-      b[k][2]   = P.get_oY()*P.get_x();
+      b[k][2]   = P.oY*P.x;
 
-      b[k][3]   = -P.get_oZ();
+      b[k][3]   = -P.oZ;
       b[k][4]   =  0.0;
-      b[k][5]   =  P.get_oZ()*P.get_x();
+      b[k][5]   =  P.oZ*P.x;
 
       b[k][6]   =  -1.0;
       b[k][7]   =  0.0;
-      b[k][8]   =  P.get_x();
+      b[k][8]   =  P.x;
 
       b[k+1][0] =  0.0;
-      b[k+1][1] = -P.get_oY();
-      b[k+1][2] =  P.get_oY()*P.get_y();
+      b[k+1][1] = -P.oY;
+      b[k+1][2] =  P.oY*P.y;
 
       b[k+1][3] =  0.0;
-      b[k+1][4] = -P.get_oZ();
-      b[k+1][5] =  P.get_oZ()*P.get_y();
+      b[k+1][4] = -P.oZ;
+      b[k+1][5] =  P.oZ*P.y;
 
       b[k+1][6] =  0.0;
       b[k+1][7] = -1.0;
-      b[k+1][8] =  P.get_y();
+      b[k+1][8] =  P.y;
 
       k += 2;
     }
@@ -277,6 +277,7 @@ The approach has been proposed by D.G Lowe in 1992 paper \cite Lowe92a.
 void
 vpPose::poseLowe(vpHomogeneousMatrix & cMo)
 {
+  updateCorrespondences() ;
 #if (DEBUG_LEVEL1)
   std::cout << "begin CCalcuvpPose::PoseLowe(...) " << std::endl;
 #endif
@@ -309,16 +310,14 @@ vpPose::poseLowe(vpHomogeneousMatrix & cMo)
     sol[i+3] = u[i];
   }
 
-  vpPoint P ;
   unsigned int i_=0;
-  for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+  for (std::vector<Correspondence>::const_iterator it = correspondences.begin(); it != correspondences.end(); ++it)
   {
-    P = *it;
-    XI[i_] = P.get_x();//*cam.px + cam.xc ;
-    YI[i_] = P.get_y() ;//;*cam.py + cam.yc ;
-    XO[i_] = P.get_oX();
-    YO[i_] = P.get_oY();
-    ZO[i_] = P.get_oZ();
+    XI[i_] = it->x;//*cam.px + cam.xc ;
+    YI[i_] = it->y ;//;*cam.py + cam.yc ;
+    XO[i_] = it->oX;
+    YO[i_] = it->oY;
+    ZO[i_] = it->oZ;
     ++i_;
   }
   tst_lmder = lmder1 (&fcn, m, n, sol, f, &jac[0][0], ldfjac, tol, &info, ipvt, lwa, wa);
@@ -0,0 +1,326 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Pose computation from three points (P3P).
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpPoseP3P.cpp
+  \brief Pose estimation from three points using Grunert's solution.
+*/
+
+#include <cmath>
+#include <float.h>
+
+#include <visp3/core/vpMath.h>
+#include <visp3/vision/vpPose.h>
+#include <visp3/vision/vpPoseException.h>
+
+namespace {
+  //! Largest real root of x^3 + a x^2 + b x + c
+  double largestCubicRoot(const double a, const double b, const double c)
+  {
+    // Depressed cubic t^3 + p t + q with x = t - a/3
+    const double p = b - a*a/3.;
+    const double q = 2.*a*a*a/27. - a*b/3. + c;
+    const double delta = q*q/4. + p*p*p/27.;
+    double t;
+    if (delta > 0) {
+      const double sd = sqrt(delta);
+      t = vpMath::sign(-q/2. + sd) * pow(std::fabs(-q/2. + sd), 1./3.)
+          + vpMath::sign(-q/2. - sd) * pow(std::fabs(-q/2. - sd), 1./3.);
+    }
+    else {
+      // Three real roots, the largest one is given by k = 0
+      const double r = sqrt(-p/3.);
+      const double cosArg = (r > 0) ? std::max(-1., std::min(1., (3.*q)/(2.*p*r))) : 0.;
+      t = 2.*r*cos(acos(cosArg)/3.);
+    }
+    return t - a/3.;
+  }
+
+  /*!
+    Real roots of a4 x^4 + a3 x^3 + a2 x^2 + a1 x + a0 with Ferrari's method,
+    polished with Newton iterations. Return the number of roots.
+  */
+  unsigned int solveQuartic(const double a4, const double a3, const double a2, const double a1, const double a0,
+                            double roots[4])
+  {
+    if (std::fabs(a4) < DBL_EPSILON)
+      return 0;
+    const double b = a3/a4, c = a2/a4, d = a1/a4, e = a0/a4;
+
+    // Depressed quartic y^4 + p y^2 + q y + r with x = y - b/4
+    const double b2 = b*b;
+    const double p = c - 3.*b2/8.;
+    const double q = b2*b/8. - b*c/2. + d;
+    const double r = -3.*b2*b2/256. + b2*c/16. - b*d/4. + e;
+
+    unsigned int n = 0;
+    if (std::fabs(q) < 1e-14) {
+      // Biquadratic equation
+      const double delta = p*p - 4.*r;
+      if (delta >= 0) {
+        const double z[2] = { (-p + sqrt(delta))/2., (-p - sqrt(delta))/2. };
+        for (unsigned int i = 0; i < 2; i++) {
+          if (z[i] >= 0) {
+            roots[n++] = sqrt(z[i]) - b/4.;
+            roots[n++] = -sqrt(z[i]) - b/4.;
+          }
+        }
+      }
+    }
+    else {
+      // Positive root of the resolvent cubic m^3 + p m^2 + (p^2/4 - r) m - q^2/8
+      const double m = largestCubicRoot(p, p*p/4. - r, -q*q/8.);
+      if (m <= 0)
+        return 0;
+      const double s = sqrt(2.*m);
+      const double c1 = p/2. + m + q/(2.*s), c2 = p/2. + m - q/(2.*s);
+      double delta1 = s*s - 4.*c1, delta2 = s*s - 4.*c2;
+      // Keep the double roots lost in the rounding errors
+      const double tol = 1e-10*(s*s + 4.*std::fabs(c1) + 4.*std::fabs(c2));
+      if (delta1 < 0 && delta1 > -tol)
+        delta1 = 0;
+      if (delta2 < 0 && delta2 > -tol)
+        delta2 = 0;
+      if (delta1 >= 0) {
+        roots[n++] = (s + sqrt(delta1))/2. - b/4.;
+        roots[n++] = (s - sqrt(delta1))/2. - b/4.;
+      }
+      if (delta2 >= 0) {
+        roots[n++] = (-s + sqrt(delta2))/2. - b/4.;
+        roots[n++] = (-s - sqrt(delta2))/2. - b/4.;
+      }
+    }
+
+    for (unsigned int i = 0; i < n; i++) {
+      double x = roots[i];
+      for (unsigned int iter = 0; iter < 2; iter++) {
+        const double f = (((x + b)*x + c)*x + d)*x + e;
+        const double df = ((4.*x + 3.*b)*x + 2.*c)*x + d;
+        if (std::fabs(df) < DBL_EPSILON)
+          break;
+        x -= f/df;
+      }
+      roots[i] = x;
+    }
+    return n;
+  }
+
+  /*!
+    Newton iterations on the distances s of the points to the camera, that
+    satisfy the law of cosines in the three triangles formed by the camera
+    and two points. The accuracy lost when solving the quartic is recovered.
+  */
+  void refineDistances(const double cos_alpha, const double cos_beta, const double cos_gamma,
+                       const double a2, const double b2, const double c2, double s[3])
+  {
+    for (unsigned int iter = 0; iter < 2; iter++) {
+      const double f[3] = { s[1]*s[1] + s[2]*s[2] - 2.*s[1]*s[2]*cos_alpha - a2,
+                            s[0]*s[0] + s[2]*s[2] - 2.*s[0]*s[2]*cos_beta - b2,
+                            s[0]*s[0] + s[1]*s[1] - 2.*s[0]*s[1]*cos_gamma - c2 };
+      const double J[3][3] = { { 0., 2.*(s[1] - s[2]*cos_alpha), 2.*(s[2] - s[1]*cos_alpha) },
+                               { 2.*(s[0] - s[2]*cos_beta), 0., 2.*(s[2] - s[0]*cos_beta) },
+                               { 2.*(s[0] - s[1]*cos_gamma), 2.*(s[1] - s[0]*cos_gamma), 0. } };
+      const double det = J[0][0]*(J[1][1]*J[2][2] - J[1][2]*J[2][1]) - J[0][1]*(J[1][0]*J[2][2] - J[1][2]*J[2][0])
+          + J[0][2]*(J[1][0]*J[2][1] - J[1][1]*J[2][0]);
+      if (std::fabs(det) < DBL_EPSILON)
+        return;
+      // Cramer's rule
+      double ds[3];
+      for (unsigned int c = 0; c < 3; c++) {
+        double Jc[3][3];
+        for (unsigned int r = 0; r < 3; r++) {
+          for (unsigned int l = 0; l < 3; l++)
+            Jc[r][l] = (l == c) ? f[r] : J[r][l];
+        }
+        ds[c] = (Jc[0][0]*(Jc[1][1]*Jc[2][2] - Jc[1][2]*Jc[2][1]) - Jc[0][1]*(Jc[1][0]*Jc[2][2] - Jc[1][2]*Jc[2][0])
+            + Jc[0][2]*(Jc[1][0]*Jc[2][1] - Jc[1][1]*Jc[2][0]))/det;
+      }
+      for (unsigned int i = 0; i < 3; i++)
+        s[i] -= ds[i];
+    }
+  }
+
+  /*!
+    Orthonormal frame defined by a triangle: first axis along P1P2, third
+    axis normal to the triangle. The axes are stored in the columns of F.
+    Return false if the triangle is degenerate.
+  */
+  bool triangleFrame(const double P1[3], const double P2[3], const double P3[3], double F[3][3])
+  {
+    double e1[3] = { P2[0] - P1[0], P2[1] - P1[1], P2[2] - P1[2] };
+    const double u[3] = { P3[0] - P1[0], P3[1] - P1[1], P3[2] - P1[2] };
+    double e3[3] = { e1[1]*u[2] - e1[2]*u[1], e1[2]*u[0] - e1[0]*u[2], e1[0]*u[1] - e1[1]*u[0] };
+    const double n1 = sqrt(e1[0]*e1[0] + e1[1]*e1[1] + e1[2]*e1[2]);
+    const double n3 = sqrt(e3[0]*e3[0] + e3[1]*e3[1] + e3[2]*e3[2]);
+    if (n1 < DBL_EPSILON || n3 < DBL_EPSILON)
+      return false;
+    for (unsigned int i = 0; i < 3; i++) {
+      e1[i] /= n1;
+      e3[i] /= n3;
+    }
+    const double e2[3] = { e3[1]*e1[2] - e3[2]*e1[1], e3[2]*e1[0] - e3[0]*e1[2], e3[0]*e1[1] - e3[1]*e1[0] };
+    for (unsigned int i = 0; i < 3; i++) {
+      F[i][0] = e1[i];
+      F[i][1] = e2[i];
+      F[i][2] = e3[i];
+    }
+    return true;
+  }
+}
+
+/*!
+  Compute the poses that project three object points on their image
+  coordinates, using Grunert's solution \cite Haralick94: the distances of
+  the points to the camera are given by the real roots of a quartic
+  polynomial.
+
+  \param P1, P2, P3 : Three correspondences whose object points are not
+  collinear.
+  \param cMo : Array of at least 4 homogeneous matrices, in which the
+  solutions are written.
+  \return The number of solutions, between 0 and 4.
+*/
+unsigned int
+vpPose::computeP3P(const Correspondence &P1, const Correspondence &P2, const Correspondence &P3,
+                   vpHomogeneousMatrix cMo[4])
+{
+  const double oP[3][3] = { { P1.oX, P1.oY, P1.oZ }, { P2.oX, P2.oY, P2.oZ }, { P3.oX, P3.oY, P3.oZ } };
+  const double x[3][2] = { { P1.x, P1.y }, { P2.x, P2.y }, { P3.x, P3.y } };
+
+  // Unit vectors along the lines of sight
+  double j[3][3];
+  for (unsigned int i = 0; i < 3; i++) {
+    const double n = sqrt(x[i][0]*x[i][0] + x[i][1]*x[i][1] + 1.);
+    j[i][0] = x[i][0]/n;
+    j[i][1] = x[i][1]/n;
+    j[i][2] = 1./n;
+  }
+  const double cos_alpha = j[1][0]*j[2][0] + j[1][1]*j[2][1] + j[1][2]*j[2][2];
+  const double cos_beta  = j[0][0]*j[2][0] + j[0][1]*j[2][1] + j[0][2]*j[2][2];
+  const double cos_gamma = j[0][0]*j[1][0] + j[0][1]*j[1][1] + j[0][2]*j[1][2];
+
+  // Squared lengths of the sides of the triangle
+  const double a2 = vpMath::sqr(oP[1][0]-oP[2][0]) + vpMath::sqr(oP[1][1]-oP[2][1]) + vpMath::sqr(oP[1][2]-oP[2][2]);
+  const double b2 = vpMath::sqr(oP[0][0]-oP[2][0]) + vpMath::sqr(oP[0][1]-oP[2][1]) + vpMath::sqr(oP[0][2]-oP[2][2]);
+  const double c2 = vpMath::sqr(oP[0][0]-oP[1][0]) + vpMath::sqr(oP[0][1]-oP[1][1]) + vpMath::sqr(oP[0][2]-oP[1][2]);
+  if (b2 < DBL_EPSILON)
+    return 0;
+
+  double F_o[3][3];
+  if (! triangleFrame(oP[0], oP[1], oP[2], F_o))
+    return 0;
+
+  // With s2 = u s1 and s3 = v s1 the distances of the points to the camera,
+  // v is a root of A4 v^4 + A3 v^3 + A2 v^2 + A1 v + A0
+  const double amc = (a2 - c2)/b2, apc = (a2 + c2)/b2;
+  const double ca2 = cos_alpha*cos_alpha, cb2 = cos_beta*cos_beta, cg2 = cos_gamma*cos_gamma;
+  const double A4 = vpMath::sqr(amc - 1.) - 4.*c2/b2*ca2;
+  const double A3 = 4.*(amc*(1. - amc)*cos_beta - (1. - apc)*cos_alpha*cos_gamma + 2.*c2/b2*ca2*cos_beta);
+  const double A2 = 2.*(amc*amc - 1. + 2.*amc*amc*cb2 + 2.*(b2 - c2)/b2*ca2 - 4.*apc*cos_alpha*cos_beta*cos_gamma
+                        + 2.*(b2 - a2)/b2*cg2);
+  const double A1 = 4.*(-amc*(1. + amc)*cos_beta + 2.*a2/b2*cg2*cos_beta - (1. - apc)*cos_alpha*cos_gamma);
+  const double A0 = vpMath::sqr(1. + amc) - 4.*a2/b2*cg2;
+
+  double v[4];
+  const unsigned int nbRoots = solveQuartic(A4, A3, A2, A1, A0, v);
+
+  unsigned int nbSolutions = 0;
+  for (unsigned int k = 0; k < nbRoots; k++) {
+    const double den = 2.*(cos_gamma - v[k]*cos_alpha);
+    if (v[k] <= 0 || std::fabs(den) < DBL_EPSILON)
+      continue;
+    const double u = ((amc - 1.)*v[k]*v[k] - 2.*amc*cos_beta*v[k] + 1. + amc)/den;
+    const double d = 1. + v[k]*v[k] - 2.*v[k]*cos_beta;
+    if (u <= 0 || d <= 0)
+      continue;
+    const double s1 = sqrt(b2/d);
+    double s[3] = { s1, u*s1, v[k]*s1 };
+    refineDistances(cos_alpha, cos_beta, cos_gamma, a2, b2, c2, s);
+
+    // Points in the camera frame
+    double cP[3][3];
+    for (unsigned int i = 0; i < 3; i++) {
+      for (unsigned int l = 0; l < 3; l++)
+        cP[i][l] = s[i]*j[i][l];
+    }
+
+    // The rotation maps the frame of the object triangle on the one of the
+    // camera triangle
+    double F_c[3][3];
+    if (! triangleFrame(cP[0], cP[1], cP[2], F_c))
+      continue;
+    vpHomogeneousMatrix &M = cMo[nbSolutions];
+    for (unsigned int r = 0; r < 3; r++) {
+      for (unsigned int c = 0; c < 3; c++)
+        M[r][c] = F_c[r][0]*F_o[c][0] + F_c[r][1]*F_o[c][1] + F_c[r][2]*F_o[c][2];
+    }
+    for (unsigned int r = 0; r < 3; r++)
+      M[r][3] = cP[0][r] - (M[r][0]*oP[0][0] + M[r][1]*oP[0][1] + M[r][2]*oP[0][2]);
+    nbSolutions++;
+  }
+
+  return nbSolutions;
+}
+
+/*!
+  Compute the pose from the three first points with computeP3P(). The
+  solution that gives the smallest residual on all the points is kept, so at
+  least four points are needed to remove the ambiguity.
+
+  \param cMo : Computed pose.
+*/
+void
+vpPose::poseP3P(vpHomogeneousMatrix &cMo)
+{
+  updateCorrespondences() ;
+  if (correspondences.size() < 4) {
+    throw(vpPoseException(vpPoseException::notEnoughPointError,
+                          "At least 4 points are required to remove the ambiguity of the P3P")) ;
+  }
+
+  vpHomogeneousMatrix solutions[4];
+  const unsigned int nbSolutions = computeP3P(correspondences[0], correspondences[1], correspondences[2], solutions);
+
+  double r_min = DBL_MAX;
+  for (unsigned int i = 0; i < nbSolutions; i++) {
+    const double r = computeResidual(solutions[i]);
+    if (r < r_min) {
+      r_min = r;
+      cMo = solutions[i];
+    }
+  }
+  if (nbSolutions == 0 || r_min == DBL_MAX) {
+    throw(vpPoseException(vpPoseException::poseError, "No solution to the P3P")) ;
+  }
+}
@@ -53,7 +53,7 @@
 
 #include <visp3/vision/vpPose.h>
 #include <visp3/core/vpColVector.h>
-#include <visp3/core/vpRansac.h>
+#include <visp3/core/vpRansacEngine.h>
 #include <visp3/vision/vpPoseException.h>
 #include <visp3/core/vpMath.h>
 
@@ -61,82 +61,78 @@
 #  include <unordered_map>
 #endif
 
-#if defined(VISP_HAVE_OPENMP)
-#  include <omp.h>
-#endif
-
 #define eps 1e-6
 
 
 namespace {
-//For std::map<vpPoint>
+//For std::map<vpPose::Correspondence>
 struct ComparePointDuplicate {
-  bool operator()( const vpPoint &point1, const vpPoint &point2 ) const {
-    if (point1.oP[0] < point2.oP[0]) return true;
-    if (point1.oP[0] > point2.oP[0]) return false;
+  bool operator()( const vpPose::Correspondence &point1, const vpPose::Correspondence &point2 ) const {
+    if (point1.oX < point2.oX) return true;
+    if (point1.oX > point2.oX) return false;
 
-    if (point1.oP[1] < point2.oP[1]) return true;
-    if (point1.oP[1] > point2.oP[1]) return false;
+    if (point1.oY < point2.oY) return true;
+    if (point1.oY > point2.oY) return false;
 
-    if (point1.oP[2] < point2.oP[2]) return true;
-    if (point1.oP[2] > point2.oP[2]) return false;
+    if (point1.oZ < point2.oZ) return true;
+    if (point1.oZ > point2.oZ) return false;
 
-    if (point1.p[0] < point2.p[0]) return true;
-    if (point1.p[0] > point2.p[0]) return false;
+    if (point1.x < point2.x) return true;
+    if (point1.x > point2.x) return false;
 
-    if (point1.p[1] < point2.p[1]) return true;
-    if (point1.p[1] > point2.p[1]) return false;
+    if (point1.y < point2.y) return true;
+    if (point1.y > point2.y) return false;
 
     return false;
   }
 };
 
-//For std::map<vpPoint>
+//For std::map<vpPose::Correspondence>
 struct ComparePointAlmostDuplicate {
-  bool operator()( const vpPoint &point1, const vpPoint &point2 ) const {
-    if (point1.oP[0] - point2.oP[0] < -eps) return true;
-    if (point1.oP[0] - point2.oP[0] > eps) return false;
+  bool operator()( const vpPose::Correspondence &point1, const vpPose::Correspondence &point2 ) const {
+    if (point1.oX - point2.oX < -eps) return true;
+    if (point1.oX - point2.oX > eps) return false;
 
-    if (point1.oP[1] - point2.oP[1] < -eps) return true;
-    if (point1.oP[1] - point2.oP[1] > eps) return false;
+    if (point1.oY - point2.oY < -eps) return true;
+    if (point1.oY - point2.oY > eps) return false;
 
-    if (point1.oP[2] - point2.oP[2] < -eps) return true;
-    if (point1.oP[2] - point2.oP[2] > eps) return false;
+    if (point1.oZ - point2.oZ < -eps) return true;
+    if (point1.oZ - point2.oZ > eps) return false;
 
-    if (point1.p[0] - point2.p[0] < -eps) return true;
-    if (point1.p[0] - point2.p[0] > eps) return false;
+    if (point1.x - point2.x < -eps) return true;
+    if (point1.x - point2.x > eps) return false;
 
-    if (point1.p[1] - point2.p[1] < -eps) return true;
-    if (point1.p[1] - point2.p[1] > eps) return false;
+    if (point1.y - point2.y < -eps) return true;
+    if (point1.y - point2.y > eps) return false;
 
     return false;
   }
 };
 
-//For std::map<vpPoint>
+//For std::map<vpPose::Correspondence>
 struct CompareObjectPointDegenerate {
-  bool operator()( const vpPoint &point1, const vpPoint &point2 ) const {
-    if (point1.oP[0] - point2.oP[0] < -eps) return true;
-    if (point1.oP[0] - point2.oP[0] > eps) return false;
+  bool operator()( const vpPose::Correspondence &point1, const vpPose::Correspondence &point2 ) const {
+    if (point1.oX - point2.oX < -eps) return true;
+    if (point1.oX - point2.oX > eps) return false;
 
-    if (point1.oP[1] - point2.oP[1] < -eps) return true;
-    if (point1.oP[1] - point2.oP[1] > eps) return false;
+    if (point1.oY - point2.oY < -eps) return true;
+    if (point1.oY - point2.oY > eps) return false;
 
-    if (point1.oP[2] - point2.oP[2] < -eps) return true;
-    if (point1.oP[2] - point2.oP[2] > eps) return false;
+    if (point1.oZ - point2.oZ < -eps) return true;
+    if (point1.oZ - point2.oZ > eps) return false;
 
     return false;
   }
 };
 
-//For std::map<vpPoint>
+//For std::map<vpPose::Correspondence>
 struct CompareImagePointDegenerate {
-  bool operator()( const vpPoint &point1, const vpPoint &point2 ) const {
-    if (point1.p[0] - point2.p[0] < -eps) return true;
-    if (point1.p[0] - point2.p[0] > eps) return false;
+  bool operator()( const vpPose::Correspondence &point1, const vpPose::Correspondence &point2 ) const {
+    if (point1.x - point2.x < -eps) return true;
+    if (point1.x - point2.x > eps) return false;
 
-    if (point1.p[1] - point2.p[1] < -eps) return true;
-    if (point1.p[1] - point2.p[1] > eps) return false;
+    if (point1.y - point2.y < -eps) return true;
+    if (point1.y - point2.y > eps) return false;
 
     return false;
   }
@@ -144,662 +140,401 @@ struct CompareImagePointDegenerate {
 
 //std::find_if
 struct FindDegeneratePoint {
-  explicit FindDegeneratePoint( const vpPoint &pt ) : m_pt(pt) { }
-
-  bool operator() (const vpPoint &pt) {
-    return ( (std::fabs(m_pt.oP[0] - pt.oP[0]) < eps &&
-        std::fabs(m_pt.oP[1] - pt.oP[1]) < eps &&
-        std::fabs(m_pt.oP[2] - pt.oP[2]) < eps) ||
-        (std::fabs(m_pt.p[0] - pt.p[0]) < eps &&
-        std::fabs(m_pt.p[1] - pt.p[1]) < eps) );
+  explicit FindDegeneratePoint( const vpPose::Correspondence &pt ) : m_pt(pt) { }
+
+  bool operator() (const vpPose::Correspondence &pt) const {
+    return ( (std::fabs(m_pt.oX - pt.oX) < eps &&
+        std::fabs(m_pt.oY - pt.oY) < eps &&
+        std::fabs(m_pt.oZ - pt.oZ) < eps) ||
+        (std::fabs(m_pt.x - pt.x) < eps &&
+        std::fabs(m_pt.y - pt.y) < eps) );
   }
 
-  vpPoint m_pt;
+  vpPose::Correspondence m_pt;
 };
 
+/*!
+  Reprojection error of a correspondence for the pose cMo, computed as
+  vpPoint::track() does.
+*/
+inline double reprojectionError(const vpPose::Correspondence &P, const vpHomogeneousMatrix &cMo) {
+  double X = cMo[0][0]*P.oX + cMo[0][1]*P.oY + cMo[0][2]*P.oZ + cMo[0][3];
+  double Y = cMo[1][0]*P.oX + cMo[1][1]*P.oY + cMo[1][2]*P.oZ + cMo[1][3];
+  double Z = cMo[2][0]*P.oX + cMo[2][1]*P.oY + cMo[2][2]*P.oZ + cMo[2][3];
+  double d = 1/Z;
+
+  return sqrt(vpMath::sqr(X*d - P.x) + vpMath::sqr(Y*d - P.y));
+}
+
 #if defined (VISP_HAVE_CPP11_COMPATIBILITY)
-//For unordered_map<vpPoint>
+//For unordered_map<vpPose::Correspondence>
 struct HashDuplicate {
-  std::size_t operator()(const vpPoint &point) const {
+  std::size_t operator()(const vpPose::Correspondence &point) const {
     using std::size_t;
     using std::hash;
 
     size_t res = 17;
-    res = res * 31 + hash<double>()( point.oP[0] );
-    res = res * 31 + hash<double>()( point.oP[1] );
-    res = res * 31 + hash<double>()( point.oP[2] );
-    res = res * 31 + hash<double>()( point.p[0] );
-    res = res * 31 + hash<double>()( point.p[1] );
+    res = res * 31 + hash<double>()( point.oX );
+    res = res * 31 + hash<double>()( point.oY );
+    res = res * 31 + hash<double>()( point.oZ );
+    res = res * 31 + hash<double>()( point.x );
+    res = res * 31 + hash<double>()( point.y );
 
     return res;
   }
 };
 
-//For unordered_map<vpPoint>
+//For unordered_map<vpPose::Correspondence>
 struct ComparePointDuplicateUnorderedMap {
-  bool operator()( const vpPoint &point1, const vpPoint &point2 ) const {
+  bool operator()( const vpPose::Correspondence &point1, const vpPose::Correspondence &point2 ) const {
     return (
-          std::fabs(point1.oP[0] - point2.oP[0]) < std::numeric_limits<double>::epsilon() &&
-        std::fabs(point1.oP[1] - point2.oP[1]) < std::numeric_limits<double>::epsilon() &&
-        std::fabs(point1.oP[2] - point2.oP[2]) < std::numeric_limits<double>::epsilon() &&
-        std::fabs(point1.p[0] - point2.p[0]) < std::numeric_limits<double>::epsilon() &&
-        std::fabs(point1.p[1] - point2.p[1]) < std::numeric_limits<double>::epsilon()
+          std::fabs(point1.oX - point2.oX) < std::numeric_limits<double>::epsilon() &&
+        std::fabs(point1.oY - point2.oY) < std::numeric_limits<double>::epsilon() &&
+        std::fabs(point1.oZ - point2.oZ) < std::numeric_limits<double>::epsilon() &&
+        std::fabs(point1.x - point2.x) < std::numeric_limits<double>::epsilon() &&
+        std::fabs(point1.y - point2.y) < std::numeric_limits<double>::epsilon()
         );
   }
 };
-#endif
-}
-
-bool vpPose::RansacFunctor::poseRansacImpl() {
-  unsigned int size = (unsigned int) m_listOfUniquePoints.size();
-  int nbTrials = 0;
-  unsigned int nbMinRandom = 4;
-
-#if defined(_WIN32) && defined(_MSC_VER)
-  srand(m_initial_seed);
 #endif
 
-  vpPoint p; //Point used to project using the estimated pose
+/*!
+  Count the points whose reprojection error for the pose cMo is below the
+  threshold. The count stops as soon as it cannot exceed \e nbInliersToBeat,
+  since the hypothesis cannot be better than the best one.
 
-  bool foundSolution = false;
-  while (nbTrials < m_ransacMaxTrials && m_nbInliers < (unsigned int) m_ransacNbInlierConsensus)
+  \return The number of inliers, that is not greater than \e nbInliersToBeat
+  if the count was stopped.
+*/
+unsigned int countInliers(const std::vector<vpPose::Correspondence> &points, const vpHomogeneousMatrix &cMo,
+                          const double threshold, const bool checkDegeneratePoints, const unsigned int nbInliersToBeat,
+                          std::vector<unsigned int> &consensus, std::vector<vpPose::Correspondence> &inliers)
+{
+  consensus.clear();
+  inliers.clear();
+  const unsigned int size = (unsigned int) points.size();
+  unsigned int nbInliers = 0, nbOutliers = 0;
+  unsigned int iter = 0;
+  for (std::vector<vpPose::Correspondence>::const_iterator it = points.begin(); it != points.end(); ++it, iter++)
   {
-    //Hold the list of the index of the inliers (points in the consensus set)
-    std::vector<unsigned int> cur_consensus;
-    //Hold the list of the index of the outliers
-    std::vector<unsigned int> cur_outliers;
-    //Hold the list of the index of the points randomly picked
-    std::vector<unsigned int> cur_randoms;
-    //Hold the list of the current inliers points to avoid to add a degenerate point if the flag is set
-    std::vector<vpPoint> cur_inliers;
-
-    vpHomogeneousMatrix cMo_lagrange, cMo_dementhon;
-    //Use a temporary variable because if not, the cMo passed in parameters will be modified when
-    // we compute the pose for the minimal sample sets but if the pose is not correct when we pass
-    // a function pointer we do not want to modify the cMo passed in parameters
-    vpHomogeneousMatrix cMo_tmp;
-
-    //Vector of used points, initialized at false for all points
-    std::vector<bool> usedPt(size, false);
-
-    vpPose poseMin;
-    for(unsigned int i = 0; i < nbMinRandom;)
-    {
-      if((size_t) std::count(usedPt.begin(), usedPt.end(), true) == usedPt.size()) {
-        //All points was picked once, break otherwise we stay in an infinite loop
-        break;
-      }
-
-      //Pick a point randomly
-#if defined(_WIN32) && defined(_MSC_VER)
-      unsigned int r_ = (unsigned int) rand() % size;
-#else
-      unsigned int r_ = (unsigned int) rand_r(&m_initial_seed) % size;
-#endif
-
-      while(usedPt[r_]) {
-        //If already picked, pick another point randomly
-#if defined(_WIN32) && defined(_MSC_VER)
-        r_ = (unsigned int) rand() % size;
-#else
-        r_ = (unsigned int) rand_r(&m_initial_seed) % size;
-#endif
-      }
-      //Mark this point as already picked
-      usedPt[r_] = true;
-      vpPoint pt = m_listOfUniquePoints[r_];
-
-      bool degenerate = false;
-      if (m_checkDegeneratePoints) {
-        if ( std::find_if(poseMin.listOfPoints.begin(), poseMin.listOfPoints.end(), FindDegeneratePoint(pt)) !=  poseMin.listOfPoints.end()) {
-          degenerate = true;
+    double error = reprojectionError(*it, cMo);
+    bool inlier = false;
+    if(error < threshold) {
+      inlier = true;
+      if (checkDegeneratePoints) {
+        if ( std::find_if(inliers.begin(), inliers.end(), FindDegeneratePoint(*it)) != inliers.end() ) {
+          inlier = false;
         }
       }
-
-      if (!degenerate) {
-        poseMin.addPoint(pt);
-        cur_randoms.push_back(r_);
-        //Increment the number of points picked
-        i++;
-      }
-    }
-
-    if(poseMin.npt < nbMinRandom) {
-      nbTrials++;
-      continue;
     }
 
-    //Flags set if pose computation is OK
-    bool is_valid_lagrange = false;
-    bool is_valid_dementhon = false;
-
-    //Set maximum value for residuals
-    double r_lagrange = DBL_MAX;
-    double r_dementhon = DBL_MAX;
-
-    try {
-      poseMin.computePose(vpPose::LAGRANGE, cMo_lagrange);
-      r_lagrange = poseMin.computeResidual(cMo_lagrange);
-      is_valid_lagrange = true;
-    } catch(...) { }
-
-    try {
-      poseMin.computePose(vpPose::DEMENTHON, cMo_dementhon);
-      r_dementhon = poseMin.computeResidual(cMo_dementhon);
-      is_valid_dementhon = true;
-    } catch(...) { }
-
-    //If residual returned is not a number (NAN), set valid to false
-    if(vpMath::isNaN(r_lagrange)) {
-      is_valid_lagrange = false;
-      r_lagrange = DBL_MAX;
-    }
-
-    if(vpMath::isNaN(r_dementhon)) {
-      is_valid_dementhon = false;
-      r_dementhon = DBL_MAX;
-    }
-
-    //If at least one pose computation is OK,
-    //we can continue, otherwise pick another random set
-    if(is_valid_lagrange || is_valid_dementhon) {
-      double r;
-      if (r_lagrange < r_dementhon) {
-        r = r_lagrange;
-        cMo_tmp = cMo_lagrange;
-      }
-      else {
-        r = r_dementhon;
-        cMo_tmp = cMo_dementhon;
-      }
-      r = sqrt(r) / (double) nbMinRandom;
-
-      //Filter the pose using some criterion (orientation angles, translations, etc.)
-      bool isPoseValid = true;
-      if(m_func != NULL) {
-        isPoseValid = m_func(&cMo_tmp);
-        if(isPoseValid) {
-          m_cMo = cMo_tmp;
-        }
-      } else {
-        //No post filtering on pose, so copy cMo_temp to cMo
-        m_cMo = cMo_tmp;
+    if (inlier) {
+      // the point is considered as inlier if the error is below the threshold
+      nbInliers++;
+      consensus.push_back(iter);
+      if (checkDegeneratePoints) {
+        inliers.push_back(*it);
       }
-
-      if (isPoseValid && r < m_ransacThreshold)
-      {
-        unsigned int nbInliersCur = 0;
-        unsigned int iter = 0;
-        for (std::vector<vpPoint>::const_iterator it = m_listOfUniquePoints.begin(); it != m_listOfUniquePoints.end(); ++it, iter++)
-        {
-          p.setWorldCoordinates(it->get_oX(), it->get_oY(), it->get_oZ());
-          p.track(m_cMo);
-
-          double d = vpMath::sqr(p.get_x() - it->get_x()) + vpMath::sqr(p.get_y() - it->get_y());
-          double error = sqrt(d);
-          if(error < m_ransacThreshold) {
-            bool degenerate = false;
-            if (m_checkDegeneratePoints) {
-              if ( std::find_if(cur_inliers.begin(), cur_inliers.end(), FindDegeneratePoint(*it)) != cur_inliers.end() ) {
-                degenerate = true;
-              }
-            }
-
-            if (!degenerate) {
-              // the point is considered as inlier if the error is below the threshold
-              nbInliersCur++;
-              cur_consensus.push_back(iter);
-              cur_inliers.push_back(*it);
-            } else {
-              cur_outliers.push_back(iter);
-            }
-          }
-          else {
-            cur_outliers.push_back(iter);
-          }
-        }
-
-        if(nbInliersCur > m_nbInliers)
-        {
-          foundSolution = true;
-          m_best_consensus = cur_consensus;
-          m_nbInliers = nbInliersCur;
-        }
-
-        nbTrials++;
-
-        if(nbTrials >= m_ransacMaxTrials) {
-          foundSolution = true;
-        }
-      }
-      else {
-        nbTrials++;
-      }
-    } else {
-      nbTrials++;
+    }
+    else if (size - ++nbOutliers <= nbInliersToBeat) {
+      break;
     }
   }
-
-  return foundSolution;
+  return nbInliers;
 }
 
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
-vpThread::Return vpPose::poseRansacImplThread(vpThread::Args arg) {
-  vpPose::RansacFunctor* f = reinterpret_cast<vpPose::RansacFunctor*>(arg);
-  (*f)();
-  return 0;
-}
-#endif
-
 /*!
-  Compute the pose using the Ransac approach.
-
-  \param cMo : Computed pose
-  \param func : Pointer to a function that takes in parameter a vpHomogeneousMatrix
-  and returns true if the pose check is OK or false otherwise
-  \return True if we found at least 4 points with a reprojection error below ransacThreshold.
+  Remove the duplicate or degenerate correspondences according to the
+  RANSAC flags.
+
+  \param correspondences : All the correspondences.
+  \param ransacFlags : RANSAC flags, see vpPose::FILTERING_RANSAC_FLAGS.
+  \param listOfUniquePoints : Correspondences kept, filled only if a prefiltering is done.
+  \param mapOfUniquePointIndex : Index in \e correspondences of the points used by the RANSAC.
+  \return True if a prefiltering is done.
 */
-bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMatrix *))
+bool prefilterCorrespondences(const std::vector<vpPose::Correspondence> &correspondences, const int ransacFlags,
+                              std::vector<vpPose::Correspondence> &listOfUniquePoints,
+                              std::vector<size_t> &mapOfUniquePointIndex)
 {
-  //Check only for adding / removing problem
-  //Do not take into account problem with element modification here
-  if (listP.size() != listOfPoints.size()) {
-    std::cerr << "You should not modify vpPose::listP!" << std::endl;
-    listOfPoints = std::vector<vpPoint>(listP.begin(), listP.end());
-  }
-
-  ransacInliers.clear();
-  ransacInlierIndex.clear();
-
-  std::vector<unsigned int> best_consensus;
-  unsigned int nbInliers = 0;
-
-  vpHomogeneousMatrix cMo_lagrange, cMo_dementhon;
-
-  if (listOfPoints.size() < 4) {
-    //vpERROR_TRACE("Not enough point to compute the pose");
-    throw(vpPoseException(vpPoseException::notInitializedError,
-                          "Not enough point to compute the pose")) ;
-  }
-
-  std::vector<vpPoint> listOfUniquePoints;
-  std::map<size_t, size_t> mapOfUniquePointIndex;
-
-  //Get RANSAC flags
-  bool prefilterDuplicatePoints = (ransacFlags & PREFILTER_DUPLICATE_POINTS) != 0;
-  bool prefilterAlmostDuplicatePoints = (ransacFlags & PREFILTER_ALMOST_DUPLICATE_POINTS) != 0;
-  bool prefilterDegeneratePoints = (ransacFlags & PREFILTER_DEGENERATE_POINTS) != 0;
-  bool checkDegeneratePoints = (ransacFlags & CHECK_DEGENERATE_POINTS) != 0;
+  bool prefilterDuplicatePoints = (ransacFlags & vpPose::PREFILTER_DUPLICATE_POINTS) != 0;
+  bool prefilterAlmostDuplicatePoints = (ransacFlags & vpPose::PREFILTER_ALMOST_DUPLICATE_POINTS) != 0;
+  bool prefilterDegeneratePoints = (ransacFlags & vpPose::PREFILTER_DEGENERATE_POINTS) != 0;
 
   if (prefilterDuplicatePoints || prefilterAlmostDuplicatePoints || prefilterDegeneratePoints) {
     //Prefiltering
     if (prefilterDuplicatePoints) {
 #if defined (VISP_HAVE_CPP11_COMPATIBILITY)
-      std::unordered_map<vpPoint, size_t, HashDuplicate, ComparePointDuplicateUnorderedMap> filterMap;
-      size_t index_pt = 0;
-      for (std::vector<vpPoint>::const_iterator it_pt = listOfPoints.begin(); it_pt != listOfPoints.end(); ++it_pt, index_pt++) {
-        if (filterMap.find(*it_pt) == filterMap.end()) {
-          filterMap[*it_pt] = index_pt;
-
-          listOfUniquePoints.push_back(*it_pt);
-          mapOfUniquePointIndex[listOfUniquePoints.size()-1] = index_pt;
-        }
-      }
+      std::unordered_map<vpPose::Correspondence, size_t, HashDuplicate, ComparePointDuplicateUnorderedMap> filterMap;
 #else
-      std::map<vpPoint, size_t, ComparePointDuplicate> filterMap;
+      std::map<vpPose::Correspondence, size_t, ComparePointDuplicate> filterMap;
+#endif
       size_t index_pt = 0;
-      for (std::vector<vpPoint>::const_iterator it_pt = listOfPoints.begin(); it_pt != listOfPoints.end(); ++it_pt, index_pt++) {
+      for (std::vector<vpPose::Correspondence>::const_iterator it_pt = correspondences.begin(); it_pt != correspondences.end(); ++it_pt, index_pt++) {
         if (filterMap.find(*it_pt) == filterMap.end()) {
           filterMap[*it_pt] = index_pt;
 
           listOfUniquePoints.push_back(*it_pt);
-          mapOfUniquePointIndex[listOfUniquePoints.size()-1] = index_pt;
+          mapOfUniquePointIndex.push_back(index_pt);
         }
       }
-#endif
     } else if (prefilterAlmostDuplicatePoints) {
-      std::map<vpPoint, size_t, ComparePointAlmostDuplicate> filterMap;
+      std::map<vpPose::Correspondence, size_t, ComparePointAlmostDuplicate> filterMap;
       size_t index_pt = 0;
-      for (std::vector<vpPoint>::const_iterator it_pt = listOfPoints.begin(); it_pt != listOfPoints.end(); ++it_pt, index_pt++) {
+      for (std::vector<vpPose::Correspondence>::const_iterator it_pt = correspondences.begin(); it_pt != correspondences.end(); ++it_pt, index_pt++) {
         if (filterMap.find(*it_pt) == filterMap.end()) {
           filterMap[*it_pt] = index_pt;
 
           listOfUniquePoints.push_back(*it_pt);
-          mapOfUniquePointIndex[listOfUniquePoints.size()-1] = index_pt;
+          mapOfUniquePointIndex.push_back(index_pt);
         }
       }
     } else {
       //Remove other degenerate object points
-      std::map<vpPoint, size_t, CompareObjectPointDegenerate> filterObjectPointMap;
+      std::map<vpPose::Correspondence, size_t, CompareObjectPointDegenerate> filterObjectPointMap;
       size_t index_pt = 0;
-      for (std::vector<vpPoint>::const_iterator it_pt = listOfPoints.begin(); it_pt != listOfPoints.end(); ++it_pt, index_pt++) {
+      for (std::vector<vpPose::Correspondence>::const_iterator it_pt = correspondences.begin(); it_pt != correspondences.end(); ++it_pt, index_pt++) {
         if (filterObjectPointMap.find(*it_pt) == filterObjectPointMap.end()) {
           filterObjectPointMap[*it_pt] = index_pt;
         }
       }
 
-      std::map<vpPoint, size_t, CompareImagePointDegenerate> filterImagePointMap;
-      for (std::map<vpPoint, size_t>::const_iterator it = filterObjectPointMap.begin(); it != filterObjectPointMap.end(); ++it) {
+      std::map<vpPose::Correspondence, size_t, CompareImagePointDegenerate> filterImagePointMap;
+      for (std::map<vpPose::Correspondence, size_t, CompareObjectPointDegenerate>::const_iterator it = filterObjectPointMap.begin(); it != filterObjectPointMap.end(); ++it) {
         if (filterImagePointMap.find(it->first) == filterImagePointMap.end()) {
           filterImagePointMap[it->first] = it->second;
 
           listOfUniquePoints.push_back(it->first);
-          mapOfUniquePointIndex[listOfUniquePoints.size()-1] = it->second;
+          mapOfUniquePointIndex.push_back(it->second);
         }
       }
     }
-  } else {
-    //No prefiltering
-    listOfUniquePoints = listOfPoints;
-
-    size_t index_pt = 0;
-    for (std::vector<vpPoint>::const_iterator it_pt = listOfPoints.begin(); it_pt != listOfPoints.end(); ++it_pt, index_pt++) {
-      mapOfUniquePointIndex[index_pt] = index_pt;
-    }
+    return true;
   }
 
-  unsigned int size = (unsigned int) listOfUniquePoints.size();
-  if (size < 4) {
-    throw(vpPoseException(vpPoseException::notInitializedError, "Not enough point to compute the pose")) ;
+  //No prefiltering
+  mapOfUniquePointIndex.resize(correspondences.size());
+  for (size_t index_pt = 0; index_pt < correspondences.size(); index_pt++) {
+    mapOfUniquePointIndex[index_pt] = index_pt;
   }
+  return false;
+}
+}
 
+/*!
+  Estimation of the pose from the correspondences, solved by vpRansacEngine.
+  A model is the 3x4 upper part of cMo stored by rows, and the error of a
+  correspondence is its reprojection error.
+*/
+class vpPose::RansacProblem : public vpRansacEngine::Problem {
+public:
+  RansacProblem(const std::vector<Correspondence> &points, const double threshold, const bool checkDegeneratePoints,
+                bool (*func)(vpHomogeneousMatrix *))
+    : m_points(points), m_threshold(threshold), m_checkDegeneratePoints(checkDegeneratePoints), m_func(func) {
+  }
 
-  bool executeParallelVersion = useParallelRansac;
-
-#if defined (VISP_HAVE_PTHREAD) || (defined (_WIN32) && !defined(WINRT_8_0))
-#  define VP_THREAD_OK
-  int nbThreads = 1;
-#endif
+  unsigned int getNbData() const { return (unsigned int) m_points.size(); }
+  unsigned int getSampleSize() const { return 4; }
 
-  if (executeParallelVersion) {
-#if !defined (VP_THREAD_OK) && !defined (VISP_HAVE_OPENMP)
-    executeParallelVersion = false;
-    std::cerr << "Pthread or WIN32 API or OpenMP is needed to use the parallel RANSAC version." << std::endl;
-#elif !defined (VP_THREAD_OK)
-    //Use OpenMP
-#define PARALLEL_RANSAC_OPEN_MP
-#elif !defined (VISP_HAVE_OPENMP)
-    if(nbParallelRansacThreads <= 0) {
-      //Cannot get the number of CPU threads so use the sequential mode
-      executeParallelVersion = false;
-      std::cerr << "OpenMP is needed to get the number of CPU threads so use the sequential mode instead." << std::endl;
-    } else {
-      nbThreads = nbParallelRansacThreads;
-      if (nbThreads == 1) {
-        executeParallelVersion = false;
-      }
-    }
-#elif defined (VP_THREAD_OK) && defined (VISP_HAVE_OPENMP)
-    if (nbParallelRansacThreads <= 0) {
-      //Use OpenMP to get the number of CPU threads
-      nbThreads = omp_get_max_threads();
-      if(nbThreads <= 1) {
-        nbThreads = 1;
-        executeParallelVersion = false;
+  bool isDegenerate(const unsigned int *sample) const {
+    if (m_checkDegeneratePoints) {
+      for (unsigned int i = 1; i < 4; i++) {
+        for (unsigned int j = 0; j < i; j++) {
+          if (FindDegeneratePoint(m_points[sample[i]])(m_points[sample[j]])) {
+            return true;
+          }
+        }
       }
     }
-#endif
+    return false;
   }
 
-  bool foundSolution = false;
-
-  if(executeParallelVersion) {
-#if defined (PARALLEL_RANSAC_OPEN_MP)
-    //List of points picked randomly (minimal sample set, MSS)
-    //std::vector<unsigned int> best_randoms; // never used
+  //The pose of the sample is the one of the Lagrange and Dementhon methods with the lowest residual
+  unsigned int computeModels(const unsigned int *sample, std::vector<vpColVector> &models) const {
+    vpPose poseMin;
+    for (unsigned int i = 0; i < 4; i++) {
+      poseMin.correspondences.push_back(m_points[sample[i]]);
+    }
+    poseMin.npt = 4;
+    poseMin.correspondencesOnly = true;
 
-    //Section of code run in parallel
-    //All variables declared before the parallel keyword are shared between the team of threads (if private keyword is not used)
-    //Code in parallel section are duplicated between the team of threads
-#pragma omp parallel
-    {
-#if defined(VISP_HAVE_OPENMP)
-      //Set different seeds for each thread in the team, rand() is not thread safe
-      unsigned int initial_seed = (unsigned int) omp_get_thread_num(); //same seed each time
-      //(unsigned int) (int(time(NULL)) ^ omp_get_thread_num());
-      if(omp_get_num_threads() == 1) {
-        initial_seed = 0; //Same seed at each run
-      }
-#else
-      unsigned int initial_seed = 0;
-#endif
+    vpHomogeneousMatrix cMo_lagrange, cMo_dementhon;
+    double r_lagrange = DBL_MAX;
+    double r_dementhon = DBL_MAX;
+    try {
+      poseMin.computePose(vpPose::LAGRANGE, cMo_lagrange);
+      r_lagrange = poseMin.computeResidual(cMo_lagrange);
+    } catch(...) { }
 
-#if defined(_WIN32) && defined(_MSC_VER)
-      srand(initial_seed);
-#endif
+    try {
+      poseMin.computePose(vpPose::DEMENTHON, cMo_dementhon);
+      r_dementhon = poseMin.computeResidual(cMo_dementhon);
+    } catch(...) { }
 
-      unsigned int nbMinRandom = 4;
+    //If residual returned is not a number (NAN), the pose is not valid
+    if(vpMath::isNaN(r_lagrange)) {
+      r_lagrange = DBL_MAX;
+    }
+    if(vpMath::isNaN(r_dementhon)) {
+      r_dementhon = DBL_MAX;
+    }
+    if (r_lagrange == DBL_MAX && r_dementhon == DBL_MAX) {
+      return 0;
+    }
 
-      //Numbers of points in the best consensus set
-      unsigned int nb_best_inliers = 0;
+    vpHomogeneousMatrix cMo = r_lagrange < r_dementhon ? cMo_lagrange : cMo_dementhon;
+    double r = sqrt(std::min(r_lagrange, r_dementhon)) / 4.;
 
-      //True if we found a consensus set with a size > ransacNbInlierConsensus
-      bool foundSolutionWithConsensus = false;
+    //Filter the pose using some criterion (orientation angles, translations, etc.)
+    if ((m_func != NULL && !m_func(&cMo)) || r >= m_threshold) {
+      return 0;
+    }
+    models.push_back(toModel(cMo));
+    return 1;
+  }
 
-      vpPoint p; //Point used to project using the estimated pose
+  void computeErrors(const vpColVector &model, const unsigned int begin, const unsigned int end,
+                     double *errors) const {
+    const double *m = model.data;
+    for (unsigned int i = begin; i < end; i++) {
+      const Correspondence &P = m_points[i];
+      const double X = m[0]*P.oX + m[1]*P.oY + m[2]*P.oZ + m[3];
+      const double Y = m[4]*P.oX + m[5]*P.oY + m[6]*P.oZ + m[7];
+      const double Z = m[8]*P.oX + m[9]*P.oY + m[10]*P.oZ + m[11];
+      const double d = 1/Z;
+      errors[i - begin] = sqrt(vpMath::sqr(X*d - P.x) + vpMath::sqr(Y*d - P.y));
+    }
+  }
 
-#pragma omp for
-      for(int nbTrials = 0; nbTrials < ransacMaxTrials; nbTrials++) {
-        //Flag to check if a solution has been founded, used to "cancel" the threads
-        if(!foundSolutionWithConsensus) {
-          //Hold the list of the index of the inliers (points in the consensus set)
-          std::vector<unsigned int> cur_consensus;
-          //Hold the list of the index of the outliers
-          std::vector<unsigned int> cur_outliers;
-          //Hold the list of the index of the points randomly picked
-          std::vector<unsigned int> cur_randoms;
-          //Hold the list of the current inliers points to avoid to add a degenerate point if the flag is set
-          std::vector<vpPoint> cur_inliers;
+  //A point degenerate with a previous inlier is not an inlier
+  unsigned int computeConsensus(const vpColVector &model, const double threshold,
+                                const unsigned int nbInliersToBeat, std::vector<unsigned int> &consensus,
+                                std::vector<double> &errors) const {
+    if (!m_checkDegeneratePoints) {
+      return vpRansacEngine::Problem::computeConsensus(model, threshold, nbInliersToBeat, consensus, errors);
+    }
+    std::vector<Correspondence> inliers;
+    return countInliers(m_points, toPose(model), threshold, true, nbInliersToBeat, consensus, inliers);
+  }
 
-          vpHomogeneousMatrix cMo_lagrange, cMo_dementhon;
-          vpHomogeneousMatrix cMo_tmp;
+  //Local optimization with the EPnP method
+  bool refineModel(const std::vector<unsigned int> &inliers, vpColVector &model) const {
+    vpPose pose;
+    pose.correspondences.reserve(inliers.size());
+    for (size_t i = 0; i < inliers.size(); i++) {
+      pose.correspondences.push_back(m_points[inliers[i]]);
+    }
+    pose.npt = (unsigned int) pose.correspondences.size();
+    pose.correspondencesOnly = true;
 
-          //Vector of used points, initialized at false for all points
-          std::vector<bool> usedPt(size, false);
+    vpHomogeneousMatrix cMo;
+    try {
+      pose.poseEPnP(cMo);
+    } catch(...) {
+      return false;
+    }
+    if (m_func != NULL && !m_func(&cMo)) {
+      return false;
+    }
+    model = toModel(cMo);
+    return true;
+  }
 
-          vpPose poseMin;
+  static vpColVector toModel(const vpHomogeneousMatrix &cMo) {
+    vpColVector model(12);
+    for (unsigned int i = 0; i < 3; i++) {
+      for (unsigned int j = 0; j < 4; j++) {
+        model[4*i + j] = cMo[i][j];
+      }
+    }
+    return model;
+  }
 
-          for(unsigned int i = 0; i < nbMinRandom;) {
-            if((size_t) std::count(usedPt.begin(), usedPt.end(), true) == usedPt.size()) {
-              //All points was picked once, break otherwise we stay in an infinite loop
-              break;
-            }
+  static vpHomogeneousMatrix toPose(const vpColVector &model) {
+    vpHomogeneousMatrix cMo;
+    for (unsigned int i = 0; i < 3; i++) {
+      for (unsigned int j = 0; j < 4; j++) {
+        cMo[i][j] = model[4*i + j];
+      }
+    }
+    return cMo;
+  }
 
-            //Pick a point randomly
-#if defined(_WIN32) && defined(_MSC_VER)
-            unsigned int r_ = (unsigned int) rand() % size;
-#else
-            unsigned int r_ = (unsigned int) rand_r(&initial_seed) % size;
-#endif
+private:
+  const std::vector<Correspondence> &m_points;
+  const double m_threshold;
+  const bool m_checkDegeneratePoints;
+  bool (*m_func)(vpHomogeneousMatrix *);
+};
 
-            while(usedPt[r_]) {
-              //If already picked, pick another point randomly
-#if defined(_WIN32) && defined(_MSC_VER)
-              r_ = (unsigned int) rand() % size;
-#else
-              r_ = (unsigned int) rand_r(&initial_seed) % size;
-#endif
-            }
-            //Mark this point as already picked
-            usedPt[r_] = true;
-            vpPoint pt = listOfUniquePoints[r_];
-
-            bool degenerate = false;
-            if (checkDegeneratePoints) {
-              if ( std::find_if(poseMin.listOfPoints.begin(), poseMin.listOfPoints.end(), FindDegeneratePoint(pt)) !=  poseMin.listOfPoints.end()) {
-                degenerate = true;
-              }
-            }
+/*!
+  Compute the pose using the Ransac approach.
 
-            if (!degenerate) {
-              poseMin.addPoint(pt);
-              cur_randoms.push_back(r_);
-              //Increment the number of points picked
-              i++;
-            }
-          }
+  The hypotheses are computed from samples of 4 points with the Lagrange and
+  Dementhon methods, the one with the lowest residual being kept, and
+  evaluated by vpRansacEngine. The best hypotheses are refined with the EPnP
+  method from their inliers, and the search stops when the number of inliers
+  given by setRansacNbInliersToReachConsensus() is reached, when a sample
+  without outlier has been drawn with a probability of 0.99, or after
+  setRansacMaxTrials() trials. With the CHECK_DEGENERATE_POINTS flag, the
+  samples with degenerate points are drawn again without counting a trial,
+  and the search stops after 1000 consecutive degenerate samples. With
+  setUseParallelRansac(), the hypotheses are evaluated by
+  setNbParallelRansacThreads() threads, giving the same pose as the
+  sequential version.
 
-          if(poseMin.npt >= nbMinRandom) {
-            //Flags set if pose computation is OK
-            bool is_valid_lagrange = false;
-            bool is_valid_dementhon = false;
-
-            //Set maximum value for residuals
-            double r = DBL_MAX;
-            double r_lagrange = DBL_MAX;
-            double r_dementhon = DBL_MAX;
-
-            try {
-              poseMin.computePose(vpPose::LAGRANGE, cMo_lagrange);
-              r_lagrange = poseMin.computeResidual(cMo_lagrange);
-              is_valid_lagrange = true;
-            } catch(...) { }
-
-            try {
-              poseMin.computePose(vpPose::DEMENTHON, cMo_dementhon);
-              r_dementhon = poseMin.computeResidual(cMo_dementhon);
-              is_valid_dementhon = true;
-            } catch(...) { }
-
-            //If residual returned is not a number (NAN), set valid to false
-            if(vpMath::isNaN(r_lagrange)) {
-              is_valid_lagrange = false;
-              r_lagrange = DBL_MAX;
-            }
+  \param cMo : Computed pose
+  \param func : Pointer to a function that takes in parameter a vpHomogeneousMatrix
+  and returns true if the pose check is OK or false otherwise
+  \return True if we found at least 4 points with a reprojection error below ransacThreshold.
+*/
+bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMatrix *))
+{
+  updateCorrespondences();
 
-            if(vpMath::isNaN(r_dementhon)) {
-              is_valid_dementhon = false;
-              r_dementhon = DBL_MAX;
-            }
+  ransacInliers.clear();
+  ransacInlierIndex.clear();
 
-            //If at least one pose computation is OK,
-            //we can continue, otherwise pick another random set
-            if(is_valid_lagrange || is_valid_dementhon) {
-              if (r_lagrange < r_dementhon) {
-                r = r_lagrange;
-                cMo_tmp = cMo_lagrange;
-              }
-              else {
-                r = r_dementhon;
-                cMo_tmp = cMo_dementhon;
-              }
-              r = sqrt(r) / (double) nbMinRandom;
+  std::vector<unsigned int> best_consensus;
+  unsigned int nbInliers = 0;
 
-              //Filter the pose using some criterion (orientation angles, translations, etc.)
-              bool isPoseValid = true;
-              if(func != NULL) {
-                isPoseValid = func(&cMo_tmp);
-              }
+  vpHomogeneousMatrix cMo_lagrange, cMo_dementhon;
 
-              if (isPoseValid && r < ransacThreshold) {
-                unsigned int nbInliersCur = 0;
-                unsigned int iter = 0;
-                for (std::vector<vpPoint>::const_iterator it = listOfUniquePoints.begin(); it != listOfUniquePoints.end(); ++it, iter++) {
-                  p.setWorldCoordinates(it->get_oX(), it->get_oY(), it->get_oZ());
-                  p.track(cMo_tmp);
-
-                  double d = vpMath::sqr(p.get_x() - it->get_x()) + vpMath::sqr(p.get_y() - it->get_y()) ;
-                  double error = sqrt(d) ;
-                  if(error < ransacThreshold) {
-                    bool degenerate = false;
-                    if (checkDegeneratePoints) {
-                      if ( std::find_if(cur_inliers.begin(), cur_inliers.end(), FindDegeneratePoint(*it)) != cur_inliers.end() ) {
-                        degenerate = true;
-                      }
-                    }
-
-                    if (!degenerate) {
-                      // the point is considered as inlier if the error is below the threshold
-                      nbInliersCur++;
-                      cur_consensus.push_back(iter);
-                      cur_inliers.push_back(*it);
-                    } else {
-                      cur_outliers.push_back(iter);
-                    }
-                  } else {
-                    cur_outliers.push_back(iter);
-                  }
-                }
-
-#pragma omp critical (update_best_consensus_set)
-                {
-                  if(nbInliersCur > nb_best_inliers) {
-                    foundSolution = true;
-                    best_consensus = cur_consensus;
-                    //best_randoms = cur_randoms; // never used
-                    nb_best_inliers = nbInliersCur;
-
-                    if(nbInliersCur >= ransacNbInlierConsensus) {
-                      foundSolutionWithConsensus = true;
-                    }
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
+  if (correspondences.size() < 4) {
+    //vpERROR_TRACE("Not enough point to compute the pose");
+    throw(vpPoseException(vpPoseException::notInitializedError,
+                          "Not enough point to compute the pose")) ;
+  }
 
-      nbInliers = best_consensus.size();
-    }
-#elif defined(VP_THREAD_OK)
-    std::vector<vpThread *> threads((size_t) nbThreads);
-    std::vector<RansacFunctor> ransac_func((size_t) nbThreads);
-
-    int splitTrials = ransacMaxTrials / nbThreads;
-    for(size_t i = 0; i < (size_t) nbThreads; i++) {
-      unsigned int initial_seed = (unsigned int) i; //((unsigned int) time(NULL) ^ i);
-      if(i < (size_t) nbThreads-1) {
-        ransac_func[i] = RansacFunctor(cMo, ransacNbInlierConsensus, splitTrials, ransacThreshold,
-                                       initial_seed, checkDegeneratePoints, listOfUniquePoints, func);
-      } else {
-        int maxTrialsRemainder = ransacMaxTrials - splitTrials * (nbThreads-1);
-        ransac_func[i] = RansacFunctor(cMo, ransacNbInlierConsensus, maxTrialsRemainder, ransacThreshold,
-                                       initial_seed, checkDegeneratePoints, listOfUniquePoints, func);
-      }
+  //Points used by the RANSAC, all the points if there is no prefiltering
+  const std::vector<Correspondence> *uniquePoints = &correspondences;
+  std::vector<Correspondence> listOfUniquePoints;
+  //Index in listP of the points used by the RANSAC
+  std::vector<size_t> mapOfUniquePointIndex;
 
-      threads[(size_t) i] = new vpThread((vpThread::Fn) poseRansacImplThread, (vpThread::Args) &ransac_func[ i]);
-    }
+  bool checkDegeneratePoints = (ransacFlags & CHECK_DEGENERATE_POINTS) != 0;
 
-    //Get the best pose between the threads
-    vpPose final_pose;
-    for(std::vector<vpPoint>::const_iterator it = listOfPoints.begin(); it != listOfPoints.end(); ++it) {
-      final_pose.addPoint(*it);
-    }
+  if (prefilterCorrespondences(correspondences, ransacFlags, listOfUniquePoints, mapOfUniquePointIndex)) {
+    uniquePoints = &listOfUniquePoints;
+  }
 
-    for(size_t i = 0; i < (size_t) nbThreads; i++) {
-      threads[i]->join();
-      delete threads[i];
-    }
+  unsigned int size = (unsigned int) uniquePoints->size();
+  if (size < 4) {
+    throw(vpPoseException(vpPoseException::notInitializedError, "Not enough point to compute the pose")) ;
+  }
 
-    bool successRansac = false;
-    size_t best_consensus_size = 0;
-    for(size_t i = 0; i < (size_t) nbThreads; i++) {
-      if(ransac_func[i].getResult()) {
-        successRansac = true;
 
-        if(ransac_func[i].getBestConsensus().size() > best_consensus_size) {
-          nbInliers = ransac_func[i].getNbInliers();
-          best_consensus = ransac_func[i].getBestConsensus();
-          best_consensus_size = ransac_func[i].getBestConsensus().size();
-        }
-      }
-    }
+  //The hypotheses are evaluated in parallel only if requested, the result does not depend on the number of threads
+  vpRansacEngine engine;
+  engine.setThreshold(ransacThreshold);
+  engine.setMaxTrials(ransacMaxTrials > 0 ? (unsigned int) ransacMaxTrials : 0);
+  engine.setNbInliersToReachConsensus(ransacNbInlierConsensus);
+  engine.setNbThreads(useParallelRansac ? (unsigned int) std::max(nbParallelRansacThreads, 0) : 1);
 
-    foundSolution = successRansac;
-#endif
-  } else {
-    //Sequential RANSAC
-    RansacFunctor sequentialRansac(cMo, ransacNbInlierConsensus, ransacMaxTrials, ransacThreshold,
-                                   0, checkDegeneratePoints, listOfUniquePoints, func);
-    sequentialRansac();
-    foundSolution = sequentialRansac.getResult();
-
-    if (foundSolution) {
-      nbInliers = sequentialRansac.getNbInliers();
-      best_consensus = sequentialRansac.getBestConsensus();
-    }
-  }
+  RansacProblem problem(*uniquePoints, ransacThreshold, checkDegeneratePoints, func);
+  vpColVector model;
+  bool foundSolution = engine.estimate(problem, model, best_consensus);
+  nbInliers = (unsigned int) best_consensus.size();
 
   if(foundSolution) {
     unsigned int nbMinRandom = 4;
@@ -828,13 +563,13 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
     {
       //Refine the solution using all the points in the consensus set and with VVS pose estimation
       vpPose pose;
+      pose.correspondences.reserve(best_consensus.size());
       for(size_t i = 0 ; i < best_consensus.size(); i++)
       {
-        vpPoint pt = listOfUniquePoints[best_consensus[i]];
-
-        pose.addPoint(pt) ;
-        ransacInliers.push_back(pt);
+        pose.correspondences.push_back((*uniquePoints)[best_consensus[i]]);
       }
+      pose.npt = (unsigned int) pose.correspondences.size();
+      pose.correspondencesOnly = true;
 
       //Update the list of inlier index
       for(std::vector<unsigned int>::const_iterator it_index = best_consensus.begin();
@@ -842,6 +577,8 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
         ransacInlierIndex.push_back((unsigned int) mapOfUniquePointIndex[*it_index]);
       }
 
+      updateRansacInliers();
+
       //Flags set if pose computation is OK
       bool is_valid_lagrange = false;
       bool is_valid_dementhon = false;
@@ -902,6 +639,238 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
   return foundSolution;
 }
 
+/*!
+  Update the list of inliers with the points of listP at the indexes of
+  ransacInlierIndex.
+*/
+void vpPose::updateRansacInliers()
+{
+  std::vector<const vpPoint *> points;
+  points.reserve(listP.size());
+  for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it) {
+    points.push_back(&(*it));
+  }
+  ransacInliers.clear();
+  ransacInliers.reserve(ransacInlierIndex.size());
+  for(std::vector<unsigned int>::const_iterator it_index = ransacInlierIndex.begin();
+      it_index != ransacInlierIndex.end(); ++it_index) {
+    ransacInliers.push_back(*points[*it_index]);
+  }
+}
+
+/*!
+  Compute the pose using the PROSAC approach \cite Chum05.
+
+  The hypotheses are computed with the minimal P3P solver from samples of 3
+  points. The samples are first drawn among the points of best quality (see
+  setProsacQuality()), then progressively among all the points. The scoring
+  of a hypothesis stops as soon as it cannot have more inliers than the best
+  one, and the number of trials is adapted to the ratio of inliers of the
+  best hypothesis so that a sample without outlier is drawn with a
+  probability of 0.99, up to the maximum number of trials (see
+  setRansacMaxTrials()). As for poseRansac(), the search stops when the
+  number of inliers given by setRansacNbInliersToReachConsensus() is reached.
+
+  The pose is finally estimated from the inliers with the EPnP method
+  refined with Gauss-Newton iterations of the virtual visual servoing
+  approach, then refined again if this pose gives more inliers.
+
+  The prefiltering flags are used as in poseRansac(). The parallel version
+  is not available, since the samples are drawn in a sequence. The samples
+  are drawn with the generator of vpRansacEngine and the same seed, so that
+  the pose only depends on the points.
+
+  \param cMo : Computed pose
+  \param func : Pointer to a function that takes in parameter a vpHomogeneousMatrix
+  and returns true if the pose check is OK or false otherwise
+  \return True if we found at least 4 points with a reprojection error below ransacThreshold.
+*/
+bool vpPose::poseProsac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMatrix *))
+{
+  updateCorrespondences();
+
+  ransacInliers.clear();
+  ransacInlierIndex.clear();
+
+  if (correspondences.size() < 4) {
+    throw(vpPoseException(vpPoseException::notInitializedError,
+                          "Not enough point to compute the pose")) ;
+  }
+
+  std::vector<Correspondence> listOfUniquePoints;
+  std::vector<size_t> mapOfUniquePointIndex;
+  const std::vector<Correspondence> &uniquePoints =
+      prefilterCorrespondences(correspondences, ransacFlags, listOfUniquePoints, mapOfUniquePointIndex) ?
+        listOfUniquePoints : correspondences;
+  const unsigned int size = (unsigned int) uniquePoints.size();
+  if (size < 4) {
+    throw(vpPoseException(vpPoseException::notInitializedError, "Not enough point to compute the pose")) ;
+  }
+  const bool checkDegeneratePoints = (ransacFlags & CHECK_DEGENERATE_POINTS) != 0;
+
+  // Index of the points sorted by decreasing quality, and rank of each point
+  std::vector<std::pair<double, unsigned int> > quality(size);
+  for (unsigned int i = 0; i < size; i++) {
+    const size_t index = mapOfUniquePointIndex[i];
+    quality[i] = std::make_pair(prosacQuality.size() == correspondences.size() ? -prosacQuality[index] : (double) i, i);
+  }
+  std::stable_sort(quality.begin(), quality.end());
+  std::vector<unsigned int> order(size), rank(size);
+  for (unsigned int i = 0; i < size; i++) {
+    order[i] = quality[i].second;
+    rank[order[i]] = i;
+  }
+
+  const unsigned int m = 3;
+  // Number of samples drawn from the n first points, for the n first points
+  // and for all the points that both PROSAC and RANSAC draw ransacMaxTrials samples
+  double T_n = ransacMaxTrials;
+  for (unsigned int i = 0; i < m; i++) {
+    T_n *= (double) (m - i) / (double) (size - i);
+  }
+  double T_n_prime = 1;
+  unsigned int n = m;
+
+  vpRansacEngine::RandomGenerator random;
+  std::vector<unsigned int> best_consensus, cur_consensus;
+  std::vector<Correspondence> cur_inliers;
+  std::vector<unsigned int> nbInliersInRank;
+  unsigned int nbInliers = 0;
+  vpHomogeneousMatrix hypotheses[4];
+  int maxTrials = ransacMaxTrials;
+  for (int nbTrials = 1; nbTrials <= maxTrials && nbInliers < ransacNbInlierConsensus; nbTrials++) {
+    // Growth of the set of points from which the samples are drawn
+    if (nbTrials >= T_n_prime && n < size) {
+      const double T_n_next = T_n * (n + 1) / (double) (n + 1 - m);
+      T_n_prime += ceil(T_n_next - T_n);
+      T_n = T_n_next;
+      n++;
+    }
+
+    // The sample contains the n-th point, unless all the samples of the n
+    // first points were drawn
+    unsigned int sample[m];
+    unsigned int nbRandom = m;
+    if (T_n_prime >= nbTrials) {
+      sample[--nbRandom] = order[n - 1];
+    }
+    const unsigned int range = (nbRandom == m) ? n : n - 1;
+    for (unsigned int i = 0; i < nbRandom;) {
+      const unsigned int r_ = order[random(range)];
+      bool picked = false;
+      for (unsigned int j = 0; j < i; j++) {
+        picked = picked || sample[j] == r_;
+      }
+      if (!picked) {
+        sample[i++] = r_;
+      }
+    }
+    const Correspondence &P1 = uniquePoints[sample[0]], &P2 = uniquePoints[sample[1]], &P3 = uniquePoints[sample[2]];
+    if (checkDegeneratePoints) {
+      if (FindDegeneratePoint(P1)(P2) || FindDegeneratePoint(P1)(P3) || FindDegeneratePoint(P2)(P3)) {
+        continue;
+      }
+    }
+
+    const unsigned int nbSolutions = computeP3P(P1, P2, P3, hypotheses);
+    for (unsigned int k = 0; k < nbSolutions; k++) {
+      //Filter the pose using some criterion (orientation angles, translations, etc.)
+      if (func != NULL && !func(&hypotheses[k])) {
+        continue;
+      }
+
+      unsigned int nbInliersCur = countInliers(uniquePoints, hypotheses[k], ransacThreshold, checkDegeneratePoints,
+                                               nbInliers, cur_consensus, cur_inliers);
+      if (nbInliersCur > nbInliers) {
+        nbInliers = nbInliersCur;
+        best_consensus.swap(cur_consensus);
+
+        // Number of trials needed to draw a sample without outlier among the
+        // n first points, for the n whose ratio of inliers is the highest
+        // and not due to chance: the inliers of a wrong pose are supposed to
+        // be drawn with a probability beta, and their number is compared to
+        // the one of the best pose with a 95% confidence.
+        nbInliersInRank.assign(size + 1, 0);
+        for (std::vector<unsigned int>::const_iterator it = best_consensus.begin(); it != best_consensus.end(); ++it) {
+          nbInliersInRank[rank[*it] + 1]++;
+        }
+        const double beta = 0.05;
+        for (unsigned int i = 1; i <= size; i++) {
+          nbInliersInRank[i] += nbInliersInRank[i - 1];
+          if (i > m) {
+            const double mu = (i - m) * beta, sigma = sqrt((i - m) * beta * (1 - beta));
+            if (nbInliersInRank[i] > m + mu + 1.645 * sigma) {
+              const double epsilon = 1. - (double) nbInliersInRank[i] / (double) i;
+              const int N = computeRansacIterations(0.99, epsilon, (int) m, ransacMaxTrials);
+              if (N > 0) {
+                maxTrials = std::min(maxTrials, N);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  if (nbInliers < 4) {
+    return false;
+  }
+
+  //Refine the solution using all the points in the consensus set. Since
+  //EPnP gives an accurate initialization, the virtual visual servoing uses a
+  //unit gain (Gauss-Newton iterations) and a few iterations.
+  vpPose pose;
+  pose.setCovarianceComputation(computeCovariance);
+  pose.setLambda(1.);
+  pose.setVvsIterMax(20);
+  for (unsigned int iter = 0; ; iter++) {
+    pose.correspondences.clear();
+    pose.correspondences.reserve(best_consensus.size());
+    for (size_t i = 0; i < best_consensus.size(); i++) {
+      pose.correspondences.push_back(uniquePoints[best_consensus[i]]);
+    }
+    pose.npt = (unsigned int) pose.correspondences.size();
+    pose.correspondencesOnly = true;
+
+    try {
+      pose.computePose(iter == 0 ? vpPose::EPNP_VIRTUAL_VS : vpPose::VIRTUAL_VS, cMo);
+    } catch(...) {
+      return false;
+    }
+
+    //Refine once more if the refined pose gives more inliers
+    if (iter > 0) {
+      break;
+    }
+    unsigned int nbInliersRefined = countInliers(uniquePoints, cMo, ransacThreshold, checkDegeneratePoints, nbInliers,
+                                                 cur_consensus, cur_inliers);
+    if (nbInliersRefined <= nbInliers) {
+      break;
+    }
+    nbInliers = nbInliersRefined;
+    best_consensus.swap(cur_consensus);
+  }
+
+  //In some rare cases, the final pose could not respect the pose criterion even
+  //if the sampled points respect the pose criterion.
+  if(func != NULL && !func(&cMo)) {
+    return false;
+  }
+
+  if(computeCovariance) {
+    covarianceMatrix = pose.covarianceMatrix;
+  }
+
+  //Update the list of inlier index
+  for(std::vector<unsigned int>::const_iterator it_index = best_consensus.begin();
+      it_index != best_consensus.end(); ++it_index) {
+    ransacInlierIndex.push_back((unsigned int) mapOfUniquePointIndex[*it_index]);
+  }
+  updateRansacInliers();
+
+  return true;
+}
+
 /*!
   Compute the number of RANSAC iterations to ensure with a probability \e p
   that at least one of the random samples of \e s points is free from outliers.
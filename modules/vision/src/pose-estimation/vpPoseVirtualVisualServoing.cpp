@@ -44,6 +44,7 @@
 #include <visp3/core/vpPoint.h>
 #include <visp3/core/vpExponentialMap.h>
 #include <visp3/core/vpRobust.h>
+#include <visp3/core/vpWeightedLeastSquares.h>
 
 /*!
   \brief Compute the pose using virtual visual servoing approach
@@ -55,6 +56,7 @@
 void
 vpPose::poseVirtualVS(vpHomogeneousMatrix & cMo)
 {
+  updateCorrespondences() ;
   try
   {
 
@@ -65,25 +67,19 @@ vpPose::poseVirtualVS(vpHomogeneousMatrix & cMo)
 
     int iter = 0 ;
 
-    unsigned int nb = (unsigned int) listP.size() ;
-    vpMatrix L(2*nb,6) ;
-    vpColVector err(2*nb) ;
-    vpColVector sd(2*nb),s(2*nb) ;
-    vpColVector v ;
-    
-    vpPoint P;
-    std::list<vpPoint> lP ;
-
-    // create sd
-    unsigned int k =0 ;
-    for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
-    {
-      P = *it;
-      sd[2*k] = P.get_x() ;
-      sd[2*k+1] = P.get_y() ;
-      lP.push_back(P);
-      k ++;
+    unsigned int nb = (unsigned int) correspondences.size() ;
+    // The interaction matrix and the error are only kept to compute the covariance,
+    // the rows are otherwise directly accumulated in the normal equations
+    vpMatrix L ;
+    vpColVector err ;
+    if (computeCovariance) {
+      L.resize(2*nb, 6) ;
+      err.resize(2*nb) ;
     }
+    vpColVector v ;
+    vpWeightedLeastSquares normalEquations(6) ;
+    double Lx[6], Ly[6] ;
+    Lx[1] = Ly[0] = 0 ;
 
     vpHomogeneousMatrix cMoPrev = cMo;
     //while((int)((residu_1 - r)*1e12) !=0)
@@ -91,46 +87,54 @@ vpPose::poseVirtualVS(vpHomogeneousMatrix & cMo)
     {      
       residu_1 = r ;
 
-      // Compute the interaction matrix and the error
-      k =0 ;
-      for (std::list<vpPoint>::const_iterator it = lP.begin(); it != lP.end(); ++it)
+      // Compute the interaction matrix and the error, and accumulate them
+      normalEquations.reset() ;
+      unsigned int k =0 ;
+      for (std::vector<Correspondence>::const_iterator it = correspondences.begin(); it != correspondences.end(); ++it)
       {
-        P = *it;
         // forward projection of the 3D model for a given pose
         // change frame coordinates
+        double X = cMo[0][0]*it->oX + cMo[0][1]*it->oY + cMo[0][2]*it->oZ + cMo[0][3] ;
+        double Y = cMo[1][0]*it->oX + cMo[1][1]*it->oY + cMo[1][2]*it->oZ + cMo[1][3] ;
+        double Z = cMo[2][0]*it->oX + cMo[2][1]*it->oY + cMo[2][2]*it->oZ + cMo[2][3] ;
         // perspective projection
-        P.track(cMo) ;
-
-        double x = s[2*k] = P.get_x();  /* point projected from cMo */
-        double y = s[2*k+1] = P.get_y();
-        double Z = P.get_Z() ;
-        L[2*k][0] = -1/Z  ;
-        L[2*k][1] = 0 ;
-        L[2*k][2] = x/Z ;
-        L[2*k][3] = x*y ;
-        L[2*k][4] = -(1+x*x) ;
-        L[2*k][5] = y ;
-
-        L[2*k+1][0] = 0 ;
-        L[2*k+1][1]  = -1/Z ;
-        L[2*k+1][2] = y/Z ;
-        L[2*k+1][3] = 1+y*y ;
-        L[2*k+1][4] = -x*y ;
-        L[2*k+1][5] = -x ;
+        double d = 1/Z ;
+        double x = X*d;  /* point projected from cMo */
+        double y = Y*d;
+        Lx[0] = -1/Z  ;
+        Lx[2] = x/Z ;
+        Lx[3] = x*y ;
+        Lx[4] = -(1+x*x) ;
+        Lx[5] = y ;
+
+        Ly[1]  = -1/Z ;
+        Ly[2] = y/Z ;
+        Ly[3] = 1+y*y ;
+        Ly[4] = -x*y ;
+        Ly[5] = -x ;
+
+        normalEquations.addRow(Lx, x - it->x) ;
+        normalEquations.addRow(Ly, y - it->y) ;
+        if (computeCovariance) {
+          for (unsigned int j = 0; j < 6; j++) {
+            L[2*k][j] = Lx[j] ;
+            L[2*k+1][j] = Ly[j] ;
+          }
+          err[2*k] = x - it->x ;
+          err[2*k+1] = y - it->y ;
+        }
 
         k+=1 ;
       }
-      err = s - sd ;
 
       // compute the residual
-      r = err.sumSquare() ;
+      r = normalEquations.getWeightedSumSquare() ;
 
-      // compute the pseudo inverse of the interaction matrix
-      vpMatrix Lp ;
-      L.pseudoInverse(Lp,1e-16) ;
+      // solve L v = err in the least squares sense through the normal equations
+      normalEquations.solve(v, 0.0, 1e-16) ;
 
       // compute the VVS control law
-      v = -lambda*Lp*err ;
+      v = -lambda*v ;
 
       //std::cout << "r=" << r <<std::endl ;
       // update the pose
@@ -161,41 +165,36 @@ vpPose::poseVirtualVS(vpHomogeneousMatrix & cMo)
 void
 vpPose::poseVirtualVSrobust(vpHomogeneousMatrix & cMo)
 {
+  updateCorrespondences() ;
 	try{
 
     double  residu_1 = 1e8 ;
     double r =1e8-1;
 
     // we stop the minimization when the error is bellow 1e-8
-    vpMatrix W ;
-    vpRobust robust((unsigned int)(2*listP.size())) ;
+    vpRobust robust((unsigned int)(2*correspondences.size())) ;
     robust.setThreshold(0.0000) ;
     vpColVector w,res ;
 
-    unsigned int nb = (unsigned int) listP.size() ;
+    unsigned int nb = (unsigned int) correspondences.size() ;
     vpMatrix L(2*nb,6) ;
     vpColVector error(2*nb) ;
     vpColVector sd(2*nb),s(2*nb) ;
     vpColVector v ;
-
-    listP.front() ;
-    vpPoint P;
-    std::list<vpPoint> lP ;
+    vpColVector W2(2*nb) ;
+    vpWeightedLeastSquares normalEquations(6) ;
 
     // create sd
     unsigned int k_ =0 ;
-    for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+    for (std::vector<Correspondence>::const_iterator it = correspondences.begin(); it != correspondences.end(); ++it)
     {
-      P = *it;
-      sd[2*k_] = P.get_x() ;
-      sd[2*k_+1] = P.get_y() ;
-      lP.push_back(P) ;
+      sd[2*k_] = it->x ;
+      sd[2*k_+1] = it->y ;
       k_ ++;
     }
     int iter = 0 ;
     res.resize(s.getRows()/2) ;
     w.resize(s.getRows()/2) ;
-    W.resize(s.getRows(), s.getRows()) ;
     w =1 ;
 
     //while((int)((residu_1 - r)*1e12) !=0)
@@ -205,17 +204,17 @@ vpPose::poseVirtualVSrobust(vpHomogeneousMatrix & cMo)
 
       // Compute the interaction matrix and the error
       k_ =0 ;
-      for (std::list<vpPoint>::const_iterator it = lP.begin(); it != lP.end(); ++it)
+      for (std::vector<Correspondence>::const_iterator it = correspondences.begin(); it != correspondences.end(); ++it)
       {
-        P = *it;
         // forward projection of the 3D model for a given pose
         // change frame coordinates
+        double X = cMo[0][0]*it->oX + cMo[0][1]*it->oY + cMo[0][2]*it->oZ + cMo[0][3] ;
+        double Y = cMo[1][0]*it->oX + cMo[1][1]*it->oY + cMo[1][2]*it->oZ + cMo[1][3] ;
+        double Z = cMo[2][0]*it->oX + cMo[2][1]*it->oY + cMo[2][2]*it->oZ + cMo[2][3] ;
         // perspective projection
-        P.track(cMo) ;
-
-        double x = s[2*k_] = P.get_x();  // point projected from cMo
-        double y = s[2*k_+1] = P.get_y();
-        double Z = P.get_Z() ;
+        double d = 1/Z ;
+        double x = s[2*k_] = X*d;  // point projected from cMo
+        double y = s[2*k_+1] = Y*d;
         L[2*k_][0] = -1/Z  ;
         L[2*k_][1] = 0 ;
         L[2*k_][2] = x/Z ;
@@ -245,25 +244,27 @@ vpPose::poseVirtualVSrobust(vpHomogeneousMatrix & cMo)
       robust.setIteration(0);
       robust.MEstimator(vpRobust::TUKEY, res, w);
 
-      // compute the pseudo inverse of the interaction matrix
+      // (W L)^+ W e is the solution of the normal equations weighted by W^2
       for (unsigned int k=0 ; k < error.getRows()/2 ; k++)
       {
-        W[2*k][2*k] = w[k] ;
-        W[2*k+1][2*k+1] = w[k] ;
+        W2[2*k] = W2[2*k+1] = w[k]*w[k] ;
       }
-      // compute the pseudo inverse of the interaction matrix
-      vpMatrix Lp ;
-      (W*L).pseudoInverse(Lp,1e-6) ;
+      normalEquations.reset() ;
+      normalEquations.addRows(L, error, W2) ;
+      normalEquations.solve(v, 0.0, 1e-12) ;
 
       // compute the VVS control law
-      v = -lambda*Lp*W*error ;
+      v = -lambda*v ;
 
       cMo = vpExponentialMap::direct(v).inverse()*cMo ; ;
       if (iter++>vvsIterMax) break ;
     }
     
-    if(computeCovariance)
-      covarianceMatrix = vpMatrix::computeCovarianceMatrix(L,v,-lambda*error, W*W); // Remark: W*W = W*W.t() since the matrix is diagonale, but using W*W is more efficient.
+    if(computeCovariance) {
+      vpMatrix W2diag ;
+      W2diag.diag(W2) ;
+      covarianceMatrix = vpMatrix::computeCovarianceMatrix(L,v,-lambda*error, W2diag);
+    }
   }
   catch(...)
   {
@@ -0,0 +1,346 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the generic RANSAC engine.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceRansac.cpp
+
+  \brief Check that vpRansacEngine gives the same model whatever the number
+  of threads, that it draws the degenerate samples again without counting a
+  trial and handles an inclusive threshold, that the homography and the pose estimated with RANSAC have the
+  expected inliers, and measure the number of hypotheses evaluated per second
+  and the time spent by vpHomography::ransac() and vpPose::poseRansac().
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpRansacEngine.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/vision/vpHomography.h>
+#include <visp3/vision/vpPose.h>
+
+namespace {
+  double random(const double min, const double max)
+  {
+    return min + (max - min) * (rand() % 10000) / 10000.;
+  }
+
+  bool sameArray(const vpArray2D<double> &A, const vpArray2D<double> &B)
+  {
+    if (A.size() != B.size())
+      return false;
+    for (unsigned int i = 0; i < A.size(); i++) {
+      if (A.data[i] != B.data[i])
+        return false;
+    }
+    return true;
+  }
+
+  //! Line y = a x + b fitted to 2D points, the model being (a, b)
+  class LineProblem : public vpRansacEngine::Problem
+  {
+  public:
+    LineProblem(const std::vector<double> &x, const std::vector<double> &y)
+      : m_x(x), m_y(y), m_degenerateX(-1e9), m_inclusive(false) {}
+
+    unsigned int getNbData() const { return (unsigned int) m_x.size(); }
+    unsigned int getSampleSize() const { return 2; }
+
+    //! The samples whose points both have an abscissa below \e x are degenerate
+    void setDegenerateX(const double x) { m_degenerateX = x; }
+    void setThresholdInclusive(const bool inclusive) { m_inclusive = inclusive; }
+
+    bool isDegenerate(const unsigned int *sample) const
+    {
+      return m_x[sample[0]] < m_degenerateX && m_x[sample[1]] < m_degenerateX;
+    }
+
+    bool isThresholdInclusive() const { return m_inclusive; }
+
+    unsigned int computeModels(const unsigned int *sample, std::vector<vpColVector> &models) const
+    {
+      const double dx = m_x[sample[1]] - m_x[sample[0]];
+      if (fabs(dx) < 1e-9)
+        return 0;
+      vpColVector model(2);
+      model[0] = (m_y[sample[1]] - m_y[sample[0]]) / dx;
+      model[1] = m_y[sample[0]] - model[0] * m_x[sample[0]];
+      models.push_back(model);
+      return 1;
+    }
+
+    void computeErrors(const vpColVector &model, const unsigned int begin, const unsigned int end,
+                       double *errors) const
+    {
+      for (unsigned int i = begin; i < end; i++)
+        errors[i - begin] = fabs(model[0] * m_x[i] + model[1] - m_y[i]);
+    }
+
+    // Least squares fit
+    bool refineModel(const std::vector<unsigned int> &inliers, vpColVector &model) const
+    {
+      double sx = 0, sy = 0, sxx = 0, sxy = 0;
+      const double n = (double) inliers.size();
+      for (size_t i = 0; i < inliers.size(); i++) {
+        const double x = m_x[inliers[i]], y = m_y[inliers[i]];
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+      }
+      const double det = n * sxx - sx * sx;
+      if (fabs(det) < 1e-12)
+        return false;
+      model[0] = (n * sxy - sx * sy) / det;
+      model[1] = (sy - model[0] * sx) / n;
+      return true;
+    }
+
+  private:
+    const std::vector<double> &m_x, &m_y;
+    double m_degenerateX;
+    bool m_inclusive;
+  };
+}
+
+int main()
+{
+  try {
+    srand(0);
+    // Several threads, even on a single core, to check that the results do not depend on them
+    vpThreadPool::getInstance().setNumThreads(std::max(4u, vpThreadPool::getNumberOfCPU()));
+
+    // Line with 60% of outliers
+    const unsigned int n = 20000;
+    std::vector<double> x(n), y(n);
+    size_t nb_inliers = 0;
+    for (unsigned int i = 0; i < n; i++) {
+      x[i] = random(-1, 1);
+      y[i] = 0.5 * x[i] + 0.2 + random(-0.001, 0.001);
+      if (random(0, 1) < 0.6)
+        y[i] = random(-1, 1);
+      else
+        nb_inliers++;
+    }
+    LineProblem line(x, y);
+    vpRansacEngine engine;
+    engine.setThreshold(0.002);
+    std::vector<unsigned int> inliers_ref;
+    vpColVector model_ref;
+    const unsigned int nbThreads[] = { 1, 2, 0 };
+    for (unsigned int t = 0; t < 3; t++) {
+      engine.setNbThreads(nbThreads[t]);
+      std::vector<unsigned int> inliers;
+      vpColVector model;
+      if (! engine.estimate(line, model, inliers)) {
+        std::cerr << "The line was not found" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (t == 0) {
+        inliers_ref = inliers;
+        model_ref = model;
+        if (fabs(model[0] - 0.5) > 1e-3 || fabs(model[1] - 0.2) > 1e-3) {
+          std::cerr << "The line is wrong: " << model.t() << std::endl;
+          return EXIT_FAILURE;
+        }
+        if (100 * inliers.size() < 99 * nb_inliers) {
+          std::cerr << "Only " << inliers.size() << " inliers on " << nb_inliers << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      else if (inliers != inliers_ref || ! sameArray(model, model_ref)) {
+        std::cerr << "The line depends on the number of threads" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Hypotheses per second, with a fixed number of trials
+    engine.setConfidence(0);
+    engine.setMaxTrials(2000);
+    engine.setLocalOptimization(false);
+    std::cout << "Line from " << n << " points, 2000 hypotheses:" << std::endl;
+    for (unsigned int t = 0; t < 2; t++) {
+      engine.setNbThreads(t == 0 ? 1 : 0);
+      std::vector<unsigned int> inliers;
+      vpColVector model;
+      double time = vpTime::measureTimeMs();
+      engine.estimate(line, model, inliers);
+      time = vpTime::measureTimeMs() - time;
+      std::cout << "  " << (t == 0 ? 1 : vpThreadPool::getInstance().getNumThreads()) << " thread(s): "
+                << engine.getNbHypotheses() / time * 1000
+                << " hypotheses/s" << std::endl;
+    }
+
+    // The degenerate samples do not count as trials
+    line.setDegenerateX(0.5);
+    engine.setMaxTrials(100);
+    engine.setNbThreads(0);
+    {
+      std::vector<unsigned int> inliers;
+      vpColVector model;
+      engine.estimate(line, model, inliers);
+      if (engine.getNbTrials() != 100 || engine.isDegenerateLimitReached()) {
+        std::cerr << "The degenerate samples were counted as trials" << std::endl;
+        return EXIT_FAILURE;
+      }
+      line.setDegenerateX(2);
+      if (engine.estimate(line, model, inliers) || ! engine.isDegenerateLimitReached()) {
+        std::cerr << "The search did not stop on degenerate samples" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Errors equal to the threshold, with exact arithmetic: 10 points on y = x, 5 points at 0.5 of it
+    {
+      std::vector<double> xs, ys;
+      for (unsigned int i = 0; i < 18; i++) {
+        xs.push_back(i);
+        ys.push_back(i < 10 ? i : (i < 15 ? i + 0.5 : i + 100.));
+      }
+      LineProblem exact(xs, ys);
+      vpColVector model(2);
+      model[0] = 1;
+      const size_t nbInliers[] = { 10, 15 };
+      for (unsigned int inclusive = 0; inclusive < 2; inclusive++) {
+        exact.setThresholdInclusive(inclusive == 1);
+        std::vector<unsigned int> consensus;
+        std::vector<double> errors;
+        exact.computeConsensus(model, 0.5, 0, consensus, errors);
+        if (consensus.size() != nbInliers[inclusive]) {
+          std::cerr << "Wrong number of inliers with " << (inclusive ? "an inclusive" : "an exclusive")
+                    << " threshold: " << consensus.size() << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Homography with 40% of outliers
+    const unsigned int nb_matches = 2000, nb_iter = 10;
+    vpHomography aHb;
+    aHb[0][0] = 1.1; aHb[0][1] = 0.05; aHb[0][2] = 0.02;
+    aHb[1][0] = -0.03; aHb[1][1] = 0.95; aHb[1][2] = -0.01;
+    aHb[2][0] = 0.1; aHb[2][1] = -0.05; aHb[2][2] = 1;
+    std::vector<double> xa(nb_matches), ya(nb_matches), xb(nb_matches), yb(nb_matches);
+    std::vector<bool> inliers_gt(nb_matches);
+    for (unsigned int i = 0; i < nb_matches; i++) {
+      xb[i] = random(-0.3, 0.3);
+      yb[i] = random(-0.3, 0.3);
+      const double z = aHb[2][0] * xb[i] + aHb[2][1] * yb[i] + aHb[2][2];
+      xa[i] = (aHb[0][0] * xb[i] + aHb[0][1] * yb[i] + aHb[0][2]) / z;
+      ya[i] = (aHb[1][0] * xb[i] + aHb[1][1] * yb[i] + aHb[1][2]) / z;
+      inliers_gt[i] = random(0, 1) >= 0.4;
+      if (! inliers_gt[i]) {
+        xa[i] = random(-0.4, 0.4);
+        ya[i] = random(-0.4, 0.4);
+        const double zo = aHb[2][0] * xb[i] + aHb[2][1] * yb[i] + aHb[2][2];
+        const double dx = xa[i] - (aHb[0][0] * xb[i] + aHb[0][1] * yb[i] + aHb[0][2]) / zo;
+        const double dy = ya[i] - (aHb[1][0] * xb[i] + aHb[1][1] * yb[i] + aHb[1][2]) / zo;
+        inliers_gt[i] = sqrt(dx * dx + dy * dy) < 0.001;
+      }
+    }
+    double t_homography = 0;
+    for (unsigned int iter = 0; iter < nb_iter; iter++) {
+      vpHomography H;
+      std::vector<bool> inliers;
+      double residual;
+      double t = vpTime::measureTimeMs();
+      if (! vpHomography::ransac(xb, yb, xa, ya, H, inliers, residual, nb_matches, 0.001)) {
+        // The consensus of all the matches cannot be reached
+      }
+      t_homography += vpTime::measureTimeMs() - t;
+      if (inliers != inliers_gt) {
+        std::cerr << "The inliers of the homography are wrong" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    std::cout << "Homography from " << nb_matches << " matches with 40% of outliers: " << t_homography / nb_iter
+              << " ms" << std::endl;
+
+    // Pose, sequential and parallel
+    const vpHomogeneousMatrix cMo_ref(0.05, -0.02, 1.0, vpMath::rad(10), vpMath::rad(-20), vpMath::rad(30));
+    std::vector<vpPoint> points;
+    for (unsigned int i = 0; i < nb_matches; i++) {
+      vpPoint P(random(-0.2, 0.2), random(-0.2, 0.2), random(-0.1, 0.1));
+      P.project(cMo_ref);
+      P.set_x(P.get_x() + random(-0.0002, 0.0002));
+      P.set_y(P.get_y() + random(-0.0002, 0.0002));
+      if (random(0, 1) < 0.4) {
+        P.set_x(random(-0.5, 0.5));
+        P.set_y(random(-0.5, 0.5));
+      }
+      points.push_back(P);
+    }
+    vpHomogeneousMatrix cMo_seq;
+    std::vector<unsigned int> index_seq;
+    for (unsigned int parallel = 0; parallel < 2; parallel++) {
+      double t_pose = 0;
+      for (unsigned int iter = 0; iter < nb_iter; iter++) {
+        vpPose pose;
+        pose.addPoints(points);
+        pose.setRansacThreshold(0.001);
+        pose.setRansacNbInliersToReachConsensus(nb_matches);
+        pose.setRansacMaxTrials(500);
+        pose.setUseParallelRansac(parallel == 1);
+        vpHomogeneousMatrix cMo;
+        double t = vpTime::measureTimeMs();
+        if (! pose.computePose(vpPose::RANSAC, cMo)) {
+          std::cerr << "RANSAC failed" << std::endl;
+          return EXIT_FAILURE;
+        }
+        t_pose += vpTime::measureTimeMs() - t;
+        if (parallel == 0 && iter == 0) {
+          cMo_seq = cMo;
+          index_seq = pose.getRansacInlierIndex();
+        }
+        else if (pose.getRansacInlierIndex() != index_seq || ! sameArray(cMo, cMo_seq)) {
+          std::cerr << "The pose depends on the number of threads" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      std::cout << "Pose from " << nb_matches << " points with 40% of outliers, "
+                << (parallel ? vpThreadPool::getInstance().getNumThreads() : 1) << " thread(s): " << t_pose / nb_iter
+                << " ms" << std::endl;
+    }
+
+    std::cout << "testPerformanceRansac is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
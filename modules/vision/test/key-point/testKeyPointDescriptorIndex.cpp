@@ -0,0 +1,205 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the matching of vpKeyPoint with the index of the train descriptors.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testKeyPointDescriptorIndex.cpp
+
+  \brief Check that vpKeyPoint gives the same matches with the index of the
+  train descriptors as with the brute force matcher, with and without the
+  ratio filter, including when there are less train descriptors than the two
+  neighbours needed by the ratio filter.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdlib.h>
+#include <utility>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020400)
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/vision/vpKeyPoint.h>
+
+namespace {
+  //! Pseudo-random value in [0, 1] of a node of a 2D lattice
+  double latticeValue(const int i, const int j)
+  {
+    unsigned int h = (unsigned int)i * 73856093u ^ (unsigned int)j * 19349663u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return (h & 0xffff) / 65535.;
+  }
+
+  //! Bilinear interpolation of the lattice values, with a lattice step of \e step pixels
+  double noise(const double u, const double v, const double step)
+  {
+    const double x = u / step, y = v / step;
+    const int i = (int)floor(x), j = (int)floor(y);
+    const double a = x - i, b = y - j;
+    return (1 - a) * (1 - b) * latticeValue(i, j) + a * (1 - b) * latticeValue(i + 1, j) +
+        (1 - a) * b * latticeValue(i, j + 1) + a * b * latticeValue(i + 1, j + 1);
+  }
+
+  //! Random texture rotated by \e angle and translated by (\e tu, \e tv)
+  void render(vpImage<unsigned char> &I, const double angle, const double tu, const double tv)
+  {
+    const double c = cos(angle), s = sin(angle);
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        const double du = j - 320. - tu, dv = i - 240. - tv;
+        const double u = 320. + c * du + s * dv, v = 240. - s * du + c * dv;
+        const double val = 128. + 90. * (noise(u, v, 6.) - 0.5) + 60. * (noise(u, v, 17.) - 0.5);
+        I[i][j] = (unsigned char) vpMath::round(std::max(0., std::min(255., val)));
+      }
+    }
+  }
+
+  //! Matches of the query image as pairs of query and train keypoint positions
+  std::vector<std::pair<cv::Point2f, cv::Point2f> > match(vpKeyPoint &keypoint, const vpImage<unsigned char> &I)
+  {
+    keypoint.matchPoint(I);
+    std::vector<std::pair<cv::KeyPoint, cv::KeyPoint> > pairs = keypoint.getMatchQueryToTrainKeyPoints();
+    std::vector<std::pair<cv::Point2f, cv::Point2f> > matches;
+    for (size_t i = 0; i < pairs.size(); i++)
+      matches.push_back(std::make_pair(pairs[i].first.pt, pairs[i].second.pt));
+    return matches;
+  }
+
+  //! Number of matches of \e ref also given by \e matches
+  size_t nbCommonMatches(const std::vector<std::pair<cv::Point2f, cv::Point2f> > &ref,
+                         const std::vector<std::pair<cv::Point2f, cv::Point2f> > &matches)
+  {
+    size_t nb = 0;
+    for (size_t i = 0; i < ref.size(); i++) {
+      for (size_t j = 0; j < matches.size(); j++) {
+        if (ref[i].first == matches[j].first && ref[i].second == matches[j].second) {
+          nb++;
+          break;
+        }
+      }
+    }
+    return nb;
+  }
+
+  //! Match the query image with the brute force matcher and with the index
+  bool compare(const vpImage<unsigned char> &Iref, const vpImage<unsigned char> &I,
+               const vpKeyPoint::vpFilterMatchingType filterType, const char *name)
+  {
+    vpKeyPoint bruteForce("ORB", "ORB", "BruteForce-Hamming", filterType);
+    vpKeyPoint indexed("ORB", "ORB", "BruteForce-Hamming", filterType);
+    indexed.setUseDescriptorIndex(true);
+    bruteForce.buildReference(Iref);
+    indexed.buildReference(Iref);
+
+    std::vector<std::pair<cv::Point2f, cv::Point2f> > ref = match(bruteForce, I), matches = match(indexed, I);
+    size_t nbCommon = nbCommonMatches(ref, matches);
+    std::cout << name << ": " << ref.size() << " matches with the brute force matcher, " << matches.size()
+              << " with the index, " << nbCommon << " in common" << std::endl;
+    // The index is approximate and may break the ties between equidistant descriptors differently
+    if (ref.size() < 50 || 100 * nbCommon < 95 * ref.size() || 100 * matches.size() > 105 * ref.size()) {
+      std::cerr << name << ": the matches of the index differ from the brute force ones" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  //! Match the query image with a single train descriptor
+  bool compareSingle(const vpImage<unsigned char> &Iref, const vpImage<unsigned char> &I,
+                     const vpKeyPoint::vpFilterMatchingType filterType, const char *name)
+  {
+    vpKeyPoint detector("ORB", "ORB", "BruteForce-Hamming");
+    detector.buildReference(Iref);
+    std::vector<cv::KeyPoint> trainKeyPoints;
+    detector.getTrainKeyPoints(trainKeyPoints);
+    const cv::Mat trainDescriptors = detector.getTrainDescriptors();
+    if (trainKeyPoints.empty()) {
+      std::cerr << "No keypoint detected" << std::endl;
+      return false;
+    }
+    std::vector<cv::KeyPoint> keyPoint(1, trainKeyPoints[0]);
+    std::vector<cv::Point3f> points3f(1, cv::Point3f(0, 0, 0));
+
+    vpKeyPoint bruteForce("ORB", "ORB", "BruteForce-Hamming", filterType);
+    vpKeyPoint indexed("ORB", "ORB", "BruteForce-Hamming", filterType);
+    indexed.setUseDescriptorIndex(true);
+    bruteForce.buildReference(Iref, keyPoint, trainDescriptors.row(0).clone(), points3f);
+    indexed.buildReference(Iref, keyPoint, trainDescriptors.row(0).clone(), points3f);
+
+    std::vector<std::pair<cv::Point2f, cv::Point2f> > ref = match(bruteForce, I), matches = match(indexed, I);
+    if (matches.size() != ref.size() || nbCommonMatches(ref, matches) != ref.size()) {
+      std::cerr << name << " with a single train descriptor: " << matches.size() << " matches with the index, "
+                << ref.size() << " with the brute force matcher" << std::endl;
+      return false;
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    vpImage<unsigned char> Iref(480, 640), I(480, 640);
+    render(Iref, 0., 0., 0.);
+    render(I, vpMath::rad(5.), 12., -7.);
+
+    if (! compare(Iref, I, vpKeyPoint::noFilterMatching, "No filtering") ||
+        ! compare(Iref, I, vpKeyPoint::ratioDistanceThreshold, "Ratio filtering") ||
+        ! compare(Iref, I, vpKeyPoint::stdAndRatioDistanceThreshold, "Std and ratio filtering") ||
+        ! compareSingle(Iref, I, vpKeyPoint::noFilterMatching, "No filtering") ||
+        ! compareSingle(Iref, I, vpKeyPoint::ratioDistanceThreshold, "Ratio filtering") ||
+        ! compareSingle(Iref, I, vpKeyPoint::stdAndRatioDistanceThreshold, "Std and ratio filtering"))
+      return EXIT_FAILURE;
+
+    std::cout << "testKeyPointDescriptorIndex is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "This test requires OpenCV 2.4 or higher." << std::endl;
+  return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,225 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the save and load of the mapped learning data of vpKeyPoint.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testKeyPointMappedLearningData.cpp
+
+  \brief Check that the learning data saved by
+  vpKeyPoint::saveMappedLearningData() are loaded back by
+  vpKeyPoint::loadLearningData() with the same keypoints, 3D points,
+  descriptors and matches, with and without the descriptor index.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020400)
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/vision/vpKeyPoint.h>
+
+namespace {
+  //! Temporary directory of the user
+  std::string tempDirectory()
+  {
+#if defined(_WIN32)
+    std::string directory = "C:/temp/" + vpIoTools::getUserName();
+#else
+    std::string directory = "/tmp/" + vpIoTools::getUserName();
+#endif
+    if (! vpIoTools::checkDirectory(directory))
+      vpIoTools::makeDirectory(directory);
+    return directory;
+  }
+
+  //! Pseudo-random value in [0, 1] of a node of a 2D lattice
+  double latticeValue(const int i, const int j)
+  {
+    unsigned int h = (unsigned int)i * 73856093u ^ (unsigned int)j * 19349663u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return (h & 0xffff) / 65535.;
+  }
+
+  //! Bilinear interpolation of the lattice values, with a lattice step of \e step pixels
+  double noise(const double u, const double v, const double step)
+  {
+    const double x = u / step, y = v / step;
+    const int i = (int)floor(x), j = (int)floor(y);
+    const double a = x - i, b = y - j;
+    return (1 - a) * (1 - b) * latticeValue(i, j) + a * (1 - b) * latticeValue(i + 1, j) +
+        (1 - a) * b * latticeValue(i, j + 1) + a * b * latticeValue(i + 1, j + 1);
+  }
+
+  //! Random texture rotated by \e angle and translated by (\e tu, \e tv)
+  void render(vpImage<unsigned char> &I, const double angle, const double tu, const double tv)
+  {
+    const double c = cos(angle), s = sin(angle);
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        const double du = j - 320. - tu, dv = i - 240. - tv;
+        const double u = 320. + c * du + s * dv, v = 240. - s * du + c * dv;
+        const double val = 128. + 90. * (noise(u, v, 6.) - 0.5) + 60. * (noise(u, v, 17.) - 0.5);
+        I[i][j] = (unsigned char) vpMath::round(std::max(0., std::min(255., val)));
+      }
+    }
+  }
+
+  bool sameKeyPoint(const cv::KeyPoint &a, const cv::KeyPoint &b)
+  {
+    return a.pt == b.pt && a.size == b.size && a.angle == b.angle && a.response == b.response &&
+        a.octave == b.octave && a.class_id == b.class_id;
+  }
+
+  bool sameMatches(const std::vector<cv::DMatch> &a, const std::vector<cv::DMatch> &b)
+  {
+    if (a.size() != b.size())
+      return false;
+    for (size_t i = 0; i < a.size(); i++) {
+      if (a[i].queryIdx != b[i].queryIdx || a[i].trainIdx != b[i].trainIdx || a[i].distance != b[i].distance)
+        return false;
+    }
+    return true;
+  }
+
+  //! Compare the learning data and the matches of two vpKeyPoint
+  bool compare(vpKeyPoint &ref, vpKeyPoint &loaded, const vpImage<unsigned char> &I, const char *name)
+  {
+    std::vector<cv::KeyPoint> refKeyPoints, loadedKeyPoints;
+    std::vector<cv::Point3f> refPoints, loadedPoints;
+    ref.getTrainKeyPoints(refKeyPoints);
+    loaded.getTrainKeyPoints(loadedKeyPoints);
+    ref.getTrainPoints(refPoints);
+    loaded.getTrainPoints(loadedPoints);
+    bool same = refKeyPoints.size() == loadedKeyPoints.size() && refPoints.size() == loadedPoints.size();
+    for (size_t i = 0; i < refKeyPoints.size() && same; i++)
+      same = sameKeyPoint(refKeyPoints[i], loadedKeyPoints[i]);
+    for (size_t i = 0; i < refPoints.size() && same; i++)
+      same = refPoints[i] == loadedPoints[i];
+    if (!same) {
+      std::cerr << name << ": the loaded keypoints differ from the saved ones" << std::endl;
+      return false;
+    }
+
+    const cv::Mat refDescriptors = ref.getTrainDescriptors(), loadedDescriptors = loaded.getTrainDescriptors();
+    if (refDescriptors.rows != loadedDescriptors.rows || refDescriptors.cols != loadedDescriptors.cols ||
+        refDescriptors.type() != loadedDescriptors.type()) {
+      std::cerr << name << ": the loaded descriptors have another size or type" << std::endl;
+      return false;
+    }
+    const size_t rowSize = (size_t) refDescriptors.cols * refDescriptors.elemSize();
+    for (int i = 0; i < refDescriptors.rows; i++) {
+      if (memcmp(refDescriptors.ptr(i), loadedDescriptors.ptr(i), rowSize) != 0) {
+        std::cerr << name << ": the loaded descriptors differ from the saved ones" << std::endl;
+        return false;
+      }
+    }
+
+    ref.matchPoint(I);
+    loaded.matchPoint(I);
+    if (ref.getMatches().size() < 50 || !sameMatches(ref.getMatches(), loaded.getMatches())) {
+      std::cerr << name << ": " << loaded.getMatches().size() << " matches with the loaded data, "
+                << ref.getMatches().size() << " with the saved ones" << std::endl;
+      return false;
+    }
+    std::cout << name << ": " << refKeyPoints.size() << " keypoints and " << ref.getMatches().size()
+              << " matches" << std::endl;
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    vpImage<unsigned char> Iref(480, 640), I(480, 640);
+    render(Iref, 0., 0., 0.);
+    render(I, vpMath::rad(5.), 12., -7.);
+
+    const std::string filename = tempDirectory() + "/testKeyPointMappedLearningData.bin";
+    for (int useIndex = 0; useIndex < 2; useIndex++) {
+      vpKeyPoint ref("ORB", "ORB", "BruteForce-Hamming");
+      ref.setUseDescriptorIndex(useIndex != 0);
+      std::vector<cv::KeyPoint> keyPoints;
+      ref.detect(Iref, keyPoints);
+      std::vector<cv::Point3f> points3f;
+      for (size_t i = 0; i < keyPoints.size(); i++)
+        points3f.push_back(cv::Point3f(keyPoints[i].pt.x * 0.001f, keyPoints[i].pt.y * 0.001f, 0.f));
+      ref.buildReference(Iref, keyPoints, points3f);
+      if (useIndex)
+        ref.buildDescriptorIndex();
+      ref.saveMappedLearningData(filename, false);
+
+      vpKeyPoint loaded("ORB", "ORB", "BruteForce-Hamming");
+      loaded.setUseDescriptorIndex(useIndex != 0);
+      loaded.loadLearningData(filename, true);
+      if (! compare(ref, loaded, I, useIndex ? "With the index" : "Without the index"))
+        return EXIT_FAILURE;
+
+      // The descriptors of the mapped file must be cloned to outlive the learning data
+      const cv::Mat descriptors = loaded.getTrainDescriptors().clone();
+      loaded.reset();
+      if (descriptors.rows != (int) keyPoints.size()) {
+        std::cerr << "The cloned descriptors are lost" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    remove(filename.c_str());
+
+    std::cout << "testKeyPointMappedLearningData is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "This test requires OpenCV 2.4 or higher." << std::endl;
+  return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,265 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the approximate nearest neighbour index of descriptors.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceDescriptorIndex.cpp
+
+  \brief Check that vpDescriptorIndex finds the nearest neighbours of binary
+  and float descriptors, whatever the number of threads and after having
+  been saved and loaded, and compare its search time with an exhaustive
+  search.
+*/
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/vision/vpDescriptorIndex.h>
+
+namespace {
+  //! Random train descriptors and queries close to some of them
+  void createBinaryDescriptors(const unsigned int nbTrain, const unsigned int nbQueries, const unsigned int size,
+                               std::vector<unsigned char> &train, std::vector<unsigned char> &queries)
+  {
+    train.resize(nbTrain * size);
+    for (size_t i = 0; i < train.size(); i++)
+      train[i] = (unsigned char) (rand() % 256);
+    queries.resize(nbQueries * size);
+    for (unsigned int i = 0; i < nbQueries; i++) {
+      unsigned int n = rand() % nbTrain;
+      for (unsigned int j = 0; j < size; j++)
+        queries[i * size + j] = train[n * size + j];
+      // Flip 10 bits
+      for (unsigned int j = 0; j < 10; j++) {
+        unsigned int bit = rand() % (8 * size);
+        queries[i * size + bit / 8] ^= (unsigned char) (1 << (bit % 8));
+      }
+    }
+  }
+
+  void createFloatDescriptors(const unsigned int nbTrain, const unsigned int nbQueries, const unsigned int size,
+                              std::vector<float> &train, std::vector<float> &queries)
+  {
+    train.resize(nbTrain * size);
+    for (size_t i = 0; i < train.size(); i++)
+      train[i] = (rand() % 10000) / 10000.f;
+    queries.resize(nbQueries * size);
+    for (unsigned int i = 0; i < nbQueries; i++) {
+      unsigned int n = rand() % nbTrain;
+      for (unsigned int j = 0; j < size; j++)
+        queries[i * size + j] = train[n * size + j] + ((rand() % 10000) / 10000.f - 0.5f) * 0.05f;
+    }
+  }
+
+  unsigned int distance(const unsigned char *a, const unsigned char *b, const unsigned int size)
+  {
+    static unsigned char bitCount[256];
+    if (bitCount[255] == 0) {
+      for (unsigned int i = 1; i < 256; i++)
+        bitCount[i] = (unsigned char) ((i & 1) + bitCount[i / 2]);
+    }
+    unsigned int d = 0;
+    for (unsigned int i = 0; i < size; i++)
+      d += bitCount[a[i] ^ b[i]];
+    return d;
+  }
+
+  float distance(const float *a, const float *b, const unsigned int size)
+  {
+    float d = 0;
+    for (unsigned int i = 0; i < size; i++)
+      d += (a[i] - b[i]) * (a[i] - b[i]);
+    return sqrt(d);
+  }
+
+  //! Nearest neighbour of each query found by an exhaustive search
+  template <typename Type>
+  std::vector<int> searchAll(const std::vector<Type> &train, const std::vector<Type> &queries, const unsigned int size)
+  {
+    std::vector<int> nearest(queries.size() / size);
+    for (size_t i = 0; i < nearest.size(); i++) {
+      double dmin = 0;
+      for (size_t j = 0; j < train.size() / size; j++) {
+        double d = distance(&queries[i * size], &train[j * size], size);
+        if (j == 0 || d < dmin) {
+          dmin = d;
+          nearest[i] = (int) j;
+        }
+      }
+    }
+    return nearest;
+  }
+
+  //! Check the neighbours, return the ratio of queries whose nearest neighbour is found
+  template <typename Type>
+  double checkNeighbours(const std::vector<Type> &train, const std::vector<Type> &queries, const unsigned int size,
+                         const unsigned int k, const std::vector<int> &indexes, const std::vector<float> &distances,
+                         const std::vector<int> &nearest)
+  {
+    unsigned int nbFound = 0;
+    for (size_t i = 0; i < nearest.size(); i++) {
+      for (unsigned int j = 0; j < k; j++) {
+        int index = indexes[i * k + j];
+        if (index < 0 || (size_t) index >= train.size() / size)
+          throw vpException(vpException::fatalError, "Missing neighbour");
+        if (fabs(distances[i * k + j] - distance(&queries[i * size], &train[index * size], size)) > 1e-4)
+          throw vpException(vpException::fatalError, "Wrong distance");
+        if (j > 0 && distances[i * k + j] < distances[i * k + j - 1])
+          throw vpException(vpException::fatalError, "The neighbours are not sorted");
+      }
+      if (indexes[i * k] == nearest[i])
+        nbFound++;
+    }
+    return nbFound / (double) nearest.size();
+  }
+
+  //! Temporary directory of the user
+  std::string tempDirectory()
+  {
+#if defined(_WIN32)
+    std::string directory = "C:/temp/" + vpIoTools::getUserName();
+#else
+    std::string directory = "/tmp/" + vpIoTools::getUserName();
+#endif
+    if (! vpIoTools::checkDirectory(directory))
+      vpIoTools::makeDirectory(directory);
+    return directory;
+  }
+
+  template <typename Type>
+  bool test(const std::string &name, const std::vector<Type> &train, const std::vector<Type> &queries,
+            const unsigned int size, const double minRecall)
+  {
+    const unsigned int nbTrain = (unsigned int) (train.size() / size), nbQueries = (unsigned int) (queries.size() / size);
+    const unsigned int k = 2;
+
+    double t = vpTime::measureTimeMs();
+    std::vector<int> nearest = searchAll(train, queries, size);
+    double t_all = vpTime::measureTimeMs() - t;
+
+    t = vpTime::measureTimeMs();
+    vpDescriptorIndex index;
+    index.build(&train[0], nbTrain, size);
+    double t_build = vpTime::measureTimeMs() - t;
+
+    std::vector<int> indexes;
+    std::vector<float> distances;
+    t = vpTime::measureTimeMs();
+    index.knnSearch(&queries[0], nbQueries, k, indexes, distances);
+    double t_search = vpTime::measureTimeMs() - t;
+    double recall = checkNeighbours(train, queries, size, k, indexes, distances, nearest);
+    if (recall < minRecall) {
+      std::cerr << name << ": the nearest neighbour is found for only " << 100 * recall << "% of the queries"
+                << std::endl;
+      return false;
+    }
+
+    // Same neighbours whatever the number of threads
+    std::vector<int> indexes1;
+    std::vector<float> distances1;
+    index.setNbThreads(1);
+    index.knnSearch(&queries[0], nbQueries, k, indexes1, distances1);
+    if (indexes1 != indexes || distances1 != distances) {
+      std::cerr << name << ": the neighbours depend on the number of threads" << std::endl;
+      return false;
+    }
+
+    // Same neighbours after having saved and loaded the index
+    const std::string filename = tempDirectory() + "/testPerformanceDescriptorIndex.bin";
+    index.save(filename);
+    vpDescriptorIndex loaded;
+    if (!loaded.load(filename, &train[0], nbTrain, size)) {
+      std::cerr << name << ": cannot load the index" << std::endl;
+      return false;
+    }
+    loaded.knnSearch(&queries[0], nbQueries, k, indexes1, distances1);
+    if (indexes1 != indexes || distances1 != distances) {
+      std::cerr << name << ": the loaded index gives other neighbours" << std::endl;
+      return false;
+    }
+    std::vector<Type> other(train);
+    other[0] = other[0] + 1;
+    if (loaded.load(filename, &other[0], nbTrain, size) || !loaded.empty()) {
+      std::cerr << name << ": an index is loaded for other descriptors" << std::endl;
+      return false;
+    }
+    remove(filename.c_str());
+
+    std::cout << name << ", " << nbQueries << " queries on " << nbTrain << " descriptors:" << std::endl;
+    std::cout << "  build:             " << t_build << " ms" << std::endl;
+    std::cout << "  indexed search:    " << t_search << " ms, recall " << 100 * recall << "%" << std::endl;
+    std::cout << "  exhaustive search: " << t_all << " ms" << std::endl;
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    vpThreadPool::getInstance().setNumThreads(std::max(4u, vpThreadPool::getNumberOfCPU()));
+    srand(0);
+
+    std::vector<unsigned char> binaryTrain, binaryQueries;
+    createBinaryDescriptors(50000, 1000, 32, binaryTrain, binaryQueries);
+    if (!test("Binary descriptors", binaryTrain, binaryQueries, 32, 0.95))
+      return EXIT_FAILURE;
+
+    std::vector<float> floatTrain, floatQueries;
+    createFloatDescriptors(20000, 500, 64, floatTrain, floatQueries);
+    if (!test("Float descriptors", floatTrain, floatQueries, 64, 0.9))
+      return EXIT_FAILURE;
+
+    // Less descriptors than neighbours
+    vpDescriptorIndex index;
+    index.build(&binaryTrain[0], 1, 32);
+    std::vector<int> indexes;
+    std::vector<float> distances;
+    index.knnSearch(&binaryQueries[0], 1, 2, indexes, distances);
+    if (indexes.size() != 2 || indexes[0] != 0 || indexes[1] != -1) {
+      std::cerr << "Wrong neighbours in a small index" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "testPerformanceDescriptorIndex is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,420 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the memory mapped file of keypoint learning data.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceLearningDataFile.cpp
+
+  \brief Check that vpLearningDataFile gives back the saved learning data,
+  mapped or not, that the sections of a file that is not mapped can be read
+  from several threads, that corrupted files are rejected, and compare its loading
+  time with the field by field reading of the binary learning files. Also time
+  the loading of the stored index of the descriptors, and of a separate index
+  file checked against them.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/vision/vpLearningDataFile.h>
+
+namespace {
+  //! Request the sections of a file from several threads, section i % 3 at iteration i
+  class SectionTask : public vpThreadPool::Task
+  {
+  public:
+    SectionTask(const vpLearningDataFile &file, std::vector<const void *> &sections)
+      : m_file(file), m_sections(sections) {}
+
+    void operator()(const unsigned int begin, const unsigned int end)
+    {
+      for (unsigned int i = begin; i < end; i++) {
+        if (i % 3 == 0)
+          m_sections[i] = m_file.getKeyPoints();
+        else if (i % 3 == 1)
+          m_sections[i] = m_file.getDescriptors();
+        else
+          m_sections[i] = m_file.getPoints3D();
+      }
+    }
+
+  private:
+    const vpLearningDataFile &m_file;
+    std::vector<const void *> &m_sections;
+  };
+
+  //! Temporary directory of the user
+  std::string tempDirectory()
+  {
+#if defined(_WIN32)
+    std::string directory = "C:/temp/" + vpIoTools::getUserName();
+#else
+    std::string directory = "/tmp/" + vpIoTools::getUserName();
+#endif
+    if (! vpIoTools::checkDirectory(directory))
+      vpIoTools::makeDirectory(directory);
+    return directory;
+  }
+
+  template <typename Type>
+  void writeValue(std::ofstream &file, const Type &value)
+  {
+    file.write((const char *) &value, sizeof(value));
+  }
+
+  template <typename Type>
+  void readValue(std::ifstream &file, Type &value)
+  {
+    file.read((char *) &value, sizeof(value));
+  }
+
+  //! Save the data as a binary learning file of vpKeyPoint, field by field
+  void saveFieldByField(const std::string &filename, const std::vector<vpLearningDataFile::KeyPoint> &keyPoints,
+                        const std::vector<unsigned char> &descriptors, const unsigned int descriptorSize,
+                        const std::vector<float> &points3D)
+  {
+    std::ofstream file(filename.c_str(), std::ofstream::binary);
+    writeValue(file, 0);
+    writeValue(file, 1);
+    writeValue(file, (int) keyPoints.size());
+    writeValue(file, (int) descriptorSize);
+    writeValue(file, 0);
+    for (size_t i = 0; i < keyPoints.size(); i++) {
+      writeValue(file, keyPoints[i].u);
+      writeValue(file, keyPoints[i].v);
+      writeValue(file, keyPoints[i].size);
+      writeValue(file, keyPoints[i].angle);
+      writeValue(file, keyPoints[i].response);
+      writeValue(file, keyPoints[i].octave);
+      writeValue(file, keyPoints[i].classId);
+      writeValue(file, keyPoints[i].imageId);
+      for (unsigned int j = 0; j < 3; j++)
+        writeValue(file, points3D[3 * i + j]);
+      for (unsigned int j = 0; j < descriptorSize; j++)
+        writeValue(file, descriptors[i * descriptorSize + j]);
+    }
+  }
+
+  //! Load a binary learning file as vpKeyPoint::loadLearningData() does
+  void loadFieldByField(const std::string &filename, std::vector<vpLearningDataFile::KeyPoint> &keyPoints,
+                        std::vector<unsigned char> &descriptors, std::vector<float> &points3D)
+  {
+    std::ifstream file(filename.c_str(), std::ifstream::binary);
+    int nbImages, have3D, nbDescriptors, descriptorSize, type;
+    readValue(file, nbImages);
+    readValue(file, have3D);
+    readValue(file, nbDescriptors);
+    readValue(file, descriptorSize);
+    readValue(file, type);
+    keyPoints.clear();
+    points3D.clear();
+    descriptors.resize((size_t) nbDescriptors * descriptorSize);
+    for (int i = 0; i < nbDescriptors; i++) {
+      vpLearningDataFile::KeyPoint keyPoint;
+      readValue(file, keyPoint.u);
+      readValue(file, keyPoint.v);
+      readValue(file, keyPoint.size);
+      readValue(file, keyPoint.angle);
+      readValue(file, keyPoint.response);
+      readValue(file, keyPoint.octave);
+      readValue(file, keyPoint.classId);
+      readValue(file, keyPoint.imageId);
+      keyPoints.push_back(keyPoint);
+      for (unsigned int j = 0; j < 3; j++) {
+        float value;
+        readValue(file, value);
+        points3D.push_back(value);
+      }
+      for (int j = 0; j < descriptorSize; j++)
+        readValue(file, descriptors[i * descriptorSize + j]);
+    }
+  }
+
+  //! Check that the file gives back the saved data
+  bool checkFile(const vpLearningDataFile &file, const std::vector<vpLearningDataFile::KeyPoint> &keyPoints,
+                 const std::vector<unsigned char> &descriptors, const unsigned int descriptorSize,
+                 const std::vector<float> &points3D, const std::map<int, std::string> &images)
+  {
+    return file.getNbDescriptors() == keyPoints.size() && file.getDescriptorSize() == descriptorSize &&
+           file.getDescriptorType() == 0 && file.getDescriptorElementSize() == 1 &&
+           memcmp(file.getKeyPoints(), &keyPoints[0], keyPoints.size() * sizeof(keyPoints[0])) == 0 &&
+           memcmp(file.getDescriptors(), &descriptors[0], descriptors.size()) == 0 && file.hasPoints3D() &&
+           memcmp(file.getPoints3D(), &points3D[0], points3D.size() * sizeof(float)) == 0 &&
+           file.getImages() == images;
+  }
+
+  //! Return true if opening the file throws an exception
+  bool isRejected(const std::string &filename)
+  {
+    vpLearningDataFile file;
+    try {
+      file.open(filename);
+    }
+    catch(const vpException &) {
+      return true;
+    }
+    return false;
+  }
+
+  //! Copy the first bytes of a file, changing the byte at a given position
+  void copyFile(const std::string &source, const std::string &destination, const size_t size,
+                const size_t position, const char byte)
+  {
+    std::vector<char> buffer(size);
+    std::ifstream input(source.c_str(), std::ifstream::binary);
+    input.read(&buffer[0], (std::streamsize) size);
+    if (position < size)
+      buffer[position] = byte;
+    std::ofstream output(destination.c_str(), std::ofstream::binary);
+    output.write(&buffer[0], (std::streamsize) size);
+  }
+}
+
+int main()
+{
+  try {
+    srand(0);
+    const unsigned int nbDescriptors = 200000, descriptorSize = 32;
+    std::vector<vpLearningDataFile::KeyPoint> keyPoints(nbDescriptors);
+    std::vector<unsigned char> descriptors(nbDescriptors * descriptorSize);
+    std::vector<float> points3D(3 * nbDescriptors);
+    for (unsigned int i = 0; i < nbDescriptors; i++) {
+      keyPoints[i].u = (float) (rand() % 640);
+      keyPoints[i].v = (float) (rand() % 480);
+      keyPoints[i].size = 31.f;
+      keyPoints[i].angle = (float) (rand() % 360);
+      keyPoints[i].response = (rand() % 1000) / 1000.f;
+      keyPoints[i].octave = rand() % 8;
+      keyPoints[i].classId = (int) i;
+      keyPoints[i].imageId = rand() % 2;
+      for (unsigned int j = 0; j < 3; j++)
+        points3D[3 * i + j] = (rand() % 1000) / 1000.f;
+    }
+    for (size_t i = 0; i < descriptors.size(); i++)
+      descriptors[i] = (unsigned char) (rand() % 256);
+    std::map<int, std::string> images;
+    images[0] = "train_image_000.png";
+    images[1] = "train_image_001.png";
+
+    vpDescriptorIndex index;
+    index.build(&descriptors[0], nbDescriptors, descriptorSize);
+
+    const std::string directory = tempDirectory();
+    const std::string filename = directory + "/testPerformanceLearningDataFile.bin";
+    const std::string fieldFilename = directory + "/testPerformanceLearningDataFile_fields.bin";
+    const std::string corruptedFilename = directory + "/testPerformanceLearningDataFile_corrupted.bin";
+    vpLearningDataFile::save(filename, keyPoints, &descriptors[0], descriptorSize, 0, 1, points3D, images, &index);
+    saveFieldByField(fieldFilename, keyPoints, descriptors, descriptorSize, points3D);
+
+    if (!vpLearningDataFile::isLearningDataFile(filename) || vpLearningDataFile::isLearningDataFile(fieldFilename)) {
+      std::cerr << "The learning data files are not detected" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Load the data, mapped or not, and touch them all
+    double t = vpTime::measureTimeMs();
+    vpLearningDataFile file;
+    file.open(filename);
+    unsigned int sum = 0;
+    const unsigned char *mappedDescriptors = (const unsigned char *) file.getDescriptors();
+    for (size_t i = 0; i < descriptors.size(); i++)
+      sum += mappedDescriptors[i];
+    double t_mapped = vpTime::measureTimeMs() - t;
+
+    t = vpTime::measureTimeMs();
+    vpLearningDataFile readFile;
+    readFile.open(filename, false);
+    const unsigned char *readDescriptors = (const unsigned char *) readFile.getDescriptors();
+    for (size_t i = 0; i < descriptors.size(); i++)
+      sum -= readDescriptors[i];
+    readFile.getKeyPoints();
+    readFile.getPoints3D();
+    double t_read = vpTime::measureTimeMs() - t;
+
+    t = vpTime::measureTimeMs();
+    std::vector<vpLearningDataFile::KeyPoint> fieldKeyPoints;
+    std::vector<unsigned char> fieldDescriptors;
+    std::vector<float> fieldPoints3D;
+    loadFieldByField(fieldFilename, fieldKeyPoints, fieldDescriptors, fieldPoints3D);
+    double t_fields = vpTime::measureTimeMs() - t;
+
+    if (sum != 0 || !checkFile(file, keyPoints, descriptors, descriptorSize, points3D, images) ||
+        !checkFile(readFile, keyPoints, descriptors, descriptorSize, points3D, images) || readFile.isMapped() ||
+        fieldDescriptors != descriptors) {
+      std::cerr << "The loaded learning data are different from the saved ones" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The index stored in the file gives the same neighbours
+    vpDescriptorIndex loadedIndex;
+    if (!file.hasIndex() || !file.getIndex(loadedIndex)) {
+      std::cerr << "Cannot load the index of the descriptors" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::vector<int> indexes, loadedIndexes;
+    std::vector<float> distances, loadedDistances;
+    index.knnSearch(&descriptors[0], 100, 2, indexes, distances);
+    loadedIndex.knnSearch(&descriptors[0], 100, 2, loadedIndexes, loadedDistances);
+    if (indexes != loadedIndexes || distances != loadedDistances) {
+      std::cerr << "The loaded index gives other neighbours" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The index stored with the descriptors is loaded without reading them, unlike a separate index file
+    t = vpTime::measureTimeMs();
+    vpLearningDataFile indexFile;
+    indexFile.open(filename);
+    vpDescriptorIndex embeddedIndex;
+    bool loaded = indexFile.getIndex(embeddedIndex);
+    double t_index = vpTime::measureTimeMs() - t;
+
+    const std::string indexFilename = directory + "/testPerformanceLearningDataFile.index";
+    index.save(indexFilename);
+    t = vpTime::measureTimeMs();
+    vpDescriptorIndex separateIndex;
+    loaded = loaded && separateIndex.load(indexFilename, &descriptors[0], nbDescriptors, descriptorSize);
+    double t_separate = vpTime::measureTimeMs() - t;
+    if (!loaded) {
+      std::cerr << "Cannot load the index of the descriptors" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::vector<unsigned char> modifiedDescriptors(descriptors);
+    modifiedDescriptors.back() ^= 0xFF;
+    ((unsigned char *) indexFile.getDescriptors())[0] ^= 0xFF;
+    if (separateIndex.load(indexFilename, &modifiedDescriptors[0], nbDescriptors, descriptorSize) ||
+        !indexFile.getIndex(embeddedIndex)) {
+      std::cerr << "Only the separate index file must be checked against the descriptors" << std::endl;
+      return EXIT_FAILURE;
+    }
+    indexFile.close();
+
+    // The sections read on demand by several threads are read once
+    vpLearningDataFile concurrentFile;
+    concurrentFile.open(filename, false);
+    std::vector<const void *> sections(300);
+    SectionTask task(concurrentFile, sections);
+    // Several threads, even on a single core
+    vpThreadPool::getInstance().setNumThreads(std::max(4u, vpThreadPool::getNumberOfCPU()));
+    vpThreadPool::getInstance().parallelFor(0, (unsigned int) sections.size(), task);
+    for (size_t i = 3; i < sections.size(); i++) {
+      if (sections[i] == NULL || sections[i] != sections[i % 3]) {
+        std::cerr << "The sections read by several threads differ" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    if (!checkFile(concurrentFile, keyPoints, descriptors, descriptorSize, points3D, images)) {
+      std::cerr << "The sections read by several threads are wrong" << std::endl;
+      return EXIT_FAILURE;
+    }
+    concurrentFile.close();
+
+    // A copy keeps the data once the file is closed, a modification of the mapped data does not modify the file
+    vpLearningDataFile copy(file);
+    file.close();
+    readFile = copy;
+    *((unsigned char *) copy.getDescriptors()) ^= 0xFF;
+    vpLearningDataFile reopened;
+    reopened.open(filename);
+    if (copy.getNbDescriptors() != nbDescriptors || readFile.getDescriptors() != copy.getDescriptors() ||
+        !checkFile(reopened, keyPoints, descriptors, descriptorSize, points3D, images)) {
+      std::cerr << "The copies do not share the file" << std::endl;
+      return EXIT_FAILURE;
+    }
+    copy.close();
+    readFile.close();
+    reopened.close();
+
+    // Float descriptors without 3D points, images or index
+    std::vector<vpLearningDataFile::KeyPoint> floatKeyPoints(keyPoints.begin(), keyPoints.begin() + 10);
+    std::vector<float> floatDescriptors(10 * 64, 0.5f);
+    vpLearningDataFile::save(filename, floatKeyPoints, &floatDescriptors[0], 64, 5, 4, std::vector<float>(),
+                             std::map<int, std::string>());
+    vpLearningDataFile floatFile;
+    floatFile.open(filename);
+    if (floatFile.getNbDescriptors() != 10 || floatFile.getDescriptorType() != 5 || floatFile.hasPoints3D() ||
+        floatFile.getPoints3D() != NULL || floatFile.hasIndex() || !floatFile.getImages().empty() ||
+        memcmp(floatFile.getDescriptors(), &floatDescriptors[0], floatDescriptors.size() * sizeof(float)) != 0) {
+      std::cerr << "Wrong float learning data" << std::endl;
+      return EXIT_FAILURE;
+    }
+    floatFile.close();
+
+    // Corrupted files are rejected
+    vpLearningDataFile::save(filename, keyPoints, &descriptors[0], descriptorSize, 0, 1, points3D, images, &index);
+    std::ifstream input(filename.c_str(), std::ifstream::binary | std::ifstream::ate);
+    const size_t fileSize = (size_t) input.tellg();
+    input.close();
+    copyFile(filename, corruptedFilename, fileSize, fileSize, 0);
+    if (isRejected(corruptedFilename)) {
+      std::cerr << "A valid file is rejected" << std::endl;
+      return EXIT_FAILURE;
+    }
+    copyFile(filename, corruptedFilename, fileSize, 20, 0x7F);
+    bool rejected = isRejected(corruptedFilename);
+    copyFile(filename, corruptedFilename, fileSize - 1, fileSize, 0);
+    rejected = rejected && isRejected(corruptedFilename) && isRejected(fieldFilename);
+    if (!rejected) {
+      std::cerr << "A corrupted file is accepted" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    remove(filename.c_str());
+    remove(fieldFilename.c_str());
+    remove(corruptedFilename.c_str());
+    remove(indexFilename.c_str());
+
+    std::cout << nbDescriptors << " keypoints with " << descriptorSize << " bytes descriptors and 3D points:"
+              << std::endl;
+    std::cout << "  mapped file:              " << t_mapped << " ms" << std::endl;
+    std::cout << "  file read by sections:    " << t_read << " ms" << std::endl;
+    std::cout << "  file read field by field: " << t_fields << " ms" << std::endl;
+    std::cout << "Index of the descriptors:" << std::endl;
+    std::cout << "  stored in the mapped file:  " << t_index << " ms" << std::endl;
+    std::cout << "  separate file, checksummed: " << t_separate << " ms" << std::endl;
+    std::cout << "testPerformanceLearningDataFile is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
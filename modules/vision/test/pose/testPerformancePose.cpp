@@ -0,0 +1,181 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the pose estimation from many points.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformancePose.cpp
+
+  \brief Check that the residual computed by vpPose is the one given by
+  vpPoint::track(), that the pose does not depend on the way the points are
+  added, and measure the time spent to add the points, compute the residual
+  and estimate the pose with RANSAC from many points with outliers.
+*/
+
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpTime.h>
+#include <visp3/vision/vpPose.h>
+
+namespace {
+  double random(const double min, const double max)
+  {
+    return min + (max - min) * (rand() % 10000) / 10000.;
+  }
+
+  //! Points projected with cMo, with some noise and a ratio of outliers
+  std::vector<vpPoint> createPoints(const unsigned int n, const vpHomogeneousMatrix &cMo, const double outliers)
+  {
+    std::vector<vpPoint> points;
+    for (unsigned int i = 0; i < n; i++) {
+      vpPoint P(random(-0.2, 0.2), random(-0.2, 0.2), random(-0.1, 0.1));
+      P.project(cMo);
+      P.set_x(P.get_x() + random(-0.0002, 0.0002));
+      P.set_y(P.get_y() + random(-0.0002, 0.0002));
+      if (random(0, 1) < outliers) {
+        P.set_x(random(-0.5, 0.5));
+        P.set_y(random(-0.5, 0.5));
+      }
+      points.push_back(P);
+    }
+    return points;
+  }
+
+  //! Residual computed with vpPoint
+  double residual(const std::vector<vpPoint> &points, const vpHomogeneousMatrix &cMo)
+  {
+    double r = 0;
+    for (size_t i = 0; i < points.size(); i++) {
+      vpPoint P = points[i];
+      P.track(cMo);
+      r += vpMath::sqr(points[i].get_x() - P.get_x()) + vpMath::sqr(points[i].get_y() - P.get_y());
+    }
+    return r;
+  }
+
+  bool samePose(const vpHomogeneousMatrix &M1, const vpHomogeneousMatrix &M2)
+  {
+    for (unsigned int i = 0; i < 3; i++) {
+      for (unsigned int j = 0; j < 4; j++) {
+        if (M1[i][j] != M2[i][j])
+          return false;
+      }
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    srand(0);
+    const vpHomogeneousMatrix cMo_ref(0.05, -0.02, 1.0, vpMath::rad(10), vpMath::rad(-20), vpMath::rad(30));
+
+    // Same pose whatever the way the points are added
+    std::vector<vpPoint> points = createPoints(20, cMo_ref, 0);
+    vpPose pose1, pose2;
+    for (size_t i = 0; i < points.size(); i++)
+      pose1.addPoint(points[i]);
+    pose2.addPoints(points);
+    const vpPose::vpPoseMethodType methods[] = { vpPose::LAGRANGE, vpPose::DEMENTHON, vpPose::LAGRANGE_VIRTUAL_VS,
+                                                 vpPose::DEMENTHON_LOWE };
+    for (unsigned int m = 0; m < 4; m++) {
+      vpHomogeneousMatrix cMo1, cMo2;
+      pose1.computePose(methods[m], cMo1);
+      pose2.computePose(methods[m], cMo2);
+      if (! samePose(cMo1, cMo2)) {
+        std::cerr << "The pose depends on the way the points are added" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (pose1.computeResidual(cMo1) != residual(points, cMo1)) {
+        std::cerr << "The residual differs from the one computed with vpPoint" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (sqrt(pose1.computeResidual(cMo1) / points.size()) > 0.001) {
+        std::cerr << "The pose is not estimated accurately" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // RANSAC with outliers
+    const unsigned int n = 2000, nb_iter = 10;
+    points = createPoints(n, cMo_ref, 0.3);
+    double t_add = 0, t_residual = 0, t_ransac = 0;
+    for (unsigned int iter = 0; iter < nb_iter; iter++) {
+      double t = vpTime::measureTimeMs();
+      vpPose pose;
+      pose.addPoints(points);
+      t_add += vpTime::measureTimeMs() - t;
+
+      t = vpTime::measureTimeMs();
+      pose.computeResidual(cMo_ref);
+      t_residual += vpTime::measureTimeMs() - t;
+
+      pose.setRansacThreshold(0.001);
+      pose.setRansacNbInliersToReachConsensus(n);
+      pose.setRansacMaxTrials(200);
+      vpHomogeneousMatrix cMo;
+      t = vpTime::measureTimeMs();
+      if (! pose.computePose(vpPose::RANSAC, cMo)) {
+        std::cerr << "RANSAC failed" << std::endl;
+        return EXIT_FAILURE;
+      }
+      t_ransac += vpTime::measureTimeMs() - t;
+
+      std::vector<vpPoint> inliers = pose.getRansacInliers();
+      std::vector<unsigned int> index = pose.getRansacInlierIndex();
+      if (inliers.size() < n / 2 || index.size() != inliers.size()) {
+        std::cerr << "Only " << inliers.size() << " inliers on " << n << " points" << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (size_t i = 0; i < index.size(); i++) {
+        if (inliers[i].get_x() != points[index[i]].get_x() || inliers[i].get_oZ() != points[index[i]].get_oZ()) {
+          std::cerr << "The inliers do not match their index" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+    std::cout << "Pose from " << n << " points, mean time:" << std::endl;
+    std::cout << "  addPoints():            " << t_add / nb_iter << " ms" << std::endl;
+    std::cout << "  computeResidual():      " << t_residual / nb_iter << " ms" << std::endl;
+    std::cout << "  RANSAC with 200 trials: " << t_ransac / nb_iter << " ms" << std::endl;
+
+    std::cout << "testPerformancePose is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
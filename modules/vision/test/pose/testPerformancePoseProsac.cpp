@@ -0,0 +1,182 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test and benchmark the P3P, EPnP and PROSAC pose estimation.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformancePoseProsac.cpp
+
+  \brief Check that the P3P and EPnP methods give the exact pose from
+  noise-free planar and non-planar points, that PROSAC finds as many inliers as
+  RANSAC, and measure the time spent by RANSAC and PROSAC, with and without
+  a quality of the correspondences, for several ratios of outliers.
+*/
+
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include <visp3/core/vpTime.h>
+#include <visp3/vision/vpPose.h>
+
+namespace {
+  double random(const double min, const double max)
+  {
+    return min + (max - min) * (rand() % 10000) / 10000.;
+  }
+
+  //! Points projected with cMo, with some noise and a ratio of outliers whose quality is lower
+  std::vector<vpPoint> createPoints(const unsigned int n, const vpHomogeneousMatrix &cMo, const bool planar,
+                                    const double noise, const double outliers, std::vector<double> &quality)
+  {
+    std::vector<vpPoint> points;
+    quality.clear();
+    for (unsigned int i = 0; i < n; i++) {
+      vpPoint P(random(-0.2, 0.2), random(-0.2, 0.2), planar ? 0 : random(-0.1, 0.1));
+      P.project(cMo);
+      P.set_x(P.get_x() + random(-noise, noise));
+      P.set_y(P.get_y() + random(-noise, noise));
+      if (random(0, 1) < outliers) {
+        P.set_x(random(-0.5, 0.5));
+        P.set_y(random(-0.5, 0.5));
+        quality.push_back(random(0, 0.8));
+      } else {
+        quality.push_back(random(0.2, 1));
+      }
+      points.push_back(P);
+    }
+    return points;
+  }
+
+  double poseError(const vpHomogeneousMatrix &M1, const vpHomogeneousMatrix &M2)
+  {
+    double e = 0;
+    for (unsigned int i = 0; i < 3; i++) {
+      for (unsigned int j = 0; j < 4; j++) {
+        e = std::max(e, fabs(M1[i][j] - M2[i][j]));
+      }
+    }
+    return e;
+  }
+}
+
+int main()
+{
+  try {
+    srand(0);
+    const vpHomogeneousMatrix cMo_ref(0.05, -0.02, 1.0, vpMath::rad(10), vpMath::rad(-20), vpMath::rad(30));
+    std::vector<double> quality;
+
+    // Exact pose from noise-free points
+    const vpPose::vpPoseMethodType methods[] = { vpPose::P3P, vpPose::EPNP, vpPose::EPNP_VIRTUAL_VS };
+    const char *names[] = { "P3P", "EPNP", "EPNP_VIRTUAL_VS" };
+    const unsigned int sizes[] = { 4, 5, 10, 100 };
+    for (unsigned int planar = 0; planar < 2; planar++) {
+      for (unsigned int s = 0; s < 4; s++) {
+        std::vector<vpPoint> points = createPoints(sizes[s], cMo_ref, planar == 1, 0, 0, quality);
+        vpPose pose;
+        pose.addPoints(points);
+        for (unsigned int m = 0; m < 3; m++) {
+          vpHomogeneousMatrix cMo;
+          pose.computePose(methods[m], cMo);
+          if (poseError(cMo, cMo_ref) > 1e-6) {
+            std::cerr << names[m] << " pose from " << sizes[s] << (planar ? " planar" : " non-planar")
+                      << " points is wrong:\n" << cMo << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+    // RANSAC and PROSAC with outliers
+    const unsigned int n = 2000, nb_iter = 10;
+    const double ratios[] = { 0.1, 0.3, 0.5, 0.7 };
+    std::cout << "Pose from " << n << " points, mean time:" << std::endl;
+    for (unsigned int r = 0; r < 4; r++) {
+      std::vector<vpPoint> points = createPoints(n, cMo_ref, false, 0.0002, ratios[r], quality);
+      double t_ransac = 0, t_prosac = 0, t_prosac_quality = 0;
+      for (unsigned int iter = 0; iter < nb_iter; iter++) {
+        vpPose pose;
+        pose.addPoints(points);
+        pose.setRansacThreshold(0.001);
+        pose.setRansacNbInliersToReachConsensus(n);
+        pose.setRansacMaxTrials(ratios[r] < 0.6 ? 200 : 1000);
+
+        vpHomogeneousMatrix cMo;
+        double t = vpTime::measureTimeMs();
+        if (! pose.computePose(vpPose::RANSAC, cMo)) {
+          std::cerr << "RANSAC failed" << std::endl;
+          return EXIT_FAILURE;
+        }
+        t_ransac += vpTime::measureTimeMs() - t;
+        const std::vector<unsigned int> index_ransac = pose.getRansacInlierIndex();
+
+        for (unsigned int q = 0; q < 2; q++) {
+          pose.setProsacQuality(q == 0 ? std::vector<double>() : quality);
+          t = vpTime::measureTimeMs();
+          if (! pose.computePose(vpPose::PROSAC, cMo)) {
+            std::cerr << "PROSAC failed" << std::endl;
+            return EXIT_FAILURE;
+          }
+          (q == 0 ? t_prosac : t_prosac_quality) += vpTime::measureTimeMs() - t;
+
+          const std::vector<vpPoint> inliers = pose.getRansacInliers();
+          const std::vector<unsigned int> index = pose.getRansacInlierIndex();
+          if (100 * index.size() < 99 * index_ransac.size() || inliers.size() != index.size()) {
+            std::cerr << "PROSAC found " << index.size() << " inliers while RANSAC found " << index_ransac.size()
+                      << " with " << ratios[r] * 100 << "% of outliers" << std::endl;
+            return EXIT_FAILURE;
+          }
+          for (size_t i = 0; i < index.size(); i++) {
+            if (inliers[i].get_x() != points[index[i]].get_x() || inliers[i].get_oZ() != points[index[i]].get_oZ()) {
+              std::cerr << "The inliers do not match their index" << std::endl;
+              return EXIT_FAILURE;
+            }
+          }
+          if (poseError(cMo, cMo_ref) > 0.01) {
+            std::cerr << "The PROSAC pose is not accurate:\n" << cMo << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+      std::cout << "  " << ratios[r] * 100 << "% of outliers: RANSAC " << t_ransac / nb_iter << " ms, PROSAC "
+                << t_prosac / nb_iter << " ms, PROSAC with quality " << t_prosac_quality / nb_iter << " ms" << std::endl;
+    }
+
+    std::cout << "testPerformancePoseProsac is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,156 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the pose estimation when the points of vpPose::listP are modified.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPoseModifiedPoints.cpp
+
+  \brief Check that the pose estimation methods take into account the points
+  of vpPose::listP modified in place, or cleared and replaced by the same
+  number of points, without calling addPoint().
+*/
+
+#include <cmath>
+#include <iostream>
+#include <list>
+#include <stdlib.h>
+
+#include <visp3/core/vpMath.h>
+#include <visp3/vision/vpPose.h>
+#include <visp3/vision/vpPoseException.h>
+
+namespace {
+  //! Object points of a non-planar target
+  std::list<vpPoint> createPoints()
+  {
+    const double X[8] = { -0.1,  0.1, 0.1, -0.1, -0.05,  0.05, 0.08, -0.07 };
+    const double Y[8] = { -0.1, -0.1, 0.1,  0.1,  0.02, -0.06, 0.03,  0.05 };
+    const double Z[8] = {  0.,   0.,  0.,   0.,   0.05,  0.03, 0.08,  0.02 };
+    std::list<vpPoint> points;
+    for (unsigned int i = 0; i < 8; i++)
+      points.push_back(vpPoint(X[i], Y[i], Z[i]));
+    return points;
+  }
+
+  bool samePose(const vpHomogeneousMatrix &cMo_ref, const vpHomogeneousMatrix &cMo_est)
+  {
+    const vpPoseVector pose_ref(cMo_ref), pose_est(cMo_est);
+    for (unsigned int i = 0; i < 6; i++) {
+      if (std::fabs(pose_ref[i] - pose_est[i]) > 1e-6)
+        return false;
+    }
+    return true;
+  }
+
+  //! Check that the pose computed by each method is the one used to project the points
+  bool checkPose(vpPose &pose, const vpHomogeneousMatrix &cMo_ref, const std::string &legend)
+  {
+    const vpPose::vpPoseMethodType methods[5] = { vpPose::LAGRANGE_VIRTUAL_VS, vpPose::DEMENTHON_VIRTUAL_VS,
+                                                  vpPose::EPNP, vpPose::RANSAC, vpPose::PROSAC };
+    const char *names[5] = { "Lagrange and VVS", "Dementhon and VVS", "EPnP", "RANSAC", "PROSAC" };
+    for (unsigned int i = 0; i < 5; i++) {
+      vpHomogeneousMatrix cMo;
+      pose.computePose(methods[i], cMo);
+      if (! samePose(cMo_ref, cMo)) {
+        std::cerr << legend << ": the pose of the " << names[i] << " method is not the expected one" << std::endl;
+        return false;
+      }
+    }
+    if (pose.computeResidual(cMo_ref) > 1e-12) {
+      std::cerr << legend << ": the residual of the expected pose is " << pose.computeResidual(cMo_ref) << std::endl;
+      return false;
+    }
+    std::cout << legend << ": the poses are the expected ones" << std::endl;
+    return true;
+  }
+}
+
+int main()
+{
+  try {
+    const vpHomogeneousMatrix cMo_ref1(0.01, 0.02, 0.5, vpMath::rad(5), 0, vpMath::rad(10));
+    const vpHomogeneousMatrix cMo_ref2(-0.03, 0.01, 0.6, vpMath::rad(-10), vpMath::rad(15), vpMath::rad(-5));
+    const vpHomogeneousMatrix cMo_ref3(0.05, -0.04, 0.4, vpMath::rad(20), vpMath::rad(-5), vpMath::rad(30));
+
+    std::list<vpPoint> points = createPoints();
+    vpPose pose;
+    pose.setRansacNbInliersToReachConsensus((unsigned int) points.size());
+    pose.setRansacThreshold(1e-6);
+    for (std::list<vpPoint>::iterator it = points.begin(); it != points.end(); ++it) {
+      it->project(cMo_ref1);
+      pose.addPoint(*it);
+    }
+    if (! checkPose(pose, cMo_ref1, "Points added"))
+      return EXIT_FAILURE;
+
+    // Points modified in place
+    for (std::list<vpPoint>::iterator it = pose.listP.begin(); it != pose.listP.end(); ++it) {
+      vpColVector cP, p;
+      it->changeFrame(cMo_ref2, cP);
+      it->projection(cP, p);
+      it->set_x(p[0]);
+      it->set_y(p[1]);
+    }
+    if (! checkPose(pose, cMo_ref2, "Points modified in place"))
+      return EXIT_FAILURE;
+
+    // Points cleared and replaced by the same number of points
+    pose.listP.clear();
+    for (std::list<vpPoint>::iterator it = points.begin(); it != points.end(); ++it) {
+      it->project(cMo_ref3);
+      pose.listP.push_back(*it);
+    }
+    if (! checkPose(pose, cMo_ref3, "Points replaced"))
+      return EXIT_FAILURE;
+
+    // No point left
+    pose.listP.clear();
+    try {
+      vpHomogeneousMatrix cMo;
+      pose.computePose(vpPose::LAGRANGE_VIRTUAL_VS, cMo);
+      std::cerr << "A pose is computed without any point" << std::endl;
+      return EXIT_FAILURE;
+    }
+    catch(vpPoseException &e) {
+      if (e.getCode() != vpPoseException::notEnoughPointError)
+        throw;
+    }
+
+    std::cout << "testPoseModifiedPoints is ok!" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch(vpException &e) {
+    std::cerr << "Catch an exception: " << e.getStringMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}